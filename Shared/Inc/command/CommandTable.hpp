@@ -0,0 +1,164 @@
+/**
+ * @file CommandTable.hpp
+ * @brief Compile-time command table with O(1) dense dispatch
+ *
+ * Built-in commands are listed once in a constexpr CommandEntry array.
+ * makeCommandTable<Entries>() folds that list into a [cluster][commandId]
+ * pointer matrix at compile time, so the table lives in flash (.rodata),
+ * costs no RAM, and lookup is a bounds check plus one indexed load — no
+ * virtual getKey() call per entry. Duplicate keys fail the build.
+ *
+ * Usage:
+ *   static PingCommand sPing;
+ *   static constexpr CommandEntry kEntries[] = { commandEntry(sPing) };
+ *   static constexpr auto kTable = makeCommandTable<kEntries>();
+ *   ICommand* cmd = kTable.find(key);
+ */
+
+#ifndef ARCANA_COMMAND_TABLE_HPP
+#define ARCANA_COMMAND_TABLE_HPP
+
+#include "ICommand.hpp"
+#include <cstddef>
+
+namespace arcana {
+
+/**
+ * @brief One (key, handler) pair of a command table
+ */
+struct CommandEntry {
+    CommandKey key;
+    ICommand* command;
+};
+
+/**
+ * @brief Build an entry from a command type exposing `static constexpr CommandKey kKey`
+ */
+template <typename Cmd>
+constexpr CommandEntry commandEntry(Cmd& cmd) {
+    return { Cmd::kKey, &cmd };
+}
+
+/**
+ * @brief Type-erased, read-only view over a CommandTable
+ *
+ * Lets non-template code (registries, dispatchers) hold any table size.
+ * Trivially copyable; a default-constructed view is empty.
+ */
+class CommandTableView {
+public:
+    constexpr CommandTableView() = default;
+    constexpr CommandTableView(ICommand* const* slots, uint16_t rows,
+                               uint16_t cols, uint8_t count)
+        : slots_(slots), rows_(rows), cols_(cols), count_(count) {}
+
+    /**
+     * @brief O(1) lookup by key
+     * @return Command handler, or nullptr if the key is not in the table
+     */
+    ICommand* find(CommandKey key) const {
+        uint16_t row = static_cast<uint8_t>(key.cluster);
+        if (row >= rows_ || key.commandId >= cols_) return nullptr;
+        return slots_[row * cols_ + key.commandId];
+    }
+
+    /** Number of commands in the table */
+    constexpr uint8_t size() const { return count_; }
+
+private:
+    ICommand* const* slots_ = nullptr;
+    uint16_t rows_ = 0;
+    uint16_t cols_ = 0;
+    uint8_t count_ = 0;
+};
+
+/**
+ * @brief Dense [cluster][commandId] dispatch matrix
+ * @tparam Rows Highest cluster value + 1
+ * @tparam Cols Highest command id + 1 (up to 256)
+ *
+ * Construct through makeCommandTable() so the dimensions and the
+ * duplicate-key check are derived from the entry list.
+ */
+template <uint16_t Rows, uint16_t Cols>
+class CommandTable {
+public:
+    template <size_t N>
+    constexpr explicit CommandTable(const CommandEntry (&entries)[N])
+        : slots_{}, count_(static_cast<uint8_t>(N)) {
+        for (size_t i = 0; i < N; i++) {
+            slots_[static_cast<uint8_t>(entries[i].key.cluster) * Cols
+                   + entries[i].key.commandId] = entries[i].command;
+        }
+    }
+
+    ICommand* find(CommandKey key) const { return view().find(key); }
+
+    constexpr uint8_t size() const { return count_; }
+
+    constexpr CommandTableView view() const {
+        return CommandTableView(slots_, Rows, Cols, count_);
+    }
+
+private:
+    ICommand* slots_[Rows * Cols];
+    uint8_t count_;
+};
+
+namespace detail {
+
+template <size_t N>
+constexpr bool commandKeysUnique(const CommandEntry (&entries)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            if (entries[i].key == entries[j].key) return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr bool commandEntriesValid(const CommandEntry (&entries)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        if (entries[i].command == nullptr) return false;
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr uint16_t commandTableRows(const CommandEntry (&entries)[N]) {
+    uint16_t rows = 0;
+    for (size_t i = 0; i < N; i++) {
+        uint16_t r = static_cast<uint16_t>(static_cast<uint8_t>(entries[i].key.cluster) + 1);
+        if (r > rows) rows = r;
+    }
+    return rows;
+}
+
+template <size_t N>
+constexpr uint16_t commandTableCols(const CommandEntry (&entries)[N]) {
+    uint16_t cols = 0;
+    for (size_t i = 0; i < N; i++) {
+        uint16_t c = static_cast<uint16_t>(entries[i].key.commandId + 1);
+        if (c > cols) cols = c;
+    }
+    return cols;
+}
+
+} // namespace detail
+
+/**
+ * @brief Fold a static entry list into a dense CommandTable at compile time
+ * @tparam Entries constexpr CommandEntry array with static storage duration
+ */
+template <const auto& Entries>
+constexpr auto makeCommandTable() {
+    static_assert(detail::commandKeysUnique(Entries), "duplicate CommandKey in command table");
+    static_assert(detail::commandEntriesValid(Entries), "null command in command table");
+    return CommandTable<detail::commandTableRows(Entries),
+                        detail::commandTableCols(Entries)>(Entries);
+}
+
+} // namespace arcana
+
+#endif /* ARCANA_COMMAND_TABLE_HPP */
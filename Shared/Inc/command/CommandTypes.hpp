@@ -42,7 +42,7 @@ struct CommandKey {
     Cluster cluster;
     uint8_t commandId;
 
-    bool operator==(const CommandKey& other) const {
+    constexpr bool operator==(const CommandKey& other) const {
         return cluster == other.cluster && commandId == other.commandId;
     }
 };
@@ -59,6 +59,7 @@ namespace SensorCommand {
     constexpr uint8_t GetTemperature = 0x02;
     constexpr uint8_t GetAccel       = 0x03;
     constexpr uint8_t GetLight       = 0x04;
+    constexpr uint8_t StreamRecords  = 0x10;
 }
 
 namespace DeviceCommand {
@@ -69,6 +70,8 @@ namespace DeviceCommand {
 
 namespace SecurityCommand {
     constexpr uint8_t KeyExchange     = 0x01;
+    constexpr uint8_t SessionTicket   = 0x02;
+    constexpr uint8_t ResumeSession   = 0x03;
 }
 
 /**
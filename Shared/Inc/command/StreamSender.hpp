@@ -0,0 +1,239 @@
+/**
+ * @file StreamSender.hpp
+ * @brief Sliding-window sender for fragmented stream transfers
+ *
+ * Pulls bytes from an IStreamSource, cuts them into ChunkSize chunks and
+ * keeps up to Window chunks in flight. Chunks stay buffered until the
+ * receiver acknowledges them, so loss recovery never re-queries the source:
+ *  - cumulative ACK slides the window
+ *  - SACK bits mark out-of-order chunks received; holes below the highest
+ *    SACKed chunk are retransmitted once right away (no timeout wait)
+ *  - NACK retransmits one chunk
+ *  - RTO retransmits everything still in flight; after maxRetries without
+ *    progress the transfer stalls (kept for RESUME, no more sending)
+ *  - RESUME re-sends from a seq after a reconnect
+ *
+ * Transport-agnostic: framing/encryption is done by the emit callback, and
+ * time is passed in so hosts can drive it deterministically.
+ */
+
+#ifndef ARCANA_STREAM_SENDER_HPP
+#define ARCANA_STREAM_SENDER_HPP
+
+#include "StreamCodec.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace arcana {
+
+/**
+ * @brief Byte source for a stream transfer
+ *
+ * read() fills up to cap bytes. A short read (including 0) marks the end
+ * of the stream.
+ */
+class IStreamSource {
+public:
+    virtual ~IStreamSource() {}
+    virtual size_t read(uint8_t* dst, size_t cap) = 0;
+};
+
+/**
+ * @tparam Window    Chunks in flight (power of two, <= 16 = SACK width)
+ * @tparam ChunkSize Bytes of data per DATA message
+ */
+template <uint8_t Window, uint8_t ChunkSize>
+class StreamSender {
+    static_assert(Window > 0 && Window <= StreamCodec::kSackBits,
+                  "window must fit the SACK bitmap");
+    static_assert((Window & (Window - 1)) == 0,
+                  "window must be a power of two (seq wraps at 2^16)");
+
+public:
+    /** Frame and send one DATA message; return false if the link is busy */
+    typedef bool (*EmitFn)(const uint8_t* payload, size_t len, bool fin, void* ctx);
+
+    enum class State : uint8_t { Idle, Running, Stalled };
+
+    static constexpr size_t kMaxPayload = StreamCodec::kDataHeader + ChunkSize;
+
+    /**
+     * @brief Start a transfer
+     * @param rtoMs      Retransmission timeout
+     * @param maxRetries RTOs without progress before stalling
+     */
+    void begin(uint8_t xferId, IStreamSource* src, uint32_t nowMs,
+               uint32_t rtoMs = 1000, uint8_t maxRetries = 5) {
+        mXferId = xferId;
+        mSource = src;
+        mBase = 0;
+        mProduced = 0;
+        mEof = false;
+        mRtoMs = rtoMs;
+        mMaxRetries = maxRetries;
+        mRetries = 0;
+        mLastProgressMs = nowMs;
+        mFramesSent = 0;
+        mRetransmits = 0;
+        for (uint8_t i = 0; i < Window; i++) mSlots[i].status = SlotStatus::Empty;
+        mState = src ? State::Running : State::Idle;
+    }
+
+    /**
+     * @brief Refill the window and transmit every pending chunk
+     * @return Number of DATA messages emitted
+     */
+    uint8_t pump(uint32_t nowMs, EmitFn emit, void* ctx) {
+        if (mState != State::Running) return 0;
+        fill();
+
+        if (mBase != mProduced && nowMs - mLastProgressMs >= mRtoMs) {
+            if (++mRetries > mMaxRetries) {
+                mState = State::Stalled;
+                return 0;
+            }
+            for (uint16_t s = mBase; s != mProduced; s++) {
+                Slot& sl = slot(s);
+                if (sl.status == SlotStatus::InFlight) {
+                    sl.status = SlotStatus::Pending;
+                    mRetransmits++;
+                }
+            }
+            mLastProgressMs = nowMs;
+        }
+
+        uint8_t sent = 0;
+        uint8_t payload[kMaxPayload];
+        for (uint16_t s = mBase; s != mProduced; s++) {
+            Slot& sl = slot(s);
+            if (sl.status != SlotStatus::Pending) continue;
+            size_t len = StreamCodec::writeData(payload, sizeof(payload), mXferId, s,
+                                                sl.data, sl.len);
+            bool fin = mEof && static_cast<uint16_t>(s + 1) == mProduced;
+            if (!emit(payload, len, fin, ctx)) break;
+            sl.status = SlotStatus::InFlight;
+            mFramesSent++;
+            sent++;
+        }
+        return sent;
+    }
+
+    /**
+     * @brief Apply an ACK / NACK / RESUME / ABORT from the receiver
+     * @return false if the message is not for this transfer
+     */
+    bool onControl(const StreamMessage& msg, uint32_t nowMs) {
+        if (mState == State::Idle || msg.xferId != mXferId) return false;
+
+        switch (msg.type) {
+        case StreamCodec::kAck: {
+            if (!inWindow(msg.seq, true)) return false;
+            if (msg.seq != mBase) {
+                mBase = msg.seq;
+                mRetries = 0;
+                mLastProgressMs = nowMs;
+            }
+            // Selective ACKs: mark received, retransmit holes below the highest
+            uint16_t highest = mBase;
+            for (uint8_t i = 0; i < StreamCodec::kSackBits; i++) {
+                if (!(msg.sack & (1u << i))) continue;
+                uint16_t s = static_cast<uint16_t>(mBase + 1 + i);
+                if (!inWindow(s, false)) break;
+                slot(s).status = SlotStatus::Acked;
+                highest = s;
+                mLastProgressMs = nowMs;
+            }
+            for (uint16_t s = mBase; s != highest; s++) {
+                Slot& sl = slot(s);
+                if (sl.status == SlotStatus::InFlight && !sl.fastRetx) {
+                    sl.status = SlotStatus::Pending;
+                    sl.fastRetx = true;
+                    mRetransmits++;
+                }
+            }
+            if (mEof && mBase == mProduced) mState = State::Idle;  // complete
+            return true;
+        }
+        case StreamCodec::kNack: {
+            if (!inWindow(msg.seq, false)) return false;
+            Slot& sl = slot(msg.seq);
+            if (sl.status == SlotStatus::InFlight) {
+                sl.status = SlotStatus::Pending;
+                mRetransmits++;
+            }
+            return true;
+        }
+        case StreamCodec::kResume: {
+            // Everything below fromSeq is held by the receiver
+            if (inWindow(msg.seq, true)) mBase = msg.seq;
+            for (uint16_t s = mBase; s != mProduced; s++) {
+                if (slot(s).status != SlotStatus::Acked) slot(s).status = SlotStatus::Pending;
+            }
+            mRetries = 0;
+            mLastProgressMs = nowMs;
+            mState = (mEof && mBase == mProduced) ? State::Idle : State::Running;
+            return true;
+        }
+        case StreamCodec::kAbort:
+            mState = State::Idle;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    State state() const { return mState; }
+    bool running() const { return mState == State::Running; }
+    uint8_t xferId() const { return mXferId; }
+    uint32_t framesSent() const { return mFramesSent; }
+    uint32_t retransmits() const { return mRetransmits; }
+
+private:
+    enum class SlotStatus : uint8_t { Empty, Pending, InFlight, Acked };
+
+    struct Slot {
+        uint8_t data[ChunkSize];
+        uint8_t len;
+        SlotStatus status;
+        bool fastRetx;     // SACK hole already retransmitted once
+    };
+
+    Slot& slot(uint16_t seq) { return mSlots[seq & (Window - 1)]; }
+
+    /** seq in [base, produced) — or [base, produced] when allowEnd */
+    bool inWindow(uint16_t seq, bool allowEnd) const {
+        uint16_t off = static_cast<uint16_t>(seq - mBase);
+        uint16_t span = static_cast<uint16_t>(mProduced - mBase);
+        return allowEnd ? off <= span : off < span;
+    }
+
+    void fill() {
+        while (!mEof && static_cast<uint16_t>(mProduced - mBase) < Window) {
+            Slot& sl = slot(mProduced);
+            size_t n = mSource->read(sl.data, ChunkSize);
+            sl.len = static_cast<uint8_t>(n);
+            sl.status = SlotStatus::Pending;
+            sl.fastRetx = false;
+            if (n < ChunkSize) mEof = true;
+            mProduced++;
+        }
+    }
+
+    Slot mSlots[Window] = {};
+    IStreamSource* mSource = nullptr;
+    uint16_t mBase = 0;        // oldest unacknowledged seq
+    uint16_t mProduced = 0;    // next seq to read from the source
+    uint32_t mRtoMs = 1000;
+    uint32_t mLastProgressMs = 0;
+    uint32_t mFramesSent = 0;
+    uint32_t mRetransmits = 0;
+    uint8_t mMaxRetries = 5;
+    uint8_t mRetries = 0;
+    uint8_t mXferId = 0;
+    bool mEof = false;
+    State mState = State::Idle;
+};
+
+} // namespace arcana
+
+#endif /* ARCANA_STREAM_SENDER_HPP */
@@ -0,0 +1,171 @@
+/**
+ * @file BatchCodec.hpp
+ * @brief v2 batched command envelope (header-only, static methods)
+ *
+ * Carries N requests (or N responses) in one frame payload so a client
+ * pays one BLE/MQTT round trip — and one nonce + HMAC — per batch instead
+ * of per command. Each entry has a client-chosen correlation id; responses
+ * echo it and may arrive in any order or be omitted when the response
+ * frame is full (client retries the missing ids).
+ *
+ * Body format (after FrameCodec deframe / decrypt):
+ *   [ver:1=0x02][count:1] entry*count
+ *   request  entry: [reqId][cluster][cmdId][plen][params:plen]
+ *   response entry: [reqId][cluster][cmdId][status][dlen][data:dlen]
+ *
+ * v1 single-command payloads are unchanged; the stream id selects v2.
+ *
+ * v2 batches more commands per frame; it does not carry bigger ones.
+ * Request params are capped at kMaxParams (sizeof CommandRequest::params,
+ * the v1 limit): the writer refuses longer entries and the bridge answers
+ * them with InvalidParam. Response data is capped by the response frame.
+ */
+
+#ifndef ARCANA_BATCH_CODEC_HPP
+#define ARCANA_BATCH_CODEC_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "CommandTypes.hpp"
+
+namespace arcana {
+
+/**
+ * @brief One decoded batch entry (request or response)
+ *
+ * `data` points into the source buffer — no copy is made.
+ */
+struct BatchEntry {
+    uint8_t reqId = 0;
+    CommandKey key = {};
+    CommandStatus status = CommandStatus::Success;  // responses only
+    const uint8_t* data = nullptr;                   // params or response data
+    uint8_t length = 0;
+};
+
+class BatchCodec {
+public:
+    static constexpr uint8_t kVersion        = 0x02;
+    static constexpr size_t  kHeaderSize     = 2;   /* ver + count */
+    static constexpr size_t  kRequestHeader  = 4;   /* reqId cluster cmdId plen */
+    static constexpr size_t  kResponseHeader = 5;   /* reqId cluster cmdId status dlen */
+    static constexpr uint8_t kMaxEntries     = 16;
+    static constexpr uint8_t kMaxParams      = sizeof(CommandRequest::params);
+
+    /* ── Reader ──────────────────────────────────────────────────────── */
+
+    /**
+     * @brief Validate the batch header
+     * @param count  [out] Declared entry count
+     * @param offset [out] Offset of the first entry
+     * @return true if version matches and count is within kMaxEntries
+     */
+    static bool beginRead(const uint8_t* buf, size_t len,
+                          uint8_t& count, size_t& offset) {
+        if (len < kHeaderSize || buf[0] != kVersion) return false;
+        if (buf[1] > kMaxEntries) return false;
+        count = buf[1];
+        offset = kHeaderSize;
+        return true;
+    }
+
+    /**
+     * @brief Decode the request entry at offset and advance past it
+     * @return false if the entry is truncated
+     */
+    static bool readRequest(const uint8_t* buf, size_t len,
+                            size_t& offset, BatchEntry& out) {
+        if (offset + kRequestHeader > len) return false;
+        const uint8_t* p = buf + offset;
+        uint8_t plen = p[3];
+        if (offset + kRequestHeader + plen > len) return false;
+        out.reqId         = p[0];
+        out.key.cluster   = static_cast<Cluster>(p[1]);
+        out.key.commandId = p[2];
+        out.status        = CommandStatus::Success;
+        out.data          = p + kRequestHeader;
+        out.length        = plen;
+        offset += kRequestHeader + plen;
+        return true;
+    }
+
+    /**
+     * @brief Decode the response entry at offset and advance past it
+     * @return false if the entry is truncated
+     */
+    static bool readResponse(const uint8_t* buf, size_t len,
+                             size_t& offset, BatchEntry& out) {
+        if (offset + kResponseHeader > len) return false;
+        const uint8_t* p = buf + offset;
+        uint8_t dlen = p[4];
+        if (offset + kResponseHeader + dlen > len) return false;
+        out.reqId         = p[0];
+        out.key.cluster   = static_cast<Cluster>(p[1]);
+        out.key.commandId = p[2];
+        out.status        = static_cast<CommandStatus>(p[3]);
+        out.data          = p + kResponseHeader;
+        out.length        = dlen;
+        offset += kResponseHeader + dlen;
+        return true;
+    }
+
+    /* ── Writer ──────────────────────────────────────────────────────── */
+
+    /**
+     * @brief Write an empty batch header
+     * @param offset [out] Write cursor, positioned after the header
+     */
+    static bool beginWrite(uint8_t* buf, size_t cap, size_t& offset) {
+        if (cap < kHeaderSize) return false;
+        buf[0] = kVersion;
+        buf[1] = 0;
+        offset = kHeaderSize;
+        return true;
+    }
+
+    /**
+     * @brief Append a request entry and bump the header count
+     * @return false if it does not fit or plen > kMaxParams
+     *         (buffer is left unchanged)
+     */
+    static bool writeRequest(uint8_t* buf, size_t cap, size_t& offset,
+                             uint8_t reqId, CommandKey key,
+                             const uint8_t* params, uint8_t plen) {
+        if (buf[1] >= kMaxEntries || plen > kMaxParams) return false;
+        if (offset + kRequestHeader + plen > cap) return false;
+        uint8_t* p = buf + offset;
+        p[0] = reqId;
+        p[1] = static_cast<uint8_t>(key.cluster);
+        p[2] = key.commandId;
+        p[3] = plen;
+        if (plen > 0) memcpy(p + kRequestHeader, params, plen);
+        offset += kRequestHeader + plen;
+        buf[1]++;
+        return true;
+    }
+
+    /**
+     * @brief Append a response entry and bump the header count
+     * @return false if it does not fit (buffer is left unchanged)
+     */
+    static bool writeResponse(uint8_t* buf, size_t cap, size_t& offset,
+                              uint8_t reqId, const CommandResponseModel& rsp) {
+        if (buf[1] >= kMaxEntries) return false;
+        if (offset + kResponseHeader + rsp.dataLength > cap) return false;
+        uint8_t* p = buf + offset;
+        p[0] = reqId;
+        p[1] = static_cast<uint8_t>(rsp.key.cluster);
+        p[2] = rsp.key.commandId;
+        p[3] = static_cast<uint8_t>(rsp.status);
+        p[4] = rsp.dataLength;
+        if (rsp.dataLength > 0) memcpy(p + kResponseHeader, rsp.data, rsp.dataLength);
+        offset += kResponseHeader + rsp.dataLength;
+        buf[1]++;
+        return true;
+    }
+};
+
+} // namespace arcana
+
+#endif /* ARCANA_BATCH_CODEC_HPP */
@@ -18,7 +18,7 @@ namespace arcana {
 
 class FrameAssembler {
 public:
-    static constexpr uint16_t MAX_FRAME = 112;  // KE response: 100B payload + 9B frame
+    static constexpr uint16_t MAX_FRAME = 128;  // v2 batch request: 119B payload + 9B frame
 
     FrameAssembler() { reset(); }
 
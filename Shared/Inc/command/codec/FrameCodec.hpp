@@ -47,7 +47,8 @@ public:
      * @param payloadLen Payload length
      * @param flags     Frame flags (kFlagFin for single-frame)
      * @param streamId  Stream ID (kSidNone for no stream)
-     * @param outBuf    Destination buffer (must be >= payloadLen + kOverhead)
+     * @param outBuf    Destination buffer (must be >= payloadLen + kOverhead);
+     *                  payload may already sit at outBuf + kHeaderSize (framed in place)
      * @param outBufSize Size of outBuf
      * @param outLen    [out] Total frame length written
      * @return true on success
@@ -70,7 +71,7 @@ public:
         outBuf[kOffLenHi]  = static_cast<uint8_t>((payloadLen >> 8) & 0xFF);
 
         /* Payload */
-        if (payloadLen > 0) {
+        if (payloadLen > 0 && payload != outBuf + kHeaderSize) {
             memcpy(outBuf + kHeaderSize, payload, payloadLen);
         }
 
@@ -0,0 +1,146 @@
+/**
+ * @file StreamCodec.hpp
+ * @brief Fragmented stream messages carried inside FrameCodec payloads
+ *        (header-only, static methods)
+ *
+ * A transfer splits a large payload into sequenced DATA chunks; the last
+ * chunk's frame carries FrameCodec::kFlagFin. The receiver drives flow
+ * control with cumulative + selective ACKs, explicit NACKs and RESUME.
+ *
+ * Message format (first byte = type):
+ *   DATA   [0x01][xferId][seq:2 LE][chunk:N]
+ *   ACK    [0x02][xferId][cumAck:2 LE][sack:2 LE]
+ *            cumAck = next expected seq (all below received)
+ *            sack bit i = seq cumAck+1+i received
+ *   NACK   [0x03][xferId][seq:2 LE]       retransmit one chunk
+ *   RESUME [0x04][xferId][fromSeq:2 LE]   restart after link loss
+ *   ABORT  [0x05][xferId]                 cancel the transfer
+ */
+
+#ifndef ARCANA_STREAM_CODEC_HPP
+#define ARCANA_STREAM_CODEC_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace arcana {
+
+/**
+ * @brief One decoded stream message
+ *
+ * `seq` holds the DATA/NACK seq, the ACK cumulative seq, or the RESUME
+ * start seq. `data` points into the source buffer.
+ */
+struct StreamMessage {
+    uint8_t type = 0;
+    uint8_t xferId = 0;
+    uint16_t seq = 0;
+    uint16_t sack = 0;
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+};
+
+class StreamCodec {
+public:
+    static constexpr uint8_t kData   = 0x01;
+    static constexpr uint8_t kAck    = 0x02;
+    static constexpr uint8_t kNack   = 0x03;
+    static constexpr uint8_t kResume = 0x04;
+    static constexpr uint8_t kAbort  = 0x05;
+
+    static constexpr size_t kDataHeader = 4;   /* type xferId seq:2 */
+    static constexpr size_t kAckSize    = 6;
+    static constexpr size_t kSeqMsgSize = 4;   /* NACK / RESUME */
+    static constexpr size_t kAbortSize  = 2;
+    static constexpr uint8_t kSackBits  = 16;
+
+    static size_t writeData(uint8_t* buf, size_t cap, uint8_t xferId,
+                            uint16_t seq, const uint8_t* chunk, size_t len) {
+        if (kDataHeader + len > cap) return 0;
+        writeHeader(buf, kData, xferId, seq);
+        if (len > 0) memcpy(buf + kDataHeader, chunk, len);
+        return kDataHeader + len;
+    }
+
+    static size_t writeAck(uint8_t* buf, size_t cap, uint8_t xferId,
+                           uint16_t cumAck, uint16_t sack) {
+        if (cap < kAckSize) return 0;
+        writeHeader(buf, kAck, xferId, cumAck);
+        buf[4] = static_cast<uint8_t>(sack & 0xFF);
+        buf[5] = static_cast<uint8_t>(sack >> 8);
+        return kAckSize;
+    }
+
+    static size_t writeNack(uint8_t* buf, size_t cap, uint8_t xferId, uint16_t seq) {
+        if (cap < kSeqMsgSize) return 0;
+        writeHeader(buf, kNack, xferId, seq);
+        return kSeqMsgSize;
+    }
+
+    static size_t writeResume(uint8_t* buf, size_t cap, uint8_t xferId, uint16_t fromSeq) {
+        if (cap < kSeqMsgSize) return 0;
+        writeHeader(buf, kResume, xferId, fromSeq);
+        return kSeqMsgSize;
+    }
+
+    static size_t writeAbort(uint8_t* buf, size_t cap, uint8_t xferId) {
+        if (cap < kAbortSize) return 0;
+        buf[0] = kAbort;
+        buf[1] = xferId;
+        return kAbortSize;
+    }
+
+    /**
+     * @brief Decode any stream message
+     * @return false on unknown type or short buffer
+     */
+    static bool parse(const uint8_t* buf, size_t len, StreamMessage& out) {
+        if (len < kAbortSize) return false;
+        out.type = buf[0];
+        out.xferId = buf[1];
+        out.seq = 0;
+        out.sack = 0;
+        out.data = nullptr;
+        out.length = 0;
+
+        switch (out.type) {
+        case kData:
+            if (len < kDataHeader) return false;
+            out.seq = readU16(buf + 2);
+            out.data = buf + kDataHeader;
+            out.length = len - kDataHeader;
+            return true;
+        case kAck:
+            if (len < kAckSize) return false;
+            out.seq = readU16(buf + 2);
+            out.sack = readU16(buf + 4);
+            return true;
+        case kNack:
+        case kResume:
+            if (len < kSeqMsgSize) return false;
+            out.seq = readU16(buf + 2);
+            return true;
+        case kAbort:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+private:
+    static void writeHeader(uint8_t* buf, uint8_t type, uint8_t xferId, uint16_t seq) {
+        buf[0] = type;
+        buf[1] = xferId;
+        buf[2] = static_cast<uint8_t>(seq & 0xFF);
+        buf[3] = static_cast<uint8_t>(seq >> 8);
+    }
+
+    static uint16_t readU16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+};
+
+} // namespace arcana
+
+#endif /* ARCANA_STREAM_CODEC_HPP */
@@ -0,0 +1,56 @@
+/**
+ * @file P256.hpp
+ * @brief NIST P-256 for key exchange and registration — keygen, ECDH, ECDSA verify
+ *
+ * One backend on top of micro-ecc's field arithmetic (secp256r1 fast
+ * reduction; on the F103 the unrolled Thumb-2 UMULL multiply, see the
+ * uECC_* defines in .cproject). Keys and secrets use uECC's byte layout:
+ * private key 32 bytes big-endian, public key X||Y, shared secret X.
+ *
+ * Fixed base (key generation): Lim-Lee comb, 5 teeth 52 bits apart, 31
+ * affine multiples of G in flash (tools/gen_p256_comb.py). 52 doublings +
+ * 52 additions with the complete Renes-Costello-Batina formulas (a = -3),
+ * so there are no special cases; every table entry is read on every step
+ * and the projective Z is randomised before the final inversion.
+ *
+ * Variable base (ECDH): uECC's Co-Z Montgomery ladder, which already walks
+ * all 257 bits with a fixed sequence of operations and a randomised Z.
+ *
+ * All functions use uECC's RNG (setRng), none of them allocate.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "uECC.h"
+
+namespace arcana {
+namespace crypto {
+
+class P256 {
+public:
+    static constexpr size_t PRIV_SIZE   = 32;
+    static constexpr size_t PUB_SIZE    = 64;
+    static constexpr size_t SECRET_SIZE = 32;
+    static constexpr size_t SIG_SIZE    = 64;
+
+    static void setRng(uECC_RNG_Function rng) { uECC_set_rng(rng); }
+
+    /** Fresh key pair, 0 < priv < n. @return false if the RNG failed */
+    static bool makeKey(uint8_t pub[PUB_SIZE], uint8_t priv[PRIV_SIZE]);
+
+    /** pub = priv * G via the comb. @return false if priv is 0 or >= n */
+    static bool computePublicKey(const uint8_t priv[PRIV_SIZE], uint8_t pub[PUB_SIZE]);
+
+    /** secret = X(priv * pub). @return false if pub is not on the curve */
+    static bool sharedSecret(const uint8_t pub[PUB_SIZE], const uint8_t priv[PRIV_SIZE],
+                             uint8_t secret[SECRET_SIZE]);
+
+    /** ECDSA verify of r||s over a message hash */
+    static bool verify(const uint8_t pub[PUB_SIZE], const uint8_t* hash, size_t hashLen,
+                       const uint8_t sig[SIG_SIZE]);
+};
+
+} // namespace crypto
+} // namespace arcana
@@ -4,6 +4,9 @@
  *
  * Zero mbedtls dependency. All stack-based, no heap allocation.
  * Based on FIPS 180-4 / RFC 2104 / RFC 5869.
+ *
+ * HmacSha256 keeps the two pad midstates of a key, for keys that MAC
+ * more than one message (session keys, HKDF PRK, file/image streams).
  */
 
 #pragma once
@@ -29,67 +32,21 @@ public:
         final(ctx, out);
     }
 
-    // ─── HMAC-SHA256 ────────────────────────────────────────────────────
+    // ─── HMAC-SHA256 (one-shot, see HmacSha256 to reuse a key) ─────────
 
     static void hmac(const uint8_t* key, size_t keyLen,
                      const uint8_t* data, size_t dataLen,
-                     uint8_t out[HASH_SIZE]) {
-        uint8_t kBlock[BLOCK_SIZE] = {};
-
-        // Key preparation
-        if (keyLen > BLOCK_SIZE) {
-            hash(key, keyLen, kBlock);
-        } else {
-            memcpy(kBlock, key, keyLen);
-        }
-
-        // Inner hash: SHA256((key ^ ipad) || data)
-        uint8_t iPad[BLOCK_SIZE];
-        for (size_t i = 0; i < BLOCK_SIZE; i++) iPad[i] = kBlock[i] ^ 0x36;
-
-        Context inner;
-        init(inner);
-        update(inner, iPad, BLOCK_SIZE);
-        update(inner, data, dataLen);
-        uint8_t innerHash[HASH_SIZE];
-        final(inner, innerHash);
-
-        // Outer hash: SHA256((key ^ opad) || innerHash)
-        uint8_t oPad[BLOCK_SIZE];
-        for (size_t i = 0; i < BLOCK_SIZE; i++) oPad[i] = kBlock[i] ^ 0x5C;
-
-        Context outer;
-        init(outer);
-        update(outer, oPad, BLOCK_SIZE);
-        update(outer, innerHash, HASH_SIZE);
-        final(outer, out);
-    }
+                     uint8_t out[HASH_SIZE]);
 
     // ─── HKDF-SHA256 (single block, max 32 bytes output) ───────────────
 
     static bool hkdf(const uint8_t* ikm, size_t ikmLen,
                      const uint8_t* salt, size_t saltLen,
                      const uint8_t* info, size_t infoLen,
-                     uint8_t* okm, size_t okmLen) {
-        if (okmLen > HASH_SIZE) return false;
-
-        // Extract: PRK = HMAC-SHA256(salt, ikm)
-        uint8_t prk[HASH_SIZE];
-        hmac(salt, saltLen, ikm, ikmLen, prk);
-
-        // Expand: T(1) = HMAC-SHA256(PRK, info || 0x01)
-        uint8_t expandBuf[128 + 1];
-        if (infoLen > 127) return false;
-        memcpy(expandBuf, info, infoLen);
-        expandBuf[infoLen] = 0x01;
-
-        uint8_t t[HASH_SIZE];
-        hmac(prk, HASH_SIZE, expandBuf, infoLen + 1, t);
-        memcpy(okm, t, okmLen);
-        return true;
-    }
+                     uint8_t* okm, size_t okmLen);
+
+    // ─── SHA-256 streaming (data that does not fit in RAM at once) ─────
 
-private:
     struct Context {
         uint32_t state[8];
         uint8_t  buffer[BLOCK_SIZE];
@@ -106,8 +63,23 @@ private:
         ctx.bufLen = 0;
     }
 
+    /** Resume from a saved state after prefixLen bytes (a multiple of 64) */
+    static void init(Context& ctx, const uint32_t midstate[8], uint64_t prefixLen) {
+        memcpy(ctx.state, midstate, sizeof(ctx.state));
+        ctx.totalLen = prefixLen;
+        ctx.bufLen = 0;
+    }
+
     static void update(Context& ctx, const uint8_t* data, size_t len) {
         ctx.totalLen += len;
+        // Whole blocks straight from the caller's buffer
+        if (ctx.bufLen == 0) {
+            while (len >= BLOCK_SIZE) {
+                transform(ctx.state, data);
+                data += BLOCK_SIZE;
+                len -= BLOCK_SIZE;
+            }
+        }
         while (len > 0) {
             size_t space = BLOCK_SIZE - ctx.bufLen;
             size_t chunk = len < space ? len : space;
@@ -140,15 +112,61 @@ private:
         transform(ctx.state, ctx.buffer);
 
         // Output (big-endian)
-        for (int i = 0; i < 8; i++) {
-            out[i * 4 + 0] = (uint8_t)(ctx.state[i] >> 24);
-            out[i * 4 + 1] = (uint8_t)(ctx.state[i] >> 16);
-            out[i * 4 + 2] = (uint8_t)(ctx.state[i] >> 8);
-            out[i * 4 + 3] = (uint8_t)(ctx.state[i]);
+        for (int i = 0; i < 8; i++) storeBE32(out + i * 4, ctx.state[i]);
+    }
+
+    // ─── Compression function ──────────────────────────────────────────
+
+    /**
+     * One SHA-256 block given as 16 big-endian words. Rounds are unrolled
+     * eight at a time so the working variables never shuffle, and the
+     * message schedule is a 16-word ring instead of w[64].
+     */
+    static void compress(uint32_t state[8], const uint32_t block[16]) {
+        uint32_t w[16];
+        memcpy(w, block, sizeof(w));
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; i += 8) {
+            round(a, b, c, d, e, f, g, h, w, i + 0);
+            round(h, a, b, c, d, e, f, g, w, i + 1);
+            round(g, h, a, b, c, d, e, f, w, i + 2);
+            round(f, g, h, a, b, c, d, e, w, i + 3);
+            round(e, f, g, h, a, b, c, d, w, i + 4);
+            round(d, e, f, g, h, a, b, c, w, i + 5);
+            round(c, d, e, f, g, h, a, b, w, i + 6);
+            round(b, c, d, e, f, g, h, a, w, i + 7);
         }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
     }
 
-    // ─── SHA-256 block transform ────────────────────────────────────────
+    static uint32_t loadBE32(const uint8_t* p) {
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+               ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    }
+
+    static void storeBE32(uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t)(v >> 24);
+        p[1] = (uint8_t)(v >> 16);
+        p[2] = (uint8_t)(v >> 8);
+        p[3] = (uint8_t)v;
+    }
+
+private:
+    static constexpr uint32_t K[64] = {
+        0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
+        0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
+        0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
+        0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
+        0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
+        0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
+        0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
+        0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2,
+    };
 
     static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
     static uint32_t ch(uint32_t x, uint32_t y, uint32_t z)  { return (x & y) ^ (~x & z); }
@@ -158,41 +176,130 @@ private:
     static uint32_t sig0(uint32_t x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
     static uint32_t sig1(uint32_t x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
 
-    static void transform(uint32_t state[8], const uint8_t block[BLOCK_SIZE]) {
-        static constexpr uint32_t K[64] = {
-            0x428a2f98,0x71374491,0xb5c0fbcf,0xe9b5dba5,0x3956c25b,0x59f111f1,0x923f82a4,0xab1c5ed5,
-            0xd807aa98,0x12835b01,0x243185be,0x550c7dc3,0x72be5d74,0x80deb1fe,0x9bdc06a7,0xc19bf174,
-            0xe49b69c1,0xefbe4786,0x0fc19dc6,0x240ca1cc,0x2de92c6f,0x4a7484aa,0x5cb0a9dc,0x76f988da,
-            0x983e5152,0xa831c66d,0xb00327c8,0xbf597fc7,0xc6e00bf3,0xd5a79147,0x06ca6351,0x14292967,
-            0x27b70a85,0x2e1b2138,0x4d2c6dfc,0x53380d13,0x650a7354,0x766a0abb,0x81c2c92e,0x92722c85,
-            0xa2bfe8a1,0xa81a664b,0xc24b8b70,0xc76c51a3,0xd192e819,0xd6990624,0xf40e3585,0x106aa070,
-            0x19a4c116,0x1e376c08,0x2748774c,0x34b0bcb5,0x391c0cb3,0x4ed8aa4a,0x5b9cca4f,0x682e6ff3,
-            0x748f82ee,0x78a5636f,0x84c87814,0x8cc70208,0x90befffa,0xa4506ceb,0xbef9a3f7,0xc67178f2,
-        };
-
-        uint32_t w[64];
-        for (int i = 0; i < 16; i++) {
-            w[i] = ((uint32_t)block[i*4] << 24) | ((uint32_t)block[i*4+1] << 16) |
-                   ((uint32_t)block[i*4+2] << 8) | (uint32_t)block[i*4+3];
-        }
-        for (int i = 16; i < 64; i++) {
-            w[i] = sig1(w[i-2]) + w[i-7] + sig0(w[i-15]) + w[i-16];
+    // Round i: d += T1, h = T1 + T2; the caller rotates the names
+    static inline __attribute__((always_inline))
+    void round(uint32_t a, uint32_t b, uint32_t c, uint32_t& d,
+               uint32_t e, uint32_t f, uint32_t g, uint32_t& h,
+               uint32_t w[16], int i) {
+        if (i >= 16) {
+            w[i & 15] += sig1(w[(i - 2) & 15]) + w[(i - 7) & 15] + sig0(w[(i - 15) & 15]);
         }
+        uint32_t t1 = h + ep1(e) + ch(e, f, g) + K[i] + w[i & 15];
+        d += t1;
+        h = t1 + ep0(a) + maj(a, b, c);
+    }
 
-        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
-        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    static void transform(uint32_t state[8], const uint8_t block[BLOCK_SIZE]) {
+        uint32_t w[16];
+        for (int i = 0; i < 16; i++) w[i] = loadBE32(block + i * 4);
+        compress(state, w);
+    }
+};
+
+/**
+ * HMAC-SHA256 (RFC 2104) with the key schedule done once.
+ *
+ * Key holds the states after the ipad and opad blocks (64 bytes), so a
+ * MAC costs the message blocks plus one outer block: a frame of up to
+ * 55 bytes takes 2 compressions instead of 4. Streams like Sha256::Context, so a
+ * file or firmware image can be authenticated chunk by chunk off the SD.
+ */
+class HmacSha256 {
+public:
+    static constexpr size_t MAC_SIZE = Sha256::HASH_SIZE;
 
-        for (int i = 0; i < 64; i++) {
-            uint32_t t1 = h + ep1(e) + ch(e, f, g) + K[i] + w[i];
-            uint32_t t2 = ep0(a) + maj(a, b, c);
-            h = g; g = f; f = e; e = d + t1;
-            d = c; c = b; b = a; a = t1 + t2;
+    struct Key {
+        uint32_t inner[8];
+        uint32_t outer[8];
+    };
+
+    static void setKey(Key& k, const uint8_t* key, size_t keyLen) {
+        uint8_t pad[Sha256::BLOCK_SIZE] = {};
+        if (keyLen > Sha256::BLOCK_SIZE) {
+            Sha256::hash(key, keyLen, pad);
+        } else {
+            memcpy(pad, key, keyLen);
         }
 
-        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
-        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        uint32_t w[16];
+        for (int i = 0; i < 16; i++) w[i] = Sha256::loadBE32(pad + i * 4) ^ 0x36363636;
+        Sha256::Context c;
+        Sha256::init(c);
+        memcpy(k.inner, c.state, sizeof(k.inner));
+        Sha256::compress(k.inner, w);
+
+        for (int i = 0; i < 16; i++) w[i] ^= 0x36363636 ^ 0x5c5c5c5c;
+        memcpy(k.outer, c.state, sizeof(k.outer));
+        Sha256::compress(k.outer, w);
+
+        memset(pad, 0, sizeof(pad));
+        memset(w, 0, sizeof(w));
     }
+
+    explicit HmacSha256(const Key& k) : mKey(k) { reset(); }
+
+    /** Start a new message under the same key */
+    void reset() { Sha256::init(mCtx, mKey.inner, Sha256::BLOCK_SIZE); }
+
+    void update(const uint8_t* data, size_t len) { Sha256::update(mCtx, data, len); }
+
+    void final(uint8_t out[MAC_SIZE]) {
+        uint8_t inner[Sha256::HASH_SIZE];
+        Sha256::final(mCtx, inner);
+
+        // Outer message is opad || inner: one padded block, built as words
+        uint32_t w[16] = {};
+        for (int i = 0; i < 8; i++) w[i] = Sha256::loadBE32(inner + i * 4);
+        w[8] = 0x80000000;
+        w[15] = (Sha256::BLOCK_SIZE + Sha256::HASH_SIZE) * 8;
+        uint32_t state[8];
+        memcpy(state, mKey.outer, sizeof(state));
+        Sha256::compress(state, w);
+        for (int i = 0; i < 8; i++) Sha256::storeBE32(out + i * 4, state[i]);
+    }
+
+    static void mac(const Key& k, const uint8_t* data, size_t len, uint8_t out[MAC_SIZE]) {
+        HmacSha256 h(k);
+        h.update(data, len);
+        h.final(out);
+    }
+
+private:
+    const Key& mKey;
+    Sha256::Context mCtx;
 };
 
+inline void Sha256::hmac(const uint8_t* key, size_t keyLen,
+                         const uint8_t* data, size_t dataLen,
+                         uint8_t out[HASH_SIZE]) {
+    HmacSha256::Key k;
+    HmacSha256::setKey(k, key, keyLen);
+    HmacSha256::mac(k, data, dataLen, out);
+}
+
+inline bool Sha256::hkdf(const uint8_t* ikm, size_t ikmLen,
+                         const uint8_t* salt, size_t saltLen,
+                         const uint8_t* info, size_t infoLen,
+                         uint8_t* okm, size_t okmLen) {
+    if (okmLen > HASH_SIZE || infoLen > 127) return false;
+
+    // Extract: PRK = HMAC-SHA256(salt, ikm)
+    uint8_t prk[HASH_SIZE];
+    hmac(salt, saltLen, ikm, ikmLen, prk);
+
+    // Expand: T(1) = HMAC-SHA256(PRK, info || 0x01), info streamed in place
+    HmacSha256::Key k;
+    HmacSha256::setKey(k, prk, HASH_SIZE);
+    HmacSha256 h(k);
+    const uint8_t one = 0x01;
+    h.update(info, infoLen);
+    h.update(&one, 1);
+    uint8_t t[HASH_SIZE];
+    h.final(t);
+    memcpy(okm, t, okmLen);
+    memset(prk, 0, sizeof(prk));
+    return true;
+}
+
 } // namespace crypto
 } // namespace arcana
@@ -213,6 +213,9 @@ static const uint16_t OTA_CRC_RESULT        = 0x0A1D;
 static const uint16_t OTA_META_FAIL         = 0x0A1E;
 static const uint16_t OTA_FLAG_SET          = 0x0A1F;
 static const uint16_t OTA_RESETTING         = 0x0A20;
+static const uint16_t OTA_DELTA_START       = 0x0A21;  // p=patch bytes
+static const uint16_t OTA_DELTA_BAD_PATCH   = 0x0A22;
+static const uint16_t OTA_DELTA_WRONG_BASE  = 0x0A23;  // p=running image CRC
 
 // ---------------------------------------------------------------------------
 // CMD  (0x0B00 - 0x0BFF)
@@ -225,6 +228,9 @@ static const uint16_t CMD_BRIDGE_START      = 0x0B11;
 static const uint16_t CMD_BAD_FRAME         = 0x0B12;
 static const uint16_t CMD_RX               = 0x0B13;
 static const uint16_t CMD_RSP              = 0x0B14;
+static const uint16_t CMD_SESSION_RESUMED  = 0x0B15;  // p=source
+static const uint16_t CMD_RESUME_REJECTED  = 0x0B16;  // p=source
+static const uint16_t CMD_STACK_FREE       = 0x0B17;  // p=bridge stack high-water mark (words)
 
 // ---------------------------------------------------------------------------
 // Upload  (0x0C00 - 0x0CFF)
@@ -253,6 +259,11 @@ static const uint16_t UPL_READ_FAIL       = 0x0C15;  // p=offset
 static const uint16_t UPL_SEND_FAIL       = 0x0C16;  // p=offset
 static const uint16_t UPL_PROGRESS        = 0x0C17;  // p=bytes sent
 static const uint16_t UPL_CANCELLED       = 0x0C18;
+static const uint16_t UPL_STREAM_RATE     = 0x0C19;  // p=body bytes/s
+static const uint16_t UPL_STREAM_STALLS   = 0x0C1A;  // p=(sd stalls << 16) | read retries
+static const uint16_t UPL_CHUNKS_MISSING  = 0x0C1B;  // p=(missing << 16) | chunks
+static const uint16_t UPL_NO_MANIFEST     = 0x0C1C;  // server lacks /manifest → whole file
+static const uint16_t UPL_MANIFEST_FAIL   = 0x0C1D;  // p=attempt
 
 // ---------------------------------------------------------------------------
 // Registration  (0x0D00 - 0x0DFF)
@@ -315,6 +326,7 @@ static const uint16_t WIFI_BAUD_460K_FAIL = 0x0320;
 static const uint16_t WIFI_BAUD_921K_FAIL = 0x0321;
 static const uint16_t WIFI_BAUD_SET       = 0x0322;
 static const uint16_t WIFI_VERSION        = 0x0323;
+static const uint16_t WIFI_MUX_FAIL       = 0x0324;
 
 // ---------------------------------------------------------------------------
 // MQTT extra  (0x0820 - 0x083F)
@@ -327,6 +339,14 @@ static const uint16_t MQTT_NO_CONNACK     = 0x0824;
 static const uint16_t MQTT_CONNACK        = 0x0825;  // p=rc
 static const uint16_t MQTT_SUB_RESULT     = 0x0826;  // p=rc
 static const uint16_t MQTT_CREDS_CLEAR    = 0x0827;
+static const uint16_t MQTT_RX_DESYNC      = 0x0828;  // p=bytes dropped
+static const uint16_t MQTT_RX_OVERSIZE    = 0x0829;  // p=packet bytes
+static const uint16_t MQTT_BACKFILL_START = 0x082A;  // p=blocks behind
+static const uint16_t MQTT_BACKFILL_DONE  = 0x082B;  // p=records replayed
+static const uint16_t MQTT_BACKFILL_SKIP  = 0x082C;  // p=blocks given up (gap cap)
+static const uint16_t MQTT_RX_LATENCY     = 0x082D;  // p=ms from +IPD to command dispatch
+static const uint16_t MQTT_PUBACK_TIMEOUT = 0x082E;  // p=PUBLISHes in flight
+static const uint16_t MQTT_INFLIGHT_DROP  = 0x082F;  // p=responses unacknowledged at disconnect
 
 // ---------------------------------------------------------------------------
 // ATS extra  (0x0660 - 0x067F)
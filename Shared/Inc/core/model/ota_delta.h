@@ -0,0 +1,226 @@
+/**
+ * @file ota_delta.h
+ * @brief Delta OTA patch format + streaming applier (App + Bootloader)
+ *
+ * Pure C header - no C++ dependencies, no heap.
+ * The App validates a downloaded patch against the running image; the
+ * Bootloader rebuilds the new image from app flash + patch.
+ *
+ * File on SD card: fw_patch.bin = ota_delta_header_t + op stream
+ *
+ * Each op starts with varint (len << 2 | kind):
+ *   COPY     zigzag varint source delta, relative to the end of the last
+ *            COPY; copies len bytes of the running image
+ *   LITERAL  len raw bytes
+ *   FILL     one byte, repeated len times (erased 0xFF / zeroed regions)
+ *
+ * The applier holds a 32-byte lookahead plus a caller-supplied staging
+ * buffer; COPY streams straight from the (memory-mapped) source image.
+ * Patches are produced by tools/ota_delta.py.
+ */
+
+#ifndef ARCANA_OTA_DELTA_H
+#define ARCANA_OTA_DELTA_H
+
+#include "ota_header.h"
+#include "Crc32.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define OTA_DELTA_MAGIC     0x50445241u  /* "ARDP" (Arcana Delta Patch) */
+#define OTA_DELTA_VERSION   1u
+#define OTA_PATCH_FILENAME  "fw_patch.bin"
+
+/* ota_meta_t.flags: fw_size/crc32 describe the image the patch rebuilds */
+#define OTA_META_FLAG_DELTA 0x01u
+
+enum {
+    OTA_DELTA_OP_COPY    = 0,
+    OTA_DELTA_OP_LITERAL = 1,
+    OTA_DELTA_OP_FILL    = 2
+};
+
+enum {
+    OTA_DELTA_OK          =  0,
+    OTA_DELTA_ERR_HEADER  = -1,  /* bad magic/version/CRC/sizes */
+    OTA_DELTA_ERR_SOURCE  = -2,  /* running image is not the patch base */
+    OTA_DELTA_ERR_CORRUPT = -3,  /* bad op, out-of-range copy, truncated */
+    OTA_DELTA_ERR_IO      = -4,  /* write callback failed */
+    OTA_DELTA_ERR_TARGET  = -5   /* rebuilt image CRC mismatch */
+};
+
+/**
+ * @brief Patch header
+ *
+ * Layout: 28 bytes, packed, little-endian
+ * hdr_crc covers bytes [0..23]
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;          /**< Must be OTA_DELTA_MAGIC */
+    uint8_t  version;        /**< Patch format version (currently 1) */
+    uint8_t  reserved[3];    /**< Reserved, set to 0 */
+    uint32_t src_size;       /**< Size of the image the patch applies to */
+    uint32_t src_crc32;      /**< CRC-32 IEEE of that image */
+    uint32_t dst_size;       /**< Size of the rebuilt image */
+    uint32_t dst_crc32;      /**< CRC-32 IEEE of the rebuilt image */
+    uint32_t hdr_crc;        /**< CRC-32 of this struct [0..23] */
+} ota_delta_header_t;
+
+#define OTA_DELTA_HDR_CRC_OFFSET  24u
+
+/** Patch bytes after the header; returns bytes read, <= 0 at end/error */
+typedef int (*ota_delta_read_fn)(void* ctx, uint8_t* buf, uint32_t len);
+/** Next bytes of the rebuilt image, in order; returns 0 on success */
+typedef int (*ota_delta_write_fn)(void* ctx, const uint8_t* buf, uint32_t len);
+
+typedef struct {
+    ota_delta_read_fn  read;
+    ota_delta_write_fn write;
+    void*              ctx;
+    const uint8_t*     src;       /**< Running image (app flash) */
+    uint8_t*           buf;       /**< Staging for LITERAL/FILL */
+    uint32_t           buf_size;
+} ota_delta_io_t;
+
+/**
+ * @brief Validate header fields and self-CRC
+ * @return OTA_DELTA_OK or OTA_DELTA_ERR_HEADER
+ */
+static inline int ota_delta_check_header(const ota_delta_header_t* h) {
+    if (h->magic != OTA_DELTA_MAGIC || h->version != OTA_DELTA_VERSION) {
+        return OTA_DELTA_ERR_HEADER;
+    }
+    if (~crc32_calc(0xFFFFFFFFu, (const uint8_t*)h, OTA_DELTA_HDR_CRC_OFFSET)
+            != h->hdr_crc) {
+        return OTA_DELTA_ERR_HEADER;
+    }
+    if (h->src_size == 0 || h->src_size > APP_FLASH_SIZE ||
+        h->dst_size == 0 || h->dst_size > APP_FLASH_SIZE) {
+        return OTA_DELTA_ERR_HEADER;
+    }
+    return OTA_DELTA_OK;
+}
+
+/* ---- Internal: buffered patch reader ---- */
+typedef struct {
+    ota_delta_io_t* io;
+    uint8_t         la[32];
+    uint8_t         pos;
+    uint8_t         len;
+} ota_delta_reader_t;
+
+static inline int ota_delta__byte(ota_delta_reader_t* r, uint8_t* b) {
+    if (r->pos == r->len) {
+        int n = r->io->read(r->io->ctx, r->la, sizeof(r->la));
+        if (n <= 0) return -1;
+        r->len = (uint8_t)n;
+        r->pos = 0;
+    }
+    *b = r->la[r->pos++];
+    return 0;
+}
+
+static inline int ota_delta__take(ota_delta_reader_t* r, uint8_t* out, uint32_t len) {
+    uint32_t got = 0;
+    while (got < len && r->pos < r->len) out[got++] = r->la[r->pos++];
+    while (got < len) {
+        int n = r->io->read(r->io->ctx, out + got, len - got);
+        if (n <= 0) return -1;
+        got += (uint32_t)n;
+    }
+    return 0;
+}
+
+static inline int ota_delta__varint(ota_delta_reader_t* r, uint32_t* v) {
+    uint32_t x = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t b;
+        if (ota_delta__byte(r, &b) != 0) return -1;
+        x |= (uint32_t)(b & 0x7Fu) << shift;
+        if (!(b & 0x80u)) { *v = x; return 0; }
+    }
+    return -1;
+}
+
+/**
+ * @brief Rebuild the target image from io->src + the op stream
+ *
+ * Checks the source CRC first, so a patch for another build is rejected
+ * before anything is written. The caller still owns what was written
+ * on failure (e.g. a partial firmware.bin to delete).
+ *
+ * @param io Callbacks, source image and staging buffer (>= 1 byte)
+ * @param h  Header already read from the patch
+ * @return OTA_DELTA_OK or a negative OTA_DELTA_ERR_*
+ */
+static inline int ota_delta_apply(ota_delta_io_t* io, const ota_delta_header_t* h) {
+    if (ota_delta_check_header(h) != OTA_DELTA_OK) return OTA_DELTA_ERR_HEADER;
+    if (!io->buf || io->buf_size == 0) return OTA_DELTA_ERR_IO;
+    if (~crc32_calc(0xFFFFFFFFu, io->src, h->src_size) != h->src_crc32) {
+        return OTA_DELTA_ERR_SOURCE;
+    }
+
+    ota_delta_reader_t r;
+    r.io = io;
+    r.pos = 0;
+    r.len = 0;
+
+    uint32_t out = 0;
+    uint32_t src_pos = 0;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    while (out < h->dst_size) {
+        uint32_t op;
+        if (ota_delta__varint(&r, &op) != 0) return OTA_DELTA_ERR_CORRUPT;
+        uint32_t kind = op & 3u;
+        uint32_t len = op >> 2;
+        if (len == 0 || len > h->dst_size - out) return OTA_DELTA_ERR_CORRUPT;
+
+        if (kind == OTA_DELTA_OP_COPY) {
+            uint32_t z;
+            if (ota_delta__varint(&r, &z) != 0) return OTA_DELTA_ERR_CORRUPT;
+            /* zigzag: 0,-1,1,-2,... → 0,1,2,3,... */
+            uint32_t from = (z & 1u) ? src_pos - ((z >> 1) + 1u) : src_pos + (z >> 1);
+            if ((z & 1u) && (z >> 1) >= src_pos) return OTA_DELTA_ERR_CORRUPT;
+            if (from > h->src_size || len > h->src_size - from) {
+                return OTA_DELTA_ERR_CORRUPT;
+            }
+            crc = crc32_calc(crc, io->src + from, len);
+            if (io->write(io->ctx, io->src + from, len) != 0) return OTA_DELTA_ERR_IO;
+            src_pos = from + len;
+        } else if (kind == OTA_DELTA_OP_LITERAL || kind == OTA_DELTA_OP_FILL) {
+            uint8_t fill = 0;
+            if (kind == OTA_DELTA_OP_FILL && ota_delta__byte(&r, &fill) != 0) {
+                return OTA_DELTA_ERR_CORRUPT;
+            }
+            uint32_t left = len;
+            while (left > 0) {
+                uint32_t n = left < io->buf_size ? left : io->buf_size;
+                if (kind == OTA_DELTA_OP_LITERAL) {
+                    if (ota_delta__take(&r, io->buf, n) != 0) return OTA_DELTA_ERR_CORRUPT;
+                } else {
+                    for (uint32_t i = 0; i < n; i++) io->buf[i] = fill;
+                }
+                crc = crc32_calc(crc, io->buf, n);
+                if (io->write(io->ctx, io->buf, n) != 0) return OTA_DELTA_ERR_IO;
+                left -= n;
+            }
+        } else {
+            return OTA_DELTA_ERR_CORRUPT;
+        }
+        out += len;
+    }
+
+    if (~crc != h->dst_crc32) return OTA_DELTA_ERR_TARGET;
+    return OTA_DELTA_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARCANA_OTA_DELTA_H */
@@ -52,7 +52,8 @@ extern "C" {
 typedef struct __attribute__((packed)) {
     uint32_t magic;          /**< Must be OTA_META_MAGIC (0x41524F54) */
     uint8_t  version;        /**< Metadata format version (currently 1) */
-    uint8_t  reserved[3];    /**< Reserved, set to 0 */
+    uint8_t  flags;          /**< OTA_META_FLAG_* (0 = full image) */
+    uint8_t  reserved[2];    /**< Reserved, set to 0 */
     uint32_t fw_size;        /**< firmware.bin size in bytes */
     uint32_t crc32;          /**< CRC-32 IEEE of firmware.bin (~crc32(0xFFFFFFFF,...)) */
     uint32_t target_addr;    /**< Target flash address (APP_FLASH_BASE) */
@@ -71,10 +71,29 @@ public:
     uint16_t queryLatest(uint8_t channelId, uint8_t* outBuf,
                          uint16_t maxRecords) const;
 
-    /** @brief Iterate records in time range, callback per record */
+    /**
+     * @brief Iterate records in time range, callback per record
+     *
+     * Safe against a concurrent writer: the mutex is held one block at a
+     * time, including while cb runs, so cb must not call into the DB.
+     */
     bool queryByTime(uint8_t channelId, uint32_t startEpoch, uint32_t endEpoch,
                      RecordCallback cb, void* ctx) const;
 
+    /**
+     * @brief Copy committed records forward from a cursor (disk only)
+     *
+     * Reads blocks [cursor.block, endBlock) and advances the cursor past
+     * every record copied; blocks failing CRC are skipped. Records still in
+     * RAM buffers are not visible until flushed. Safe from another task.
+     * @return records copied (0 = caught up with endBlock)
+     */
+    uint16_t readFrom(uint8_t channelId, AtsCursor& cursor, uint32_t endBlock,
+                      uint8_t* outBuf, uint16_t maxRecords) const;
+
+    /** @brief Cursor just past the last committed block */
+    AtsCursor headCursor() const;
+
     // -- Query by schema name -----------------------------------------------
 
     uint16_t queryLatestBySchema(const char* schemaName, uint8_t* outBuf,
@@ -98,6 +117,7 @@ public:
     const StorageStats& getStats() const { return mStats; }
     uint8_t getChannelCount() const { return mChannelCount; }
     uint16_t getIndexCount() const { return mIndexCount; }
+    uint32_t getCreatedEpoch() const { return mCreatedEpoch; }
     const ArcanaTsSchema* getSchema(uint8_t channelId) const;
 
 private:
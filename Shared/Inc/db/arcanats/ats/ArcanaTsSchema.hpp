@@ -276,6 +276,18 @@ public:
         return s;
     }
 
+    /** @brief MQTT backfill cursor: last acknowledged position in a daily file (16 bytes/record, 254 rec/block) */
+    static inline ArcanaTsSchema mqttCursor() {
+        ArcanaTsSchema s;
+        s.setName("MQTT_CURSOR");
+        s.addField("ts",      FieldType::U32);
+        s.addField("fileId",  FieldType::U32);   // createdEpoch of the sensor file
+        s.addField("block",   FieldType::U32);
+        s.addField("rec",     FieldType::U16);
+        s.addField("rsv",     FieldType::U16);
+        return s;
+    }
+
     /** @brief Sensor calibration (18 bytes/record, 225 rec/block) */
     static inline ArcanaTsSchema calibration() {
         ArcanaTsSchema s;
@@ -169,6 +169,18 @@ struct StorageStats {
     uint32_t lastTimestamp;
 };
 
+/**
+ * @brief Read position for ArcanaTsDb::readFrom()
+ *
+ * block is a file block number (1 = first data block); record counts only
+ * the channel's own records inside that block, so a cursor stays valid for
+ * multi-channel blocks and across reopen (blocks are append-only).
+ */
+struct AtsCursor {
+    uint32_t block;
+    uint16_t record;
+};
+
 /** @brief Configuration for opening an ArcanaTS database */
 struct AtsConfig {
     IFilePort*      file;
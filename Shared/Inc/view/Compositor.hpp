@@ -0,0 +1,297 @@
+#pragma once
+#include "DisplayConfig.hpp"
+#if DISPLAY_FEATURE_COMPOSITOR
+
+#include "IDisplay.hpp"
+#include "Font5x7.hpp"
+
+namespace arcana {
+namespace display {
+
+/** Screen rectangle, right/bottom exclusive */
+struct Rect {
+    uint16_t x, y, w, h;
+
+    bool empty() const { return w == 0 || h == 0; }
+    uint16_t right() const { return (uint16_t)(x + w); }
+    uint16_t bottom() const { return (uint16_t)(y + h); }
+    uint32_t area() const { return (uint32_t)w * h; }
+
+    bool intersects(const Rect& o) const {
+        return !empty() && !o.empty() &&
+               x < o.right() && o.x < right() && y < o.bottom() && o.y < bottom();
+    }
+
+    Rect intersect(const Rect& o) const {
+        if (!intersects(o)) return Rect{ 0, 0, 0, 0 };
+        uint16_t l = x > o.x ? x : o.x;
+        uint16_t t = y > o.y ? y : o.y;
+        uint16_t r = right() < o.right() ? right() : o.right();
+        uint16_t b = bottom() < o.bottom() ? bottom() : o.bottom();
+        return Rect{ l, t, (uint16_t)(r - l), (uint16_t)(b - t) };
+    }
+
+    Rect unite(const Rect& o) const {
+        if (empty()) return o;
+        if (o.empty()) return *this;
+        uint16_t l = x < o.x ? x : o.x;
+        uint16_t t = y < o.y ? y : o.y;
+        uint16_t r = right() > o.right() ? right() : o.right();
+        uint16_t b = bottom() > o.bottom() ? bottom() : o.bottom();
+        return Rect{ l, t, (uint16_t)(r - l), (uint16_t)(b - t) };
+    }
+};
+
+/**
+ * Damaged screen areas waiting to be recomposited.
+ *
+ * Rects are merged when their bounding box costs no more than painting
+ * them apart (a window setup is worth WINDOW_COST pixels). When the list
+ * is full the new rect joins whichever entry grows least.
+ */
+template <uint8_t MaxRects = 8>
+class DamageList {
+public:
+    static const uint32_t WINDOW_COST = 64;
+
+    DamageList() : mRects(), mCount(0) {}
+
+    void add(Rect r) {
+        if (r.empty()) return;
+        // Absorb entries until nothing else is worth merging
+        for (uint8_t i = 0; i < mCount; ) {
+            if (worthMerging(mRects[i], r)) {
+                r = r.unite(mRects[i]);
+                mRects[i] = mRects[--mCount];
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+        if (mCount == MaxRects) {
+            uint8_t best = 0;
+            uint32_t bestGrowth = 0xFFFFFFFF;
+            for (uint8_t i = 0; i < mCount; i++) {
+                uint32_t growth = mRects[i].unite(r).area() - mRects[i].area();
+                if (growth < bestGrowth) { bestGrowth = growth; best = i; }
+            }
+            r = r.unite(mRects[best]);
+            mRects[best] = mRects[--mCount];
+            add(r);
+            return;
+        }
+        mRects[mCount++] = r;
+    }
+
+    void clear() { mCount = 0; }
+    uint8_t count() const { return mCount; }
+    const Rect& operator[](uint8_t i) const { return mRects[i]; }
+
+private:
+    static bool worthMerging(const Rect& a, const Rect& b) {
+        return a.unite(b).area() <= a.area() + b.area() + WINDOW_COST;
+    }
+
+    Rect mRects[MaxRects];
+    uint8_t mCount;
+};
+
+/**
+ * IDisplay that rasterizes into an RGB565 buffer covering one window of
+ * the screen. Drawing outside the window is clipped; anything the panel
+ * driver would drop (a glyph crossing the screen edge) is dropped here too,
+ * so a composed tile matches what direct drawing would have produced.
+ */
+class Canvas : public IDisplay {
+public:
+    Canvas(Color* pixels, uint16_t screenW, uint16_t screenH)
+        : mPixels(pixels), mWin{ 0, 0, 0, 0 }, mScreenW(screenW), mScreenH(screenH) {}
+
+    /** Pixels of r are stored row-major, r.w per row */
+    void setWindow(const Rect& r) { mWin = r; }
+    const Rect& window() const { return mWin; }
+    const Color* pixels() const { return mPixels; }
+
+    uint16_t width() const override { return mScreenW; }
+    uint16_t height() const override { return mScreenH; }
+
+    void fillScreen(Color color) override { fillRect(0, 0, mScreenW, mScreenH, color); }
+
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, Color color) override {
+        Rect r = mWin.intersect(Rect{ x, y, w, h });
+        for (uint16_t row = r.y; row < r.bottom(); row++) {
+            Color* dst = at(r.x, row);
+            for (uint16_t i = 0; i < r.w; i++) dst[i] = color;
+        }
+    }
+
+    void drawChar(uint16_t x, uint16_t y, char c,
+                  Color fg, Color bg, uint8_t scale) override {
+        glyph(x, y, c, fg, bg, scale);
+    }
+
+    void drawString(uint16_t x, uint16_t y, const char* str,
+                    Color fg, Color bg, uint8_t scale) override {
+        uint16_t cw = (lcd::FONT_WIDTH + 1) * scale;
+        if (scale == 0 || !mWin.intersects(Rect{ 0, y, mScreenW, (uint16_t)(lcd::FONT_HEIGHT * scale) }))
+            return;
+        for (; *str && x + cw <= mScreenW; str++, x += cw) {
+            if (x >= mWin.right()) break;
+            if (x + cw > mWin.x) glyph(x, y, *str, fg, bg, scale);
+        }
+    }
+
+    void drawXBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                     const uint8_t* bitmap, Color fg, Color bg) override {
+        Rect r = mWin.intersect(Rect{ x, y, w, h });
+        uint16_t bytesPerRow = (w + 7) / 8;
+        for (uint16_t row = r.y; row < r.bottom(); row++) {
+            Color* dst = at(r.x, row);
+            const uint8_t* src = bitmap + (row - y) * bytesPerRow;
+            for (uint16_t col = r.x - x; col < r.right() - x; col++) {
+                *dst++ = (src[col >> 3] & (1 << (col & 7))) ? fg : bg;
+            }
+        }
+    }
+
+    void drawBitmap16(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint16_t* pixels) override {
+        Rect r = mWin.intersect(Rect{ x, y, w, h });
+        for (uint16_t row = r.y; row < r.bottom(); row++) {
+            Color* dst = at(r.x, row);
+            const uint16_t* src = pixels + (row - y) * w + (r.x - x);
+            for (uint16_t i = 0; i < r.w; i++) dst[i] = src[i];
+        }
+    }
+
+protected:
+    Color* at(uint16_t x, uint16_t y) {
+        return mPixels + (uint32_t)(y - mWin.y) * mWin.w + (x - mWin.x);
+    }
+
+    /** One 5x7 cell plus its gap column, scaled, clipped to the window */
+    void glyph(uint16_t x, uint16_t y, char c, Color fg, Color bg, uint8_t scale) {
+        if (c < 0x20 || c > 0x7E) c = '?';
+        uint16_t cw = (lcd::FONT_WIDTH + 1) * scale;
+        uint16_t ch = lcd::FONT_HEIGHT * scale;
+        if (scale == 0 || x + cw > mScreenW || y + ch > mScreenH) return;
+
+        const uint8_t* g = lcd::FONT_5X7[c - 0x20];
+        Rect r = mWin.intersect(Rect{ x, y, cw, ch });
+        for (uint16_t py = r.y; py < r.bottom(); py++) {
+            uint8_t bit = (uint8_t)(1 << ((py - y) / scale));
+            Color* dst = at(r.x, py);
+            for (uint16_t px = r.x; px < r.right(); px++) {
+                uint8_t col = (uint8_t)((px - x) / scale);
+                *dst++ = (col < lcd::FONT_WIDTH && (g[col] & bit)) ? fg : bg;
+            }
+        }
+    }
+
+    Color* mPixels;
+    Rect mWin;
+    uint16_t mScreenW;
+    uint16_t mScreenH;
+};
+
+/**
+ * Retained content for the Compositor. paint() uses ordinary IDisplay
+ * calls; the canvas it receives only keeps what falls inside the tile
+ * being composed (clip), so a layer may simply redraw everything it owns
+ * — or skip the parts that miss clip when drawing them costs more than
+ * the canvas rejecting them.
+ */
+class Layer {
+public:
+    virtual ~Layer() {}
+
+    /** Area the layer currently covers — empty while hidden */
+    virtual Rect bounds() const = 0;
+
+    virtual void paint(IDisplay& canvas, const Rect& clip) = 0;
+};
+
+/**
+ * Dirty-rectangle compositor.
+ *
+ * Views report damage instead of drawing. compose() walks each merged
+ * damage rect in tiles: the tile is cleared, every layer touching it is
+ * painted bottom to top into RAM, and the result goes to the panel in
+ * one drawBitmap16 — overlays never flicker over live data and each
+ * pixel crosses the bus once per compose.
+ *
+ * The tile buffer holds TileW x TileH pixels; narrower rects take more
+ * rows per tile so a text field usually goes out in one burst.
+ *
+ * @tparam TileW     Widest tile (normally the screen width)
+ * @tparam TileH     Rows per full-width tile
+ * @tparam MaxLayers Layers in z-order, bottom first
+ */
+template <uint16_t TileW = 240, uint16_t TileH = 16, uint8_t MaxLayers = 4>
+class Compositor {
+public:
+    static const uint32_t TILE_PIXELS = (uint32_t)TileW * TileH;
+
+    Compositor(uint16_t screenW = 240, uint16_t screenH = 320,
+               Color background = colors::BLACK)
+        : mTile(), mCanvas(mTile, screenW, screenH), mLayers(), mLayerCount(0)
+        , mDamage(), mBackground(background), mTiles(0), mPixels(0) {}
+
+    /** Stack a layer on top of the ones already added */
+    bool addLayer(Layer* layer) {
+        if (!layer || mLayerCount == MaxLayers) return false;
+        mLayers[mLayerCount++] = layer;
+        return true;
+    }
+
+    void damage(const Rect& r) {
+        mDamage.add(r.intersect(Rect{ 0, 0, mCanvas.width(), mCanvas.height() }));
+    }
+
+    bool dirty() const { return mDamage.count() > 0; }
+
+    /** Repaint all damage onto out and clear it */
+    void compose(IDisplay& out) {
+        for (uint8_t i = 0; i < mDamage.count(); i++) {
+            const Rect& r = mDamage[i];
+            for (uint16_t x = r.x; x < r.right(); x += TileW) {
+                uint16_t w = (uint16_t)(r.right() - x < TileW ? r.right() - x : TileW);
+                uint16_t rows = (uint16_t)(TILE_PIXELS / w);
+                for (uint16_t y = r.y; y < r.bottom(); y += rows) {
+                    uint16_t h = (uint16_t)(r.bottom() - y < rows ? r.bottom() - y : rows);
+                    composeTile(out, Rect{ x, y, w, h });
+                }
+            }
+        }
+        mDamage.clear();
+    }
+
+    uint32_t tiles() const { return mTiles; }
+    uint32_t pixels() const { return mPixels; }
+
+private:
+    void composeTile(IDisplay& out, const Rect& tile) {
+        mCanvas.setWindow(tile);
+        mCanvas.fillRect(tile.x, tile.y, tile.w, tile.h, mBackground);
+        for (uint8_t i = 0; i < mLayerCount; i++) {
+            if (mLayers[i]->bounds().intersects(tile)) mLayers[i]->paint(mCanvas, tile);
+        }
+        out.drawBitmap16(tile.x, tile.y, tile.w, tile.h, mTile);
+        mTiles++;
+        mPixels += tile.area();
+    }
+
+    Color mTile[TILE_PIXELS];
+    Canvas mCanvas;
+    Layer* mLayers[MaxLayers];
+    uint8_t mLayerCount;
+    DamageList<> mDamage;
+    Color mBackground;
+    uint32_t mTiles;
+    uint32_t mPixels;
+};
+
+} // namespace display
+} // namespace arcana
+
+#endif // DISPLAY_FEATURE_COMPOSITOR
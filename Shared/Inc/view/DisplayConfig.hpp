@@ -15,6 +15,8 @@
 // ── Decorators / Utilities ───────────────────────
 #define DISPLAY_FEATURE_MUTEX       1   // MutexDisplay — thread-safe decorator
 #define DISPLAY_FEATURE_STATUS      1   // statusLine() / headerBar() / clearStatusLine()
+#define DISPLAY_FEATURE_TEXT_CACHE  1   // drawString glyph run cache + text diff (~2.1KB RAM)
+#define DISPLAY_FEATURE_COMPOSITOR  1   // Dirty-rect Compositor + tile Canvas (tile RAM per instance)
 
 // ── Input Types ──────────────────────────────────
 #define DISPLAY_FEATURE_TOUCH       1   // TouchEvent, Gesture, TouchPoint
@@ -3,6 +3,9 @@
 #if DISPLAY_FEATURE_STATUS
 
 #include "IDisplay.hpp"
+#if DISPLAY_FEATURE_COMPOSITOR
+#include "Compositor.hpp"
+#endif
 
 namespace arcana {
 namespace display {
@@ -83,15 +86,39 @@ inline ToastState& toastState() {
     return s;
 }
 
+/** Draw the toast box + text onto d */
+inline void toastPaint(IDisplay& d, const ToastState& ts, const char* text) {
+    d.fillRect(ts.x, ts.y, ts.w, ts.h, ts.bg);
+    d.drawHLine(ts.x, ts.y, ts.w, colors::WHITE);
+    d.drawHLine(ts.x, ts.y + ts.h - 1, ts.w, colors::WHITE);
+    d.fillRect(ts.x, ts.y, 1, ts.h, colors::WHITE);
+    d.fillRect(ts.x + ts.w - 1, ts.y, 1, ts.h, colors::WHITE);
+    d.drawString(ts.textX, ts.textY, text, ts.fg, ts.bg, ts.scale);
+}
+
 /** Render-task only: draw the toast box + text */
 inline void toastRedraw(const ToastState& ts, const char* text) {
     if (!g_display) return;
-    g_display->fillRect(ts.x, ts.y, ts.w, ts.h, ts.bg);
-    g_display->drawHLine(ts.x, ts.y, ts.w, colors::WHITE);
-    g_display->drawHLine(ts.x, ts.y + ts.h - 1, ts.w, colors::WHITE);
-    g_display->fillRect(ts.x, ts.y, 1, ts.h, colors::WHITE);
-    g_display->fillRect(ts.x + ts.w - 1, ts.y, 1, ts.h, colors::WHITE);
-    g_display->drawString(ts.textX, ts.textY, text, ts.fg, ts.bg, ts.scale);
+    toastPaint(*g_display, ts, text);
+}
+
+/** Size the box for req and centre it on a screenW x screenH display */
+inline void toastLayout(ToastState& ts, const ToastRequest& req,
+                        uint16_t screenW, uint16_t screenH) {
+    uint8_t scale = 2;
+    uint16_t charW = 6 * scale;
+    uint16_t textW = 0;
+    const char* p = req.text;
+    while (*p++) textW += charW;
+    uint16_t textH = 7 * scale;
+    uint16_t padX = 16, padY = 12;
+    uint16_t boxW = textW + padX * 2;
+    uint16_t boxH = textH + padY * 2;
+    if (boxW < 200) boxW = 200;
+    uint16_t bx = (screenW - boxW) / 2;
+    uint16_t by = (screenH - boxH) / 2;
+    ts.x = bx; ts.y = by; ts.w = boxW; ts.h = boxH;
+    ts.textX = bx + (boxW - textW) / 2; ts.textY = by + padY;
 }
 
 /** Render-task only: process toast requests + lifecycle.
@@ -114,22 +141,7 @@ inline bool toastUpdate(uint32_t currentTick) {
     // Handle new toast request
     if (req.pending) {
         req.pending = false;
-        uint8_t scale = 2;
-        uint16_t charW = 6 * scale;
-        uint16_t textW = 0;
-        const char* p = req.text;
-        while (*p++) textW += charW;
-        uint16_t textH = 7 * scale;
-        uint16_t padX = 16, padY = 12;
-        uint16_t boxW = textW + padX * 2;
-        uint16_t boxH = textH + padY * 2;
-        if (boxW < 200) boxW = 200;
-        if (g_display) {
-            uint16_t bx = (g_display->width() - boxW) / 2;
-            uint16_t by = (g_display->height() - boxH) / 2;
-            ts.x = bx; ts.y = by; ts.w = boxW; ts.h = boxH;
-            ts.textX = bx + (boxW - textW) / 2; ts.textY = by + padY;
-        }
+        if (g_display) toastLayout(ts, req, g_display->width(), g_display->height());
         ts.dismissTick = currentTick + req.durationMs;
         ts.fg = req.fg; ts.bg = req.bg; ts.scale = 2;
         ts.active = true;
@@ -150,6 +162,50 @@ inline bool toastUpdate(uint32_t currentTick) {
     return false;
 }
 
+#if DISPLAY_FEATURE_COMPOSITOR
+/** Render-task only, compositor path: the toastUpdate lifecycle without
+ *  drawing. Returns true when the box appeared, moved or went away;
+ *  damage then covers both the old and the new box. */
+inline bool toastPoll(uint32_t currentTick, uint16_t screenW, uint16_t screenH,
+                      Rect& damage) {
+    ToastRequest& req = toastRequest();
+    ToastState& ts = toastState();
+    Rect old = ts.active ? Rect{ ts.x, ts.y, ts.w, ts.h } : Rect{ 0, 0, 0, 0 };
+
+    if (req.dismiss) {
+        req.dismiss = false;
+        req.pending = false;
+        ts.active = false;
+    } else if (req.pending) {
+        req.pending = false;
+        toastLayout(ts, req, screenW, screenH);
+        ts.dismissTick = currentTick + req.durationMs;
+        ts.fg = req.fg; ts.bg = req.bg; ts.scale = 2;
+        ts.active = true;
+    } else if (ts.active && currentTick >= ts.dismissTick) {
+        ts.active = false;
+    } else {
+        return false;
+    }
+
+    damage = ts.active ? old.unite(Rect{ ts.x, ts.y, ts.w, ts.h }) : old;
+    return !damage.empty();
+}
+
+/** Toast as a compositor overlay — stack it above the view's own layers */
+class ToastLayer : public Layer {
+public:
+    Rect bounds() const override {
+        const ToastState& ts = toastState();
+        return ts.active ? Rect{ ts.x, ts.y, ts.w, ts.h } : Rect{ 0, 0, 0, 0 };
+    }
+
+    void paint(IDisplay& canvas, const Rect&) override {
+        toastPaint(canvas, toastState(), toastRequest().text);
+    }
+};
+#endif // DISPLAY_FEATURE_COMPOSITOR
+
 // Backward-compatible wrappers (redirect to requestToast)
 inline void toast(const char* msg, uint32_t durationMs, uint32_t /*currentTick*/,
                   Color fg = colors::WHITE, Color bg = colors::DARKGRAY, uint8_t /*scale*/ = 2) {
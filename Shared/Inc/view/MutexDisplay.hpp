@@ -37,6 +37,10 @@ public:
                      const uint8_t* bmp, Color fg, Color bg) override {
         if (mMutex.lock(10)) { mInner.drawXBitmap(x, y, w, h, bmp, fg, bg); mMutex.unlock(); }
     }
+    void drawBitmap16(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint16_t* pixels) override {
+        if (mMutex.lock(10)) { mInner.drawBitmap16(x, y, w, h, pixels); mMutex.unlock(); }
+    }
 };
 
 } // namespace display
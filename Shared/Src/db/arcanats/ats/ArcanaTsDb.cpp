@@ -222,6 +222,7 @@ bool ArcanaTsDb::addChannelLive(uint8_t channelId, const ArcanaTsSchema& schema,
     mChannelCount++;
 
     // Rewrite header to persist the new channel descriptor + field table
+    mCfg.mutex->lock();
     bool ok;
     if (mCfg.headerKey) {
         ok = writeEntireHeaderBlock();
@@ -229,6 +230,7 @@ bool ArcanaTsDb::addChannelLive(uint8_t channelId, const ArcanaTsSchema& schema,
         ok = writeFileHeader() && writeChannelDescriptors() && writeShadowHeader();
     }
     if (ok) mCfg.file->sync();
+    mCfg.mutex->unlock();
     return ok;
 }
 
@@ -272,9 +274,14 @@ bool ArcanaTsDb::start() {
 bool ArcanaTsDb::close() {
     if (!mOpen) return false;
 
+    // Flush remaining data
+    if (!mReadOnly && mStarted) flush();
+
+    // Index/header rewrite and file close use the shared read cache and file
+    // position — exclude readFrom()/queryLatest() running in another task
+    mCfg.mutex->lock();
+
     if (!mReadOnly && mStarted) {
-        // Flush remaining data
-        flush();
         // Write sparse index
         writeIndex();
         // Update header with final stats
@@ -307,6 +314,7 @@ bool ArcanaTsDb::close() {
     memset(&mSlow, 0, sizeof(mSlow));
     memset(mIndex, 0, sizeof(mIndex));
 
+    mCfg.mutex->unlock();
     return true;
 }
 
@@ -465,12 +473,14 @@ bool ArcanaTsDb::flush() {
 
     // Update file header with current stats (survives power loss)
     if (ok) {
+        mCfg.mutex->lock();
         if (mCfg.headerKey) {
             writeEntireHeaderBlock();
         } else {
             updateFileHeader();
         }
         mCfg.file->sync();
+        mCfg.mutex->unlock();
     }
 
     return ok;
@@ -557,6 +567,10 @@ bool ArcanaTsDb::writeBlock(uint8_t channelId, const uint8_t* payload,
     uint8_t* blockBuf = getReadCache();
     if (!blockBuf) return false;
 
+    // The read cache and file position are shared with readers (readFrom,
+    // queryLatest) that may run in another task
+    mCfg.mutex->lock();
+
     memset(blockBuf, 0xFF, BLOCK_SIZE);  // fill unused with 0xFF
 
     // Copy payload at offset 32
@@ -590,26 +604,27 @@ bool ArcanaTsDb::writeBlock(uint8_t channelId, const uint8_t* payload,
     memcpy(hdr->nonce, nonce, 12);
     hdr->payloadCrc32 = payloadCrc;
 
-    // Write to file: header fields + payload first (skip first 4 bytes = blockSeqNo)
-    if (!mCfg.file->seek(mNextBlockOffset + 4)) return false;
-    if (mCfg.file->write(blockBuf + 4, BLOCK_SIZE - 4) != (BLOCK_SIZE - 4)) return false;
-
-    // Atomic commit: write blockSeqNo at offset 0 LAST
+    // Write to file: header fields + payload first (skip first 4 bytes = blockSeqNo),
+    // then atomic commit: write blockSeqNo at offset 0 LAST
     uint32_t seqNo = mNextSeqNo;
-    if (!mCfg.file->seek(mNextBlockOffset)) return false;
-    if (mCfg.file->write(reinterpret_cast<const uint8_t*>(&seqNo), 4) != 4) return false;
-
-    if (!mCfg.file->sync()) return false;
+    bool ok = mCfg.file->seek(mNextBlockOffset + 4)
+           && mCfg.file->write(blockBuf + 4, BLOCK_SIZE - 4) == (BLOCK_SIZE - 4)
+           && mCfg.file->seek(mNextBlockOffset)
+           && mCfg.file->write(reinterpret_cast<const uint8_t*>(&seqNo), 4) == 4
+           && mCfg.file->sync();
 
-    // Update index
-    addIndexEntry(mNextBlockOffset / BLOCK_SIZE, channelId, recordCount, firstTs, lastTs);
+    if (ok) {
+        // Update index
+        addIndexEntry(mNextBlockOffset / BLOCK_SIZE, channelId, recordCount, firstTs, lastTs);
 
-    // Advance state
-    mNextSeqNo++;
-    mNextBlockOffset += BLOCK_SIZE;
-    mStats.blocksWritten++;
+        // Advance state
+        mNextSeqNo++;
+        mNextBlockOffset += BLOCK_SIZE;
+        mStats.blocksWritten++;
+    }
 
-    return true;
+    mCfg.mutex->unlock();
+    return ok;
 }
 
 // ---------------------------------------------------------------------------
@@ -1529,63 +1544,184 @@ uint16_t ArcanaTsDb::queryLatestBySchema(const char* schemaName, uint8_t* outBuf
 
 bool ArcanaTsDb::queryByTime(uint8_t channelId, uint32_t startEpoch,
                               uint32_t endEpoch, RecordCallback cb, void* ctx) const {
-    if (!mStarted || channelId >= MAX_CHANNELS || !mChannels[channelId].active) return false;
+    if (!mStarted || !mCfg.mutex || channelId >= MAX_CHANNELS ||
+        !mChannels[channelId].active) return false;
     if (!cb) return false;
 
     const uint16_t recSize = mChannels[channelId].schema.recordSize;
     uint8_t* cache = getReadCache();
     if (!cache) return false;
 
-    // Iterate index entries
-    for (uint16_t i = 0; i < mIndexCount; i++) {
-        const AtsIndexEntry& ie = mIndex[i];
-
-        // Skip blocks outside time range
-        if (ie.lastTimestamp < startEpoch) continue;
-        if (ie.firstTimestamp > endEpoch) break;
-
-        // Skip blocks for other channels
-        if (ie.channelId != channelId && ie.channelId != MULTI_CHANNEL_ID) continue;
+    // One block per lock hold, as in readFrom: the index, the read cache and
+    // the file position are the writer's in between. cb runs with the lock
+    // held (the record points into the cache) and must not re-enter the DB.
+    uint16_t i = 0;
+    uint32_t lastBlock = 0;  // last index entry consumed
+    bool stop = false;
+    while (!stop) {
+        mCfg.mutex->lock();
 
-        if (!readAndDecryptBlock(ie.blockNumber, cache)) continue;
+        // Eviction shifts the index left while unlocked: step back to the
+        // entry after the last one consumed
+        if (i > mIndexCount) i = mIndexCount;
+        while (i > 0 && mIndex[i - 1].blockNumber > lastBlock) i--;
 
-        const AtsBlockHeader* hdr = reinterpret_cast<const AtsBlockHeader*>(cache);
-        const uint8_t* payload = cache + BLOCK_HEADER_SIZE;
+        if (!mOpen || i >= mIndexCount) {
+            mCfg.mutex->unlock();
+            break;
+        }
+        const AtsIndexEntry ie = mIndex[i++];
+        lastBlock = ie.blockNumber;
 
-        if (hdr->channelId == channelId) {
-            // Single-channel block: iterate fixed-size records
-            for (uint16_t r = 0; r < hdr->recordCount; r++) {
-                const uint8_t* rec = payload + r * recSize;
-                // Extract timestamp (first 4 bytes by convention)
-                uint32_t ts;
-                memcpy(&ts, rec, 4);
-                if (ts < startEpoch) continue;
-                if (ts > endEpoch) continue;
-                if (cb(channelId, rec, ts, ctx)) return true;  // early stop
-            }
-        } else if (hdr->channelId == MULTI_CHANNEL_ID) {
-            // Multi-channel: parse tagged records
-            uint16_t off = 0;
-            while (off < BLOCK_PAYLOAD_SIZE) {
-                uint8_t chId = payload[off];
-                if (chId >= MAX_CHANNELS || !mChannels[chId].active) break;
-                uint16_t rs = mChannels[chId].schema.recordSize;
-                if (chId == channelId) {
-                    const uint8_t* rec = payload + off + 1;
+        // Skip blocks outside time range
+        if (ie.firstTimestamp > endEpoch) {
+            mCfg.mutex->unlock();
+            break;
+        }
+        // Skip blocks for other channels
+        bool wanted = ie.lastTimestamp >= startEpoch &&
+                      (ie.channelId == channelId || ie.channelId == MULTI_CHANNEL_ID);
+
+        if (wanted && readAndDecryptBlock(ie.blockNumber, cache)) {
+            const AtsBlockHeader* hdr = reinterpret_cast<const AtsBlockHeader*>(cache);
+            const uint8_t* payload = cache + BLOCK_HEADER_SIZE;
+
+            if (hdr->channelId == channelId) {
+                // Single-channel block: iterate fixed-size records
+                for (uint16_t r = 0; r < hdr->recordCount && !stop; r++) {
+                    const uint8_t* rec = payload + r * recSize;
+                    // Extract timestamp (first 4 bytes by convention)
                     uint32_t ts;
                     memcpy(&ts, rec, 4);
-                    if (ts >= startEpoch && ts <= endEpoch) {
-                        if (cb(channelId, rec, ts, ctx)) return true;
+                    if (ts < startEpoch) continue;
+                    if (ts > endEpoch) continue;
+                    stop = cb(channelId, rec, ts, ctx);  // early stop
+                }
+            } else if (hdr->channelId == MULTI_CHANNEL_ID) {
+                // Multi-channel: parse tagged records
+                uint16_t off = 0;
+                while (off < BLOCK_PAYLOAD_SIZE && !stop) {
+                    uint8_t chId = payload[off];
+                    if (chId >= MAX_CHANNELS || !mChannels[chId].active) break;
+                    uint16_t rs = mChannels[chId].schema.recordSize;
+                    if (chId == channelId) {
+                        const uint8_t* rec = payload + off + 1;
+                        uint32_t ts;
+                        memcpy(&ts, rec, 4);
+                        if (ts >= startEpoch && ts <= endEpoch) {
+                            stop = cb(channelId, rec, ts, ctx);
+                        }
                     }
+                    off += 1 + rs;
                 }
-                off += 1 + rs;
             }
         }
+
+        mCfg.mutex->unlock();
     }
 
     return true;
 }
 
+// ---------------------------------------------------------------------------
+// Query: readFrom (cursor replay)
+// ---------------------------------------------------------------------------
+
+uint16_t ArcanaTsDb::readFrom(uint8_t channelId, AtsCursor& cursor, uint32_t endBlock,
+                              uint8_t* outBuf, uint16_t maxRecords) const {
+    if (!mCfg.mutex || channelId >= MAX_CHANNELS || maxRecords == 0 || !outBuf) return 0;
+    uint8_t* cache = getReadCache();
+    if (!cache) return 0;
+
+    const uint32_t firstBlock = static_cast<uint32_t>(DATA_START_OFFSET / BLOCK_SIZE);
+    if (cursor.block < firstBlock) {
+        cursor.block = firstBlock;
+        cursor.record = 0;
+    }
+
+    uint16_t found = 0;
+
+    // One block per lock hold so the writer is never held off for long
+    while (found < maxRecords) {
+        mCfg.mutex->lock();
+
+        const uint32_t headBlock = static_cast<uint32_t>(mNextBlockOffset / BLOCK_SIZE);
+        if (!mOpen || !mChannels[channelId].active ||
+            cursor.block >= endBlock || cursor.block >= headBlock) {
+            mCfg.mutex->unlock();
+            break;
+        }
+
+        bool exhausted = true;  // cursor moves to the next block
+        if (readAndDecryptBlock(cursor.block, cache)) {
+            const uint16_t recSize = mChannels[channelId].schema.recordSize;
+            const AtsBlockHeader* hdr = reinterpret_cast<const AtsBlockHeader*>(cache);
+            const uint8_t* payload = cache + BLOCK_HEADER_SIZE;
+
+            if (hdr->channelId == channelId) {
+                // Single-channel block: contiguous records
+                uint16_t inBlock = hdr->recordCount;
+                if (inBlock > BLOCK_PAYLOAD_SIZE / recSize) inBlock = BLOCK_PAYLOAD_SIZE / recSize;
+                if (cursor.record < inBlock) {
+                    uint16_t need = maxRecords - found;
+                    uint16_t avail = inBlock - cursor.record;
+                    uint16_t toCopy = (avail < need) ? avail : need;
+                    memcpy(outBuf + found * recSize, payload + cursor.record * recSize,
+                           toCopy * recSize);
+                    found += toCopy;
+                    cursor.record += toCopy;
+                }
+                exhausted = (cursor.record >= inBlock);
+            } else if (hdr->channelId == MULTI_CHANNEL_ID) {
+                // Multi-channel: count this channel's tagged records
+                uint16_t off = 0;
+                uint16_t matchIdx = 0;
+                while (off < BLOCK_PAYLOAD_SIZE) {
+                    uint8_t chId = payload[off];
+                    if (chId >= MAX_CHANNELS || !mChannels[chId].active) break;
+                    uint16_t rs = mChannels[chId].schema.recordSize;
+                    if (off + 1 + rs > BLOCK_PAYLOAD_SIZE) break;
+                    if (chId == channelId) {
+                        if (matchIdx >= cursor.record) {
+                            if (found >= maxRecords) {
+                                exhausted = false;
+                                break;
+                            }
+                            memcpy(outBuf + found * recSize, payload + off + 1, recSize);
+                            found++;
+                            cursor.record = matchIdx + 1;
+                        }
+                        matchIdx++;
+                    }
+                    off += 1 + rs;
+                }
+            }
+        }
+        // CRC failure: the block is lost, move past it
+
+        if (exhausted) {
+            cursor.block++;
+            cursor.record = 0;
+        }
+
+        mCfg.mutex->unlock();
+    }
+
+    return found;
+}
+
+AtsCursor ArcanaTsDb::headCursor() const {
+    AtsCursor c;
+    c.block = static_cast<uint32_t>(DATA_START_OFFSET / BLOCK_SIZE);
+    c.record = 0;
+    if (!mCfg.mutex) return c;  // never opened
+
+    mCfg.mutex->lock();
+    c.block = static_cast<uint32_t>(mNextBlockOffset / BLOCK_SIZE);
+    mCfg.mutex->unlock();
+    return c;
+}
+
 bool ArcanaTsDb::queryBySchema(const char* schemaName, uint32_t startEpoch,
                                 uint32_t endEpoch, RecordCallback cb, void* ctx) const {
     int8_t ch = findChannelBySchema(schemaName);
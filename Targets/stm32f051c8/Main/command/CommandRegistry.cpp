@@ -7,30 +7,35 @@
 
 namespace arcana {
 
+#if ARCANA_CMD_RUNTIME_REGISTRY
 bool CommandRegistry::registerCommand(ICommand* command) {
     if (command == nullptr) return false;
     if (count_ >= MAX_COMMANDS) return false;
 
-    /* Check for duplicate key */
+    /* Check for duplicate key (built-in table and runtime list) */
     CommandKey key = command->getKey();
-    for (uint8_t i = 0; i < count_; i++) {
-        if (commands_[i]->getKey() == key) {
-            return false;
-        }
+    if (findCommand(key) != nullptr) {
+        return false;
     }
 
-    commands_[count_] = command;
+    commands_[count_] = {key, command};
     count_++;
     return true;
 }
+#endif
 
 ICommand* CommandRegistry::findCommand(CommandKey key) const {
+    ICommand* command = table_.find(key);
+#if ARCANA_CMD_RUNTIME_REGISTRY
+    if (command != nullptr) return command;
+
     for (uint8_t i = 0; i < count_; i++) {
-        if (commands_[i]->getKey() == key) {
-            return commands_[i];
+        if (commands_[i].key == key) {
+            return commands_[i].command;
         }
     }
-    return nullptr;
+#endif
+    return command;
 }
 
 } // namespace arcana
@@ -6,26 +6,46 @@
 #ifndef ARCANA_COMMAND_REGISTRY_HPP
 #define ARCANA_COMMAND_REGISTRY_HPP
 
-#include "ICommand.hpp"
+#include "CommandTable.hpp"
+
+/* Runtime registration costs RAM the F051 does not have; off by default */
+#ifndef ARCANA_CMD_RUNTIME_REGISTRY
+#define ARCANA_CMD_RUNTIME_REGISTRY 0
+#endif
 
 namespace arcana {
 
 /**
  * @brief Static command registry
  *
- * Holds pointers to command instances. Linear scan lookup — O(n) with n <= MAX_COMMANDS.
+ * The compile-time CommandTable (flash, O(1) lookup) is the registry; the
+ * object itself is just a view over it. Builds that need to add commands
+ * at runtime define ARCANA_CMD_RUNTIME_REGISTRY=1 to get a small overflow
+ * list, whose keys are cached at registration so lookup never calls getKey().
  * All storage is static (no heap allocation).
  */
 class CommandRegistry {
 public:
+#if ARCANA_CMD_RUNTIME_REGISTRY
     static constexpr uint8_t MAX_COMMANDS = 8;
+#endif
+
+    CommandRegistry() = default;
+
+    /**
+     * @brief Construct with a compile-time table of built-in commands
+     * @param table View over a constexpr CommandTable (must outlive the registry)
+     */
+    explicit CommandRegistry(const CommandTableView& table) : table_(table) {}
 
+#if ARCANA_CMD_RUNTIME_REGISTRY
     /**
-     * @brief Register a command handler
+     * @brief Register a command handler at runtime
      * @param command Pointer to static command instance
      * @return true if registered successfully, false if full or duplicate
      */
     bool registerCommand(ICommand* command);
+#endif
 
     /**
      * @brief Find a command by key
@@ -35,13 +55,20 @@ public:
     ICommand* findCommand(CommandKey key) const;
 
     /**
-     * @brief Get the number of registered commands
+     * @brief Get the number of commands (built-in table + runtime)
      */
-    uint8_t getCommandCount() const { return count_; }
+#if ARCANA_CMD_RUNTIME_REGISTRY
+    uint8_t getCommandCount() const { return table_.size() + count_; }
+#else
+    uint8_t getCommandCount() const { return table_.size(); }
+#endif
 
 private:
-    ICommand* commands_[MAX_COMMANDS] = {};
+    CommandTableView table_;
+#if ARCANA_CMD_RUNTIME_REGISTRY
+    CommandEntry commands_[MAX_COMMANDS] = {};
     uint8_t count_ = 0;
+#endif
 };
 
 } // namespace arcana
@@ -16,9 +16,17 @@ CommandService commandService;
 static PingCommand pingCommand;
 static GetCounterCommand getCounterCommand;
 
+/* Built-in command table — resolved at compile time, lives in flash */
+static constexpr CommandEntry kBuiltinCommands[] = {
+    commandEntry(pingCommand),
+    commandEntry(getCounterCommand),
+};
+static constexpr auto kBuiltinTable = makeCommandTable<kBuiltinCommands>();
+
+CommandService::CommandService() : registry_(kBuiltinTable.view()) {}
+
 void CommandService::init() {
-    registry_.registerCommand(&pingCommand);
-    registry_.registerCommand(&getCounterCommand);
+    /* Built-ins are already in kBuiltinTable; nothing to register at runtime */
 }
 
 } // namespace arcana
@@ -15,14 +15,18 @@ namespace arcana {
  *
  * Top-level entry point for the command pattern.
  * Owns the registry, observable, and dispatcher.
- * Registers built-in commands on init().
+ * Built-in commands come from a compile-time table (no registry RAM);
+ * with ARCANA_CMD_RUNTIME_REGISTRY=1 extra commands can be registered at
+ * runtime via getRegistry().
  */
 class CommandService {
 public:
     Observable<CommandResponseModel> observable{"Command"};
 
+    CommandService();
+
     /**
-     * @brief Initialize the command service and register built-in commands
+     * @brief Initialize the command service
      */
     void init();
 
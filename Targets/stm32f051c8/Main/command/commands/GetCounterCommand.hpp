@@ -18,8 +18,10 @@ namespace arcana {
  */
 class GetCounterCommand : public ICommand {
 public:
+    static constexpr CommandKey kKey = {Cluster::Sensor, SensorCommand::GetCounter};
+
     CommandKey getKey() const override {
-        return {Cluster::Sensor, SensorCommand::GetCounter};
+        return kKey;
     }
 
     void execute(const CommandRequest& request, CommandResponseModel& response) override {
@@ -20,8 +20,10 @@ namespace arcana {
  */
 class PingCommand : public ICommand {
 public:
+    static constexpr CommandKey kKey = {Cluster::System, SystemCommand::Ping};
+
     CommandKey getKey() const override {
-        return {Cluster::System, SystemCommand::Ping};
+        return kKey;
     }
 
     void execute(const CommandRequest& request, CommandResponseModel& response) override {
@@ -35,6 +35,33 @@ int bl_flash_erase_app(uint32_t num_pages)
     return 0;
 }
 
+int bl_flash_erase_page(uint32_t page_addr)
+{
+    HAL_StatusTypeDef status;
+    FLASH_EraseInitTypeDef erase;
+    uint32_t page_error = 0;
+
+    /* Defense-in-depth: never erase key store pages */
+    if (page_addr < APP_FLASH_BASE || page_addr >= KEY_STORE_BASE) return -1;
+    if ((page_addr - APP_FLASH_BASE) % FLASH_PAGE_SIZE != 0) return -1;
+
+    status = HAL_FLASH_Unlock();
+    if (status != HAL_OK) return -1;
+
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.PageAddress = page_addr;
+    erase.NbPages = 1;
+
+    status = HAL_FLASHEx_Erase(&erase, &page_error);
+
+    HAL_FLASH_Lock();
+
+    if (status != HAL_OK || page_error != 0xFFFFFFFF) {
+        return -1;
+    }
+    return 0;
+}
+
 int bl_flash_program(uint32_t dest_addr, const uint8_t* data, uint32_t len)
 {
     HAL_StatusTypeDef status;
@@ -14,6 +14,13 @@
  */
 int bl_flash_erase_app(uint32_t num_pages);
 
+/**
+ * @brief Erase one 2KB App page
+ * @param page_addr Page start (page-aligned, inside the App region)
+ * @return 0 on success, -1 on error
+ */
+int bl_flash_erase_page(uint32_t page_addr);
+
 /**
  * @brief Program flash from buffer, word-by-word
  * @param dest_addr Flash destination (must be word-aligned, >= APP_FLASH_BASE)
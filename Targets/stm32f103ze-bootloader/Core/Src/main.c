@@ -5,8 +5,11 @@
  * Flow:
  * 1. Init clock (72MHz), UART (debug), GPIO (LED, KEY1)
  * 2. Check BKP DR2/DR3 for OTA flag
- *    - If set: clear flag → mount SD → read ota_meta.bin → verify CRC →
- *      erase App flash → program → verify → rename firmware.bin → fw_prev.bin
+ *    - If set: clear flag → mount SD → read ota_meta.bin →
+ *      (delta: rebuild firmware.bin from App flash + fw_patch.bin) →
+ *      verify CRC → reprogram changed pages → verify →
+ *      rename firmware.bin → fw_prev.bin
+ *    - Flash left half-written → reflash fw_prev.bin
  * 3. Check KEY1 held 2s → manual recovery from fw_prev.bin
  * 4. Validate App image at 0x08008000 → jump
  * 5. Invalid App → error LED blink loop
@@ -16,6 +19,7 @@
 #include "bl_flash.h"
 #include "bl_uart.h"
 #include "ota_header.h"
+#include "ota_delta.h"
 #include "Crc32.hpp"
 #include "ff.h"
 #include <string.h>
@@ -32,6 +36,7 @@ static int  perform_ota_update(void);
 static int  perform_recovery(void);
 static void jump_to_app(uint32_t addr);
 static int  flash_firmware(const char* filename);
+static int  apply_delta(const ota_meta_t* meta);
 static int  write_status(const char* msg);
 
 /* ---- Globals ---- */
@@ -40,6 +45,9 @@ static FATFS fs;
 /* 512-byte aligned buffer for f_read (used as both file I/O and flash staging) */
 static uint8_t io_buf[512] __attribute__((aligned(4)));
 
+/* One flash page of the new image, compared against flash before erasing */
+static uint8_t page_buf[FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+
 /* ---- Main ---- */
 int main(void)
 {
@@ -172,6 +180,13 @@ static int perform_ota_update(void)
     bl_print_hex("[BL] FW size: ", meta.fw_size);
     bl_print("\r\n");
 
+    /* Delta: rebuild firmware.bin first — flash is untouched until the
+     * rebuilt image passes the same CRC check as a full download */
+    int delta = (meta.flags & OTA_META_FLAG_DELTA) != 0;
+    if (delta && apply_delta(&meta) != 0) {
+        return -1;
+    }
+
     /* 3. Verify firmware.bin CRC */
     bl_print("[BL] Verifying firmware CRC...\r\n");
     if (f_open(&f, OTA_FW_FILENAME, FA_READ) != FR_OK) {
@@ -206,7 +221,94 @@ static int perform_ota_update(void)
     bl_print("[BL] CRC OK\r\n");
 
     /* 4. Flash firmware */
-    return flash_firmware(OTA_FW_FILENAME);
+    int result = flash_firmware(OTA_FW_FILENAME);
+    if (result == -2) {
+        /* App region half-written — put the previous image back */
+        bl_print("[BL] Falling back to fw_prev.bin\r\n");
+        if (perform_recovery() == 0) {
+            write_status("FAIL: flash, restored fw_prev.bin");
+        }
+        return -1;
+    }
+    if (result == 0 && delta) {
+        f_unlink(OTA_PATCH_FILENAME);
+    }
+    return result;
+}
+
+/* ---- Delta OTA: App flash + fw_patch.bin → firmware.bin ---- */
+typedef struct {
+    FIL* patch;
+    FIL* out;
+} delta_files_t;
+
+static int delta_read(void* ctx, uint8_t* buf, uint32_t len)
+{
+    UINT br;
+    if (f_read(((delta_files_t*)ctx)->patch, buf, len, &br) != FR_OK) return -1;
+    return (int)br;
+}
+
+static int delta_write(void* ctx, const uint8_t* buf, uint32_t len)
+{
+    UINT bw;
+    if (f_write(((delta_files_t*)ctx)->out, buf, len, &bw) != FR_OK || bw != len) {
+        return -1;
+    }
+    return 0;
+}
+
+static int apply_delta(const ota_meta_t* meta)
+{
+    FIL patch;
+    FIL out;
+    UINT br;
+    ota_delta_header_t hdr;
+
+    bl_print("[BL] Applying delta patch...\r\n");
+    if (f_open(&patch, OTA_PATCH_FILENAME, FA_READ) != FR_OK) {
+        bl_print("[BL] No fw_patch.bin\r\n");
+        write_status("FAIL: no fw_patch.bin");
+        return -1;
+    }
+    if (f_read(&patch, &hdr, sizeof(hdr), &br) != FR_OK || br != sizeof(hdr) ||
+        ota_delta_check_header(&hdr) != OTA_DELTA_OK ||
+        hdr.dst_size != meta->fw_size || hdr.dst_crc32 != meta->crc32) {
+        f_close(&patch);
+        bl_print("[BL] Patch header invalid\r\n");
+        write_status("FAIL: patch header");
+        return -1;
+    }
+    if (f_open(&out, OTA_FW_FILENAME, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        f_close(&patch);
+        write_status("FAIL: create firmware.bin");
+        return -1;
+    }
+
+    /* Source is the running App, read in place through the flash bus */
+    delta_files_t files = { &patch, &out };
+    ota_delta_io_t io;
+    io.read = delta_read;
+    io.write = delta_write;
+    io.ctx = &files;
+    io.src = (const uint8_t*)APP_FLASH_BASE;
+    io.buf = io_buf;
+    io.buf_size = sizeof(io_buf);
+
+    int rc = ota_delta_apply(&io, &hdr);
+    f_close(&out);
+    f_close(&patch);
+
+    if (rc != OTA_DELTA_OK) {
+        f_unlink(OTA_FW_FILENAME);
+        bl_print_hex("[BL] Delta FAILED: ", (uint32_t)-rc);
+        bl_print("\r\n");
+        write_status(rc == OTA_DELTA_ERR_SOURCE ? "FAIL: delta base mismatch"
+                                                : "FAIL: delta apply");
+        return -1;
+    }
+    bl_print("[BL] Delta OK\r\n");
+    return 0;
 }
 
 /* ---- Manual Recovery ---- */
@@ -223,7 +325,8 @@ static int perform_recovery(void)
     return flash_firmware(OTA_PREV_FILENAME);
 }
 
-/* ---- Common: erase + program + verify from file ---- */
+/* ---- Common: erase + program + verify from file ----
+ * Returns -1 with the App region untouched, -2 once it has been changed */
 static int flash_firmware(const char* filename)
 {
     FIL f;
@@ -237,47 +340,58 @@ static int flash_firmware(const char* filename)
 
     /* Calculate pages needed */
     uint32_t pages = (fw_size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
-    bl_print_hex("[BL] Erasing pages: ", pages);
-    bl_print("\r\n");
-
-    /* 1. Erase */
-    if (bl_flash_erase_app(pages) != 0) {
+    uint32_t max_pages = (KEY_STORE_BASE - APP_FLASH_BASE) / FLASH_PAGE_SIZE;
+    if (pages > max_pages) {
         f_close(&f);
-        bl_print("[BL] Erase FAILED\r\n");
-        write_status("FAIL: flash erase");
+        write_status("FAIL: image too large");
         return -1;
     }
-    bl_print("[BL] Erase OK\r\n");
+    bl_print_hex("[BL] Pages: ", pages);
+    bl_print("\r\n");
 
-    /* 2. Program */
+    /* 1. Erase + program page by page, skipping pages that already hold
+     *    the new contents (most of them after a delta update) */
     bl_print("[BL] Programming...\r\n");
-    uint32_t addr = APP_FLASH_BASE;
-    uint32_t programmed = 0;
+    uint32_t written = 0;
+
+    for (uint32_t p = 0; p < pages; p++) {
+        uint32_t addr = APP_FLASH_BASE + p * FLASH_PAGE_SIZE;
+        uint32_t chunk = fw_size - p * FLASH_PAGE_SIZE;
+        if (chunk > FLASH_PAGE_SIZE) chunk = FLASH_PAGE_SIZE;
+
+        uint32_t got = 0;
+        while (got < chunk) {
+            if (f_read(&f, page_buf + got, chunk - got, &br) != FR_OK || br == 0) {
+                f_close(&f);
+                bl_print("[BL] Read error during program\r\n");
+                write_status("FAIL: read during program");
+                return written ? -2 : -1;
+            }
+            got += br;
+        }
 
-    while (programmed < fw_size) {
-        uint32_t chunk = fw_size - programmed;
-        if (chunk > sizeof(io_buf)) chunk = sizeof(io_buf);
+        if (bl_flash_verify(addr, page_buf, chunk) == 0) continue;
 
-        if (f_read(&f, io_buf, chunk, &br) != FR_OK || br == 0) {
+        written++;
+        if (bl_flash_erase_page(addr) != 0) {
             f_close(&f);
-            bl_print("[BL] Read error during program\r\n");
-            write_status("FAIL: read during program");
-            return -1;
+            bl_print_hex("[BL] Erase FAILED at ", addr);
+            bl_print("\r\n");
+            write_status("FAIL: flash erase");
+            return -2;
         }
-
-        if (bl_flash_program(addr, io_buf, br) != 0) {
+        if (bl_flash_program(addr, page_buf, chunk) != 0) {
             f_close(&f);
             bl_print_hex("[BL] Program FAILED at ", addr);
             bl_print("\r\n");
             write_status("FAIL: flash program");
-            return -1;
+            return -2;
         }
-
-        addr += br;
-        programmed += br;
     }
     f_close(&f);
 
+    bl_print_hex("[BL] Pages written: ", written);
+    bl_print("\r\n");
     bl_print("[BL] Program OK\r\n");
 
     /* 3. Verify — CRC of flash contents */
@@ -304,7 +418,7 @@ static int flash_firmware(const char* filename)
     if (crc != file_crc) {
         bl_print("[BL] Verify FAILED — CRC mismatch\r\n");
         write_status("FAIL: verify CRC mismatch");
-        return -1;
+        return -2;
     }
 
     bl_print("[BL] Verify OK\r\n");
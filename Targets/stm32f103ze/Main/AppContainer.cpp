@@ -2,6 +2,7 @@
 #include "TimerServiceImpl.hpp"
 #include "LedServiceImpl.hpp"
 #include "SensorServiceImpl.hpp"
+#include "AcquisitionServiceImpl.hpp"
 #include "LcdServiceImpl.hpp"
 #ifdef ARCANA_LIGHT_SENSOR
 #include "LightServiceImpl.hpp"
@@ -13,6 +14,9 @@
 #include "BleServiceImpl.hpp"
 #include "OtaServiceImpl.hpp"
 #include "IoServiceImpl.hpp"
+#include "CommandBridge.hpp"
+#include "StreamCommands.hpp"
+#include "TelemetryPipeline.hpp"
 #include "MainViewModel.hpp"
 #include "MainView.hpp"
 #include "IDisplay.hpp"
@@ -30,6 +34,7 @@ AppContainer::AppContainer()
     : mTimer(0)
     , mLed(0)
     , mSensor(0)
+    , mAcq(0)
     , mLcd(0)
 #ifdef ARCANA_LIGHT_SENSOR
     , mLight(0)
@@ -69,6 +74,7 @@ void AppContainer::wireServices() {
     mTimer     = &timer::TimerServiceImpl::getInstance();
     mLed       = &led::LedServiceImpl::getInstance();
     mSensor    = &sensor::SensorServiceImpl::getInstance();
+    mAcq       = &acquisition::AcquisitionServiceImpl::getInstance();
     mLcd       = &lcd::LcdServiceImpl::getInstance();
 #ifdef ARCANA_LIGHT_SENSOR
     mLight     = &light::LightServiceImpl::getInstance();
@@ -83,21 +89,40 @@ void AppContainer::wireServices() {
     // Wire ECG callback: AtsStorage → AppContainer → MainView (decoupled)
     static_cast<atsstorage::AtsStorageServiceImpl*>(mSdStorage)->setEcgCallback(ecgCallback);
 
+    // Wire record streaming command: CommandBridge -> AtsStorage sensor DB
+    static StreamRecordsCommand sStreamRecordsCmd;
+    sStreamRecordsCmd.db = &static_cast<atsstorage::AtsStorageServiceImpl*>(mSdStorage)->getSensorDb();
+    sStreamRecordsCmd.cacheLock = &static_cast<atsstorage::AtsStorageServiceImpl*>(mSdStorage)->readCacheLock();
+    sStreamRecordsCmd.bridge = &CommandBridge::getInstance();
+    CommandBridge::getInstance().registerCommand(&sStreamRecordsCmd);
+
     // Wire OTA <- ESP8266
     static_cast<OtaServiceImpl*>(mOta)->input.esp = &Esp8266::getInstance();
 
     // Wire LED <- Timer
     mLed->input.TimerEvents = mTimer->output.BaseTimer;
 
+    // Wire Sensor + Light -> Acquisition (one task samples the shared I2C bus)
+    mSensor->input.Acquisition = mAcq;
+#ifdef ARCANA_LIGHT_SENSOR
+    mLight->input.Acquisition  = mAcq;
+#endif
+
+    // Telemetry pipeline <- Sensor + Light, subscribed ahead of the services
+    // below so each reading is encoded once before they are notified
+#ifdef ARCANA_LIGHT_SENSOR
+    TelemetryPipeline::getInstance().attach(mSensor->output.DataEvents,
+                                            mLight->output.DataEvents);
+#else
+    TelemetryPipeline::getInstance().attach(mSensor->output.DataEvents, 0);
+#endif
+
     // Wire SdStorage <- Sensor
     mSdStorage->input.SensorData = mSensor->output.DataEvents;
 
-    // Wire MQTT <- WiFi + Sensor + Light
+    // Wire MQTT <- WiFi + Sensor (light values come from the pipeline)
     mMqtt->input.Wifi       = mWifi;
     mMqtt->input.SensorData = mSensor->output.DataEvents;
-#ifdef ARCANA_LIGHT_SENSOR
-    mMqtt->input.LightData  = mLight->output.DataEvents;
-#endif
 
     // Wire BLE <- Sensor + Light (JSON streaming)
     mBle->input.SensorData = mSensor->output.DataEvents;
@@ -120,11 +145,13 @@ void AppContainer::wireViews() {
     // View ← ViewModel + LCD hardware
     sMainView.input.viewModel = &sViewModel;
     sMainView.input.lcd       = &mLcd->getDisplay();
+    sMainView.input.ecgSampleHz = atsstorage::AtsStorageServiceImpl::ECG_SAMPLE_HZ;
 }
 
 void AppContainer::initHAL() {
     mTimer->initHAL();
     mLed->initHAL();
+    mAcq->initHAL();
     mSensor->initHAL();
 #ifdef ARCANA_LIGHT_SENSOR
     mLight->initHAL();
@@ -153,6 +180,7 @@ void AppContainer::initHAL() {
 void AppContainer::initServices() {
     mTimer->init();
     mLed->init();
+    mAcq->init();
     mSensor->init();
 #ifdef ARCANA_LIGHT_SENSOR
     mLight->init();
@@ -180,6 +208,7 @@ void AppContainer::startServices() {
 #ifdef ARCANA_LIGHT_SENSOR
     mLight->start();
 #endif
+    mAcq->start();            // after every plan is registered
     mSdStorage->start();
     mWifi->start();
     mMqtt->start();
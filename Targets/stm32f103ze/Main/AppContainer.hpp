@@ -3,6 +3,7 @@
 #include "ITimerService.hpp"
 #include "LedService.hpp"
 #include "SensorService.hpp"
+#include "AcquisitionService.hpp"
 #include "LcdService.hpp"
 #ifdef ARCANA_LIGHT_SENSOR
 #include "LightService.hpp"
@@ -44,6 +45,7 @@ private:
     timer::TimerService*             mTimer;
     led::LedService*                 mLed;
     sensor::SensorService*           mSensor;
+    acquisition::AcquisitionService* mAcq;
     lcd::LcdService*                 mLcd;
 #ifdef ARCANA_LIGHT_SENSOR
     light::LightService*             mLight;
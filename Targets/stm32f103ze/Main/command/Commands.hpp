@@ -23,9 +23,9 @@ namespace arcana {
 
 class GetFwVersionCommand : public ICommand {
 public:
-    CommandKey getKey() const override {
-        return { Cluster::System, SystemCommand::GetFwVersion };
-    }
+    static constexpr CommandKey kKey = { Cluster::System, SystemCommand::GetFwVersion };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest&, CommandResponseModel& rsp) override {
         const char* ver = __DATE__;  // "Mar 17 2026"
         uint8_t len = strlen(ver);
@@ -39,9 +39,9 @@ public:
 
 class GetCompileTimeCommand : public ICommand {
 public:
-    CommandKey getKey() const override {
-        return { Cluster::System, SystemCommand::GetCompileTime };
-    }
+    static constexpr CommandKey kKey = { Cluster::System, SystemCommand::GetCompileTime };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest&, CommandResponseModel& rsp) override {
         // "Mar 17 2026 14:30:00"
         char buf[24];
@@ -62,9 +62,9 @@ public:
 
 class GetDeviceModelCommand : public ICommand {
 public:
-    CommandKey getKey() const override {
-        return { Cluster::Device, DeviceCommand::GetModel };
-    }
+    static constexpr CommandKey kKey = { Cluster::Device, DeviceCommand::GetModel };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest&, CommandResponseModel& rsp) override {
         const char* model = "STM32F103ZE";
         uint8_t len = strlen(model);
@@ -76,9 +76,9 @@ public:
 
 class GetSerialNumberCommand : public ICommand {
 public:
-    CommandKey getKey() const override {
-        return { Cluster::Device, DeviceCommand::GetSerialNumber };
-    }
+    static constexpr CommandKey kKey = { Cluster::Device, DeviceCommand::GetSerialNumber };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest&, CommandResponseModel& rsp) override {
         // Read 12-byte UID, output as 24-char hex string
         const uint8_t* uid = reinterpret_cast<const uint8_t*>(UID_BASE);
@@ -101,9 +101,9 @@ class GetTemperatureCommand : public ICommand {
 public:
     const SensorDataCache* cache = nullptr;
 
-    CommandKey getKey() const override {
-        return { Cluster::Sensor, SensorCommand::GetTemperature };
-    }
+    static constexpr CommandKey kKey = { Cluster::Sensor, SensorCommand::GetTemperature };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest&, CommandResponseModel& rsp) override {
         if (!cache) { rsp.status = CommandStatus::Error; return; }
         int16_t t10 = static_cast<int16_t>(cache->temp * 10.0f);
@@ -118,9 +118,9 @@ class GetAccelCommand : public ICommand {
 public:
     const SensorDataCache* cache = nullptr;
 
-    CommandKey getKey() const override {
-        return { Cluster::Sensor, SensorCommand::GetAccel };
-    }
+    static constexpr CommandKey kKey = { Cluster::Sensor, SensorCommand::GetAccel };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest&, CommandResponseModel& rsp) override {
         if (!cache) { rsp.status = CommandStatus::Error; return; }
         rsp.data[0] = static_cast<uint8_t>(cache->ax & 0xFF);
@@ -138,9 +138,9 @@ class GetLightCommand : public ICommand {
 public:
     const SensorDataCache* cache = nullptr;
 
-    CommandKey getKey() const override {
-        return { Cluster::Sensor, SensorCommand::GetLight };
-    }
+    static constexpr CommandKey kKey = { Cluster::Sensor, SensorCommand::GetLight };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest&, CommandResponseModel& rsp) override {
         if (!cache) { rsp.status = CommandStatus::Error; return; }
         rsp.data[0] = static_cast<uint8_t>(cache->als & 0xFF);
@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * @file StreamCommands.hpp
+ * @brief Commands that answer with a stream transfer instead of one response
+ *
+ * The command response only carries the transfer header; the data follows
+ * as StreamCodec DATA frames on the stream SID of the requesting transport.
+ * Registered at runtime (AppContainer) — they need the ATS database, which
+ * the bridge itself does not depend on.
+ */
+
+#include "ICommand.hpp"
+#include "CommandBridge.hpp"
+#include "AtsQuerySource.hpp"
+
+namespace arcana {
+
+/**
+ * @brief Stream ArcanaTS records of one channel
+ *
+ * Params (8 bytes):
+ *   [channel][mode][start:4 LE][arg:2 LE]
+ *   mode 0 = time range: start epoch, arg = span in minutes (0 = to the end)
+ *   mode 1 = latest N:   start ignored, arg = record count
+ *
+ * Response data: [xferId][recordSize:2 LE][chunkSize][window][count:2 LE]
+ *   count = latest N after clamping to one AtsQuerySource page, i.e. the
+ *   most records that will follow; 0 in range mode (open-ended)
+ */
+class StreamRecordsCommand : public ICommand {
+public:
+    const ats::ArcanaTsDb* db = nullptr;
+    CommandBridge* bridge = nullptr;
+    ats::IMutex* cacheLock = nullptr;     // owner of the DB's read cache
+
+    static constexpr CommandKey kKey = { Cluster::Sensor, SensorCommand::StreamRecords };
+    static constexpr uint8_t MODE_RANGE  = 0;
+    static constexpr uint8_t MODE_LATEST = 1;
+
+    CommandKey getKey() const override { return kKey; }
+    void execute(const CommandRequest& req, CommandResponseModel& rsp) override {
+        if (!db || !bridge || !db->isOpen()) { rsp.status = CommandStatus::Error; return; }
+        if (req.paramsLength < 8) { rsp.status = CommandStatus::InvalidParam; return; }
+        if (bridge->isStreaming()) { rsp.status = CommandStatus::Busy; return; }
+
+        uint8_t channel = req.params[0];
+        uint8_t mode = req.params[1];
+        uint32_t start = static_cast<uint32_t>(req.params[2])
+                       | (static_cast<uint32_t>(req.params[3]) << 8)
+                       | (static_cast<uint32_t>(req.params[4]) << 16)
+                       | (static_cast<uint32_t>(req.params[5]) << 24);
+        uint16_t arg = static_cast<uint16_t>(req.params[6] | (req.params[7] << 8));
+
+        mSource.setCacheLock(cacheLock);
+        bool ok = false;
+        if (mode == MODE_RANGE) {
+            uint32_t end = 0xFFFFFFFFu;
+            uint64_t span = static_cast<uint64_t>(arg) * 60u;
+            if (arg != 0 && start + span < end) end = static_cast<uint32_t>(start + span);
+            ok = mSource.beginRange(db, channel, start, end);
+        } else if (mode == MODE_LATEST) {
+            ok = mSource.beginLatest(db, channel, arg);
+        }
+        if (!ok) { rsp.status = CommandStatus::InvalidParam; return; }
+
+        uint8_t xferId = 0;
+        if (!bridge->beginStream(&mSource, xferId)) { rsp.status = CommandStatus::Busy; return; }
+
+        uint16_t recSize = mSource.recordSize();
+        rsp.data[0] = xferId;
+        rsp.data[1] = static_cast<uint8_t>(recSize & 0xFF);
+        rsp.data[2] = static_cast<uint8_t>(recSize >> 8);
+        rsp.data[3] = CommandBridge::STREAM_CHUNK;
+        rsp.data[4] = CommandBridge::STREAM_WINDOW;
+        uint16_t count = mSource.latestCount();
+        rsp.data[5] = static_cast<uint8_t>(count & 0xFF);
+        rsp.data[6] = static_cast<uint8_t>(count >> 8);
+        rsp.dataLength = 7;
+        rsp.status = CommandStatus::Success;
+    }
+
+private:
+    AtsQuerySource mSource;
+};
+
+} // namespace arcana
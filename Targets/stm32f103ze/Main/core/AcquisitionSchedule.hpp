@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstdint>
+#include "F103Models.hpp"
+
+namespace arcana {
+
+/** One bus transaction of a release, handed to the plan's sample function */
+struct AcqSlot {
+    uint32_t dueMs;      // release time on the plan's grid
+    uint32_t stampMs;    // when this transaction started
+    uint32_t stampUs;    // same instant on the microsecond clock
+    uint8_t index;       // position within the burst
+};
+
+enum class AcqStatus : uint8_t {
+    Done,                // release complete, end the burst
+    More,                // run the next transaction of the burst
+    Error                // transaction failed, counted, burst ends
+};
+
+typedef AcqStatus (*AcqSampleFn)(void* ctx, const AcqSlot& slot);
+
+/**
+ * Sampling plan: releases on the grid phaseMs + k * periodMs, each running
+ * up to burst back-to-back transactions. Phases spread plans that share a
+ * period so their releases do not pile onto the same tick.
+ */
+struct AcqPlan {
+    AcqSampleFn sample;
+    void* ctx;
+    uint32_t periodMs;
+    uint32_t phaseMs;
+    uint8_t burst;
+};
+
+/**
+ * Multi-rate sampling table, run from a single task.
+ *
+ * runDue() executes every release that is due, earliest first with table
+ * order breaking ties, so transactions of different sensors never overlap
+ * on the bus. Each transaction is stamped on a free-running microsecond
+ * clock right before its sample function runs; the first stamp of a
+ * release against its grid time is the release jitter.
+ *
+ * The grid never drifts: a release that starts a whole period or more
+ * late runs once for the newest slot and counts the skipped ones missed.
+ *
+ * start() ties the microsecond clock to the ms time base. Call it on a
+ * tick edge (right after a delay returns) so jitter reads as scheduling
+ * latency rather than where in the tick the anchor happened to fall.
+ */
+class AcquisitionSchedule {
+public:
+    static const uint8_t MAX_PLANS = AcquisitionStatsModel::MAX_PLANS;
+    typedef uint32_t (*ClockUs)();
+
+    AcquisitionSchedule()
+        : mClock(0)
+        , mPlans{}
+        , mNext{}
+        , mStats{}
+        , mJitterSum{}
+        , mCount(0)
+        , mStarted(false)
+        , mAnchorMs(0)
+        , mAnchorUs(0)
+        , mWindowMs(0)
+        , mBusyUs(0)
+        , mTotalMissed(0) {}
+
+    void setClock(ClockUs clock) { mClock = clock; }
+
+    /**
+     * Add a plan, or replace the one with the same sample/ctx pair.
+     * Plans are fixed once the schedule runs.
+     */
+    bool add(const AcqPlan& plan) {
+        if (mStarted || !plan.sample || plan.periodMs == 0) return false;
+        AcqPlan p = plan;
+        if (p.burst == 0) p.burst = 1;
+        for (uint8_t i = 0; i < mCount; i++) {
+            if (mPlans[i].sample == p.sample && mPlans[i].ctx == p.ctx) {
+                mPlans[i] = p;
+                return true;
+            }
+        }
+        if (mCount >= MAX_PLANS) return false;
+        mPlans[mCount++] = p;
+        return true;
+    }
+
+    uint8_t planCount() const { return mCount; }
+    bool started() const { return mStarted; }
+
+    void start(uint32_t nowMs) {
+        mAnchorMs = nowMs;
+        mAnchorUs = clockUs();
+        for (uint8_t i = 0; i < mCount; i++) {
+            mNext[i] = nowMs + mPlans[i].phaseMs;
+        }
+        resetWindow(nowMs);
+        mTotalMissed = 0;
+        mStarted = true;
+    }
+
+    void stop() { mStarted = false; }
+
+    /** Earliest pending release; idleMs ahead when there is nothing to run */
+    uint32_t nextDueMs(uint32_t nowMs, uint32_t idleMs) const {
+        if (!mStarted || mCount == 0) return nowMs + idleMs;
+        uint32_t best = mNext[0];
+        for (uint8_t i = 1; i < mCount; i++) {
+            if ((int32_t)(mNext[i] - best) < 0) best = mNext[i];
+        }
+        return best;
+    }
+
+    /** Run everything due at nowMs; returns the number of releases */
+    uint8_t runDue(uint32_t nowMs) {
+        if (!mStarted) return 0;
+        uint8_t releases = 0;
+        for (;;) {
+            int8_t pick = -1;
+            for (uint8_t i = 0; i < mCount; i++) {
+                if ((int32_t)(nowMs - mNext[i]) < 0) continue;
+                if (pick < 0 || (int32_t)(mNext[i] - mNext[pick]) < 0) pick = (int8_t)i;
+            }
+            if (pick < 0) return releases;
+            release((uint8_t)pick, nowMs);
+            releases++;
+        }
+    }
+
+    /** Copy the window's statistics out and start a new window */
+    void collect(AcquisitionStatsModel& out, uint32_t nowMs) {
+        uint32_t windowMs = nowMs - mWindowMs;
+        out.planCount = mCount;
+        out.windowMs = windowMs > 0xFFFF ? 0xFFFF : (uint16_t)windowMs;
+        for (uint8_t i = 0; i < mCount; i++) {
+            AcquisitionStatsModel::Plan& p = out.plan[i];
+            p = mStats[i];
+            p.jitterAvgUs = p.releases ? sat16(mJitterSum[i] / p.releases) : 0;
+        }
+        uint32_t permille = windowMs ? mBusyUs / windowMs : 0;
+        out.busyPermille = permille > 1000 ? 1000 : (uint16_t)permille;
+        out.totalMissed = mTotalMissed;
+        resetWindow(nowMs);
+    }
+
+private:
+    uint32_t clockUs() const { return mClock ? mClock() : 0; }
+
+    static uint16_t sat16(uint32_t v) { return v > 0xFFFF ? 0xFFFF : (uint16_t)v; }
+
+    void release(uint8_t i, uint32_t nowMs) {
+        const AcqPlan& plan = mPlans[i];
+        AcquisitionStatsModel::Plan& st = mStats[i];
+
+        uint32_t behind = (nowMs - mNext[i]) / plan.periodMs;
+        if (behind > 0) {
+            st.missed = sat16((uint32_t)st.missed + behind);
+            mTotalMissed += behind;
+            mNext[i] += behind * plan.periodMs;
+        }
+
+        AcqSlot slot;
+        slot.dueMs = mNext[i];
+        // Clock and tick run off the same oscillator: the grid maps onto
+        // the microsecond clock exactly, wrap included
+        uint32_t dueUs = mAnchorUs + (slot.dueMs - mAnchorMs) * 1000;
+        uint32_t t0 = clockUs();
+        int32_t late = (int32_t)(t0 - dueUs);
+        if (late < 0) late = 0;
+
+        for (uint8_t b = 0; b < plan.burst; b++) {
+            slot.stampUs = b == 0 ? t0 : clockUs();
+            slot.stampMs = slot.dueMs + (uint32_t)((int32_t)(slot.stampUs - dueUs) / 1000);
+            slot.index = b;
+            AcqStatus s = plan.sample(plan.ctx, slot);
+            if (s == AcqStatus::Error) {
+                if (st.errors < 0xFFFF) st.errors++;
+                break;
+            }
+            if (s == AcqStatus::Done) break;
+        }
+
+        uint32_t busy = clockUs() - t0;
+        mBusyUs += busy;
+        if (st.releases < 0xFFFF) st.releases++;
+        mJitterSum[i] += (uint32_t)late;
+        if ((uint32_t)late > st.jitterMaxUs) st.jitterMaxUs = sat16((uint32_t)late);
+        if (busy > st.busMaxUs) st.busMaxUs = sat16(busy);
+
+        mNext[i] += plan.periodMs;
+    }
+
+    void resetWindow(uint32_t nowMs) {
+        for (uint8_t i = 0; i < MAX_PLANS; i++) {
+            mStats[i] = AcquisitionStatsModel::Plan();
+            mJitterSum[i] = 0;
+        }
+        mWindowMs = nowMs;
+        mBusyUs = 0;
+    }
+
+    ClockUs mClock;
+    AcqPlan mPlans[MAX_PLANS];
+    uint32_t mNext[MAX_PLANS];
+    AcquisitionStatsModel::Plan mStats[MAX_PLANS];
+    uint32_t mJitterSum[MAX_PLANS];
+    uint8_t mCount;
+    bool mStarted;
+    uint32_t mAnchorMs;
+    uint32_t mAnchorUs;
+    uint32_t mWindowMs;
+    uint32_t mBusyUs;
+    uint32_t mTotalMissed;
+};
+
+} // namespace arcana
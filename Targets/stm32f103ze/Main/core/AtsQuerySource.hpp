@@ -0,0 +1,177 @@
+/**
+ * @file AtsQuerySource.hpp
+ * @brief Stream source — serves ArcanaTS query results as a byte stream
+ *
+ * Adapts ArcanaTsDb queries to IStreamSource so CommandBridge can stream
+ * records over BLE/MQTT without holding the whole result in RAM. Records
+ * are staged a buffer-full at a time and handed out as raw bytes, so one
+ * record may span two stream chunks.
+ *
+ * Range mode pages through queryByTime() with a (timestamp, skip) cursor:
+ * records sharing the cursor timestamp that were already sent are skipped,
+ * so duplicate timestamps at a page boundary are neither lost nor repeated.
+ * Latest-N mode is a single queryLatest(), so N is clamped to one staging
+ * buffer (STAGING_SIZE / recordSize records); latestCount() reports the
+ * clamped N so the requester learns it up front rather than from a short
+ * stream.
+ *
+ * An optional cache lock is held around each query: the DB's read cache is
+ * lent to the HTTP upload, which owns it through that lock meanwhile.
+ */
+
+#pragma once
+
+#include "StreamSender.hpp"
+#include "ats/ArcanaTsDb.hpp"
+#include <cstring>
+
+namespace arcana {
+
+class AtsQuerySource : public IStreamSource {
+public:
+    static const uint16_t STAGING_SIZE = 1024;
+
+    AtsQuerySource()
+        : mDb(nullptr), mCacheLock(nullptr), mChannel(0), mRecordSize(0), mLatest(false)
+        , mCursorTs(0), mEndTs(0), mSkip(0), mRemaining(0)
+        , mStagedLen(0), mReadPos(0), mDone(true) {}
+
+    /**
+     * @brief Stream all records with start <= ts <= end
+     * @return false if the channel does not exist
+     */
+    bool beginRange(const ats::ArcanaTsDb* db, uint8_t channel,
+                    uint32_t start, uint32_t end) {
+        if (!reset(db, channel)) return false;
+        mLatest = false;
+        mCursorTs = start;
+        mEndTs = end;
+        mDone = start > end;
+        return true;
+    }
+
+    /**
+     * @brief Stream the newest `count` records (oldest first)
+     *
+     * `count` is clamped to one staging buffer; see latestCount().
+     * @return false if the channel does not exist
+     */
+    bool beginLatest(const ats::ArcanaTsDb* db, uint8_t channel, uint16_t count) {
+        if (!reset(db, channel)) return false;
+        uint16_t maxRecords = STAGING_SIZE / mRecordSize;
+        if (count > maxRecords) count = maxRecords;
+        mLatest = true;
+        mRemaining = count;
+        mDone = count == 0;
+        return true;
+    }
+
+    size_t read(uint8_t* dst, size_t cap) override {
+        size_t n = 0;
+        while (n < cap) {
+            if (mReadPos == mStagedLen) {
+                if (mDone || !refill()) break;
+            }
+            size_t take = mStagedLen - mReadPos;
+            if (take > cap - n) take = cap - n;
+            memcpy(dst + n, mStaging + mReadPos, take);
+            mReadPos += static_cast<uint16_t>(take);
+            n += take;
+        }
+        return n;
+    }
+
+    uint16_t recordSize() const { return mRecordSize; }
+
+    /** Latest-N mode: records asked for after clamping (an upper bound) */
+    uint16_t latestCount() const { return mLatest ? mRemaining : 0; }
+
+    /** Lock taken around every DB query (nullptr = none) */
+    void setCacheLock(ats::IMutex* lock) { mCacheLock = lock; }
+
+private:
+    bool reset(const ats::ArcanaTsDb* db, uint8_t channel) {
+        mDb = db;
+        mChannel = channel;
+        mSkip = 0;
+        mStagedLen = 0;
+        mReadPos = 0;
+        mDone = true;
+        const ats::ArcanaTsSchema* schema = db ? db->getSchema(channel) : nullptr;
+        if (!schema || schema->recordSize == 0 || schema->recordSize > STAGING_SIZE)
+            return false;
+        mRecordSize = schema->recordSize;
+        return true;
+    }
+
+    /** Stage the next page of records; false when nothing is left */
+    bool refill() {
+        mStagedLen = 0;
+        mReadPos = 0;
+        uint16_t maxRecords = STAGING_SIZE / mRecordSize;
+
+        if (mLatest) {
+            if (mCacheLock) mCacheLock->lock();
+            uint16_t got = mDb->queryLatest(mChannel, mStaging, mRemaining);
+            if (mCacheLock) mCacheLock->unlock();
+            mStagedLen = static_cast<uint16_t>(got * mRecordSize);
+            mDone = true;
+            return got > 0;
+        }
+
+        PageCtx ctx = { this, maxRecords, 0, 0, mCursorTs, 0 };
+        if (mCacheLock) mCacheLock->lock();
+        mDb->queryByTime(mChannel, mCursorTs, mEndTs, collect, &ctx);
+        if (mCacheLock) mCacheLock->unlock();
+
+        if (ctx.count < maxRecords) mDone = true;   // range exhausted
+        if (ctx.count > 0) {
+            mSkip = (ctx.lastTs == mCursorTs) ? static_cast<uint16_t>(mSkip + ctx.sameTs)
+                                              : ctx.sameTs;
+            mCursorTs = ctx.lastTs;
+        }
+        mStagedLen = static_cast<uint16_t>(ctx.count * mRecordSize);
+        return ctx.count > 0;
+    }
+
+    struct PageCtx {
+        AtsQuerySource* self;
+        uint16_t maxRecords;
+        uint16_t count;
+        uint16_t seenAtCursor;  // records at the cursor ts passed so far
+        uint32_t lastTs;
+        uint16_t sameTs;        // records in this page sharing lastTs
+    };
+
+    static bool collect(uint8_t, const uint8_t* rec, uint32_t ts, void* arg) {
+        PageCtx* c = static_cast<PageCtx*>(arg);
+        AtsQuerySource* s = c->self;
+        if (ts == s->mCursorTs && c->seenAtCursor < s->mSkip) {
+            c->seenAtCursor++;
+            return false;
+        }
+        memcpy(s->mStaging + c->count * s->mRecordSize, rec, s->mRecordSize);
+        c->sameTs = (c->count > 0 && ts == c->lastTs) ? static_cast<uint16_t>(c->sameTs + 1) : 1;
+        c->lastTs = ts;
+        return ++c->count >= c->maxRecords;   // stop early when the page is full
+    }
+
+    const ats::ArcanaTsDb* mDb;
+    ats::IMutex* mCacheLock;
+    uint8_t mChannel;
+    uint16_t mRecordSize;
+    bool mLatest;
+
+    // Range cursor
+    uint32_t mCursorTs;
+    uint32_t mEndTs;
+    uint16_t mSkip;
+    uint16_t mRemaining;
+
+    uint8_t mStaging[STAGING_SIZE];
+    uint16_t mStagedLen;
+    uint16_t mReadPos;
+    bool mDone;
+};
+
+} // namespace arcana
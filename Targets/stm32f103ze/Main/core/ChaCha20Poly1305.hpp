@@ -0,0 +1,234 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "ChaCha20.hpp"
+
+namespace arcana {
+namespace crypto {
+
+/**
+ * Poly1305 one-time authenticator (RFC 8439 §2.5).
+ * 26-bit limbs, 32x32→64 multiplies only (Cortex-M3 UMULL), streaming.
+ */
+class Poly1305 {
+public:
+    static const uint8_t KEY_SIZE = 32;
+    static const uint8_t TAG_SIZE = 16;
+
+    explicit Poly1305(const uint8_t key[KEY_SIZE])
+        : mR{}, mH{}, mPad{}, mBuf{}, mLeftover(0) {
+        mR[0] = (loadLE32(key +  0)     ) & 0x3ffffff;
+        mR[1] = (loadLE32(key +  3) >> 2) & 0x3ffff03;
+        mR[2] = (loadLE32(key +  6) >> 4) & 0x3ffc0ff;
+        mR[3] = (loadLE32(key +  9) >> 6) & 0x3f03fff;
+        mR[4] = (loadLE32(key + 12) >> 8) & 0x00fffff;
+        for (int i = 0; i < 4; i++) mPad[i] = loadLE32(key + 16 + i * 4);
+    }
+
+    void update(const uint8_t* m, size_t len) {
+        if (mLeftover) {
+            size_t want = 16 - mLeftover;
+            if (want > len) want = len;
+            memcpy(mBuf + mLeftover, m, want);
+            m += want;
+            len -= want;
+            mLeftover += want;
+            if (mLeftover < 16) return;
+            blocks(mBuf, 16, 1u << 24);
+            mLeftover = 0;
+        }
+        if (len >= 16) {
+            size_t whole = len & ~(size_t)15;
+            blocks(m, whole, 1u << 24);
+            m += whole;
+            len -= whole;
+        }
+        if (len) {
+            memcpy(mBuf, m, len);
+            mLeftover = len;
+        }
+    }
+
+    /** Zero-pad the message to a 16-byte boundary (AEAD layout) */
+    void pad16() {
+        if (!mLeftover) return;
+        memset(mBuf + mLeftover, 0, 16 - mLeftover);
+        blocks(mBuf, 16, 1u << 24);
+        mLeftover = 0;
+    }
+
+    void finish(uint8_t tag[TAG_SIZE]) {
+        if (mLeftover) {
+            mBuf[mLeftover] = 1;
+            memset(mBuf + mLeftover + 1, 0, 15 - mLeftover);
+            blocks(mBuf, 16, 0);
+        }
+
+        uint32_t h0 = mH[0], h1 = mH[1], h2 = mH[2], h3 = mH[3], h4 = mH[4];
+        uint32_t c;
+        c = h1 >> 26; h1 &= 0x3ffffff;
+        h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+        h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+        h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+        h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+        h1 += c;
+
+        // g = h - p = h + 5 - 2^130; keep h if that went negative
+        uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+        uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+        uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+        uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+        uint32_t g4 = h4 + c - (1u << 26);
+        uint32_t mask = (g4 >> 31) - 1;
+        h0 = (h0 & ~mask) | (g0 & mask);
+        h1 = (h1 & ~mask) | (g1 & mask);
+        h2 = (h2 & ~mask) | (g2 & mask);
+        h3 = (h3 & ~mask) | (g3 & mask);
+        h4 = (h4 & ~mask) | (g4 & mask);
+
+        // tag = (h + s) mod 2^128
+        uint32_t w[4];
+        w[0] = h0 | (h1 << 26);
+        w[1] = (h1 >> 6) | (h2 << 20);
+        w[2] = (h2 >> 12) | (h3 << 14);
+        w[3] = (h3 >> 18) | (h4 << 8);
+        uint64_t f = 0;
+        for (int i = 0; i < 4; i++) {
+            f = (uint64_t)w[i] + mPad[i] + (f >> 32);
+            storeLE32(tag + i * 4, (uint32_t)f);
+        }
+
+        memset(mH, 0, sizeof(mH));
+        memset(mR, 0, sizeof(mR));
+        memset(mPad, 0, sizeof(mPad));
+    }
+
+    static void mac(const uint8_t key[KEY_SIZE], const uint8_t* m, size_t len,
+                    uint8_t tag[TAG_SIZE]) {
+        Poly1305 p(key);
+        p.update(m, len);
+        p.finish(tag);
+    }
+
+private:
+    static uint32_t loadLE32(const uint8_t* p) {
+        return (uint32_t)p[0]       | ((uint32_t)p[1] << 8) |
+               ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static void storeLE32(uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+        p[3] = (uint8_t)(v >> 24);
+    }
+
+    // h = (h + m + hibit) * r mod 2^130 - 5, 16 bytes at a time
+    void blocks(const uint8_t* m, size_t len, uint32_t hibit) {
+        const uint32_t r0 = mR[0], r1 = mR[1], r2 = mR[2], r3 = mR[3], r4 = mR[4];
+        const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+        uint32_t h0 = mH[0], h1 = mH[1], h2 = mH[2], h3 = mH[3], h4 = mH[4];
+
+        while (len >= 16) {
+            h0 += (loadLE32(m +  0)     ) & 0x3ffffff;
+            h1 += (loadLE32(m +  3) >> 2) & 0x3ffffff;
+            h2 += (loadLE32(m +  6) >> 4) & 0x3ffffff;
+            h3 += (loadLE32(m +  9) >> 6) & 0x3ffffff;
+            h4 += (loadLE32(m + 12) >> 8) | hibit;
+
+            uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 +
+                          (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+            uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 +
+                          (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+            uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 +
+                          (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+            uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 +
+                          (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+            uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 +
+                          (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+            uint32_t c;
+            c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+            d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+            d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+            d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+            d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+            h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+            h1 += c;
+
+            m += 16;
+            len -= 16;
+        }
+
+        mH[0] = h0; mH[1] = h1; mH[2] = h2; mH[3] = h3; mH[4] = h4;
+    }
+
+    uint32_t mR[5];
+    uint32_t mH[5];
+    uint32_t mPad[4];
+    uint8_t  mBuf[16];
+    size_t   mLeftover;
+};
+
+/**
+ * ChaCha20-Poly1305 AEAD (RFC 8439 §2.8), in place.
+ * Block 0 of the key stream is the Poly1305 key, data starts at block 1.
+ * The tag covers aad and ciphertext; open() checks it before decrypting.
+ */
+class ChaCha20Poly1305 {
+public:
+    static const uint8_t KEY_SIZE   = ChaCha20::KEY_SIZE;
+    static const uint8_t NONCE_SIZE = ChaCha20::NONCE_SIZE;
+    static const uint8_t TAG_SIZE   = Poly1305::TAG_SIZE;
+
+    static void seal(const uint8_t key[KEY_SIZE], const uint8_t nonce[NONCE_SIZE],
+                     const uint8_t* aad, size_t aadLen,
+                     uint8_t* data, size_t len, uint8_t tag[TAG_SIZE]) {
+        ChaCha20::crypt(key, nonce, 1, data, (uint32_t)len);
+        computeTag(key, nonce, aad, aadLen, data, len, tag);
+    }
+
+    /** @return false (data untouched) if the tag does not match */
+    static bool open(const uint8_t key[KEY_SIZE], const uint8_t nonce[NONCE_SIZE],
+                     const uint8_t* aad, size_t aadLen,
+                     uint8_t* data, size_t len, const uint8_t tag[TAG_SIZE]) {
+        uint8_t expected[TAG_SIZE];
+        computeTag(key, nonce, aad, aadLen, data, len, expected);
+        uint8_t diff = 0;
+        for (uint8_t i = 0; i < TAG_SIZE; i++) diff |= expected[i] ^ tag[i];
+        if (diff != 0) return false;
+        ChaCha20::crypt(key, nonce, 1, data, (uint32_t)len);
+        return true;
+    }
+
+private:
+    static void computeTag(const uint8_t* key, const uint8_t* nonce,
+                           const uint8_t* aad, size_t aadLen,
+                           const uint8_t* cipher, size_t len, uint8_t* tag) {
+        uint8_t otk[Poly1305::KEY_SIZE] = {};
+        ChaCha20::crypt(key, nonce, 0, otk, sizeof(otk));
+
+        Poly1305 p(otk);
+        memset(otk, 0, sizeof(otk));
+        if (aadLen) {
+            p.update(aad, aadLen);
+            p.pad16();
+        }
+        p.update(cipher, len);
+        p.pad16();
+
+        uint8_t lens[16];
+        uint64_t a = aadLen, c = len;
+        for (int i = 0; i < 8; i++) {
+            lens[i]     = (uint8_t)(a >> (8 * i));
+            lens[8 + i] = (uint8_t)(c >> (8 * i));
+        }
+        p.update(lens, sizeof(lens));
+        p.finish(tag);
+    }
+};
+
+} // namespace crypto
+} // namespace arcana
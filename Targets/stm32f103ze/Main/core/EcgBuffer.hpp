@@ -2,13 +2,15 @@
 
 #include <cstdint>
 #include "IDisplay.hpp"
+#include "EcgSweep.hpp"
 
 namespace arcana {
 
 /**
  * Real-time ECG sweep display.
- * Draws one column at a time directly to LCD from the producer task.
  * Sweep: 240 columns, ~960ms per sweep at 250Hz update.
+ * Producers may push() several samples and flush() once; pushAndDraw()
+ * is the one-sample shorthand.
  */
 struct EcgDisplay {
     static const uint16_t WIDTH  = 240;
@@ -16,15 +18,25 @@ struct EcgDisplay {
     static const uint16_t HEIGHT = 100;
 
     display::IDisplay* lcd;
-    uint16_t cursor;          // current X position (0-239)
-    uint8_t  prevY;           // previous sample Y for line connection
+    EcgSweep<1> sweep;
 
-    void init(display::IDisplay* lcdPtr) {
+    void init(display::IDisplay* lcdPtr, uint16_t sampleRateHz = 250) {
         lcd = lcdPtr;
-        cursor = 0;
-        prevY = 70;  // baseline
+        EcgSweep<1>::Config cfg = {};
+        cfg.x = 0;
+        cfg.y = TOP_Y;
+        cfg.width = WIDTH;
+        cfg.height = HEIGHT;
+        cfg.sampleRateHz = sampleRateHz;
+        cfg.columnsPerSec = 250;        // 1 column per sample at 250Hz
+        cfg.gap = 4;
+        cfg.bg = display::colors::BLACK;
+        cfg.color[0] = display::colors::GREEN;
+        sweep.begin(cfg);
     }
 
+    void push(uint8_t y) { sweep.push(&y); }
+    void flush() { if (lcd) sweep.flush(*lcd); }
     void pushAndDraw(uint8_t y);  // implemented in .cpp (needs IDisplay methods)
 };
 
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstdint>
+#include "IDisplay.hpp"
+
+namespace arcana {
+
+/**
+ * Batched sweep-mode ECG renderer.
+ *
+ * Samples are pushed as they arrive and turned into pixel columns by the
+ * sweep speed: above the column rate several samples fold into one column
+ * as a min/max envelope (QRS spikes survive decimation), below it one
+ * sample stretches over several columns. Each column also spans the last
+ * value of the previous one so the trace stays connected.
+ *
+ * flush() draws every pending column:
+ *  - one fillRect blanks the newly exposed part of the gap ahead of the
+ *    cursor (each column is erased once per sweep, not once per sample)
+ *  - the trace is composited into an RGB565 strip covering only the rows
+ *    it touches, and pushed with one drawBitmap16 — the strip takes as
+ *    many columns as fit in StripPixels
+ *
+ * @tparam Leads       Traces drawn in the same area (later leads on top)
+ * @tparam StripPixels Composite buffer size; a strip is one window write
+ */
+template <uint8_t Leads, uint16_t StripPixels = 400>
+class EcgSweep {
+    static_assert(Leads > 0, "at least one lead");
+
+public:
+    static const uint8_t MAX_PENDING = 32;   // columns between flushes
+
+    struct Config {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint8_t height;                // sample values are 0..height-1
+        uint16_t sampleRateHz;
+        uint16_t columnsPerSec;        // sweep speed
+        uint8_t gap;                   // blank columns ahead of the cursor
+        display::Color bg;
+        display::Color color[Leads];
+    };
+
+    void begin(const Config& cfg) {
+        mCfg = cfg;
+        if (mCfg.width == 0) mCfg.width = 1;
+        if (mCfg.height == 0) mCfg.height = 1;
+        // A full-height column must fit one strip
+        if (mCfg.height > StripPixels) mCfg.height = (uint8_t)StripPixels;
+        if (mCfg.sampleRateHz == 0) mCfg.sampleRateHz = 1;
+        mCursor = 0;
+        mHead = 0;
+        mCount = 0;
+        mAcc = 0;
+        mInColumn = 0;
+        mDropped = 0;
+        mStrips = 0;
+        for (uint8_t l = 0; l < Leads; l++) {
+            mLast[l] = mCfg.height / 2;
+            mNewest[l] = mLast[l];
+            mLo[l] = 0xFF;
+            mHi[l] = 0;
+        }
+    }
+
+    /** One sample per lead, in area coordinates (0 = top) */
+    void push(const uint8_t* y) {
+        if (mCfg.sampleRateHz == 0) return;     // begin() not called
+        for (uint8_t l = 0; l < Leads; l++) {
+            uint8_t v = y[l] < mCfg.height ? y[l] : (uint8_t)(mCfg.height - 1);
+            if (v < mLo[l]) mLo[l] = v;
+            if (v > mHi[l]) mHi[l] = v;
+            mNewest[l] = v;
+        }
+        mInColumn++;
+
+        mAcc += mCfg.columnsPerSec;
+        while (mAcc >= mCfg.sampleRateHz) {
+            mAcc -= mCfg.sampleRateHz;
+            emitColumn();
+        }
+    }
+
+    /** Draw all pending columns */
+    void flush(display::IDisplay& lcd) {
+        while (mCount > 0) {
+            uint16_t c = mCursor;
+
+            // Columns for this strip: stop at the right edge or when the
+            // band no longer fits the composite buffer
+            uint16_t n = 0;
+            uint8_t bandLo = 0xFF, bandHi = 0;
+            while (n < mCount && c + n < mCfg.width) {
+                const Column& col = mPending[(mHead + n) % MAX_PENDING];
+                uint8_t lo = bandLo, hi = bandHi;
+                for (uint8_t l = 0; l < Leads; l++) {
+                    if (col.lo[l] < lo) lo = col.lo[l];
+                    if (col.hi[l] > hi) hi = col.hi[l];
+                }
+                if ((uint32_t)(n + 1) * (hi - lo + 1) > StripPixels) break;
+                bandLo = lo;
+                bandHi = hi;
+                n++;
+            }
+
+            erase(lcd, (uint16_t)((c + mCfg.gap) % mCfg.width), n);
+
+            uint16_t bandH = (uint16_t)(bandHi - bandLo + 1);
+            for (uint16_t i = 0; i < n * bandH; i++) mStrip[i] = mCfg.bg;
+            for (uint16_t k = 0; k < n; k++) {
+                const Column& col = mPending[(mHead + k) % MAX_PENDING];
+                for (uint8_t l = 0; l < Leads; l++) {
+                    for (uint8_t r = col.lo[l]; r <= col.hi[l]; r++) {
+                        mStrip[(r - bandLo) * n + k] = mCfg.color[l];
+                    }
+                }
+            }
+            lcd.drawBitmap16(mCfg.x + c, mCfg.y + bandLo, n, bandH, mStrip);
+            mStrips++;
+
+            mHead = (uint8_t)((mHead + n) % MAX_PENDING);
+            mCount = (uint8_t)(mCount - n);
+            mCursor = (uint16_t)((c + n) % mCfg.width);
+        }
+    }
+
+    /**
+     * Hand each pending column to sink(x, lo, hi) instead of drawing it,
+     * for a caller that keeps the trace itself (a compositor layer).
+     * lo/hi hold one row per lead; the cursor advances as in flush().
+     */
+    template <typename Sink>
+    void drain(Sink sink) {
+        while (mCount > 0) {
+            const Column& col = mPending[mHead];
+            sink(mCursor, col.lo, col.hi);
+            mHead = (uint8_t)((mHead + 1) % MAX_PENDING);
+            mCount--;
+            mCursor = (uint16_t)((mCursor + 1) % mCfg.width);
+        }
+    }
+
+    uint16_t cursor() const { return mCursor; }
+    uint8_t pending() const { return mCount; }
+    uint32_t dropped() const { return mDropped; }
+    uint32_t strips() const { return mStrips; }
+
+private:
+    struct Column {
+        uint8_t lo[Leads];
+        uint8_t hi[Leads];
+    };
+
+    void emitColumn() {
+        if (mCount == MAX_PENDING) {
+            mDropped++;                 // renderer behind — skip, keep timing
+        } else {
+            Column& col = mPending[(mHead + mCount) % MAX_PENDING];
+            for (uint8_t l = 0; l < Leads; l++) {
+                uint8_t lo = mLast[l], hi = mLast[l];
+                if (mInColumn > 0) {
+                    if (mLo[l] < lo) lo = mLo[l];
+                    if (mHi[l] > hi) hi = mHi[l];
+                }
+                // At least 2px tall so a flat trace stays visible
+                if (hi == lo) {
+                    if (hi + 1 < mCfg.height) hi++;
+                    else if (lo > 0) lo--;
+                }
+                col.lo[l] = lo;
+                col.hi[l] = hi;
+            }
+            mCount++;
+        }
+        // The next column starts from where this one ended
+        for (uint8_t l = 0; l < Leads; l++) {
+            if (mInColumn > 0) mLast[l] = mNewest[l];
+            mLo[l] = 0xFF;
+            mHi[l] = 0;
+        }
+        mInColumn = 0;
+    }
+
+    /** Blank n columns from x, split at the right edge */
+    void erase(display::IDisplay& lcd, uint16_t x, uint16_t n) {
+        uint16_t first = (x + n > mCfg.width) ? (uint16_t)(mCfg.width - x) : n;
+        lcd.fillRect(mCfg.x + x, mCfg.y, first, mCfg.height, mCfg.bg);
+        if (first < n) lcd.fillRect(mCfg.x, mCfg.y, n - first, mCfg.height, mCfg.bg);
+    }
+
+    Config mCfg = {};
+    Column mPending[MAX_PENDING] = {};
+    display::Color mStrip[StripPixels] = {};
+    uint8_t mLo[Leads] = {};
+    uint8_t mHi[Leads] = {};
+    uint8_t mLast[Leads] = {};
+    uint8_t mNewest[Leads] = {};
+    uint32_t mAcc = 0;
+    uint32_t mDropped = 0;
+    uint32_t mStrips = 0;
+    uint16_t mCursor = 0;
+    uint16_t mInColumn = 0;
+    uint8_t mHead = 0;
+    uint8_t mCount = 0;
+};
+
+} // namespace arcana
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include "ats/ArcanaTsTypes.hpp"
+
+namespace arcana {
+
+/**
+ * QoS 1 PUBLISHes sent but not yet acknowledged, oldest first.
+ *
+ * A broker sends PUBACKs in the order it received the PUBLISHes (MQTT
+ * 3.1.1 §4.6), so the window is a FIFO ring: ack() marks an entry and
+ * pop() hands back the acknowledged prefix, in send order.
+ *
+ * Payloads are not kept. A replay batch carries what its acknowledgment
+ * commits — the sensor.ats position past its records — so an entry lost
+ * with the connection is re-sent from disk by the backfill. Live frames
+ * commit nothing: they hold coalesced samples, not every stored record.
+ */
+class MqttInflight {
+public:
+    static constexpr uint8_t MAX_WINDOW = 8;
+
+    enum Kind : uint8_t {
+        Response = 0,   // command response: nothing to commit
+        Live     = 1,   // live telemetry: best effort, nothing to commit
+        Backfill = 2,   // replay batch: covered = cursor past its records
+    };
+
+    struct Entry {
+        ats::AtsCursor covered;
+        uint32_t sentTick;
+        uint16_t packetId;
+        uint8_t  kind;
+        bool     acked;
+    };
+
+    MqttInflight() : mEntries{}, mHead(0), mCount(0), mWindow(1) {}
+
+    /** Outstanding PUBLISHes allowed (1 = stop-and-wait) */
+    void setWindow(uint8_t n) {
+        mWindow = n == 0 ? 1 : (n > MAX_WINDOW ? MAX_WINDOW : n);
+    }
+    uint8_t window() const { return mWindow; }
+    uint8_t count() const { return mCount; }
+    bool full() const { return mCount >= mWindow; }
+
+    /** @return false when the window is full (nothing recorded) */
+    bool push(uint16_t packetId, uint8_t kind, const ats::AtsCursor& covered,
+              uint32_t tick) {
+        if (full()) return false;
+        Entry& e = mEntries[(mHead + mCount) % MAX_WINDOW];
+        e.covered = covered;
+        e.sentTick = tick;
+        e.packetId = packetId;
+        e.kind = kind;
+        e.acked = false;
+        mCount++;
+        return true;
+    }
+
+    /** @return false for a packet ID that is not in flight */
+    bool ack(uint16_t packetId) {
+        for (uint8_t i = 0; i < mCount; i++) {
+            Entry& e = mEntries[(mHead + i) % MAX_WINDOW];
+            if (e.packetId == packetId && !e.acked) {
+                e.acked = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Remove the oldest entry if it is acknowledged */
+    bool pop(Entry& out) {
+        if (mCount == 0 || !mEntries[mHead].acked) return false;
+        out = mEntries[mHead];
+        mHead = (uint8_t)((mHead + 1) % MAX_WINDOW);
+        mCount--;
+        return true;
+    }
+
+    /** Entries of one kind still in the window */
+    uint8_t pending(uint8_t kind) const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < mCount; i++) {
+            if (mEntries[(mHead + i) % MAX_WINDOW].kind == kind) n++;
+        }
+        return n;
+    }
+
+    /** Send tick of the oldest unacknowledged entry (count() > 0) */
+    uint32_t oldestTick() const {
+        for (uint8_t i = 0; i < mCount; i++) {
+            const Entry& e = mEntries[(mHead + i) % MAX_WINDOW];
+            if (!e.acked) return e.sentTick;
+        }
+        return 0;
+    }
+
+    void clear() {
+        mHead = 0;
+        mCount = 0;
+    }
+
+private:
+    Entry   mEntries[MAX_WINDOW];
+    uint8_t mHead;
+    uint8_t mCount;
+    uint8_t mWindow;
+};
+
+} // namespace arcana
@@ -92,14 +92,18 @@ public:
         return pos;
     }
 
-    static uint16_t buildPublish(uint8_t* buf, uint16_t bufSz,
-                                  const char* topic,
-                                  const uint8_t* payload, uint16_t payloadLen,
-                                  uint8_t qos = 0, uint16_t packetId = 0,
-                                  bool retain = false) {
+    /**
+     * PUBLISH fixed + variable header only, for sending the payload from
+     * its own buffer. Returns 0 when the header does not fit in bufSz.
+     */
+    static uint16_t buildPublishHeader(uint8_t* buf, uint16_t bufSz,
+                                        const char* topic, uint16_t payloadLen,
+                                        uint8_t qos = 0, uint16_t packetId = 0,
+                                        bool retain = false) {
         uint16_t tLen = (uint16_t)strlen(topic);
         uint32_t remLen = 2 + tLen + payloadLen;
         if (qos > 0) remLen += 2;  // packet ID
+        if ((uint32_t)1 + 4 + 2 + tLen + 2 > bufSz) return 0;
         uint16_t pos = 0;
         buf[pos++] = 0x30 | ((qos & 0x03) << 1) | (retain ? 1 : 0);
         pos += encodeRemLen(buf + pos, remLen);
@@ -110,6 +114,17 @@ public:
             buf[pos++] = (uint8_t)(packetId >> 8);
             buf[pos++] = (uint8_t)(packetId);
         }
+        return pos;
+    }
+
+    static uint16_t buildPublish(uint8_t* buf, uint16_t bufSz,
+                                  const char* topic,
+                                  const uint8_t* payload, uint16_t payloadLen,
+                                  uint8_t qos = 0, uint16_t packetId = 0,
+                                  bool retain = false) {
+        uint16_t pos = buildPublishHeader(buf, bufSz, topic, payloadLen,
+                                          qos, packetId, retain);
+        if (pos == 0) return 0;
         memcpy(buf + pos, payload, payloadLen); pos += payloadLen;
         return pos;
     }
@@ -206,6 +221,21 @@ public:
         return true;
     }
 
+    // ---- stream framing ----
+
+    /**
+     * Size of the packet at the start of a TCP byte stream (link queue).
+     * @return total bytes, 0 if the fixed header is not complete yet,
+     *         -1 if the remaining length is malformed
+     */
+    static int32_t frameLength(const uint8_t* buf, uint16_t len) {
+        if (len < 2) return 0;
+        uint32_t remLen;
+        uint16_t rlBytes = decodeRemLen(buf + 1, len - 1, remLen);
+        if (!rlBytes) return len - 1 >= 4 ? -1 : 0;
+        return (int32_t)(1 + rlBytes + remLen);
+    }
+
     // ---- +IPD helper ----
 
     /**
@@ -3,7 +3,8 @@
  * @brief Log appender — UDP syslog via ESP8266 AT commands
  *
  * WARN+ events formatted as RFC 3164 syslog into a ring buffer.
- * MQTT task calls flushViaUdp() to send pending messages.
+ * MQTT task calls flushViaUdp() to send pending messages on
+ * Esp8266::LINK_SYSLOG, next to the MQTT link.
  * SPSC: ATS task produces (append), MQTT task consumes (flush).
  */
 
@@ -64,10 +65,7 @@ public:
     /** Open persistent UDP socket to syslog server. Call from MQTT task. */
     bool openUdp(Esp8266& esp) {
         if (mUdpOpen) return true;
-        char cmd[64];
-        snprintf(cmd, sizeof(cmd),
-                 "AT+CIPSTART=\"UDP\",\"%s\",%u", SYSLOG_HOST, SYSLOG_PORT);
-        if (esp.sendCmd(cmd, "OK", 3000)) {
+        if (esp.linkOpen(Esp8266::LINK_SYSLOG, "UDP", SYSLOG_HOST, SYSLOG_PORT, 3000)) {
             mUdpOpen = true;
             return true;
         }
@@ -77,7 +75,7 @@ public:
     /** Close UDP socket. Call from MQTT task. */
     void closeUdp(Esp8266& esp) {
         if (!mUdpOpen) return;
-        esp.sendCmd("AT+CIPCLOSE", "OK", 2000);
+        esp.linkClose(Esp8266::LINK_SYSLOG);
         mUdpOpen = false;
     }
 
@@ -93,16 +91,10 @@ public:
             uint16_t len = (uint16_t)strlen(mRing[mTail]);
             if (len == 0) { mTail = (mTail + 1) & RING_MASK; continue; }
 
-            char cmd[24];
-            snprintf(cmd, sizeof(cmd), "AT+CIPSEND=%u", (unsigned)len);
-            if (!esp.sendCmd(cmd, ">", 1000)) {
-                // UDP send failed — connection may be broken
-                mUdpOpen = false;
-                break;
-            }
-            esp.sendData(reinterpret_cast<const uint8_t*>(mRing[mTail]),
-                         len, 1000);
-            if (!esp.waitFor("SEND OK", 2000)) {
+            if (!esp.linkSend(Esp8266::LINK_SYSLOG,
+                              reinterpret_cast<const uint8_t*>(mRing[mTail]),
+                              len, 2000)) {
+                // UDP send failed — link may be gone (ESP reset)
                 mUdpOpen = false;
                 break;
             }
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace arcana {
+
+/**
+ * Packs several telemetry samples into one MQTT payload.
+ *
+ *   [ver:1][fields:1][count:1][rsv:1][baseTs:4 LE]
+ *   per sample: varint(zz(ts - prevTs)) then varint(zz(v[i] - prev[i]))
+ *
+ * The first sample's deltas are against baseTs and zero, so it carries
+ * absolute values; after that a slowly changing field costs one byte. The
+ * varints are protobuf base-128 with zig-zag for the signed deltas.
+ *
+ * The caller owns the buffer. add() refuses a sample that does not fit;
+ * the owner then publishes, reset()s and adds it to the next batch.
+ */
+class TelemetryBatch {
+public:
+    static constexpr uint8_t  VERSION = 1;
+    static constexpr uint8_t  MAX_FIELDS = 8;
+    static constexpr uint16_t HEADER_SIZE = 8;
+    static constexpr uint8_t  MAX_COUNT = 255;
+
+    TelemetryBatch()
+        : mBuf(nullptr), mCap(0), mLen(0), mFields(0), mCount(0),
+          mPrevTs(0), mPrev{} {}
+
+    void init(uint8_t* buf, uint16_t cap, uint8_t fields) {
+        mBuf = buf;
+        mCap = cap;
+        mFields = fields > MAX_FIELDS ? MAX_FIELDS : fields;
+        reset();
+    }
+
+    void reset() {
+        mLen = 0;
+        mCount = 0;
+        memset(mPrev, 0, sizeof(mPrev));
+    }
+
+    /** @return false when the sample does not fit (nothing was written) */
+    bool add(uint32_t ts, const int32_t* values) {
+        if (!mBuf || mCount >= MAX_COUNT) return false;
+        if (mCount == 0 && mCap < HEADER_SIZE) return false;
+
+        // Encode against the running state, commit only if it fits
+        uint32_t prevTs = (mCount == 0) ? ts : mPrevTs;
+        uint8_t tmp[5 * (1 + MAX_FIELDS)];
+        uint8_t n = putVarint(tmp, zigzag((int32_t)(ts - prevTs)));
+        for (uint8_t i = 0; i < mFields; i++) {
+            n += putVarint(tmp + n, zigzag(values[i] - mPrev[i]));
+        }
+        uint16_t start = (mCount == 0) ? HEADER_SIZE : mLen;
+        if (start + n > mCap) return false;
+
+        if (mCount == 0) {
+            mBuf[0] = VERSION;
+            mBuf[1] = mFields;
+            mBuf[3] = 0;
+            memcpy(mBuf + 4, &ts, 4);
+        }
+        memcpy(mBuf + start, tmp, n);
+        mLen = (uint16_t)(start + n);
+        mPrevTs = ts;
+        for (uint8_t i = 0; i < mFields; i++) mPrev[i] = values[i];
+        mCount++;
+        mBuf[2] = mCount;
+        return true;
+    }
+
+    uint8_t count() const { return mCount; }
+    uint16_t size() const { return mLen; }
+    const uint8_t* data() const { return mBuf; }
+
+    /**
+     * Decode a batch (host tools and tests).
+     * @return samples written to ts/values (values: fields per sample), 0 on error
+     */
+    static uint16_t decode(const uint8_t* in, uint16_t len, uint32_t* ts,
+                           int32_t* values, uint16_t maxSamples) {
+        if (len < HEADER_SIZE || in[0] != VERSION) return 0;
+        uint8_t fields = in[1];
+        uint8_t count = in[2];
+        if (fields > MAX_FIELDS || count > maxSamples) return 0;
+        uint32_t t;
+        memcpy(&t, in + 4, 4);
+        int32_t prev[MAX_FIELDS] = {};
+        uint16_t pos = HEADER_SIZE;
+        for (uint16_t s = 0; s < count; s++) {
+            uint32_t zz;
+            if (!getVarint(in, len, pos, zz)) return 0;
+            t += (uint32_t)unzigzag(zz);
+            ts[s] = t;
+            for (uint8_t i = 0; i < fields; i++) {
+                if (!getVarint(in, len, pos, zz)) return 0;
+                prev[i] += unzigzag(zz);
+                values[s * fields + i] = prev[i];
+            }
+        }
+        return pos == len ? count : 0;
+    }
+
+private:
+    static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    static uint8_t putVarint(uint8_t* out, uint32_t v) {
+        uint8_t n = 0;
+        while (v > 0x7F) { out[n++] = (uint8_t)((v & 0x7F) | 0x80); v >>= 7; }
+        out[n++] = (uint8_t)v;
+        return n;
+    }
+
+    static bool getVarint(const uint8_t* in, uint16_t len, uint16_t& pos, uint32_t& v) {
+        v = 0;
+        for (uint8_t shift = 0; shift < 35; shift += 7) {
+            if (pos >= len) return false;
+            uint8_t b = in[pos++];
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    uint8_t* mBuf;
+    uint16_t mCap;
+    uint16_t mLen;
+    uint8_t mFields;
+    uint8_t mCount;
+    uint32_t mPrevTs;
+    int32_t mPrev[MAX_FIELDS];
+};
+
+} // namespace arcana
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "Observable.hpp"
+#include "F103Models.hpp"
+#include "ChaCha20.hpp"
+#include "FrameCodec.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace arcana {
+
+/**
+ * Latest sensor + light reading, protobuf-encoded once.
+ *
+ * SensorData proto: sint32 temp_x10=1, sint32 ax=2, sint32 ay=3,
+ * sint32 az=4, uint32 als=5, uint32 ps=6. values() gives the same six
+ * fields in that order for TelemetryBatch.
+ */
+struct TelemetrySample {
+    static constexpr uint8_t FIELDS = 6;
+    static constexpr uint8_t MAX_PB = FIELDS * 4;   // tag + 16-bit zig-zag varint
+
+    uint32_t seq;           // bumped on every change, part of the nonce
+    uint32_t ts;            // tick of the sensor sample
+    float    temperature;
+    int16_t  ax, ay, az;
+    uint16_t als, ps;
+    uint8_t  pbLen;
+    uint8_t  pb[MAX_PB];
+
+    TelemetrySample()
+        : seq(0), ts(0), temperature(0), ax(0), ay(0), az(0),
+          als(0), ps(0), pbLen(0), pb{} {}
+
+    void setSensor(const SensorDataModel& m) {
+        ts = m.timestamp;
+        temperature = m.temperature;
+        ax = m.accelX;
+        ay = m.accelY;
+        az = m.accelZ;
+    }
+
+    void setLight(const LightDataModel& m) {
+        als = m.ambientLight;
+        ps = m.proximity;
+    }
+
+    int32_t tempX10() const {
+        float t = temperature * 10;
+        if (t > 32767.0f) return 32767;
+        if (t < -32768.0f) return -32768;
+        return (int32_t)t;
+    }
+
+    void values(int32_t* v) const {
+        v[0] = tempX10();
+        v[1] = ax;
+        v[2] = ay;
+        v[3] = az;
+        v[4] = als;
+        v[5] = ps;
+    }
+
+    void encode() {
+        int32_t v[FIELDS];
+        values(v);
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < FIELDS; i++) {
+            pb[n++] = (uint8_t)((i + 1) << 3);     // wire type 0
+            uint32_t u = i < 4 ? ((uint32_t)v[i] << 1) ^ (uint32_t)(v[i] >> 31)
+                               : (uint32_t)v[i];
+            while (u > 0x7F) { pb[n++] = (uint8_t)((u & 0x7F) | 0x80); u >>= 7; }
+            pb[n++] = (uint8_t)u;
+        }
+        pbLen = n;
+    }
+};
+
+/**
+ * One encode per reading, shared by every transport.
+ *
+ * Subscribes to the sensor and light observables ahead of the services,
+ * so by the time MQTT, BLE or storage are notified the slot already holds
+ * the encoded sample; they copy it with latest() from their own task.
+ *
+ * seal() builds the SID 0x20 frame [nonce:12][ChaCha20(pb)]. The nonce
+ * is [ts:4][seq:4][0:4], so the same sample under the same key always
+ * gives the same frame: the ciphertext of the last seal is kept, and a
+ * second transport with that key reuses it instead of encrypting again.
+ * Keys are compared by address; a key rewritten in place (registration)
+ * applies from the next sample.
+ */
+class TelemetryPipeline {
+public:
+    static constexpr uint8_t SID_SENSOR = 0x20;
+    static constexpr uint16_t MAX_FRAME =
+        (uint16_t)(FrameCodec::kOverhead + crypto::ChaCha20::NONCE_SIZE +
+                   TelemetrySample::MAX_PB);
+
+    static TelemetryPipeline& getInstance() {
+        static TelemetryPipeline sInstance;
+        return sInstance;
+    }
+
+    /** Call before the services' init() so the slot is filled first */
+    void attach(Observable<SensorDataModel>* sensor, Observable<LightDataModel>* light) {
+        if (sensor) sensor->subscribe(onSensorData, this);
+        if (light) light->subscribe(onLightData, this);
+    }
+
+    void update(const SensorDataModel& m) {
+        TelemetrySample s = snapshot();
+        s.setSensor(m);
+        commit(s);
+    }
+
+    void update(const LightDataModel& m) {
+        TelemetrySample s = snapshot();
+        s.setLight(m);
+        commit(s);
+    }
+
+    void latest(TelemetrySample& out) const { out = snapshot(); }
+
+    /**
+     * Frame an encrypted copy of the sample for one transport.
+     * @return false if the frame does not fit in out
+     */
+    bool seal(const TelemetrySample& s, const uint8_t* key,
+              uint8_t* out, uint16_t cap, uint16_t& outLen) {
+        uint8_t enc[crypto::ChaCha20::NONCE_SIZE + TelemetrySample::MAX_PB] = {};
+        memcpy(enc, &s.ts, 4);
+        memcpy(enc + 4, &s.seq, 4);
+        uint8_t* cipher = enc + crypto::ChaCha20::NONCE_SIZE;
+
+        bool hit;
+        taskENTER_CRITICAL();
+        hit = mSealedKey == key && mSealedSeq == s.seq;
+        if (hit) memcpy(cipher, mSealed, s.pbLen);
+        taskEXIT_CRITICAL();
+
+        if (!hit) {
+            memcpy(cipher, s.pb, s.pbLen);
+            crypto::ChaCha20::crypt(key, enc, 0, cipher, s.pbLen);
+            taskENTER_CRITICAL();
+            memcpy(mSealed, cipher, s.pbLen);
+            mSealedKey = key;
+            mSealedSeq = s.seq;
+            taskEXIT_CRITICAL();
+        }
+
+        size_t len = 0;
+        if (!FrameCodec::frame(enc, crypto::ChaCha20::NONCE_SIZE + s.pbLen,
+                               FrameCodec::kFlagFin, SID_SENSOR,
+                               out, cap, len)) return false;
+        outLen = (uint16_t)len;
+        return true;
+    }
+
+private:
+    TelemetryPipeline()
+        : mSample(), mSealed{}, mSealedKey(nullptr), mSealedSeq(0) {
+        mSample.encode();
+    }
+
+    static void onSensorData(SensorDataModel* model, void* ctx) {
+        static_cast<TelemetryPipeline*>(ctx)->update(*model);
+    }
+
+    static void onLightData(LightDataModel* model, void* ctx) {
+        static_cast<TelemetryPipeline*>(ctx)->update(*model);
+    }
+
+    TelemetrySample snapshot() const {
+        taskENTER_CRITICAL();
+        TelemetrySample s = mSample;
+        taskEXIT_CRITICAL();
+        return s;
+    }
+
+    void commit(TelemetrySample& s) {
+        s.encode();
+        taskENTER_CRITICAL();
+        s.seq = mSample.seq + 1;
+        mSample = s;
+        taskEXIT_CRITICAL();
+    }
+
+    TelemetrySample mSample;
+    uint8_t mSealed[TelemetrySample::MAX_PB];
+    const uint8_t* mSealedKey;
+    uint32_t mSealedSeq;
+};
+
+} // namespace arcana
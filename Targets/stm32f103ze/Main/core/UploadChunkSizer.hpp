@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+
+namespace arcana {
+
+/**
+ * Chunk size control for the SD → Wi-Fi upload pipeline.
+ *
+ * The pipeline reads chunk N+1 from SD while chunk N is on the wire. Each
+ * step reports how long the read took and how long the send was in flight;
+ * from those the sizer keeps smoothed SD and TX rates and decides the size
+ * of the next read:
+ *
+ *   - a read that needed a retry halves the chunk (SD struggles with long
+ *     multi-block reads after a hiccup)
+ *   - clean steps grow it back one STEP at a time, up to the buffer size;
+ *     steps where the wire sat idle waiting for SD count double, since
+ *     bigger reads spread the per-command SD overhead over more bytes
+ *
+ * When TX is the bottleneck the read hides entirely behind the send, and
+ * the size only sets how often the task wakes.
+ */
+class UploadChunkSizer {
+public:
+    static const uint16_t MIN_CHUNK = 512;
+    static const uint16_t STEP = 512;
+    static const uint8_t GROW_AFTER = 4;     // clean-step credits per growth
+
+    explicit UploadChunkSizer(uint16_t maxChunk)
+        : mMax(maxChunk < MIN_CHUNK ? MIN_CHUNK : maxChunk)
+        , mChunk(mMax)
+        , mCredit(0)
+        , mSdRate(0)
+        , mTxRate(0)
+        , mSdStalls(0)
+        , mRetries(0) {}
+
+    uint16_t chunk() const { return mChunk; }
+
+    /** Bytes to read next, given what is left of the body */
+    uint16_t next(uint32_t remaining) const {
+        return remaining < mChunk ? (uint16_t)remaining : mChunk;
+    }
+
+    /** An SD read had to be retried */
+    void onReadRetry() {
+        mRetries++;
+        mCredit = 0;
+        uint16_t half = (uint16_t)((mChunk / 2) / STEP * STEP);
+        mChunk = half < MIN_CHUNK ? MIN_CHUNK : half;
+    }
+
+    /**
+     * One overlapped step: readLen bytes read in readMs while sendLen bytes
+     * were in flight for sendMs. waitMs is how long the task then blocked
+     * for the send to finish; 0 means the wire went idle before the read
+     * was done.
+     */
+    void onStep(uint16_t readLen, uint32_t readMs,
+                uint16_t sendLen, uint32_t sendMs, uint32_t waitMs) {
+        mSdRate = smooth(mSdRate, rate(readLen, readMs));
+        mTxRate = smooth(mTxRate, rate(sendLen, sendMs));
+
+        bool sdBound = waitMs == 0 && readMs > 0;
+        if (sdBound) mSdStalls++;
+        mCredit = (uint8_t)(mCredit + (sdBound ? 2 : 1));
+        if (mCredit >= GROW_AFTER) {
+            mCredit = 0;
+            uint32_t grown = (uint32_t)mChunk + STEP;
+            mChunk = grown > mMax ? mMax : (uint16_t)grown;
+        }
+    }
+
+    /** Smoothed rates, bytes per second */
+    uint32_t sdRate() const { return mSdRate; }
+    uint32_t txRate() const { return mTxRate; }
+    /** Steps where the wire waited on SD */
+    uint16_t sdStalls() const { return mSdStalls; }
+    uint16_t retries() const { return mRetries; }
+
+private:
+    static uint32_t rate(uint32_t len, uint32_t ms) {
+        return len * 1000u / (ms ? ms : 1);
+    }
+    static uint32_t smooth(uint32_t avg, uint32_t sample) {
+        return avg ? (avg * 3 + sample) / 4 : sample;
+    }
+
+    uint16_t mMax;
+    uint16_t mChunk;
+    uint8_t mCredit;
+    uint32_t mSdRate;
+    uint32_t mTxRate;
+    uint16_t mSdStalls;
+    uint16_t mRetries;
+};
+
+} // namespace arcana
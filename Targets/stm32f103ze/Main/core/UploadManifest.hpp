@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "Sha256.hpp"
+
+namespace arcana {
+
+/** Run of chunk indices, both ends included */
+struct ChunkRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+/**
+ * Block-aligned upload manifest.
+ *
+ * A file is cut on ATS block boundaries (4KB) and each chunk is named by
+ * the first 8 bytes of its SHA-256. ATS only ever appends blocks or
+ * rewrites whole blocks in place, so fixed block-aligned cuts find every
+ * unchanged region that content-defined cuts would.
+ *
+ * The manifest body is the digests in file order. The server answers with
+ * the chunk ranges it lacks ("0-3,17,40-52"), at most the MAX_RANGES the
+ * device asked for, merging nearby gaps to stay under it. Only those
+ * chunks go over the air.
+ */
+class UploadManifest {
+public:
+    static const uint32_t CHUNK_SIZE = 4096;     // one ATS block
+    static const uint8_t DIGEST_SIZE = 8;
+    static const uint8_t MAX_RANGES = 16;
+
+    static uint32_t chunkCount(uint32_t fileSize) {
+        return (fileSize + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    }
+    static uint32_t manifestSize(uint32_t fileSize) {
+        return chunkCount(fileSize) * DIGEST_SIZE;
+    }
+
+    /** Digest of one chunk, fed in pieces as they come off SD */
+    class Hasher {
+    public:
+        Hasher() { reset(); }
+        void reset() { crypto::Sha256::init(mCtx); }
+        void update(const uint8_t* data, size_t len) {
+            crypto::Sha256::update(mCtx, data, len);
+        }
+        void finish(uint8_t out[DIGEST_SIZE]) {
+            uint8_t full[crypto::Sha256::HASH_SIZE];
+            crypto::Sha256::final(mCtx, full);
+            for (uint8_t i = 0; i < DIGEST_SIZE; i++) out[i] = full[i];
+            reset();
+        }
+    private:
+        crypto::Sha256::Context mCtx;
+    };
+
+    /**
+     * Parse "a-b,c,..." up to a closing quote or end of string.
+     * Empty means nothing is missing. Returns the range count, or -1 when
+     * malformed, unordered, past the last chunk or longer than max.
+     */
+    static int parseRanges(const char* s, ChunkRange* out, uint8_t max,
+                           uint32_t chunks) {
+        int n = 0;
+        bool first = true;
+        while (*s && *s != '"') {
+            if (!first) {
+                if (*s != ',') return -1;
+                s++;
+            }
+            first = false;
+            ChunkRange r;
+            if (!parseNum(s, r.first)) return -1;
+            r.last = r.first;
+            if (*s == '-') {
+                s++;
+                if (!parseNum(s, r.last)) return -1;
+            }
+            if (r.last < r.first || r.last >= chunks) return -1;
+            if (n > 0 && r.first <= out[n - 1].last) return -1;
+            if (n >= max) return -1;
+            out[n++] = r;
+        }
+        return n;
+    }
+
+    /** Inverse of parseRanges; returns the length, 0 if buf is too small */
+    static uint16_t formatRanges(const ChunkRange* r, uint8_t n,
+                                 char* buf, uint16_t bufSz) {
+        uint16_t pos = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            char tmp[24];
+            uint8_t len = 0;
+            if (i > 0) tmp[len++] = ',';
+            len += putNum(tmp + len, r[i].first);
+            if (r[i].last != r[i].first) {
+                tmp[len++] = '-';
+                len += putNum(tmp + len, r[i].last);
+            }
+            if (pos + len + 1 > bufSz) return 0;
+            for (uint8_t k = 0; k < len; k++) buf[pos++] = tmp[k];
+        }
+        if (pos + 1 > bufSz) return 0;
+        buf[pos] = '\0';
+        return pos;
+    }
+
+    static uint32_t rangeOffset(const ChunkRange& r) {
+        return r.first * CHUNK_SIZE;
+    }
+    /** Bytes of the file a range covers; the last chunk may be short */
+    static uint32_t rangeBytes(const ChunkRange& r, uint32_t fileSize) {
+        uint32_t end = (r.last + 1) * CHUNK_SIZE;
+        if (end > fileSize) end = fileSize;
+        return end - rangeOffset(r);
+    }
+    static uint32_t totalBytes(const ChunkRange* r, uint8_t n, uint32_t fileSize) {
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < n; i++) sum += rangeBytes(r[i], fileSize);
+        return sum;
+    }
+    static uint32_t totalChunks(const ChunkRange* r, uint8_t n) {
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < n; i++) sum += r[i].last - r[i].first + 1;
+        return sum;
+    }
+
+private:
+    static bool parseNum(const char*& s, uint32_t& v) {
+        if (*s < '0' || *s > '9') return false;
+        v = 0;
+        while (*s >= '0' && *s <= '9') {
+            if (v > 0x0FFFFFFF) return false;
+            v = v * 10 + (uint32_t)(*s - '0');
+            s++;
+        }
+        return true;
+    }
+    static uint8_t putNum(char* out, uint32_t v) {
+        char rev[10];
+        uint8_t n = 0;
+        do { rev[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+        for (uint8_t i = 0; i < n; i++) out[i] = rev[n - 1 - i];
+        return n;
+    }
+};
+
+} // namespace arcana
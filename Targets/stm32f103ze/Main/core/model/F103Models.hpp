@@ -11,7 +11,9 @@ enum class F103ModelType : uint8_t {
     LedFrame       = 103,
     Light          = 104,
     StorageStats   = 105,
-    SdBenchmark    = 106
+    SdBenchmark    = 106,
+    SensorBatch    = 107,
+    AcqStats       = 108
 };
 
 class SensorDataModel : public Model {
@@ -27,6 +29,67 @@ public:
         , accelX(0), accelY(0), accelZ(0) {}
 };
 
+/**
+ * Accelerometer samples drained from the MPU6050 FIFO in one burst.
+ * timestamp (ms) is the drain time, which is when the newest sample
+ * (accel[count - 1]) was taken; earlier ones are periodUs apart.
+ */
+class SensorBatchModel : public Model {
+public:
+    static const uint8_t MAX_SAMPLES = 32;
+
+    int16_t accel[MAX_SAMPLES][3];  // X, Y, Z per sample
+    uint8_t count;
+    uint16_t periodUs;
+    uint32_t sequence;     // running index of accel[0] since start
+    uint16_t overflows;    // FIFO overflows since start, each losing samples
+
+    SensorBatchModel()
+        : Model(static_cast<uint8_t>(F103ModelType::SensorBatch))
+        , accel{}
+        , count(0)
+        , periodUs(0)
+        , sequence(0)
+        , overflows(0) {}
+
+    uint32_t sampleTime(uint8_t i) const {
+        return timestamp - ((uint32_t)(count - 1 - i) * periodUs) / 1000;
+    }
+};
+
+/**
+ * Acquisition scheduler health over the last stats window. Jitter is how
+ * late a release started against its grid; missed counts releases that
+ * were skipped because the one before overran a whole period.
+ */
+class AcquisitionStatsModel : public Model {
+public:
+    static const uint8_t MAX_PLANS = 4;
+
+    struct Plan {
+        uint16_t releases;
+        uint16_t missed;
+        uint16_t errors;       // transactions that failed
+        uint16_t jitterAvgUs;
+        uint16_t jitterMaxUs;
+        uint16_t busMaxUs;     // longest release, whole burst
+    };
+
+    Plan plan[MAX_PLANS];
+    uint8_t planCount;
+    uint16_t windowMs;
+    uint16_t busyPermille;     // time in sample functions / window
+    uint32_t totalMissed;      // since start
+
+    AcquisitionStatsModel()
+        : Model(static_cast<uint8_t>(F103ModelType::AcqStats))
+        , plan{}
+        , planCount(0)
+        , windowMs(0)
+        , busyPermille(0)
+        , totalMissed(0) {}
+};
+
 class MqttCommandModel : public Model {
 public:
     static const uint8_t MAX_DATA = 64;
@@ -1,4 +1,5 @@
 #include "I2cBus.hpp"
+#include "task.h"
 
 namespace arcana {
 
@@ -9,7 +10,7 @@ static GPIO_TypeDef* const PORT = GPIOB;
 static const uint16_t SCL_PIN = GPIO_PIN_6;
 static const uint16_t SDA_PIN = GPIO_PIN_7;
 
-I2cBus::I2cBus() {}
+I2cBus::I2cBus() : mMutex(0), mMutexBuf(), mErrors(0), mRecoveries(0) {}
 
 I2cBus& I2cBus::getInstance() {
     static I2cBus sInstance;
@@ -24,6 +25,8 @@ void I2cBus::initHAL() {
     DWT->CYCCNT = 0;
     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
+    if (!mMutex) mMutex = xSemaphoreCreateMutexStatic(&mMutexBuf);
+
     GPIO_InitTypeDef gpio = {};
     gpio.Pin = SCL_PIN | SDA_PIN;
     gpio.Mode = GPIO_MODE_OUTPUT_OD;
@@ -35,6 +38,21 @@ void I2cBus::initHAL() {
     sclHigh();
     sdaHigh();
     delayUs(10);
+
+    // A sensor reset mid-read can still be holding SDA low
+    if (!sdaRead()) recover();
+}
+
+void I2cBus::lock() {
+    if (mMutex && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreTake(mMutex, portMAX_DELAY);
+    }
+}
+
+void I2cBus::unlock() {
+    if (mMutex && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xSemaphoreGive(mMutex);
+    }
 }
 
 void I2cBus::sclHigh() { HAL_GPIO_WritePin(PORT, SCL_PIN, GPIO_PIN_SET); }
@@ -49,11 +67,17 @@ void I2cBus::delayUs(uint32_t us) {
     while ((DWT->CYCCNT - start) < cycles) {}
 }
 
-void I2cBus::start() {
+bool I2cBus::start() {
     sdaHigh(); delayUs(5);
     sclHigh(); delayUs(5);
+    // Bus must be free: a slave still driving SDA would swallow the START
+    if (!sdaRead()) {
+        recover();
+        if (!sdaRead()) return false;
+    }
     sdaLow();  delayUs(5);
     sclLow();  delayUs(5);
+    return true;
 }
 
 void I2cBus::stop() {
@@ -94,13 +118,21 @@ uint8_t I2cBus::recvByte(bool ack) {
     return byte;
 }
 
-bool I2cBus::writeReg(uint8_t devAddr, uint8_t reg, uint8_t value) {
-    start();
-    if (!sendByte(devAddr << 1)) { stop(); return false; }
-    if (!sendByte(reg))          { stop(); return false; }
-    if (!sendByte(value))        { stop(); return false; }
+bool I2cBus::fail() {
+    mErrors++;
     stop();
-    return true;
+    return false;
+}
+
+bool I2cBus::writeReg(uint8_t devAddr, uint8_t reg, uint8_t value) {
+    lock();
+    bool ok = start() &&
+              sendByte((uint8_t)(devAddr << 1)) &&
+              sendByte(reg) &&
+              sendByte(value);
+    if (ok) stop(); else fail();
+    unlock();
+    return ok;
 }
 
 bool I2cBus::readReg(uint8_t devAddr, uint8_t reg, uint8_t* value) {
@@ -108,18 +140,40 @@ bool I2cBus::readReg(uint8_t devAddr, uint8_t reg, uint8_t* value) {
 }
 
 bool I2cBus::readRegs(uint8_t devAddr, uint8_t reg, uint8_t* buf, uint16_t len) {
-    // Write register address
-    start();
-    if (!sendByte(devAddr << 1)) { stop(); return false; }
-    if (!sendByte(reg))          { stop(); return false; }
-    // Repeated start + read
-    start();
-    if (!sendByte((devAddr << 1) | 1)) { stop(); return false; }
-    for (uint16_t i = 0; i < len; i++) {
-        buf[i] = recvByte(i < len - 1); // ACK all except last
+    if (len == 0) return true;
+    lock();
+    // Write register address, then repeated start + read
+    bool ok = start() &&
+              sendByte((uint8_t)(devAddr << 1)) &&
+              sendByte(reg) &&
+              start() &&
+              sendByte((uint8_t)((devAddr << 1) | 1));
+    if (ok) {
+        for (uint16_t i = 0; i < len; i++) {
+            buf[i] = recvByte(i < len - 1); // ACK all except last
+        }
+        stop();
+    } else {
+        fail();
     }
-    stop();
-    return true;
+    unlock();
+    return ok;
+}
+
+void I2cBus::recover() {
+    mRecoveries++;
+    sdaHigh();
+    sclHigh(); delayUs(5);
+    // A slave stuck mid-byte lets go of SDA within 9 clocks
+    for (int i = 0; i < 9 && !sdaRead(); i++) {
+        sclLow();  delayUs(5);
+        sclHigh(); delayUs(5);
+    }
+    // STOP: SDA rises while SCL is high
+    sclLow();  delayUs(5);
+    sdaLow();  delayUs(5);
+    sclHigh(); delayUs(5);
+    sdaHigh(); delayUs(5);
 }
 
 } // namespace arcana
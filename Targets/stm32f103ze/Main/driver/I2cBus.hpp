@@ -1,10 +1,24 @@
 #pragma once
 
 #include "stm32f1xx_hal.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
 #include <cstdint>
 
 namespace arcana {
 
+/**
+ * Shared I2C master on PB6 (SCL) / PB7 (SDA), bit-banged at ~100kHz.
+ *
+ * Software on purpose: the ILI9341 keeps the FSMC clock enabled, and on
+ * STM32F103xE I2C1 on PB6/PB7 then clashes with FSMC_NADV on PB7 (device
+ * errata ES0340). The board wires the sensors to PB6/PB7, so the PB8/PB9
+ * remap is not an option.
+ *
+ * A bus mutex serializes MPU6050 and AP3216C; multi-byte reads are one
+ * transaction (repeated START, ACK all but the last byte). A slave holding
+ * SDA low at START is released with 9 clocks and a STOP.
+ */
 class I2cBus {
 public:
     static I2cBus& getInstance();
@@ -14,9 +28,16 @@ public:
     bool readReg(uint8_t devAddr, uint8_t reg, uint8_t* value);
     bool readRegs(uint8_t devAddr, uint8_t reg, uint8_t* buf, uint16_t len);
 
+    /** Transactions that failed (NACK, stuck bus) and bus recoveries so far */
+    uint32_t errorCount() const { return mErrors; }
+    uint32_t recoveryCount() const { return mRecoveries; }
+
 private:
     I2cBus();
 
+    void lock();
+    void unlock();
+
     void sclHigh();
     void sclLow();
     void sdaHigh();
@@ -24,10 +45,19 @@ private:
     bool sdaRead();
     void delayUs(uint32_t us);
 
-    void start();
+    bool start();
     void stop();
     bool sendByte(uint8_t byte);
     uint8_t recvByte(bool ack);
+    bool fail();
+
+    // Bus recovery: 9 clocks + STOP
+    void recover();
+
+    SemaphoreHandle_t mMutex;
+    StaticSemaphore_t mMutexBuf;
+    uint32_t mErrors;
+    uint32_t mRecoveries;
 };
 
 } // namespace arcana
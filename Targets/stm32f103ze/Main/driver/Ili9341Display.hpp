@@ -30,6 +30,10 @@ public:
                      const uint8_t* bitmap, Color fg, Color bg) override {
         mLcd.drawXBitmap(x, y, w, h, bitmap, fg, bg);
     }
+    void drawBitmap16(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint16_t* pixels) override {
+        mLcd.drawBitmap16(x, y, w, h, pixels);
+    }
 };
 
 } // namespace display
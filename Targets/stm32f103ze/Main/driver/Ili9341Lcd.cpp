@@ -1,5 +1,39 @@
 #include "Ili9341Lcd.hpp"
 #include "Font5x7.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <cstring>
+
+// FSMC Bank1 NE4 (0x6C000000), A23 (PE2) as RS
+// 16-bit mode: FSMC_A23 = HADDR[24], DATA offset = 1<<24 = 0x01000000
+#ifndef LCD_FSMC_CMD_ADDR
+#define LCD_FSMC_CMD_ADDR   0x6C000000u
+#define LCD_FSMC_DATA_ADDR  0x6D000000u
+#endif
+
+/* LCD DMA (C linkage) — DMA2 Channel1 is free (SDIO owns Channel4) */
+extern "C" {
+    DMA_HandleTypeDef g_hdma_lcd;
+
+    static StaticSemaphore_t g_lcd_dma_sem_buf;
+    static SemaphoreHandle_t g_lcd_dma_sem = 0;
+    static volatile uint8_t g_lcd_dma_busy = 0;
+
+    static void lcdDmaDone(DMA_HandleTypeDef* hdma) {
+        (void)hdma;
+        g_lcd_dma_busy = 0;
+        BaseType_t woken = pdFALSE;
+        if (g_lcd_dma_sem) {
+            xSemaphoreGiveFromISR(g_lcd_dma_sem, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+    }
+
+    void DMA2_Channel1_IRQHandler(void) {
+        HAL_DMA_IRQHandler(&g_hdma_lcd);
+    }
+}
 
 namespace arcana {
 namespace lcd {
@@ -12,12 +46,10 @@ static void delayMs(uint32_t ms) {
     while (i < ms * 8000) { i = i + 1; }
 }
 
-// FSMC Bank1 NE4 (0x6C000000), A23 (PE2) as RS
-// 16-bit mode: FSMC_A23 = HADDR[24], DATA offset = 1<<24 = 0x01000000
-volatile uint16_t* const Ili9341Lcd::CMD_ADDR  = (volatile uint16_t*)0x6C000000;
-volatile uint16_t* const Ili9341Lcd::DATA_ADDR = (volatile uint16_t*)0x6D000000;
+volatile uint16_t* const Ili9341Lcd::CMD_ADDR  = (volatile uint16_t*)LCD_FSMC_CMD_ADDR;
+volatile uint16_t* const Ili9341Lcd::DATA_ADDR = (volatile uint16_t*)LCD_FSMC_DATA_ADDR;
 
-Ili9341Lcd::Ili9341Lcd() {}
+Ili9341Lcd::Ili9341Lcd() : mDmaReady(false), mFillColor(0), mLineBuf() {}
 
 void Ili9341Lcd::writeCmd(uint16_t cmd) {
     *CMD_ADDR = cmd;
@@ -29,7 +61,7 @@ void Ili9341Lcd::writeData(uint16_t data) {
 
 void Ili9341Lcd::initFsmc() {
     // Enable FSMC clock
-    RCC->AHBENR |= RCC_AHBENR_FSMCEN;
+    RCC->AHBENR = RCC->AHBENR | RCC_AHBENR_FSMCEN;
     __IO uint32_t tmpreg = RCC->AHBENR;
     (void)tmpreg;
 
@@ -183,6 +215,100 @@ void Ili9341Lcd::initHAL() {
     initFsmc();
     delayMs(50);
     initSequence();
+    initDma();
+}
+
+// ---------------------------------------------------------------------------
+// DMA memory → FSMC data port
+// ---------------------------------------------------------------------------
+
+void Ili9341Lcd::initDma() {
+    g_lcd_dma_sem = xSemaphoreCreateBinaryStatic(&g_lcd_dma_sem_buf);
+    if (!g_lcd_dma_sem) return;
+
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    g_hdma_lcd.Instance = DMA2_Channel1;
+    g_hdma_lcd.Init.Direction = DMA_MEMORY_TO_MEMORY;
+    g_hdma_lcd.Init.PeriphInc = DMA_PINC_ENABLE;
+    g_hdma_lcd.Init.MemInc = DMA_MINC_DISABLE;       // fixed FSMC data port
+    g_hdma_lcd.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    g_hdma_lcd.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    g_hdma_lcd.Init.Mode = DMA_NORMAL;
+    g_hdma_lcd.Init.Priority = DMA_PRIORITY_MEDIUM;  // below SDIO
+    if (HAL_DMA_Init(&g_hdma_lcd) != HAL_OK) return;
+    g_hdma_lcd.XferCpltCallback = lcdDmaDone;
+    g_hdma_lcd.XferErrorCallback = lcdDmaDone;
+
+    HAL_NVIC_SetPriority(DMA2_Channel1_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Channel1_IRQn);
+    mDmaReady = true;
+}
+
+void Ili9341Lcd::dmaStart(const uint16_t* src, uint16_t count, bool increment) {
+    // Channel is idle between transfers, so PINC can be flipped in place
+    g_hdma_lcd.Init.PeriphInc = increment ? DMA_PINC_ENABLE : DMA_PINC_DISABLE;
+    MODIFY_REG(g_hdma_lcd.Instance->CCR, DMA_CCR_PINC, g_hdma_lcd.Init.PeriphInc);
+
+    g_lcd_dma_busy = 1;
+    xSemaphoreTake(g_lcd_dma_sem, 0);  // drain stale signal
+    if (HAL_DMA_Start_IT(&g_hdma_lcd, (uint32_t)(uintptr_t)src,
+                         (uint32_t)LCD_FSMC_DATA_ADDR, count) != HAL_OK) {
+        g_lcd_dma_busy = 0;
+    }
+}
+
+void Ili9341Lcd::dmaWait() {
+    if (!g_lcd_dma_busy) return;
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        // Render task sleeps here — the CPU is free while the FSMC drains.
+        // 64K pixels at the conservative FSMC timing take ~70 ms.
+        if (xSemaphoreTake(g_lcd_dma_sem, pdMS_TO_TICKS(200)) != pdTRUE) {
+            HAL_DMA_Abort(&g_hdma_lcd);
+            g_lcd_dma_busy = 0;
+        }
+    } else {
+        while (g_lcd_dma_busy) {}      // boot screens, before the scheduler
+    }
+}
+
+void Ili9341Lcd::dmaWrite(const uint16_t* src, uint32_t count, bool increment) {
+    while (count > 0) {
+        uint16_t n = count > DMA_MAX_XFER ? DMA_MAX_XFER : (uint16_t)count;
+        dmaStart(src, n, increment);
+        dmaWait();
+        if (increment) src += n;
+        count -= n;
+    }
+}
+
+/**
+ * Stream generated pixels into the open GRAM window. gen(dst, n) writes the
+ * next n pixels; it fills one line buffer while DMA sends the other.
+ */
+template <typename Gen>
+void Ili9341Lcd::pushPixels(uint32_t total, Gen gen) {
+    if (!mDmaReady || total < DMA_MIN_PIXELS) {
+        uint16_t px[16];
+        while (total > 0) {
+            uint16_t n = total > 16 ? 16 : (uint16_t)total;
+            gen(px, n);
+            for (uint16_t i = 0; i < n; i++) writeData(px[i]);
+            total -= n;
+        }
+        return;
+    }
+
+    uint8_t cur = 0;
+    while (total > 0) {
+        uint16_t n = total > LINE_PIXELS ? LINE_PIXELS : (uint16_t)total;
+        gen(mLineBuf[cur], n);
+        dmaWait();                      // previous buffer done
+        dmaStart(mLineBuf[cur], n, true);
+        cur ^= 1;
+        total -= n;
+    }
+    dmaWait();
 }
 
 void Ili9341Lcd::setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
@@ -205,11 +331,17 @@ void Ili9341Lcd::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16
     if (x >= WIDTH || y >= HEIGHT) return;
     if (x + w > WIDTH) w = WIDTH - x;
     if (y + h > HEIGHT) h = HEIGHT - y;
+    forgetText(x, y, w, h);
 
     setWindow(x, y, x + w - 1, y + h - 1);
     writeCmd(0x2C);
 
     uint32_t total = (uint32_t)w * h;
+    if (mDmaReady && total >= DMA_MIN_PIXELS) {
+        mFillColor = color;
+        dmaWrite(&mFillColor, total, false);
+        return;
+    }
     for (uint32_t i = 0; i < total; i++) {
         writeData(color);
     }
@@ -227,52 +359,160 @@ void Ili9341Lcd::drawChar(uint16_t x, uint16_t y, char c, uint16_t fg, uint16_t
     uint16_t ch = FONT_HEIGHT * scale;
 
     if (x + cw > WIDTH || y + ch > HEIGHT) return;
+    forgetText(x, y, cw, ch);
 
     setWindow(x, y, x + cw - 1, y + ch - 1);
     writeCmd(0x2C);
 
-    for (uint8_t row = 0; row < FONT_HEIGHT; row++) {
-        for (uint8_t sy = 0; sy < scale; sy++) {
-            for (uint8_t col = 0; col < FONT_WIDTH + 1; col++) {
-                uint16_t color = (col < FONT_WIDTH && (glyph[col] & (1 << row)))
-                    ? fg : bg;
-                for (uint8_t sx = 0; sx < scale; sx++) {
-                    writeData(color);
-                }
-            }
+    // Walk the scaled glyph in GRAM order: x advances fastest
+    uint16_t px = 0, py = 0;
+    pushPixels((uint32_t)cw * ch, [&](uint16_t* dst, uint16_t n) {
+        for (uint16_t i = 0; i < n; i++) {
+            uint8_t col = px / scale;
+            uint8_t row = py / scale;
+            dst[i] = (col < FONT_WIDTH && (glyph[col] & (1 << row))) ? fg : bg;
+            if (++px == cw) { px = 0; py++; }
         }
-    }
+    });
 }
 
 void Ili9341Lcd::drawString(uint16_t x, uint16_t y, const char* str,
                             uint16_t fg, uint16_t bg, uint8_t scale) {
     uint16_t cw = (FONT_WIDTH + 1) * scale;
-    while (*str) {
-        if (x + cw > WIDTH) break;
-        drawChar(x, y, *str, fg, bg, scale);
+    if (scale == 0 || y + FONT_HEIGHT * scale > HEIGHT) return;
+
+    // Characters that fit on the line
+    uint8_t len = 0;
+    while (str[len] && len < 0xFF && x + (uint16_t)(len + 1) * cw <= WIDTH) len++;
+    if (len == 0) return;
+
+#if DISPLAY_FEATURE_TEXT_CACHE
+    int8_t slot = mGlyphCache.acquire(scale, fg, bg);
+    if (slot >= 0) {
+        TextDiff::Span span = mTextDiff.update(x, y, str, len, scale, fg, bg);
+        if (span.count > 0) {
+            blitText(x + span.first * cw, y, str + span.first, span.count, scale, slot);
+        }
+        return;
+    }
+#endif
+    for (uint8_t i = 0; i < len; i++) {
+        drawChar(x, y, str[i], fg, bg, scale);
         x += cw;
-        str++;
     }
 }
 
+#if DISPLAY_FEATURE_TEXT_CACHE
+void Ili9341Lcd::blitText(uint16_t x, uint16_t y, const char* str, uint8_t count,
+                          uint8_t scale, int8_t slot) {
+    uint16_t cw = GlyphRunCache::CELL_W * scale;
+    uint16_t w = count * cw;
+    setWindow(x, y, x + w - 1, y + FONT_HEIGHT * scale - 1);
+    writeCmd(0x2C);
+
+    // Window rows are contiguous in GRAM order, so each DMA transfer
+    // carries as many whole rows as fit in a line buffer
+    bool dma = mDmaReady && (uint32_t)w * FONT_HEIGHT * scale >= DMA_MIN_PIXELS;
+    uint8_t cur = 0;
+    uint16_t used = 0;
+    const uint16_t* prev = 0;
+    for (uint8_t row = 0; row < FONT_HEIGHT; row++) {
+        for (uint8_t k = 0; k < scale; k++) {
+            if (used + w > LINE_PIXELS) {
+                dmaWait();                  // other buffer may still be draining
+                dmaStart(mLineBuf[cur], used, true);
+                cur ^= 1;
+                used = 0;
+            }
+            uint16_t* line = mLineBuf[cur] + used;
+            if (k == 0) {
+                for (uint8_t i = 0; i < count; i++) {
+                    memcpy(line + i * cw,
+                           mGlyphCache.run(slot, GlyphRunCache::rowBits(str[i], row)),
+                           cw * sizeof(uint16_t));
+                }
+            } else if (line != prev) {
+                memcpy(line, prev, w * sizeof(uint16_t));
+            }
+            prev = line;
+            if (dma) {
+                used += w;
+            } else {
+                for (uint16_t i = 0; i < w; i++) writeData(line[i]);
+            }
+        }
+    }
+    if (used > 0) {
+        dmaWait();
+        dmaStart(mLineBuf[cur], used, true);
+    }
+    if (dma) dmaWait();
+}
+#endif
+
+void Ili9341Lcd::forgetText(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+#if DISPLAY_FEATURE_TEXT_CACHE
+    mTextDiff.invalidate(x, y, w, h);
+#else
+    (void)x; (void)y; (void)w; (void)h;
+#endif
+}
+
 void Ili9341Lcd::drawXBitmap(uint16_t x, uint16_t y,
                               uint16_t w, uint16_t h,
                               const uint8_t* bitmap,
                               uint16_t fg, uint16_t bg) {
     if (x >= WIDTH || y >= HEIGHT) return;
+    uint16_t srcW = w;
     if (x + w > WIDTH) w = WIDTH - x;
     if (y + h > HEIGHT) h = HEIGHT - y;
+    forgetText(x, y, w, h);
 
     setWindow(x, y, x + w - 1, y + h - 1);
     writeCmd(0x2C);  // Memory Write
 
-    uint16_t bytesPerRow = (w + 7) / 8;
-    for (uint16_t row = 0; row < h; row++) {
-        for (uint16_t col = 0; col < w; col++) {
+    // Stride comes from the source width, even when clipped
+    uint16_t bytesPerRow = (srcW + 7) / 8;
+    uint16_t col = 0, row = 0;
+    pushPixels((uint32_t)w * h, [&](uint16_t* dst, uint16_t n) {
+        for (uint16_t i = 0; i < n; i++) {
             uint8_t byte = bitmap[row * bytesPerRow + (col >> 3)];
-            writeData((byte & (1 << (col & 7))) ? fg : bg);
+            dst[i] = (byte & (1 << (col & 7))) ? fg : bg;
+            if (++col == w) { col = 0; row++; }
         }
+    });
+}
+
+void Ili9341Lcd::drawBitmap16(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                              const uint16_t* pixels) {
+    if (x >= WIDTH || y >= HEIGHT || w == 0 || h == 0) return;
+    uint16_t srcW = w;
+    if (x + w > WIDTH) w = WIDTH - x;
+    if (y + h > HEIGHT) h = HEIGHT - y;
+    forgetText(x, y, w, h);
+
+    setWindow(x, y, x + w - 1, y + h - 1);
+    writeCmd(0x2C);
+
+    uint32_t total = (uint32_t)w * h;
+    if (!mDmaReady || total < DMA_MIN_PIXELS) {
+        for (uint16_t r = 0; r < h; r++)
+            for (uint16_t c = 0; c < w; c++)
+                writeData(pixels[r * srcW + c]);
+        return;
+    }
+    if (w == srcW) {
+        dmaWrite(pixels, total, true);   // contiguous — one (or two) transfers
+        return;
     }
+    // Clipped rows are short: pack them into the line buffers
+    uint16_t col = 0, row = 0;
+    pushPixels(total, [&](uint16_t* dst, uint16_t n) {
+        for (uint16_t i = 0; i < n; i++) {
+            dst[i] = pixels[row * srcW + col];
+            if (++col == w) { col = 0; row++; }
+        }
+    });
 }
 
 } // namespace lcd
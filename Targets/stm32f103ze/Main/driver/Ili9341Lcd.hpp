@@ -1,6 +1,10 @@
 #pragma once
 
 #include "stm32f1xx_hal.h"
+#include "DisplayConfig.hpp"
+#if DISPLAY_FEATURE_TEXT_CACHE
+#include "TextCache.hpp"
+#endif
 #include <cstdint>
 
 namespace arcana {
@@ -19,6 +23,8 @@ public:
     void drawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color);
     void drawXBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
                      const uint8_t* bitmap, uint16_t fg, uint16_t bg);
+    void drawBitmap16(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint16_t* pixels);
 
     static const uint16_t WIDTH  = 240;
     static const uint16_t HEIGHT = 320;
@@ -34,6 +40,16 @@ public:
     static const uint16_t GRAY    = 0x7BEF;
     static const uint16_t DARKGRAY = 0x39E7;
 
+    // One line buffer holds a full row; two let the CPU expand the next
+    // row (glyphs, XBM) while DMA drains the current one
+    static const uint16_t LINE_PIXELS = WIDTH;
+    // DMA path: below one full row the channel setup, completion wait and
+    // context switch cost more than the FSMC store loop (a scale-1 glyph
+    // is 42 px, a clock digit pair at scale 2 is 24 px wide)
+    static const uint16_t DMA_MIN_PIXELS = LINE_PIXELS;
+    // DMA CNDTR is 16-bit
+    static const uint16_t DMA_MAX_XFER = 0xFFFF;
+
 private:
     void enableBacklight();
     void initFsmc();
@@ -43,6 +59,28 @@ private:
     void writeData(uint16_t data);
     void setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
 
+    // DMA2 Channel1 memory-to-FSMC. Source is the DMA "peripheral" side in
+    // MEM2MEM mode: non-incrementing for fills, incrementing for blits.
+    void initDma();
+    void dmaWrite(const uint16_t* src, uint32_t count, bool increment);
+    void dmaStart(const uint16_t* src, uint16_t count, bool increment);
+    void dmaWait();
+    template <typename Gen> void pushPixels(uint32_t total, Gen gen);
+
+#if DISPLAY_FEATURE_TEXT_CACHE
+    // One window for the changed span; each font row is composed once from
+    // cached runs and sent `scale` times
+    void blitText(uint16_t x, uint16_t y, const char* str, uint8_t count,
+                  uint8_t scale, int8_t slot);
+    GlyphRunCache mGlyphCache;
+    TextDiff mTextDiff;
+#endif
+    void forgetText(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+    bool mDmaReady;
+    uint16_t mFillColor;                     // DMA source for fills
+    uint16_t mLineBuf[2][LINE_PIXELS];
+
     // FSMC Bank1 NE4 base: 0x6C000000, A23 (PE2) as RS (D/C)
     // CMD (A23=0): 0x6C000000, DATA (A23=1): 0x6D000000
     static volatile uint16_t* const CMD_ADDR;
@@ -3,7 +3,7 @@
 namespace arcana {
 namespace sensor {
 
-Mpu6050Sensor::Mpu6050Sensor() : mBus(0) {}
+Mpu6050Sensor::Mpu6050Sensor() : mBus(0), mFifo(false), mRateHz(0) {}
 
 void Mpu6050Sensor::init(I2cBus* bus) {
     mBus = bus;
@@ -22,13 +22,85 @@ Mpu6050Reading Mpu6050Sensor::read() {
     result.accelX = static_cast<int16_t>((buf[0] << 8) | buf[1]);
     result.accelY = static_cast<int16_t>((buf[2] << 8) | buf[3]);
     result.accelZ = static_cast<int16_t>((buf[4] << 8) | buf[5]);
-
-    int16_t rawTemp = static_cast<int16_t>((buf[6] << 8) | buf[7]);
-    result.temperature = (rawTemp / 340.0f) + 36.53f;
+    result.temperature = tempFromRaw(buf + 6);
 
     result.valid = true;
     return result;
 }
 
+// ---------------------------------------------------------------------------
+// FIFO burst mode
+// ---------------------------------------------------------------------------
+
+bool Mpu6050Sensor::enableFifo(uint16_t rateHz) {
+    mFifo = false;
+    if (!mBus) return false;
+
+    uint8_t who = 0;
+    if (!mBus->readReg(ADDR, REG_WHO_AM_I, &who) || who != ADDR) return false;
+
+    if (rateHz == 0) rateHz = 1;
+    if (rateHz > FIFO_MAX_HZ) rateHz = FIFO_MAX_HZ;
+    uint16_t div = FIFO_MAX_HZ / rateHz - 1;
+    if (div > 255) div = 255;
+    mRateHz = FIFO_MAX_HZ / (1 + div);
+
+    // Gyro PLL clock keeps the sample period steadier than the internal RC
+    bool ok = mBus->writeReg(ADDR, REG_PWR_MGMT_1, CLKSEL_PLL_GYRO_X)
+           && mBus->writeReg(ADDR, REG_CONFIG, DLPF_184HZ)
+           && mBus->writeReg(ADDR, REG_SMPLRT_DIV, static_cast<uint8_t>(div))
+           && mBus->writeReg(ADDR, REG_INT_ENABLE, INT_FIFO_OFLOW)
+           && mBus->writeReg(ADDR, REG_FIFO_EN, FIFO_EN_ACCEL)
+           && resetFifo();
+    mFifo = ok;
+    return ok;
+}
+
+bool Mpu6050Sensor::resetFifo() {
+    return mBus->writeReg(ADDR, REG_USER_CTRL, USER_CTRL_FIFO_RESET)
+        && mBus->writeReg(ADDR, REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+Mpu6050FifoRead Mpu6050Sensor::readFifo(int16_t* xyz, uint16_t maxFrames) {
+    Mpu6050FifoRead r = {0, 0, false, false};
+    if (!mBus || !mFifo) return r;
+
+    uint8_t status = 0;
+    uint8_t cnt[2];
+    if (!mBus->readReg(ADDR, REG_INT_STATUS, &status)) return r;
+    if (!mBus->readRegs(ADDR, REG_FIFO_COUNT_H, cnt, 2)) return r;
+    uint16_t count = static_cast<uint16_t>((cnt[0] << 8) | cnt[1]);
+
+    // 1024 is not a multiple of the frame, so an overflow leaves the read
+    // pointer mid-frame: start over
+    if ((status & INT_FIFO_OFLOW) || count >= FIFO_SIZE) {
+        r.overflow = true;
+        r.ok = resetFifo();
+        return r;
+    }
+
+    uint16_t avail = count / FIFO_FRAME;
+    uint16_t n = avail < maxFrames ? avail : maxFrames;
+    if (n > 0) {
+        uint8_t* raw = reinterpret_cast<uint8_t*>(xyz);
+        if (!mBus->readRegs(ADDR, REG_FIFO_R_W, raw, n * FIFO_FRAME)) return r;
+        // Big-endian to int16 in place: each word's bytes are read before it is written
+        for (uint16_t i = 0; i < n * 3; i++) {
+            xyz[i] = static_cast<int16_t>((raw[2 * i] << 8) | raw[2 * i + 1]);
+        }
+    }
+    r.frames = n;
+    r.pending = avail - n;
+    r.ok = true;
+    return r;
+}
+
+bool Mpu6050Sensor::readTemperature(float* celsius) {
+    uint8_t buf[2];
+    if (!mBus || !mBus->readRegs(ADDR, REG_TEMP_OUT_H, buf, 2)) return false;
+    *celsius = tempFromRaw(buf);
+    return true;
+}
+
 } // namespace sensor
 } // namespace arcana
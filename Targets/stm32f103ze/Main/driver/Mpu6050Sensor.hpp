@@ -12,18 +12,74 @@ struct Mpu6050Reading {
     bool valid;
 };
 
+/** Result of one FIFO drain */
+struct Mpu6050FifoRead {
+    uint16_t frames;    // accel XYZ frames copied out
+    uint16_t pending;   // whole frames left in the FIFO
+    bool overflow;      // FIFO overflowed and was reset; samples were lost
+    bool ok;            // bus transactions succeeded
+};
+
 class Mpu6050Sensor {
 public:
+    static const uint16_t FIFO_MAX_HZ = 1000;   // accel output rate with DLPF on
+
     Mpu6050Sensor();
     void init(I2cBus* bus);
     Mpu6050Reading read();
 
+    /**
+     * Stream accelerometer samples into the on-chip FIFO at 1kHz / (1 + div),
+     * the divider chosen for the nearest rate at or above rateHz.
+     * @return false if the chip is absent or did not take the config
+     */
+    bool enableFifo(uint16_t rateHz);
+    bool fifoEnabled() const { return mFifo; }
+    uint16_t sampleRateHz() const { return mRateHz; }
+
+    /**
+     * Burst-read up to maxFrames whole frames as interleaved X,Y,Z.
+     * On overflow the FIFO is reset (frame alignment is lost) and no
+     * samples are returned.
+     */
+    Mpu6050FifoRead readFifo(int16_t* xyz, uint16_t maxFrames);
+
+    bool readTemperature(float* celsius);
+
 private:
     static const uint8_t ADDR = 0x68;
-    static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+    static const uint8_t REG_SMPLRT_DIV = 0x19;
+    static const uint8_t REG_CONFIG = 0x1A;
+    static const uint8_t REG_FIFO_EN = 0x23;
+    static const uint8_t REG_INT_ENABLE = 0x38;
+    static const uint8_t REG_INT_STATUS = 0x3A;
     static const uint8_t REG_ACCEL_XOUT_H = 0x3B;
+    static const uint8_t REG_TEMP_OUT_H = 0x41;
+    static const uint8_t REG_USER_CTRL = 0x6A;
+    static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+    static const uint8_t REG_FIFO_COUNT_H = 0x72;
+    static const uint8_t REG_FIFO_R_W = 0x74;
+    static const uint8_t REG_WHO_AM_I = 0x75;
+
+    static const uint8_t FIFO_EN_ACCEL = 0x08;
+    static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+    static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+    static const uint8_t INT_FIFO_OFLOW = 0x10;
+    static const uint8_t CLKSEL_PLL_GYRO_X = 0x01;
+    static const uint8_t DLPF_184HZ = 0x01;     // also sets the 1kHz base rate
+
+    static const uint16_t FIFO_SIZE = 1024;
+    static const uint8_t FIFO_FRAME = 6;        // accel XYZ, big-endian
+
+    static float tempFromRaw(const uint8_t* be) {
+        int16_t raw = static_cast<int16_t>((be[0] << 8) | be[1]);
+        return (raw / 340.0f) + 36.53f;
+    }
+    bool resetFifo();
 
     I2cBus* mBus;
+    bool mFifo;
+    uint16_t mRateHz;
 };
 
 } // namespace sensor
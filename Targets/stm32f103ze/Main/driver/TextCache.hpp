@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Font5x7.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace arcana {
+namespace lcd {
+
+struct TextCacheTestAccess;
+
+/**
+ * Pre-expanded RGB565 runs for the 5x7 font.
+ *
+ * A glyph row is 5 bits, so any row of any glyph is one of 32 patterns.
+ * Each slot holds all 32 patterns expanded once for a (scale, fg, bg),
+ * including the 1px gap column — composing a text row is then a memcpy
+ * per character instead of a bit test per pixel.
+ */
+class GlyphRunCache {
+public:
+    static const uint8_t SLOTS     = 2;
+    static const uint8_t MAX_SCALE = 2;                  // larger text keeps drawChar
+    static const uint8_t CELL_W    = FONT_WIDTH + 1;     // glyph + gap column
+    static const uint8_t PATTERNS  = 1 << FONT_WIDTH;
+    static const uint8_t RUN_MAX   = CELL_W * MAX_SCALE;
+
+    GlyphRunCache() : mSlots(), mStamp(0), mHits(0), mMisses(0) {}
+
+    /**
+     * Slot with runs for (scale, fg, bg), expanding the least recently
+     * used slot on a miss.
+     * @return Slot index, or -1 if the scale is not cacheable
+     */
+    int8_t acquire(uint8_t scale, uint16_t fg, uint16_t bg) {
+        if (scale == 0 || scale > MAX_SCALE) return -1;
+        uint8_t victim = 0;
+        for (uint8_t i = 0; i < SLOTS; i++) {
+            Slot& s = mSlots[i];
+            if (s.scale == scale && s.fg == fg && s.bg == bg) {
+                s.stamp = ++mStamp;
+                mHits++;
+                return (int8_t)i;
+            }
+            if (s.scale == 0 || (mSlots[victim].scale != 0 && age(s) > age(mSlots[victim])))
+                victim = i;
+        }
+        expand(mSlots[victim], scale, fg, bg);
+        mSlots[victim].stamp = ++mStamp;
+        mMisses++;
+        return (int8_t)victim;
+    }
+
+    /** CELL_W * scale pixels for one row pattern (bit n = column n) */
+    const uint16_t* run(int8_t slot, uint8_t pattern) const {
+        return mSlots[slot].runs[pattern];
+    }
+
+    /** Row `row` (0 = top) of glyph c as a 5-bit pattern */
+    static uint8_t rowBits(char c, uint8_t row) {
+        if (c < 0x20 || c > 0x7E) c = '?';
+        const uint8_t* glyph = FONT_5X7[c - 0x20];
+        uint8_t bits = 0;
+        for (uint8_t col = 0; col < FONT_WIDTH; col++) {
+            if (glyph[col] & (1 << row)) bits |= (uint8_t)(1 << col);
+        }
+        return bits;
+    }
+
+    uint32_t hits() const { return mHits; }
+    uint32_t misses() const { return mMisses; }
+
+private:
+    friend struct TextCacheTestAccess;
+
+    struct Slot {
+        uint16_t fg;
+        uint16_t bg;
+        uint8_t scale;         // 0 = empty
+        uint32_t stamp;
+        uint16_t runs[PATTERNS][RUN_MAX];
+    };
+
+    // Draws since last use; unsigned difference stays right across a wrap
+    uint32_t age(const Slot& s) const { return mStamp - s.stamp; }
+
+    static void expand(Slot& s, uint8_t scale, uint16_t fg, uint16_t bg) {
+        s.scale = scale;
+        s.fg = fg;
+        s.bg = bg;
+        for (uint8_t p = 0; p < PATTERNS; p++) {
+            uint16_t* dst = s.runs[p];
+            for (uint8_t col = 0; col < CELL_W; col++) {
+                uint16_t c = (col < FONT_WIDTH && (p & (1 << col))) ? fg : bg;
+                for (uint8_t k = 0; k < scale; k++) *dst++ = c;
+            }
+        }
+    }
+
+    Slot mSlots[SLOTS];
+    uint32_t mStamp;
+    uint32_t mHits;
+    uint32_t mMisses;
+};
+
+/**
+ * What each text origin currently shows, so a redraw only touches the
+ * characters that changed.
+ *
+ * Entries are keyed by (x, y). A style change redraws the whole string;
+ * anything else drawn over an entry (fillRect, bitmaps, other text) must
+ * call invalidate() so stale entries are never trusted.
+ */
+class TextDiff {
+public:
+    static const uint8_t ENTRIES = 16;
+    static const uint8_t MAX_LEN = 28;
+
+    struct Span {
+        uint8_t first;
+        uint8_t count;     // 0 = nothing to draw
+    };
+
+    TextDiff() : mEntries(), mStamp(0) {}
+
+    /**
+     * Record `len` chars of str drawn at (x, y) and return the span that
+     * differs from what the origin shows now. Strings longer than MAX_LEN
+     * are not tracked and always redraw in full.
+     */
+    Span update(uint16_t x, uint16_t y, const char* str, uint8_t len,
+                uint8_t scale, uint16_t fg, uint16_t bg) {
+        Span all = { 0, len };
+        Entry* e = find(x, y);
+        uint16_t w = (uint16_t)len * FONT_CELL * scale;
+        uint16_t h = (uint16_t)FONT_HEIGHT * scale;
+
+        // Other origins under the new text are overwritten
+        for (uint8_t i = 0; i < ENTRIES; i++) {
+            Entry& o = mEntries[i];
+            if (o.used && &o != e && overlaps(o, x, y, w, h)) o.used = false;
+        }
+
+        if (len > MAX_LEN) {
+            if (e) e->used = false;
+            return all;
+        }
+
+        Span span = all;
+        if (e && e->scale == scale && e->fg == fg && e->bg == bg) {
+            uint8_t first = len, last = 0;
+            for (uint8_t i = 0; i < len; i++) {
+                if (i < e->len && e->text[i] == str[i]) continue;
+                if (first == len) first = i;
+                last = i;
+            }
+            span.first = first;
+            span.count = (first == len) ? 0 : (uint8_t)(last - first + 1);
+        }
+
+        if (!e) e = victim();
+        e->used = true;
+        e->x = x;
+        e->y = y;
+        e->scale = scale;
+        e->fg = fg;
+        e->bg = bg;
+        e->len = len;
+        memcpy(e->text, str, len);
+        e->stamp = ++mStamp;
+        return span;
+    }
+
+    /** Forget every entry overlapping the rect */
+    void invalidate(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+        for (uint8_t i = 0; i < ENTRIES; i++) {
+            if (mEntries[i].used && overlaps(mEntries[i], x, y, w, h))
+                mEntries[i].used = false;
+        }
+    }
+
+    void clear() {
+        for (uint8_t i = 0; i < ENTRIES; i++) mEntries[i].used = false;
+    }
+
+private:
+    friend struct TextCacheTestAccess;
+
+    static const uint8_t FONT_CELL = FONT_WIDTH + 1;
+
+    struct Entry {
+        uint16_t x, y;
+        uint16_t fg, bg;
+        uint32_t stamp;
+        uint8_t scale;
+        uint8_t len;
+        bool used;
+        char text[MAX_LEN];
+    };
+
+    Entry* find(uint16_t x, uint16_t y) {
+        for (uint8_t i = 0; i < ENTRIES; i++) {
+            Entry& e = mEntries[i];
+            if (e.used && e.x == x && e.y == y) return &e;
+        }
+        return nullptr;
+    }
+
+    /** Free entry, else the least recently drawn one */
+    Entry* victim() {
+        Entry* v = &mEntries[0];
+        for (uint8_t i = 0; i < ENTRIES; i++) {
+            Entry& e = mEntries[i];
+            if (!e.used) return &e;
+            if (mStamp - e.stamp > mStamp - v->stamp) v = &e;   // older, wrap-safe
+        }
+        return v;
+    }
+
+    static bool overlaps(const Entry& e, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+        uint16_t ew = (uint16_t)e.len * FONT_CELL * e.scale;
+        uint16_t eh = (uint16_t)FONT_HEIGHT * e.scale;
+        return x < e.x + ew && e.x < x + w && y < e.y + eh && e.y < y + h;
+    }
+
+    Entry mEntries[ENTRIES];
+    uint32_t mStamp;
+};
+
+} // namespace lcd
+} // namespace arcana
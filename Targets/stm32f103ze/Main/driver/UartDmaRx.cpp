@@ -0,0 +1,125 @@
+#include "UartDmaRx.hpp"
+
+namespace arcana {
+
+UartDmaRx::UartDmaRx(uint8_t* ring, uint16_t size)
+    : mRing(ring)
+    , mSize(size)
+    , mDma(0)
+    , mNotify(0)
+    , mCtx(0)
+    , mLastPos(0)
+    , mWritten(0)
+    , mRead(0)
+    , mEvents(0)
+    , mOverruns(0)
+    , mLost(0)
+    , mUartOverruns(0)
+    , mPeak(0)
+{
+}
+
+bool UartDmaRx::start(UART_HandleTypeDef* huart, DMA_HandleTypeDef* hdma,
+                      Notify notify, void* ctx) {
+    // Power-of-two ring: the free-running counts stay valid across wrap
+    if (!huart || !hdma || !mRing || mSize == 0 || (mSize & (mSize - 1))) {
+        return false;
+    }
+    if (mDma) stop();
+
+    mNotify = notify;
+    mCtx = ctx;
+    mLastPos = 0;
+    mWritten = 0;
+    mRead = 0;
+
+    hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma->Init.MemInc = DMA_MINC_ENABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma->Init.Mode = DMA_CIRCULAR;
+    hdma->Init.Priority = DMA_PRIORITY_MEDIUM;
+    if (HAL_DMA_Init(hdma) != HAL_OK) return false;
+
+    hdma->Parent = this;
+    // Both callbacks set: HAL_DMA_Start_IT enables HT as well as TC
+    hdma->XferHalfCpltCallback = dmaEvent;
+    hdma->XferCpltCallback = dmaEvent;
+    mDma = hdma;
+
+    if (HAL_DMA_Start_IT(hdma, (uintptr_t)&huart->Instance->DR,
+                         (uintptr_t)mRing, mSize) != HAL_OK) {
+        mDma = 0;
+        return false;
+    }
+    huart->Instance->CR3 = huart->Instance->CR3 | USART_CR3_DMAR;
+    return true;
+}
+
+void UartDmaRx::stop() {
+    if (!mDma) return;
+    HAL_DMA_Abort(mDma);
+    mDma = 0;
+}
+
+void UartDmaRx::dmaEvent(DMA_HandleTypeDef* hdma) {
+    UartDmaRx* self = static_cast<UartDmaRx*>(hdma->Parent);
+    if (self->isr_update() && self->mNotify) self->mNotify(self->mCtx);
+}
+
+bool UartDmaRx::isr_update() {
+    if (!mDma) return false;
+    mEvents = mEvents + 1;
+
+    // CNDTR counts down from size and reloads; 0 only at the reload instant
+    uint32_t pos = mSize - __HAL_DMA_GET_COUNTER(mDma);
+    if (pos >= mSize) pos = 0;
+    uint16_t delta = (uint16_t)((pos + mSize - mLastPos) & (mSize - 1));
+    mLastPos = (uint16_t)pos;
+    if (delta == 0) return false;
+
+    mWritten = mWritten + delta;
+    uint32_t fill = mWritten - mRead;
+    if (fill > mSize) fill = mSize;
+    if (fill > mPeak) mPeak = (uint16_t)fill;
+    return true;
+}
+
+bool UartDmaRx::checkOverrun() {
+    uint32_t fill = mWritten - mRead;
+    if (fill <= mSize) return false;
+    mOverruns++;
+    mLost += fill;
+    mRead = mWritten;
+    return true;
+}
+
+uint16_t UartDmaRx::available() {
+    checkOverrun();
+    return (uint16_t)(mWritten - mRead);
+}
+
+UartRxSpan UartDmaRx::span() {
+    UartRxSpan s;
+    checkOverrun();
+    uint32_t fill = mWritten - mRead;
+    uint16_t off = (uint16_t)(mRead & (mSize - 1));
+    uint16_t run = mSize - off;
+    s.data = mRing + off;
+    s.len = fill < run ? (uint16_t)fill : run;
+    return s;
+}
+
+void UartDmaRx::consume(uint16_t n) {
+    uint32_t fill = mWritten - mRead;
+    mRead = mRead + (n < fill ? n : fill);
+}
+
+void UartDmaRx::flush() {
+    // Also drops what the channel wrote since the last event
+    isr_update();
+    mRead = mWritten;
+}
+
+} // namespace arcana
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "stm32f1xx_hal.h"
+#include <cstdint>
+
+namespace arcana {
+
+/** Contiguous run of received bytes, valid until consume() */
+struct UartRxSpan {
+    const uint8_t* data;
+    uint16_t len;
+};
+
+/**
+ * USART receive through a circular DMA ring.
+ *
+ * The channel runs forever from DR into the ring; nothing interrupts per
+ * byte. The driver is woken by the DMA half/full-transfer events and by
+ * the USART IDLE line, each of which calls isr_update() to account for
+ * what the channel wrote since the last event. HT + TC bound the gap
+ * between updates to half a ring, so the write count stays exact.
+ *
+ * One consumer reads spans straight out of the ring and consume()s them.
+ * A writer that laps the consumer corrupts unread bytes: the consumer
+ * sees it on its next call, drops the backlog and counts an overrun.
+ *
+ * Interrupt sources for the owning driver:
+ *   - DMA channel IRQ  → HAL_DMA_IRQHandler → notify(ctx)
+ *   - USART IRQ, IDLE  → clear flag, isr_update(), then frame handling
+ *   - USART IRQ, ORE   → isr_onUartOverrun()
+ */
+class UartDmaRx {
+public:
+    typedef void (*Notify)(void* ctx);
+
+    UartDmaRx(uint8_t* ring, uint16_t size);
+
+    /** Configure the channel circular and start it; notify runs from the DMA IRQ */
+    bool start(UART_HandleTypeDef* huart, DMA_HandleTypeDef* hdma,
+               Notify notify, void* ctx);
+    void stop();
+
+    // --- ISR side ---
+
+    /** Account for bytes the channel wrote since the last event */
+    bool isr_update();
+    void isr_onUartOverrun() { mUartOverruns = mUartOverruns + 1; }
+
+    // --- Consumer side (one reader) ---
+
+    uint16_t available();
+    /** Readable bytes up to the ring end; a wrapped run takes two spans */
+    UartRxSpan span();
+    void consume(uint16_t n);
+    /** Drop everything received so far */
+    void flush();
+
+    // --- Statistics ---
+
+    uint16_t size() const { return mSize; }
+    uint32_t received() const { return mWritten; }
+    uint32_t events() const { return mEvents; }
+    /** Times the writer lapped the reader, and the bytes dropped for it */
+    uint32_t overruns() const { return mOverruns; }
+    uint32_t lostBytes() const { return mLost; }
+    /** USART ORE: a byte the DMA did not pick up in time */
+    uint32_t uartOverruns() const { return mUartOverruns; }
+    /** Highest unread level seen at any event */
+    uint16_t peakFill() const { return mPeak; }
+
+private:
+    static void dmaEvent(DMA_HandleTypeDef* hdma);
+    /** Lapped: resync the reader to the writer */
+    bool checkOverrun();
+
+    uint8_t* mRing;
+    uint16_t mSize;
+    DMA_HandleTypeDef* mDma;
+    Notify mNotify;
+    void* mCtx;
+
+    uint16_t mLastPos;            // channel position at the last event
+    volatile uint32_t mWritten;   // bytes written, ISR only
+    volatile uint32_t mRead;      // bytes consumed, consumer only
+    volatile uint32_t mEvents;
+    uint32_t mOverruns;
+    uint32_t mLost;
+    volatile uint32_t mUartOverruns;
+    volatile uint16_t mPeak;
+};
+
+} // namespace arcana
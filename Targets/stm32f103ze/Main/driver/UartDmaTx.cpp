@@ -0,0 +1,185 @@
+#include "UartDmaTx.hpp"
+
+namespace arcana {
+
+// Before the scheduler runs there is no task to notify: spin on the flag
+static const uint32_t SPIN_LIMIT = 5000000;
+
+UartDmaTx::UartDmaTx()
+    : mUart(0)
+    , mDma(0)
+    , mSegs{}
+    , mCount(0)
+    , mIndex(0)
+    , mOffset(0)
+    , mBusy(false)
+    , mFailed(false)
+    , mWaiter(0)
+    , mBytes(0)
+    , mSends(0)
+    , mTimeouts(0)
+{
+}
+
+bool UartDmaTx::start(UART_HandleTypeDef* huart, DMA_HandleTypeDef* hdma) {
+    if (!huart) return false;
+    mUart = huart;
+    mDma = hdma;
+    if (!hdma) return true;
+
+    hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma->Init.MemInc = DMA_MINC_ENABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma->Init.Mode = DMA_NORMAL;
+    hdma->Init.Priority = DMA_PRIORITY_LOW;      // RX rings come first
+    if (HAL_DMA_Init(hdma) != HAL_OK) return false;
+
+    hdma->Parent = this;
+    hdma->XferCpltCallback = dmaDone;
+    hdma->XferHalfCpltCallback = 0;              // no HT interrupt
+    hdma->XferErrorCallback = dmaError;
+    return true;
+}
+
+bool UartDmaTx::submit(const UartTxSeg* segs, uint8_t count) {
+    if (!mUart || mBusy || count > MAX_SEGS) return false;
+
+    mCount = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (segs[i].len) mSegs[mCount++] = segs[i];
+    }
+    if (mCount == 0) {
+        mFailed = false;
+        return true;
+    }
+
+    bool rtos = xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+    mWaiter = rtos ? xTaskGetCurrentTaskHandle() : 0;
+    if (rtos) ulTaskNotifyTake(pdTRUE, 0);   // drain a stale completion
+    mIndex = 0;
+    mOffset = 0;
+    mFailed = false;
+    mBusy = true;
+    mSends++;
+
+    if (!mDma) {
+        // TXE is already set: the first interrupt fires at once
+        mUart->Instance->CR1 = mUart->Instance->CR1 | USART_CR1_TXEIE;
+        return true;
+    }
+    mUart->Instance->CR3 = mUart->Instance->CR3 | USART_CR3_DMAT;
+    const UartTxSeg& s = mSegs[0];
+    if (HAL_DMA_Start_IT(mDma, (uintptr_t)s.data, (uintptr_t)&mUart->Instance->DR,
+                         s.len) != HAL_OK) {
+        mUart->Instance->CR3 = mUart->Instance->CR3 & ~USART_CR3_DMAT;
+        mBusy = false;
+        mFailed = true;
+        return false;
+    }
+    return true;
+}
+
+bool UartDmaTx::wait(uint32_t timeoutMs) {
+    if (mBusy) {
+        if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+            TickType_t start = xTaskGetTickCount();
+            TickType_t total = pdMS_TO_TICKS(timeoutMs);
+            while (mBusy) {
+                TickType_t elapsed = xTaskGetTickCount() - start;
+                if (elapsed >= total) break;
+                ulTaskNotifyTake(pdTRUE, total - elapsed);
+            }
+        } else {
+            for (uint32_t n = 0; mBusy && n < SPIN_LIMIT; n++) {}
+        }
+        if (mBusy) {
+            abort();
+            mTimeouts++;
+            return false;
+        }
+    }
+    return !mFailed;
+}
+
+bool UartDmaTx::send(const UartTxSeg* segs, uint8_t count, uint32_t timeoutMs) {
+    if (!submit(segs, count)) return false;
+    return wait(timeoutMs);
+}
+
+void UartDmaTx::abort() {
+    taskENTER_CRITICAL();
+    if (mBusy) {
+        if (mDma) {
+            HAL_DMA_Abort(mDma);
+            mUart->Instance->CR3 = mUart->Instance->CR3 & ~USART_CR3_DMAT;
+        } else {
+            mUart->Instance->CR1 = mUart->Instance->CR1 & ~USART_CR1_TXEIE;
+        }
+        mBusy = false;
+        mFailed = true;
+    }
+    taskEXIT_CRITICAL();
+}
+
+// --- ISR side ---
+
+void UartDmaTx::dmaDone(DMA_HandleTypeDef* hdma) {
+    UartDmaTx* self = static_cast<UartDmaTx*>(hdma->Parent);
+    self->mBytes = self->mBytes + self->mSegs[self->mIndex].len;
+    self->mIndex = self->mIndex + 1;
+    self->next();
+}
+
+void UartDmaTx::dmaError(DMA_HandleTypeDef* hdma) {
+    static_cast<UartDmaTx*>(hdma->Parent)->finish(false);
+}
+
+void UartDmaTx::next() {
+    if (mIndex >= mCount) {
+        finish(true);
+        return;
+    }
+    // The channel is idle again inside its own TC callback: chain straight on
+    const UartTxSeg& s = mSegs[mIndex];
+    if (HAL_DMA_Start_IT(mDma, (uintptr_t)s.data, (uintptr_t)&mUart->Instance->DR,
+                         s.len) != HAL_OK) {
+        finish(false);
+    }
+}
+
+void UartDmaTx::isr_onTxe() {
+    if (!mBusy || mDma) {
+        mUart->Instance->CR1 = mUart->Instance->CR1 & ~USART_CR1_TXEIE;
+        return;
+    }
+    const UartTxSeg& s = mSegs[mIndex];
+    mUart->Instance->DR = static_cast<const uint8_t*>(s.data)[mOffset];
+    mBytes = mBytes + 1;
+    uint16_t off = mOffset + 1;
+    if (off < s.len) {
+        mOffset = off;
+        return;
+    }
+    mOffset = 0;
+    mIndex = mIndex + 1;
+    if (mIndex >= mCount) finish(true);
+}
+
+void UartDmaTx::finish(bool ok) {
+    if (mDma) {
+        mUart->Instance->CR3 = mUart->Instance->CR3 & ~USART_CR3_DMAT;
+    } else {
+        mUart->Instance->CR1 = mUart->Instance->CR1 & ~USART_CR1_TXEIE;
+    }
+    mFailed = !ok;
+    mBusy = false;
+    BaseType_t woken = pdFALSE;
+    if (mWaiter) {
+        vTaskNotifyGiveFromISR(mWaiter, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+} // namespace arcana
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "stm32f1xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstdint>
+
+namespace arcana {
+
+/** One piece of an outgoing packet; must stay valid until the send is done */
+struct UartTxSeg {
+    const void* data;
+    uint16_t len;
+};
+
+/**
+ * Asynchronous USART transmit of a gather list.
+ *
+ * submit() takes up to MAX_SEGS descriptors (say header + payload +
+ * trailer in three separate buffers) and returns at once; the segments
+ * go out back to back without being copied together. The F1 DMA has no
+ * descriptor chaining, so the transfer-complete ISR restarts the channel
+ * on the next segment — a few µs between segments, well under a byte time.
+ * The task that submitted sleeps in wait() on its task notification.
+ *
+ * Without a DMA channel (hdma = nullptr) the same list is fed from the
+ * USART TXE interrupt, one byte per IRQ: the owning driver calls
+ * isr_onTxe() from its USART handler.
+ */
+class UartDmaTx {
+public:
+    static const uint8_t MAX_SEGS = 4;
+
+    UartDmaTx();
+
+    /** Configure the channel memory-to-DR; hdma->Instance must be set */
+    bool start(UART_HandleTypeDef* huart, DMA_HandleTypeDef* hdma);
+
+    /** Start sending; false while a send is in flight or the list is too long */
+    bool submit(const UartTxSeg* segs, uint8_t count);
+    /** Sleep until the submitted list is out; aborts it on timeout */
+    bool wait(uint32_t timeoutMs);
+    /** submit() + wait() */
+    bool send(const UartTxSeg* segs, uint8_t count, uint32_t timeoutMs);
+    void abort();
+
+    bool busy() const { return mBusy; }
+
+    // --- ISR side ---
+
+    /** TXE interrupt, IRQ-fed mode only */
+    void isr_onTxe();
+
+    // --- Statistics ---
+
+    uint32_t bytesSent() const { return mBytes; }
+    uint32_t sends() const { return mSends; }
+    uint32_t timeouts() const { return mTimeouts; }
+
+private:
+    static void dmaDone(DMA_HandleTypeDef* hdma);
+    static void dmaError(DMA_HandleTypeDef* hdma);
+    /** Start the segment at mIndex, or finish when there is none */
+    void next();
+    void finish(bool ok);
+
+    UART_HandleTypeDef* mUart;
+    DMA_HandleTypeDef* mDma;
+    UartTxSeg mSegs[MAX_SEGS];
+    uint8_t mCount;
+    volatile uint8_t mIndex;
+    volatile uint16_t mOffset;    // IRQ-fed: next byte in the segment
+    volatile bool mBusy;
+    volatile bool mFailed;
+    TaskHandle_t mWaiter;
+
+    volatile uint32_t mBytes;
+    uint32_t mSends;
+    uint32_t mTimeouts;
+};
+
+} // namespace arcana
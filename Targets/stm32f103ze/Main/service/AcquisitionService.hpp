@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Observable.hpp"
+#include "F103Models.hpp"
+#include "ServiceTypes.hpp"
+#include "AcquisitionSchedule.hpp"
+
+namespace arcana {
+namespace acquisition {
+
+/**
+ * Single task that samples every bus sensor on its own plan. Sensor
+ * services register plans in start(), before this service starts.
+ */
+class AcquisitionService {
+public:
+    struct Output {
+        Observable<AcquisitionStatsModel>* StatsEvents;   // 1Hz jitter/miss window
+    };
+
+    Output output;
+
+    virtual ~AcquisitionService() {}
+    virtual ServiceStatus initHAL() = 0;
+    virtual ServiceStatus init() = 0;
+    virtual ServiceStatus start() = 0;
+    virtual void stop() = 0;
+
+    virtual bool addPlan(const AcqPlan& plan) = 0;
+
+protected:
+    AcquisitionService() : output() {
+        output.StatsEvents = 0;
+    }
+};
+
+} // namespace acquisition
+} // namespace arcana
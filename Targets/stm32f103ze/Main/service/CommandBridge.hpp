@@ -2,8 +2,12 @@
 
 #include "CommandTypes.hpp"
 #include "ICommand.hpp"
+#include "CommandTable.hpp"
+#include "StreamSender.hpp"
 #include "FrameCodec.hpp"
+#include "BatchCodec.hpp"
 #include "SensorDataCache.hpp"
+#include "Sha256.hpp"
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
@@ -16,10 +20,11 @@ struct FrameItem;
 
 /**
  * Shared frame item for RX queue.
- * MAX_DATA=80 fits encrypted commands: [nonce:12][cipher:28max][hmac:32] = 72B
+ * MAX_DATA=128 fits an encrypted v2 batch: 9B frame + [nonce:12][cipher:75max][hmac:32]
+ * (AEAD sessions: [nonce:12][cipher:91max][tag:16])
  */
 struct CmdFrameItem {
-    static constexpr uint16_t MAX_DATA = 80;
+    static constexpr uint16_t MAX_DATA = 128;
     uint8_t data[MAX_DATA];
     uint16_t len;
     enum Transport : uint8_t { BLE = 0, MQTT = 1 } source;
@@ -27,39 +32,122 @@ struct CmdFrameItem {
 
 /**
  * Lightweight ChaCha20 session — replaces CryptoEngine + KeyExchangeManager.
- * 41 bytes per session vs ~430 bytes per CryptoEngine instance.
+ * 106 bytes per session vs ~430 bytes per CryptoEngine instance.
+ * suite is picked at key exchange (CommandBridge::SUITE_*); mac holds the
+ * HMAC pad midstates of key so HMAC frames skip the two pad blocks.
  */
 struct ChaChaSession {
     uint8_t key[32] = {};
+    crypto::HmacSha256::Key mac = {};
     uint32_t txCounter = 0;
     uint32_t rxCounter = 0;
     bool active = false;
+    uint8_t suite = 0;
+
+    void install(const uint8_t sessionKey[32], uint8_t sessionSuite) {
+        memcpy(key, sessionKey, 32);
+        crypto::HmacSha256::setKey(mac, key, 32);
+        txCounter = 0;
+        rxCounter = 0;
+        active = true;
+        suite = sessionSuite;
+    }
 };
 
 /**
  * CommandBridge — shared command registry + frame processing.
  * Transport-agnostic: BLE and MQTT share the same crypto path.
  *
- * Crypto: uECC (ECDH) + ChaCha20 (encrypt) + HMAC-SHA256 (auth)
+ * Crypto: ephemeral P-256 ECDH (crypto::P256 — comb keygen on uECC's field
+ * arithmetic) and HKDF-SHA256 for the session key. Frames are sealed with
+ * one of two suites: ChaCha20 + HMAC-SHA256 (encrypt-then-MAC, the
+ * original), or ChaCha20-Poly1305 AEAD (RFC 8439) when the client offers
+ * it at key exchange. Session tickets (below) resume without P-256.
  * Zero mbedtls dependency.
  *
+ * Suite negotiation: a KE request may append one offer byte after the
+ * client key (bit0 = AEAD). The response then appends the chosen suite and
+ * the auth tag covers serverPub || clientPub || offer || chosen, so a
+ * stripped offer fails authentication. Without the byte the exchange is
+ * the original 96-byte one and the session stays HMAC.
+ *
+ * Resumption: inside a session, SessionTicket returns an opaque ticket
+ * sealed under a per-boot ticket key; both sides derive its resumption
+ * secret from the session key. ResumeSession (plaintext, like KE) trades
+ * ticket + client nonce for a server nonce and a fresh session key from
+ * one HKDF — no P-256 on reconnect. Tickets expire after
+ * TICKET_LIFETIME_S, die with a reboot and are single-use: the serial
+ * must rise per transport, as the nonce counter does.
+ *
  * StreamId routing:
  *   0x00 = plaintext binary command (backward compatible)
- *   0x10 = ChaCha20 + HMAC encrypted command
+ *   0x01 = plaintext v2 batch (BatchCodec)
+ *   0x02 = plaintext stream transfer (StreamCodec DATA out, ACK/NACK/RESUME in)
+ *   0x10 = session-encrypted command
+ *   0x11 = session-encrypted v2 batch — one nonce/tag per batch
+ *   0x12 = session-encrypted stream transfer
+ *   (session suite: [nonce:12][cipher][hmac:32] or [nonce:12][cipher][tag:16])
  *   0x20 = ChaCha20 encrypted sensor stream (BleServiceImpl)
  */
 class CommandBridge {
 public:
-    static constexpr uint8_t SID_PLAINTEXT = 0x00;
-    static constexpr uint8_t SID_ENCRYPTED = 0x10;
-    static constexpr uint8_t SID_SENSOR    = 0x20;
+    static constexpr uint8_t SID_PLAINTEXT        = 0x00;
+    static constexpr uint8_t SID_BATCH            = 0x01;
+    static constexpr uint8_t SID_STREAM           = 0x02;
+    static constexpr uint8_t SID_ENCRYPTED        = 0x10;
+    static constexpr uint8_t SID_ENCRYPTED_BATCH  = 0x11;
+    static constexpr uint8_t SID_ENCRYPTED_STREAM = 0x12;
+    static constexpr uint8_t SID_SENSOR           = 0x20;
+
+    /** Largest response frame handed to a transport (batch responses) */
+    static constexpr uint16_t MAX_TX_FRAME = 160;
+
+    /** Session cipher suites (KE offer/chosen byte) */
+    static constexpr uint8_t SUITE_HMAC = 0x00;   // ChaCha20 + HMAC-SHA256
+    static constexpr uint8_t SUITE_AEAD = 0x01;   // ChaCha20-Poly1305
+
+    /** Crypto envelope around an encrypted payload: nonce + HMAC */
+    static constexpr size_t CRYPTO_OVERHEAD = 12 + 32;
+
+    /** Crypto envelope of an AEAD session: nonce + Poly1305 tag */
+    static constexpr size_t AEAD_OVERHEAD = 12 + 16;
+
+    /** Largest plaintext that fits one encrypted response frame (any suite) */
+    static constexpr size_t MAX_PLAIN =
+        MAX_TX_FRAME - FrameCodec::kOverhead - CRYPTO_OVERHEAD;
+
+    /** Resumption ticket: [serial:4][issueTick:4][sealed rms:32 suite:1 source:1][tag:16] */
+    static constexpr size_t TICKET_SIZE = 8 + 34 + 16;
+    static constexpr size_t RESUME_NONCE_SIZE = 16;
+    static constexpr uint32_t TICKET_LIFETIME_S = 12UL * 3600;
+
+    /** Largest plaintext that fits one AEAD response frame */
+    static constexpr size_t MAX_PLAIN_AEAD =
+        MAX_TX_FRAME - FrameCodec::kOverhead - AEAD_OVERHEAD;
+
+    /** True for stream ids carrying a v2 batch body */
+    static constexpr bool isBatchSid(uint8_t sid) {
+        return sid == SID_BATCH || sid == SID_ENCRYPTED_BATCH;
+    }
+
+    /** True for stream ids carrying StreamCodec messages */
+    static constexpr bool isStreamSid(uint8_t sid) {
+        return sid == SID_STREAM || sid == SID_ENCRYPTED_STREAM;
+    }
+
+    /** Stream transfer geometry: 8 x 96B chunks in flight (768B buffered) */
+    static constexpr uint8_t STREAM_WINDOW = 8;
+    static constexpr uint8_t STREAM_CHUNK  = 96;
+    static constexpr uint32_t STREAM_RTO_MS  = 1500;   // sender runs on the 1 kHz tick
+    static constexpr uint32_t STREAM_POLL_MS = 50;
+    typedef StreamSender<STREAM_WINDOW, STREAM_CHUNK> Stream;
 
     /** Transport send function */
     typedef bool (*TransportSendFn)(const uint8_t* data, uint16_t len, void* ctx);
 
     static CommandBridge& getInstance();
 
-    /** Register a command handler (max 16) */
+    /** Register an extra command handler at runtime (max 8 on top of built-ins) */
     bool registerCommand(ICommand* cmd);
 
     /** Submit a complete frame for processing (called from BLE/MQTT) */
@@ -81,11 +169,21 @@ public:
     void processFrame(const uint8_t* data, uint16_t len,
                       void (*respCb)(const uint8_t*, uint16_t, void*), void* ctx);
 
-    uint8_t getCommandCount() const { return mCommandCount; }
+    uint8_t getCommandCount() const { return mBuiltins.size() + mCommandCount; }
 
     /** Check if session is active for a transport source */
     bool hasSession(uint8_t source) const { return mSessions[source & 1].active; }
 
+    /**
+     * Start streaming src back to the transport (and crypto mode) of the
+     * command currently executing. Called from a command's execute().
+     * A stalled transfer is replaced; a running one makes this fail.
+     */
+    bool beginStream(IStreamSource* src, uint8_t& xferId);
+
+    /** True while a transfer is sending (not idle or stalled) */
+    bool isStreaming() const { return mStream.running(); }
+
 private:
     /* Test access — host-side gtest fixture exercises private crypto/registry. */
     friend struct CommandBridgeTestAccess;
@@ -94,9 +192,11 @@ private:
 
     static void bridgeTask(void* param);
 
-    // Command registry
-    static const uint8_t MAX_COMMANDS = 16;
-    ICommand* mCommands[MAX_COMMANDS];
+    // Command registry — built-ins in a constexpr table (flash, O(1)),
+    // runtime extras in a small keyed overflow list
+    static const uint8_t MAX_EXTRA_COMMANDS = 8;
+    CommandTableView mBuiltins;
+    CommandEntry mCommands[MAX_EXTRA_COMMANDS];
     uint8_t mCommandCount;
     ICommand* findCommand(CommandKey key);
 
@@ -114,10 +214,30 @@ private:
     ChaChaSession mSessions[MAX_SESSIONS];
     uint8_t mDeviceKey[32];  // for KE auth tag verification
 
-    // Bridge task — 512 words for uECC ECDH (~700B peak + frame processing)
-    static const uint16_t BRIDGE_STACK_SIZE = 512;
+    // Resumption tickets — key re-derived from the device key and a boot epoch
+    uint32_t mTicketEpoch;
+    uint32_t mTicketSerial;
+    uint32_t mResumedSerial[MAX_SESSIONS];
+
+    // Stream transfer — one at a time, bound to the transport that started it
+    Stream mStream;
+    uint8_t mStreamSource;
+    bool mStreamEncrypted;
+    uint8_t mNextXferId;
+    uint8_t mRxSource;       // origin of the command being executed
+    bool mRxEncrypted;
+
+    // Bridge task — deepest path is a key exchange, estimated at -O0 (not
+    // measured on target; CMD_STACK_FREE logs each new high-water mark):
+    //   bridgeTask locals, every block-scope buffer kept apart   ~1.1 KB
+    //   handleKeyExchange (priv, shared, session key, auth data)  ~0.3 KB
+    //   P256 keygen / ECDH on uECC's field arithmetic             ~1.2-1.35 KB
+    //   LOG_x, exception frame                                    ~0.1 KB
+    // ~2.85 KB; 832 words (3.25 KB) leaves ~15% headroom
+    static const uint16_t BRIDGE_STACK_SIZE = 832;
     StaticTask_t mBridgeTaskBuf;
     StackType_t mBridgeStack[BRIDGE_STACK_SIZE];
+    UBaseType_t mStackFree;  // lowest uxTaskGetStackHighWaterMark seen (words)
 
     // Transport send functions
     TransportSendFn mBleSend;
@@ -127,13 +247,28 @@ private:
 
     // Internal helpers
     bool handleKeyExchange(uint8_t source, const uint8_t* clientPub,
-                           uint8_t* serverPub, uint8_t* authTag);
+                           uint8_t* serverPub, uint8_t* authTag,
+                           const uint8_t* offer = nullptr, uint8_t* chosen = nullptr);
+    size_t cryptoOverhead(uint8_t source) const;
+    void ticketKey(uint8_t* key);
+    bool issueTicket(uint8_t source, uint8_t* ticket);
+    bool resumeSession(uint8_t source, const uint8_t* ticket, const uint8_t* clientNonce,
+                       uint8_t* serverNonce, uint8_t* confirm);
     bool encryptAndFrame(uint8_t source, uint8_t streamId,
                          const uint8_t* plain, size_t plainLen,
-                         uint8_t* frameBuf, size_t frameBufSize, size_t& frameLen);
+                         uint8_t* frameBuf, size_t frameBufSize, size_t& frameLen,
+                         uint8_t flags = FrameCodec::kFlagFin);
     bool decryptAndVerify(uint8_t source,
                           const uint8_t* payload, size_t payloadLen,
                           uint8_t* plain, size_t plainBufSize, size_t& plainLen);
+    void executeCommand(const CommandRequest& req, CommandResponseModel& rsp);
+    void handleBatch(uint8_t source, uint8_t streamId,
+                     const uint8_t* payload, size_t payloadLen);
+    bool sendToTransport(uint8_t source, const uint8_t* frame, size_t frameLen);
+    void handleStreamControl(uint8_t source, uint8_t streamId,
+                             const uint8_t* payload, size_t payloadLen);
+    void pumpStream();
+    static bool emitStreamData(const uint8_t* payload, size_t len, bool fin, void* ctx);
 };
 
 } // namespace arcana
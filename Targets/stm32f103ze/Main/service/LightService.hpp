@@ -3,16 +3,22 @@
 #include "Observable.hpp"
 #include "F103Models.hpp"
 #include "ServiceTypes.hpp"
+#include "AcquisitionService.hpp"
 
 namespace arcana {
 namespace light {
 
 class LightService {
 public:
+    struct Input {
+        acquisition::AcquisitionService* Acquisition;   // runs the sampling plans
+    };
+
     struct Output {
         Observable<LightDataModel>* DataEvents;
     };
 
+    Input input;
     Output output;
 
     virtual ~LightService() {}
@@ -22,7 +28,8 @@ public:
     virtual void stop() = 0;
 
 protected:
-    LightService() : output() {
+    LightService() : input(), output() {
+        input.Acquisition = 0;
         output.DataEvents = 0;
     }
 };
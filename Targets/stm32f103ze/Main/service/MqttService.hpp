@@ -13,7 +13,6 @@ class MqttService {
 public:
     struct Input {
         Observable<SensorDataModel>* SensorData;
-        Observable<LightDataModel>*  LightData;
         wifi::WifiService*           Wifi;
     };
 
@@ -34,7 +33,6 @@ public:
 protected:
     MqttService() : input(), output() {
         input.SensorData = 0;
-        input.LightData = 0;
         input.Wifi = 0;
         output.CommandEvents = 0;
         output.ConnectionStatus = 0;
@@ -27,6 +27,21 @@ public:
                              const char* path, uint32_t expectedSize,
                              uint32_t expectedCrc32) = 0;
 
+    /**
+     * @brief Start delta OTA update (blocks until complete or failed)
+     *
+     * Downloads a patch made by tools/ota_delta.py against the running
+     * image; the bootloader rebuilds the full image from flash + patch.
+     * @param path        HTTP path (e.g. "/fw_patch.bin")
+     * @param patchSize   Patch size in bytes
+     * @param patchCrc32  CRC-32 (IEEE) of the patch file
+     * @return true if the patch downloaded, matches the running image,
+     *         and the system will reset
+     */
+    virtual bool startDeltaUpdate(const char* host, uint16_t port,
+                                  const char* path, uint32_t patchSize,
+                                  uint32_t patchCrc32) = 0;
+
     /** @brief Get download progress (0-100) */
     virtual uint8_t getProgress() const = 0;
 
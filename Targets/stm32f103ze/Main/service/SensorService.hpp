@@ -3,16 +3,23 @@
 #include "Observable.hpp"
 #include "F103Models.hpp"
 #include "ServiceTypes.hpp"
+#include "AcquisitionService.hpp"
 
 namespace arcana {
 namespace sensor {
 
 class SensorService {
 public:
+    struct Input {
+        acquisition::AcquisitionService* Acquisition;   // runs the sampling plans
+    };
+
     struct Output {
-        Observable<SensorDataModel>* DataEvents;
+        Observable<SensorDataModel>* DataEvents;     // 1Hz snapshot
+        Observable<SensorBatchModel>* BatchEvents;   // accel FIFO bursts
     };
 
+    Input input;
     Output output;
 
     virtual ~SensorService() {}
@@ -22,8 +29,10 @@ public:
     virtual void stop() = 0;
 
 protected:
-    SensorService() : output() {
+    SensorService() : input(), output() {
+        input.Acquisition = 0;
         output.DataEvents = 0;
+        output.BatchEvents = 0;
     }
 };
 
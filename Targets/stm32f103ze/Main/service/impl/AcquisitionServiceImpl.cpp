@@ -0,0 +1,116 @@
+#include "AcquisitionServiceImpl.hpp"
+#include "stm32f1xx_hal.h"
+
+namespace arcana {
+namespace acquisition {
+
+AcquisitionServiceImpl::AcquisitionServiceImpl()
+    : mSchedule()
+    , mStatsObs("AcqSvc Stats")
+    , mStats()
+    , mTaskBuffer()
+    , mTaskStack{}
+    , mTaskHandle(0)
+    , mRunning(false)
+{
+    output.StatsEvents = &mStatsObs;
+}
+
+AcquisitionServiceImpl::~AcquisitionServiceImpl() {
+    stop();
+}
+
+AcquisitionService& AcquisitionServiceImpl::getInstance() {
+    static AcquisitionServiceImpl sInstance;
+    return sInstance;
+}
+
+ServiceStatus AcquisitionServiceImpl::initHAL() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    return ServiceStatus::OK;
+}
+
+ServiceStatus AcquisitionServiceImpl::init() {
+    mSchedule.setClock(cycleClockUs);
+    return ServiceStatus::OK;
+}
+
+ServiceStatus AcquisitionServiceImpl::start() {
+    mRunning = true;
+
+    mTaskHandle = xTaskCreateStatic(
+        acqTask,
+        "acq",
+        TASK_STACK_SIZE,
+        this,
+        tskIDLE_PRIORITY + 3,
+        mTaskStack,
+        &mTaskBuffer
+    );
+
+    if (!mTaskHandle) return ServiceStatus::Error;
+    return ServiceStatus::OK;
+}
+
+void AcquisitionServiceImpl::stop() {
+    mRunning = false;
+}
+
+bool AcquisitionServiceImpl::addPlan(const AcqPlan& plan) {
+    return mSchedule.add(plan);
+}
+
+uint32_t AcquisitionServiceImpl::cycleClockUs() {
+    // Only the acquisition task reads it, at least once per stats window,
+    // well inside the 59s CYCCNT wrap at 72MHz
+    static uint32_t sLastCycles = 0;
+    static uint32_t sCarry = 0;
+    static uint32_t sUs = 0;
+    uint32_t perUs = SystemCoreClock / 1000000;
+    if (perUs == 0) perUs = 1;
+    uint32_t cycles = DWT->CYCCNT;
+    sCarry += cycles - sLastCycles;
+    sLastCycles = cycles;
+    sUs += sCarry / perUs;
+    sCarry %= perUs;
+    return sUs;
+}
+
+void AcquisitionServiceImpl::acqTask(void* param) {
+    AcquisitionServiceImpl* self = static_cast<AcquisitionServiceImpl*>(param);
+
+    // Anchor the grid on a tick edge (ticks are ms: configTICK_RATE_HZ 1000)
+    TickType_t wake = xTaskGetTickCount();
+    vTaskDelayUntil(&wake, 1);
+    self->mSchedule.start(wake);
+    TickType_t lastStats = wake;
+
+    while (self->mRunning) {
+        TickType_t now = xTaskGetTickCount();
+        self->mSchedule.runDue(now);
+
+        if (now - lastStats >= pdMS_TO_TICKS(STATS_INTERVAL_MS)) {
+            lastStats = now;
+            self->mSchedule.collect(self->mStats, now);
+            self->mStats.updateTimestamp();
+            self->mStatsObs.publish(&self->mStats);
+        }
+
+        // Sleep to the earliest release; the stats window bounds the wait
+        uint32_t next = self->mSchedule.nextDueMs(now, STATS_INTERVAL_MS);
+        uint32_t statsDue = lastStats + pdMS_TO_TICKS(STATS_INTERVAL_MS);
+        if ((int32_t)(statsDue - next) < 0) next = statsDue;
+        now = xTaskGetTickCount();
+        if ((int32_t)(next - now) > 0) {
+            wake = now;
+            vTaskDelayUntil(&wake, next - now);
+        }
+    }
+
+    self->mSchedule.stop();
+    vTaskDelete(0);
+}
+
+} // namespace acquisition
+} // namespace arcana
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "AcquisitionService.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+
+namespace arcana {
+namespace acquisition {
+
+class AcquisitionServiceImpl : public AcquisitionService {
+public:
+    static AcquisitionService& getInstance();
+
+    ServiceStatus initHAL() override;
+    ServiceStatus init() override;
+    ServiceStatus start() override;
+    void stop() override;
+
+    bool addPlan(const AcqPlan& plan) override;
+
+private:
+    /* Test access — host gtest fixture drives the static acqTask. */
+    friend struct AcquisitionServiceTestAccess;
+
+    AcquisitionServiceImpl();
+    ~AcquisitionServiceImpl();
+    AcquisitionServiceImpl(const AcquisitionServiceImpl&);
+    AcquisitionServiceImpl& operator=(const AcquisitionServiceImpl&);
+
+    static void acqTask(void* param);
+    /** DWT cycle counter widened to a free-running 32-bit µs clock */
+    static uint32_t cycleClockUs();
+
+    static const uint32_t STATS_INTERVAL_MS = 1000;
+    // Replaces the sensor and light tasks (256 words each); the FIFO burst
+    // and the I2C DMA wait are the deepest paths
+    static const uint16_t TASK_STACK_SIZE = 320;
+
+    AcquisitionSchedule mSchedule;
+    Observable<AcquisitionStatsModel> mStatsObs;
+    AcquisitionStatsModel mStats;
+
+    StaticTask_t mTaskBuffer;
+    StackType_t mTaskStack[TASK_STACK_SIZE];
+    TaskHandle_t mTaskHandle;
+    bool mRunning;
+};
+
+} // namespace acquisition
+} // namespace arcana
@@ -90,6 +90,7 @@ AtsStorageServiceImpl::AtsStorageServiceImpl()
     : mDb()
     , mFilePort()
     , mMutex()
+    , mCacheMutex()
     , mCipher()
     , mTaskBuffer()
     , mTaskStack{}
@@ -100,7 +101,9 @@ AtsStorageServiceImpl::AtsStorageServiceImpl()
     , mFormatRequested(false)
     , mUploadPause(false)
     , mUploadRequested(false)
-    , mPendingData()
+    , mPostedCursorFileId(0)
+    , mPostedCursor()
+    , mCursorPosted(false)
     , mWriteSemBuffer()
     , mWriteSem(0)
     , mStatsObs("AtsStorage Stats")
@@ -134,6 +137,7 @@ ServiceStatus AtsStorageServiceImpl::init() {
     if (!mWriteSem) return ServiceStatus::Error;
 
     mMutex.init();
+    mCacheMutex.init();
 
     return ServiceStatus::OK;
 }
@@ -163,7 +167,7 @@ void AtsStorageServiceImpl::stop() {
 
 void AtsStorageServiceImpl::onSensorData(SensorDataModel* model, void* context) {
     AtsStorageServiceImpl* self = static_cast<AtsStorageServiceImpl*>(context);
-    self->mPendingData = *model;
+    (void)model;    // already in the TelemetryPipeline slot
     xSemaphoreGive(self->mWriteSem);
 }
 
@@ -352,6 +356,7 @@ void AtsStorageServiceImpl::storageTask(void* param) {
             self->mDbReady = false;
         }
         if (self->mDeviceDbReady) {
+            if (self->mCursorPosted) self->savePostedMqttCursor();
             self->writeLifecycleEvent(
                 static_cast<uint8_t>(ats::LifecycleEventType::PowerOff), 0);
             self->mDeviceDb.close();
@@ -493,7 +498,9 @@ bool AtsStorageServiceImpl::openDailyDb() {
 
     if (!mDb.open("sensor.ats", cfg)) {
         LOG_W(ats::ErrorSource::Tsdb, evt::ATS_DB_OPEN_FAIL);
+        mMutex.lock();
         f_unlink("sensor.ats");
+        mMutex.unlock();
         if (!mDb.open("sensor.ats", cfg)) {
             LOG_E(ats::ErrorSource::Tsdb, evt::ATS_DB_OPEN_FAIL);
             return false;
@@ -546,7 +553,11 @@ void AtsStorageServiceImpl::rotateDailyDb(uint32_t lastDay) {
     char oldName[] = "sensor.ats";
     char newName[16];
     snprintf(newName, sizeof(newName), "%08lu.ats", (unsigned long)lastDay);
+    // FatFs is not reentrant: the DB mutex also covers the directory
+    // update against readers (MQTT replay, record streaming) in other tasks
+    mMutex.lock();
     f_rename(oldName, newName);
+    mMutex.unlock();
 
     // Open fresh DB
     if (!openDailyDb()) {
@@ -565,6 +576,8 @@ bool AtsStorageServiceImpl::initDeviceDbChannels() {
     mDeviceDb.addChannel(1, cfgSchema);
     ats::ArcanaTsSchema creds = ats::ArcanaTsSchema::credentials();
     mDeviceDb.addChannel(2, creds);
+    ats::ArcanaTsSchema cursor = ats::ArcanaTsSchema::mqttCursor();
+    mDeviceDb.addChannel(3, cursor);
     return mDeviceDb.start();
 }
 
@@ -572,9 +585,10 @@ bool AtsStorageServiceImpl::openDeviceDbSafe(const ats::AtsConfig& cfg) {
     // Attempt 1: open existing
     if (mDeviceDb.open("device.ats", cfg)) {
         // Live upgrade: add missing channels (OTA)
-        if (mDeviceDb.getChannelCount() > 0 && mDeviceDb.getChannelCount() < 3) {
+        if (mDeviceDb.getChannelCount() > 0 && mDeviceDb.getChannelCount() < 4) {
             ats::ArcanaTsSchema creds = ats::ArcanaTsSchema::credentials();
-            if (mDeviceDb.addChannelLive(2, creds)) {
+            ats::ArcanaTsSchema cursor = ats::ArcanaTsSchema::mqttCursor();
+            if (mDeviceDb.addChannelLive(2, creds) && mDeviceDb.addChannelLive(3, cursor)) {
                 LOG_I(ats::ErrorSource::Tsdb, evt::ATS_DEVICE_UPGRADE);
             }
         }
@@ -899,6 +913,55 @@ bool AtsStorageServiceImpl::saveCredentials(const uint8_t* data, uint16_t len) {
     return true;
 }
 
+bool AtsStorageServiceImpl::loadMqttCursor(uint32_t& fileId, ats::AtsCursor& cursor) {
+    if (!mDeviceDbReady || mDeviceDb.getChannelCount() < 4) return false;
+
+    // MQTT_CURSOR record: [ts:4][fileId:4][block:4][rec:2][rsv:2] = 16 bytes
+    uint8_t rec[16];
+    if (mDeviceDb.queryLatest(3, rec, 1) == 0) return false;
+    memcpy(&fileId, rec + 4, 4);
+    memcpy(&cursor.block, rec + 8, 4);
+    memcpy(&cursor.record, rec + 12, 2);
+    return true;
+}
+
+bool AtsStorageServiceImpl::saveMqttCursor(uint32_t fileId, const ats::AtsCursor& cursor) {
+    if (!mDeviceDbReady || mDeviceDb.getChannelCount() < 4) return false;
+
+    // 16-byte MQTT_CURSOR record — see loadMqttCursor() for layout.
+    // Every save is a 4KB partial block: callers rate-limit.
+    uint8_t rec[16];
+    memset(rec, 0, sizeof(rec));
+    uint32_t ts = atsGetTime();
+    memcpy(rec, &ts, 4);
+    memcpy(rec + 4, &fileId, 4);
+    memcpy(rec + 8, &cursor.block, 4);
+    memcpy(rec + 12, &cursor.record, 2);
+    if (!mDeviceDb.append(3, rec)) return false;
+    return mDeviceDb.flush();
+}
+
+bool AtsStorageServiceImpl::postMqttCursor(uint32_t fileId, const ats::AtsCursor& cursor) {
+    if (!mDeviceDbReady || mDeviceDb.getChannelCount() < 4) return false;
+    taskENTER_CRITICAL();
+    mPostedCursorFileId = fileId;
+    mPostedCursor = cursor;
+    mCursorPosted = true;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+void AtsStorageServiceImpl::savePostedMqttCursor() {
+    taskENTER_CRITICAL();
+    uint32_t fileId = mPostedCursorFileId;
+    ats::AtsCursor cursor = mPostedCursor;
+    mCursorPosted = false;
+    taskEXIT_CRITICAL();
+    if (!saveMqttCursor(fileId, cursor)) {
+        LOG_W(ats::ErrorSource::Tsdb, evt::ATS_FLUSH_FAIL, cursor.block);
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Schema upgrade after OTA — add missing channels to existing .ats
 // ---------------------------------------------------------------------------
@@ -944,6 +1007,9 @@ void AtsStorageServiceImpl::taskLoop() {
             log::Logger::getInstance().drain(1);
         }
 
+        // device.ats is written from this task only (FatFs is not reentrant)
+        if (mCursorPosted) savePostedMqttCursor();
+
         if (!mDbReady) {
             // DB failed (e.g. rotation error) — retry every 5 seconds
             static uint32_t retryTick = 0;
@@ -965,8 +1031,9 @@ void AtsStorageServiceImpl::taskLoop() {
         uint8_t ecgVal = ECG_LUT[ecgPhase % ECG_LUT_LEN];
         ecgPhase++;
 
-        // Push ECG sample via callback (250Hz, thread-safe, decoupled from View)
-        if ((mTotalRecords & 3) == 0 && mEcgCallback) {
+        // Push every ECG sample via callback (ECG_SAMPLE_HZ, thread-safe,
+        // decoupled from View) — the view folds them into sweep columns
+        if (mEcgCallback) {
             mEcgCallback(ecgVal);
         }
 
@@ -1054,11 +1121,11 @@ void AtsStorageServiceImpl::taskLoop() {
     }
 }
 
-void AtsStorageServiceImpl::appendRecord(const SensorDataModel* model) {
+void AtsStorageServiceImpl::appendRecord(const TelemetrySample& sample) {
     if (!mDbReady) return;
 
     uint8_t rec[RECORD_SIZE];
-    serializeRecord(model, rec);
+    serializeRecord(sample, rec);
 
     if (mDb.append(0, rec)) {
         mTotalRecords++;
@@ -1088,18 +1155,18 @@ void AtsStorageServiceImpl::appendRecord(const SensorDataModel* model) {
     }
 }
 
-void AtsStorageServiceImpl::serializeRecord(const SensorDataModel* model, uint8_t* buf) {
+void AtsStorageServiceImpl::serializeRecord(const TelemetrySample& sample, uint8_t* buf) {
     // ts: U32 (epoch seconds)
     uint32_t ts = atsGetTime();
     memcpy(buf, &ts, 4);
 
     // temp: F32
-    memcpy(buf + 4, &model->temperature, 4);
+    memcpy(buf + 4, &sample.temperature, 4);
 
     // ax, ay, az: I16 each
-    memcpy(buf + 8,  &model->accelX, 2);
-    memcpy(buf + 10, &model->accelY, 2);
-    memcpy(buf + 12, &model->accelZ, 2);
+    memcpy(buf + 8,  &sample.ax, 2);
+    memcpy(buf + 10, &sample.ay, 2);
+    memcpy(buf + 12, &sample.az, 2);
 }
 
 uint16_t AtsStorageServiceImpl::queryByDate(uint32_t dateYYYYMMDD,
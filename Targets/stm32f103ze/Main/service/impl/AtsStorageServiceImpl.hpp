@@ -6,6 +6,7 @@
 #include "FreeRtosMutex.hpp"
 #include "ChaCha20Cipher.hpp"
 #include "ChaCha20.hpp"
+#include "TelemetryPipeline.hpp"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
@@ -37,6 +38,8 @@ public:
 
     /** Register ECG sample callback (called from Controller wiring) */
     void setEcgCallback(EcgSampleCallback cb) { mEcgCallback = cb; }
+    /** ECG callback rate: one sample per record, 1 ms task period */
+    static const uint16_t ECG_SAMPLE_HZ = 1000;
 
     uint16_t queryByDate(uint32_t dateYYYYMMDD,
                          SensorDataModel* out, uint16_t maxCount) override;
@@ -61,9 +64,20 @@ public:
     /** Shared 4KB read cache — for upload file streaming */
     static uint8_t* getReadCache() { return sReadCache; }
 
+    /** Own the read cache while an upload borrows it. Not the DB mutex:
+     *  the upload pump still publishes samples, which reads the DB head.
+     *  Record streaming takes readCacheLock() around its queries; the
+     *  storage task is paused for the upload. */
+    void lockReadCache()   { mCacheMutex.lock(); }
+    void unlockReadCache() { mCacheMutex.unlock(); }
+    ats::IMutex& readCacheLock() { return mCacheMutex; }
+
     /** True when DB is open and recording (boot complete) */
     bool isReady() const { return mDbReady; }
 
+    /** Today's sensor DB — read-only queries (record streaming) */
+    const ats::ArcanaTsDb& getSensorDb() const { return mDb; }
+
     /** Cooperative pause/resume — ATS task yields cleanly between writes */
     void pauseRecording()  { mUploadPause = true; }
     void resumeRecording() { mUploadPause = false; }
@@ -91,7 +105,7 @@ private:
     // Dedicated task
     static void storageTask(void* param);
     void taskLoop();
-    void appendRecord(const SensorDataModel* model);
+    void appendRecord(const TelemetrySample& sample);
 
     // Daily rotation
     bool openDailyDb();
@@ -99,7 +113,7 @@ private:
 
     // Record serialization (matches MPU6050 schema: ts,temp,ax,ay,az = 14 bytes)
     static const uint16_t RECORD_SIZE = 14;
-    void serializeRecord(const SensorDataModel* model, uint8_t* buf);
+    void serializeRecord(const TelemetrySample& sample, uint8_t* buf);
 
     void publishStats();
 
@@ -107,6 +121,7 @@ private:
     ats::ArcanaTsDb mDb;
     ats::FatFsFilePort mFilePort;
     ats::FreeRtosMutex mMutex;
+    ats::FreeRtosMutex mCacheMutex;    // sReadCache owner, taken before mMutex
     ats::ChaCha20Cipher mCipher;
 
     // ArcanaTS device DB (permanent, never rotated)
@@ -120,6 +135,7 @@ private:
     void writeRecoveryEvents(uint32_t recoveredRec, uint16_t truncations,
                              uint16_t skippedBlocks);
     void upgradeSensorChannels();
+    void savePostedMqttCursor();
 
 public:
     // Timezone config — stored in device.ats CONFIG channel (ch1)
@@ -130,6 +146,18 @@ public:
     bool loadCredentials(uint8_t* outBuf, uint16_t bufSize, uint16_t& outLen);
     bool saveCredentials(const uint8_t* data, uint16_t len);
 
+    // MQTT backfill cursor — stored in device.ats MQTT_CURSOR channel (ch3)
+    bool loadMqttCursor(uint32_t& fileId, ats::AtsCursor& cursor);
+    bool saveMqttCursor(uint32_t fileId, const ats::AtsCursor& cursor);
+
+    /**
+     * Hand a cursor to the storage task, which saves it on its next pass
+     * (after the upload, if one is running). Callable from any task; a
+     * newer post replaces one not saved yet.
+     * @return false if device.ats is not available
+     */
+    bool postMqttCursor(uint32_t fileId, const ats::AtsCursor& cursor);
+
 private:
 
     // Buffers (static, no heap)
@@ -153,8 +181,12 @@ private:
     EcgSampleCallback mEcgCallback = nullptr;
     volatile bool mUploadRequested;
 
-    // Pending write data
-    SensorDataModel mPendingData;
+    // MQTT cursor posted by the MQTT task, saved by the storage task
+    uint32_t mPostedCursorFileId;
+    ats::AtsCursor mPostedCursor;
+    volatile bool mCursorPosted;
+
+    // New sample in the TelemetryPipeline slot
     StaticSemaphore_t mWriteSemBuffer;
     SemaphoreHandle_t mWriteSem;
 
@@ -1,6 +1,6 @@
 #include "BleServiceImpl.hpp"
 #include "CommandBridge.hpp"
-#include "ChaCha20.hpp"
+#include "TelemetryPipeline.hpp"
 #include "RegistrationServiceImpl.hpp"
 #include "Log.hpp"
 #include "EventCodes.hpp"
@@ -19,8 +19,7 @@ BleServiceImpl::BleServiceImpl()
     , mTaskStack{}
     , mTaskHandle(0)
     , mRunning(false)
-    , mTemp(0), mAx(0), mAy(0), mAz(0)
-    , mAls(0), mPs(0), mSensorDirty(false)
+    , mSensorDirty(false)
     , mBle(Hc08Ble::getInstance())
 {
 }
@@ -118,10 +117,6 @@ void BleServiceImpl::taskLoop() {
 
 void BleServiceImpl::onSensorData(SensorDataModel* model, void* ctx) {
     BleServiceImpl* self = static_cast<BleServiceImpl*>(ctx);
-    self->mTemp = model->temperature;
-    self->mAx = model->accelX;
-    self->mAy = model->accelY;
-    self->mAz = model->accelZ;
     self->mSensorDirty = true;
 
     // Update shared sensor cache for commands
@@ -134,8 +129,6 @@ void BleServiceImpl::onSensorData(SensorDataModel* model, void* ctx) {
 
 void BleServiceImpl::onLightData(LightDataModel* model, void* ctx) {
     BleServiceImpl* self = static_cast<BleServiceImpl*>(ctx);
-    self->mAls = model->ambientLight;
-    self->mPs  = model->proximity;
     self->mSensorDirty = true;
 
     // Update shared sensor cache for commands
@@ -145,16 +138,19 @@ void BleServiceImpl::onLightData(LightDataModel* model, void* ctx) {
 }
 
 void BleServiceImpl::pushSensorJson() {
+    TelemetrySample sample;
+    TelemetryPipeline::getInstance().latest(sample);
+
     char json[96];
-    int whole = (int)mTemp;
-    int frac = (int)((mTemp - whole) * 10);
+    int whole = (int)sample.temperature;
+    int frac = (int)((sample.temperature - whole) * 10);
     if (frac < 0) frac = -frac;
 
     int n = snprintf(json, sizeof(json),
         "{\"t\":%d.%d,\"ax\":%d,\"ay\":%d,\"az\":%d,\"als\":%u,\"ps\":%u}\n",
         whole, frac,
-        (int)mAx, (int)mAy, (int)mAz,
-        (unsigned)mAls, (unsigned)mPs);
+        (int)sample.ax, (int)sample.ay, (int)sample.az,
+        (unsigned)sample.als, (unsigned)sample.ps);
 
     if (n > 0) {
         mBle.send((const uint8_t*)json, (uint16_t)n);
@@ -162,65 +158,25 @@ void BleServiceImpl::pushSensorJson() {
 }
 
 // ---------------------------------------------------------------------------
-// Encrypted sensor push — ChaCha20 + FrameCodec (same format as MQTT)
-// No ARCANA_CMD_CRYPTO dependency — uses ChaCha20 (software, zero extra RAM)
+// Encrypted sensor push — same SID 0x20 frame as MQTT, sealed by
+// TelemetryPipeline (reuses the MQTT ciphertext when the keys match)
 // ---------------------------------------------------------------------------
 
-static uint16_t bleVarInt(uint8_t* buf, uint32_t val) {
-    uint16_t n = 0;
-    while (val > 0x7F) { buf[n++] = (uint8_t)(val | 0x80); val >>= 7; }
-    buf[n++] = (uint8_t)val;
-    return n;
-}
-
-static uint16_t blePbSint32(uint8_t* buf, uint8_t fieldNum, int32_t val) {
-    buf[0] = (fieldNum << 3);
-    uint32_t zz = (uint32_t)((val << 1) ^ (val >> 31));
-    return 1 + bleVarInt(buf + 1, zz);
-}
-
-static uint16_t blePbUint32(uint8_t* buf, uint8_t fieldNum, uint32_t val) {
-    buf[0] = (fieldNum << 3);
-    return 1 + bleVarInt(buf + 1, val);
-}
-
 void BleServiceImpl::pushSensorEncrypted() {
     // Same key as MQTT: comm_key (ECDH-derived) or device_key (fallback)
     auto& regSvc = reg::RegistrationServiceImpl::getInstance();
-    const uint8_t* key = regSvc.getCommKey();
-
-    // 1. Encode protobuf (~20-30 bytes) — identical to MQTT
-    uint8_t pb[40];
-    uint16_t pos = 0;
-    pos += blePbSint32(pb + pos, 1, (int32_t)(mTemp * 10));
-    pos += blePbSint32(pb + pos, 2, (int32_t)mAx);
-    pos += blePbSint32(pb + pos, 3, (int32_t)mAy);
-    pos += blePbSint32(pb + pos, 4, (int32_t)mAz);
-    pos += blePbUint32(pb + pos, 5, (uint32_t)mAls);
-    pos += blePbUint32(pb + pos, 6, (uint32_t)mPs);
-
-    // 2. Nonce: [tick:4][0:8] — same as MQTT
-    uint8_t nonce[12] = {};
-    uint32_t tick = xTaskGetTickCount();
-    memcpy(nonce, &tick, 4);
-
-    // 3. ChaCha20 encrypt in-place
-    crypto::ChaCha20::crypt(key, nonce, 0, pb, pos);
-
-    // 4. Build payload: [nonce:12][encrypted_pb:N]
-    uint8_t enc[52];
-    memcpy(enc, nonce, 12);
-    memcpy(enc + 12, pb, pos);
-
-    // 5. FrameCodec wrap (streamId 0x20 = sensor stream)
-    uint8_t frame[72];
-    size_t frameLen = 0;
-    if (!FrameCodec::frame(enc, 12 + pos, FrameCodec::kFlagFin, 0x20,
-                            frame, sizeof(frame), frameLen)) {
+    auto& pipeline = TelemetryPipeline::getInstance();
+
+    TelemetrySample sample;
+    pipeline.latest(sample);
+
+    uint8_t frame[TelemetryPipeline::MAX_FRAME];
+    uint16_t frameLen = 0;
+    if (!pipeline.seal(sample, regSvc.getCommKey(), frame, sizeof(frame), frameLen)) {
         return;
     }
 
-    mBle.send(frame, (uint16_t)frameLen);
+    mBle.send(frame, frameLen);
 }
 
 } // namespace ble
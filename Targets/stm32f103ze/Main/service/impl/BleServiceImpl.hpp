@@ -51,10 +51,7 @@ private:
     TaskHandle_t mTaskHandle;
     bool mRunning;
 
-    // Cached latest readings (for JSON push)
-    float mTemp;
-    int16_t mAx, mAy, mAz;
-    uint16_t mAls, mPs;
+    // New reading in the TelemetryPipeline slot
     volatile bool mSensorDirty;
 
     // Reference to BLE driver
@@ -1,13 +1,16 @@
 #include "CommandBridge.hpp"
 #include "FrameCodec.hpp"
+#include "BatchCodec.hpp"
+#include "StreamCodec.hpp"
 #include "Crc16.hpp"
 #include "ChaCha20.hpp"
+#include "ChaCha20Poly1305.hpp"
 #include "Sha256.hpp"
 #include "stm32f1xx_hal.h"
 #include "Commands.hpp"
 #include "Log.hpp"
 #include "EventCodes.hpp"
-#include "uECC.h"
+#include "P256.hpp"
 #include <cstring>
 
 // DeviceKey needs UID_BASE from the HAL header above
@@ -21,9 +24,9 @@ namespace arcana {
 
 class PingCommand : public ICommand {
 public:
-    CommandKey getKey() const override {
-        return { Cluster::System, SystemCommand::Ping };
-    }
+    static constexpr CommandKey kKey = { Cluster::System, SystemCommand::Ping };
+
+    CommandKey getKey() const override { return kKey; }
     void execute(const CommandRequest& req, CommandResponseModel& rsp) override {
         (void)req;
         uint32_t tick = xTaskGetTickCount();
@@ -41,8 +44,21 @@ static GetTemperatureCommand    sTempCmd;
 static GetAccelCommand          sAccelCmd;
 static GetLightCommand          sLightCmd;
 
+// Built-in dispatch table — folded at compile time, duplicate keys fail the build
+static constexpr CommandEntry kBuiltinCommands[] = {
+    commandEntry(sPingCmd),
+    commandEntry(sFwVerCmd),
+    commandEntry(sCompileCmd),
+    commandEntry(sModelCmd),
+    commandEntry(sSerialCmd),
+    commandEntry(sTempCmd),
+    commandEntry(sAccelCmd),
+    commandEntry(sLightCmd),
+};
+static constexpr auto kBuiltinTable = makeCommandTable<kBuiltinCommands>();
+
 // ---------------------------------------------------------------------------
-// ChaCha20 CSPRNG for uECC (same as RegistrationServiceImpl)
+// ChaCha20 CSPRNG for P-256 (same as RegistrationServiceImpl)
 // ---------------------------------------------------------------------------
 
 static int ueccRng(uint8_t* dest, unsigned size) {
@@ -73,7 +89,8 @@ static int ueccRng(uint8_t* dest, unsigned size) {
 // ---------------------------------------------------------------------------
 
 CommandBridge::CommandBridge()
-    : mCommands{}
+    : mBuiltins(kBuiltinTable.view())
+    , mCommands{}
     , mCommandCount(0)
     , mSensorCache()
     , mRxQueue(0)
@@ -81,26 +98,27 @@ CommandBridge::CommandBridge()
     , mRxQueueStorage{}
     , mSessions{}
     , mDeviceKey{}
+    , mTicketEpoch(0)
+    , mTicketSerial(0)
+    , mResumedSerial{}
+    , mStream()
+    , mStreamSource(CmdFrameItem::BLE)
+    , mStreamEncrypted(false)
+    , mNextXferId(0)
+    , mRxSource(CmdFrameItem::BLE)
+    , mRxEncrypted(false)
     , mBridgeTaskBuf()
     , mBridgeStack{}
+    , mStackFree(BRIDGE_STACK_SIZE)
     , mBleSend(nullptr)
     , mBleCtx(nullptr)
     , mMqttSend(nullptr)
     , mMqttCtx(nullptr)
 {
-    // Register all commands
-    registerCommand(&sPingCmd);
-    registerCommand(&sFwVerCmd);
-    registerCommand(&sCompileCmd);
-    registerCommand(&sModelCmd);
-    registerCommand(&sSerialCmd);
-
+    // Built-in commands live in kBuiltinTable; wire the sensor cache
     sTempCmd.cache  = &mSensorCache;
     sAccelCmd.cache = &mSensorCache;
     sLightCmd.cache = &mSensorCache;
-    registerCommand(&sTempCmd);
-    registerCommand(&sAccelCmd);
-    registerCommand(&sLightCmd);
 
     // Create RX queue
     mRxQueue = xQueueCreateStatic(RX_QUEUE_LEN, sizeof(CmdFrameItem),
@@ -109,7 +127,7 @@ CommandBridge::CommandBridge()
     // Derive device key for key exchange auth
     crypto::DeviceKey::deriveKey(mDeviceKey);
 
-    LOG_I(ats::ErrorSource::Cmd, evt::CMD_REGISTERED, (uint32_t)mCommandCount);
+    LOG_I(ats::ErrorSource::Cmd, evt::CMD_REGISTERED, (uint32_t)getCommandCount());
 }
 
 CommandBridge& CommandBridge::getInstance() {
@@ -118,14 +136,18 @@ CommandBridge& CommandBridge::getInstance() {
 }
 
 bool CommandBridge::registerCommand(ICommand* cmd) {
-    if (mCommandCount >= MAX_COMMANDS) return false;
-    mCommands[mCommandCount++] = cmd;
+    if (!cmd || mCommandCount >= MAX_EXTRA_COMMANDS) return false;
+    CommandKey key = cmd->getKey();
+    if (findCommand(key)) return false;
+    mCommands[mCommandCount++] = { key, cmd };
     return true;
 }
 
 ICommand* CommandBridge::findCommand(CommandKey key) {
+    ICommand* cmd = mBuiltins.find(key);
+    if (cmd) return cmd;
     for (uint8_t i = 0; i < mCommandCount; i++) {
-        if (mCommands[i]->getKey() == key) return mCommands[i];
+        if (mCommands[i].key == key) return mCommands[i].command;
     }
     return nullptr;
 }
@@ -150,17 +172,17 @@ bool CommandBridge::submitFrame(const uint8_t* data, uint16_t len,
 // ---------------------------------------------------------------------------
 
 bool CommandBridge::handleKeyExchange(uint8_t source, const uint8_t* clientPub,
-                                       uint8_t* serverPub, uint8_t* authTag) {
-    const uECC_Curve_t* curve = uECC_secp256r1();
-    uECC_set_rng(ueccRng);
+                                       uint8_t* serverPub, uint8_t* authTag,
+                                       const uint8_t* offer, uint8_t* chosen) {
+    crypto::P256::setRng(ueccRng);
 
-    // Generate server ephemeral keypair
-    uint8_t serverPriv[32];
-    if (!uECC_make_key(serverPub, serverPriv, curve)) return false;
+    // Generate server ephemeral keypair (fixed-base comb)
+    uint8_t serverPriv[crypto::P256::PRIV_SIZE];
+    if (!crypto::P256::makeKey(serverPub, serverPriv)) return false;
 
-    // ECDH shared secret
-    uint8_t shared[32];
-    if (!uECC_shared_secret(clientPub, serverPriv, shared, curve)) return false;
+    // ECDH shared secret (rejects points off the curve)
+    uint8_t shared[crypto::P256::SECRET_SIZE];
+    if (!crypto::P256::sharedSecret(clientPub, serverPriv, shared)) return false;
 
     // Session key = HKDF-SHA256(shared, device_key, "ARCANA-SESSION")
     uint8_t sessionKey[32];
@@ -168,18 +190,24 @@ bool CommandBridge::handleKeyExchange(uint8_t source, const uint8_t* clientPub,
                           (const uint8_t*)"ARCANA-SESSION", 14,
                           sessionKey, 32);
 
-    // Auth tag = HMAC-SHA256(device_key, serverPub || clientPub)
-    uint8_t authData[128];
+    // Suite: AEAD if offered, otherwise the legacy HMAC construction
+    uint8_t suite = (offer && (*offer & SUITE_AEAD)) ? SUITE_AEAD : SUITE_HMAC;
+    if (chosen) *chosen = suite;
+
+    // Auth tag = HMAC-SHA256(device_key, serverPub || clientPub [|| offer || suite])
+    uint8_t authData[130];
     memcpy(authData, serverPub, 64);
     memcpy(authData + 64, clientPub, 64);
-    crypto::Sha256::hmac(mDeviceKey, 32, authData, 128, authTag);
+    size_t authLen = 128;
+    if (offer) {
+        authData[authLen++] = *offer;
+        authData[authLen++] = suite;
+    }
+    crypto::Sha256::hmac(mDeviceKey, 32, authData, authLen, authTag);
 
     // Install session
     uint8_t idx = source & 1;
-    memcpy(mSessions[idx].key, sessionKey, 32);
-    mSessions[idx].txCounter = 0;
-    mSessions[idx].rxCounter = 0;
-    mSessions[idx].active = true;
+    mSessions[idx].install(sessionKey, suite);
 
     // Clear ephemeral private key (PFS)
     memset(serverPriv, 0, sizeof(serverPriv));
@@ -188,10 +216,98 @@ bool CommandBridge::handleKeyExchange(uint8_t source, const uint8_t* clientPub,
     return true;
 }
 
+// Ticket key = HMAC(device_key, "ARCANA-TICKET" || epoch); a new epoch each boot
+void CommandBridge::ticketKey(uint8_t* key) {
+    if (mTicketEpoch == 0) {
+        ueccRng(reinterpret_cast<uint8_t*>(&mTicketEpoch), sizeof(mTicketEpoch));
+        if (mTicketEpoch == 0) mTicketEpoch = 1;
+    }
+    uint8_t info[13 + 4];
+    memcpy(info, "ARCANA-TICKET", 13);
+    memcpy(info + 13, &mTicketEpoch, 4);
+    crypto::Sha256::hmac(mDeviceKey, 32, info, sizeof(info), key);
+}
+
+bool CommandBridge::issueTicket(uint8_t source, uint8_t* ticket) {
+    uint8_t idx = source & 1;
+    ChaChaSession& sess = mSessions[idx];
+    if (!sess.active) return false;
+
+    uint32_t serial = ++mTicketSerial;
+    uint32_t tick = xTaskGetTickCount();
+    memcpy(ticket, &serial, 4);
+    memcpy(ticket + 4, &tick, 4);
+
+    // Resumption secret = HKDF-SHA256(session_key, serial || tick, "ARCANA-TICKET");
+    // the client derives the same value from its copy of the session key
+    uint8_t* body = ticket + 8;
+    crypto::Sha256::hkdf(sess.key, 32, ticket, 8,
+                          (const uint8_t*)"ARCANA-TICKET", 13, body, 32);
+    body[32] = sess.suite;
+    body[33] = idx;
+
+    // Seal under the ticket key; serial || tick is the nonce and the AAD
+    uint8_t key[32];
+    uint8_t nonce[12] = {};
+    ticketKey(key);
+    memcpy(nonce, ticket, 8);
+    crypto::ChaCha20Poly1305::seal(key, nonce, ticket, 8, body, 34, body + 34);
+    memset(key, 0, sizeof(key));
+    return true;
+}
+
+bool CommandBridge::resumeSession(uint8_t source, const uint8_t* ticket,
+                                  const uint8_t* clientNonce,
+                                  uint8_t* serverNonce, uint8_t* confirm) {
+    uint8_t idx = source & 1;
+    if (mTicketEpoch == 0) return false;  // none issued since boot
+
+    // Single use per transport, same rule as the nonce counter
+    uint32_t serial, issued;
+    memcpy(&serial, ticket, 4);
+    memcpy(&issued, ticket + 4, 4);
+    if (serial <= mResumedSerial[idx]) return false;
+    if ((xTaskGetTickCount() - issued) / configTICK_RATE_HZ >= TICKET_LIFETIME_S) return false;
+
+    uint8_t body[34];
+    uint8_t key[32];
+    uint8_t nonce[12] = {};
+    memcpy(body, ticket + 8, sizeof(body));
+    memcpy(nonce, ticket, 8);
+    ticketKey(key);
+    bool ok = crypto::ChaCha20Poly1305::open(key, nonce, ticket, 8,
+                                             body, sizeof(body), ticket + 8 + 34);
+    memset(key, 0, sizeof(key));
+    if (!ok || body[33] != idx) return false;
+
+    // Session key = HKDF-SHA256(rms, clientNonce || serverNonce, "ARCANA-RESUME")
+    uint8_t salt[2 * RESUME_NONCE_SIZE];
+    ueccRng(serverNonce, RESUME_NONCE_SIZE);
+    memcpy(salt, clientNonce, RESUME_NONCE_SIZE);
+    memcpy(salt + RESUME_NONCE_SIZE, serverNonce, RESUME_NONCE_SIZE);
+    uint8_t sessionKey[32];
+    crypto::Sha256::hkdf(body, 32, salt, sizeof(salt),
+                          (const uint8_t*)"ARCANA-RESUME", 13, sessionKey, 32);
+
+    // Key confirmation: only a holder of the ticket key could produce it
+    crypto::Sha256::hmac(sessionKey, 32, salt, sizeof(salt), confirm);
+
+    mResumedSerial[idx] = serial;
+    mSessions[idx].install(sessionKey, body[32]);
+
+    memset(body, 0, sizeof(body));
+    memset(sessionKey, 0, sizeof(sessionKey));
+    return true;
+}
+
+size_t CommandBridge::cryptoOverhead(uint8_t source) const {
+    return mSessions[source & 1].suite == SUITE_AEAD ? AEAD_OVERHEAD : CRYPTO_OVERHEAD;
+}
+
 bool CommandBridge::encryptAndFrame(uint8_t source, uint8_t streamId,
                                      const uint8_t* plain, size_t plainLen,
                                      uint8_t* frameBuf, size_t frameBufSize,
-                                     size_t& frameLen) {
+                                     size_t& frameLen, uint8_t flags) {
     uint8_t idx = source & 1;
     ChaChaSession& sess = mSessions[idx];
     if (!sess.active) return false;
@@ -203,22 +319,28 @@ bool CommandBridge::encryptAndFrame(uint8_t source, uint8_t streamId,
     memcpy(nonce, &counter, 4);
     memcpy(nonce + 4, &tick, 4);
 
-    // Payload: [nonce:12][ciphertext:N][hmac:32]
-    uint8_t payload[80];
-    size_t payloadLen = 12 + plainLen + 32;
+    // Payload: [nonce:12][ciphertext:N][hmac:32] or [nonce:12][ciphertext:N][tag:16]
+    uint8_t payload[MAX_TX_FRAME - FrameCodec::kOverhead];
+    size_t payloadLen = cryptoOverhead(source) + plainLen;
     if (payloadLen > sizeof(payload)) return false;
 
     memcpy(payload, nonce, 12);
     memcpy(payload + 12, plain, plainLen);
 
-    // ChaCha20 encrypt ciphertext portion in-place
-    crypto::ChaCha20::crypt(sess.key, nonce, 0, payload + 12, plainLen);
-
-    // HMAC-SHA256 over nonce + ciphertext
-    crypto::Sha256::hmac(sess.key, 32, payload, 12 + plainLen,
-                          payload + 12 + plainLen);
+    if (sess.suite == SUITE_AEAD) {
+        // ChaCha20-Poly1305: the nonce is sent in clear and bound through the key stream
+        crypto::ChaCha20Poly1305::seal(sess.key, nonce, nullptr, 0,
+                                       payload + 12, plainLen, payload + 12 + plainLen);
+    } else {
+        // ChaCha20 encrypt ciphertext portion in-place
+        crypto::ChaCha20::crypt(sess.key, nonce, 0, payload + 12, plainLen);
+
+        // HMAC-SHA256 over nonce + ciphertext
+        crypto::HmacSha256::mac(sess.mac, payload, 12 + plainLen,
+                                payload + 12 + plainLen);
+    }
 
-    return FrameCodec::frame(payload, payloadLen, FrameCodec::kFlagFin,
+    return FrameCodec::frame(payload, payloadLen, flags,
                               streamId, frameBuf, frameBufSize, frameLen);
 }
 
@@ -229,29 +351,39 @@ bool CommandBridge::decryptAndVerify(uint8_t source,
     uint8_t idx = source & 1;
     ChaChaSession& sess = mSessions[idx];
     if (!sess.active) return false;
-    if (payloadLen < 12 + 1 + 32) return false; // nonce + min 1B cipher + hmac
+    size_t overhead = cryptoOverhead(source);
+    if (payloadLen < overhead + 1) return false; // nonce + min 1B cipher + tag
 
-    size_t cipherLen = payloadLen - 12 - 32;
+    size_t cipherLen = payloadLen - overhead;
     if (cipherLen > plainBufSize) return false;
 
     const uint8_t* nonce = payload;
     const uint8_t* cipher = payload + 12;
-    const uint8_t* hmac = payload + 12 + cipherLen;
+    const uint8_t* tag = payload + 12 + cipherLen;
 
-    // Verify HMAC-SHA256(key, nonce || ciphertext)
-    uint8_t expectedHmac[32];
-    crypto::Sha256::hmac(sess.key, 32, payload, 12 + cipherLen, expectedHmac);
-    if (memcmp(hmac, expectedHmac, 32) != 0) return false;
-
-    // Replay protection: nonce counter must increase
     uint32_t rxCounter;
     memcpy(&rxCounter, nonce, 4);
-    if (sess.rxCounter > 0 && rxCounter <= sess.rxCounter) return false;
-    sess.rxCounter = rxCounter;
 
-    // ChaCha20 decrypt
-    memcpy(plain, cipher, cipherLen);
-    crypto::ChaCha20::crypt(sess.key, nonce, 0, plain, cipherLen);
+    if (sess.suite == SUITE_AEAD) {
+        // Poly1305 verify, then decrypt into plain
+        memcpy(plain, cipher, cipherLen);
+        if (!crypto::ChaCha20Poly1305::open(sess.key, nonce, nullptr, 0,
+                                            plain, cipherLen, tag)) return false;
+        if (sess.rxCounter > 0 && rxCounter <= sess.rxCounter) return false;
+    } else {
+        // Verify HMAC-SHA256(key, nonce || ciphertext)
+        uint8_t expectedHmac[32];
+        crypto::HmacSha256::mac(sess.mac, payload, 12 + cipherLen, expectedHmac);
+        if (memcmp(tag, expectedHmac, 32) != 0) return false;
+
+        // Replay protection: nonce counter must increase
+        if (sess.rxCounter > 0 && rxCounter <= sess.rxCounter) return false;
+
+        // ChaCha20 decrypt
+        memcpy(plain, cipher, cipherLen);
+        crypto::ChaCha20::crypt(sess.key, nonce, 0, plain, cipherLen);
+    }
+    sess.rxCounter = rxCounter;
     plainLen = cipherLen;
     return true;
 }
@@ -271,8 +403,20 @@ void CommandBridge::bridgeTask(void* param) {
     LOG_I(ats::ErrorSource::Cmd, evt::CMD_BRIDGE_START);
 
     while (true) {
+        // Headroom left by the deepest frame so far — sizes BRIDGE_STACK_SIZE
+        UBaseType_t stackFree = uxTaskGetStackHighWaterMark(nullptr);
+        if (stackFree < self->mStackFree) {
+            self->mStackFree = stackFree;
+            LOG_I(ats::ErrorSource::Cmd, evt::CMD_STACK_FREE, (uint32_t)stackFree);
+        }
+
+        // Keep an active transfer's window full; poll so RTOs fire without RX
+        self->pumpStream();
+        TickType_t wait = self->mStream.running()
+            ? pdMS_TO_TICKS(STREAM_POLL_MS) : portMAX_DELAY;
+
         CmdFrameItem frame;
-        if (xQueueReceive(self->mRxQueue, &frame, portMAX_DELAY) != pdTRUE) continue;
+        if (xQueueReceive(self->mRxQueue, &frame, wait) != pdTRUE) continue;
 
         // Deframe
         const uint8_t* payload = nullptr;
@@ -285,6 +429,20 @@ void CommandBridge::bridgeTask(void* param) {
             continue;
         }
 
+        // v2 batch: N requests → N responses in one frame
+        if (isBatchSid(streamId)) {
+            self->handleBatch(static_cast<uint8_t>(frame.source), streamId,
+                              payload, payloadLen);
+            continue;
+        }
+
+        // Stream transfer control: ACK / NACK / RESUME / ABORT
+        if (isStreamSid(streamId)) {
+            self->handleStreamControl(static_cast<uint8_t>(frame.source), streamId,
+                                      payload, payloadLen);
+            continue;
+        }
+
         // Decode command request
         CommandRequest req;
         bool encrypted = false;
@@ -330,42 +488,49 @@ void CommandBridge::bridgeTask(void* param) {
 
         bool isKeRequest = (req.key.cluster == Cluster::Security &&
                             req.key.commandId == SecurityCommand::KeyExchange);
+        bool isTicketRequest = (req.key.cluster == Cluster::Security &&
+                                req.key.commandId == SecurityCommand::SessionTicket);
+        bool isResumeRequest = (req.key.cluster == Cluster::Security &&
+                                req.key.commandId == SecurityCommand::ResumeSession);
 
         if (isKeRequest && req.paramsLength == 0 && payloadLen >= 3 + 64) {
             // KeyExchange: client sends 64-byte public key in params area
-            // For KE, the 64B pub key is in the payload after the 3-byte header
+            // For KE, the 64B pub key is in the payload after the 3-byte header,
+            // optionally followed by a suite offer byte
             const uint8_t* clientPub = (streamId == SID_ENCRYPTED)
                 ? nullptr  // can't KE over encrypted channel (chicken-egg)
                 : payload + 3;
 
             if (clientPub) {
+                const uint8_t* offer = payloadLen >= 3 + 64 + 1 ? payload + 3 + 64 : nullptr;
                 uint8_t serverPub[64];
                 uint8_t authTag[32];
+                uint8_t suite = SUITE_HMAC;
                 if (self->handleKeyExchange(static_cast<uint8_t>(frame.source),
-                                             clientPub, serverPub, authTag)) {
-                    // Response: [serverPub:64][authTag:32] = 96 bytes
+                                             clientPub, serverPub, authTag,
+                                             offer, &suite)) {
+                    // Response: [serverPub:64][authTag:32] = 96 bytes, + [suite:1] if offered
                     memcpy(rsp.data, serverPub, 24);  // first 24 bytes in data field
                     rsp.dataLength = 24;
                     rsp.status = CommandStatus::Success;
 
                     // KE response is special: send full 96B directly (too big for rsp.data[24])
-                    uint8_t keRsp[4 + 96]; // binary response header + KE payload
+                    uint8_t keRsp[4 + 97]; // binary response header + KE payload
+                    uint8_t keLen = offer ? 97 : 96;
                     keRsp[0] = static_cast<uint8_t>(rsp.key.cluster);
                     keRsp[1] = rsp.key.commandId;
                     keRsp[2] = static_cast<uint8_t>(CommandStatus::Success);
-                    keRsp[3] = 96;
+                    keRsp[3] = keLen;
                     memcpy(keRsp + 4, serverPub, 64);
                     memcpy(keRsp + 4 + 64, authTag, 32);
+                    keRsp[4 + 96] = suite;
 
                     uint8_t frameBuf[112];
                     size_t frameLen = 0;
-                    if (FrameCodec::frame(keRsp, 100, FrameCodec::kFlagFin,
+                    if (FrameCodec::frame(keRsp, 4 + keLen, FrameCodec::kFlagFin,
                                            streamId, frameBuf, sizeof(frameBuf), frameLen)) {
-                        if (frame.source == CmdFrameItem::BLE && self->mBleSend) {
-                            self->mBleSend(frameBuf, (uint16_t)frameLen, self->mBleCtx);
-                        } else if (frame.source == CmdFrameItem::MQTT && self->mMqttSend) {
-                            self->mMqttSend(frameBuf, (uint16_t)frameLen, self->mMqttCtx);
-                        }
+                        self->sendToTransport(static_cast<uint8_t>(frame.source),
+                                              frameBuf, frameLen);
                     }
                     LOG_I(ats::ErrorSource::Cmd, 0x0B1E, (uint32_t)frame.source);
                     continue; // KE response already sent
@@ -375,23 +540,57 @@ void CommandBridge::bridgeTask(void* param) {
             } else {
                 rsp.status = CommandStatus::InvalidParam;
             }
-        } else if (encrypted && !isKeRequest) {
-            // Session gate: encrypted non-KE command requires active session
-            // (session was verified in decryptAndVerify, so we're good)
-            ICommand* cmd = self->findCommand(req.key);
-            if (cmd) {
-                cmd->execute(req, rsp);
-            } else {
-                rsp.status = CommandStatus::NotFound;
+        } else if (isResumeRequest && !encrypted && req.paramsLength == 0 &&
+                   payloadLen >= 3 + TICKET_SIZE + RESUME_NONCE_SIZE) {
+            // ResumeSession: [ticket][clientNonce] after the 3-byte header
+            // Response: [serverNonce:16][confirm:32]; on error the client runs KE
+            uint8_t rmRsp[4 + RESUME_NONCE_SIZE + 32];
+            if (self->resumeSession(static_cast<uint8_t>(frame.source), payload + 3,
+                                    payload + 3 + TICKET_SIZE,
+                                    rmRsp + 4, rmRsp + 4 + RESUME_NONCE_SIZE)) {
+                rmRsp[0] = static_cast<uint8_t>(rsp.key.cluster);
+                rmRsp[1] = rsp.key.commandId;
+                rmRsp[2] = static_cast<uint8_t>(CommandStatus::Success);
+                rmRsp[3] = RESUME_NONCE_SIZE + 32;
+
+                uint8_t frameBuf[112];
+                size_t frameLen = 0;
+                if (FrameCodec::frame(rmRsp, sizeof(rmRsp), FrameCodec::kFlagFin,
+                                       streamId, frameBuf, sizeof(frameBuf), frameLen)) {
+                    self->sendToTransport(static_cast<uint8_t>(frame.source),
+                                          frameBuf, frameLen);
+                }
+                LOG_I(ats::ErrorSource::Cmd, evt::CMD_SESSION_RESUMED, (uint32_t)frame.source);
+                continue;
             }
-        } else if (!encrypted && !isKeRequest) {
-            // Plaintext command (no session required)
-            ICommand* cmd = self->findCommand(req.key);
-            if (cmd) {
-                cmd->execute(req, rsp);
-            } else {
-                rsp.status = CommandStatus::NotFound;
+            LOG_W(ats::ErrorSource::Cmd, evt::CMD_RESUME_REJECTED, (uint32_t)frame.source);
+            rsp.status = CommandStatus::Error;
+        } else if (isTicketRequest && encrypted) {
+            // SessionTicket: [ticket:58] — larger than rsp.data, sent directly
+            uint8_t tkRsp[4 + TICKET_SIZE];
+            if (self->issueTicket(static_cast<uint8_t>(frame.source), tkRsp + 4)) {
+                tkRsp[0] = static_cast<uint8_t>(rsp.key.cluster);
+                tkRsp[1] = rsp.key.commandId;
+                tkRsp[2] = static_cast<uint8_t>(CommandStatus::Success);
+                tkRsp[3] = TICKET_SIZE;
+
+                uint8_t frameBuf[MAX_TX_FRAME];
+                size_t frameLen = 0;
+                if (self->encryptAndFrame(static_cast<uint8_t>(frame.source),
+                                          SID_ENCRYPTED, tkRsp, sizeof(tkRsp),
+                                          frameBuf, sizeof(frameBuf), frameLen)) {
+                    self->sendToTransport(static_cast<uint8_t>(frame.source),
+                                          frameBuf, frameLen);
+                }
+                continue;
             }
+            rsp.status = CommandStatus::Error;
+        } else if (!isKeRequest && !isTicketRequest && !isResumeRequest) {
+            // Encrypted commands were session-checked in decryptAndVerify;
+            // plaintext commands need no session
+            self->mRxSource = static_cast<uint8_t>(frame.source);
+            self->mRxEncrypted = encrypted;
+            self->executeCommand(req, rsp);
         } else {
             rsp.status = CommandStatus::InvalidParam;
         }
@@ -427,16 +626,186 @@ void CommandBridge::bridgeTask(void* param) {
         }
 
         // Direct send (no TX task needed)
-        if (frame.source == CmdFrameItem::BLE && self->mBleSend) {
-            self->mBleSend(frameBuf, (uint16_t)frameLen, self->mBleCtx);
-        } else if (frame.source == CmdFrameItem::MQTT && self->mMqttSend) {
-            self->mMqttSend(frameBuf, (uint16_t)frameLen, self->mMqttCtx);
-        }
+        self->sendToTransport(static_cast<uint8_t>(frame.source), frameBuf, frameLen);
 
         LOG_D(ats::ErrorSource::Cmd, evt::CMD_RSP, (uint32_t)rsp.status);
     }
 }
 
+// ---------------------------------------------------------------------------
+// Dispatch helpers shared by the v1 and v2 paths
+// ---------------------------------------------------------------------------
+
+void CommandBridge::executeCommand(const CommandRequest& req, CommandResponseModel& rsp) {
+    ICommand* cmd = findCommand(req.key);
+    if (cmd) {
+        cmd->execute(req, rsp);
+    } else {
+        rsp.status = CommandStatus::NotFound;
+    }
+}
+
+bool CommandBridge::sendToTransport(uint8_t source, const uint8_t* frame, size_t frameLen) {
+    if (source == CmdFrameItem::BLE && mBleSend) {
+        return mBleSend(frame, (uint16_t)frameLen, mBleCtx);
+    } else if (source == CmdFrameItem::MQTT && mMqttSend) {
+        return mMqttSend(frame, (uint16_t)frameLen, mMqttCtx);
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// v2 batch — one decrypt, N executes, one encrypt, one send
+// ---------------------------------------------------------------------------
+
+void CommandBridge::handleBatch(uint8_t source, uint8_t streamId,
+                                const uint8_t* payload, size_t payloadLen) {
+    bool encrypted = (streamId == SID_ENCRYPTED_BATCH);
+
+    // Encrypted body is decrypted into a local buffer; plaintext is used in place
+    uint8_t plainBuf[CmdFrameItem::MAX_DATA - FrameCodec::kOverhead - AEAD_OVERHEAD];
+    const uint8_t* body = payload;
+    size_t bodyLen = payloadLen;
+    if (encrypted) {
+        size_t plainLen = 0;
+        if (!decryptAndVerify(source, payload, payloadLen,
+                              plainBuf, sizeof(plainBuf), plainLen)) {
+            LOG_W(ats::ErrorSource::Cmd, evt::CMD_BAD_FRAME, 0xDE);
+            return;
+        }
+        body = plainBuf;
+        bodyLen = plainLen;
+    }
+
+    uint8_t count = 0;
+    size_t rdOff = 0;
+    if (!BatchCodec::beginRead(body, bodyLen, count, rdOff)) {
+        LOG_W(ats::ErrorSource::Cmd, evt::CMD_BAD_FRAME, (uint32_t)bodyLen);
+        return;
+    }
+
+    // AEAD sessions fit 16 more bytes of responses into the same frame
+    uint8_t rspBody[MAX_PLAIN_AEAD];
+    size_t rspCap = encrypted ? MAX_TX_FRAME - FrameCodec::kOverhead - cryptoOverhead(source)
+                              : MAX_PLAIN;
+    size_t wrOff = 0;
+    BatchCodec::beginWrite(rspBody, rspCap, wrOff);
+    mRxSource = source;
+    mRxEncrypted = encrypted;
+
+    for (uint8_t i = 0; i < count; i++) {
+        BatchEntry entry;
+        if (!BatchCodec::readRequest(body, bodyLen, rdOff, entry)) break;
+
+        LOG_D(ats::ErrorSource::Cmd, evt::CMD_RX,
+              ((uint32_t)entry.key.cluster << 8) | entry.key.commandId);
+
+        CommandResponseModel rsp;
+        rsp.key = entry.key;
+
+        // KE / ticket / resume stay v1 single-frame exchanges; params are
+        // capped per entry at the v1 size (BatchCodec::kMaxParams)
+        bool isSessionRequest = (entry.key.cluster == Cluster::Security);
+        if (isSessionRequest || entry.length > BatchCodec::kMaxParams) {
+            rsp.status = CommandStatus::InvalidParam;
+        } else {
+            CommandRequest req;
+            req.key = entry.key;
+            req.paramsLength = entry.length;
+            if (entry.length > 0) memcpy(req.params, entry.data, entry.length);
+            executeCommand(req, rsp);
+        }
+
+        // Response frame full — stop here; client retries the missing reqIds
+        if (!BatchCodec::writeResponse(rspBody, rspCap, wrOff,
+                                       entry.reqId, rsp)) {
+            break;
+        }
+    }
+
+    uint8_t frameBuf[MAX_TX_FRAME];
+    size_t frameLen = 0;
+    bool ok = encrypted
+        ? encryptAndFrame(source, SID_ENCRYPTED_BATCH, rspBody, wrOff,
+                          frameBuf, sizeof(frameBuf), frameLen)
+        : FrameCodec::frame(rspBody, wrOff, FrameCodec::kFlagFin, SID_BATCH,
+                            frameBuf, sizeof(frameBuf), frameLen);
+    if (!ok) return;
+
+    sendToTransport(source, frameBuf, frameLen);
+    LOG_D(ats::ErrorSource::Cmd, evt::CMD_RSP, (uint32_t)rspBody[1]);
+}
+
+// ---------------------------------------------------------------------------
+// Stream transfers — DATA out through the window, control frames in
+// ---------------------------------------------------------------------------
+
+bool CommandBridge::beginStream(IStreamSource* src, uint8_t& xferId) {
+    if (!src || mStream.running()) return false;
+    if (++mNextXferId == 0) mNextXferId = 1;
+    xferId = mNextXferId;
+    mStreamSource = mRxSource;
+    mStreamEncrypted = mRxEncrypted;
+    mStream.begin(xferId, src, xTaskGetTickCount(), pdMS_TO_TICKS(STREAM_RTO_MS));
+    return true;
+}
+
+bool CommandBridge::emitStreamData(const uint8_t* payload, size_t len,
+                                   bool fin, void* ctx) {
+    CommandBridge* self = static_cast<CommandBridge*>(ctx);
+    uint8_t frameBuf[MAX_TX_FRAME];
+    size_t frameLen = 0;
+    uint8_t flags = fin ? FrameCodec::kFlagFin : 0;
+    bool ok;
+    if (self->mStreamEncrypted) {
+        ok = self->encryptAndFrame(self->mStreamSource, SID_ENCRYPTED_STREAM,
+                                   payload, len, frameBuf, sizeof(frameBuf), frameLen,
+                                   flags);
+    } else {
+        ok = FrameCodec::frame(payload, len, flags, SID_STREAM,
+                               frameBuf, sizeof(frameBuf), frameLen);
+    }
+    return ok && self->sendToTransport(self->mStreamSource, frameBuf, frameLen);
+}
+
+void CommandBridge::pumpStream() {
+    if (!mStream.running()) return;
+    mStream.pump(xTaskGetTickCount(), emitStreamData, this);
+}
+
+void CommandBridge::handleStreamControl(uint8_t source, uint8_t streamId,
+                                        const uint8_t* payload, size_t payloadLen) {
+    bool encrypted = (streamId == SID_ENCRYPTED_STREAM);
+    // Control rides the transfer's own protection: a plaintext ACK or
+    // RESUME must not steer (or downgrade) an encrypted stream
+    if (encrypted != mStreamEncrypted) {
+        LOG_W(ats::ErrorSource::Cmd, evt::CMD_BAD_FRAME, (uint32_t)streamId);
+        return;
+    }
+    uint8_t plainBuf[StreamCodec::kAckSize];
+    const uint8_t* body = payload;
+    size_t bodyLen = payloadLen;
+    if (encrypted) {
+        size_t plainLen = 0;
+        if (!decryptAndVerify(source, payload, payloadLen,
+                              plainBuf, sizeof(plainBuf), plainLen)) {
+            LOG_W(ats::ErrorSource::Cmd, evt::CMD_BAD_FRAME, 0xDE);
+            return;
+        }
+        body = plainBuf;
+        bodyLen = plainLen;
+    }
+
+    StreamMessage msg;
+    if (!StreamCodec::parse(body, bodyLen, msg) || msg.type == StreamCodec::kData) return;
+
+    if (!mStream.onControl(msg, xTaskGetTickCount())) return;
+
+    // RESUME may arrive over the other transport after a link drop — follow
+    // it; the protection level stays the one the transfer started with
+    if (msg.type == StreamCodec::kResume) mStreamSource = source;
+}
+
 // ---------------------------------------------------------------------------
 // Legacy processFrame — direct call (kept for compatibility)
 // ---------------------------------------------------------------------------
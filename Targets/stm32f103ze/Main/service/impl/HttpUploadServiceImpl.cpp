@@ -22,11 +22,21 @@ extern "C" {
 
 namespace arcana {
 
+static_assert(UploadManifest::CHUNK_SIZE == ats::BLOCK_SIZE,
+              "manifest chunks must line up with ATS blocks");
+static_assert(UploadManifest::CHUNK_SIZE % 2048 == 0,
+              "pipeline reads must not straddle a chunk");
+static_assert(2048 <= Esp8266::LINK_SEND_MAX,
+              "a body chunk must fit one AT+CIPSEND");
+
 const char* HttpUploadServiceImpl::SERVER = UPLOAD_SERVER_VALUE;
 const uint16_t HttpUploadServiceImpl::PORT = UPLOAD_PORT_VALUE;
 
 UploadProgress g_uploadProgress = {0, 0, 0, 0};
 
+void (*HttpUploadServiceImpl::sPump)(void*) = nullptr;
+void* HttpUploadServiceImpl::sPumpCtx = nullptr;
+
 // ---------------------------------------------------------------------------
 // Upload all pending files
 // ---------------------------------------------------------------------------
@@ -72,9 +82,6 @@ uint8_t HttpUploadServiceImpl::uploadPendingFiles(Esp8266& esp) {
         return 0;
     }
 
-    // Enable IPD passthrough so +IPD stays in mRxBuf (not intercepted as MQTT)
-    esp.setIpdPassthrough(true);
-
     // Enable DMA reads — ATS paused, no writes, no direction switching
     sd_enable_dma_reads();
 
@@ -89,7 +96,10 @@ uint8_t HttpUploadServiceImpl::uploadPendingFiles(Esp8266& esp) {
         g_uploadProgress.currentFile = i + 1;
         LOG_I(ats::ErrorSource::System, 0x0071, pending[i].date);  // uploading date
 
-        if (uploadFile(esp, pending[i].name, deviceId)) {
+        storage.lockReadCache();
+        bool synced = syncFile(esp, pending[i].name, deviceId);
+        storage.unlockReadCache();
+        if (synced) {
             storage.markUploaded(pending[i].date);
             uploaded++;
             LOG_I(ats::ErrorSource::System, 0x0072, pending[i].date);  // upload OK
@@ -97,12 +107,16 @@ uint8_t HttpUploadServiceImpl::uploadPendingFiles(Esp8266& esp) {
             LOG_W(ats::ErrorSource::System, 0x0073, pending[i].date);  // upload failed
             break;  // stop on first failure (connection may be broken)
         }
+        pump();
         vTaskDelay(pdMS_TO_TICKS(500));  // brief pause between files
     }
 
-    // Always upload device.ats blackbox (latest version)
+    // Always upload device.ats blackbox (latest version) — only the blocks
+    // rewritten since the last sync go over the air
     if (uploaded > 0) {
-        uploadFile(esp, "device.ats", deviceId);
+        storage.lockReadCache();
+        syncFile(esp, "device.ats", deviceId);
+        storage.unlockReadCache();
     }
 
     // Clear upload progress + dismiss toast
@@ -112,9 +126,6 @@ uint8_t HttpUploadServiceImpl::uploadPendingFiles(Esp8266& esp) {
     // Restore DMA write direction before resuming ATS recording
     sd_disable_dma_reads();
 
-    // Restore normal +IPD handling for MQTT
-    esp.setIpdPassthrough(false);
-
     // Resume ATS recording
     storage.resumeRecording();
 
@@ -144,6 +155,7 @@ bool HttpUploadServiceImpl::uploadFile(Esp8266& esp, const char* filename,
     g_uploadProgress.totalBytes = fileSize;
     g_uploadProgress.bytesSent = 0;
     g_uploadProgress.resumeOffset = 0;
+    g_uploadProgress.attempts = 0;
 
     // --- Retry loop: resume from server offset on each attempt ---
     static const int MAX_ATTEMPTS = 200;
@@ -155,11 +167,13 @@ bool HttpUploadServiceImpl::uploadFile(Esp8266& esp, const char* filename,
     int stallCount = 0;
 
     for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        g_uploadProgress.attempts = (uint16_t)(attempt + 1);
         if (attempt > 0) {
             LOG_W(ats::ErrorSource::Upload, evt::UPL_RETRY, (uint32_t)(attempt + 1));
             // Full SDIO reinit between retries
             sd_card_full_reinit();
             vTaskDelay(pdMS_TO_TICKS(3000));  // 3s recovery
+            pump();
 
             // Re-open file after SDIO reinit
             memset(&fp, 0, sizeof(FIL));
@@ -208,52 +222,15 @@ bool HttpUploadServiceImpl::uploadFile(Esp8266& esp, const char* filename,
             continue;  // retry
         }
 
-        // Enter transparent passthrough mode
-        if (!esp.sendCmd("AT+CIPMODE=1", "OK", 2000)) {
-            LOG_W(ats::ErrorSource::Upload, evt::UPL_CIPMODE_FAIL);
+        if (!sendHttpHeader(esp, filename, deviceId, remainSize, resumeOffset, fileSize)) {
+            LOG_W(ats::ErrorSource::Upload, evt::UPL_SEND_FAIL, resumeOffset);
             sslClose(esp);
             continue;
         }
-        if (!esp.sendCmd("AT+CIPSEND", ">", 3000)) {
-            LOG_W(ats::ErrorSource::Upload, evt::UPL_TRANSPARENT_FAIL);
-            esp.sendCmd("AT+CIPMODE=0", "OK", 1000);
-            sslClose(esp);
-            continue;
-        }
-
-        // Send HTTP header (raw bytes, transparent mode)
-        {
-            auto& regSvc = reg::RegistrationServiceImpl::getInstance();
-            const char* token = regSvc.isRegistered()
-                                ? regSvc.credentials().uploadToken : "";
-            char header[448];
-            uint32_t rangeEnd = resumeOffset + remainSize - 1;
-            int hLen = snprintf(header, sizeof(header),
-                "POST /upload/%s/%s HTTP/1.1\r\n"
-                "Host: %s\r\n"
-                "Authorization: Bearer %s\r\n"
-                "Content-Length: %lu\r\n"
-                "Content-Range: bytes %lu-%lu/%lu\r\n"
-                "Content-Type: application/octet-stream\r\n"
-                "Connection: close\r\n"
-                "\r\n",
-                deviceId, filename, SERVER,
-                token,
-                (unsigned long)remainSize,
-                (unsigned long)resumeOffset, (unsigned long)rangeEnd,
-                (unsigned long)fileSize);
-            esp.sendData(reinterpret_cast<const uint8_t*>(header), hLen, 3000);
-        }
 
-        // Stream file body (transparent + DMA read)
+        // Stream file body (DMA read + DMA send)
         ok = streamFileBody(esp, &fp, remainSize);
 
-        // Exit transparent mode: 1s silence → +++ → 1s silence
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        esp.sendData(reinterpret_cast<const uint8_t*>("+++"), 3, 1000);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        esp.sendCmd("AT+CIPMODE=0", "OK", 2000);
-
         if (ok) {
             ok = waitHttpResponse(esp);
             if (!ok) LOG_W(ats::ErrorSource::System, 0x0077);
@@ -282,23 +259,296 @@ bool HttpUploadServiceImpl::uploadFile(Esp8266& esp, const char* filename,
 }
 
 // ---------------------------------------------------------------------------
-// SSL connection
+// Sync single file by manifest (only the chunks the server lacks)
 // ---------------------------------------------------------------------------
 
-bool HttpUploadServiceImpl::sslConnect(Esp8266& esp) {
-    char cmd[80];
-    snprintf(cmd, sizeof(cmd), "AT+CIPSTART=\"SSL\",\"%s\",%u", SERVER, PORT);
-    if (!esp.sendCmd(cmd, "OK", 10000)) {
-        if (!esp.responseContains("ALREADY CONNECTED")) {
+bool HttpUploadServiceImpl::syncFile(Esp8266& esp, const char* filename,
+                                     const char* deviceId) {
+    LOG_D(ats::ErrorSource::Upload, evt::UPL_FILE_OPEN);
+    FIL& fp = atsstorage::AtsStorageServiceImpl::sSharedFil;
+    memset(&fp, 0, sizeof(FIL));
+    FRESULT fr = f_open(&fp, filename, FA_READ);
+    if (fr != FR_OK) {
+        LOG_W(ats::ErrorSource::Upload, evt::UPL_FILE_OPEN_FAIL, (uint32_t)fr);
+        return false;
+    }
+
+    uint32_t fileSize = (uint32_t)f_size(&fp);
+    if (fileSize == 0) { f_close(&fp); return false; }
+
+    LOG_D(ats::ErrorSource::Upload, evt::UPL_FILE_SIZE, (uint32_t)(fileSize / 1024));
+    g_uploadProgress.totalBytes = fileSize;
+    g_uploadProgress.bytesSent = 0;
+    g_uploadProgress.resumeOffset = 0;
+    g_uploadProgress.attempts = 0;
+
+    // Each attempt re-asks the server, so a broken chunk upload resumes
+    // from whatever chunks did land
+    static const int MAX_ATTEMPTS = 20;
+    static const int MAX_STALL = 3;
+    ChunkRange missing[UploadManifest::MAX_RANGES];
+    uint32_t chunks = UploadManifest::chunkCount(fileSize);
+    uint32_t lastMissing = chunks + 1;
+    int stallCount = 0;
+    bool ok = false;
+
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+        g_uploadProgress.attempts = (uint16_t)(attempt + 1);
+        if (attempt > 0) {
+            LOG_W(ats::ErrorSource::Upload, evt::UPL_RETRY, (uint32_t)(attempt + 1));
+            sd_card_full_reinit();
+            vTaskDelay(pdMS_TO_TICKS(3000));  // 3s recovery
+            pump();
+
+            memset(&fp, 0, sizeof(FIL));
+            fr = f_open(&fp, filename, FA_READ);
+            if (fr != FR_OK) {
+                LOG_W(ats::ErrorSource::Upload, evt::UPL_REOPEN_FAIL, (uint32_t)fr);
+                break;
+            }
+        }
+
+        uint8_t count = 0;
+        ManifestResult mr = exchangeManifest(esp, &fp, filename, deviceId, fileSize,
+                                             missing, count);
+        if (mr == ManifestResult::Unsupported) {
+            LOG_I(ats::ErrorSource::Upload, evt::UPL_NO_MANIFEST);
+            f_close(&fp);
+            return uploadFile(esp, filename, deviceId);
+        }
+
+        if (mr == ManifestResult::Ok) {
+            uint32_t nMissing = UploadManifest::totalChunks(missing, count);
+            LOG_I(ats::ErrorSource::Upload, evt::UPL_CHUNKS_MISSING,
+                  (nMissing << 16) | (chunks & 0xFFFF));
+            if (count == 0) {
+                LOG_D(ats::ErrorSource::Upload, evt::UPL_ALREADY_DONE,
+                      (uint32_t)(fileSize / 1024));
+                ok = true;
+                break;
+            }
+
+            // Stall detection: give up if the gap stops shrinking
+            if (nMissing >= lastMissing) {
+                if (++stallCount >= MAX_STALL) {
+                    LOG_W(ats::ErrorSource::Upload, evt::UPL_STALLED);
+                    break;
+                }
+            } else {
+                stallCount = 0;
+            }
+            lastMissing = nMissing;
+
+            ok = sendChunks(esp, &fp, filename, deviceId, fileSize, missing, count);
+            if (ok) break;
+        } else {
+            LOG_W(ats::ErrorSource::Upload, evt::UPL_MANIFEST_FAIL, (uint32_t)(attempt + 1));
+        }
+
+        // KEY2 cancel — stop all retries
+        if (io::IoServiceImpl::getInstance().isCancelRequested()) {
+            io::IoServiceImpl::getInstance().disarmCancel();
+            break;
+        }
+
+        LOG_W(ats::ErrorSource::Upload, evt::UPL_ATTEMPT_FAIL, (uint32_t)(attempt + 1));
+        f_close(&fp);
+        memset(&fp, 0, sizeof(FIL));
+    }
+
+    f_close(&fp);
+    return ok;
+}
+
+HttpUploadServiceImpl::ManifestResult HttpUploadServiceImpl::exchangeManifest(
+        Esp8266& esp, FIL* fp, const char* filename, const char* deviceId,
+        uint32_t fileSize, ChunkRange* missing, uint8_t& count) {
+    count = 0;
+    if (!sslConnect(esp)) {
+        LOG_W(ats::ErrorSource::Upload, evt::UPL_TCP_FAIL);
+        return ManifestResult::Failed;
+    }
+
+    {
+        auto& regSvc = reg::RegistrationServiceImpl::getInstance();
+        const char* token = regSvc.isRegistered()
+                            ? regSvc.credentials().uploadToken : "";
+        char header[448];
+        int hLen = snprintf(header, sizeof(header),
+            "POST /upload/%s/%s/manifest HTTP/1.1\r\n"
+            "Host: %s\r\n"
+            "Authorization: Bearer %s\r\n"
+            "Content-Length: %lu\r\n"
+            "Content-Type: application/octet-stream\r\n"
+            "X-File-Size: %lu\r\n"
+            "X-Chunk-Size: %lu\r\n"
+            "X-Max-Ranges: %u\r\n"
+            "Connection: close\r\n"
+            "\r\n",
+            deviceId, filename, SERVER,
+            token,
+            (unsigned long)UploadManifest::manifestSize(fileSize),
+            (unsigned long)fileSize,
+            (unsigned long)UploadManifest::CHUNK_SIZE,
+            (unsigned)UploadManifest::MAX_RANGES);
+        if (!esp.linkSend(Esp8266::LINK_HTTP, reinterpret_cast<const uint8_t*>(header),
+                          (uint16_t)hLen, 5000)) {
+            sslClose(esp);
+            return ManifestResult::Failed;
+        }
+    }
+
+    fp->err = 0;
+    f_lseek(fp, 0);
+    if (!streamManifest(esp, fp, fileSize)) {
+        sslClose(esp);
+        return ManifestResult::Failed;
+    }
+
+    const char* resp;
+    uint16_t respLen;
+    if (!recvResponse(esp, "\"missing\"", 10000, resp, respLen)) {
+        // An older server routes /manifest nowhere
+        bool unsupported = strstr(resp, " 404") || strstr(resp, " 405");
+        sslClose(esp);
+        return unsupported ? ManifestResult::Unsupported : ManifestResult::Failed;
+    }
+
+    // "missing":"0-3,17" — parse before CIPCLOSE
+    const char* list = strstr(resp, "\"missing\":\"");
+    int n = list ? UploadManifest::parseRanges(list + 11, missing, UploadManifest::MAX_RANGES,
+                                               UploadManifest::chunkCount(fileSize))
+                 : -1;
+    sslClose(esp);
+    if (n < 0) return ManifestResult::Failed;
+    count = (uint8_t)n;
+    return ManifestResult::Ok;
+}
+
+bool HttpUploadServiceImpl::streamManifest(Esp8266& esp, FIL* fp, uint32_t fileSize) {
+    // Chunks are read in PIPE_CHUNK pieces into the first cache half and
+    // hashed; digests collect in the second half and go out in batches
+    uint8_t* cache = atsstorage::AtsStorageServiceImpl::getReadCache();
+    uint8_t* digests = cache + PIPE_CHUNK;
+    UploadChunkSizer sizer(PIPE_CHUNK);
+    UploadManifest::Hasher hasher;
+
+    uint32_t pos = 0;
+    uint16_t batched = 0;
+    while (pos < fileSize) {
+        uint32_t left = fileSize - pos;
+        UINT len = 0;
+        if (!readChunk(fp, cache, left < PIPE_CHUNK ? (uint16_t)left : PIPE_CHUNK,
+                       len, sizer)) {
+            LOG_W(ats::ErrorSource::Upload, evt::UPL_READ_FAIL, pos);
             return false;
         }
+        hasher.update(cache, len);
+        pos += len;
+
+        if (pos % UploadManifest::CHUNK_SIZE == 0 || pos == fileSize) {
+            hasher.finish(digests + batched * UploadManifest::DIGEST_SIZE);
+            batched++;
+        }
+        if (batched == DIGEST_BATCH || (pos == fileSize && batched > 0)) {
+            if (!esp.linkSend(Esp8266::LINK_HTTP, digests,
+                              (uint16_t)(batched * UploadManifest::DIGEST_SIZE), 5000)) {
+                LOG_W(ats::ErrorSource::Upload, evt::UPL_SEND_FAIL, pos);
+                return false;
+            }
+            batched = 0;
+        }
+    }
+    return true;
+}
+
+bool HttpUploadServiceImpl::sendChunks(Esp8266& esp, FIL* fp, const char* filename,
+                                       const char* deviceId, uint32_t fileSize,
+                                       const ChunkRange* ranges, uint8_t count) {
+    char list[192];
+    uint16_t listLen = UploadManifest::formatRanges(ranges, count, list, sizeof(list));
+    if (listLen == 0) return false;
+    uint32_t bodySize = UploadManifest::totalBytes(ranges, count, fileSize);
+
+    if (!sslConnect(esp)) {
+        LOG_W(ats::ErrorSource::Upload, evt::UPL_TCP_FAIL);
+        return false;
+    }
+
+    {
+        auto& regSvc = reg::RegistrationServiceImpl::getInstance();
+        const char* token = regSvc.isRegistered()
+                            ? regSvc.credentials().uploadToken : "";
+        char header[384];
+        int hLen = snprintf(header, sizeof(header),
+            "POST /upload/%s/%s/chunks HTTP/1.1\r\n"
+            "Host: %s\r\n"
+            "Authorization: Bearer %s\r\n"
+            "Content-Length: %lu\r\n"
+            "Content-Type: application/octet-stream\r\n"
+            "X-File-Size: %lu\r\n"
+            "X-Chunk-Size: %lu\r\n"
+            "Connection: close\r\n"
+            "X-Ranges: ",
+            deviceId, filename, SERVER,
+            token,
+            (unsigned long)bodySize,
+            (unsigned long)fileSize,
+            (unsigned long)UploadManifest::CHUNK_SIZE);
+        // Range list straight from its own buffer
+        UartTxSeg segs[3] = {
+            { header, (uint16_t)hLen },
+            { list, listLen },
+            { "\r\n\r\n", 4 },
+        };
+        if (!esp.linkSend(Esp8266::LINK_HTTP, segs, 3, 5000)) {
+            sslClose(esp);
+            return false;
+        }
+    }
+
+    // Ranges back to back, in file order; the LCD shows progress through
+    // the missing bytes rather than the whole file
+    g_uploadProgress.totalBytes = bodySize;
+    uint32_t done = 0;
+    bool ok = true;
+    for (uint8_t i = 0; i < count && ok; i++) {
+        uint32_t len = UploadManifest::rangeBytes(ranges[i], fileSize);
+        g_uploadProgress.resumeOffset = done;
+        fp->err = 0;  // clear sticky FatFS error
+        f_lseek(fp, UploadManifest::rangeOffset(ranges[i]));
+        ok = streamFileBody(esp, fp, len);
+        done += len;
+    }
+
+    if (ok) {
+        const char* resp;
+        uint16_t respLen;
+        ok = recvResponse(esp, "\"complete\"", 10000, resp, respLen);
+        if (!ok) LOG_W(ats::ErrorSource::System, 0x0077);
+    } else {
+        LOG_W(ats::ErrorSource::System, 0x0078);
+    }
+
+    sslClose(esp);
+    g_uploadProgress.totalBytes = fileSize;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// SSL connection
+// ---------------------------------------------------------------------------
+
+bool HttpUploadServiceImpl::sslConnect(Esp8266& esp) {
+    if (!esp.linkOpen(Esp8266::LINK_HTTP, "SSL", SERVER, PORT, 10000)) {
+        return false;
     }
     vTaskDelay(pdMS_TO_TICKS(200));
     return true;
 }
 
 void HttpUploadServiceImpl::sslClose(Esp8266& esp) {
-    esp.sendCmd("AT+CIPCLOSE", "OK", 2000);
+    esp.linkClose(Esp8266::LINK_HTTP);
 }
 
 // ---------------------------------------------------------------------------
@@ -324,29 +574,21 @@ uint32_t HttpUploadServiceImpl::queryServerOffset(Esp8266& esp, const char* file
         "\r\n",
         deviceId, filename, SERVER);
 
-    char cipsend[24];
-    snprintf(cipsend, sizeof(cipsend), "AT+CIPSEND=%d", hLen);
-    if (!esp.sendCmd(cipsend, ">", 3000)) {
+    if (!esp.linkSend(Esp8266::LINK_HTTP, reinterpret_cast<const uint8_t*>(header),
+                      (uint16_t)hLen, 5000)) {
         LOG_W(ats::ErrorSource::Upload, evt::UPL_QUERY_SEND_FAIL);
         sslClose(esp); return 0;
     }
-    esp.sendData(reinterpret_cast<const uint8_t*>(header), hLen, 3000);
-    if (!esp.waitFor("SEND OK", 5000)) {
-        LOG_W(ats::ErrorSource::Upload, evt::UPL_QUERY_SEND_FAIL);
-        sslClose(esp); return 0;
-    }
-
-    // Clear buffer before waiting for server response
-    esp.clearRx();
 
     // Wait for JSON body (may arrive in 2nd +IPD after headers)
-    if (!esp.waitFor("\"size\"", 8000)) {
-        LOG_W(ats::ErrorSource::Upload, evt::UPL_QUERY_NO_RESP, (uint32_t)esp.getResponseLen());
+    const char* resp;
+    uint16_t respLen;
+    if (!recvResponse(esp, "\"size\"", 8000, resp, respLen)) {
+        LOG_W(ats::ErrorSource::Upload, evt::UPL_QUERY_NO_RESP, (uint32_t)respLen);
         sslClose(esp); return 0;
     }
 
     // Parse "size":NNNN from JSON response
-    const char* resp = esp.getResponse();
     const char* sizeStr = strstr(resp, "\"size\":");
     uint32_t offset = 0;
     if (sizeStr) {
@@ -395,59 +637,98 @@ bool HttpUploadServiceImpl::sendHttpHeader(Esp8266& esp, const char* filename,
 
     if (hLen <= 0 || hLen >= (int)sizeof(header)) return false;
 
-    // AT+CIPSEND=<len>
-    char cipsend[24];
-    snprintf(cipsend, sizeof(cipsend), "AT+CIPSEND=%d", hLen);
-    if (!esp.sendCmd(cipsend, ">", 3000)) return false;
-
-    // Send header
-    esp.sendData(reinterpret_cast<const uint8_t*>(header), hLen, 3000);
-    return esp.waitFor("SEND OK", 5000);
+    return esp.linkSend(Esp8266::LINK_HTTP, reinterpret_cast<const uint8_t*>(header),
+                        (uint16_t)hLen, 5000);
 }
 
 // ---------------------------------------------------------------------------
 // Stream file body in chunks
 // ---------------------------------------------------------------------------
 
+bool HttpUploadServiceImpl::readChunk(FIL* fp, uint8_t* buf, uint16_t len, UINT& br,
+                                      UploadChunkSizer& sizer) {
+    // DMA read from SD with retry
+    FRESULT fr = FR_DISK_ERR;
+    for (int retry = 0; retry < 3; retry++) {
+        if (retry > 0) {
+            sizer.onReadRetry();
+            sdio_force_reinit();
+            vTaskDelay(pdMS_TO_TICKS(50));
+        }
+        SDIO->DCTRL = 0;
+        SDIO->ICR = 0xFFFFFFFF;
+        br = 0;
+        fr = f_read(fp, buf, len, &br);
+        if (fr == FR_OK && br > 0) return true;
+    }
+    return false;
+}
+
 bool HttpUploadServiceImpl::streamFileBody(Esp8266& esp, FIL* fp, uint32_t fileSize) {
-    uint8_t* chunkBuf = atsstorage::AtsStorageServiceImpl::getReadCache();
-    static const uint16_t TX_CHUNK = 2048;  // DMA reads stable at 2KB
+    // Ping-pong: one half of the read cache is on the wire (UART DMA)
+    // while the next chunk is read from SD into the other
+    uint8_t* cache = atsstorage::AtsStorageServiceImpl::getReadCache();
+    uint8_t* bufs[2] = { cache, cache + PIPE_CHUNK };
+    UploadChunkSizer sizer(PIPE_CHUNK);
 
     LOG_D(ats::ErrorSource::Upload, evt::UPL_STREAM_START, (uint32_t)fileSize);
     io::IoServiceImpl::getInstance().armCancel();
+    TickType_t streamStart = xTaskGetTickCount();
+
+    uint8_t cur = 0;
+    UINT len = 0;
+    if (!readChunk(fp, bufs[cur], sizer.next(fileSize), len, sizer)) {
+        LOG_W(ats::ErrorSource::Upload, evt::UPL_READ_FAIL, 0u);
+        return false;
+    }
+
     uint32_t sent = 0;
-    while (sent < fileSize) {
-        uint32_t remaining = fileSize - sent;
-        uint16_t chunkLen = (remaining > TX_CHUNK) ? TX_CHUNK : (uint16_t)remaining;
-
-        // DMA read from SD with retry
-        UINT br = 0;
-        FRESULT fr = FR_DISK_ERR;
-        for (int retry = 0; retry < 3; retry++) {
-            SDIO->DCTRL = 0;
-            SDIO->ICR = 0xFFFFFFFF;
-            br = 0;
-            fr = f_read(fp, chunkBuf, chunkLen, &br);
-            if (fr == FR_OK && br > 0) break;
-            sdio_force_reinit();
-            vTaskDelay(pdMS_TO_TICKS(50));
+    uint32_t nextMark = PROGRESS_STEP;
+    bool ok = true;
+    while (len > 0) {
+        // One AT+CIPSEND per chunk; the data goes out by DMA
+        UartTxSeg seg = { bufs[cur], (uint16_t)len };
+        TickType_t txStart = xTaskGetTickCount();
+        if (!esp.linkSendAsync(Esp8266::LINK_HTTP, &seg, 1)) {
+            LOG_W(ats::ErrorSource::Upload, evt::UPL_SEND_FAIL, (uint32_t)sent);
+            ok = false;
+            break;
         }
-        if (fr != FR_OK || br == 0) {
-            LOG_W(ats::ErrorSource::Upload, evt::UPL_READ_FAIL, (uint32_t)sent);
-            return false;
+
+        // Next chunk from SD while this one goes out
+        uint32_t readPos = sent + len;
+        UINT nextLen = 0;
+        bool readOk = true;
+        TickType_t readStart = xTaskGetTickCount();
+        if (readPos < fileSize) {
+            readOk = readChunk(fp, bufs[cur ^ 1], sizer.next(fileSize - readPos),
+                               nextLen, sizer);
         }
+        TickType_t waitStart = xTaskGetTickCount();
+        bool txOk = esp.linkSendWait(5000);
+        TickType_t txEnd = xTaskGetTickCount();
 
-        // Transparent mode: send directly to TCP (no AT overhead)
-        if (!esp.sendData(chunkBuf, br, 5000)) {
+        if (!txOk) {
             LOG_W(ats::ErrorSource::Upload, evt::UPL_SEND_FAIL, (uint32_t)sent);
-            return false;
+            ok = false;
+            break;
         }
-
-        sent += br;
+        sent += len;
         g_uploadProgress.bytesSent = sent;
+        if (!readOk) {
+            LOG_W(ats::ErrorSource::Upload, evt::UPL_READ_FAIL, (uint32_t)sent);
+            ok = false;
+            break;
+        }
+        if (nextLen > 0) {
+            // 1ms tick: tick deltas are the step's timings
+            sizer.onStep((uint16_t)nextLen, waitStart - readStart,
+                         (uint16_t)len, txEnd - txStart, txEnd - waitStart);
+        }
 
         // Progress log + LCD update + cancel check every ~20KB
-        if (sent % (TX_CHUNK * 10) == 0 || sent == fileSize) {
+        if (sent >= nextMark || sent == fileSize) {
+            nextMark = sent + PROGRESS_STEP;
             LOG_D(ats::ErrorSource::Upload, evt::UPL_PROGRESS, (uint32_t)sent);
             // LCD toast: "Upload 1/7 23%" — static buffer (toast stores pointer)
             uint32_t totalSent = g_uploadProgress.resumeOffset + sent;
@@ -463,11 +744,30 @@ bool HttpUploadServiceImpl::streamFileBody(Esp8266& esp, FIL* fp, uint32_t fileS
             // Cancel check — don't clear flag here, let retry loop see it
             if (io::IoServiceImpl::getInstance().isCancelRequested()) {
                 LOG_I(ats::ErrorSource::Upload, evt::UPL_CANCELLED);
-                return false;
+                ok = false;
+                break;
             }
+
+            // MQTT keepalive / publish between chunks (AT lock is free here)
+            pump();
         }
+
+        cur ^= 1;
+        len = nextLen;
     }
-    return true;
+
+    // Pipeline metrics for the LCD and the log
+    uint32_t ms = (uint32_t)(xTaskGetTickCount() - streamStart);
+    g_uploadProgress.bytesPerSec = (uint32_t)((uint64_t)sent * 1000u / (ms ? ms : 1));
+    g_uploadProgress.sdRate = sizer.sdRate();
+    g_uploadProgress.txRate = sizer.txRate();
+    g_uploadProgress.chunkSize = sizer.chunk();
+    g_uploadProgress.sdStalls = sizer.sdStalls();
+    g_uploadProgress.readRetries = sizer.retries();
+    LOG_I(ats::ErrorSource::Upload, evt::UPL_STREAM_RATE, g_uploadProgress.bytesPerSec);
+    LOG_I(ats::ErrorSource::Upload, evt::UPL_STREAM_STALLS,
+          ((uint32_t)sizer.sdStalls() << 16) | sizer.retries());
+    return ok && sent == fileSize;
 }
 
 // ---------------------------------------------------------------------------
@@ -476,11 +776,22 @@ bool HttpUploadServiceImpl::streamFileBody(Esp8266& esp, FIL* fp, uint32_t fileS
 
 bool HttpUploadServiceImpl::waitHttpResponse(Esp8266& esp) {
     // Wait for server response (HTTP 200)
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    if (!esp.waitFor("+IPD", 10000)) return false;
+    const char* resp;
+    uint16_t respLen;
+    if (recvResponse(esp, "200", 10000, resp, respLen)) return true;
+    return strstr(resp, "complete") != nullptr;
+}
 
-    // Check for "200" in response
-    return esp.responseContains("200") || esp.responseContains("complete");
+bool HttpUploadServiceImpl::recvResponse(Esp8266& esp, const char* expect,
+                                         uint32_t timeoutMs, const char*& resp,
+                                         uint16_t& len) {
+    // The body pipeline is done with the read cache: the reply lands there
+    // instead of on the MQTT task stack
+    char* buf = reinterpret_cast<char*>(atsstorage::AtsStorageServiceImpl::getReadCache());
+    buf[0] = '\0';
+    resp = buf;
+    len = 0;
+    return esp.linkRecvUntil(Esp8266::LINK_HTTP, buf, PIPE_CHUNK, len, expect, timeoutMs);
 }
 
 } // namespace arcana
@@ -2,6 +2,8 @@
 
 #include "Esp8266.hpp"
 #include "AtsStorageServiceImpl.hpp"
+#include "UploadChunkSizer.hpp"
+#include "UploadManifest.hpp"
 #include "ff.h"
 #include <cstdint>
 
@@ -14,28 +16,51 @@ struct UploadProgress {
     volatile uint32_t bytesSent;     // session bytes sent
     volatile uint32_t totalBytes;    // total file size
     volatile uint32_t resumeOffset;  // resume start point
+    // Last body stream (pipeline metrics)
+    volatile uint32_t bytesPerSec;   // body bytes / stream time
+    volatile uint32_t sdRate;        // smoothed SD read rate, B/s
+    volatile uint32_t txRate;        // smoothed UART TX rate, B/s
+    volatile uint16_t chunkSize;     // current read size
+    volatile uint16_t sdStalls;      // steps where the wire waited on SD
+    volatile uint16_t readRetries;   // SD reads retried
+    volatile uint16_t attempts;      // connection attempts for this file
 };
 extern UploadProgress g_uploadProgress;
 
 /**
  * HTTPS file upload service — uploads .ats files to cloud server.
  *
- * Stateless utility: call uploadPendingFiles() from MQTT task
- * after disconnecting MQTT (ESP8266 single-connection mode).
+ * Stateless utility: call uploadPendingFiles() from MQTT task. It runs on
+ * Esp8266::LINK_HTTP while MQTT stays connected on its own link; the
+ * pump hook (setPump) lets the caller service MQTT between body chunks.
  *
  * Flow:
- *   AT+CIPSTART="SSL" → HTTP POST header → stream file body → AT+CIPCLOSE
+ *   AT+CIPSTART=1,"SSL" → HTTP POST header → stream file body → AT+CIPCLOSE=1
  *   Repeat for each pending file + device.ats blackbox.
+ *
+ * Files go through syncFile(): the device POSTs the file's 4KB chunk
+ * digests to /manifest, the server answers with the chunk ranges it does
+ * not hold, and only those are POSTed to /chunks. A server without the
+ * manifest endpoint gets the whole file through uploadFile().
  */
 class HttpUploadServiceImpl {
 public:
     /**
      * Upload all pending .ats files + device.ats.
-     * @param esp   ESP8266 instance (MQTT must be disconnected)
+     * @param esp   ESP8266 instance (links enabled)
      * @return number of files successfully uploaded
      */
     static uint8_t uploadPendingFiles(Esp8266& esp);
 
+    /**
+     * Called between body chunks and files while an upload runs, with the
+     * AT lock free (MQTT keepalive, sensor publish). nullptr to clear.
+     */
+    static void setPump(void (*fn)(void*), void* ctx) {
+        sPump = fn;
+        sPumpCtx = ctx;
+    }
+
     /**
      * Upload a single file via HTTPS POST.
      * @param esp       ESP8266 instance
@@ -45,6 +70,13 @@ public:
      */
     static bool uploadFile(Esp8266& esp, const char* filename, const char* deviceId);
 
+    /**
+     * Upload only the chunks of a file the server is missing.
+     * Falls back to uploadFile() when the server has no manifest endpoint.
+     * @return true once the server reports the file complete
+     */
+    static bool syncFile(Esp8266& esp, const char* filename, const char* deviceId);
+
 private:
     /* Test access — host gtest fixture exercises private static helpers. */
     friend struct HttpUploadServiceTestAccess;
@@ -57,12 +89,35 @@ private:
                                const char* deviceId, uint32_t bodySize,
                                uint32_t rangeStart = 0, uint32_t totalSize = 0);
     static bool streamFileBody(Esp8266& esp, FIL* fp, uint32_t fileSize);
+    static bool readChunk(FIL* fp, uint8_t* buf, uint16_t len, UINT& br,
+                          UploadChunkSizer& sizer);
     static bool waitHttpResponse(Esp8266& esp);
+    static bool recvResponse(Esp8266& esp, const char* expect, uint32_t timeoutMs,
+                             const char*& resp, uint16_t& len);
+    static void pump() { if (sPump) sPump(sPumpCtx); }
+
+    enum class ManifestResult : uint8_t { Ok, Failed, Unsupported };
+
+    static ManifestResult exchangeManifest(Esp8266& esp, FIL* fp, const char* filename,
+                                           const char* deviceId, uint32_t fileSize,
+                                           ChunkRange* missing, uint8_t& count);
+    static bool streamManifest(Esp8266& esp, FIL* fp, uint32_t fileSize);
+    static bool sendChunks(Esp8266& esp, FIL* fp, const char* filename,
+                           const char* deviceId, uint32_t fileSize,
+                           const ChunkRange* ranges, uint8_t count);
 
     // Config
     static const char* SERVER;
     static const uint16_t PORT;
     static const uint16_t CHUNK_SIZE = 512;  // max stable with SDIO polling read
+    // Body pipeline: the 4KB ATS read cache split into two ping-pong halves
+    static const uint16_t PIPE_CHUNK = 2048;   // DMA reads stable at 2KB
+    static const uint32_t PROGRESS_STEP = 20480;
+    // Manifest digests go out in batches from the spare cache half
+    static const uint16_t DIGEST_BATCH = 64;
+
+    static void (*sPump)(void*);
+    static void* sPumpCtx;
 };
 
 } // namespace arcana
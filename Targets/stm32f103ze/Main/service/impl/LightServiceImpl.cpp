@@ -8,9 +8,6 @@ LightServiceImpl::LightServiceImpl()
     : mDataObs("LightSvc Data")
     , mLightData()
     , mSensor()
-    , mTaskBuffer()
-    , mTaskStack{}
-    , mTaskHandle(0)
     , mRunning(false)
 {
     output.DataEvents = &mDataObs;
@@ -36,19 +33,13 @@ ServiceStatus LightServiceImpl::init() {
 }
 
 ServiceStatus LightServiceImpl::start() {
+    if (!input.Acquisition) {
+        return ServiceStatus::InvalidState;
+    }
     mRunning = true;
 
-    mTaskHandle = xTaskCreateStatic(
-        lightTask,
-        "light",
-        TASK_STACK_SIZE,
-        this,
-        tskIDLE_PRIORITY + 2,
-        mTaskStack,
-        &mTaskBuffer
-    );
-
-    if (!mTaskHandle) return ServiceStatus::Error;
+    AcqPlan plan = { readPlan, this, READ_INTERVAL_MS, READ_PHASE_MS, 1 };
+    if (!input.Acquisition->addPlan(plan)) return ServiceStatus::Error;
     return ServiceStatus::OK;
 }
 
@@ -56,26 +47,21 @@ void LightServiceImpl::stop() {
     mRunning = false;
 }
 
-void LightServiceImpl::lightTask(void* param) {
-    LightServiceImpl* self = static_cast<LightServiceImpl*>(param);
-
-    // Wait for AP3216C first conversion (~112ms for ALS)
-    vTaskDelay(pdMS_TO_TICKS(200));
-
-    while (self->mRunning) {
-        Ap3216cReading reading = self->mSensor.read();
+AcqStatus LightServiceImpl::readPlan(void* ctx, const AcqSlot& slot) {
+    return static_cast<LightServiceImpl*>(ctx)->read(slot);
+}
 
-        if (reading.valid) {
-            self->mLightData.ambientLight = reading.ambientLight;
-            self->mLightData.proximity = reading.proximity;
-            self->mLightData.updateTimestamp();
-            self->mDataObs.publish(&self->mLightData);
-        }
+AcqStatus LightServiceImpl::read(const AcqSlot& slot) {
+    if (!mRunning) return AcqStatus::Done;
 
-        vTaskDelay(pdMS_TO_TICKS(READ_INTERVAL_MS));
-    }
+    Ap3216cReading reading = mSensor.read();
+    if (!reading.valid) return AcqStatus::Error;
 
-    vTaskDelete(0);
+    mLightData.ambientLight = reading.ambientLight;
+    mLightData.proximity = reading.proximity;
+    mLightData.timestamp = slot.stampMs;
+    mDataObs.publish(&mLightData);
+    return AcqStatus::Done;
 }
 
 } // namespace light
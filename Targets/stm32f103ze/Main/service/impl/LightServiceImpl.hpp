@@ -2,8 +2,6 @@
 
 #include "LightService.hpp"
 #include "Ap3216cSensor.hpp"
-#include "FreeRTOS.h"
-#include "task.h"
 
 namespace arcana {
 namespace light {
@@ -18,7 +16,7 @@ public:
     void stop() override;
 
 private:
-    /* Test access — host gtest fixture drives the static lightTask. */
+    /* Test access — host gtest fixture drives the sampling plan. */
     friend struct LightServiceTestAccess;
 
     LightServiceImpl();
@@ -26,18 +24,18 @@ private:
     LightServiceImpl(const LightServiceImpl&);
     LightServiceImpl& operator=(const LightServiceImpl&);
 
-    static void lightTask(void* param);
+    /** Sampling plan, run from the acquisition task */
+    static AcqStatus readPlan(void* ctx, const AcqSlot& slot);
+    AcqStatus read(const AcqSlot& slot);
 
     static const uint32_t READ_INTERVAL_MS = 1000;
-    static const uint16_t TASK_STACK_SIZE = 256;
+    // First ALS conversion takes ~112ms; also keeps clear of the accel plans
+    static const uint32_t READ_PHASE_MS = 200;
 
     Observable<LightDataModel> mDataObs;
     LightDataModel mLightData;
     Ap3216cSensor mSensor;
 
-    StaticTask_t mTaskBuffer;
-    StackType_t mTaskStack[TASK_STACK_SIZE];
-    TaskHandle_t mTaskHandle;
     bool mRunning;
 };
 
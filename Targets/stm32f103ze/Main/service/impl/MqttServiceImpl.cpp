@@ -8,7 +8,7 @@
 #include "AtsStorageServiceImpl.hpp"
 #include "HttpUploadServiceImpl.hpp"
 #include "RegistrationServiceImpl.hpp"
-// No IoServiceImpl include — decoupled via Esp8266 resource lock
+// No IoServiceImpl include — upload requests arrive via Esp8266
 #include "Credentials.hpp"
 #include "Esp8266.hpp"
 #include "CommandBridge.hpp"
@@ -37,26 +37,56 @@ const char* MqttServiceImpl::MQTT_CLIENT_ID = "arcana_f103";
 static char sTopicSensor[48] = "/arcana/sensor";  // fallback (prefix up to 35 + "/sensor")
 static char sTopicCmd[48]    = "/arcana/cmd";
 static char sTopicRsp[48]    = "/arcana/rsp";
+static char sTopicRspBin[48] = "/arcana/rsp_bin";
 const char* MqttServiceImpl::TOPIC_SENSOR   = sTopicSensor;
 const char* MqttServiceImpl::TOPIC_CMD      = sTopicCmd;
 const char* MqttServiceImpl::TOPIC_RSP      = sTopicRsp;
+const char* MqttServiceImpl::TOPIC_RSP_BIN  = sTopicRspBin;
+
+// Main loop wake-ups: LINK_MQTT data and EVT_ACCESS are set by Esp8266
+static const EventBits_t EVT_MQTT_RX = (EventBits_t)1 << Esp8266::LINK_MQTT;
+static const EventBits_t EVT_SENSOR  = Esp8266::EVT_ACCESS << 1;
+static const EventBits_t EVT_WAKE    = EVT_MQTT_RX | Esp8266::EVT_ACCESS | EVT_SENSOR;
 
 MqttServiceImpl::MqttServiceImpl()
     : mCmdObs("MqttSvc Cmd")
     , mConnObs("MqttSvc Conn")
     , mCmdModel()
     , mConnModel()
+    , mEventsBuf()
+    , mEvents(0)
     , mSensorPending(false)
-    , mPendingSensor()
     , mTaskBuffer()
     , mTaskStack{}
     , mTaskHandle(0)
     , mRunning(false)
     , mMqttConnected(false)
     , mNextPacketId(1)
+    , mLastPingTick(0)
+    , mInflight()
+    , mBackfillCursor()
+    , mBackfillSendPos()
+    , mBackfillFileId(0)
+    , mBackfillEnd(0)
+    , mBackfillCount(0)
+    , mLastBackfillTick(0)
+    , mLastCursorSaveTick(0)
+    , mBackfillActive(false)
+    , mBackfillReplay(false)
+    , mCursorDirty(false)
+    , mTelemetry()
+    , mTelemetryBuf{}
+    , mBatchStartTick(0)
+    , mBatchLatencyMs(TELEMETRY_LATENCY_MS)
+    , mBatchMax(TELEMETRY_BATCH_DEFAULT)
+    , mRxPacket{}
+    , mRxPacketLen(0)
+    , mRxReady(false)
 {
     output.CommandEvents    = &mCmdObs;
     output.ConnectionStatus = &mConnObs;
+    mTelemetry.init(mTelemetryBuf, sizeof(mTelemetryBuf), TELEMETRY_FIELDS);
+    mInflight.setWindow(PUBLISH_WINDOW_DEFAULT);
 }
 
 MqttServiceImpl::~MqttServiceImpl() { stop(); }
@@ -66,16 +96,15 @@ MqttService& MqttServiceImpl::getInstance() {
     return sInstance;
 }
 
-ServiceStatus MqttServiceImpl::initHAL() { return ServiceStatus::OK; }
+ServiceStatus MqttServiceImpl::initHAL() {
+    mEvents = xEventGroupCreateStatic(&mEventsBuf);
+    return mEvents ? ServiceStatus::OK : ServiceStatus::Error;
+}
 
 ServiceStatus MqttServiceImpl::init() {
     if (input.SensorData) {
         input.SensorData->subscribe(onSensorData, this);
     }
-    if (input.LightData) {
-        input.LightData->subscribe(
-            reinterpret_cast<void (*)(LightDataModel*, void*)>(onLightData), this);
-    }
     return ServiceStatus::OK;
 }
 
@@ -91,18 +120,23 @@ ServiceStatus MqttServiceImpl::start() {
 
 void MqttServiceImpl::stop() { mRunning = false; }
 
+void MqttServiceImpl::setTelemetryBatch(uint8_t maxSamples, uint32_t maxLatencyMs) {
+    mBatchMax = maxSamples ? maxSamples : 1;
+    mBatchLatencyMs = maxLatencyMs;
+}
+
+void MqttServiceImpl::setPublishWindow(uint8_t n) {
+    mInflight.setWindow(n);
+}
+
 // --- Observer callbacks ---
 
 void MqttServiceImpl::onSensorData(SensorDataModel* model, void* ctx) {
     MqttServiceImpl* self = static_cast<MqttServiceImpl*>(ctx);
     if (!self->mMqttConnected) return;
-    self->mPendingSensor = *model;
+    (void)model;    // already encoded in the TelemetryPipeline slot
     self->mSensorPending = true;
-}
-
-void MqttServiceImpl::onLightData(LightDataModel* model, void* ctx) {
-    MqttServiceImpl* self = static_cast<MqttServiceImpl*>(ctx);
-    self->mLatestLight = *model;
+    xEventGroupSetBits(self->mEvents, EVT_SENSOR);
 }
 
 // --- TCP SSL + raw MQTT 3.1.1 ---
@@ -118,46 +152,70 @@ bool MqttServiceImpl::sslConnect() {
         port = regSvc.credentials().mqttPort;
     }
 
-    char cmd[80];
-    snprintf(cmd, sizeof(cmd),
-             "AT+CIPSTART=\"SSL\",\"%s\",%u", broker, port);
     LOG_I(ats::ErrorSource::Mqtt, evt::MQTT_SSL_START);
-    bool ok = esp.sendCmd(cmd, "CONNECT", 20000);
+    mRxReady = false;
+    bool ok = esp.linkOpen(Esp8266::LINK_MQTT, "SSL", broker, port, 20000);
     LOG_I(ats::ErrorSource::Mqtt, evt::MQTT_SSL_RESULT, (uint32_t)ok);
     return ok;
 }
 
 void MqttServiceImpl::sslClose() {
     Esp8266& esp = input.Wifi->getEsp();
-    esp.sendCmd("AT+CIPCLOSE", "OK", 2000);
+    esp.linkClose(Esp8266::LINK_MQTT);
+    mRxReady = false;
 }
 
 bool MqttServiceImpl::sendMqttPacket(const uint8_t* pkt, uint16_t len) {
+    UartTxSeg seg = { pkt, len };
+    return sendMqttPacket(&seg, 1);
+}
+
+bool MqttServiceImpl::sendMqttPacket(const UartTxSeg* segs, uint8_t count) {
+    Esp8266& esp = input.Wifi->getEsp();
+    return esp.linkSend(Esp8266::LINK_MQTT, segs, count, 5000);
+}
+
+bool MqttServiceImpl::pollMqttPacket() {
+    if (mRxReady) return true;
     Esp8266& esp = input.Wifi->getEsp();
-    char cmd[20];
-    snprintf(cmd, sizeof(cmd), "AT+CIPSEND=%u", len);
-    if (!esp.sendCmd(cmd, ">", 5000)) return false;
-    esp.sendData(pkt, len, 2000);
-    return esp.waitFor("SEND OK", 5000);
+    // The CommandBridge task polls too (PUBACK for its responses)
+    Esp8266::AtLock lock(esp);
+
+    // Fixed header: type byte + up to 4 remaining-length bytes
+    uint8_t hdr[5];
+    uint16_t have = esp.linkPeek(Esp8266::LINK_MQTT, hdr, sizeof(hdr));
+    int32_t total = MqttPacket::frameLength(hdr, have);
+    if (total == 0) return false;
+    if (total < 0 || total > Esp8266::MQTT_QUEUE_SIZE) {
+        // Lost the packet boundaries: nothing after this can be framed
+        LOG_W(ats::ErrorSource::Mqtt, evt::MQTT_RX_DESYNC,
+              (uint32_t)esp.linkAvailable(Esp8266::LINK_MQTT));
+        esp.linkSkip(Esp8266::LINK_MQTT, esp.linkAvailable(Esp8266::LINK_MQTT));
+        return false;
+    }
+    if (esp.linkAvailable(Esp8266::LINK_MQTT) < (uint32_t)total) return false;
+
+    if (total > RX_PACKET_SIZE) {
+        // Bigger than any command we accept: drop it whole
+        LOG_W(ats::ErrorSource::Mqtt, evt::MQTT_RX_OVERSIZE, (uint32_t)total);
+        esp.linkSkip(Esp8266::LINK_MQTT, (uint16_t)total);
+        return false;
+    }
+    mRxPacketLen = esp.linkRead(Esp8266::LINK_MQTT, mRxPacket, (uint16_t)total);
+    mRxReady = true;
+    return true;
 }
 
 bool MqttServiceImpl::waitMqttPacket(uint8_t* buf, uint16_t& len,
                                       uint32_t timeoutMs) {
-    Esp8266& esp = input.Wifi->getEsp();
     uint32_t start = xTaskGetTickCount();
     while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(timeoutMs)) {
-        if (esp.hasMqttMsg()) {
-            const uint8_t* data;
-            uint16_t dataLen;
-            if (MqttPacket::parseIpd(esp.getMqttMsg(), esp.getMqttMsgLen(),
-                                      data, dataLen)) {
-                uint16_t n = dataLen < len ? dataLen : len;
-                memcpy(buf, data, n);
-                len = n;
-                esp.clearMqttMsg();
-                return true;
-            }
-            esp.clearMqttMsg();
+        if (pollMqttPacket()) {
+            uint16_t n = mRxPacketLen < len ? mRxPacketLen : len;
+            memcpy(buf, mRxPacket, n);
+            len = n;
+            mRxReady = false;
+            return true;
         }
         vTaskDelay(pdMS_TO_TICKS(50));
     }
@@ -198,7 +256,7 @@ bool MqttServiceImpl::mqttHandshake() {
 
 bool MqttServiceImpl::mqttSubscribeRaw(const char* topic, uint8_t qos) {
     uint8_t pkt[80];
-    uint16_t pid = mNextPacketId++;
+    uint16_t pid = nextPacketId();
     uint16_t len = MqttPacket::buildSubscribe(pkt, sizeof(pkt), pid, topic, qos);
     if (!sendMqttPacket(pkt, len)) return false;
 
@@ -215,41 +273,87 @@ bool MqttServiceImpl::mqttPublishRaw(const char* topic, const char* payload) {
     return mqttPublishBin(topic, (const uint8_t*)payload, (uint16_t)strlen(payload));
 }
 
-bool MqttServiceImpl::mqttPublishBin(const char* topic, const uint8_t* data, uint16_t dataLen) {
+bool MqttServiceImpl::mqttPublishBin(const char* topic, const uint8_t* data, uint16_t dataLen,
+                                     uint8_t kind, const ats::AtsCursor* covered) {
+    // QoS 1, pipelined: the PUBACK is matched later by onPuback()
     Esp8266& esp = input.Wifi->getEsp();
-    uint16_t pid = mNextPacketId++;
-    uint8_t pkt[192];
-    uint16_t len = MqttPacket::buildPublish(pkt, sizeof(pkt), topic, data, dataLen,
-                                             1, pid);  // QoS 1
-    if (len > sizeof(pkt)) return false;
-    if (!sendMqttPacket(pkt, len)) return false;
+    for (;;) {
+        if (!waitWindow()) return false;
+        Esp8266::AtLock lock(esp);
+        if (mInflight.full()) continue;   // the other publishing task took the slot
+
+        uint16_t pid = nextPacketId();
+        // Header here, payload straight from the caller's buffer
+        uint8_t hdr[64];  // fixed hdr + topic + pid
+        uint16_t hdrLen = MqttPacket::buildPublishHeader(hdr, sizeof(hdr), topic, dataLen,
+                                                         1, pid);  // QoS 1
+        if (hdrLen == 0) return false;
+        UartTxSeg segs[2] = { { hdr, hdrLen }, { data, dataLen } };
+        if (!sendMqttPacket(segs, 2)) return false;
+        const ats::AtsCursor none = { 0, 0 };
+        mInflight.push(pid, kind, covered ? *covered : none, xTaskGetTickCount());
+        return true;
+    }
+}
 
-    // Wait for PUBACK (QoS 1 delivery confirmation)
+bool MqttServiceImpl::mqttPublishResponse(const char* topic, const uint8_t* data,
+                                          uint16_t dataLen) {
+    // The CommandBridge task sends these: a full window of sensor frames
+    // must not stall it for up to PUBACK_TIMEOUT_MS. A lost reply is the
+    // client's retry, as over BLE; streams recover through their own ACKs.
+    uint8_t hdr[64];  // fixed hdr + topic
+    uint16_t hdrLen = MqttPacket::buildPublishHeader(hdr, sizeof(hdr), topic, dataLen);
+    if (hdrLen == 0) return false;
+    UartTxSeg segs[2] = { { hdr, hdrLen }, { data, dataLen } };
+    Esp8266& esp = input.Wifi->getEsp();
+    Esp8266::AtLock lock(esp);
+    return sendMqttPacket(segs, 2);
+}
+
+uint16_t MqttServiceImpl::nextPacketId() {
+    // 0 is not a valid packet ID
+    if (mNextPacketId == 0) mNextPacketId = 1;
+    return mNextPacketId++;
+}
+
+bool MqttServiceImpl::waitWindow() {
+    if (!mInflight.full()) return true;
+    // Only the session task reads LINK_MQTT; the CommandBridge task waits
+    // for it to take the PUBACKs off the queue
+    const bool session = xTaskGetCurrentTaskHandle() == mTaskHandle;
     uint32_t start = xTaskGetTickCount();
-    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(5000)) {
-        if (esp.hasMqttMsg()) {
-            const uint8_t* mqttData;
-            uint16_t mqttDataLen;
-            if (MqttPacket::parseIpd(esp.getMqttMsg(), esp.getMqttMsgLen(),
-                                      mqttData, mqttDataLen)) {
-                uint8_t pktType = MqttPacket::packetType(mqttData[0]);
-                if (pktType == MqttPacket::PUBACK) {
-                    uint16_t ackId = MqttPacket::parsePuback(mqttData, mqttDataLen);
-                    esp.clearMqttMsg();
-                    return ackId == pid;
-                }
-                if (pktType == MqttPacket::PINGRESP) {
-                    esp.clearMqttMsg();
-                    continue;  // ignore, keep waiting for PUBACK
-                }
-                // Other packet (server PUBLISH) — leave for main loop
-                break;
-            }
-            esp.clearMqttMsg();
-        }
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(PUBACK_TIMEOUT_MS)) {
+        if (session) drainAcks();
+        if (!mInflight.full()) return true;
         vTaskDelay(pdMS_TO_TICKS(20));
     }
-    return false;  // PUBACK timeout
+    LOG_W(ats::ErrorSource::Mqtt, evt::MQTT_PUBACK_TIMEOUT, (uint32_t)mInflight.count());
+    return false;
+}
+
+void MqttServiceImpl::drainAcks() {
+    // A server PUBLISH at the head stays for the main loop
+    while (pollMqttPacket()) {
+        uint8_t pktType = MqttPacket::packetType(mRxPacket[0]);
+        if (pktType != MqttPacket::PUBACK && pktType != MqttPacket::PINGRESP) return;
+        processIncomingMqtt();
+    }
+}
+
+void MqttServiceImpl::onPuback(uint16_t packetId) {
+    Esp8266& esp = input.Wifi->getEsp();
+    {
+        Esp8266::AtLock lock(esp);
+        if (!mInflight.ack(packetId)) return;   // duplicate, or sent before a reconnect
+    }
+    for (;;) {
+        MqttInflight::Entry e;
+        {
+            Esp8266::AtLock lock(esp);
+            if (!mInflight.pop(e)) break;
+        }
+        if (e.kind == MqttInflight::Backfill) backfillAck(e.covered);
+    }
 }
 
 bool MqttServiceImpl::mqttDisconnectRaw() {
@@ -275,9 +379,6 @@ void MqttServiceImpl::runTask() {
 
     while (mRunning) {
 
-        // Acquire ESP8266 (blocks if upload is using it)
-        esp.requestAccess(Esp8266::User::Mqtt);
-
         // --- Phase 1: WiFi ---
         LOG_I(ats::ErrorSource::Wifi, 0x0001);  // WiFi connecting
         while (mRunning) {
@@ -285,7 +386,7 @@ void MqttServiceImpl::runTask() {
             LOG_W(ats::ErrorSource::Wifi, 0x0002);  // WiFi retry
             vTaskDelay(pdMS_TO_TICKS(10000));
         }
-        if (!mRunning) { esp.releaseAccess(); break; }
+        if (!mRunning) break;
 
         // --- Phase 2: NTP ---
         wifi->syncNtp();
@@ -325,10 +426,11 @@ void MqttServiceImpl::runTask() {
                 snprintf(sTopicSensor, sizeof(sTopicSensor), "%s/sensor", prefix);
                 snprintf(sTopicCmd, sizeof(sTopicCmd), "%s/cmd", prefix);
                 snprintf(sTopicRsp, sizeof(sTopicRsp), "%s/rsp", prefix);
+                snprintf(sTopicRspBin, sizeof(sTopicRspBin), "%s/rsp_bin", prefix);
             }
         }
 
-        // ESP8266 lock: upload requested by IoServiceImpl → run upload here
+        // Upload requested by IoServiceImpl → run it before MQTT connects
         if (esp.isAccessRequested()) {
             HttpUploadServiceImpl::uploadPendingFiles(esp);
             esp.clearRequest();
@@ -336,11 +438,9 @@ void MqttServiceImpl::runTask() {
 
         // --- Phase 3: TCP SSL + MQTT CONNECT ---
         LOG_I(ats::ErrorSource::Mqtt, 0x0001);  // MQTT connecting
-        esp.clearMqttMsg();  // flush stale +IPD from registration
 
         bool connected = false;
         for (int i = 0; i < 3 && mRunning; i++) {
-            esp.clearMqttMsg();
             if (sslConnect() && mqttHandshake()) {
                 connected = true;
                 break;
@@ -358,7 +458,6 @@ void MqttServiceImpl::runTask() {
                 regSvc2.invalidate();
             }
             vTaskDelay(pdMS_TO_TICKS(5000));
-            esp.releaseAccess();
             continue;
         }
 
@@ -372,22 +471,28 @@ void MqttServiceImpl::runTask() {
         mConnModel.updateTimestamp();
         mConnObs.publish(&mConnModel);
 
-        // Syslog UDP disabled — CIPMUX=0, TCP SSL already using the link.
-        // TODO: enable CIPMUX=1 for simultaneous TCP SSL + UDP syslog.
+        // Syslog UDP on its own link, next to the TLS session
+        auto& syslog = log::SyslogAppender::getInstance();
+        syslog.openUdp(esp);
 
         uint32_t lastNtpTick  = xTaskGetTickCount();
-        uint32_t lastPingTick = xTaskGetTickCount();
+        mLastPingTick = xTaskGetTickCount();
+        // Sleep between passes until link data, a sample or an upload request
+        xEventGroupClearBits(mEvents, EVT_WAKE);
+        esp.setEventGroup(mEvents);
+
+        // Records sensor.ats took while the link was down
+        backfillBegin();
 
         // --- Phase 5: Main loop ---
         uint32_t lastSuccessTick = xTaskGetTickCount();
         static const uint32_t ESP_WATCHDOG_MS = 30000;
-        static const uint32_t PING_INTERVAL_MS = (KEEPALIVE_SEC * 750);  // 75%
 
         while (mRunning && mMqttConnected) {
             // Publish sensor data
             if (mSensorPending) {
                 mSensorPending = false;
-                if (publishSensorData(&mPendingSensor)) {
+                if (publishSensorData()) {
                     lastSuccessTick = xTaskGetTickCount();
                 } else {
                     // Publish failed → assume TCP broken
@@ -395,18 +500,34 @@ void MqttServiceImpl::runTask() {
                     break;
                 }
             }
+            if (telemetryDue()) {
+                if (!flushTelemetry()) {
+                    mMqttConnected = false;
+                    break;
+                }
+                lastSuccessTick = xTaskGetTickCount();
+            }
 
-            // ESP8266 lock: yield MQTT, reset ESP8266, upload, reconnect
-            if (esp.isAccessRequested()) {
-                mqttDisconnectRaw();
-                sslClose();
+            // One replay batch per BACKFILL_INTERVAL_MS, between live publishes
+            if (!backfillStep()) {
                 mMqttConnected = false;
-                if (wifi->resetAndConnect()) {
-                    HttpUploadServiceImpl::uploadPendingFiles(esp);
-                    esp.clearRequest();
-                }
                 break;
             }
+            if (mCursorDirty &&
+                (xTaskGetTickCount() - mLastCursorSaveTick) > pdMS_TO_TICKS(CURSOR_SAVE_MS)) {
+                backfillSaveCursor();
+            }
+
+            // Upload requested: runs on LINK_HTTP while the session stays
+            // up; incoming commands wait in the LINK_MQTT queue meanwhile
+            if (esp.isAccessRequested()) {
+                HttpUploadServiceImpl::setPump(uploadPump, this);
+                HttpUploadServiceImpl::uploadPendingFiles(esp);
+                HttpUploadServiceImpl::setPump(nullptr, nullptr);
+                esp.clearRequest();
+                lastSuccessTick = xTaskGetTickCount();
+                if (!mMqttConnected) break;
+            }
 
             // ESP8266 watchdog
             if ((xTaskGetTickCount() - lastSuccessTick) > pdMS_TO_TICKS(ESP_WATCHDOG_MS)) {
@@ -415,41 +536,60 @@ void MqttServiceImpl::runTask() {
                 break;
             }
 
+            // Oldest PUBLISH still unacknowledged: the session is gone
+            if (mInflight.count() &&
+                (xTaskGetTickCount() - mInflight.oldestTick()) > pdMS_TO_TICKS(PUBACK_TIMEOUT_MS)) {
+                LOG_W(ats::ErrorSource::Mqtt, evt::MQTT_PUBACK_TIMEOUT,
+                      (uint32_t)mInflight.count());
+                mMqttConnected = false;
+                break;
+            }
+
             // PINGREQ keepalive
-            if ((xTaskGetTickCount() - lastPingTick) > pdMS_TO_TICKS(PING_INTERVAL_MS)) {
-                uint8_t ping[2];
-                MqttPacket::buildPingreq(ping);
-                if (sendMqttPacket(ping, 2)) {
-                    lastPingTick = xTaskGetTickCount();
-                } else {
+            if ((xTaskGetTickCount() - mLastPingTick) > pdMS_TO_TICKS(PING_INTERVAL_MS)) {
+                if (!sendPing()) {
                     mMqttConnected = false;
                     break;
                 }
             }
 
-            // NTP resync every 6 hours
+            // NTP resync every 6 hours — firmware SNTP, no socket needed
             if ((xTaskGetTickCount() - lastNtpTick) >
                 pdMS_TO_TICKS(6UL * 3600UL * 1000UL)) {
-                // NTP requires its own AT+CIPSTART — skip while MQTT connected.
-                // Will resync on next reconnect cycle.
+                wifi->syncNtp();
                 lastNtpTick = xTaskGetTickCount();
             }
 
-            // Incoming MQTT packets via +IPD → mMqttBuf
-            if (esp.hasMqttMsg()) {
-                LOG_I(ats::ErrorSource::Mqtt, 0x0030, (uint32_t)esp.getMqttMsgLen());
+            // Queued WARN+ events out over UDP
+            syslog.flushViaUdp(esp);
+
+            // Incoming MQTT packets from the LINK_MQTT queue; another
+            // packet may already be queued behind this one, so no sleep
+            if (pollMqttPacket()) {
+                LOG_I(ats::ErrorSource::Mqtt, 0x0030, (uint32_t)mRxPacketLen);
                 processIncomingMqtt();
-                esp.clearMqttMsg();
+                continue;
             }
 
-            vTaskDelay(pdMS_TO_TICKS(100));
+            xEventGroupWaitBits(mEvents, EVT_WAKE, pdTRUE, pdFALSE,
+                                pdMS_TO_TICKS(waitBudgetMs()));
         }
 
         // --- Phase 6: Disconnected ---
+        esp.setEventGroup(0);
         mqttDisconnectRaw();
         sslClose();
+        syslog.closeUdp(esp);
+        backfillSaveCursor();
+        mTelemetry.reset();   // unsent samples stay behind the cursor
+        {
+            // Sensor frames in flight are behind the cursor too; responses are lost
+            Esp8266::AtLock lock(esp);
+            uint8_t lost = mInflight.pending(MqttInflight::Response);
+            if (lost) LOG_W(ats::ErrorSource::Mqtt, evt::MQTT_INFLIGHT_DROP, (uint32_t)lost);
+            mInflight.clear();
+        }
         mMqttConnected = false;
-        esp.releaseAccess();
         mConnModel.connected = false;
         mConnModel.updateTimestamp();
         mConnObs.publish(&mConnModel);
@@ -459,100 +599,311 @@ void MqttServiceImpl::runTask() {
     }
 }
 
-// --- Protobuf manual encoder (SensorData, 6 varint fields) ---
-// Proto: sint32 temp_x10=1, sint32 ax=2, sint32 ay=3, sint32 az=4, uint32 als=5, uint32 ps=6
+// --- Stream IDs (SensorData protobuf is encoded by TelemetryPipeline) ---
 
-static const uint8_t SID_SENSOR = 0x20;
+static const uint8_t SID_BACKFILL = 0x21;
+static const uint8_t SID_SENSOR_BATCH = 0x22;
 
-static uint16_t pbVarint(uint8_t* buf, uint32_t val) {
-    uint16_t n = 0;
-    while (val > 0x7F) { buf[n++] = (val & 0x7F) | 0x80; val >>= 7; }
-    buf[n++] = val & 0x7F;
-    return n;
-}
+// --- Publish sensor data ---
 
-static uint16_t pbSint32(uint8_t* buf, uint8_t fieldNum, int32_t val) {
-    buf[0] = (fieldNum << 3);  // wire type 0
-    uint32_t zz = (uint32_t)((val << 1) ^ (val >> 31));  // zigzag
-    return 1 + pbVarint(buf + 1, zz);
+static atsstorage::AtsStorageServiceImpl& sensorStorage() {
+    return static_cast<atsstorage::AtsStorageServiceImpl&>(
+        atsstorage::AtsStorageServiceImpl::getInstance());
 }
 
-static uint16_t pbUint32(uint8_t* buf, uint8_t fieldNum, uint32_t val) {
-    buf[0] = (fieldNum << 3);
-    return 1 + pbVarint(buf + 1, val);
+bool MqttServiceImpl::publishSensorData() {
+    TelemetrySample sample;
+    TelemetryPipeline::getInstance().latest(sample);
+    // Best effort: samples coalesce while the task is busy, so live frames
+    // never stand in for sensor.ats records — only the backfill moves the cursor
+#ifndef MQTT_SENSOR_PLAINTEXT
+    if (mBatchMax > 1) {
+        int32_t v[TELEMETRY_FIELDS];
+        sample.values(v);
+        if (mTelemetry.count() == 0) mBatchStartTick = xTaskGetTickCount();
+        if (mTelemetry.add(sample.ts, v)) return true;
+        // Buffer full before mBatchMax (large deltas): send, start the next
+        if (!flushTelemetry()) return false;
+        mBatchStartTick = xTaskGetTickCount();
+        mTelemetry.add(sample.ts, v);
+        return true;
+    }
+#endif
+    return publishSensorSample(sample);
 }
 
-// --- Publish sensor data ---
-
-bool MqttServiceImpl::publishSensorData(SensorDataModel* model) {
+bool MqttServiceImpl::publishSensorSample(const TelemetrySample& sample) {
 #ifdef MQTT_SENSOR_PLAINTEXT
     // Debug: plain JSON (human-readable, unencrypted)
     char payload[192];
-    int tInt = (int)model->temperature;
-    int tFrac = (int)(model->temperature * 10) % 10;
+    int tInt = (int)sample.temperature;
+    int tFrac = sample.tempX10() % 10;
     if (tFrac < 0) tFrac = -tFrac;
     snprintf(payload, sizeof(payload),
              "{\"t\":%d.%d,\"ax\":%d,\"ay\":%d,\"az\":%d,\"als\":%u,\"ps\":%u}",
              tInt, tFrac,
-             (int)model->accelX, (int)model->accelY, (int)model->accelZ,
-             mLatestLight.ambientLight, mLatestLight.proximity);
-    return mqttPublishRaw(TOPIC_SENSOR, payload);
+             (int)sample.ax, (int)sample.ay, (int)sample.az,
+             sample.als, sample.ps);
+    return mqttPublishBin(TOPIC_SENSOR, (const uint8_t*)payload, (uint16_t)strlen(payload),
+                          MqttInflight::Live);
 #else
     // Production: FrameCodec + ChaCha20 encrypted protobuf
     // Use comm_key (from registration ECDH) if available, else fall back to device_key
     auto& regSvc = reg::RegistrationServiceImpl::getInstance();
-    const uint8_t* key = regSvc.getCommKey();
-
-    // 1. Encode protobuf (~20-30 bytes)
-    uint8_t pb[40];
-    uint16_t pos = 0;
-    pos += pbSint32(pb + pos, 1, (int32_t)(model->temperature * 10));
-    pos += pbSint32(pb + pos, 2, (int32_t)model->accelX);
-    pos += pbSint32(pb + pos, 3, (int32_t)model->accelY);
-    pos += pbSint32(pb + pos, 4, (int32_t)model->accelZ);
-    pos += pbUint32(pb + pos, 5, mLatestLight.ambientLight);
-    pos += pbUint32(pb + pos, 6, mLatestLight.proximity);
-
-    // 2. Nonce: [tick:4][0:8] — unique at 1Hz (tick increments each ms)
-    uint8_t nonce[12] = {};
+    uint8_t frame[TelemetryPipeline::MAX_FRAME];
+    uint16_t frameLen;
+    if (!TelemetryPipeline::getInstance().seal(sample, regSvc.getCommKey(),
+                                               frame, sizeof(frame), frameLen)) return false;
+    return mqttPublishBin(TOPIC_SENSOR, frame, frameLen, MqttInflight::Live);
+#endif
+}
+
+bool MqttServiceImpl::telemetryDue() const {
+    uint8_t n = mTelemetry.count();
+    if (n == 0) return false;
+    return n >= mBatchMax ||
+           (xTaskGetTickCount() - mBatchStartTick) >= pdMS_TO_TICKS(mBatchLatencyMs);
+}
+
+uint32_t MqttServiceImpl::waitBudgetMs() const {
+    // Nearest timer deadline of the main loop. The watchdog and NTP resync
+    // are far longer than MAX_WAIT_MS and may run up to that much late.
+    const uint32_t now = xTaskGetTickCount();
+    uint32_t budget = MAX_WAIT_MS;
+    auto until = [&](uint32_t since, uint32_t periodMs) {
+        uint32_t elapsed = now - since;
+        uint32_t left = elapsed >= periodMs ? 0 : periodMs - elapsed;
+        if (left < budget) budget = left;
+    };
+    until(mLastPingTick, PING_INTERVAL_MS);
+    if (mTelemetry.count()) until(mBatchStartTick, mBatchLatencyMs);
+    if (mBackfillActive) until(mLastBackfillTick, BACKFILL_INTERVAL_MS);
+    if (mCursorDirty) until(mLastCursorSaveTick, CURSOR_SAVE_MS);
+    if (mInflight.count()) until(mInflight.oldestTick(), PUBACK_TIMEOUT_MS);
+    return budget;
+}
+
+bool MqttServiceImpl::flushTelemetry() {
+    if (mTelemetry.count() == 0) return true;
+
+    // [frame hdr:7][nonce:12][batch][crc:2], framed in place on the task stack
+    uint8_t buf[FrameCodec::kOverhead + 12 + TELEMETRY_BUF_SIZE];
+    uint8_t* nonce = buf + FrameCodec::kHeaderSize;
+    uint8_t* body = nonce + 12;
+    const uint16_t len = mTelemetry.size();
+    memcpy(body, mTelemetry.data(), len);
+    // Dropped even if the publish fails: the backfill resends from disk
+    mTelemetry.reset();
+
+    // Nonce: [tick:4][0:7][0x22] — last byte keeps it apart from 0x20/0x21
     uint32_t tick = xTaskGetTickCount();
+    memset(nonce, 0, 12);
     memcpy(nonce, &tick, 4);
+    nonce[11] = SID_SENSOR_BATCH;
+    const uint8_t* key = reg::RegistrationServiceImpl::getInstance().getCommKey();
+    crypto::ChaCha20::crypt(key, nonce, 0, body, len);
+
+    size_t frameLen;
+    if (!FrameCodec::frame(nonce, 12 + len, FrameCodec::kFlagFin, SID_SENSOR_BATCH,
+                           buf, sizeof(buf), frameLen)) return true;
+    return mqttPublishBin(TOPIC_SENSOR, buf, (uint16_t)frameLen, MqttInflight::Live);
+}
+
+// --- Store-and-forward backfill ---
 
-    // 3. Encrypt in-place
-    crypto::ChaCha20::crypt(key, nonce, 0, pb, pos);
+void MqttServiceImpl::backfillBegin() {
+    mBackfillActive = false;
+    mBackfillReplay = false;
+    mBackfillCount = 0;
+    mLastCursorSaveTick = xTaskGetTickCount();
+    mLastBackfillTick = mLastCursorSaveTick - pdMS_TO_TICKS(BACKFILL_INTERVAL_MS);
 
-    // 4. Build payload: [nonce:12][encrypted_pb:N]
-    uint8_t enc[52];
-    memcpy(enc, nonce, 12);
-    memcpy(enc + 12, pb, pos);
+    auto& storage = sensorStorage();
+    if (!storage.isReady()) return;
+    const ats::ArcanaTsDb& db = storage.getSensorDb();
+    const uint32_t fileId = db.getCreatedEpoch();
+    const ats::AtsCursor head = db.headCursor();
+
+    // First session since boot: resume from the last persisted cursor
+    if (mBackfillFileId == 0) {
+        storage.loadMqttCursor(mBackfillFileId, mBackfillCursor);
+    }
+
+    if (mBackfillFileId != fileId) {
+        // No cursor yet: nothing to replay. Otherwise the day rotated —
+        // earlier files go out with the HTTP upload, today replays from its start.
+        if (mBackfillFileId == 0) {
+            mBackfillCursor = head;
+        } else {
+            mBackfillCursor.block = 0;
+            mBackfillCursor.record = 0;
+        }
+        mBackfillFileId = fileId;
+        mCursorDirty = true;
+    }
+    if (mBackfillCursor.block > head.block) {
+        // Recovery truncated the file behind the cursor
+        mBackfillCursor = head;
+        mCursorDirty = true;
+    }
+
+    uint32_t behind = head.block - mBackfillCursor.block;
+    if (behind > BACKFILL_MAX_BLOCKS) {
+        LOG_W(ats::ErrorSource::Mqtt, evt::MQTT_BACKFILL_SKIP, behind - BACKFILL_MAX_BLOCKS);
+        mBackfillCursor.block = head.block - BACKFILL_MAX_BLOCKS;
+        mBackfillCursor.record = 0;
+        mCursorDirty = true;
+        behind = BACKFILL_MAX_BLOCKS;
+    }
+
+    mBackfillEnd = head.block;
+    mBackfillSendPos = mBackfillCursor;
+    if (behind > 0) {
+        mBackfillActive = true;
+        mBackfillReplay = true;
+        LOG_I(ats::ErrorSource::Mqtt, evt::MQTT_BACKFILL_START, behind);
+    }
+}
+
+bool MqttServiceImpl::backfillFollow() {
+    // Batches of the previous file still in flight: their PUBACKs would
+    // land a cursor from that file on this one
+    if (mBackfillFileId == 0 || mInflight.pending(MqttInflight::Backfill)) return false;
+    auto& storage = sensorStorage();
+    if (!storage.isReady()) return false;
+    const ats::ArcanaTsDb& db = storage.getSensorDb();
+    const uint32_t fileId = db.getCreatedEpoch();
+    if (fileId != mBackfillFileId) {
+        // Rotated while connected: the old file goes out with the HTTP upload
+        mBackfillFileId = fileId;
+        mBackfillCursor.block = 0;
+        mBackfillCursor.record = 0;
+        mCursorDirty = true;
+    }
+    const ats::AtsCursor head = db.headCursor();
+    if (head.block <= mBackfillCursor.block) return false;
+    mBackfillEnd = head.block;
+    mBackfillSendPos = mBackfillCursor;
+    mBackfillActive = true;
+    return true;
+}
+
+bool MqttServiceImpl::backfillStep() {
+    // Caught up: blocks committed since go out the same way — live frames
+    // are coalesced samples, only these batches stand for sensor.ats records
+    if (!mBackfillActive && !backfillFollow()) return true;
+    // Leave live data a slot (a window of one is shared)
+    const uint8_t room = mInflight.window() > 1 ? mInflight.window() - 1 : 1;
+    if (mInflight.count() >= room) return true;
+    uint32_t now = xTaskGetTickCount();
+    if ((now - mLastBackfillTick) < pdMS_TO_TICKS(BACKFILL_INTERVAL_MS)) return true;
+    mLastBackfillTick = now;
+
+    auto& storage = sensorStorage();
+    const ats::ArcanaTsDb& db = storage.getSensorDb();
+    const ats::ArcanaTsSchema* schema = db.getSchema(BACKFILL_CHANNEL);
+    if (!storage.isReady() || !schema || db.getCreatedEpoch() != mBackfillFileId) {
+        // Rotated at midnight mid-replay: the rest is in the daily upload
+        backfillFinish();
+        return true;
+    }
+
+    // Built in place, one buffer (task stack, only while publishing):
+    // [frame hdr:7][nonce:12][fileId:4][block:4][rec:2][n:1][size:1][records][crc:2]
+    //                        └──────────────── ChaCha20 ────────────────────┘
+    uint8_t buf[FrameCodec::kOverhead + 12 + BACKFILL_HDR_SIZE +
+                BACKFILL_BATCH * BACKFILL_REC_SIZE];
+    uint8_t* nonce = buf + FrameCodec::kHeaderSize;
+    uint8_t* body = nonce + 12;
+    const uint16_t recSize = schema->recordSize;
+    const uint16_t maxRecs = (BACKFILL_BATCH * BACKFILL_REC_SIZE) / recSize;
+
+    ats::AtsCursor next = mBackfillSendPos;
+    uint16_t n = db.readFrom(BACKFILL_CHANNEL, next, mBackfillEnd,
+                             body + BACKFILL_HDR_SIZE, maxRecs);
+    if (n == 0) {
+        if (mInflight.pending(MqttInflight::Backfill)) return true;  // last PUBACKs
+        mBackfillCursor = next;   // past any blocks that failed CRC
+        mCursorDirty = true;
+        backfillFinish();
+        return true;
+    }
+
+    memcpy(body, &mBackfillFileId, 4);
+    memcpy(body + 4, &mBackfillSendPos.block, 4);
+    memcpy(body + 8, &mBackfillSendPos.record, 2);
+    body[10] = (uint8_t)n;
+    body[11] = (uint8_t)recSize;
+    uint16_t bodyLen = (uint16_t)(BACKFILL_HDR_SIZE + n * recSize);
+
+    // Nonce: [tick:4][block:4][rec:2][0:2] — block >= 1 keeps it apart from live
+    memset(nonce, 0, 12);
+    memcpy(nonce, &now, 4);
+    memcpy(nonce + 4, &mBackfillSendPos.block, 4);
+    memcpy(nonce + 8, &mBackfillSendPos.record, 2);
+    const uint8_t* key = reg::RegistrationServiceImpl::getInstance().getCommKey();
+    crypto::ChaCha20::crypt(key, nonce, 0, body, bodyLen);
 
-    // 5. FrameCodec wrap
-    uint8_t frame[72];
     size_t frameLen;
-    if (!FrameCodec::frame(enc, 12 + pos, FrameCodec::kFlagFin, SID_SENSOR,
-                            frame, sizeof(frame), frameLen)) return false;
+    if (!FrameCodec::frame(nonce, 12 + bodyLen, FrameCodec::kFlagFin, SID_BACKFILL,
+                           buf, sizeof(buf), frameLen)) return true;
+
+    // Cursor moves only once the broker has the batch (backfillAck)
+    if (!mqttPublishBin(TOPIC_SENSOR, buf, (uint16_t)frameLen,
+                        MqttInflight::Backfill, &next)) return false;
+    mBackfillSendPos = next;
+    mBackfillCount += n;
+    return true;
+}
 
-    // 6. Publish binary
-    return mqttPublishBin(TOPIC_SENSOR, frame, (uint16_t)frameLen);
-#endif
+void MqttServiceImpl::backfillAck(const ats::AtsCursor& covered) {
+    if (!mBackfillActive) return;   // finished or rotated since it was sent
+    mBackfillCursor = covered;
+    mCursorDirty = true;
+    if (mBackfillSendPos.block >= mBackfillEnd &&
+        !mInflight.pending(MqttInflight::Backfill)) {
+        backfillFinish();
+    }
 }
 
-// --- Process incoming +IPD (raw MQTT packets) ---
+void MqttServiceImpl::backfillFinish() {
+    mBackfillActive = false;
+    // Following the head: the cursor is saved on the CURSOR_SAVE_MS timer
+    if (!mBackfillReplay) return;
+    mBackfillReplay = false;
+    LOG_I(ats::ErrorSource::Mqtt, evt::MQTT_BACKFILL_DONE, mBackfillCount);
+    backfillSaveCursor();
+}
 
-void MqttServiceImpl::processIncomingMqtt() {
-    Esp8266& esp = input.Wifi->getEsp();
+void MqttServiceImpl::backfillSaveCursor() {
+    mLastCursorSaveTick = xTaskGetTickCount();
+    if (!mCursorDirty || mBackfillFileId == 0) return;
+    // Posted, not written: this can run inside the HTTP upload pump while
+    // the read cache is on loan, and device.ats is the storage task's file
+    if (sensorStorage().postMqttCursor(mBackfillFileId, mBackfillCursor)) {
+        mCursorDirty = false;
+    }
+}
+
+// --- Process incoming packet (raw MQTT) ---
 
-    // Parse +IPD to get raw MQTT bytes
-    const uint8_t* mqttData;
-    uint16_t mqttDataLen;
-    if (!MqttPacket::parseIpd(esp.getMqttMsg(), esp.getMqttMsgLen(),
-                               mqttData, mqttDataLen)) return;
+void MqttServiceImpl::processIncomingMqtt() {
+    if (!mRxReady) return;
+    // Consumed here: PUBACK below may poll for the next packet
+    mRxReady = false;
+    const uint8_t* mqttData = mRxPacket;
+    uint16_t mqttDataLen = mRxPacketLen;
 
     uint8_t pktType = MqttPacket::packetType(mqttData[0]);
 
     // PINGRESP — just acknowledge
     if (pktType == MqttPacket::PINGRESP) return;
 
+    if (pktType == MqttPacket::PUBACK) {
+        onPuback(MqttPacket::parsePuback(mqttData, mqttDataLen));
+        return;
+    }
+
     // Only handle PUBLISH
     if (pktType != MqttPacket::PUBLISH) return;
 
@@ -565,6 +916,10 @@ void MqttServiceImpl::processIncomingMqtt() {
                                    topic, topicLen, payload, payloadLen,
                                    packetId)) return;
 
+    // ISR → dispatch delay of the command (the wake-up cost of the loop)
+    LOG_I(ats::ErrorSource::Mqtt, evt::MQTT_RX_LATENCY,
+          xTaskGetTickCount() - input.Wifi->getEsp().linkRxTick(Esp8266::LINK_MQTT));
+
     // QoS 1 → PUBACK
     if (packetId > 0) {
         uint8_t ack[4];
@@ -637,7 +992,8 @@ void MqttServiceImpl::processIncomingMqtt() {
                                         hexBuf[i * 2 + 1] = hex[frameBuf[i] & 0x0F];
                                     }
                                     hexBuf[frameLen * 2] = '\0';
-                                    mqttPublishRaw(TOPIC_RSP, hexBuf);
+                                    mqttPublishResponse(TOPIC_RSP, (const uint8_t*)hexBuf,
+                                                        (uint16_t)(frameLen * 2));
 
                                     bridge.mKeyExchange.installPendingSession(1, 0);
                                     LOG_I(ats::ErrorSource::Cmd, 0x0B21);
@@ -669,22 +1025,63 @@ void MqttServiceImpl::processIncomingMqtt() {
     mCmdObs.publish(&mCmdModel);
 }
 
+// --- Upload pump ---
+
+bool MqttServiceImpl::sendPing() {
+    uint8_t ping[2];
+    MqttPacket::buildPingreq(ping);
+    if (!sendMqttPacket(ping, 2)) return false;
+    mLastPingTick = xTaskGetTickCount();
+    return true;
+}
+
+void MqttServiceImpl::uploadPump(void* ctx) {
+    // Between upload chunks: only what keeps the session alive (PUBACKs
+    // free the window). Incoming commands stay queued (the KeyExchange
+    // path needs more stack than the upload leaves).
+    MqttServiceImpl* self = static_cast<MqttServiceImpl*>(ctx);
+    if (!self->mMqttConnected) return;
+    self->drainAcks();
+    if (self->mSensorPending) {
+        self->mSensorPending = false;
+        if (!self->publishSensorData()) {
+            self->mMqttConnected = false;
+            return;
+        }
+    }
+    if (self->telemetryDue() && !self->flushTelemetry()) {
+        self->mMqttConnected = false;
+        return;
+    }
+    if ((xTaskGetTickCount() - self->mLastPingTick) > pdMS_TO_TICKS(PING_INTERVAL_MS)) {
+        if (!self->sendPing()) self->mMqttConnected = false;
+    }
+}
+
 // --- CommandBridge response ---
 
 bool MqttServiceImpl::mqttSendFn(const uint8_t* data, uint16_t len, void* ctx) {
     MqttServiceImpl* self = static_cast<MqttServiceImpl*>(ctx);
     if (!self->mMqttConnected) return false;
 
-    char hexPayload[130];
-    uint16_t hLen = len > 64 ? 64 : len;
-    for (uint16_t i = 0; i < hLen; i++) {
+    // v2 batch responses and stream DATA go out as raw binary — hex would
+    // double a full frame — on their own topic, so TOPIC_RSP stays hex text.
+    // So do single frames past the hex cap (KE, ticket and resume replies).
+    if (len > RSP_HEX_MAX ||
+        (len > FrameCodec::kOffSid &&
+         (CommandBridge::isBatchSid(data[FrameCodec::kOffSid]) ||
+          CommandBridge::isStreamSid(data[FrameCodec::kOffSid])))) {
+        return self->mqttPublishResponse(TOPIC_RSP_BIN, data, len);
+    }
+
+    char hexPayload[RSP_HEX_MAX * 2];
+    for (uint16_t i = 0; i < len; i++) {
         static const char hex[] = "0123456789ABCDEF";
         hexPayload[i * 2]     = hex[data[i] >> 4];
         hexPayload[i * 2 + 1] = hex[data[i] & 0x0F];
     }
-    hexPayload[hLen * 2] = '\0';
-
-    return self->mqttPublishRaw(TOPIC_RSP, hexPayload);
+    return self->mqttPublishResponse(TOPIC_RSP, (const uint8_t*)hexPayload,
+                                     (uint16_t)(len * 2));
 }
 
 } // namespace mqtt
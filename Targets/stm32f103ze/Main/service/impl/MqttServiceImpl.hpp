@@ -3,6 +3,12 @@
 #include "MqttService.hpp"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "event_groups.h"
+#include "UartDmaTx.hpp"
+#include "TelemetryBatch.hpp"
+#include "TelemetryPipeline.hpp"
+#include "MqttInflight.hpp"
+#include "ats/ArcanaTsTypes.hpp"
 
 namespace arcana {
 namespace mqtt {
@@ -12,6 +18,28 @@ namespace mqtt {
  *
  * ESP8266 1MB flash has no built-in MQTT+TLS, but AT+CIPSTART="SSL" works.
  * STM32 builds raw MQTT 3.1.1 packets and sends via AT+CIPSEND over TLS TCP.
+ * The session owns Esp8266::LINK_MQTT; uploads and syslog use their own
+ * links without disconnecting it.
+ *
+ * Store-and-forward: the position in sensor.ats the cloud has seen is kept
+ * as a cursor in device.ats. After a reconnect the records written while
+ * the link was down are replayed in batches, interleaved with live data;
+ * once caught up the backfill follows the head, sending each block as
+ * sensor.ats commits it, so the cursor only ever passes published records.
+ *
+ * Live samples are batched: up to mBatchMax samples or mBatchLatencyMs,
+ * whichever comes first, go out as one delta-encoded TelemetryBatch frame.
+ *
+ * Publishes are QoS 1 and pipelined: up to the window size go out before
+ * the first PUBACK returns. Only a replay batch's acknowledgment commits:
+ * live frames carry coalesced samples, not every sensor.ats record, so
+ * they never move the cursor. Sensor data is queued on disk already —
+ * sensor.ats, with the cursor in device.ats — so whatever was in flight
+ * when the link dropped is sent again by the backfill after the reconnect.
+ *
+ * The session loop sleeps on an event group: LINK_MQTT data (USART3 ISR),
+ * a new sensor sample and an upload request wake it at once; otherwise it
+ * wakes for the nearest timer (ping, batch latency, backfill pacing).
  */
 class MqttServiceImpl : public MqttService {
 public:
@@ -22,6 +50,12 @@ public:
     ServiceStatus start() override;
     void stop() override;
 
+    /** Live telemetry batching; maxSamples 1 = one legacy frame per sample */
+    void setTelemetryBatch(uint8_t maxSamples, uint32_t maxLatencyMs);
+
+    /** QoS 1 PUBLISHes in flight before waiting for a PUBACK (1..8) */
+    void setPublishWindow(uint8_t n);
+
 private:
     /* Test access — host gtest fixture exercises private helpers. */
     friend struct MqttServiceTestAccess;
@@ -41,26 +75,56 @@ private:
     bool mqttHandshake();
     bool mqttSubscribeRaw(const char* topic, uint8_t qos = 0);
     bool mqttPublishRaw(const char* topic, const char* payload);
-    bool mqttPublishBin(const char* topic, const uint8_t* data, uint16_t len);
+    bool mqttPublishBin(const char* topic, const uint8_t* data, uint16_t len,
+                        uint8_t kind = MqttInflight::Response,
+                        const ats::AtsCursor* covered = nullptr);
+    // QoS 0 command response: never waits on the telemetry window
+    bool mqttPublishResponse(const char* topic, const uint8_t* data, uint16_t len);
     bool mqttDisconnectRaw();
 
     // Low-level: send MQTT packet via AT+CIPSEND
     bool sendMqttPacket(const uint8_t* pkt, uint16_t len);
-    // Wait for incoming MQTT packet via +IPD → mMqttBuf
+    // Same, one packet gathered from several buffers
+    bool sendMqttPacket(const UartTxSeg* segs, uint8_t count);
+    // Wait for incoming MQTT packet (LINK_MQTT queue)
     bool waitMqttPacket(uint8_t* buf, uint16_t& len, uint32_t timeoutMs);
+    // Move one complete packet from the link queue into mRxPacket
+    bool pollMqttPacket();
+
+    // QoS 1 window: PUBACKs commit the entries they close, in send order
+    uint16_t nextPacketId();
+    bool waitWindow();                   // false = no PUBACK in time
+    void drainAcks();                    // PUBACK / PINGRESP at the queue head
+    void onPuback(uint16_t packetId);
+
+    // Queue the latest sample (or publish it directly: JSON / batch of one)
+    bool publishSensorData();
+    bool publishSensorSample(const TelemetrySample& sample);
+    bool flushTelemetry();
+    bool telemetryDue() const;
+    // Main loop sleep: ms until the nearest timer, at most MAX_WAIT_MS
+    uint32_t waitBudgetMs() const;
+
+    // Process the packet held in mRxPacket (raw MQTT from server)
+    void processIncomingMqtt();
 
-    // Publish sensor data as JSON
-    bool publishSensorData(SensorDataModel* model);
+    // Store-and-forward backfill from sensor.ats
+    void backfillBegin();
+    bool backfillFollow();               // true = new blocks behind the head to send
+    bool backfillStep();                 // false = publish failed (link down)
+    void backfillAck(const ats::AtsCursor& covered);
+    void backfillFinish();
+    void backfillSaveCursor();
 
-    // Process incoming +IPD (raw MQTT packets from server)
-    void processIncomingMqtt();
+    // Upload pump: keepalive + sensor publish between upload chunks
+    static void uploadPump(void* ctx);
+    bool sendPing();
 
     // MQTT send — used as TransportSendFn by CommandBridge TX task
     static bool mqttSendFn(const uint8_t* data, uint16_t len, void* ctx);
 
     // Observer callbacks
     static void onSensorData(SensorDataModel* model, void* ctx);
-    static void onLightData(LightDataModel* model, void* ctx);
 
     // Configuration
     static const char* MQTT_BROKER;
@@ -68,20 +132,46 @@ private:
     static const char* MQTT_CLIENT_ID;
     static const char* TOPIC_SENSOR;
     static const char* TOPIC_CMD;
-    static const char* TOPIC_RSP;
+    static const char* TOPIC_RSP;       // v1 responses, hex text
+    static const char* TOPIC_RSP_BIN;   // v2 batch responses + stream DATA, raw frames
+    static const uint16_t RSP_HEX_MAX = 64;   // longer responses go to TOPIC_RSP_BIN
     static const uint16_t KEEPALIVE_SEC = 60;
 
-    static const uint16_t TASK_STACK_SIZE = 576;  // +64 words for uECC ECDH in registration
+    // +64 words for uECC ECDH in registration, +64 for the upload pump
+    // (sensor publish on top of the upload body pipeline)
+    static const uint16_t TASK_STACK_SIZE = 640;
+    static const uint16_t RX_PACKET_SIZE = 256;
+    static const uint32_t PING_INTERVAL_MS = (KEEPALIVE_SEC * 750);  // 75%
+    static const uint32_t MAX_WAIT_MS = 1000;    // syslog flush, watchdog, NTP resync
+    static const uint8_t  PUBLISH_WINDOW_DEFAULT = 4;
+    static const uint32_t PUBACK_TIMEOUT_MS = 10000;     // oldest in flight → link is down
+
+    // Backfill: sensor.ats ch0, one batch per publish
+    static const uint8_t  BACKFILL_CHANNEL = 0;
+    static const uint16_t BACKFILL_REC_SIZE = 14;        // MPU6050 record
+    static const uint16_t BACKFILL_BATCH = 32;           // records per publish
+    static const uint16_t BACKFILL_HDR_SIZE = 12;        // [fileId:4][block:4][rec:2][n:1][size:1]
+    static const uint32_t BACKFILL_INTERVAL_MS = 200;    // <= 5 batches/s next to live data
+    static const uint32_t BACKFILL_MAX_BLOCKS = 256;     // older gap is left to the HTTP upload
+    static const uint32_t CURSOR_SAVE_MS = 600000;       // each save costs a device.ats block
+
+    // Live telemetry batch: temp_x10, ax, ay, az, als, ps
+    static const uint8_t  TELEMETRY_FIELDS = TelemetrySample::FIELDS;
+    static const uint16_t TELEMETRY_BUF_SIZE = 160;      // ~15 samples at 1Hz
+    static const uint8_t  TELEMETRY_BATCH_DEFAULT = 10;
+    static const uint32_t TELEMETRY_LATENCY_MS = 5000;
 
     Observable<MqttCommandModel>    mCmdObs;
     Observable<MqttConnectionModel> mConnObs;
     MqttCommandModel    mCmdModel;
     MqttConnectionModel mConnModel;
 
-    // Pending sensor + light data for publish
+    // Main loop wake-ups (EVT_* in the .cpp; Esp8266 sets its link bits)
+    StaticEventGroup_t mEventsBuf;
+    EventGroupHandle_t mEvents;
+
+    // New sample in the TelemetryPipeline slot
     volatile bool mSensorPending;
-    SensorDataModel mPendingSensor;
-    LightDataModel mLatestLight;
 
     StaticTask_t mTaskBuffer;
     StackType_t  mTaskStack[TASK_STACK_SIZE];
@@ -89,6 +179,35 @@ private:
     volatile bool mRunning;
     bool mMqttConnected;
     uint16_t mNextPacketId;
+    uint32_t mLastPingTick;
+
+    // QoS 1 PUBLISHes awaiting PUBACK (shared with the CommandBridge task
+    // under Esp8266::AtLock)
+    MqttInflight mInflight;
+
+    // Backfill cursor: next sensor.ats record the cloud has not acknowledged
+    ats::AtsCursor mBackfillCursor;
+    ats::AtsCursor mBackfillSendPos;    // next record to send; ahead by what is in flight
+    uint32_t mBackfillFileId;       // createdEpoch of the file the cursor is in (0 = none)
+    uint32_t mBackfillEnd;          // committed head block the batches run up to
+    uint32_t mBackfillCount;
+    uint32_t mLastBackfillTick;
+    uint32_t mLastCursorSaveTick;
+    bool     mBackfillActive;
+    bool     mBackfillReplay;       // reconnect replay (logged, cursor saved when done)
+    bool     mCursorDirty;
+
+    // Live samples not yet published
+    TelemetryBatch  mTelemetry;
+    uint8_t         mTelemetryBuf[TELEMETRY_BUF_SIZE];
+    uint32_t        mBatchStartTick;
+    uint32_t        mBatchLatencyMs;
+    uint8_t         mBatchMax;
+
+    // One received packet, framed out of the LINK_MQTT byte stream
+    uint8_t  mRxPacket[RX_PACKET_SIZE];
+    uint16_t mRxPacketLen;
+    bool     mRxReady;
 };
 
 } // namespace mqtt
@@ -10,10 +10,15 @@
  * 5. Write ota_meta.bin
  * 6. Set BKP DR2/DR3 OTA flag
  * 7. NVIC_SystemReset()
+ *
+ * Delta: steps 2-3 fetch fw_patch.bin instead, which must name the running
+ * image as its base; ota_meta.bin then describes the image the bootloader
+ * will rebuild from App flash + patch.
  */
 
 #include "OtaServiceImpl.hpp"
 #include "ota_header.h"
+#include "ota_delta.h"
 #include "Crc32.hpp"
 #include "ff.h"
 #include "FreeRTOS.h"
@@ -29,6 +34,7 @@ namespace arcana {
 OtaServiceImpl::OtaServiceImpl()
     : mProgress(0)
     , mActive(false)
+    , mImageBase(reinterpret_cast<const uint8_t*>(APP_FLASH_BASE))
 {
 }
 
@@ -49,39 +55,64 @@ bool OtaServiceImpl::startUpdate(const char* host, uint16_t port,
 
     LOG_I(ats::ErrorSource::Ota, evt::OTA_START, expectedSize);
 
-    /* 1. TCP connect + HTTP GET */
-    if (!httpGet(host, port, path)) {
-        LOG_E(ats::ErrorSource::Ota, evt::OTA_HTTP_FAIL);
+    /* 1-3. HTTP GET → firmware.bin → CRC */
+    if (!download(host, port, path, expectedSize, expectedCrc32, OTA_FW_FILENAME)) {
         mActive = false;
         return false;
     }
 
-    /* 2. Receive body → firmware.bin */
-    if (!receiveToFile(expectedSize)) {
-        LOG_E(ats::ErrorSource::Ota, evt::OTA_DOWNLOAD_FAIL);
-        input.esp->sendCmd("AT+CIPCLOSE", "OK", 1000);
-        input.esp->setIpdPassthrough(false);
+    /* 4. Write ota_meta.bin */
+    if (!writeOtaMeta(expectedSize, expectedCrc32, "ota")) {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_META_FAIL);
         mActive = false;
         return false;
     }
 
-    input.esp->setIpdPassthrough(false);
+    /* 5. Set OTA flag + reset */
+    LOG_I(ats::ErrorSource::Ota, evt::OTA_RESETTING);
+    setOtaFlag();
 
-    /* 3. Verify CRC */
-    if (!verifyCrc(expectedCrc32, expectedSize)) {
-        LOG_E(ats::ErrorSource::Ota, evt::OTA_VERIFY_FAIL, expectedCrc32);
+    vTaskDelay(pdMS_TO_TICKS(100));  /* Flush UART */
+    NVIC_SystemReset();
+
+    return true;  /* Never reached */
+}
+
+bool OtaServiceImpl::startDeltaUpdate(const char* host, uint16_t port,
+                                      const char* path, uint32_t patchSize,
+                                      uint32_t patchCrc32)
+{
+    if (!input.esp) return false;
+    if (mActive) return false;
+
+    mActive = true;
+    mProgress = 0;
+
+    LOG_I(ats::ErrorSource::Ota, evt::OTA_DELTA_START, patchSize);
+
+    /* 1-3. HTTP GET → fw_patch.bin → CRC */
+    if (!download(host, port, path, patchSize, patchCrc32, OTA_PATCH_FILENAME)) {
         mActive = false;
         return false;
     }
 
-    /* 4. Write ota_meta.bin */
-    if (!writeOtaMeta(expectedSize, expectedCrc32, "ota")) {
+    /* 4. Patch must be built against this image */
+    uint32_t dstSize = 0;
+    uint32_t dstCrc = 0;
+    if (!checkPatch(dstSize, dstCrc)) {
+        f_unlink(OTA_PATCH_FILENAME);
+        mActive = false;
+        return false;
+    }
+
+    /* 5. ota_meta.bin describes the rebuilt image */
+    if (!writeOtaMeta(dstSize, dstCrc, "delta", OTA_META_FLAG_DELTA)) {
         LOG_E(ats::ErrorSource::Ota, evt::OTA_META_FAIL);
         mActive = false;
         return false;
     }
 
-    /* 5. Set OTA flag + reset */
+    /* 6. Set OTA flag + reset */
     LOG_I(ats::ErrorSource::Ota, evt::OTA_RESETTING);
     setOtaFlag();
 
@@ -91,19 +122,69 @@ bool OtaServiceImpl::startUpdate(const char* host, uint16_t port,
     return true;  /* Never reached */
 }
 
+/* ---- HTTP GET → file → CRC ---- */
+bool OtaServiceImpl::download(const char* host, uint16_t port, const char* path,
+                              uint32_t size, uint32_t crc32, const char* filename)
+{
+    /* 1. TCP connect + HTTP GET */
+    if (!httpGet(host, port, path)) {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_HTTP_FAIL);
+        return false;
+    }
+
+    /* 2. Receive body → file; the link is freed either way */
+    bool ok = receiveToFile(size, filename);
+    input.esp->linkClose(Esp8266::LINK_HTTP);
+    if (!ok) {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_DOWNLOAD_FAIL);
+        return false;
+    }
+
+    /* 3. Verify CRC */
+    if (!verifyCrc(crc32, size, filename)) {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_VERIFY_FAIL, crc32);
+        return false;
+    }
+    return true;
+}
+
+/* ---- Delta patch header vs running image ---- */
+bool OtaServiceImpl::checkPatch(uint32_t& dstSize, uint32_t& dstCrc32)
+{
+    FIL f;
+    if (f_open(&f, OTA_PATCH_FILENAME, FA_READ) != FR_OK) return false;
+
+    ota_delta_header_t hdr;
+    UINT br = 0;
+    FRESULT res = f_read(&f, &hdr, sizeof(hdr), &br);
+    f_close(&f);
+
+    if (res != FR_OK || br != sizeof(hdr) || ota_delta_check_header(&hdr) != OTA_DELTA_OK) {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_DELTA_BAD_PATCH);
+        return false;
+    }
+
+    /* Same check the bootloader repeats — catches a patch for another
+     * build before the reset instead of after */
+    uint32_t crc = ~crc32_calc(0xFFFFFFFF, mImageBase, hdr.src_size);
+    if (crc != hdr.src_crc32) {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_DELTA_WRONG_BASE, crc);
+        return false;
+    }
+
+    dstSize = hdr.dst_size;
+    dstCrc32 = hdr.dst_crc32;
+    return true;
+}
+
 /* ---- HTTP GET ---- */
 bool OtaServiceImpl::httpGet(const char* host, uint16_t port, const char* path)
 {
     Esp8266& esp = *input.esp;
 
-    /* Close any existing connection */
-    esp.sendCmd("AT+CIPCLOSE", "OK", 1000);
-    vTaskDelay(pdMS_TO_TICKS(200));
-
-    /* SSL/TLS connect (prevents MITM on firmware download) */
-    char cmd[128];
-    snprintf(cmd, sizeof(cmd), "AT+CIPSTART=\"SSL\",\"%s\",%u", host, port);
-    if (!esp.sendCmd(cmd, "OK", 10000)) {
+    /* SSL/TLS connect (prevents MITM on firmware download). Fails at once
+     * while an upload holds the HTTP link. */
+    if (!esp.linkOpen(Esp8266::LINK_HTTP, "SSL", host, port, 10000)) {
         LOG_E(ats::ErrorSource::Ota, evt::OTA_TCP_FAIL);
         return false;
     }
@@ -118,47 +199,75 @@ bool OtaServiceImpl::httpGet(const char* host, uint16_t port, const char* path)
         "\r\n",
         path, host);
 
-    /* Send via AT+CIPSEND */
-    snprintf(cmd, sizeof(cmd), "AT+CIPSEND=%d", reqLen);
-    if (!esp.sendCmd(cmd, ">", 2000)) {
-        LOG_E(ats::ErrorSource::Ota, evt::OTA_CIPSEND_FAIL);
-        return false;
-    }
-
-    esp.sendData((const uint8_t*)req, reqLen, 2000);
-    if (!esp.waitFor("SEND OK", 5000)) {
+    /* AT+CIPSEND=1,<len> → request → SEND OK */
+    if (!esp.linkSend(Esp8266::LINK_HTTP, (const uint8_t*)req, (uint16_t)reqLen, 5000)) {
         LOG_E(ats::ErrorSource::Ota, evt::OTA_SEND_FAIL);
+        esp.linkClose(Esp8266::LINK_HTTP);
         return false;
     }
-
-    /* Enable IPD passthrough for large chunk handling */
-    esp.setIpdPassthrough(true);
-    esp.clearRx();
-
     return true;
 }
 
 /* ---- Receive HTTP response → file ---- */
-bool OtaServiceImpl::receiveToFile(uint32_t expectedSize)
+bool OtaServiceImpl::receiveToFile(uint32_t expectedSize, const char* filename)
 {
     Esp8266& esp = *input.esp;
     FIL f;
 
-    /* Open firmware.bin for writing */
-    if (f_open(&f, OTA_FW_FILENAME, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+    /* Open firmware.bin (or fw_patch.bin) for writing */
+    if (f_open(&f, filename, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
         LOG_E(ats::ErrorSource::Ota, evt::OTA_FILE_CREATE_FAIL);
         return false;
     }
 
+    /* Headers first, then the same buffer carries body pieces */
+    uint8_t buf[320];
+    char* head = reinterpret_cast<char*>(buf);
+    uint16_t headLen = 0;
+    if (!esp.linkRecvUntil(Esp8266::LINK_HTTP, head, sizeof(buf), headLen,
+                           "\r\n\r\n", 10000)) {
+        if (headLen + 1 >= sizeof(buf)) {
+            LOG_E(ats::ErrorSource::Ota, evt::OTA_HDR_TOO_LARGE);
+        } else if (esp.linkClosed(Esp8266::LINK_HTTP)) {
+            LOG_W(ats::ErrorSource::Ota, evt::OTA_CONN_CLOSED, 0u);
+        } else {
+            LOG_E(ats::ErrorSource::Ota, evt::OTA_DATA_TIMEOUT, 0u);
+        }
+        f_close(&f);
+        return false;
+    }
+
+    /* Check HTTP status */
+    if (headLen < 12 || memcmp(head, "HTTP/1.", 7) != 0) {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_NOT_HTTP);
+        f_close(&f);
+        return false;
+    }
+
+    /* Find status code (after "HTTP/1.x ") */
+    const char* status = head + 9;
+    if (status[0] != '2') {
+        LOG_E(ats::ErrorSource::Ota, evt::OTA_HTTP_ERROR, (uint32_t)(status[0] - '0') * 100 + (status[1] - '0') * 10 + (status[2] - '0'));
+        f_close(&f);
+        return false;
+    }
+
+    /* Body bytes that came in with the headers */
     uint32_t bytesWritten = 0;
-    bool headersParsed = false;
-    uint32_t noDataCount = 0;
+    const char* bodyStart = strstr(head, "\r\n\r\n") + 4;
+    uint16_t bodyLen = headLen - (uint16_t)(bodyStart - head);
+    if (bodyLen > 0) {
+        UINT bw;
+        f_write(&f, bodyStart, bodyLen, &bw);
+        bytesWritten += bw;
+    }
 
+    uint32_t nextLog = 10240;
+    uint32_t noDataCount = 0;
     while (bytesWritten < expectedSize) {
-        /* Wait for +IPD frame */
-        if (!esp.waitFor("+IPD,", 10000)) {
-            /* Check for CLOSED (server done) */
-            if (esp.responseContains("CLOSED")) {
+        if (!esp.linkWait(Esp8266::LINK_HTTP, 10000)) {
+            /* Server done (Connection: close) */
+            if (esp.linkClosed(Esp8266::LINK_HTTP)) {
                 LOG_W(ats::ErrorSource::Ota, evt::OTA_CONN_CLOSED, bytesWritten);
                 break;
             }
@@ -172,89 +281,10 @@ bool OtaServiceImpl::receiveToFile(uint32_t expectedSize)
         }
         noDataCount = 0;
 
-        /* Parse +IPD,<len>:<data> from mRxBuf */
-        const char* buf = esp.getResponse();
-        uint16_t bufLen = esp.getResponseLen();
-
-        /* Find +IPD, in buffer */
-        const char* ipd = nullptr;
-        for (uint16_t i = 0; i + 5 <= bufLen; i++) {
-            if (memcmp(buf + i, "+IPD,", 5) == 0) {
-                ipd = buf + i;
-                break;
-            }
-        }
-        if (!ipd) {
-            esp.clearRx();
-            continue;
-        }
-
-        /* Parse length */
-        uint32_t ipdLen = 0;
-        const char* p = ipd + 5;
-        while (*p >= '0' && *p <= '9') {
-            ipdLen = ipdLen * 10 + (*p - '0');
-            p++;
-        }
-        if (*p != ':' || ipdLen == 0) {
-            esp.clearRx();
-            continue;
-        }
-        p++;  /* Skip ':' */
-
-        const uint8_t* payload = (const uint8_t*)p;
-        uint16_t available = bufLen - (uint16_t)(p - buf);
-        uint16_t dataLen = (available < ipdLen) ? available : (uint16_t)ipdLen;
-
-        if (!headersParsed) {
-            /* First +IPD contains HTTP headers + body start */
-            /* Find \r\n\r\n (end of headers) */
-            const uint8_t* bodyStart = nullptr;
-            for (uint16_t i = 0; i + 4 <= dataLen; i++) {
-                if (payload[i] == '\r' && payload[i+1] == '\n' &&
-                    payload[i+2] == '\r' && payload[i+3] == '\n') {
-                    bodyStart = payload + i + 4;
-                    break;
-                }
-            }
-
-            if (!bodyStart) {
-                /* Headers didn't fit in one +IPD — unlikely for our small GET */
-                LOG_E(ats::ErrorSource::Ota, evt::OTA_HDR_TOO_LARGE);
-                f_close(&f);
-                return false;
-            }
-
-            /* Check HTTP status */
-            if (memcmp(payload, "HTTP/1.", 7) != 0) {
-                LOG_E(ats::ErrorSource::Ota, evt::OTA_NOT_HTTP);
-                f_close(&f);
-                return false;
-            }
-
-            /* Find status code (after "HTTP/1.x ") */
-            const char* status = (const char*)payload + 9;
-            if (status[0] != '2') {
-                LOG_E(ats::ErrorSource::Ota, evt::OTA_HTTP_ERROR, (uint32_t)(status[0] - '0') * 100 + (status[1] - '0') * 10 + (status[2] - '0'));
-                f_close(&f);
-                return false;
-            }
-
-            headersParsed = true;
-
-            /* Write body portion of first chunk */
-            uint16_t bodyLen = dataLen - (uint16_t)(bodyStart - payload);
-            if (bodyLen > 0) {
-                UINT bw;
-                f_write(&f, bodyStart, bodyLen, &bw);
-                bytesWritten += bw;
-            }
-        } else {
-            /* Subsequent +IPDs: pure body data */
-            UINT bw;
-            f_write(&f, payload, dataLen, &bw);
-            bytesWritten += bw;
-        }
+        uint16_t n = esp.linkRead(Esp8266::LINK_HTTP, buf, sizeof(buf));
+        UINT bw;
+        f_write(&f, buf, n, &bw);
+        bytesWritten += bw;
 
         /* Update progress */
         if (expectedSize > 0) {
@@ -262,11 +292,10 @@ bool OtaServiceImpl::receiveToFile(uint32_t expectedSize)
         }
 
         /* Log progress every 10KB */
-        if ((bytesWritten % 10240) < 512) {
+        if (bytesWritten >= nextLog) {
+            nextLog += 10240;
             LOG_D(ats::ErrorSource::Ota, evt::OTA_PROGRESS, bytesWritten);
         }
-
-        esp.clearRx();
     }
 
     f_close(&f);
@@ -277,12 +306,13 @@ bool OtaServiceImpl::receiveToFile(uint32_t expectedSize)
 }
 
 /* ---- CRC-32 verification ---- */
-bool OtaServiceImpl::verifyCrc(uint32_t expectedCrc32, uint32_t fileSize)
+bool OtaServiceImpl::verifyCrc(uint32_t expectedCrc32, uint32_t fileSize,
+                               const char* filename)
 {
     LOG_I(ats::ErrorSource::Ota, evt::OTA_CRC_START);
 
     FIL f;
-    if (f_open(&f, OTA_FW_FILENAME, FA_READ) != FR_OK) return false;
+    if (f_open(&f, filename, FA_READ) != FR_OK) return false;
 
     uint8_t buf[256];
     uint32_t crc = 0xFFFFFFFF;
@@ -306,13 +336,15 @@ bool OtaServiceImpl::verifyCrc(uint32_t expectedCrc32, uint32_t fileSize)
 }
 
 /* ---- Write ota_meta.bin ---- */
-bool OtaServiceImpl::writeOtaMeta(uint32_t fwSize, uint32_t crc32, const char* version)
+bool OtaServiceImpl::writeOtaMeta(uint32_t fwSize, uint32_t crc32, const char* version,
+                                  uint8_t flags)
 {
     ota_meta_t meta;
     memset(&meta, 0, sizeof(meta));
 
     meta.magic = OTA_META_MAGIC;
     meta.version = OTA_META_VERSION;
+    meta.flags = flags;
     meta.fw_size = fwSize;
     meta.crc32 = crc32;
     meta.target_addr = APP_FLASH_BASE;
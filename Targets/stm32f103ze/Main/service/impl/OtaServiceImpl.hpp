@@ -2,6 +2,7 @@
 
 #include "OtaService.hpp"
 #include "Esp8266.hpp"
+#include "ota_header.h"
 
 namespace arcana {
 
@@ -13,6 +14,10 @@ public:
                      const char* path, uint32_t expectedSize,
                      uint32_t expectedCrc32) override;
 
+    bool startDeltaUpdate(const char* host, uint16_t port,
+                          const char* path, uint32_t patchSize,
+                          uint32_t patchCrc32) override;
+
     uint8_t getProgress() const override { return mProgress; }
     bool isActive() const override { return mActive; }
 
@@ -27,13 +32,19 @@ private:
     OtaServiceImpl();
 
     bool httpGet(const char* host, uint16_t port, const char* path);
-    bool receiveToFile(uint32_t expectedSize);
-    bool verifyCrc(uint32_t expectedCrc32, uint32_t fileSize);
-    bool writeOtaMeta(uint32_t fwSize, uint32_t crc32, const char* version);
+    bool receiveToFile(uint32_t expectedSize, const char* filename = OTA_FW_FILENAME);
+    bool verifyCrc(uint32_t expectedCrc32, uint32_t fileSize,
+                   const char* filename = OTA_FW_FILENAME);
+    bool checkPatch(uint32_t& dstSize, uint32_t& dstCrc32);
+    bool writeOtaMeta(uint32_t fwSize, uint32_t crc32, const char* version,
+                      uint8_t flags = 0);
     void setOtaFlag();
+    bool download(const char* host, uint16_t port, const char* path,
+                  uint32_t size, uint32_t crc32, const char* filename);
 
     volatile uint8_t mProgress;
     volatile bool mActive;
+    const uint8_t* mImageBase;   // running App image (patch base)
 };
 
 } // namespace arcana
@@ -16,9 +16,7 @@
 #include <pb_decode.h>
 #include <cstdio>
 #include <cstring>
-extern "C" {
-#include "uECC.h"
-}
+#include "P256.hpp"
 #include "mbedtls/md.h"
 
 namespace arcana {
@@ -273,7 +271,7 @@ bool RegistrationServiceImpl::doRegistration() {
     return true;
 }
 
-// uECC RNG callback — ChaCha20 CSPRNG seeded from hardware entropy
+// P-256 RNG callback — ChaCha20 CSPRNG seeded from hardware entropy
 // Uses the same entropy sources as mbedtls_hardware_poll but with
 // ChaCha20 keystream expansion (already linked, zero extra RAM)
 static int ueccRng(uint8_t* dest, unsigned size) {
@@ -306,13 +304,12 @@ static int ueccRng(uint8_t* dest, unsigned size) {
 bool RegistrationServiceImpl::httpRegister(Esp8266& esp) {
     LOG_I(ats::ErrorSource::Reg, evt::REG_START);
 
-    // --- Generate ephemeral EC P-256 keypair (uECC — lightweight) ---
-    const struct uECC_Curve_t* curve = uECC_secp256r1();
-    uECC_set_rng(ueccRng);
+    // --- Generate ephemeral EC P-256 keypair (fixed-base comb) ---
+    crypto::P256::setRng(ueccRng);
 
-    uint8_t devPriv[32];
-    uint8_t devPub[64];
-    if (!uECC_make_key(devPub, devPriv, curve)) {
+    uint8_t devPriv[crypto::P256::PRIV_SIZE];
+    uint8_t devPub[crypto::P256::PUB_SIZE];
+    if (!crypto::P256::makeKey(devPub, devPriv)) {
         LOG_E(ats::ErrorSource::Reg, 0x0D22);  // keypair gen failed
         return false;
     }
@@ -357,18 +354,16 @@ bool RegistrationServiceImpl::httpRegister(Esp8266& esp) {
     uint16_t frameLen = fIdx;
 
     // --- TCP connect ---
-    char cmd[80];
-    snprintf(cmd, sizeof(cmd), "AT+CIPSTART=\"SSL\",\"%s\",%u", REG_SERVER, REG_PORT);
-    if (!esp.sendCmd(cmd, "OK", 10000)) {
-        if (!esp.responseContains("ALREADY CONNECTED")) {
-            LOG_E(ats::ErrorSource::Reg, evt::REG_TCP_FAIL);
-            return false;
-        }
+    if (!esp.linkOpen(Esp8266::LINK_HTTP, "SSL", REG_SERVER, REG_PORT, 10000)) {
+        LOG_E(ats::ErrorSource::Reg, evt::REG_TCP_FAIL);
+        return false;
     }
     vTaskDelay(pdMS_TO_TICKS(200));
 
     // --- HTTP POST header ---
-    char header[256];
+    // Sized for the reply too (headers + RegisterResponse frame), which
+    // lands here once the request is out
+    char header[448];
     int hLen = snprintf(header, sizeof(header),
         "POST /api/register HTTP/1.1\r\n"
         "Host: %s\r\n"
@@ -378,40 +373,28 @@ bool RegistrationServiceImpl::httpRegister(Esp8266& esp) {
         "\r\n",
         REG_SERVER, frameLen);
 
-    // Send header + body
-    uint16_t totalLen = (uint16_t)(hLen + frameLen);
-    char cipsend[24];
-    snprintf(cipsend, sizeof(cipsend), "AT+CIPSEND=%u", totalLen);
-    if (!esp.sendCmd(cipsend, ">", 3000)) {
-        LOG_E(ats::ErrorSource::Reg, evt::REG_CIPSEND_FAIL);
-        esp.sendCmd("AT+CIPCLOSE", "OK", 1000);
-        return false;
-    }
-
-    esp.sendData(reinterpret_cast<const uint8_t*>(header), hLen, 3000);
-    esp.sendData(frame, frameLen, 3000);
-
-    if (!esp.waitFor("SEND OK", 5000)) {
+    // One gather send: header and frame stay in their own buffers
+    UartTxSeg segs[2] = { { header, (uint16_t)hLen }, { frame, (uint16_t)frameLen } };
+    if (!esp.linkSend(Esp8266::LINK_HTTP, segs, 2, 5000)) {
         LOG_E(ats::ErrorSource::Reg, evt::REG_SEND_FAIL);
-        esp.sendCmd("AT+CIPCLOSE", "OK", 1000);
+        esp.linkClose(Esp8266::LINK_HTTP);
         return false;
     }
 
-    // --- Wait for response (headers + body in separate +IPD chunks) ---
-    esp.clearRx();
-    esp.setIpdPassthrough(true);
-
-    // Wait for server to process + respond (3s) then collect all data
-    vTaskDelay(pdMS_TO_TICKS(4000));
-
-    // Multiple waitFor to drain semaphore for each +IPD chunk
-    for (int i = 0; i < 5; i++) {
-        if (!esp.waitFor("+IPD", 1000)) break;
+    // --- Collect the response (headers + body, any number of +IPD) ---
+    // Connection: close — the server closing the link ends the reply
+    uint8_t* raw = reinterpret_cast<uint8_t*>(header);
+    uint16_t respLen = 0;
+    uint32_t waitStart = xTaskGetTickCount();
+    while (respLen < sizeof(header) &&
+           (xTaskGetTickCount() - waitStart) < pdMS_TO_TICKS(8000)) {
+        if (!esp.linkWait(Esp8266::LINK_HTTP, 1000)) {
+            if (esp.linkClosed(Esp8266::LINK_HTTP)) break;
+            continue;
+        }
+        respLen += esp.linkRead(Esp8266::LINK_HTTP, raw + respLen,
+                                (uint16_t)(sizeof(header) - respLen));
     }
-    vTaskDelay(pdMS_TO_TICKS(500));  // let final IDLE event fire
-
-    const uint8_t* raw = reinterpret_cast<const uint8_t*>(esp.getResponse());
-    uint16_t respLen = esp.getResponseLen();
     LOG_D(ats::ErrorSource::Reg, evt::REG_RESP_BYTES, (uint32_t)respLen);
 
     // Search for FrameCodec magic 0xAC 0xDA 0x01 in response (after HTTP headers)
@@ -430,7 +413,7 @@ bool RegistrationServiceImpl::httpRegister(Esp8266& esp) {
                     found = parseResponse(framePayload, pLen);
                     // If cleartext failed and payload long enough, try encrypted
                     if (!found && pLen > 12) {
-                        uint8_t* enc = const_cast<uint8_t*>(framePayload + 12);
+                        uint8_t* enc = raw + i + 7 + 12;
                         uint16_t encLen = pLen - 12;
                         crypto::ChaCha20::crypt(mDeviceKey, framePayload, 0, enc, encLen);
                         found = parseResponse(enc, encLen);
@@ -446,15 +429,14 @@ bool RegistrationServiceImpl::httpRegister(Esp8266& esp) {
         LOG_W(ats::ErrorSource::Reg, evt::REG_NO_FRAME, (uint32_t)respLen);
     }
 
-    esp.setIpdPassthrough(false);
-    esp.sendCmd("AT+CIPCLOSE", "OK", 1000);
+    esp.linkClose(Esp8266::LINK_HTTP);
 
     if (found && mCreds.valid) {
         // --- ECDH: derive comm_key from shared secret ---
         if (mServerPubLen == 64) {
-            // uECC shared secret: devPriv × serverPub
-            uint8_t shared[32];
-            if (uECC_shared_secret(mServerPub, devPriv, shared, curve)) {
+            // ECDH shared secret: devPriv × serverPub
+            uint8_t shared[crypto::P256::SECRET_SIZE];
+            if (crypto::P256::sharedSecret(mServerPub, devPriv, shared)) {
                 { uint32_t sp; memcpy(&sp, shared, 4);
                   LOG_D(ats::ErrorSource::Reg, 0x0D23, sp); }  // shared secret preview
                 // HKDF: comm_key = HMAC(HMAC(device_id, shared), "ARCANA-COMM" + 0x01)
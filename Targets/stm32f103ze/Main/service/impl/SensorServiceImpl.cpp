@@ -8,12 +8,17 @@ SensorServiceImpl::SensorServiceImpl()
     : mDataObs("SensorSvc Data")
     , mSensorData()
     , mMpu()
-    , mTaskBuffer()
-    , mTaskStack{}
-    , mTaskHandle(0)
+    , mBatchObs("SensorSvc Batch")
+    , mBatch()
+    , mPeriodUs(0)
+    , mDrainMs(READ_INTERVAL_MS)
+    , mSequence(0)
+    , mOverflows(0)
+    , mLatest{}
     , mRunning(false)
 {
     output.DataEvents = &mDataObs;
+    output.BatchEvents = &mBatchObs;
 }
 
 SensorServiceImpl::~SensorServiceImpl() {
@@ -33,51 +38,102 @@ ServiceStatus SensorServiceImpl::initHAL() {
 
 ServiceStatus SensorServiceImpl::init() {
     mMpu.init(&I2cBus::getInstance());
+    // No FIFO (chip absent or config rejected): fall back to 1Hz polling
+    if (mMpu.enableFifo(ACCEL_RATE_HZ)) {
+        uint16_t hz = mMpu.sampleRateHz();
+        mPeriodUs = static_cast<uint16_t>(1000000UL / hz);
+        mDrainMs = (uint32_t)SensorBatchModel::MAX_SAMPLES * 750 / hz;
+        if (mDrainMs < MIN_DRAIN_MS) mDrainMs = MIN_DRAIN_MS;
+    }
     return ServiceStatus::OK;
 }
 
 ServiceStatus SensorServiceImpl::start() {
+    if (!input.Acquisition) {
+        return ServiceStatus::InvalidState;
+    }
     mRunning = true;
 
-    mTaskHandle = xTaskCreateStatic(
-        sensorTask,
-        "sensor",
-        TASK_STACK_SIZE,
-        this,
-        tskIDLE_PRIORITY + 2,
-        mTaskStack,
-        &mTaskBuffer
-    );
-
-    if (!mTaskHandle) return ServiceStatus::Error;
-    return ServiceStatus::OK;
+    bool ok;
+    if (mMpu.fifoEnabled()) {
+        AcqPlan drain = { drainPlan, this, mDrainMs, 0, MAX_BATCHES_PER_WAKE };
+        AcqPlan snapshot = { snapshotPlan, this, READ_INTERVAL_MS, SNAPSHOT_PHASE_MS, 1 };
+        ok = input.Acquisition->addPlan(drain) && input.Acquisition->addPlan(snapshot);
+    } else {
+        AcqPlan poll = { pollPlan, this, READ_INTERVAL_MS, POLL_PHASE_MS, 1 };
+        ok = input.Acquisition->addPlan(poll);
+    }
+
+    return ok ? ServiceStatus::OK : ServiceStatus::Error;
 }
 
 void SensorServiceImpl::stop() {
     mRunning = false;
 }
 
-void SensorServiceImpl::sensorTask(void* param) {
-    SensorServiceImpl* self = static_cast<SensorServiceImpl*>(param);
+AcqStatus SensorServiceImpl::drainPlan(void* ctx, const AcqSlot& slot) {
+    return static_cast<SensorServiceImpl*>(ctx)->drainFifo(slot);
+}
 
-    vTaskDelay(pdMS_TO_TICKS(100));
+AcqStatus SensorServiceImpl::snapshotPlan(void* ctx, const AcqSlot& slot) {
+    return static_cast<SensorServiceImpl*>(ctx)->publishSnapshot(slot);
+}
 
-    while (self->mRunning) {
-        Mpu6050Reading reading = self->mMpu.read();
+AcqStatus SensorServiceImpl::pollPlan(void* ctx, const AcqSlot& slot) {
+    return static_cast<SensorServiceImpl*>(ctx)->poll(slot);
+}
 
-        if (reading.valid) {
-            self->mSensorData.temperature = reading.temperature;
-            self->mSensorData.accelX = reading.accelX;
-            self->mSensorData.accelY = reading.accelY;
-            self->mSensorData.accelZ = reading.accelZ;
-            self->mSensorData.updateTimestamp();
-            self->mDataObs.publish(&self->mSensorData);
-        }
+AcqStatus SensorServiceImpl::drainFifo(const AcqSlot& slot) {
+    if (!mRunning) return AcqStatus::Done;
 
-        vTaskDelay(pdMS_TO_TICKS(READ_INTERVAL_MS));
-    }
+    SensorBatchModel& batch = mBatch;
+    Mpu6050FifoRead r = mMpu.readFifo(&batch.accel[0][0], SensorBatchModel::MAX_SAMPLES);
+    if (r.overflow) mOverflows++;
+    if (!r.ok) return AcqStatus::Error;
+    if (r.frames == 0) return AcqStatus::Done;
+
+    batch.count = static_cast<uint8_t>(r.frames);
+    batch.periodUs = mPeriodUs;
+    batch.sequence = mSequence;
+    batch.overflows = mOverflows;
+    // Newest sample was taken as the read started, less what is still queued
+    batch.timestamp = slot.stampMs - ((uint32_t)r.pending * mPeriodUs) / 1000;
+
+    mSequence += r.frames;
+    for (uint8_t i = 0; i < 3; i++) mLatest[i] = batch.accel[r.frames - 1][i];
+    // Observers run here and must copy what they keep
+    mBatchObs.notify(&batch);
+
+    return r.pending ? AcqStatus::More : AcqStatus::Done;
+}
+
+AcqStatus SensorServiceImpl::publishSnapshot(const AcqSlot& slot) {
+    if (!mRunning) return AcqStatus::Done;
+
+    float temperature;
+    if (!mMpu.readTemperature(&temperature)) return AcqStatus::Error;
+    mSensorData.temperature = temperature;
+    mSensorData.accelX = mLatest[0];
+    mSensorData.accelY = mLatest[1];
+    mSensorData.accelZ = mLatest[2];
+    mSensorData.timestamp = slot.stampMs;
+    mDataObs.publish(&mSensorData);
+    return AcqStatus::Done;
+}
+
+AcqStatus SensorServiceImpl::poll(const AcqSlot& slot) {
+    if (!mRunning) return AcqStatus::Done;
+
+    Mpu6050Reading reading = mMpu.read();
+    if (!reading.valid) return AcqStatus::Error;
 
-    vTaskDelete(0);
+    mSensorData.temperature = reading.temperature;
+    mSensorData.accelX = reading.accelX;
+    mSensorData.accelY = reading.accelY;
+    mSensorData.accelZ = reading.accelZ;
+    mSensorData.timestamp = slot.stampMs;
+    mDataObs.publish(&mSensorData);
+    return AcqStatus::Done;
 }
 
 } // namespace sensor
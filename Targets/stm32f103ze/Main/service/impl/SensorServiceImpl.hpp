@@ -2,8 +2,6 @@
 
 #include "SensorService.hpp"
 #include "Mpu6050Sensor.hpp"
-#include "FreeRTOS.h"
-#include "task.h"
 
 namespace arcana {
 namespace sensor {
@@ -18,7 +16,7 @@ public:
     void stop() override;
 
 private:
-    /* Test access — host gtest fixture drives the static sensorTask. */
+    /* Test access — host gtest fixture drives the sampling plans. */
     friend struct SensorServiceTestAccess;
 
     SensorServiceImpl();
@@ -26,18 +24,44 @@ private:
     SensorServiceImpl(const SensorServiceImpl&);
     SensorServiceImpl& operator=(const SensorServiceImpl&);
 
-    static void sensorTask(void* param);
+    // Sampling plans, run from the acquisition task
+    static AcqStatus drainPlan(void* ctx, const AcqSlot& slot);
+    static AcqStatus snapshotPlan(void* ctx, const AcqSlot& slot);
+    static AcqStatus pollPlan(void* ctx, const AcqSlot& slot);
+
+    /** One FIFO burst-read handed downstream as a batch */
+    AcqStatus drainFifo(const AcqSlot& slot);
+    /** 1Hz SensorDataModel: temperature + newest accel sample */
+    AcqStatus publishSnapshot(const AcqSlot& slot);
+    /** No FIFO: 1Hz accel + temperature register read */
+    AcqStatus poll(const AcqSlot& slot);
 
     static const uint32_t READ_INTERVAL_MS = 1000;
-    static const uint16_t TASK_STACK_SIZE = 256;
+    // Snapshot sits between drains; first poll waits out the MPU6050 wake
+    static const uint32_t SNAPSHOT_PHASE_MS = 50;
+    static const uint32_t POLL_PHASE_MS = 100;
+
+    // FIFO mode: 100Hz-1kHz. Drained when a batch is ~3/4 full, leaving
+    // slack for the other plans on the bus
+    static const uint16_t ACCEL_RATE_HZ = 200;
+    static const uint32_t MIN_DRAIN_MS = 10;
+    // Burst length: catch-up bound after a late release (FIFO holds 170 samples)
+    static const uint8_t MAX_BATCHES_PER_WAKE = 6;
 
     Observable<SensorDataModel> mDataObs;
     SensorDataModel mSensorData;
     Mpu6050Sensor mMpu;
 
-    StaticTask_t mTaskBuffer;
-    StackType_t mTaskStack[TASK_STACK_SIZE];
-    TaskHandle_t mTaskHandle;
+    // Batches go out with notify(), not the dispatcher: one buffer, and up
+    // to 40 bursts/s stay out of the shared 8-slot queue
+    Observable<SensorBatchModel> mBatchObs;
+    SensorBatchModel mBatch;
+    uint16_t mPeriodUs;
+    uint32_t mDrainMs;
+    uint32_t mSequence;
+    uint16_t mOverflows;
+    int16_t mLatest[3];
+
     bool mRunning;
 };
 
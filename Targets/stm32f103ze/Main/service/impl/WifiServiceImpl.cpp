@@ -97,6 +97,12 @@ bool WifiServiceImpl::resetAndConnect() {
         LOG_D(ats::ErrorSource::Wifi, evt::WIFI_VERSION);
     }
 
+    // Multi-connection mode: MQTT, upload and syslog each get a link id
+    if (!mEsp.enableMux()) {
+        LOG_W(ats::ErrorSource::Wifi, evt::WIFI_MUX_FAIL);
+        return false;
+    }
+
     return connectWifi();
 }
 
@@ -154,6 +160,8 @@ bool WifiServiceImpl::syncNtp() {
     vTaskDelay(pdMS_TO_TICKS(2000));
 
     for (int i = 0; i < 5; i++) {
+        // Hold the AT lock while parsing: MQTT/upload tasks share mRxBuf
+        Esp8266::AtLock lock(mEsp);
         if (mEsp.sendCmd("AT+CIPSNTPTIME?", "OK", 3000)) {
             // Response: +CIPSNTPTIME:Mon Mar 18 13:45:00 2026
             // Parse year to check if valid (not 1970)
@@ -213,13 +221,11 @@ bool WifiServiceImpl::applyNtpEpoch(uint32_t epoch) {
 // --- IP geolocation for timezone auto-detect ---
 
 bool WifiServiceImpl::detectTimezone(int16_t& offsetMinutes) {
-    // Open TCP to ip-api.com (free, no key, 45 req/min)
-    if (!mEsp.sendCmd("AT+CIPSTART=\"TCP\",\"ip-api.com\",80", "OK", 5000)) {
-        if (!mEsp.responseContains("ALREADY CONNECTED")) {
-            return false;
-        }
+    // TCP to ip-api.com (free, no key, 45 req/min) on the upload link:
+    // runs before MQTT/upload start, so the link is free
+    if (!mEsp.linkOpen(Esp8266::LINK_HTTP, "TCP", "ip-api.com", 80, 5000)) {
+        return false;
     }
-    vTaskDelay(pdMS_TO_TICKS(200));
 
     // HTTP GET — fields=offset returns {"offset":<seconds>}
     static const char httpReq[] =
@@ -228,29 +234,26 @@ bool WifiServiceImpl::detectTimezone(int16_t& offsetMinutes) {
         "Connection: close\r\n\r\n";
     const uint16_t reqLen = sizeof(httpReq) - 1;
 
-    char cipsend[24];
-    snprintf(cipsend, sizeof(cipsend), "AT+CIPSEND=%u", reqLen);
-    if (!mEsp.sendCmd(cipsend, ">", 3000)) {
-        mEsp.sendCmd("AT+CIPCLOSE", "OK", 1000);
+    if (!mEsp.linkSend(Esp8266::LINK_HTTP,
+                       reinterpret_cast<const uint8_t*>(httpReq), reqLen, 3000)) {
+        mEsp.linkClose(Esp8266::LINK_HTTP);
         return false;
     }
 
-    mEsp.sendData(reinterpret_cast<const uint8_t*>(httpReq), reqLen, 3000);
-
-    // Wait for response (ip-api typically responds in <500ms)
-    vTaskDelay(pdMS_TO_TICKS(2000));
-    if (!mEsp.waitFor("\"offset\"", 5000)) {
-        mEsp.sendCmd("AT+CIPCLOSE", "OK", 1000);
-        return false;
-    }
+    // Headers + {"offset":28800}; ip-api typically responds in <500ms
+    char resp[320];
+    uint16_t len = 0;
+    resp[0] = '\0';
+    bool found = mEsp.linkRecvUntil(Esp8266::LINK_HTTP, resp, sizeof(resp), len,
+                                    "\"offset\"", 5000);
+    // Rest of the number may trail the key in a later segment
+    if (found) mEsp.linkRecvUntil(Esp8266::LINK_HTTP, resp, sizeof(resp), len, "}", 1000);
+    mEsp.linkClose(Esp8266::LINK_HTTP);
+    if (!found) return false;
 
     // Parse: {"offset":28800} or {"offset":-18000}
-    const char* resp = mEsp.getResponse();
     const char* p = strstr(resp, "\"offset\":");
-    if (!p) {
-        mEsp.sendCmd("AT+CIPCLOSE", "OK", 1000);
-        return false;
-    }
+    if (!p) return false;
     p += 9;  // skip "offset":
 
     bool negative = false;
@@ -263,8 +266,6 @@ bool WifiServiceImpl::detectTimezone(int16_t& offsetMinutes) {
     }
     if (negative) offsetSec = -offsetSec;
 
-    mEsp.sendCmd("AT+CIPCLOSE", "OK", 1000);
-
     offsetMinutes = static_cast<int16_t>(offsetSec / 60);
     return true;
 }
@@ -1,26 +1,40 @@
 #include "Hc08Ble.hpp"
+#include "task.h"
 #include "Log.hpp"
 #include "EventCodes.hpp"
 #include <cstring>
 
 // Global USART2 handle for IRQ handler
 static UART_HandleTypeDef sHuart2;
+// USART2_RX is the fixed DMA1 Channel6 request
+static DMA_HandleTypeDef sHdmaRx;
 
-// USART2 IRQ handler (C linkage)
+// USART2 IRQ handler (C linkage) — RX bytes arrive by DMA
 extern "C" void USART2_IRQHandler(void) {
     uint32_t sr = sHuart2.Instance->SR;
 
-    // RXNE — byte received
-    if (sr & USART_SR_RXNE) {
-        uint8_t byte = (uint8_t)(sHuart2.Instance->DR & 0xFF);
-        arcana::Hc08Ble::getInstance().isr_onRxByte(byte);
+    if (sr & (USART_SR_IDLE | USART_SR_ORE)) {
+        (void)sHuart2.Instance->DR;  // clear IDLE/ORE by reading DR
+    }
+
+    // ORE — a byte arrived before the DMA took the previous one
+    if (sr & USART_SR_ORE) {
+        arcana::Hc08Ble::getInstance().isr_onOverrun();
     }
 
     // IDLE — line idle after reception (frame complete)
     if (sr & USART_SR_IDLE) {
-        (void)sHuart2.Instance->DR;  // clear IDLE flag by reading DR
         arcana::Hc08Ble::getInstance().isr_onIdle();
     }
+
+    // TXE — next byte of a send (TXEIE is only set while one is in flight)
+    if ((sr & USART_SR_TXE) && (sHuart2.Instance->CR1 & USART_CR1_TXEIE)) {
+        arcana::Hc08Ble::getInstance().isr_onTxe();
+    }
+}
+
+extern "C" void DMA1_Channel6_IRQHandler(void) {
+    HAL_DMA_IRQHandler(&sHdmaRx);
 }
 
 namespace arcana {
@@ -29,8 +43,8 @@ Hc08Ble::Hc08Ble()
     : mAtBuf{}
     , mAtLen(0)
     , mRingBuf{}
-    , mRingWr(0)
-    , mRingRd(0)
+    , mRx(mRingBuf, RX_RING_SIZE)
+    , mTx()
     , mAssembler()
     , mRxSem(0)
     , mRxSemBuf()
@@ -65,6 +79,10 @@ void Hc08Ble::initGpio() {
     HAL_GPIO_Init(GPIOA, &gpio);
 }
 
+static void rxDmaEvent(void* ctx) {
+    static_cast<Hc08Ble*>(ctx)->isr_onRxDma();
+}
+
 void Hc08Ble::initUsart() {
     sHuart2.Instance = USART2;
     sHuart2.Init.BaudRate = 9600;
@@ -76,12 +94,20 @@ void Hc08Ble::initUsart() {
     sHuart2.Init.OverSampling = UART_OVERSAMPLING_16;
     HAL_UART_Init(&sHuart2);
 
-    // Enable RXNE + IDLE interrupts
-    __HAL_UART_ENABLE_IT(&sHuart2, UART_IT_RXNE);
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    sHdmaRx.Instance = DMA1_Channel6;
+    mRx.start(&sHuart2, &sHdmaRx, rxDmaEvent, this);
+    mTx.start(&sHuart2, nullptr);
+
+    // IDLE ends a frame; ERR reports ORE while DMAR is set
     __HAL_UART_ENABLE_IT(&sHuart2, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&sHuart2, UART_IT_ERR);
 
+    // Same priority for both: one ISR-side ring reader at a time
     HAL_NVIC_SetPriority(USART2_IRQn, 6, 0);
     HAL_NVIC_EnableIRQ(USART2_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
 }
 
 bool Hc08Ble::initHAL() {
@@ -116,26 +142,33 @@ bool Hc08Ble::initHAL() {
 // ISR callbacks
 // ---------------------------------------------------------------------------
 
-void Hc08Ble::isr_onRxByte(uint8_t byte) {
+void Hc08Ble::drainAt() {
+    for (;;) {
+        UartRxSpan span = mRx.span();
+        if (span.len == 0) break;
+        uint16_t len = mAtLen;
+        uint16_t room = AT_BUF_SIZE - 1 - len;
+        uint16_t n = span.len < room ? span.len : room;
+        memcpy(mAtBuf + len, span.data, n);
+        mAtLen = len + n;
+        mAtBuf[mAtLen] = '\0';
+        mRx.consume(span.len);   // past a full buffer → dropped
+    }
+}
+
+void Hc08Ble::isr_onRxDma() {
     if (mDataMode) {
-        // Data mode: push into ring buffer
-        uint16_t next = (mRingWr + 1) & (RX_RING_SIZE - 1);
-        if (next != mRingRd) {
-            mRingBuf[mRingWr] = byte;
-            mRingWr = next;
-        }
-        // Full → drop byte (backpressure)
-    } else {
-        // AT mode: linear buffer
-        if (mAtLen < AT_BUF_SIZE - 1) {
-            mAtBuf[mAtLen] = byte;
-            mAtLen = mAtLen + 1;
-            mAtBuf[mAtLen] = '\0';
-        }
+        // Continuous stream without an IDLE gap: wake the task every half ring
+        isr_onIdle();
+        return;
     }
+    drainAt();
 }
 
 void Hc08Ble::isr_onIdle() {
+    mRx.isr_update();
+    if (!mDataMode) drainAt();
+
     BaseType_t woken = pdFALSE;
     if (mRxSem) {
         xSemaphoreGiveFromISR(mRxSem, &woken);
@@ -148,15 +181,27 @@ void Hc08Ble::isr_onIdle() {
 // ---------------------------------------------------------------------------
 
 bool Hc08Ble::processRxRing() {
-    while (mRingRd != mRingWr) {
-        uint8_t b = mRingBuf[mRingRd];
-        mRingRd = (mRingRd + 1) & (RX_RING_SIZE - 1);
-
-        if (mAssembler.feedByte(b)) {
-            return true;  // complete frame ready — caller calls getFrame()
+    // Zero-copy: the assembler reads straight out of the DMA ring
+    for (;;) {
+        UartRxSpan span = mRx.span();
+        if (span.len == 0) return false;
+        for (uint16_t i = 0; i < span.len; i++) {
+            if (mAssembler.feedByte(span.data[i])) {
+                mRx.consume(i + 1);
+                return true;  // complete frame ready — caller calls getFrame()
+            }
         }
+        mRx.consume(span.len);
     }
-    return false;
+}
+
+void Hc08Ble::setDataMode(bool dataMode) {
+    if (dataMode == mDataMode) return;
+    // Hands the ring's reader side between ISR and task: start it empty
+    taskENTER_CRITICAL();
+    mRx.flush();
+    mDataMode = dataMode;
+    taskEXIT_CRITICAL();
 }
 
 // ---------------------------------------------------------------------------
@@ -164,6 +209,7 @@ bool Hc08Ble::processRxRing() {
 // ---------------------------------------------------------------------------
 
 bool Hc08Ble::sendCmd(const char* cmd, const char* expect, uint32_t timeoutMs) {
+    mTx.wait(timeoutMs);         // let a send in flight finish first
     mAtLen = 0;
     mAtBuf[0] = '\0';
     xSemaphoreTake(mRxSem, 0);  // clear stale
@@ -184,7 +230,7 @@ uint16_t Hc08Ble::waitForData(uint32_t timeoutMs) {
     if (xSemaphoreTake(mRxSem, pdMS_TO_TICKS(timeoutMs)) == pdTRUE) {
         if (mDataMode) {
             // Return ring buffer pending count
-            return (mRingWr - mRingRd) & (RX_RING_SIZE - 1);
+            return mRx.available();
         }
         return mAtLen;
     }
@@ -192,8 +238,12 @@ uint16_t Hc08Ble::waitForData(uint32_t timeoutMs) {
 }
 
 bool Hc08Ble::send(const uint8_t* data, uint16_t len, uint32_t timeoutMs) {
-    HAL_StatusTypeDef st = HAL_UART_Transmit(&sHuart2, (uint8_t*)data, len, timeoutMs);
-    return st == HAL_OK;
+    UartTxSeg seg = { data, len };
+    return mTx.send(&seg, 1, timeoutMs);
+}
+
+bool Hc08Ble::sendv(const UartTxSeg* segs, uint8_t count, uint32_t timeoutMs) {
+    return mTx.send(segs, count, timeoutMs);
 }
 
 } // namespace arcana
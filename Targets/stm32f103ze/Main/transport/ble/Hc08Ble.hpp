@@ -5,6 +5,8 @@
 #include "semphr.h"
 #include "queue.h"
 #include "FrameAssembler.hpp"
+#include "UartDmaRx.hpp"
+#include "UartDmaTx.hpp"
 #include <cstdint>
 
 namespace arcana {
@@ -12,8 +14,10 @@ namespace arcana {
 /**
  * HC-08 BLE 4.0 driver — USART2 (PA2=TX, PA3=RX) @ 9600 baud.
  *
- * ISR accumulates bytes into a ring buffer.
- * processRxRing() feeds bytes to FrameAssembler and enqueues complete frames.
+ * RX runs on a circular DMA ring (DMA1 Channel6), no per-byte interrupt.
+ * AT mode: IDLE/HT/TC copy the ring into the response buffer.
+ * Data mode: processRxRing() feeds ring spans in place to FrameAssembler.
+ * TX is interrupt-fed from the same gather list the ESP8266 sends by DMA.
  */
 
 /** A complete reassembled frame ready for processing */
@@ -33,9 +37,12 @@ public:
     /** Send AT command (only works when not connected). Returns true if 'expect' found. */
     bool sendCmd(const char* cmd, const char* expect = "OK", uint32_t timeoutMs = 500);
 
-    /** Send raw data bytes to BLE peer */
+    /** Send raw data bytes to BLE peer; the calling task sleeps until they are out */
     bool send(const uint8_t* data, uint16_t len, uint32_t timeoutMs = 200);
 
+    /** Send separate buffers back to back as one stream (no copy) */
+    bool sendv(const UartTxSeg* segs, uint8_t count, uint32_t timeoutMs = 200);
+
     /** Get last response buffer (AT mode only) */
     const char* getResponse() const { return reinterpret_cast<const char*>(mAtBuf); }
     uint16_t getResponseLen() const { return mAtLen; }
@@ -43,6 +50,9 @@ public:
     /** Clear AT response buffer */
     void clearRx() { mAtLen = 0; mAtBuf[0] = '\0'; }
 
+    /** RX DMA ring counters (overruns, peak fill) */
+    const UartDmaRx& rxStats() const { return mRx; }
+
     /** Wait for AT response (blocks until IDLE or timeout). Returns bytes received. */
     uint16_t waitForData(uint32_t timeoutMs);
 
@@ -57,14 +67,20 @@ public:
     uint16_t getFrameLen() const { return mAssembler.getFrameLen(); }
     void resetFrame() { mAssembler.reset(); }
 
-    /** Called from USART2 IRQ — byte received */
-    void isr_onRxByte(uint8_t byte);
-
     /** Called from USART2 IRQ — idle line */
     void isr_onIdle();
 
+    /** Called from the RX DMA half/full-transfer events */
+    void isr_onRxDma();
+
+    /** Called from USART2 IRQ — ORE, a byte the DMA missed */
+    void isr_onOverrun() { mRx.isr_onUartOverrun(); }
+
+    /** Called from USART2 IRQ — TXE while a send is in flight */
+    void isr_onTxe() { mTx.isr_onTxe(); }
+
     /** Set data mode (false = AT mode, true = frame reassembly mode) */
-    void setDataMode(bool dataMode) { mDataMode = dataMode; }
+    void setDataMode(bool dataMode);
     bool isDataMode() const { return mDataMode; }
 
 private:
@@ -75,17 +91,19 @@ private:
 
     void initGpio();
     void initUsart();
+    /** AT mode: copy the ring onto the end of mAtBuf (ISR context) */
+    void drainAt();
 
     // AT mode buffer (used during init)
     static const uint16_t AT_BUF_SIZE = 64;
     uint8_t mAtBuf[AT_BUF_SIZE];
     volatile uint16_t mAtLen;
 
-    // Ring buffer for data mode (ISR writes, task reads)
+    // DMA ring; its reader is the ISR in AT mode, the task in data mode
     static const uint16_t RX_RING_SIZE = 128;  // power of 2
     uint8_t mRingBuf[RX_RING_SIZE];
-    volatile uint16_t mRingWr;
-    uint16_t mRingRd;
+    UartDmaRx mRx;
+    UartDmaTx mTx;
 
     // Frame reassembly
     FrameAssembler mAssembler;
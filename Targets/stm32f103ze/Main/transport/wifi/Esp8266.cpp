@@ -1,48 +1,67 @@
 #include "Esp8266.hpp"
+#include "task.h"
 #include <cstring>
 #include <cstdio>
 
 // Global USART3 handle for IRQ handler
 static UART_HandleTypeDef sHuart3;
+// USART3_RX / USART3_TX are the fixed DMA1 Channel3 / Channel2 requests
+static DMA_HandleTypeDef sHdmaRx;
+static DMA_HandleTypeDef sHdmaTx;
 
-// USART3 IRQ handler (C linkage)
+// USART3 IRQ handler (C linkage) — RX bytes arrive by DMA, only IDLE/ORE here
 extern "C" void USART3_IRQHandler(void) {
     arcana::Esp8266& esp = arcana::Esp8266::getInstance();
 
-    // Check RXNE (byte received)
-    if (__HAL_UART_GET_FLAG(&sHuart3, UART_FLAG_RXNE)) {
-        uint8_t byte = (uint8_t)(sHuart3.Instance->DR & 0xFF);
-        esp.isr_onRxByte(byte);
-    }
-
-    // Check IDLE (line idle = frame complete)
-    if (__HAL_UART_GET_FLAG(&sHuart3, UART_FLAG_IDLE)) {
-        // Clear IDLE flag by reading SR then DR
+    bool overrun = __HAL_UART_GET_FLAG(&sHuart3, UART_FLAG_ORE);
+    bool idle = __HAL_UART_GET_FLAG(&sHuart3, UART_FLAG_IDLE);
+    if (overrun || idle) {
+        // Clear IDLE/ORE by reading SR then DR (DR is empty: DMA took it)
         volatile uint32_t tmp = sHuart3.Instance->SR;
         tmp = sHuart3.Instance->DR;
         (void)tmp;
-        esp.isr_onIdle();
     }
+    if (overrun) esp.isr_onOverrun();
+    // Check IDLE (line idle = frame complete)
+    if (idle) esp.isr_onIdle();
+}
+
+extern "C" void DMA1_Channel3_IRQHandler(void) {
+    HAL_DMA_IRQHandler(&sHdmaRx);
+}
+
+extern "C" void DMA1_Channel2_IRQHandler(void) {
+    HAL_DMA_IRQHandler(&sHdmaTx);
 }
 
 namespace arcana {
 
 Esp8266::Esp8266()
-    : mRxBuf{}
-    , mRxPos(0)
+    : mRxRing{}
+    , mRx(mRxRing, RX_RING_SIZE)
+    , mTx()
+    , mRxBuf{}
     , mRxLen(0)
-    , mMqttBuf{}
-    , mMqttLen(0)
-    , mMqttReady(false)
+    , mDemux()
+    , mLinkQ()
+    , mMqttQueueBuf{}
+    , mHttpQueueBuf{}
+    , mLinkOwner{}
+    , mLinkRxTick{}
+    , mEvents(0)
     , mFrameSemBuf()
     , mFrameSem(0)
+    , mAtMutexBuf()
+    , mAtMutex(0)
     , mInitialized(false)
-    , mIpdPassthrough(false)
-    , mAccessSemBuf()
-    , mAccessSem(0)
-    , mCurrentUser(User::None)
     , mRequestedUser(User::None)
 {
+    mDemux.setTextBuffer(mRxBuf, RX_BUF_SIZE);
+    mLinkQ[LINK_MQTT].init(mMqttQueueBuf, MQTT_QUEUE_SIZE);
+    mLinkQ[LINK_HTTP].init(mHttpQueueBuf, HTTP_QUEUE_SIZE);
+    mDemux.attach(LINK_MQTT, &mLinkQ[LINK_MQTT]);
+    mDemux.attach(LINK_HTTP, &mLinkQ[LINK_HTTP]);
+    // LINK_SYSLOG is send-only: no queue, stray replies are counted as unrouted
 }
 
 Esp8266::~Esp8266() {}
@@ -97,21 +116,40 @@ void Esp8266::initUsart() {
     sHuart3.Init.OverSampling = UART_OVERSAMPLING_16;
     HAL_UART_Init(&sHuart3);
 
-    // Enable RXNE + IDLE interrupts
-    __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_RXNE);
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    sHdmaRx.Instance = DMA1_Channel3;
+    startRx();
+    sHdmaTx.Instance = DMA1_Channel2;
+    mTx.start(&sHuart3, &sHdmaTx);
+
+    // IDLE ends a frame; ERR reports ORE while DMAR is set
     __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_IDLE);
+    __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_ERR);
 
-    // NVIC priority >= 5 for FreeRTOS API safety
+    // NVIC priority >= 5 for FreeRTOS API safety. Same level for both
+    // sources, so the ring and mRxBuf have one writer at a time.
     HAL_NVIC_SetPriority(USART3_IRQn, 6, 0);
     HAL_NVIC_EnableIRQ(USART3_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel2_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+}
+
+static void rxDmaEvent(void* ctx) {
+    static_cast<Esp8266*>(ctx)->isr_onRxDma();
+}
+
+void Esp8266::startRx() {
+    mRx.start(&sHuart3, &sHdmaRx, rxDmaEvent, this);
 }
 
 bool Esp8266::initHAL() {
     mFrameSem = xSemaphoreCreateBinaryStatic(&mFrameSemBuf);
     if (!mFrameSem) return false;
 
-    mAccessSem = xSemaphoreCreateBinaryStatic(&mAccessSemBuf);
-    xSemaphoreGive(mAccessSem);  // start unlocked
+    mAtMutex = xSemaphoreCreateRecursiveMutexStatic(&mAtMutexBuf);
+    if (!mAtMutex) return false;
 
     initGpio();
     initUsart();
@@ -129,18 +167,7 @@ bool Esp8266::speedUp(uint32_t baud) {
     // ESP8266 switches immediately after OK — change STM32 to match
     vTaskDelay(pdMS_TO_TICKS(50));  // let ESP8266 settle
 
-    __HAL_UART_DISABLE_IT(&sHuart3, UART_IT_RXNE);
-    __HAL_UART_DISABLE_IT(&sHuart3, UART_IT_IDLE);
-
-    sHuart3.Init.BaudRate = baud;
-    HAL_UART_Init(&sHuart3);
-
-    __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_RXNE);
-    __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_IDLE);
-
-    mRxPos = 0;
-    mRxLen = 0;
-    mRxBuf[0] = '\0';
+    setBaud(baud);
 
     vTaskDelay(pdMS_TO_TICKS(100));
 
@@ -149,15 +176,18 @@ bool Esp8266::speedUp(uint32_t baud) {
 }
 
 void Esp8266::setBaud(uint32_t baud) {
-    __HAL_UART_DISABLE_IT(&sHuart3, UART_IT_RXNE);
     __HAL_UART_DISABLE_IT(&sHuart3, UART_IT_IDLE);
+    __HAL_UART_DISABLE_IT(&sHuart3, UART_IT_ERR);
+    // Restart the ring: bytes received mid-switch are garbage anyway
+    mRx.stop();
+    mTx.abort();
     sHuart3.Init.BaudRate = baud;
     HAL_UART_Init(&sHuart3);
-    __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_RXNE);
+    startRx();
     __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_IDLE);
-    mRxPos = 0;
-    mRxLen = 0;
-    mRxBuf[0] = '\0';
+    __HAL_UART_ENABLE_IT(&sHuart3, UART_IT_ERR);
+    mDemux.reset();
+    resetRx();
 }
 
 void Esp8266::reset() {
@@ -172,65 +202,62 @@ void Esp8266::reset() {
     vTaskDelay(pdMS_TO_TICKS(2000));  // Wait for ESP8266 boot (AT+UART_DEF=460800)
 
     // Clear any boot messages
-    mRxPos = 0;
-    mRxLen = 0;
-    mRxBuf[0] = '\0';
+    resetLinks();
+    resetRx();
 }
 
-// --- ISR callbacks (called from USART3_IRQHandler) ---
+void Esp8266::resetLinks() {
+    taskENTER_CRITICAL();
+    mDemux.reset();
+    for (uint8_t i = 0; i < LINK_COUNT; i++) {
+        mLinkQ[i].clear();
+        mDemux.setClosed(i, true);
+        mLinkOwner[i] = nullptr;
+    }
+    taskEXIT_CRITICAL();
+}
 
-void Esp8266::isr_onRxByte(uint8_t byte) {
-    if (mRxPos < RX_BUF_SIZE - 1) {
-        mRxBuf[mRxPos] = (char)byte;
-        mRxPos = mRxPos + 1;
-        mRxBuf[mRxPos] = '\0';
+// --- ISR callbacks (USART3 IDLE, DMA1 Channel3 HT/TC) ---
+
+uint8_t Esp8266::drainRx() {
+    // Parsed in place: AT text is copied to mRxBuf, +IPD payload straight
+    // into the link queue, so a payload never passes through mRxBuf
+    uint8_t links = 0;
+    for (;;) {
+        UartRxSpan span = mRx.span();
+        if (span.len == 0) break;
+        links |= mDemux.feed(span.data, span.len);
+        mRx.consume(span.len);
     }
+    return links;
+}
+
+void Esp8266::isr_signalLinks(uint8_t links) {
+    links &= (uint8_t)((1u << LINK_COUNT) - 1);
+    if (links == 0) return;
+    uint32_t now = xTaskGetTickCountFromISR();
+    for (uint8_t i = 0; i < LINK_COUNT; i++) {
+        if (links & (1u << i)) mLinkRxTick[i] = now;
+    }
+    if (!mEvents) return;
+    // Deferred to the timer task; a full timer queue loses only the early
+    // wake, the owner still times out on its next deadline
+    BaseType_t woken = pdFALSE;
+    xEventGroupSetBitsFromISR(mEvents, links, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void Esp8266::isr_onRxDma() {
+    isr_signalLinks(drainRx());
 }
 
 void Esp8266::isr_onIdle() {
-    if (mRxPos == 0) return;
-
-    mRxLen = mRxPos;
-
-    // Check for unsolicited incoming data (+IPD or +MQTTSUBRECV)
-    // Search anywhere in buffer — may arrive appended to AT response (no IDLE gap)
-    if (!mIpdPassthrough) {
-        const char* mqttPos = nullptr;
-        uint16_t mqttOff = 0;
-
-        // Search for +MQTTSUBRECV: or +IPD, anywhere in buffer
-        for (uint16_t i = 0; i + 13 <= mRxLen; i++) {
-            if (mRxBuf[i] == '+') {
-                if (strncmp(mRxBuf + i, "+MQTTSUBRECV:", 13) == 0 ||
-                    strncmp(mRxBuf + i, "+IPD,", 5) == 0) {
-                    mqttPos = mRxBuf + i;
-                    mqttOff = i;
-                    break;
-                }
-            }
-        }
+    mRx.isr_update();
+    isr_signalLinks(drainRx());
 
-        if (mqttPos) {
-            uint16_t dataLen = mRxLen - mqttOff;
-            uint16_t copyLen = dataLen < MQTT_BUF_SIZE - 1 ? dataLen : MQTT_BUF_SIZE - 1;
-            memcpy(mMqttBuf, mqttPos, copyLen);
-            mMqttBuf[copyLen] = '\0';
-            mMqttLen = copyLen;
-            mMqttReady = true;
-
-            // Truncate mRxBuf to keep only the AT response before +MQTTSUBRECV
-            // so sendCmd can still find "OK" / "SEND OK" etc.
-            if (mqttOff > 0) {
-                mRxBuf[mqttOff] = '\0';
-                mRxLen = mqttOff;
-                mRxPos = mqttOff;
-            } else {
-                // Entire buffer is MQTT — clear it
-                mRxPos = 0;
-                mRxBuf[0] = '\0';
-            }
-        }
-    }
+    // Link data is polled by its reader; only AT text wakes sendCmd/waitFor
+    mRxLen = mDemux.textLen();
+    if (mRxLen == 0) return;
 
     // Signal that a complete frame was received
     BaseType_t woken = pdFALSE;
@@ -243,10 +270,12 @@ void Esp8266::isr_onIdle() {
 // --- AT command interface ---
 
 bool Esp8266::sendCmd(const char* cmd, const char* expect, uint32_t timeoutMs) {
+    AtLock lock(*this);
+    // A sendAsync() still going out would interleave with the command
+    mTx.wait(timeoutMs);
+
     // Clear RX buffer
-    mRxPos = 0;
-    mRxLen = 0;
-    mRxBuf[0] = '\0';
+    resetRx();
     // Drain any stale semaphore signals
     xSemaphoreTake(mFrameSem, 0);
 
@@ -281,30 +310,47 @@ bool Esp8266::sendCmd(const char* cmd, const char* expect, uint32_t timeoutMs) {
 }
 
 bool Esp8266::sendData(const uint8_t* data, uint16_t len, uint32_t timeoutMs) {
-    return HAL_UART_Transmit(&sHuart3, const_cast<uint8_t*>(data),
-                              len, timeoutMs) == HAL_OK;
+    UartTxSeg seg = { data, len };
+    return mTx.send(&seg, 1, timeoutMs);
+}
+
+bool Esp8266::sendv(const UartTxSeg* segs, uint8_t count, uint32_t timeoutMs) {
+    return mTx.send(segs, count, timeoutMs);
 }
 
 bool Esp8266::responseContains(const char* str) const {
-    if (mRxPos == 0 || !str) return false;
+    uint16_t textLen = mDemux.textLen();
+    if (textLen == 0 || !str) return false;
     uint16_t slen = strlen(str);
-    if (slen > mRxPos) return false;
-    // Use memcmp instead of strstr to handle embedded null bytes
-    // (binary MQTT data echoed by ESP8266 contains 0x00)
-    for (uint16_t i = 0; i <= mRxPos - slen; i++) {
+    if (slen > textLen) return false;
+    // memcmp, not strstr: a stray NUL must not hide the rest of the text
+    for (uint16_t i = 0; i <= textLen - slen; i++) {
         if (memcmp(mRxBuf + i, str, slen) == 0) return true;
     }
     return false;
 }
 
-void Esp8266::clearRx() {
-    mRxPos = 0;
+void Esp8266::resetRx() {
+    // Masks USART3/DMA1 Channel3 (priority 6): the ring's reader is the ISR
+    // Pending ring bytes may hold link data: parse them, drop only the text
+    taskENTER_CRITICAL();
+    mRx.isr_update();
+    uint8_t links = drainRx();
+    mDemux.clearText();
     mRxLen = 0;
-    mRxBuf[0] = '\0';
+    taskEXIT_CRITICAL();
+    // Link data found here would otherwise wait for the owner's timeout
+    links &= (uint8_t)((1u << LINK_COUNT) - 1);
+    if (links && mEvents) xEventGroupSetBits(mEvents, links);
+}
+
+void Esp8266::clearRx() {
+    resetRx();
     xSemaphoreTake(mFrameSem, 0);  // drain stale signal
 }
 
 bool Esp8266::waitFor(const char* expect, uint32_t timeoutMs) {
+    AtLock lock(*this);
     uint32_t start = xTaskGetTickCount();
     uint32_t remaining = pdMS_TO_TICKS(timeoutMs);
 
@@ -326,19 +372,147 @@ bool Esp8266::waitFor(const char* expect, uint32_t timeoutMs) {
     return responseContains(expect);
 }
 
-// --- Resource lock ---
+// --- AT lock ---
+
+void Esp8266::lockAt() {
+    if (mAtMutex) xSemaphoreTakeRecursive(mAtMutex, portMAX_DELAY);
+}
+
+void Esp8266::unlockAt() {
+    if (mAtMutex) xSemaphoreGiveRecursive(mAtMutex);
+}
+
+// --- Links ---
+
+bool Esp8266::enableMux() {
+    resetLinks();
+    return sendCmd("AT+CIPMUX=1", "OK", 2000);
+}
+
+bool Esp8266::linkOpen(uint8_t link, const char* type, const char* host,
+                       uint16_t port, uint32_t timeoutMs) {
+    if (link >= LINK_COUNT) return false;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    AtLock lock(*this);
+    if (mLinkOwner[link] && mLinkOwner[link] != self) return false;
+    mLinkOwner[link] = self;
+
+    // Stale data and CLOSED from the previous connection
+    mLinkQ[link].clear();
+    mDemux.setClosed(link, false);
+
+    char cmd[96];
+    snprintf(cmd, sizeof(cmd), "AT+CIPSTART=%u,\"%s\",\"%s\",%u",
+             (unsigned)link, type, host, (unsigned)port);
+    if (sendCmd(cmd, "OK", timeoutMs) || responseContains("ALREADY CONNECTED")) {
+        return true;
+    }
+    mLinkOwner[link] = nullptr;
+    return false;
+}
+
+void Esp8266::linkClose(uint8_t link) {
+    if (link >= LINK_COUNT) return;
+    char cmd[20];
+    snprintf(cmd, sizeof(cmd), "AT+CIPCLOSE=%u", (unsigned)link);
 
-void Esp8266::requestAccess(User who) {
-    mRequestedUser = who;
-    // Block until semaphore available (current owner releases)
-    xSemaphoreTake(mAccessSem, portMAX_DELAY);
-    mCurrentUser = who;
-    mRequestedUser = User::None;
+    AtLock lock(*this);
+    sendCmd(cmd, "OK", 2000);
+    mLinkQ[link].clear();
+    mDemux.setClosed(link, true);
+    mLinkOwner[link] = nullptr;
 }
 
-void Esp8266::releaseAccess() {
-    mCurrentUser = User::None;
-    xSemaphoreGive(mAccessSem);
+bool Esp8266::linkSend(uint8_t link, const UartTxSeg* segs, uint8_t count,
+                       uint32_t timeoutMs) {
+    if (!linkSendAsync(link, segs, count)) return false;
+    return linkSendWait(timeoutMs);
+}
+
+bool Esp8266::linkSend(uint8_t link, const uint8_t* data, uint16_t len,
+                       uint32_t timeoutMs) {
+    UartTxSeg seg = { data, len };
+    return linkSend(link, &seg, 1, timeoutMs);
+}
+
+bool Esp8266::linkSendAsync(uint8_t link, const UartTxSeg* segs, uint8_t count) {
+    if (link >= LINK_COUNT) return false;
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++) total += segs[i].len;
+    if (total == 0 || total > LINK_SEND_MAX) return false;
+
+    char cmd[32];
+    snprintf(cmd, sizeof(cmd), "AT+CIPSEND=%u,%lu", (unsigned)link, (unsigned long)total);
+
+    // Held until linkSendWait(): the '>' prompt, data and SEND OK belong
+    // to one transaction
+    lockAt();
+    if (sendCmd(cmd, ">", 2000)) {
+        resetRx();
+        xSemaphoreTake(mFrameSem, 0);
+        if (mTx.submit(segs, count)) return true;
+    }
+    unlockAt();
+    return false;
+}
+
+bool Esp8266::linkSendWait(uint32_t timeoutMs) {
+    bool ok = mTx.wait(timeoutMs) && waitFor("SEND OK", timeoutMs);
+    unlockAt();
+    return ok;
+}
+
+uint16_t Esp8266::linkAvailable(uint8_t link) const {
+    return link < LINK_COUNT ? mLinkQ[link].available() : 0;
+}
+
+uint16_t Esp8266::linkRead(uint8_t link, uint8_t* buf, uint16_t len) {
+    return link < LINK_COUNT ? mLinkQ[link].read(buf, len) : 0;
+}
+
+uint16_t Esp8266::linkPeek(uint8_t link, uint8_t* buf, uint16_t len) const {
+    return link < LINK_COUNT ? mLinkQ[link].peek(buf, len) : 0;
+}
+
+uint16_t Esp8266::linkSkip(uint8_t link, uint16_t len) {
+    return link < LINK_COUNT ? mLinkQ[link].skip(len) : 0;
+}
+
+uint32_t Esp8266::linkDropped(uint8_t link) const {
+    return link < LINK_COUNT ? mLinkQ[link].dropped() : 0;
+}
+
+bool Esp8266::linkWait(uint8_t link, uint32_t timeoutMs) {
+    if (link >= LINK_COUNT) return false;
+    uint32_t start = xTaskGetTickCount();
+    for (;;) {
+        if (mLinkQ[link].available() > 0) return true;
+        if (mDemux.closed(link)) return false;
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeoutMs)) return false;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+bool Esp8266::linkRecvUntil(uint8_t link, char* buf, uint16_t size, uint16_t& len,
+                            const char* expect, uint32_t timeoutMs) {
+    if (link >= LINK_COUNT || size == 0) return false;
+    uint32_t start = xTaskGetTickCount();
+    for (;;) {
+        uint16_t room = (uint16_t)(size - 1 - len);
+        len = (uint16_t)(len + mLinkQ[link].read((uint8_t*)buf + len, room));
+        buf[len] = '\0';
+        // Bodies may hold NULs (binary frames): search by length, not strstr
+        uint16_t elen = strlen(expect);
+        for (uint16_t i = 0; elen <= len && i <= len - elen; i++) {
+            if (memcmp(buf + i, expect, elen) == 0) return true;
+        }
+        if (len + 1 >= size) return false;
+        if (mLinkQ[link].available() > 0) continue;
+        if (mDemux.closed(link)) return false;
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeoutMs)) return false;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
 }
 
 } // namespace arcana
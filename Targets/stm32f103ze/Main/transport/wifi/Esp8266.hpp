@@ -3,6 +3,11 @@
 #include "stm32f1xx_hal.h"
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "event_groups.h"
+#include "task.h"
+#include "UartDmaRx.hpp"
+#include "UartDmaTx.hpp"
+#include "EspLinkDemux.hpp"
 #include <cstdint>
 
 namespace arcana {
@@ -24,9 +29,21 @@ public:
     bool sendCmd(const char* cmd, const char* expect = "OK",
                  uint32_t timeoutMs = 2000);
 
-    // Send raw data bytes
+    // Send raw data bytes (DMA; the calling task sleeps until they are out)
     bool sendData(const uint8_t* data, uint16_t len, uint32_t timeoutMs = 1000);
 
+    /** Send separate buffers back to back as one stream (no copy) */
+    bool sendv(const UartTxSeg* segs, uint8_t count, uint32_t timeoutMs = 1000);
+
+    /**
+     * Start a gather send and return at once. The segments must stay valid
+     * and untouched until waitTx() returns; meanwhile the caller can do
+     * other work (e.g. read the next block from SD).
+     */
+    bool sendAsync(const UartTxSeg* segs, uint8_t count) { return mTx.submit(segs, count); }
+    /** Sleep on the task notification until the sendAsync() data is out */
+    bool waitTx(uint32_t timeoutMs) { return mTx.wait(timeoutMs); }
+
     // Get response buffer after sendCmd
     const char* getResponse() const { return mRxBuf; }
     uint16_t getResponseLen() const { return mRxLen; }
@@ -40,38 +57,127 @@ public:
     // Clear RX buffer (for fresh response after raw data send)
     void clearRx();
 
-    // Called from USART3 IRQ handler - byte received
-    void isr_onRxByte(uint8_t byte);
     // Called from USART3 IRQ handler - idle line detected (frame complete)
     void isr_onIdle();
-
-    // Unsolicited MQTT subscription message buffer
-    bool hasMqttMsg() const { return mMqttReady; }
-    const char* getMqttMsg() const { return mMqttBuf; }
-    uint16_t getMqttMsgLen() const { return mMqttLen; }
-    void clearMqttMsg() { mMqttReady = false; }
-
-    // IPD passthrough mode: +IPD stays in mRxBuf instead of mMqttBuf
-    // Used by OTA download to handle large +IPD chunks
-    void setIpdPassthrough(bool enable) { mIpdPassthrough = enable; }
-    bool isIpdPassthrough() const { return mIpdPassthrough; }
-
-    // --- Resource lock: cooperative ESP8266 sharing ---
+    // Called from the RX DMA half/full-transfer events
+    void isr_onRxDma();
+    // Called from USART3 IRQ handler - ORE: a byte the DMA missed
+    void isr_onOverrun() { mRx.isr_onUartOverrun(); }
+
+    /** RX DMA ring counters (overruns, peak fill) */
+    const UartDmaRx& rxStats() const { return mRx; }
+    /** TX counters (bytes, sends, timeouts) */
+    const UartDmaTx& txStats() const { return mTx; }
+
+    // --- Multi-connection links (AT+CIPMUX=1) ---
+    //
+    // One Wi-Fi association carries several sockets. Incoming +IPD payload
+    // is routed by link id into a per-link queue; AT text keeps going to
+    // the response buffer. Each link has one owner task at a time.
+    enum Link : uint8_t {
+        LINK_MQTT   = 0,  // TLS to the broker, for the whole session
+        LINK_HTTP   = 1,  // registration, timezone, upload, OTA (one at a time)
+        LINK_SYSLOG = 2,  // UDP, send only
+        LINK_COUNT  = 3
+    };
+
+    /** AT+CIPMUX=1 — after every reset, before any link is opened */
+    bool enableMux();
+
+    /**
+     * AT+CIPSTART=<link>,"<type>","<host>",<port>
+     * Fails without a command if another task holds the link.
+     */
+    bool linkOpen(uint8_t link, const char* type, const char* host, uint16_t port,
+                  uint32_t timeoutMs = 10000);
+    /** AT+CIPCLOSE=<link>; drops unread data and frees the link */
+    void linkClose(uint8_t link);
+
+    /** AT+CIPSEND=<link>,<len> → '>' → data → SEND OK, as one AT transaction */
+    bool linkSend(uint8_t link, const UartTxSeg* segs, uint8_t count,
+                  uint32_t timeoutMs = 5000);
+    bool linkSend(uint8_t link, const uint8_t* data, uint16_t len,
+                  uint32_t timeoutMs = 5000);
+
+    /**
+     * Split linkSend(): returns once the data is on the TX DMA, so the
+     * caller can prepare the next block. Holds the AT lock until
+     * linkSendWait(); the segments must stay untouched until then.
+     */
+    bool linkSendAsync(uint8_t link, const UartTxSeg* segs, uint8_t count);
+    /** Wait for the linkSendAsync() data and SEND OK; releases the AT lock */
+    bool linkSendWait(uint32_t timeoutMs);
+
+    uint16_t linkAvailable(uint8_t link) const;
+    uint16_t linkRead(uint8_t link, uint8_t* buf, uint16_t len);
+    uint16_t linkPeek(uint8_t link, uint8_t* buf, uint16_t len) const;
+    uint16_t linkSkip(uint8_t link, uint16_t len);
+    /** Tick of the last payload the ISR routed to the link */
+    uint32_t linkRxTick(uint8_t link) const { return mLinkRxTick[link]; }
+    /** Peer closed the link (<link>,CLOSED); cleared by linkOpen() */
+    bool linkClosed(uint8_t link) const { return mDemux.closed(link); }
+    /** Bytes lost because the link queue was full */
+    uint32_t linkDropped(uint8_t link) const;
+
+    /** Sleep until the link has data; false on timeout or close */
+    bool linkWait(uint8_t link, uint32_t timeoutMs);
+
+    /**
+     * Append link data to buf (NUL-terminated, len bytes so far) until it
+     * contains expect. False on timeout, close or a full buffer.
+     */
+    bool linkRecvUntil(uint8_t link, char* buf, uint16_t size, uint16_t& len,
+                       const char* expect, uint32_t timeoutMs);
+
+    /**
+     * AT command lock. sendCmd() and the link calls take it themselves;
+     * hold it across a command whose response text is parsed afterwards,
+     * so another task's command cannot replace the response buffer.
+     */
+    void lockAt();
+    void unlockAt();
+
+    class AtLock {
+    public:
+        explicit AtLock(Esp8266& esp) : mEsp(esp) { mEsp.lockAt(); }
+        ~AtLock() { mEsp.unlockAt(); }
+    private:
+        AtLock(const AtLock&);
+        AtLock& operator=(const AtLock&);
+        Esp8266& mEsp;
+    };
+
+    // --- Wake-up events for the session task ---
+    //
+    // With a group attached, the driver sets linkEvent(link) when payload
+    // or <link>,CLOSED arrives (from the IDLE/DMA ISR) and EVT_ACCESS on
+    // requestAccessAsync(), so the owner can block instead of polling.
+    static EventBits_t linkEvent(uint8_t link) { return (EventBits_t)1 << link; }
+    static const EventBits_t EVT_ACCESS = (EventBits_t)1 << LINK_COUNT;
+    void setEventGroup(EventGroupHandle_t group) { mEvents = group; }
+
+    // --- Upload request: IoService (KEY2) → MQTT task ---
     enum class User : uint8_t { None, Mqtt, Upload };
 
-    /** Block until ESP8266 access granted. */
-    void requestAccess(User who);
-    /** Non-blocking: signal that a user wants access (MQTT checks and yields). */
-    void requestAccessAsync(User who) { mRequestedUser = who; }
-    /** Release ESP8266 for other users. */
-    void releaseAccess();
-    /** MQTT polls this — true means another user wants the ESP8266. */
-    bool isAccessRequested() const { return mRequestedUser != User::None && mRequestedUser != mCurrentUser; }
+    /** Non-blocking: ask the MQTT task to run an upload alongside MQTT */
+    void requestAccessAsync(User who) {
+        mRequestedUser = who;
+        if (mEvents) xEventGroupSetBits(mEvents, EVT_ACCESS);
+    }
+    /** MQTT task polls this */
+    bool isAccessRequested() const { return mRequestedUser != User::None; }
     /** Clear request after handling. */
     void clearRequest() { mRequestedUser = User::None; }
 
-    static const uint16_t RX_BUF_SIZE = 512;
-    static const uint16_t MQTT_BUF_SIZE = 256;
+    static const uint16_t RX_BUF_SIZE = 256;  // AT text only: payload goes to link queues
+    // HT/TC every 64 bytes: ~1.4ms of slack at 460800 baud
+    static const uint16_t RX_RING_SIZE = 128;
+    // A whole MQTT packet must fit: CONNACK/SUBACK/PUBACK and commands
+    static const uint16_t MQTT_QUEUE_SIZE = 512;
+    // One full +IPD (TCP MSS 1460) while the reader is busy on SD
+    static const uint16_t HTTP_QUEUE_SIZE = 2048;
+    // AT+CIPSEND limit per transaction
+    static const uint16_t LINK_SEND_MAX = 2048;
 
 private:
     Esp8266();
@@ -79,25 +185,40 @@ private:
 
     void initGpio();
     void initUsart();
+    void startRx();
+    /** Parse what the DMA ring holds: AT text → mRxBuf, +IPD → link queues
+     *  @return bit i set = link i got payload or closed */
+    uint8_t drainRx();
+    /** Stamp and signal the links drainRx() reported (ISR context) */
+    void isr_signalLinks(uint8_t links);
+    /** Parse what is still in the ring, then drop the AT text */
+    void resetRx();
+    /** Link state after an ESP reset: every socket is gone */
+    void resetLinks();
+
+    uint8_t mRxRing[RX_RING_SIZE];
+    UartDmaRx mRx;
+    UartDmaTx mTx;
 
     char mRxBuf[RX_BUF_SIZE];
-    volatile uint16_t mRxPos;    // Current write position in mRxBuf
-    volatile uint16_t mRxLen;    // Length of last complete frame
+    volatile uint16_t mRxLen;    // AT text length at the last IDLE
 
-    char mMqttBuf[MQTT_BUF_SIZE];
-    volatile uint16_t mMqttLen;
-    volatile bool mMqttReady;
+    EspLinkDemux mDemux;
+    LinkRxQueue mLinkQ[LINK_COUNT];
+    uint8_t mMqttQueueBuf[MQTT_QUEUE_SIZE];
+    uint8_t mHttpQueueBuf[HTTP_QUEUE_SIZE];
+    TaskHandle_t mLinkOwner[LINK_COUNT];
+    volatile uint32_t mLinkRxTick[LINK_COUNT];
+    EventGroupHandle_t mEvents;   // owner's group, nullptr = nobody waits
 
     StaticSemaphore_t mFrameSemBuf;
     SemaphoreHandle_t mFrameSem;  // Signaled when complete frame received
 
+    StaticSemaphore_t mAtMutexBuf;
+    SemaphoreHandle_t mAtMutex;   // Recursive: link calls nest sendCmd
+
     bool mInitialized;
-    volatile bool mIpdPassthrough;  // When true, +IPD stays in mRxBuf
 
-    // Resource lock state
-    StaticSemaphore_t mAccessSemBuf;
-    SemaphoreHandle_t mAccessSem;
-    volatile User mCurrentUser;
     volatile User mRequestedUser;
 };
 
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace arcana {
+
+/**
+ * Receive FIFO for one ESP8266 link (AT+CIPMUX=1 socket).
+ *
+ * One writer, the USART3 ISR through EspLinkDemux, and one reader task.
+ * Both counters run free: the writer only moves mWritten, the reader only
+ * mRead, so neither needs a lock. Bytes that do not fit are dropped and
+ * counted — for a TCP link that means the stream is broken.
+ */
+class LinkRxQueue {
+public:
+    LinkRxQueue() : mBuf(nullptr), mSize(0), mWritten(0), mRead(0), mDropped(0) {}
+
+    /** size must be a power of two */
+    void init(uint8_t* buf, uint16_t size) {
+        mBuf = buf;
+        mSize = size;
+        mWritten = 0;
+        mRead = 0;
+        mDropped = 0;
+    }
+
+    // --- Writer (ISR) ---
+
+    uint16_t push(const uint8_t* data, uint16_t len) {
+        uint32_t w = mWritten;
+        uint16_t room = (uint16_t)(mSize - (w - mRead));
+        uint16_t n = len < room ? len : room;
+        uint16_t at = (uint16_t)(w & (mSize - 1));
+        uint16_t first = (uint16_t)(mSize - at) < n ? (uint16_t)(mSize - at) : n;
+        memcpy(mBuf + at, data, first);
+        memcpy(mBuf, data + first, n - first);
+        mWritten = w + n;
+        if (n < len) mDropped = mDropped + (len - n);
+        return n;
+    }
+
+    // --- Reader (task) ---
+
+    uint16_t available() const { return (uint16_t)(mWritten - mRead); }
+
+    /** Copy up to len bytes without consuming them */
+    uint16_t peek(uint8_t* out, uint16_t len) const {
+        uint16_t avail = available();
+        uint16_t n = len < avail ? len : avail;
+        uint16_t at = (uint16_t)(mRead & (mSize - 1));
+        uint16_t first = (uint16_t)(mSize - at) < n ? (uint16_t)(mSize - at) : n;
+        memcpy(out, mBuf + at, first);
+        memcpy(out + first, mBuf, n - first);
+        return n;
+    }
+
+    uint16_t read(uint8_t* out, uint16_t len) {
+        uint16_t n = peek(out, len);
+        mRead = mRead + n;
+        return n;
+    }
+
+    /** Drop up to n unread bytes */
+    uint16_t skip(uint16_t n) {
+        uint16_t avail = available();
+        if (n > avail) n = avail;
+        mRead = mRead + n;
+        return n;
+    }
+
+    /** Drop everything unread (reader side: safe against the ISR) */
+    void clear() { mRead = mWritten; }
+
+    uint16_t capacity() const { return mSize; }
+    uint32_t dropped() const { return mDropped; }
+
+private:
+    uint8_t* mBuf;
+    uint16_t mSize;
+    volatile uint32_t mWritten;   // ISR only
+    volatile uint32_t mRead;      // reader only
+    volatile uint32_t mDropped;
+};
+
+/**
+ * Splits the ESP8266 UART stream (AT+CIPMUX=1) into AT text and per-link
+ * payload.
+ *
+ *   "+IPD,<id>,<len>:<len bytes>"  → queue attached to <id>
+ *   "+IPD,<len>:<len bytes>"       → link 0 (single-connection firmware)
+ *   "<id>,CLOSED"                  → closed(<id>) set
+ *   anything else                  → text buffer (sendCmd / waitFor)
+ *
+ * A stream parser, not a frame scanner: a header or payload may be split
+ * across any number of feed() calls (DMA half/full events, IDLE), and AT
+ * text before and after a payload stays in order in the text buffer.
+ * feed() runs in the USART3 / DMA ISR; the text and closed accessors are
+ * for the task side.
+ */
+class EspLinkDemux {
+public:
+    static const uint8_t MAX_LINKS = 5;      // AT firmware link ids 0-4
+    static const uint16_t MAX_IPD = 2920;    // two TCP segments
+
+    EspLinkDemux()
+        : mText(nullptr), mTextSize(0), mTextLen(0), mQueues{}, mClosed{},
+          mState(TEXT), mMatch(0), mField(0), mDigits(0), mHdrLen(0), mNum{},
+          mLink(0), mRemain(0), mLine{}, mLineLen(0),
+          mFramingErrors(0), mUnrouted(0) {}
+
+    /** AT text sink; kept NUL-terminated, bytes past the end are dropped */
+    void setTextBuffer(char* buf, uint16_t size) {
+        mText = buf;
+        mTextSize = size;
+        clearText();
+    }
+
+    void attach(uint8_t link, LinkRxQueue* q) {
+        if (link < MAX_LINKS) mQueues[link] = q;
+    }
+
+    /**
+     * Parse received bytes (ISR).
+     * @return bit per link that received payload or closed
+     */
+    uint8_t feed(const uint8_t* data, uint16_t len) {
+        uint8_t events = 0;
+        uint16_t i = 0;
+        while (i < len) {
+            if (mState == PAYLOAD) {
+                uint16_t n = (uint16_t)(len - i) < mRemain ? (uint16_t)(len - i) : mRemain;
+                LinkRxQueue* q = mLink < MAX_LINKS ? mQueues[mLink] : nullptr;
+                if (q) q->push(data + i, n);
+                else mUnrouted = mUnrouted + n;
+                if (mLink < MAX_LINKS) events |= (uint8_t)(1u << mLink);
+                mRemain = (uint16_t)(mRemain - n);
+                i += n;
+                if (mRemain == 0) mState = TEXT;
+                continue;
+            }
+            char c = (char)data[i++];
+            if (mState == HEADER) header(c);
+            else events |= text(c);
+        }
+        return events;
+    }
+
+    // --- Task side ---
+
+    uint16_t textLen() const { return mTextLen; }
+
+    /** Call with the UART ISR masked */
+    void clearText() {
+        mTextLen = 0;
+        if (mText && mTextSize) mText[0] = '\0';
+    }
+
+    bool closed(uint8_t link) const { return link < MAX_LINKS && mClosed[link]; }
+    void setClosed(uint8_t link, bool closed) {
+        if (link < MAX_LINKS) mClosed[link] = closed;
+    }
+
+    /** Forget a half-parsed header or payload (ESP reset, baud change) */
+    void reset() {
+        mState = TEXT;
+        mMatch = 0;
+        mRemain = 0;
+        mLineLen = 0;
+        clearText();
+    }
+
+    /** "+IPD," headers that did not parse */
+    uint32_t framingErrors() const { return mFramingErrors; }
+    /** Payload bytes for a link with no queue */
+    uint32_t unrouted() const { return mUnrouted; }
+
+private:
+    enum State : uint8_t { TEXT, HEADER, PAYLOAD };
+
+    static const uint8_t IPD_LEN = 5;
+    static char ipd(uint8_t i) { return "+IPD,"[i]; }
+    static const uint8_t LINE_KEEP = 12;
+    static const uint8_t HDR_MAX = 40;      // "<id>,<len>,<ip>,<port>"
+
+    uint8_t text(char c) {
+        if (c == ipd(mMatch)) {
+            if (++mMatch == IPD_LEN) {
+                mMatch = 0;
+                mLineLen = 0;
+                mState = HEADER;
+                mField = 0;
+                mDigits = 0;
+                mHdrLen = 0;
+                mNum[0] = 0;
+                mNum[1] = 0;
+            }
+            return 0;
+        }
+        // Held-back "+IPD" prefix was plain text after all
+        if (mMatch > 0) {
+            uint8_t held = mMatch;
+            mMatch = 0;
+            uint8_t ev = 0;
+            for (uint8_t k = 0; k < held; k++) ev |= emit(ipd(k));
+            if (c == ipd(0)) { mMatch = 1; return ev; }
+            return ev | emit(c);
+        }
+        return emit(c);
+    }
+
+    uint8_t emit(char c) {
+        if (mText && mTextLen + 1u < mTextSize) {
+            mText[mTextLen] = c;
+            mTextLen = mTextLen + 1;
+            mText[mTextLen] = '\0';
+        }
+        // Line tracking for "<id>,CLOSED"
+        if (c == '\n') {
+            uint8_t ev = 0;
+            uint8_t n = mLineLen;
+            if (n == 9 && mLine[8] == '\r') n = 8;
+            if (n == 8 && mLine[0] >= '0' && mLine[0] < '0' + MAX_LINKS &&
+                memcmp(mLine + 1, ",CLOSED", 7) == 0) {
+                uint8_t link = (uint8_t)(mLine[0] - '0');
+                mClosed[link] = true;
+                ev = (uint8_t)(1u << link);
+            }
+            mLineLen = 0;
+            return ev;
+        }
+        if (mLineLen < LINE_KEEP) mLine[mLineLen] = c;
+        if (mLineLen < 0xFF) mLineLen++;
+        return 0;
+    }
+
+    void header(char c) {
+        if (++mHdrLen > HDR_MAX) { framingError(); return; }
+        if (c == ':') {
+            if (mDigits == 0 && mField < 2) { framingError(); return; }
+            uint32_t len = mField == 0 ? mNum[0] : mNum[1];
+            if (len == 0 || len > MAX_IPD) { framingError(); return; }
+            mLink = mField == 0 ? 0 : (uint8_t)mNum[0];
+            mRemain = (uint16_t)len;
+            mState = PAYLOAD;
+            return;
+        }
+        if (mField >= 2) {
+            // AT+CIPDINFO=1 remote ip/port: skipped
+            if (c == '\r' || c == '\n') framingError();
+            return;
+        }
+        if (c >= '0' && c <= '9') {
+            if (++mDigits > 5) { framingError(); return; }
+            mNum[mField] = mNum[mField] * 10 + (uint32_t)(c - '0');
+            return;
+        }
+        if (c == ',' && mDigits > 0) {
+            mField++;
+            mDigits = 0;
+            return;
+        }
+        framingError();
+    }
+
+    void framingError() {
+        mFramingErrors = mFramingErrors + 1;
+        mState = TEXT;
+        mLineLen = 0;
+    }
+
+    char* mText;
+    uint16_t mTextSize;
+    volatile uint16_t mTextLen;
+    LinkRxQueue* mQueues[MAX_LINKS];
+    volatile bool mClosed[MAX_LINKS];
+
+    // Parser state (ISR only)
+    State mState;
+    uint8_t mMatch;       // "+IPD," chars matched so far
+    uint8_t mField;       // header field being parsed
+    uint8_t mDigits;
+    uint8_t mHdrLen;
+    uint32_t mNum[2];
+    uint8_t mLink;
+    uint16_t mRemain;     // payload bytes still to route
+    char mLine[LINE_KEEP];
+    uint8_t mLineLen;
+
+    volatile uint32_t mFramingErrors;
+    volatile uint32_t mUnrouted;
+};
+
+} // namespace arcana
@@ -18,17 +18,55 @@ MainView::MainView()
     , mRenderTaskStack{}
     , mRenderTaskHandle(0)
     , mEcgQueue(0)
+    , mEcgBatch(1)
     , mLcdMutex(0)
     , mRendered()
+#if DISPLAY_FEATURE_COMPOSITOR
+    , mDashboard(*this)
+    , mEcgLayer()
+    , mToastLayer()
+    , mCompositor()
+    , mPainted(0)
+#endif
 {
     input.viewModel = 0;
     input.lcd = 0;
+    input.ecgSampleHz = 0;
+
+#if DISPLAY_FEATURE_COMPOSITOR
+    mCompositor.addLayer(&mDashboard);
+    mCompositor.addLayer(&mEcgLayer);
+    mCompositor.addLayer(&mToastLayer);
+#endif
 }
 
 void MainView::init() {
     mLcdMutex = xSemaphoreCreateMutexStatic(&mLcdMutexBuf);
     mEcgQueue = xQueueCreateStatic(ECG_QUEUE_LEN, 1,
                                     mEcgQueueStorage, &mEcgQueueBuf);
+    beginEcg(input.ecgSampleHz);
+}
+
+void MainView::beginEcg(uint16_t sampleHz) {
+    if (sampleHz == 0) return;      // no ECG source wired: the sweep stays idle
+
+    EcgSweep<1>::Config ecg = {};
+    ecg.x = 0;
+    ecg.y = ECG_TOP_Y;
+    ecg.width = ECG_WIDTH;
+    ecg.height = ECG_HEIGHT;
+    ecg.sampleRateHz = sampleHz;
+    ecg.columnsPerSec = ECG_COLUMNS_HZ;
+    ecg.gap = ECG_GAP;
+    ecg.bg = display::colors::BLACK;
+    ecg.color[0] = display::colors::GREEN;
+    mEcg.begin(ecg);
+
+    // Wake the render task every ECG_BATCH_COLUMNS columns' worth of samples
+    uint32_t batch = (uint32_t)ECG_BATCH_COLUMNS * sampleHz / ECG_COLUMNS_HZ;
+    if (batch < 1) batch = 1;
+    if (batch > ECG_QUEUE_LEN / 2) batch = ECG_QUEUE_LEN / 2;
+    mEcgBatch = (uint8_t)batch;
 }
 
 void MainView::start() {
@@ -42,7 +80,9 @@ void MainView::start() {
 void MainView::pushEcgSample(uint8_t y) {
     if (mEcgQueue) {
         xQueueSend(mEcgQueue, &y, 0);
-        if (mRenderTaskHandle) xTaskNotifyGive(mRenderTaskHandle);
+        if (mRenderTaskHandle && uxQueueMessagesWaiting(mEcgQueue) >= mEcgBatch) {
+            xTaskNotifyGive(mRenderTaskHandle);
+        }
     }
 }
 
@@ -65,28 +105,50 @@ void MainView::processRender() {
     MainViewModel& vm = *input.viewModel;
     display::IDisplay& lcd = *input.lcd;
 
-    // 1. Drain all pending ECG samples → ViewModel → render
+    // 1. Drain all pending ECG samples → ViewModel + sweep
     uint8_t y;
     while (xQueueReceive(mEcgQueue, &y, 0) == pdTRUE) {
-        const LcdOutput& out = vm.output();
-        uint8_t cursor = out.ecgCursor;
-        uint8_t prevY = out.ecgPrevY;
-
         LcdInput in;
         in.type = LcdInput::EcgSample;
         in.ecg.y = y;
         vm.onEvent(in);
 
-        renderEcgColumn(lcd, cursor, y, prevY);
+        uint8_t py = ecgToPixel(y);
+        mEcg.push(&py);
     }
 
-    // 2. Render dirty fields
+#if DISPLAY_FEATURE_COMPOSITOR
+    // 2. New sweep columns become damage on the ECG layer; dirty fields
+    //    become damage on the dashboard layer, repainted from mRendered
+    composeEcg();
+    const LcdOutput& out = vm.output();
+    if (out.dirty) {
+        damageFields(out);
+        mPainted |= (uint8_t)(out.dirty & ~LcdOutput::DIRTY_ECG);
+        mRendered = out;
+        mRendered.dirty = 0;
+        vm.clearDirty();
+    }
+
+    // 3. Toast is the top layer — damaged on show/dismiss only; a trace
+    //    passing under it is composed beneath it in the same tiles
+    display::Rect toast;
+    if (display::toastPoll((uint32_t)xTaskGetTickCount(), lcd.width(), lcd.height(), toast)) {
+        mCompositor.damage(toast);
+    }
+
+    mCompositor.compose(lcd);
+#else
+    // 2. Draw the new sweep columns as strips
+    mEcg.flush(lcd);
+
+    // 3. Render dirty fields
     if (vm.output().dirty) {
         render(lcd, vm.output(), mRendered);
         vm.clearDirty();
     }
 
-    // 3. Toast overlay — single-writer: only render task touches LCD for toast
+    // 4. Toast overlay — single-writer: only render task touches LCD for toast
     {
         bool expired = display::toastUpdate((uint32_t)xTaskGetTickCount());
         if (expired) {
@@ -100,6 +162,7 @@ void MainView::processRender() {
             mRendered.dirty = 0;
         }
     }
+#endif
 
     xSemaphoreGive(mLcdMutex);
 }
@@ -110,7 +173,10 @@ void MainView::processRender() {
 
 void MainView::onEnter(display::IDisplay& lcd) {
     lcd.fillScreen(display::colors::BLACK);
+    drawLabels(lcd);
+}
 
+void MainView::drawLabels(display::IDisplay& lcd) {
     lcd.drawString(30, 4, "Arcana F103", display::colors::WHITE, display::colors::BLACK, 2);
 
     lcd.drawHLine(10, 24, 220, display::colors::DARKGRAY);
@@ -149,9 +215,9 @@ void MainView::renderTemp(display::IDisplay& lcd, const LcdOutput& out, LcdOutpu
     int whole = (int)out.temperature;
     int frac = (int)((out.temperature - whole) * 10);
     if (frac < 0) frac = -frac;
-    snprintf(buf, sizeof(buf), "%d.%d C  ", whole, frac);
+    snprintf(buf, sizeof(buf), "%d.%d C", whole, frac);
+    padField(buf, sizeof(buf), TEMP_FIELD);
 
-    lcd.fillRect(VALUE_X, TEMP_VALUE_Y, 180, 16, display::colors::BLACK);
     lcd.drawString(VALUE_X, TEMP_VALUE_Y, buf, display::colors::YELLOW, display::colors::BLACK, 2);
     rendered.temperature = out.temperature;
     rendered.tempValid = true;
@@ -161,7 +227,7 @@ void MainView::renderSdInfo(display::IDisplay& lcd, const LcdOutput& out, LcdOut
     char buf[28];
     snprintf(buf, sizeof(buf), "%lu / %luMB",
              (unsigned long)out.sdFreeMB, (unsigned long)out.sdTotalMB);
-    lcd.fillRect(VALUE_X, SD_INFO_Y, 200, 8, display::colors::BLACK);
+    padField(buf, sizeof(buf), SD_INFO_FIELD);
     lcd.drawString(VALUE_X, SD_INFO_Y, buf, display::colors::CYAN, display::colors::BLACK, 1);
 
     lcd.drawString(VALUE_X, SD_STATUS_Y, "exFAT Ready", display::colors::GREEN, display::colors::BLACK, 1);
@@ -179,7 +245,7 @@ void MainView::renderStorage(display::IDisplay& lcd, const LcdOutput& out, LcdOu
     uint32ToStr(p, out.totalKB);
     while (*p) p++;
     *p++ = 'K'; *p++ = 'B'; *p++ = ')'; *p = '\0';
-    lcd.fillRect(VAL_X, SD_RECORDS_Y, 160, 8, display::colors::BLACK);
+    padField(buf, sizeof(buf), STORAGE_FIELD);
     lcd.drawString(VAL_X, SD_RECORDS_Y, buf, display::colors::GREEN, display::colors::BLACK, 1);
 
     static const uint16_t RATE_VAL_X = VALUE_X + 36;
@@ -191,7 +257,7 @@ void MainView::renderStorage(display::IDisplay& lcd, const LcdOutput& out, LcdOu
     while (*p) p++;
     *p++ = 'K'; *p++ = 'B'; *p++ = ')';
     *p++ = ' '; *p++ = '/'; *p++ = 's'; *p = '\0';
-    lcd.fillRect(RATE_VAL_X, SD_RATE_Y, 160, 8, display::colors::BLACK);
+    padField(rateBuf, sizeof(rateBuf), STORAGE_FIELD);
     lcd.drawString(RATE_VAL_X, SD_RATE_Y, rateBuf, display::colors::GREEN, display::colors::BLACK, 1);
 
     rendered.recordCount = out.recordCount;
@@ -201,7 +267,14 @@ void MainView::renderStorage(display::IDisplay& lcd, const LcdOutput& out, LcdOu
 }
 
 void MainView::renderTime(display::IDisplay& lcd, const LcdOutput& out, LcdOutput& rendered) {
-    if (out.epoch > 1577836800) {
+    // Date line switches between "UPTIME" and the date at different x —
+    // clear it only when the mode flips; same-width values overdraw in place
+    bool wallClock = isWallClock(out.epoch);
+    if (wallClock != isWallClock(rendered.epoch)) {
+        lcd.fillRect(60, CLOCK_DATE_Y, 120, 16, display::colors::BLACK);
+    }
+
+    if (wallClock) {
         uint16_t color = out.timeSynced ? display::colors::CYAN : display::colors::WHITE;
 
         uint32_t date = SystemClock::dateYYYYMMDD(out.epoch);
@@ -210,27 +283,23 @@ void MainView::renderTime(display::IDisplay& lcd, const LcdOutput& out, LcdOutpu
             (unsigned long)(date / 10000),
             (unsigned long)((date / 100) % 100),
             (unsigned long)(date % 100));
-        lcd.fillRect(60, CLOCK_DATE_Y, 120, 16, display::colors::BLACK);
         lcd.drawString(60, CLOCK_DATE_Y, dateBuf, display::colors::WHITE, display::colors::BLACK, 2);
 
         uint8_t h, m, s;
         SystemClock::toHMS(out.epoch, h, m, s);
         char timeBuf[12];
         snprintf(timeBuf, sizeof(timeBuf), "%02u:%02u:%02u", h, m, s);
-        lcd.fillRect(72, CLOCK_TIME_Y, 96, 16, display::colors::BLACK);
         lcd.drawString(72, CLOCK_TIME_Y, timeBuf, color, display::colors::BLACK, 2);
     } else {
         uint32_t h = out.uptimeSec / 3600;
         uint32_t m = (out.uptimeSec / 60) % 60;
         uint32_t s = out.uptimeSec % 60;
 
-        lcd.fillRect(60, CLOCK_DATE_Y, 120, 16, display::colors::BLACK);
         lcd.drawString(78, CLOCK_DATE_Y, "UPTIME", display::colors::YELLOW, display::colors::BLACK, 2);
 
         char timeBuf[14];
         snprintf(timeBuf, sizeof(timeBuf), "%02lu:%02lu:%02lu",
             (unsigned long)h, (unsigned long)m, (unsigned long)s);
-        lcd.fillRect(72, CLOCK_TIME_Y, 96, 16, display::colors::BLACK);
         lcd.drawString(72, CLOCK_TIME_Y, timeBuf, display::colors::YELLOW, display::colors::BLACK, 2);
     }
 
@@ -240,11 +309,11 @@ void MainView::renderTime(display::IDisplay& lcd, const LcdOutput& out, LcdOutpu
 }
 
 void MainView::renderMqtt(display::IDisplay& lcd, const LcdOutput& out, LcdOutput& rendered) {
-    lcd.fillRect(VALUE_X, MQTT_STATUS_Y, 200, 8, display::colors::BLACK);
+    // Padded to the longest status so a shorter one covers the previous
     if (!out.mqttKnown) {
-        lcd.drawString(VALUE_X, MQTT_STATUS_Y, "---", display::colors::GRAY, display::colors::BLACK, 1);
+        lcd.drawString(VALUE_X, MQTT_STATUS_Y, "---         ", display::colors::GRAY, display::colors::BLACK, 1);
     } else if (out.mqttConnected) {
-        lcd.drawString(VALUE_X, MQTT_STATUS_Y, "Connected", display::colors::GREEN, display::colors::BLACK, 1);
+        lcd.drawString(VALUE_X, MQTT_STATUS_Y, "Connected   ", display::colors::GREEN, display::colors::BLACK, 1);
     } else {
         lcd.drawString(VALUE_X, MQTT_STATUS_Y, "Disconnected", display::colors::RED, display::colors::BLACK, 1);
     }
@@ -252,15 +321,118 @@ void MainView::renderMqtt(display::IDisplay& lcd, const LcdOutput& out, LcdOutpu
     rendered.mqttKnown = out.mqttKnown;
 }
 
+#if DISPLAY_FEATURE_COMPOSITOR
+void MainView::paintDashboard(display::IDisplay& canvas, const display::Rect& clip) {
+    // Nothing of the dashboard lies inside the ECG area
+    if (clip.intersect(ECG_RECT).area() == clip.area()) return;
+
+    // Labels cost the canvas one bounds check each when they miss the
+    // tile; values are formatted only for the fields this tile shows
+    drawLabels(canvas);
+    // render() against itself: every shown field is "dirty" and nothing
+    // differs from what is on screen, so no clears are issued
+    mRendered.dirty = (uint8_t)(mPainted & fieldsIn(clip));
+    render(canvas, mRendered, mRendered);
+    mRendered.dirty = 0;
+}
+
+uint8_t MainView::fieldsIn(const display::Rect& clip) {
+    uint8_t fields = 0;
+    if (clip.intersects(TEMP_RECT)) fields |= LcdOutput::DIRTY_TEMP;
+    if (clip.intersects(SD_INFO_RECT) || clip.intersects(SD_STATUS_RECT))
+        fields |= LcdOutput::DIRTY_SDINFO;
+    if (clip.intersects(RECORDS_RECT) || clip.intersects(RATE_RECT))
+        fields |= LcdOutput::DIRTY_STORAGE;
+    if (clip.intersects(DATE_RECT) || clip.intersects(TIME_RECT))
+        fields |= LcdOutput::DIRTY_TIME;
+    if (clip.intersects(MQTT_RECT)) fields |= LcdOutput::DIRTY_MQTT;
+    return fields;
+}
+
+void MainView::damageFields(const LcdOutput& out) {
+    uint8_t dirty = out.dirty;
+
+    if (dirty & LcdOutput::DIRTY_TEMP) {
+        mCompositor.damage(TEMP_RECT);
+    }
+    if (dirty & LcdOutput::DIRTY_SDINFO) {
+        mCompositor.damage(SD_INFO_RECT);
+        mCompositor.damage(SD_STATUS_RECT);
+    }
+    if (dirty & LcdOutput::DIRTY_STORAGE) {
+        mCompositor.damage(RECORDS_RECT);
+        mCompositor.damage(RATE_RECT);
+    }
+    if (dirty & LcdOutput::DIRTY_TIME) {
+        mCompositor.damage(TIME_RECT);
+        // The date line only changes with the mode or at midnight
+        bool wallClock = isWallClock(out.epoch);
+        if (!(mPainted & LcdOutput::DIRTY_TIME) ||
+            wallClock != isWallClock(mRendered.epoch) ||
+            (wallClock && SystemClock::dateYYYYMMDD(out.epoch) !=
+                          SystemClock::dateYYYYMMDD(mRendered.epoch))) {
+            mCompositor.damage(DATE_RECT);
+        }
+    }
+    if (dirty & LcdOutput::DIRTY_MQTT) {
+        mCompositor.damage(MQTT_RECT);
+    }
+}
+
+void MainView::composeEcg() {
+    // Each new column and the gap column it opens ahead; DamageList merges
+    // neighbours, so a batch usually composes as one narrow rect
+    mEcg.drain([this](uint16_t x, const uint8_t* lo, const uint8_t* hi) {
+        mCompositor.damage(mEcgLayer.put(x, lo[0], hi[0]));
+        mCompositor.damage(mEcgLayer.blank((uint16_t)((x + ECG_GAP) % ECG_WIDTH)));
+    });
+}
+
+MainView::EcgLayer::EcgLayer() {
+    memset(mLo, 0xFF, sizeof(mLo));
+    memset(mHi, 0, sizeof(mHi));
+}
+
+void MainView::EcgLayer::paint(display::IDisplay& canvas, const display::Rect& clip) {
+    display::Rect area = clip.intersect(ECG_RECT);
+    for (uint16_t x = area.x; x < area.right(); x++) {
+        display::Rect r = run(x);
+        if (!r.empty()) canvas.fillRect(r.x, r.y, r.w, r.h, display::colors::GREEN);
+    }
+}
+
+display::Rect MainView::EcgLayer::put(uint16_t x, uint8_t lo, uint8_t hi) {
+    display::Rect changed = run(x);
+    mLo[x] = lo;
+    mHi[x] = hi;
+    return changed.unite(run(x));
+}
+
+display::Rect MainView::EcgLayer::blank(uint16_t x) {
+    display::Rect changed = run(x);
+    mLo[x] = 0xFF;
+    mHi[x] = 0;
+    return changed;
+}
+
+display::Rect MainView::EcgLayer::run(uint16_t x) const {
+    if (mLo[x] > mHi[x]) return display::Rect{ 0, 0, 0, 0 };
+    return display::Rect{ x, (uint16_t)(ECG_TOP_Y + mLo[x]), 1, (uint16_t)(mHi[x] - mLo[x] + 1) };
+}
+#endif
+
+uint8_t MainView::ecgToPixel(uint8_t y) {
+    // Scale 0-99 → 8-92 to leave top/bottom margin
+    y = (uint8_t)(y * 84 / 100 + 8);
+    return y >= ECG_HEIGHT ? (uint8_t)(ECG_HEIGHT - 1) : y;
+}
+
 void MainView::renderEcgColumn(display::IDisplay& lcd, uint8_t x, uint8_t y, uint8_t prevY) {
     // Half-resolution: cursor 0-119, each maps to 2px on 240px wide LCD
     uint16_t px = (uint16_t)x * 2;
 
-    // Scale 0-99 → 8-92 to leave top/bottom margin
-    y    = (uint8_t)(y    * 84 / 100 + 8);
-    prevY = (uint8_t)(prevY * 84 / 100 + 8);
-    if (y >= ECG_HEIGHT) y = ECG_HEIGHT - 1;
-    if (prevY >= ECG_HEIGHT) prevY = ECG_HEIGHT - 1;
+    y     = ecgToPixel(y);
+    prevY = ecgToPixel(prevY);
 
     // Erase ahead (6px = 3 half-res columns)
     uint16_t eraseX = ((x + 1) % LcdOutput::ECG_WIDTH) * 2;
@@ -277,6 +449,12 @@ void MainView::renderEcgColumn(display::IDisplay& lcd, uint8_t x, uint8_t y, uin
     lcd.fillRect(px, ECG_TOP_Y + minY, 2, lineH, display::colors::GREEN);
 }
 
+void MainView::padField(char* buf, size_t cap, uint8_t width) {
+    size_t len = strlen(buf);
+    while (len < width && len + 1 < cap) buf[len++] = ' ';
+    buf[len] = '\0';
+}
+
 void MainView::uint32ToStr(char* buf, uint32_t value) {
     uint32_t temp = value;
     int digits = 0;
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "BaseLcdView.hpp"
+#include "EcgSweep.hpp"
+#include "DisplayStatus.hpp"
+#if DISPLAY_FEATURE_COMPOSITOR
+#include "Compositor.hpp"
+#endif
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
@@ -21,12 +26,13 @@ public:
     struct Input {
         MainViewModel* viewModel;
         display::IDisplay* lcd;
+        uint16_t ecgSampleHz;      // pushEcgSample() rate, from the ECG source (0 = none)
     };
     Input input;
 
     MainView();
 
-    void init();    // create mutex, ECG queue
+    void init();    // create mutex, ECG queue; sweep at input.ecgSampleHz
     void start();   // create render task, call onEnter
 
     /** Push ECG sample from any task (thread-safe via queue) */
@@ -50,7 +56,13 @@ private:
     void renderTime(display::IDisplay& lcd, const LcdOutput& out, LcdOutput& rendered);
     void renderMqtt(display::IDisplay& lcd, const LcdOutput& out, LcdOutput& rendered);
 
+    /** Labels, dividers and value placeholders (no screen clear) */
+    void drawLabels(display::IDisplay& lcd);
+    static bool isWallClock(uint32_t epoch) { return epoch > 1577836800; }
+
     static void uint32ToStr(char* buf, uint32_t value);
+    /** Space-pad to a fixed field so a shorter value covers the previous one */
+    static void padField(char* buf, size_t cap, uint8_t width);
 
     // Render task
     static void renderTaskEntry(void* param);
@@ -60,12 +72,23 @@ private:
     StackType_t mRenderTaskStack[RENDER_TASK_STACK];
     TaskHandle_t mRenderTaskHandle;
 
-    // ECG sample queue
-    static const uint8_t ECG_QUEUE_LEN = 16;
+    // ECG sample queue — drained in batches; the render task is woken
+    // once per mEcgBatch samples (and by its 100ms timeout)
+    static const uint8_t ECG_QUEUE_LEN = 64;
     QueueHandle_t mEcgQueue;
     StaticQueue_t mEcgQueueBuf;
     uint8_t mEcgQueueStorage[ECG_QUEUE_LEN];
 
+    // ECG sweep at ECG_COLUMNS_HZ: a faster source (the 1kHz record stream)
+    // folds into min/max envelope columns, a slower one stretches
+    static const uint16_t ECG_COLUMNS_HZ = 500;
+    static const uint8_t  ECG_BATCH_COLUMNS = 16;   // columns per render wake
+    static const uint8_t  ECG_GAP = 6;              // blank columns ahead of the cursor
+    void beginEcg(uint16_t sampleHz);
+    static uint8_t ecgToPixel(uint8_t y);
+    EcgSweep<1> mEcg;
+    uint8_t mEcgBatch;
+
     // LCD mutex + render diff
     SemaphoreHandle_t mLcdMutex;
     StaticSemaphore_t mLcdMutexBuf;
@@ -85,6 +108,69 @@ private:
     static const uint16_t ECG_WIDTH    = 240;
     static const uint16_t CLOCK_DATE_Y = 286;
     static const uint16_t CLOCK_TIME_Y = 304;
+
+    // Value field widths (chars) — values are redrawn in place, not cleared
+    static const uint8_t TEMP_FIELD    = 15;   // scale 2, 180px
+    static const uint8_t SD_INFO_FIELD = 25;
+    static const uint8_t STORAGE_FIELD = 26;   // 160px
+
+#if DISPLAY_FEATURE_COMPOSITOR
+    // Value fields as screen rects — damage and per-tile clipping share them
+    static constexpr display::Rect TEMP_RECT      = { VALUE_X, TEMP_VALUE_Y, TEMP_FIELD * 6 * 2, 14 };
+    static constexpr display::Rect SD_INFO_RECT   = { VALUE_X, SD_INFO_Y, SD_INFO_FIELD * 6, 7 };
+    static constexpr display::Rect SD_STATUS_RECT = { VALUE_X, SD_STATUS_Y, 11 * 6, 7 };
+    static constexpr display::Rect RECORDS_RECT   = { VALUE_X + 54, SD_RECORDS_Y, STORAGE_FIELD * 6, 7 };
+    static constexpr display::Rect RATE_RECT      = { VALUE_X + 36, SD_RATE_Y, STORAGE_FIELD * 6, 7 };
+    static constexpr display::Rect MQTT_RECT      = { VALUE_X, MQTT_STATUS_Y, 12 * 6, 7 };
+    static constexpr display::Rect DATE_RECT      = { 60, CLOCK_DATE_Y, 120, 14 };
+    static constexpr display::Rect TIME_RECT      = { 72, CLOCK_TIME_Y, 8 * 6 * 2, 14 };
+    static constexpr display::Rect ECG_RECT       = { 0, ECG_TOP_Y, ECG_WIDTH, ECG_HEIGHT };
+
+    /** Labels + values as the bottom compositor layer, painted from mRendered */
+    class DashboardLayer : public display::Layer {
+    public:
+        explicit DashboardLayer(MainView& view) : mView(view) {}
+        display::Rect bounds() const override { return display::Rect{ 0, 0, 240, 320 }; }
+        void paint(display::IDisplay& canvas, const display::Rect& clip) override {
+            mView.paintDashboard(canvas, clip);
+        }
+    private:
+        MainView& mView;
+    };
+
+    /** ECG trace kept as one row run per column, so any tile can be repainted */
+    class EcgLayer : public display::Layer {
+    public:
+        EcgLayer();
+        display::Rect bounds() const override { return ECG_RECT; }
+        void paint(display::IDisplay& canvas, const display::Rect& clip) override;
+        /** Column x now shows area rows lo..hi. @return screen rect that changed */
+        display::Rect put(uint16_t x, uint8_t lo, uint8_t hi);
+        /** Column x is cleared. @return screen rect that changed */
+        display::Rect blank(uint16_t x);
+    private:
+        display::Rect run(uint16_t x) const;
+        uint8_t mLo[ECG_WIDTH];
+        uint8_t mHi[ECG_WIDTH];     // mLo > mHi: blank column
+    };
+
+    void paintDashboard(display::IDisplay& canvas, const display::Rect& clip);
+    /** Damage the screen fields that change going from mRendered to out */
+    void damageFields(const LcdOutput& out);
+    /** DIRTY_* fields with a rect inside clip */
+    static uint8_t fieldsIn(const display::Rect& clip);
+    /** Move new sweep columns into the ECG layer, damaging what changed */
+    void composeEcg();
+
+    // Dashboard at the bottom, ECG trace above it, toast on top. 240x4
+    // tile (1.9KB): narrow fields take more rows, so most values still go
+    // out in one burst
+    DashboardLayer mDashboard;
+    EcgLayer mEcgLayer;
+    display::ToastLayer mToastLayer;
+    display::Compositor<240, 4, 3> mCompositor;
+    uint8_t mPainted;   // DIRTY_* fields that have a value to show
+#endif
 };
 
 } // namespace lcd
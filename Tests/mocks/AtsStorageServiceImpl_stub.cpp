@@ -59,7 +59,6 @@ AtsStorageServiceImpl::AtsStorageServiceImpl()
     , mFormatRequested(false)
     , mUploadPause(false)
     , mUploadRequested(false)
-    , mPendingData()
     , mWriteSemBuffer()
     , mWriteSem(0)
     , mStatsObs("stub")
@@ -8,6 +8,10 @@
  * Surface matches the real Esp8266.hpp closely enough that
  * RegistrationServiceImpl::httpRegister and other AT-command consumers
  * compile and run on host without modification.
+ *
+ * Every popped response runs through the same EspLinkDemux as the real
+ * driver: AT text replaces the response buffer, "+IPD,<id>,<len>:" payload
+ * lands in that link's queue (see ipd() / pushIpd()).
  */
 #pragma once
 
@@ -17,6 +21,9 @@
 #include "stm32f1xx_hal.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "event_groups.h"
+#include "UartDmaTx.hpp"
+#include "EspLinkDemux.hpp"
 
 #include <cstdint>
 #include <cstddef>
@@ -48,6 +55,20 @@ public:
         return true;
     }
 
+    /* Gather sends land in sentData() as one blob, like the wire sees them */
+    bool sendv(const UartTxSeg* segs, uint8_t count, uint32_t /*timeoutMs*/ = 1000) {
+        std::vector<uint8_t> blob;
+        for (uint8_t i = 0; i < count; i++) {
+            const uint8_t* p = static_cast<const uint8_t*>(segs[i].data);
+            blob.insert(blob.end(), p, p + segs[i].len);
+        }
+        mSentData.push_back(blob);
+        loadNextResponse();
+        return true;
+    }
+    bool sendAsync(const UartTxSeg* segs, uint8_t count) { return sendv(segs, count); }
+    bool waitTx(uint32_t /*timeoutMs*/) { return mTxOk; }
+
     const char* getResponse() const { return mRxBuf; }
     uint16_t    getResponseLen() const { return mRxLen; }
 
@@ -61,47 +82,153 @@ public:
         return responseContains(expect);
     }
 
-    void clearRx() { mRxLen = 0; mRxBuf[0] = '\0'; }
+    void clearRx() { mDemux.clearText(); mRxLen = 0; }
+
+    /* ── Links (AT+CIPMUX=1) — same AT strings as the real driver ───────── */
+    enum Link : uint8_t {
+        LINK_MQTT   = 0,
+        LINK_HTTP   = 1,
+        LINK_SYSLOG = 2,
+        LINK_COUNT  = 3
+    };
+
+    bool enableMux() {
+        resetLinks();
+        return sendCmd("AT+CIPMUX=1", "OK", 2000);
+    }
+
+    bool linkOpen(uint8_t link, const char* type, const char* host, uint16_t port,
+                  uint32_t timeoutMs = 10000) {
+        if (link >= LINK_COUNT || mLinkBusy[link]) return false;
+        mLinkQ[link].clear();
+        mDemux.setClosed(link, false);
+        std::string cmd = "AT+CIPSTART=" + std::to_string(link) + ",\"" + type +
+                          "\",\"" + host + "\"," + std::to_string(port);
+        if (sendCmd(cmd.c_str(), "OK", timeoutMs) || responseContains("ALREADY CONNECTED")) {
+            mLinkBusy[link] = mHoldLinks;
+            return true;
+        }
+        return false;
+    }
+
+    void linkClose(uint8_t link) {
+        if (link >= LINK_COUNT) return;
+        sendCmd(("AT+CIPCLOSE=" + std::to_string(link)).c_str(), "OK", 2000);
+        mLinkQ[link].clear();
+        mDemux.setClosed(link, true);
+        mLinkBusy[link] = false;
+    }
+
+    bool linkSend(uint8_t link, const UartTxSeg* segs, uint8_t count,
+                  uint32_t timeoutMs = 5000) {
+        if (!linkSendAsync(link, segs, count)) return false;
+        return linkSendWait(timeoutMs);
+    }
+    bool linkSend(uint8_t link, const uint8_t* data, uint16_t len,
+                  uint32_t timeoutMs = 5000) {
+        UartTxSeg seg = { data, len };
+        return linkSend(link, &seg, 1, timeoutMs);
+    }
+
+    bool linkSendAsync(uint8_t link, const UartTxSeg* segs, uint8_t count) {
+        if (link >= LINK_COUNT) return false;
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < count; i++) total += segs[i].len;
+        if (total == 0 || total > LINK_SEND_MAX) return false;
+        std::string cmd = "AT+CIPSEND=" + std::to_string(link) + "," + std::to_string(total);
+        if (!sendCmd(cmd.c_str(), ">", 2000)) return false;
+        return sendv(segs, count);
+    }
+    bool linkSendWait(uint32_t timeoutMs) {
+        if (!mTxOk) return false;
+        return waitFor("SEND OK", timeoutMs);
+    }
+
+    uint16_t linkAvailable(uint8_t link) const {
+        return link < LINK_COUNT ? mLinkQ[link].available() : 0;
+    }
+    uint16_t linkRead(uint8_t link, uint8_t* buf, uint16_t len) {
+        return link < LINK_COUNT ? mLinkQ[link].read(buf, len) : 0;
+    }
+    uint16_t linkPeek(uint8_t link, uint8_t* buf, uint16_t len) const {
+        return link < LINK_COUNT ? mLinkQ[link].peek(buf, len) : 0;
+    }
+    uint16_t linkSkip(uint8_t link, uint16_t len) {
+        return link < LINK_COUNT ? mLinkQ[link].skip(len) : 0;
+    }
+    bool linkClosed(uint8_t link) const { return mDemux.closed(link); }
+    uint32_t linkRxTick(uint8_t link) const { return link < LINK_COUNT ? mLinkRxTick[link] : 0; }
+    uint32_t linkDropped(uint8_t link) const {
+        return link < LINK_COUNT ? mLinkQ[link].dropped() : 0;
+    }
+
+    /** Pops one queued response when the link has nothing to read */
+    bool linkWait(uint8_t link, uint32_t /*timeoutMs*/) {
+        if (link >= LINK_COUNT) return false;
+        if (mLinkQ[link].available() == 0 && !mDemux.closed(link)) loadNextResponse();
+        return mLinkQ[link].available() > 0;
+    }
+
+    /** Pops queued responses until expect arrives on the link */
+    bool linkRecvUntil(uint8_t link, char* buf, uint16_t size, uint16_t& len,
+                       const char* expect, uint32_t /*timeoutMs*/) {
+        if (link >= LINK_COUNT || size == 0) return false;
+        for (;;) {
+            uint16_t room = (uint16_t)(size - 1 - len);
+            len = (uint16_t)(len + mLinkQ[link].read((uint8_t*)buf + len, room));
+            buf[len] = '\0';
+            std::string have(buf, len);
+            if (have.find(expect) != std::string::npos) return true;
+            if (len + 1 >= size || mDemux.closed(link)) return false;
+            if (mPendingResponses.empty()) return false;
+            loadNextResponse();
+        }
+    }
 
-    /* Unsolicited MQTT subscription buffer — production interface used by
-     * MqttServiceImpl. Test code can poke mMqttBuf via pushMqttMsg(). */
-    bool hasMqttMsg() const { return mMqttReady; }
-    const char* getMqttMsg() const { return mMqttBuf; }
-    uint16_t getMqttMsgLen() const { return mMqttLen; }
-    void clearMqttMsg() { mMqttReady = false; mMqttLen = 0; mMqttBuf[0] = '\0'; }
+    void lockAt() {}
+    void unlockAt() {}
+    class AtLock {
+    public:
+        explicit AtLock(Esp8266&) {}
+    };
+
+    /* Raw bytes as the ESP would emit them, fed through the demux now
+     * (MQTT tests: "+IPD,<len>:" lands on link 0, anything else is text) */
     void pushMqttMsg(const char* data, uint16_t len) {
-        if (len > MQTT_BUF_SIZE - 1) len = MQTT_BUF_SIZE - 1;
-        std::memcpy(mMqttBuf, data, len);
-        mMqttBuf[len] = '\0';
-        mMqttLen = len;
-        mMqttReady = true;
+        signalLinks(mDemux.feed(reinterpret_cast<const uint8_t*>(data), len));
+        mRxLen = mDemux.textLen();
     }
-    static const uint16_t MQTT_BUF_SIZE = 256;
 
-    void setIpdPassthrough(bool enable) { mIpdPassthrough = enable; }
-    bool isIpdPassthrough() const { return mIpdPassthrough; }
+    /* Same bits as the real driver; link data sets them as the ISR would */
+    static EventBits_t linkEvent(uint8_t link) { return (EventBits_t)1 << link; }
+    static const EventBits_t EVT_ACCESS = (EventBits_t)1 << LINK_COUNT;
+    void setEventGroup(EventGroupHandle_t group) { mEvents = group; }
 
     enum class User : uint8_t { None, Mqtt, Upload };
-    void requestAccess(User who) { mCurrentUser = who; }
-    void requestAccessAsync(User who) { mRequestedUser = who; }
-    void releaseAccess() { mCurrentUser = User::None; }
-    bool isAccessRequested() const {
-        return mRequestedUser != User::None && mRequestedUser != mCurrentUser;
+    void requestAccessAsync(User who) {
+        mRequestedUser = who;
+        if (mEvents) xEventGroupSetBits(mEvents, EVT_ACCESS);
     }
+    bool isAccessRequested() const { return mRequestedUser != User::None; }
     void clearRequest() { mRequestedUser = User::None; }
 
     static const uint16_t RX_BUF_SIZE = 512;
+    static const uint16_t LINK_SEND_MAX = 2048;
+    static const uint16_t MQTT_QUEUE_SIZE = 512;
 
     /* ── Test control surface ────────────────────────────────────────────── */
     void resetForTest() {
         mSentCmds.clear();
         mSentData.clear();
         mPendingResponses.clear();
-        mIpdPassthrough = false;
-        mCurrentUser    = User::None;
+        mTxOk = true;
+        mHoldLinks = false;
         mRequestedUser  = User::None;
+        mEvents = nullptr;
+        resetLinks();
+        // Links start connected so receive paths can be driven directly
+        for (uint8_t i = 0; i < LINK_COUNT; i++) mDemux.setClosed(i, false);
         clearRx();
-        clearMqttMsg();
     }
 
     /** Queue an AT-command response. Each sendCmd / waitFor / sendData call
@@ -115,29 +242,75 @@ public:
         mPendingResponses.emplace_back(reinterpret_cast<const char*>(data), len);
     }
 
+    /** "+IPD,<link>,<len>:<payload>" as the ESP frames it */
+    static std::string ipd(uint8_t link, const std::string& payload) {
+        return "+IPD," + std::to_string(link) + "," + std::to_string(payload.size()) +
+               ":" + payload;
+    }
+    /** Queue link data as the next response */
+    void pushIpd(uint8_t link, const std::string& payload) {
+        mPendingResponses.push_back(ipd(link, payload));
+    }
+
+    /** Make waitTx() report a stuck/aborted async send */
+    void setTxOk(bool ok) { mTxOk = ok; }
+
+    /** Open links stay owned until linkClose() (another user is refused) */
+    void setHoldLinks(bool hold) { mHoldLinks = hold; }
+
     const std::vector<std::string>&             sentCmds() const { return mSentCmds; }
     const std::vector<std::vector<uint8_t>>&    sentData() const { return mSentData; }
 
 private:
-    Esp8266() = default;
+    Esp8266() {
+        mDemux.setTextBuffer(mRxBuf, RX_BUF_SIZE);
+        mLinkQ[LINK_MQTT].init(mMqttQueueBuf, sizeof(mMqttQueueBuf));
+        mLinkQ[LINK_HTTP].init(mHttpQueueBuf, sizeof(mHttpQueueBuf));
+        mLinkQ[LINK_SYSLOG].init(mSyslogQueueBuf, sizeof(mSyslogQueueBuf));
+        for (uint8_t i = 0; i < LINK_COUNT; i++) mDemux.attach(i, &mLinkQ[i]);
+    }
+
+    void resetLinks() {
+        mDemux.reset();
+        for (uint8_t i = 0; i < LINK_COUNT; i++) {
+            mLinkQ[i].clear();
+            mDemux.setClosed(i, true);
+            mLinkBusy[i] = false;
+        }
+    }
 
     void loadNextResponse() {
         if (mPendingResponses.empty()) return;
-        const std::string& s = mPendingResponses.front();
-        mRxLen = (uint16_t)(s.size() < RX_BUF_SIZE - 1 ? s.size() : RX_BUF_SIZE - 1);
-        std::memcpy(mRxBuf, s.data(), mRxLen);
-        mRxBuf[mRxLen] = '\0';
+        std::string s = mPendingResponses.front();
         mPendingResponses.erase(mPendingResponses.begin());
+        mDemux.clearText();
+        signalLinks(mDemux.feed(reinterpret_cast<const uint8_t*>(s.data()), (uint16_t)s.size()));
+        mRxLen = mDemux.textLen();
+    }
+
+    void signalLinks(uint8_t links) {
+        links &= (uint8_t)((1u << LINK_COUNT) - 1);
+        if (!links) return;
+        for (uint8_t i = 0; i < LINK_COUNT; i++) {
+            if (links & (1u << i)) mLinkRxTick[i] = xTaskGetTickCount();
+        }
+        if (mEvents) xEventGroupSetBits(mEvents, links);
     }
 
     char     mRxBuf[RX_BUF_SIZE] = {};
     uint16_t mRxLen = 0;
-    char     mMqttBuf[MQTT_BUF_SIZE] = {};
-    uint16_t mMqttLen = 0;
-    bool     mMqttReady = false;
-    bool     mIpdPassthrough = false;
-    User     mCurrentUser    = User::None;
+    bool     mTxOk = true;
+    bool     mHoldLinks = false;
     User     mRequestedUser  = User::None;
+    EventGroupHandle_t mEvents = nullptr;
+    uint32_t mLinkRxTick[LINK_COUNT] = {};
+
+    EspLinkDemux mDemux;
+    LinkRxQueue  mLinkQ[LINK_COUNT];
+    uint8_t      mMqttQueueBuf[MQTT_QUEUE_SIZE] = {};
+    uint8_t      mHttpQueueBuf[8192] = {};
+    uint8_t      mSyslogQueueBuf[64] = {};
+    bool         mLinkBusy[LINK_COUNT] = {};
 
     std::vector<std::string>           mSentCmds;
     std::vector<std::vector<uint8_t>>  mSentData;
@@ -0,0 +1,207 @@
+/**
+ * @file FramebufferDisplay.hpp
+ * @brief Host IDisplay backed by a full 240x320 RGB565 framebuffer, with a
+ *        per-frame bus-traffic profiler and PPM/PNG snapshots.
+ *
+ * Rasterizes exactly like the panel driver (shared Canvas code) so tests
+ * can assert pixels, and counts what the same calls would cost on the
+ * FSMC bus: one window setup per primitive (per glyph for drawString, as
+ * the uncached driver path) and the pixels it streams. A pixel written
+ * again within the same frame counts as overdraw.
+ */
+#pragma once
+
+#include "Compositor.hpp"
+#include <cstdio>
+#include <vector>
+
+namespace arcana {
+namespace display {
+
+class FramebufferDisplay : public Canvas {
+public:
+    static const uint16_t W = 240;
+    static const uint16_t H = 320;
+    /** FSMC writes per window: CASET + 4, PASET + 4, RAMWR */
+    static const uint32_t WINDOW_BUS_WRITES = 11;
+
+    struct FrameStats {
+        uint32_t windows;       // setWindow equivalents
+        uint32_t pixels;        // pixels streamed
+        uint32_t overdraw;      // pixels already written this frame
+        uint32_t busWrites;     // windows * WINDOW_BUS_WRITES + pixels
+    };
+
+    uint32_t windows = 0;       // running totals since resetCounters()
+    uint32_t pixelsWritten = 0;
+    uint32_t bitmapWindows = 0; // drawBitmap16 calls (compositor tiles)
+    uint32_t overdraw = 0;
+
+    FramebufferDisplay() : Canvas(mFb, W, H), mFb(), mStamp(), mFrame(1) {
+        setWindow(Rect{ 0, 0, W, H });
+    }
+
+    Color at(uint16_t x, uint16_t y) const { return mFb[(uint32_t)y * W + x]; }
+
+    void resetCounters() {
+        windows = 0; pixelsWritten = 0; bitmapWindows = 0; overdraw = 0;
+        beginFrame();
+    }
+
+    // ── Frame profiler ──
+
+    /** Start a frame: later stats are relative to this point */
+    void beginFrame() {
+        mFrame++;
+        mMark = FrameStats{ windows, pixelsWritten, overdraw, 0 };
+    }
+
+    /** Cost of everything drawn since beginFrame() */
+    FrameStats frameStats() const {
+        FrameStats s;
+        s.windows = windows - mMark.windows;
+        s.pixels = pixelsWritten - mMark.pixels;
+        s.overdraw = overdraw - mMark.overdraw;
+        s.busWrites = s.windows * WINDOW_BUS_WRITES + s.pixels;
+        return s;
+    }
+
+    // ── Snapshots ──
+
+    /** Binary PPM (P6), RGB565 expanded to 8 bits per channel */
+    bool writePpm(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        fprintf(f, "P6\n%u %u\n255\n", (unsigned)W, (unsigned)H);
+        std::vector<uint8_t> row(W * 3);
+        for (uint16_t y = 0; y < H; y++) {
+            rgbRow(y, row.data());
+            fwrite(row.data(), 1, row.size(), f);
+        }
+        return fclose(f) == 0;
+    }
+
+    /** 8-bit RGB PNG using stored (uncompressed) deflate blocks */
+    bool writePng(const char* path) const {
+        std::vector<uint8_t> raw;
+        raw.reserve((size_t)H * (1 + W * 3));
+        std::vector<uint8_t> row(W * 3);
+        for (uint16_t y = 0; y < H; y++) {
+            raw.push_back(0);                      // filter: none
+            rgbRow(y, row.data());
+            raw.insert(raw.end(), row.begin(), row.end());
+        }
+
+        std::vector<uint8_t> z = { 0x78, 0x01 };
+        for (size_t off = 0; off < raw.size(); ) {
+            uint16_t n = (uint16_t)(raw.size() - off > 0xFFFF ? 0xFFFF : raw.size() - off);
+            z.push_back(off + n == raw.size() ? 1 : 0);
+            z.push_back((uint8_t)n); z.push_back((uint8_t)(n >> 8));
+            z.push_back((uint8_t)~n); z.push_back((uint8_t)(~n >> 8));
+            z.insert(z.end(), raw.begin() + off, raw.begin() + off + n);
+            off += n;
+        }
+        uint32_t a = 1, b = 0;
+        for (uint8_t v : raw) { a = (a + v) % 65521; b = (b + a) % 65521; }
+        put32(z, (b << 16) | a);
+
+        std::vector<uint8_t> ihdr;
+        put32(ihdr, W); put32(ihdr, H);
+        ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });   // 8-bit RGB
+
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        static const uint8_t SIG[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        fwrite(SIG, 1, sizeof(SIG), f);
+        writeChunk(f, "IHDR", ihdr);
+        writeChunk(f, "IDAT", z);
+        writeChunk(f, "IEND", std::vector<uint8_t>());
+        return fclose(f) == 0;
+    }
+
+    // ── IDisplay ──
+
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, Color c) override {
+        count(x, y, w, h);
+        Canvas::fillRect(x, y, w, h, c);
+    }
+
+    void drawChar(uint16_t x, uint16_t y, char c, Color fg, Color bg, uint8_t scale) override {
+        uint16_t cw = (lcd::FONT_WIDTH + 1) * scale;
+        uint16_t ch = lcd::FONT_HEIGHT * scale;
+        if (scale == 0 || x + cw > W || y + ch > H) return;
+        count(x, y, cw, ch);
+        Canvas::drawChar(x, y, c, fg, bg, scale);
+    }
+
+    void drawString(uint16_t x, uint16_t y, const char* str,
+                    Color fg, Color bg, uint8_t scale) override {
+        uint16_t cw = (lcd::FONT_WIDTH + 1) * scale;
+        for (; *str && scale && x + cw <= W; str++, x += cw) drawChar(x, y, *str, fg, bg, scale);
+    }
+
+    void drawXBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                     const uint8_t* bitmap, Color fg, Color bg) override {
+        count(x, y, w, h);
+        Canvas::drawXBitmap(x, y, w, h, bitmap, fg, bg);
+    }
+
+    void drawBitmap16(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint16_t* pixels) override {
+        count(x, y, w, h);
+        bitmapWindows++;
+        Canvas::drawBitmap16(x, y, w, h, pixels);
+    }
+
+private:
+    void count(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+        Rect r = Rect{ 0, 0, W, H }.intersect(Rect{ x, y, w, h });
+        if (r.empty()) return;
+        windows++;
+        pixelsWritten += r.area();
+        for (uint16_t py = r.y; py < r.bottom(); py++) {
+            uint32_t* s = mStamp + (uint32_t)py * W + r.x;
+            for (uint16_t i = 0; i < r.w; i++) {
+                if (s[i] == mFrame) overdraw++;
+                s[i] = mFrame;
+            }
+        }
+    }
+
+    void rgbRow(uint16_t y, uint8_t* out) const {
+        for (uint16_t x = 0; x < W; x++) {
+            Color c = at(x, y);
+            uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+            *out++ = (uint8_t)((r << 3) | (r >> 2));
+            *out++ = (uint8_t)((g << 2) | (g >> 4));
+            *out++ = (uint8_t)((b << 3) | (b >> 2));
+        }
+    }
+
+    static void put32(std::vector<uint8_t>& v, uint32_t x) {
+        v.push_back((uint8_t)(x >> 24)); v.push_back((uint8_t)(x >> 16));
+        v.push_back((uint8_t)(x >> 8));  v.push_back((uint8_t)x);
+    }
+
+    static void writeChunk(FILE* f, const char* type, const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> buf;
+        put32(buf, (uint32_t)data.size());
+        buf.insert(buf.end(), type, type + 4);
+        buf.insert(buf.end(), data.begin(), data.end());
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 4; i < buf.size(); i++) {
+            crc ^= buf[i];
+            for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+        put32(buf, ~crc);
+        fwrite(buf.data(), 1, buf.size(), f);
+    }
+
+    Color mFb[(uint32_t)W * H];
+    uint32_t mStamp[(uint32_t)W * H];   // frame that last wrote each pixel
+    uint32_t mFrame;
+    FrameStats mMark = {};
+};
+
+} // namespace display
+} // namespace arcana
@@ -12,6 +12,7 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "queue.h"
+#include "UartDmaTx.hpp"
 #include <cstdint>
 #include <cstddef>
 #include <cstring>
@@ -40,6 +41,16 @@ public:
         return mSendOk;
     }
 
+    bool sendv(const UartTxSeg* segs, uint8_t count, uint32_t /*timeoutMs*/ = 200) {
+        std::vector<uint8_t> blob;
+        for (uint8_t i = 0; i < count; i++) {
+            const uint8_t* p = static_cast<const uint8_t*>(segs[i].data);
+            blob.insert(blob.end(), p, p + segs[i].len);
+        }
+        mSent.push_back(blob);
+        return mSendOk;
+    }
+
     const char* getResponse() const { return ""; }
     uint16_t getResponseLen() const { return 0; }
     void clearRx() {}
@@ -64,8 +75,10 @@ public:
     uint16_t getFrameLen() const { return static_cast<uint16_t>(mCurrent.size()); }
     void resetFrame() { mCurrent.clear(); }
 
-    void isr_onRxByte(uint8_t /*byte*/) {}
+    void isr_onRxDma() {}
     void isr_onIdle() {}
+    void isr_onOverrun() {}
+    void isr_onTxe() {}
 
     void setDataMode(bool dataMode) { mDataMode = dataMode; }
     bool isDataMode() const { return mDataMode; }
@@ -0,0 +1,153 @@
+/**
+ * @file SimI2c.cpp
+ * @brief Pin-level SimI2cBus behind the HAL stub's GPIO hooks.
+ */
+#include "SimI2c.hpp"
+
+extern void (*g_hal_gpio_write_hook)(GPIO_TypeDef*, uint16_t, GPIO_PinState);
+extern GPIO_PinState (*g_hal_gpio_read_override)(GPIO_TypeDef*, uint16_t);
+
+namespace arcana {
+namespace test {
+
+static void gpioWrite(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+    if (port == GPIOB) SimI2cBus::instance().pinWrite(pin, state == GPIO_PIN_SET);
+}
+
+static GPIO_PinState gpioRead(GPIO_TypeDef* port, uint16_t pin) {
+    if (port == GPIOB && pin == GPIO_PIN_7) {
+        return SimI2cBus::instance().sdaLine() ? GPIO_PIN_SET : GPIO_PIN_RESET;
+    }
+    return GPIO_PIN_SET;
+}
+
+SimI2cBus& SimI2cBus::instance() {
+    static SimI2cBus sBus;
+    g_hal_gpio_write_hook = gpioWrite;
+    g_hal_gpio_read_override = gpioRead;
+    return sBus;
+}
+
+void SimI2cBus::reset() {
+    mDevices.clear();
+    mScl = true;
+    mSda = true;
+    mSlaveLow = false;
+    mMode = IDLE;
+    mDev = nullptr;
+    mClocks = 0;
+    mClocked = false;
+    mStuckClocks = 0;
+    stuck = false;
+    starts = stops = nacks = bytesRead = 0;
+}
+
+SimI2cDevice* SimI2cBus::find(uint8_t addr) const {
+    for (const auto& d : mDevices) {
+        if (d.first == addr) return d.second;
+    }
+    return nullptr;
+}
+
+void SimI2cBus::pinWrite(uint16_t pin, bool high) {
+    if (pin & GPIO_PIN_6) {
+        if (high == mScl) return;
+        mScl = high;
+        if (high) sclRise(); else sclFall();
+    }
+    if (pin & GPIO_PIN_7) {
+        bool before = sdaLine();
+        mSda = high;
+        bool after = sdaLine();
+        // START / STOP: SDA moves while SCL is high
+        if (mScl && before && !after) onStart();
+        else if (mScl && !before && after) onStop();
+    }
+}
+
+void SimI2cBus::onStart() {
+    starts++;
+    mMode = ADDR;
+    mClocks = 0;
+    mShift = 0;
+    mSlaveLow = false;
+    mClocked = false;           // SCL is still high from the START
+}
+
+void SimI2cBus::onStop() {
+    stops++;
+    if (mDev) mDev->stop();
+    mDev = nullptr;
+    mMode = IDLE;
+    mSlaveLow = false;
+}
+
+void SimI2cBus::sclRise() {
+    if (stuck && ++mStuckClocks >= STUCK_CLOCKS) {
+        stuck = false;
+        mStuckClocks = 0;
+    }
+    if (mMode == IDLE) return;
+    mClocked = true;
+    if (mClocks < 8) {
+        if (mMode != READ) mShift = (uint8_t)((mShift << 1) | (sdaLine() ? 1 : 0));
+    } else if (mMode == READ) {
+        mMasterAck = !sdaLine();
+    }
+}
+
+void SimI2cBus::sclFall() {
+    if (mMode == IDLE || !mClocked) return;
+    mClocks++;
+    if (mClocks < 8) {
+        if (mMode == READ) driveBit();
+        return;
+    }
+    if (mClocks == 8) {
+        if (mMode == READ) {
+            mSlaveLow = false;              // master's ACK slot
+            return;
+        }
+        if (mMode == ADDR) {
+            SimI2cDevice* dev = find((uint8_t)(mShift >> 1));
+            mAck = dev != nullptr;
+            if (dev) {
+                mDev = dev;
+                mDev->start();
+            }
+        } else {
+            mAck = mDev->write(mShift);
+        }
+        if (!mAck) nacks++;
+        mSlaveLow = mAck;
+        return;
+    }
+
+    // Ninth clock done: next byte
+    mClocks = 0;
+    mSlaveLow = false;
+    if (mMode == READ) {
+        if (!mMasterAck) { mMode = IDLE; return; }     // NACK: master stops
+        mShift = mDev->read();
+        bytesRead++;
+        driveBit();
+        return;
+    }
+    if (!mAck) { mMode = IDLE; return; }
+    if (mMode == ADDR && (mShift & 1)) {
+        mMode = READ;
+        mShift = mDev->read();
+        bytesRead++;
+        driveBit();
+    } else {
+        mMode = WRITE;
+        mShift = 0;
+    }
+}
+
+void SimI2cBus::driveBit() {
+    mSlaveLow = !(mShift & (0x80 >> mClocks));
+}
+
+} // namespace test
+} // namespace arcana
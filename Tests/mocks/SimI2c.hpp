@@ -0,0 +1,203 @@
+/**
+ * @file SimI2c.hpp
+ * @brief Simulated I2C bus lines and devices for host driver tests.
+ *
+ * I2cBus bit-bangs PB6/PB7. SimI2cBus watches those pins through the HAL
+ * stub's GPIO hooks and plays the slave side of every transaction, so the
+ * driver's START/STOP, clocking and ACK handling run against a live bus.
+ *
+ * Devices see the bus at byte level: start() when addressed (including a
+ * repeated start), write() per byte from the master (return false to
+ * NACK), read() per byte to the master, stop() on STOP.
+ */
+#pragma once
+
+#include "stm32f1xx_hal.h"
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace arcana {
+namespace test {
+
+class SimI2cDevice {
+public:
+    virtual ~SimI2cDevice() {}
+    virtual void start() {}
+    virtual bool write(uint8_t byte) = 0;
+    virtual uint8_t read() = 0;
+    virtual void stop() {}
+};
+
+/** Register-file device: the first byte written selects the register,
+ *  later bytes write it; reads continue from the selected register */
+class SimRegDevice : public SimI2cDevice {
+public:
+    uint8_t regs[256] = {};
+
+    void start() override { mSelect = true; }
+    bool write(uint8_t byte) override {
+        if (mSelect) { mPtr = byte; mSelect = false; return true; }
+        writeReg(mPtr, byte);
+        if (autoIncrement(mPtr)) mPtr++;
+        return true;
+    }
+    uint8_t read() override {
+        uint8_t v = readReg(mPtr);
+        if (autoIncrement(mPtr)) mPtr++;
+        return v;
+    }
+
+protected:
+    virtual void writeReg(uint8_t reg, uint8_t v) { regs[reg] = v; }
+    virtual uint8_t readReg(uint8_t reg) { return regs[reg]; }
+    virtual bool autoIncrement(uint8_t) const { return true; }
+
+    uint8_t mPtr = 0;
+    bool mSelect = true;
+};
+
+/**
+ * MPU6050 register map subset with a 1KB FIFO. produce(n) stands in for
+ * n sample periods: sample k is (k, -k, 16384 - k) and lands in the FIFO
+ * when accel FIFO is enabled. Overflow drops the oldest bytes and raises
+ * FIFO_OFLOW_INT, as the chip does.
+ */
+class SimMpu6050 : public SimRegDevice {
+public:
+    static const uint16_t FIFO_SIZE = 1024;
+    std::deque<uint8_t> fifo;
+    uint32_t produced = 0;
+
+    SimMpu6050() {
+        regs[0x75] = 0x68;       // WHO_AM_I
+        regs[0x6B] = 0x40;       // sleeping after reset
+    }
+
+    bool fifoEnabled() const { return (regs[0x6A] & 0x40) && (regs[0x23] & 0x08); }
+
+    /** Sample rate per SMPLRT_DIV: 1kHz base with DLPF on, 8kHz off */
+    uint32_t sampleRateHz() const {
+        uint8_t dlpf = regs[0x1A] & 0x07;
+        uint32_t base = (dlpf == 0 || dlpf == 7) ? 8000 : 1000;
+        return base / (1 + regs[0x19]);
+    }
+
+    static int16_t sampleX(uint32_t k) { return (int16_t)k; }
+    static int16_t sampleY(uint32_t k) { return (int16_t)-(int32_t)k; }
+    static int16_t sampleZ(uint32_t k) { return (int16_t)(16384 - (int32_t)k); }
+
+    void produce(uint32_t n) {
+        for (uint32_t i = 0; i < n; i++, produced++) {
+            int16_t v[3] = { sampleX(produced), sampleY(produced), sampleZ(produced) };
+            for (int a = 0; a < 3; a++) {
+                regs[0x3B + 2 * a] = (uint8_t)(v[a] >> 8);
+                regs[0x3C + 2 * a] = (uint8_t)v[a];
+            }
+            if (!fifoEnabled()) continue;
+            for (int a = 0; a < 6; a++) {
+                if (fifo.size() >= FIFO_SIZE) {
+                    fifo.pop_front();
+                    if (regs[0x38] & 0x10) regs[0x3A] |= 0x10;
+                }
+                fifo.push_back(regs[0x3B + a]);
+            }
+        }
+    }
+
+    void setTemperatureRaw(int16_t raw) {
+        regs[0x41] = (uint8_t)(raw >> 8);
+        regs[0x42] = (uint8_t)raw;
+    }
+
+protected:
+    void writeReg(uint8_t reg, uint8_t v) override {
+        if (reg == 0x6A && (v & 0x04)) {     // FIFO_RESET self-clears
+            fifo.clear();
+            v &= (uint8_t)~0x04;
+        }
+        regs[reg] = v;
+    }
+    uint8_t readReg(uint8_t reg) override {
+        switch (reg) {
+        case 0x3A: {                         // INT_STATUS clears on read
+            uint8_t s = regs[0x3A];
+            regs[0x3A] = 0;
+            return s;
+        }
+        case 0x72:
+            mCountLatch = (uint16_t)fifo.size();
+            return (uint8_t)(mCountLatch >> 8);
+        case 0x73:
+            return (uint8_t)mCountLatch;
+        case 0x74: {
+            if (fifo.empty()) return 0;
+            uint8_t b = fifo.front();
+            fifo.pop_front();
+            return b;
+        }
+        default:
+            return regs[reg];
+        }
+    }
+    bool autoIncrement(uint8_t reg) const override { return reg != 0x74; }
+
+private:
+    uint16_t mCountLatch = 0;
+};
+
+/**
+ * Open-drain PB6 (SCL) / PB7 (SDA) with the attached devices as slaves.
+ * Master pin writes arrive through the HAL stub's GPIO write hook and
+ * SDA reads through its read override; the model decodes START/STOP
+ * (SDA edges while SCL is high), clocks bits on SCL edges and drives SDA
+ * low for ACKs and for 0 bits while a device transmits.
+ */
+class SimI2cBus {
+public:
+    static SimI2cBus& instance();
+
+    void attach(uint8_t addr, SimI2cDevice* dev) { mDevices.push_back(std::make_pair(addr, dev)); }
+    /** Detach devices, release both lines and clear the counters */
+    void reset();
+
+    // A slave holding SDA low mid-byte: it lets go after STUCK_CLOCKS
+    // SCL pulses, as a real one finishing its byte would
+    static const uint8_t STUCK_CLOCKS = 4;
+    bool stuck = false;
+
+    uint32_t starts = 0;        // incl. repeated STARTs
+    uint32_t stops = 0;
+    uint32_t nacks = 0;         // bytes a slave did not ACK (incl. address)
+    uint32_t bytesRead = 0;     // bytes a device sent to the master
+
+    void pinWrite(uint16_t pin, bool high);
+    bool sdaLine() const { return mSda && !mSlaveLow && !stuck; }
+
+private:
+    enum Mode { IDLE, ADDR, WRITE, READ };
+
+    SimI2cDevice* find(uint8_t addr) const;
+    void onStart();
+    void onStop();
+    void sclRise();
+    void sclFall();
+    void driveBit();
+
+    std::vector<std::pair<uint8_t, SimI2cDevice*>> mDevices;
+    bool mScl = true;
+    bool mSda = true;           // master's side of SDA
+    bool mSlaveLow = false;     // slave pulling SDA low
+    Mode mMode = IDLE;
+    SimI2cDevice* mDev = nullptr;
+    uint8_t mClocks = 0;        // SCL pulses into the current byte (0..9)
+    bool mClocked = false;      // an SCL rise since the last START
+    uint8_t mShift = 0;
+    bool mAck = false;          // slave ACKed the byte just received
+    bool mMasterAck = false;    // master ACKed the byte just sent
+    uint8_t mStuckClocks = 0;
+};
+
+} // namespace test
+} // namespace arcana
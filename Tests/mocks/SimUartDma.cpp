@@ -0,0 +1,81 @@
+/**
+ * @file SimUartDma.cpp
+ * @brief SimUartDma channel model.
+ */
+#include "SimUartDma.hpp"
+#include <cstring>
+
+namespace arcana {
+namespace test {
+
+static void dmaHook(DMA_HandleTypeDef* hdma, uintptr_t src, uintptr_t dst, uint32_t len) {
+    SimUartDma::instance().dmaStart(hdma, src, dst, len);
+}
+
+SimUartDma& SimUartDma::instance() {
+    static SimUartDma sSim;
+    arcana_test_dma_hook = dmaHook;
+    return sSim;
+}
+
+void SimUartDma::dmaStart(DMA_HandleTypeDef* hdma, uintptr_t src, uintptr_t dst, uint32_t len) {
+    if (hdma->Init.Mode != DMA_CIRCULAR) return;
+    USART_TypeDef* const usarts[] = { USART1, USART2, USART3 };
+    USART_TypeDef* usart = nullptr;
+    for (USART_TypeDef* u : usarts) {
+        if (src == (uintptr_t)&u->DR) usart = u;
+    }
+    if (!usart) return;
+
+    Channel ch = { hdma, usart, reinterpret_cast<uint8_t*>(dst), len };
+    for (Channel& c : mChannels) {
+        if (c.usart == usart) {
+            c = ch;
+            return;
+        }
+    }
+    mChannels.push_back(ch);
+}
+
+const SimUartDma::Channel* SimUartDma::find(USART_TypeDef* usart) const {
+    for (const Channel& c : mChannels) {
+        if (c.usart == usart) return &c;
+    }
+    return nullptr;
+}
+
+bool SimUartDma::receive(USART_TypeDef* usart, const uint8_t* data, size_t len) {
+    const Channel* ch = find(usart);
+    if (!ch) return false;
+    DMA_HandleTypeDef* hdma = ch->hdma;
+    DMA_Channel_TypeDef* regs = hdma->Instance;
+    for (size_t i = 0; i < len; i++) {
+        // HAL_DMA_Abort leaves CNDTR at 0: the channel is off
+        if (regs->CNDTR == 0) return false;
+        ch->ring[ch->size - regs->CNDTR] = data[i];
+        regs->CNDTR = regs->CNDTR - 1;
+        if (regs->CNDTR == ch->size / 2) {
+            htEvents++;
+            if (hdma->XferHalfCpltCallback) hdma->XferHalfCpltCallback(hdma);
+        } else if (regs->CNDTR == 0) {
+            regs->CNDTR = ch->size;          // circular reload precedes the IRQ
+            tcEvents++;
+            if (hdma->XferCpltCallback) hdma->XferCpltCallback(hdma);
+        }
+    }
+    return true;
+}
+
+bool SimUartDma::receive(USART_TypeDef* usart, const char* text) {
+    return receive(usart, reinterpret_cast<const uint8_t*>(text), strlen(text));
+}
+
+uint16_t SimUartDma::position(USART_TypeDef* usart) const {
+    const Channel* ch = find(usart);
+    if (!ch) return 0;
+    uint32_t pos = ch->size - ch->hdma->Instance->CNDTR;
+    return (uint16_t)(pos == ch->size ? 0 : pos);
+}
+
+} // namespace test
+} // namespace arcana
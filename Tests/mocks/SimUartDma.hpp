@@ -0,0 +1,52 @@
+/**
+ * @file SimUartDma.hpp
+ * @brief Simulated circular USART RX DMA for host driver tests.
+ *
+ * A circular start on a USART's DR is picked up through
+ * arcana_test_dma_hook with the untruncated ring address. receive() then
+ * plays the channel: each byte lands at size - CNDTR, CNDTR counts down
+ * and reloads, and the half/full-transfer callbacks run where the
+ * hardware would raise HT and TC. IDLE is left to the test, which calls
+ * the driver's idle handler when the line would go quiet.
+ */
+#pragma once
+
+#include "stm32f1xx_hal.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace arcana {
+namespace test {
+
+class SimUartDma {
+public:
+    static SimUartDma& instance();
+
+    /** Bytes arriving on the RX pin; false when no RX channel is running */
+    bool receive(USART_TypeDef* usart, const uint8_t* data, size_t len);
+    bool receive(USART_TypeDef* usart, const char* text);
+
+    /** Where the channel writes the next byte (ring offset) */
+    uint16_t position(USART_TypeDef* usart) const;
+
+    uint32_t htEvents = 0;
+    uint32_t tcEvents = 0;
+
+    void dmaStart(DMA_HandleTypeDef* hdma, uintptr_t src, uintptr_t dst, uint32_t len);
+
+private:
+    struct Channel {
+        DMA_HandleTypeDef* hdma;
+        USART_TypeDef* usart;
+        uint8_t* ring;
+        uint32_t size;
+    };
+
+    const Channel* find(USART_TypeDef* usart) const;
+
+    std::vector<Channel> mChannels;
+};
+
+} // namespace test
+} // namespace arcana
@@ -109,8 +109,10 @@ public:
 class StubMutex : public arcana::ats::IMutex {
 public:
     int lockCount = 0;
+    int maxDepth = 0;     // >1 = nested lock (would deadlock a FreeRTOS mutex)
     bool lock(uint32_t /*timeoutMs*/ = 0xFFFFFFFF) override {
-        ++lockCount; return true;
+        if (++lockCount > maxDepth) maxDepth = lockCount;
+        return true;
     }
     void unlock() override { --lockCount; }
 };
@@ -0,0 +1,35 @@
+#pragma once
+/* Host-test mock for FreeRTOS event_groups.h
+ *
+ * Bits are really stored, so a test can see what a driver signalled.
+ * xEventGroupWaitBits never blocks: it returns the current bits and counts
+ * toward g_vTaskDelay_abort_after, like vTaskDelay, so task loops that
+ * sleep on a group can be broken out of.
+ */
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t EventBits_t;
+typedef void* EventGroupHandle_t;
+
+typedef struct StaticEventGroup_t {
+    EventBits_t bits;
+} StaticEventGroup_t;
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t* pxEventGroupBuffer);
+EventBits_t        xEventGroupSetBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet);
+BaseType_t         xEventGroupSetBitsFromISR(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet,
+                                             BaseType_t* pxHigherPriorityTaskWoken);
+EventBits_t        xEventGroupClearBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToClear);
+EventBits_t        xEventGroupGetBits(EventGroupHandle_t xEventGroup);
+EventBits_t        xEventGroupWaitBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToWaitFor,
+                                       BaseType_t xClearOnExit, BaseType_t xWaitForAllBits,
+                                       TickType_t xTicksToWait);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,7 +2,8 @@
  * @file ff_host_stub.cpp
  * @brief Tiny in-memory FatFs implementation for host tests.
  *
- * Backed by a std::vector<FileEntry>. Each entry holds the path + bytes.
+ * Backed by a std::deque<FileEntry>. Each entry holds the path + bytes;
+ * creating a file keeps the entries that open FILs point at in place.
  * Open/read/write/seek/lseek/unlink/rename are implemented enough to satisfy
  * RegistrationServiceImpl::saveToFile/loadFromFile and the FatFs paths inside
  * AtsStorageServiceImpl that don't require directory iteration.
@@ -13,6 +14,7 @@
 #include "ff.h"
 
 #include <cstring>
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -23,7 +25,7 @@ struct FileEntry {
     std::vector<uint8_t> bytes;
 };
 
-std::vector<FileEntry> g_files;
+std::deque<FileEntry> g_files;
 
 FileEntry* findEntry(const char* path) {
     for (auto& e : g_files) {
@@ -234,7 +236,7 @@ FRESULT f_rename(const char* old_path, const char* new_path) {
 FRESULT f_opendir(DIR* dp, const char* /*path*/) {
     if (!dp) return FR_INVALID_PARAMETER;
     auto* snap = new DirSnapshot{};
-    snap->entries = g_files;
+    snap->entries.assign(g_files.begin(), g_files.end());
     snap->index   = 0;
     dp->_dir = snap;
     return FR_OK;
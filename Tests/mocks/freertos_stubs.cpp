@@ -2,14 +2,20 @@
 #include "queue.h"
 #include "task.h"
 #include "timers.h"
+#include "event_groups.h"
 #include "cmsis_os.h"
 #include <cstring>
 #include <cstdlib>
 
 /* ── TickCount ──────────────────────────────────────────────────────────── */
 /* Monotonic incrementing tick — every read jumps by 100 ms-equivalent so
- * production polling loops with millisecond timeouts terminate quickly. */
+ * production polling loops with millisecond timeouts terminate quickly.
+ * Replays that need a controlled clock install g_xTaskGetTickCountOverride. */
+typedef TickType_t (*XTaskGetTickCountFn)(void);
+XTaskGetTickCountFn g_xTaskGetTickCountOverride = nullptr;
+
 extern "C" TickType_t xTaskGetTickCount(void) {
+    if (g_xTaskGetTickCountOverride) return g_xTaskGetTickCountOverride();
     static TickType_t sTick = 0;
     sTick += 100;
     return sTick;
@@ -69,7 +75,27 @@ extern "C" void vTaskDelayUntil(TickType_t* prev, TickType_t inc) {
     }
 }
 extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdTRUE; }
-extern "C" uint32_t   ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+/* Blocking on a notification is where an ISR would run: tests install
+ * g_ulTaskNotifyTakeOverride to play the peripheral while the task sleeps. */
+typedef uint32_t (*UlTaskNotifyTakeFn)(BaseType_t, TickType_t);
+UlTaskNotifyTakeFn g_ulTaskNotifyTakeOverride = nullptr;
+extern "C" uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+    if (g_ulTaskNotifyTakeOverride) return g_ulTaskNotifyTakeOverride(clear, wait);
+    return 0;
+}
+extern "C" void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t* pxWoken) {
+    if (pxWoken) *pxWoken = pdFALSE;
+}
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    static int dummy = 0;
+    return (TaskHandle_t)&dummy;
+}
+extern "C" BaseType_t xTaskGetSchedulerState(void) { return taskSCHEDULER_RUNNING; }
+/* Words of stack never touched — tests set it to play a deeper frame */
+UBaseType_t g_uxStackHighWaterMark = 1024;
+extern "C" UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) {
+    return g_uxStackHighWaterMark;
+}
 
 /* ── Timer stubs (store callback so tests can invoke it) ────────────────── */
 static TimerCallbackFunction_t s_timer_cb = nullptr;
@@ -99,26 +125,57 @@ void test_fire_timer_callback() {
 /* ── CMSIS-OS stub ──────────────────────────────────────────────────────── */
 extern "C" osStatus_t osDelay(uint32_t) { return 0; }
 
-/* ── Semaphore stubs (single-threaded host: take/give are no-ops) ─────── */
+/* ── Semaphore stubs (single-threaded host: take/give never block) ────── */
 #include "semphr.h"
 
 static int s_lock_balance = 0;
+static int s_self_deadlocks = 0;
+int test_semaphore_lock_balance() { return s_lock_balance; }
+int test_semaphore_self_deadlocks() { return s_self_deadlocks; }
+
+/* Static mutexes keep their state in the buffer: [0] marks a mutex,
+ * [1] is set while it is held. Everything runs on one host thread, so a
+ * take of a held mutex is the owner taking it again — a FreeRTOS mutex
+ * is not recursive, and on target that take never returns. */
+static const uint8_t MUTEX_MARK = 0x4D;
 
 extern "C" SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* p) {
+    p->opaque[0] = MUTEX_MARK;
+    p->opaque[1] = 0;
     return (SemaphoreHandle_t)p;
 }
 extern "C" SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* p) {
+    p->opaque[0] = 0;
     return (SemaphoreHandle_t)p;
 }
 extern "C" SemaphoreHandle_t xSemaphoreCreateMutex(void) {
     static int dummy = 0;
     return (SemaphoreHandle_t)&dummy;
 }
-extern "C" BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) {
+extern "C" SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t* p) {
+    p->opaque[0] = 0;
+    return (SemaphoreHandle_t)p;
+}
+extern "C" BaseType_t xSemaphoreTake(SemaphoreHandle_t h, TickType_t ticks) {
+    StaticSemaphore_t* s = (StaticSemaphore_t*)h;
+    if (s && s->opaque[0] == MUTEX_MARK) {
+        if (s->opaque[1] && ticks == portMAX_DELAY) ++s_self_deadlocks;
+        s->opaque[1] = 1;
+    }
+    ++s_lock_balance;
+    return pdTRUE;
+}
+extern "C" BaseType_t xSemaphoreGive(SemaphoreHandle_t h) {
+    StaticSemaphore_t* s = (StaticSemaphore_t*)h;
+    if (s && s->opaque[0] == MUTEX_MARK) s->opaque[1] = 0;
+    --s_lock_balance;
+    return pdTRUE;
+}
+extern "C" BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) {
     ++s_lock_balance;
     return pdTRUE;
 }
-extern "C" BaseType_t xSemaphoreGive(SemaphoreHandle_t) {
+extern "C" BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) {
     --s_lock_balance;
     return pdTRUE;
 }
@@ -128,3 +185,48 @@ extern "C" BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t,
     return pdTRUE;
 }
 extern "C" void vSemaphoreDelete(SemaphoreHandle_t) {}
+
+/* ── Event group stubs (bits stored, WaitBits never blocks) ─────────────── */
+/* Tests install g_xEventGroupWaitBitsOverride to set bits while the task
+ * "sleeps"; the timeout it was given is kept in g_xEventGroupWaitTicks. */
+typedef void (*XEventGroupWaitFn)(EventGroupHandle_t, TickType_t);
+XEventGroupWaitFn g_xEventGroupWaitBitsOverride = nullptr;
+TickType_t        g_xEventGroupWaitTicks = 0;
+
+extern "C" EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t* buf) {
+    buf->bits = 0;
+    return (EventGroupHandle_t)buf;
+}
+extern "C" EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits) {
+    StaticEventGroup_t* eg = (StaticEventGroup_t*)g;
+    eg->bits |= bits;
+    return eg->bits;
+}
+extern "C" BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t g, EventBits_t bits,
+                                                BaseType_t* pxWoken) {
+    if (pxWoken) *pxWoken = pdFALSE;
+    xEventGroupSetBits(g, bits);
+    return pdTRUE;
+}
+extern "C" EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits) {
+    StaticEventGroup_t* eg = (StaticEventGroup_t*)g;
+    EventBits_t before = eg->bits;
+    eg->bits &= ~bits;
+    return before;
+}
+extern "C" EventBits_t xEventGroupGetBits(EventGroupHandle_t g) {
+    return ((StaticEventGroup_t*)g)->bits;
+}
+extern "C" EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t wait,
+                                           BaseType_t clear, BaseType_t, TickType_t ticks) {
+    g_xEventGroupWaitTicks = ticks;
+    if (g_xEventGroupWaitBitsOverride) g_xEventGroupWaitBitsOverride(g, ticks);
+    if (g_vTaskDelay_abort_after > 0 &&
+        ++g_vTaskDelay_call_count >= g_vTaskDelay_abort_after) {
+        throw 1;
+    }
+    StaticEventGroup_t* eg = (StaticEventGroup_t*)g;
+    EventBits_t bits = eg->bits;
+    if (clear) eg->bits &= ~wait;
+    return bits;
+}
@@ -1,8 +1,9 @@
 #pragma once
 /* Host-test mock for FreeRTOS semphr.h
  *
- * Single-threaded host tests don't need real mutex semantics — Take/Give are
- * no-ops, but we keep a counter so test code can assert balanced lock/unlock.
+ * Single-threaded host tests don't need real mutex semantics — Take/Give
+ * never block, but we keep a counter so test code can assert balanced
+ * lock/unlock, and static mutexes count takes by their own holder.
  * Mutex creation returns a non-null cookie so callers see "success".
  */
 #include "FreeRTOS.h"
@@ -21,9 +22,12 @@ typedef struct StaticSemaphore_t {
 SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxSemaphoreBuffer);
 SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* pxSemaphoreBuffer);
 SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t* pxSemaphoreBuffer);
 BaseType_t        xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait);
 BaseType_t        xSemaphoreGive(SemaphoreHandle_t xSemaphore);
 BaseType_t        xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken);
+BaseType_t        xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xTicksToWait);
+BaseType_t        xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex);
 void              vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
 
 #ifdef __cplusplus
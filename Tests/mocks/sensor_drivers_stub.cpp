@@ -2,11 +2,12 @@
  * @file sensor_drivers_stub.cpp
  * @brief Host stubs for I2cBus + Mpu6050Sensor + Ap3216cSensor.
  *
- * Real drivers bit-bang I2C against PB6/PB7 — pure HW. The stubs provide
- * just enough symbols (singleton + init + read) for SensorServiceImpl /
+ * Real drivers bit-bang PB6/PB7 (test_i2c_drivers covers them against
+ * the simulated bus). The stubs provide just enough symbols
+ * (singleton + init + read + FIFO) for SensorServiceImpl /
  * LightServiceImpl to compile and run their lifecycle paths against host.
- * read() always returns invalid=true so the publish branch in the service
- * task body is also exercised when called directly.
+ * read() returns valid data and the FIFO hands out STUB_FIFO_FRAMES
+ * frames per drain, so the publish branches in the task bodies run.
  */
 #include "I2cBus.hpp"
 #include "Mpu6050Sensor.hpp"
@@ -14,7 +15,7 @@
 
 namespace arcana {
 
-I2cBus::I2cBus() {}
+I2cBus::I2cBus() : mMutex(0), mMutexBuf(), mErrors(0), mRecoveries(0) {}
 I2cBus& I2cBus::getInstance() {
     static I2cBus s;
     return s;
@@ -26,19 +27,9 @@ bool I2cBus::readRegs(uint8_t, uint8_t, uint8_t* buf, uint16_t len) {
     for (uint16_t i = 0; i < len; ++i) buf[i] = 0;
     return true;
 }
-void I2cBus::sclHigh() {}
-void I2cBus::sclLow()  {}
-void I2cBus::sdaHigh() {}
-void I2cBus::sdaLow()  {}
-bool I2cBus::sdaRead() { return true; }
-void I2cBus::delayUs(uint32_t) {}
-void I2cBus::start() {}
-void I2cBus::stop()  {}
-bool I2cBus::sendByte(uint8_t) { return true; }
-uint8_t I2cBus::recvByte(bool) { return 0; }
 
 namespace sensor {
-Mpu6050Sensor::Mpu6050Sensor() : mBus(nullptr) {}
+Mpu6050Sensor::Mpu6050Sensor() : mBus(nullptr), mFifo(false), mRateHz(0) {}
 void Mpu6050Sensor::init(I2cBus* bus) { mBus = bus; }
 Mpu6050Reading Mpu6050Sensor::read() {
     Mpu6050Reading r{};
@@ -46,6 +37,24 @@ Mpu6050Reading Mpu6050Sensor::read() {
     r.temperature = 25.0f;
     return r;
 }
+bool Mpu6050Sensor::enableFifo(uint16_t rateHz) {
+    mRateHz = rateHz;
+    mFifo = true;
+    return true;
+}
+Mpu6050FifoRead Mpu6050Sensor::readFifo(int16_t* xyz, uint16_t maxFrames) {
+    const uint16_t STUB_FIFO_FRAMES = 4;
+    uint16_t n = maxFrames < STUB_FIFO_FRAMES ? maxFrames : STUB_FIFO_FRAMES;
+    for (uint16_t i = 0; i < n * 3; ++i) xyz[i] = (int16_t)i;
+    Mpu6050FifoRead r{};
+    r.frames = n;
+    r.ok = true;
+    return r;
+}
+bool Mpu6050Sensor::readTemperature(float* celsius) {
+    *celsius = 25.0f;
+    return true;
+}
 } // namespace sensor
 
 namespace light {
@@ -118,8 +118,12 @@ extern USART_TypeDef* const USART3;
 #define USART_SR_TXE   ((uint32_t)0x0080)
 #define USART_SR_ORE   ((uint32_t)0x0008)
 #define USART_CR1_UE   ((uint32_t)0x2000)
+#define USART_CR3_DMAR ((uint32_t)0x0040)
+#define USART_CR3_DMAT ((uint32_t)0x0080)
+#define USART_CR1_TXEIE ((uint32_t)0x0080)
 #define USART_FLAG_RXNE USART_SR_RXNE
 #define USART_FLAG_IDLE USART_SR_IDLE
+#define USART_FLAG_ORE  USART_SR_ORE
 
 /* CoreDebug — I2cBus enables DWT cycle counter for delayUs */
 typedef struct {
@@ -158,6 +162,7 @@ typedef struct {
 #define UART_OVERSAMPLING_16 0x0000U
 #define UART_IT_RXNE         ((uint32_t)1)
 #define UART_IT_IDLE         ((uint32_t)2)
+#define UART_IT_ERR          ((uint32_t)3)
 
 typedef int HAL_StatusTypeDef;
 #define HAL_OK     0
@@ -269,6 +274,124 @@ extern RTC_TypeDef* const RTC;
 #define RTC_CRL_CNF     ((uint16_t)0x0010)
 #define RTC_CRL_RSF     ((uint16_t)0x0008)
 
+/* RCC / FSMC surface — Ili9341Lcd::initFsmc enables the FSMC clock and
+ * programs Bank1 NE4 timing. */
+#define __IO volatile
+typedef struct {
+    volatile uint32_t CR;
+    volatile uint32_t CFGR;
+    volatile uint32_t CIR;
+    volatile uint32_t APB2RSTR;
+    volatile uint32_t APB1RSTR;
+    volatile uint32_t AHBENR;
+    volatile uint32_t APB2ENR;
+    volatile uint32_t APB1ENR;
+} RCC_TypeDef;
+extern RCC_TypeDef* const RCC;
+#define RCC_AHBENR_FSMCEN ((uint32_t)0x00000100)
+
+typedef struct {
+    volatile uint32_t BTCR[8];
+} FSMC_Bank1_TypeDef;
+extern FSMC_Bank1_TypeDef* const FSMC_Bank1;
+
+void HAL_Delay(uint32_t ms);
+
+/* LCD command/data ports — on target these are FSMC addresses
+ * (0x6C000000 / 0x6D000000); on host they are plain RAM words. The DMA mock
+ * records addresses truncated to 32 bits, as HAL_DMA_Start_IT takes them. */
+extern volatile uint16_t arcana_test_lcd_cmd;
+extern volatile uint16_t arcana_test_lcd_data;
+#define LCD_FSMC_CMD_ADDR  ((uintptr_t)&arcana_test_lcd_cmd)
+#define LCD_FSMC_DATA_ADDR ((uintptr_t)&arcana_test_lcd_data)
+
+/* DMA surface — Ili9341Lcd drives DMA2 Channel1 memory-to-FSMC.
+ * HAL_DMA_Start_IT records a descriptor in arcana_test_dma_log and, unless
+ * arcana_test_dma_hold is set, completes at once via XferCpltCallback. */
+typedef struct {
+    volatile uint32_t CCR;
+    volatile uint32_t CNDTR;
+    volatile uint32_t CPAR;
+    volatile uint32_t CMAR;
+} DMA_Channel_TypeDef;
+extern DMA_Channel_TypeDef* const DMA2_Channel1;
+#define DMA_CCR_PINC ((uint32_t)0x00000040)
+#define DMA_CCR_MINC ((uint32_t)0x00000080)
+
+typedef struct {
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef* Instance;
+    DMA_InitTypeDef Init;
+    void* Parent;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef* hdma);
+} DMA_HandleTypeDef;
+#define __HAL_DMA_GET_COUNTER(h) ((h)->Instance->CNDTR)
+
+#define DMA_MEMORY_TO_MEMORY    ((uint32_t)0x00004000)
+#define DMA_PINC_ENABLE         DMA_CCR_PINC
+#define DMA_PINC_DISABLE        ((uint32_t)0x00000000)
+#define DMA_MINC_ENABLE         DMA_CCR_MINC
+#define DMA_MINC_DISABLE        ((uint32_t)0x00000000)
+#define DMA_PDATAALIGN_HALFWORD ((uint32_t)0x00000100)
+#define DMA_MDATAALIGN_HALFWORD ((uint32_t)0x00000400)
+#define DMA_NORMAL              ((uint32_t)0x00000000)
+#define DMA_PRIORITY_MEDIUM     ((uint32_t)0x00001000)
+#define DMA2_Channel1_IRQn      56
+#define __HAL_RCC_DMA2_CLK_ENABLE() ((void)0)
+#define DMA_PERIPH_TO_MEMORY    ((uint32_t)0x00000000)
+#define DMA_PDATAALIGN_BYTE     ((uint32_t)0x00000000)
+#define DMA_MDATAALIGN_BYTE     ((uint32_t)0x00000000)
+#define __HAL_RCC_DMA1_CLK_ENABLE() ((void)0)
+/* DMA1 Channel3 / Channel6 — USART3 / USART2 RX, circular. A circular start
+ * is left running: SimUartDma advances CNDTR and raises HT/TC. */
+extern DMA_Channel_TypeDef* const DMA1_Channel3;
+extern DMA_Channel_TypeDef* const DMA1_Channel6;
+#define DMA_CIRCULAR            ((uint32_t)0x00000020)
+#define DMA1_Channel3_IRQn      13
+#define DMA1_Channel6_IRQn      16
+/* DMA1 Channel2 — USART3 TX */
+extern DMA_Channel_TypeDef* const DMA1_Channel2;
+#define DMA_MEMORY_TO_PERIPH    ((uint32_t)0x00000010)
+#define DMA_PRIORITY_LOW        ((uint32_t)0x00000000)
+#define DMA1_Channel2_IRQn      12
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) \
+    ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+
+typedef struct {
+    uint32_t src;
+    uint32_t dst;
+    uint32_t length;
+    uint32_t srcInc;     /* CCR.PINC at start — source side in MEM2MEM */
+    uint32_t dstInc;     /* CCR.MINC at start */
+} ArcanaTestDmaXfer;
+#define ARCANA_TEST_DMA_LOG_MAX 64
+extern ArcanaTestDmaXfer arcana_test_dma_log[ARCANA_TEST_DMA_LOG_MAX];
+extern uint32_t arcana_test_dma_count;   /* total starts, may exceed log size */
+extern int arcana_test_dma_hold;         /* 1 = leave transfers pending */
+/* Optional data mover, called at each start with the untruncated addresses
+ * (peripheral models such as the UART sim copy their bytes here) */
+extern void (*arcana_test_dma_hook)(DMA_HandleTypeDef* hdma, uintptr_t src,
+                                    uintptr_t dst, uint32_t length);
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma);
+/* Addresses are uintptr_t on host so 64-bit buffers survive; the target
+ * HAL takes uint32_t, which is the same width there */
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef* hdma, uintptr_t src,
+                                   uintptr_t dst, uint32_t length);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma);
+
 /* ADC surface — RegistrationServiceImpl::ueccRng() XORs ADC1->DR for entropy */
 typedef struct {
     volatile uint32_t SR;
@@ -307,3 +430,4 @@ extern ADC_TypeDef* const ADC1;
 
 /* SystemCoreClock — declared at C++ linkage to match CMSIS system header */
 extern uint32_t SystemCoreClock;
+
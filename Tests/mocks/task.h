@@ -8,6 +8,10 @@ typedef void (*TaskFunction_t)(void*);
 
 #define tskIDLE_PRIORITY ((UBaseType_t)0)
 
+#define taskSCHEDULER_SUSPENDED   ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING     ((BaseType_t)2)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -21,10 +25,18 @@ void         vTaskDelayUntil(TickType_t* pxPreviousWakeTime,
                              TickType_t xTimeIncrement);
 BaseType_t   xTaskNotifyGive(TaskHandle_t xTaskToNotify);
 uint32_t     ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+void         vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify,
+                                    BaseType_t* pxHigherPriorityTaskWoken);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t   xTaskGetSchedulerState(void);
+UBaseType_t  uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
 #ifdef __cplusplus
 }
 #endif
 
+/* ISR variant reads the same host clock */
+#define xTaskGetTickCountFromISR()            xTaskGetTickCount()
+
 /* Critical section + ISR mask helpers — host stubs are no-ops */
 #define taskENTER_CRITICAL()                  ((void)0)
 #define taskEXIT_CRITICAL()                   ((void)0)
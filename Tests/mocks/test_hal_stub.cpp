@@ -44,8 +44,12 @@ GPIO_TypeDef* const GPIOE = &sGpioeStorage;
 GPIO_TypeDef* const GPIOF = &sGpiofStorage;
 GPIO_TypeDef* const GPIOG = &sGpiogStorage;
 
-void HAL_GPIO_WritePin(GPIO_TypeDef* /*port*/, uint16_t /*pin*/, GPIO_PinState /*state*/) {
-    /* no-op — Led + other services call this; tests don't inspect GPIO state */
+/* Write hook — no-op by default (Led + other services call this). Pin-level
+ * models such as the I2C sim install themselves here. */
+void (*g_hal_gpio_write_hook)(GPIO_TypeDef*, uint16_t, GPIO_PinState) = nullptr;
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+    if (g_hal_gpio_write_hook) g_hal_gpio_write_hook(port, pin, state);
 }
 
 /* ADC1 stub — DR field reads as 0; only used as entropy source mix-in. */
@@ -102,6 +106,69 @@ RTC_TypeDef* const RTC = &sRtcStorage;
 
 void HAL_PWR_EnableBkUpAccess(void) {}
 
+/* RCC / FSMC register storage — Ili9341Lcd::initFsmc */
+static RCC_TypeDef sRccStorage = {};
+RCC_TypeDef* const RCC = &sRccStorage;
+static FSMC_Bank1_TypeDef sFsmcStorage = {};
+FSMC_Bank1_TypeDef* const FSMC_Bank1 = &sFsmcStorage;
+void HAL_Delay(uint32_t /*ms*/) {}
+
+volatile uint16_t arcana_test_lcd_cmd  = 0;
+volatile uint16_t arcana_test_lcd_data = 0;
+
+/* DMA mock — records every start; completes synchronously unless held, so
+ * the driver's wait-for-completion path sees the callback like an ISR. */
+static DMA_Channel_TypeDef sDma2Ch1Storage = {};
+DMA_Channel_TypeDef* const DMA2_Channel1 = &sDma2Ch1Storage;
+static DMA_Channel_TypeDef sDma1Ch2Storage = {};
+DMA_Channel_TypeDef* const DMA1_Channel2 = &sDma1Ch2Storage;
+static DMA_Channel_TypeDef sDma1Ch3Storage = {};
+DMA_Channel_TypeDef* const DMA1_Channel3 = &sDma1Ch3Storage;
+static DMA_Channel_TypeDef sDma1Ch6Storage = {};
+DMA_Channel_TypeDef* const DMA1_Channel6 = &sDma1Ch6Storage;
+void (*arcana_test_dma_hook)(DMA_HandleTypeDef*, uintptr_t, uintptr_t, uint32_t) = nullptr;
+ArcanaTestDmaXfer arcana_test_dma_log[ARCANA_TEST_DMA_LOG_MAX];
+uint32_t arcana_test_dma_count = 0;
+int arcana_test_dma_hold = 0;
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma) {
+    hdma->Instance->CCR = hdma->Init.Direction | hdma->Init.PeriphInc |
+                          hdma->Init.MemInc | hdma->Init.PeriphDataAlignment |
+                          hdma->Init.MemDataAlignment | hdma->Init.Mode |
+                          hdma->Init.Priority;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef* hdma, uintptr_t src,
+                                   uintptr_t dst, uint32_t length) {
+    if (arcana_test_dma_count < ARCANA_TEST_DMA_LOG_MAX) {
+        ArcanaTestDmaXfer& x = arcana_test_dma_log[arcana_test_dma_count];
+        x.src = (uint32_t)src;
+        x.dst = (uint32_t)dst;
+        x.length = length;
+        x.srcInc = (hdma->Instance->CCR & DMA_CCR_PINC) ? 1 : 0;
+        x.dstInc = (hdma->Instance->CCR & DMA_CCR_MINC) ? 1 : 0;
+    }
+    arcana_test_dma_count++;
+    hdma->Instance->CPAR = (uint32_t)src;
+    hdma->Instance->CMAR = (uint32_t)dst;
+    if (arcana_test_dma_hook) arcana_test_dma_hook(hdma, src, dst, length);
+    hdma->Instance->CNDTR = length;
+    if (hdma->Init.Mode == DMA_CIRCULAR) return HAL_OK;   // never completes
+    if (!arcana_test_dma_hold) HAL_DMA_IRQHandler(hdma);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma) {
+    hdma->Instance->CNDTR = 0;
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma) {
+    hdma->Instance->CNDTR = 0;
+    if (hdma->XferCpltCallback) hdma->XferCpltCallback(hdma);
+}
+
 /* Make NVIC_SystemReset a controllable abort point: tests can throw via the
  * exception path to verify the call site is reached without actually
  * resetting the host process. The default no-op behavior lets unit tests
@@ -1,3 +1,7 @@
 #pragma once
 /* Test-only helpers — declared in freertos_stubs.cpp */
 void test_fire_timer_callback();
+/* Semaphore takes minus gives so far (mutexes currently held) */
+int test_semaphore_lock_balance();
+/* Takes (portMAX_DELAY) of a static mutex already held — deadlocks on target */
+int test_semaphore_self_deadlocks();
@@ -0,0 +1,295 @@
+/**
+ * @file test_acquisition_schedule.cpp
+ * @brief AcquisitionSchedule: multi-rate releases, bursts, jitter and
+ *        missed-deadline accounting against a fake microsecond clock.
+ *
+ * The fake clock advances only when a sample function says a transaction
+ * took time, so lateness and bus occupancy come out exact.
+ */
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "AcquisitionSchedule.hpp"
+
+using arcana::AcqPlan;
+using arcana::AcqSlot;
+using arcana::AcqStatus;
+using arcana::AcquisitionSchedule;
+using arcana::AcquisitionStatsModel;
+
+namespace {
+
+uint32_t gUs = 0;
+uint32_t fakeClock() { return gUs; }
+
+struct Event {
+    int id;
+    uint32_t dueMs;
+    uint32_t stampMs;
+    uint32_t stampUs;
+    uint8_t index;
+};
+
+struct Probe {
+    int id = 0;
+    uint32_t costUs = 0;              // bus time per transaction
+    AcqStatus result = AcqStatus::Done;
+    uint8_t moreUntil = 0;            // return More for index < moreUntil
+    std::vector<Event>* log = nullptr;
+};
+
+AcqStatus sample(void* ctx, const AcqSlot& slot) {
+    Probe* p = static_cast<Probe*>(ctx);
+    p->log->push_back(Event{ p->id, slot.dueMs, slot.stampMs, slot.stampUs, slot.index });
+    gUs += p->costUs;
+    if (slot.index + 1 < p->moreUntil) return AcqStatus::More;
+    return p->result;
+}
+
+/** Advance both time bases to a tick and run what is due, as the task does */
+uint8_t tickTo(AcquisitionSchedule& s, uint32_t baseUs, uint32_t ms, uint32_t latencyUs = 0) {
+    gUs = baseUs + ms * 1000 + latencyUs;
+    return s.runDue(ms);
+}
+
+class AcquisitionScheduleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        gUs = 5000000;
+        s.setClock(fakeClock);
+    }
+    AcqPlan plan(Probe& p, uint32_t period, uint32_t phase, uint8_t burst = 1) {
+        p.log = &log;
+        AcqPlan a = { sample, &p, period, phase, burst };
+        return a;
+    }
+    AcquisitionSchedule s;
+    std::vector<Event> log;
+};
+
+} // namespace
+
+TEST_F(AcquisitionScheduleTest, RejectsBadPlansAndFreezesAfterStart) {
+    Probe a, b;
+    AcqPlan bad = plan(a, 0, 0);
+    EXPECT_FALSE(s.add(bad));
+    AcqPlan none = { nullptr, &a, 10, 0, 1 };
+    EXPECT_FALSE(s.add(none));
+
+    EXPECT_TRUE(s.add(plan(a, 10, 0)));
+    // Same sample/ctx replaces, does not add
+    EXPECT_TRUE(s.add(plan(a, 20, 5)));
+    EXPECT_EQ(s.planCount(), 1u);
+
+    s.start(0);
+    EXPECT_FALSE(s.add(plan(b, 10, 0)));
+    EXPECT_EQ(s.planCount(), 1u);
+}
+
+TEST_F(AcquisitionScheduleTest, TableIsBounded) {
+    Probe p[AcquisitionSchedule::MAX_PLANS + 1];
+    for (uint8_t i = 0; i < AcquisitionSchedule::MAX_PLANS; i++) {
+        EXPECT_TRUE(s.add(plan(p[i], 10, 0)));
+    }
+    EXPECT_FALSE(s.add(plan(p[AcquisitionSchedule::MAX_PLANS], 10, 0)));
+}
+
+TEST_F(AcquisitionScheduleTest, MultiRatePlansReleaseOnTheirGrids) {
+    Probe fast, slow;
+    fast.id = 1;
+    slow.id = 2;
+    s.add(plan(fast, 10, 0));
+    s.add(plan(slow, 25, 3));
+
+    uint32_t base = gUs - 1000;       // tick 1 maps to the current clock
+    s.start(1);
+    uint32_t releases = 0;
+    for (uint32_t ms = 1; ms <= 100; ms++) {
+        releases += tickTo(s, base, ms);
+        EXPECT_EQ(s.nextDueMs(ms, 1000) > ms, true);
+    }
+
+    uint32_t nFast = 0, nSlow = 0;
+    for (const Event& e : log) {
+        if (e.id == 1) {
+            EXPECT_EQ((e.dueMs - 1) % 10, 0u);
+            nFast++;
+        } else {
+            EXPECT_EQ((e.dueMs - 4) % 25, 0u);
+            nSlow++;
+        }
+        // Released on the due tick itself
+        EXPECT_EQ(e.stampMs, e.dueMs);
+    }
+    EXPECT_EQ(nFast, 10u);            // 1, 11, ... 91
+    EXPECT_EQ(nSlow, 4u);             // 4, 29, 54, 79
+    EXPECT_EQ(releases, nFast + nSlow);
+}
+
+TEST_F(AcquisitionScheduleTest, CollidingReleasesAreSerializedEarliestFirst) {
+    Probe a, b;
+    a.id = 1;
+    a.costUs = 300;
+    b.id = 2;
+    b.costUs = 200;
+    // b registered second but due earlier: it goes first; then a
+    s.add(plan(a, 10, 5));
+    s.add(plan(b, 10, 4));
+
+    uint32_t base = gUs;
+    s.start(0);
+    EXPECT_EQ(s.nextDueMs(0, 1000), 4u);
+    // Task woke late: both due at once
+    EXPECT_EQ(tickTo(s, base, 6), 2u);
+    ASSERT_EQ(log.size(), 2u);
+    EXPECT_EQ(log[0].id, 2);
+    EXPECT_EQ(log[1].id, 1);
+    // Transactions do not overlap: the second starts when the first ends
+    EXPECT_EQ(log[1].stampUs, log[0].stampUs + 200);
+
+    AcquisitionStatsModel m;
+    s.collect(m, 10);
+    EXPECT_EQ(m.plan[1].jitterMaxUs, 2000u);      // due 4, ran at 6
+    EXPECT_EQ(m.plan[0].jitterMaxUs, 1200u);      // due 5, after b's 200us
+    EXPECT_EQ(m.plan[0].busMaxUs, 300u);
+    EXPECT_EQ(m.busyPermille, 50u);               // 500us in 10ms
+}
+
+TEST_F(AcquisitionScheduleTest, EqualDueTimesKeepTableOrder) {
+    Probe a, b;
+    a.id = 1;
+    b.id = 2;
+    s.add(plan(a, 10, 0));
+    s.add(plan(b, 10, 0));
+    uint32_t base = gUs;
+    s.start(0);
+    tickTo(s, base, 0);
+    ASSERT_EQ(log.size(), 2u);
+    EXPECT_EQ(log[0].id, 1);
+    EXPECT_EQ(log[1].id, 2);
+}
+
+TEST_F(AcquisitionScheduleTest, BurstRunsUntilDoneOrLength) {
+    Probe drain;
+    drain.costUs = 100;
+    drain.moreUntil = 10;             // would keep going past the burst
+    drain.result = AcqStatus::Done;
+    s.add(plan(drain, 20, 0, 4));
+    uint32_t base = gUs;
+    s.start(0);
+    tickTo(s, base, 0);
+    ASSERT_EQ(log.size(), 4u);
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_EQ(log[i].index, i);
+        EXPECT_EQ(log[i].stampUs, base + i * 100u);
+        EXPECT_EQ(log[i].dueMs, 0u);
+    }
+
+    // Ends early when the sample reports Done
+    log.clear();
+    drain.moreUntil = 2;
+    tickTo(s, base, 20);
+    EXPECT_EQ(log.size(), 2u);
+
+    AcquisitionStatsModel m;
+    s.collect(m, 40);
+    EXPECT_EQ(m.plan[0].releases, 2u);
+    EXPECT_EQ(m.plan[0].busMaxUs, 400u);
+    EXPECT_EQ(m.plan[0].errors, 0u);
+}
+
+TEST_F(AcquisitionScheduleTest, ErrorEndsBurstAndIsCounted) {
+    Probe p;
+    p.moreUntil = 3;
+    p.result = AcqStatus::Error;
+    s.add(plan(p, 10, 0, 5));
+    uint32_t base = gUs;
+    s.start(0);
+    tickTo(s, base, 0);
+    EXPECT_EQ(log.size(), 3u);
+    AcquisitionStatsModel m;
+    s.collect(m, 10);
+    EXPECT_EQ(m.plan[0].errors, 1u);
+    EXPECT_EQ(m.plan[0].releases, 1u);
+}
+
+TEST_F(AcquisitionScheduleTest, OverrunSkipsSlotsAndCountsThemMissed) {
+    Probe p;
+    s.add(plan(p, 10, 0));
+    uint32_t base = gUs;
+    s.start(0);
+    tickTo(s, base, 0);
+    // Blocked until tick 37: slots 10, 20 are gone, 30 runs late
+    EXPECT_EQ(tickTo(s, base, 37), 1u);
+    ASSERT_EQ(log.size(), 2u);
+    EXPECT_EQ(log[1].dueMs, 30u);
+    EXPECT_EQ(log[1].stampMs, 37u);
+    // Grid kept: next release is 40, not 47
+    EXPECT_EQ(s.nextDueMs(37, 1000), 40u);
+
+    AcquisitionStatsModel m;
+    s.collect(m, 40);
+    EXPECT_EQ(m.plan[0].missed, 2u);
+    EXPECT_EQ(m.plan[0].releases, 2u);
+    EXPECT_EQ(m.plan[0].jitterMaxUs, 7000u);
+    EXPECT_EQ(m.plan[0].jitterAvgUs, 3500u);
+    EXPECT_EQ(m.totalMissed, 2u);
+    EXPECT_EQ(m.windowMs, 40u);
+
+    // New window: counters reset, the running total does not
+    tickTo(s, base, 40);
+    s.collect(m, 50);
+    EXPECT_EQ(m.plan[0].missed, 0u);
+    EXPECT_EQ(m.plan[0].releases, 1u);
+    EXPECT_EQ(m.plan[0].jitterMaxUs, 0u);
+    EXPECT_EQ(m.totalMissed, 2u);
+}
+
+TEST_F(AcquisitionScheduleTest, JitterIsWakeLatencyWithinTheTick) {
+    Probe p;
+    s.add(plan(p, 5, 0));
+    uint32_t base = gUs;
+    s.start(0);
+    const uint32_t latency[] = { 0, 40, 15, 90 };
+    for (uint32_t k = 0; k < 4; k++) tickTo(s, base, k * 5, latency[k]);
+    AcquisitionStatsModel m;
+    s.collect(m, 20);
+    EXPECT_EQ(m.plan[0].releases, 4u);
+    EXPECT_EQ(m.plan[0].jitterMaxUs, 90u);
+    EXPECT_EQ(m.plan[0].jitterAvgUs, 36u);        // 145 / 4
+    EXPECT_EQ(m.plan[0].missed, 0u);
+    for (const Event& e : log) EXPECT_EQ(e.stampMs, e.dueMs);
+}
+
+TEST_F(AcquisitionScheduleTest, TimeBasesWrapTogether) {
+    Probe p;
+    s.add(plan(p, 10, 0));
+    // Both counters a few ticks short of wrapping
+    uint32_t startMs = 0xFFFFFFF0u;
+    gUs = 0xFFFFF000u;
+    uint32_t base = gUs - startMs * 1000u;
+    s.start(startMs);
+    for (uint32_t k = 0; k < 4; k++) {
+        uint32_t ms = startMs + k * 10;
+        gUs = base + ms * 1000u + 25;
+        EXPECT_EQ(s.runDue(ms), 1u);
+    }
+    ASSERT_EQ(log.size(), 4u);
+    EXPECT_EQ(log[3].dueMs, startMs + 30);
+    EXPECT_EQ(log[3].stampMs, log[3].dueMs);
+    AcquisitionStatsModel m;
+    s.collect(m, startMs + 40);
+    EXPECT_EQ(m.plan[0].jitterMaxUs, 25u);
+    EXPECT_EQ(m.plan[0].missed, 0u);
+}
+
+TEST_F(AcquisitionScheduleTest, IdleScheduleWaitsTheIdleBound) {
+    EXPECT_EQ(s.runDue(0), 0u);
+    EXPECT_EQ(s.nextDueMs(100, 1000), 1100u);
+    s.start(100);
+    EXPECT_EQ(s.nextDueMs(100, 1000), 1100u);
+    AcquisitionStatsModel m;
+    s.collect(m, 1100);
+    EXPECT_EQ(m.planCount, 0u);
+    EXPECT_EQ(m.busyPermille, 0u);
+}
@@ -19,10 +19,12 @@
 using arcana::ats::ArcanaTsDb;
 using arcana::ats::ArcanaTsSchema;
 using arcana::ats::AtsConfig;
+using arcana::ats::AtsCursor;
 using arcana::ats::OverflowPolicy;
 using arcana::ats::FieldType;
 using arcana::ats::BLOCK_SIZE;
 using arcana::ats::BLOCK_PAYLOAD_SIZE;
+using arcana::ats::BLOCK_HEADER_SIZE;
 using arcana::ats::MAX_CHANNELS;
 using arcana::ats::MULTI_CHANNEL_ID;
 
@@ -949,6 +951,124 @@ TEST(ArcanaTsDbEdgeTest, IndexEvictionAtMaxEntries) {
     db.close();
 }
 
+// ── readFrom: cursor replay ─────────────────────────────────────────────────
+
+TEST(ArcanaTsDbEdgeTest, ReadFromWalksSingleChannelBlocksAndResumes) {
+    DbCtx d;
+    TestClock::reset();
+    ArcanaTsDb db;
+    ASSERT_TRUE(db.open("rf.ats", d.makeCfg(/*primary*/0)));
+    ASSERT_TRUE(db.addChannel(0, makeAdcSchema()));
+    ASSERT_TRUE(db.start());
+
+    // 508 records per block → 2 full blocks + 1 partial after flush()
+    uint8_t rec[8];
+    for (uint32_t i = 0; i < 1100; ++i) {
+        mkRec(rec, i, i);
+        ASSERT_TRUE(db.append(0, rec));
+    }
+    ASSERT_TRUE(db.flush());
+    EXPECT_EQ(db.headCursor().block, 4u);
+
+    AtsCursor cur{0, 0};              // clamped to the first data block
+    std::vector<uint8_t> out(8 * 700);
+    uint32_t next = 0;
+    uint16_t n;
+    while ((n = db.readFrom(0, cur, db.headCursor().block, out.data(), 300)) > 0) {
+        for (uint16_t k = 0; k < n; ++k) {
+            uint32_t v;
+            std::memcpy(&v, out.data() + k * 8 + 4, 4);
+            ASSERT_EQ(v, next);
+            next++;
+        }
+    }
+    EXPECT_EQ(next, 1100u);
+    EXPECT_EQ(cur.block, 4u);
+    EXPECT_EQ(cur.record, 0u);
+
+    // Resume mid-block; endBlock stops short of the head
+    cur = {1, 500};
+    EXPECT_EQ(db.readFrom(0, cur, 2, out.data(), 700), 8u);
+    EXPECT_EQ(cur.block, 2u);
+    EXPECT_EQ(d.mutex.maxDepth, 1);
+    db.close();
+}
+
+TEST(ArcanaTsDbEdgeTest, ReadFromPicksChannelOutOfMultiChannelBlocks) {
+    DbCtx d;
+    TestClock::reset();
+    ArcanaTsDb db;
+    ASSERT_TRUE(db.open("rfm.ats", d.makeCfg(/*primary*/0xFF)));
+    ASSERT_TRUE(db.addChannel(0, makeAdcSchema()));
+    ASSERT_TRUE(db.addChannel(1, makeAdcSchema()));
+    ASSERT_TRUE(db.start());
+
+    uint8_t rec[8];
+    for (uint32_t i = 0; i < 600; ++i) {
+        mkRec(rec, i, i);
+        ASSERT_TRUE(db.append(0, rec));
+        mkRec(rec, i, 100000 + i);
+        ASSERT_TRUE(db.append(1, rec));
+    }
+    ASSERT_TRUE(db.flush());
+
+    AtsCursor cur = db.headCursor();
+    cur.block = 1;
+    std::vector<uint8_t> out(8 * 64);
+    uint32_t next = 0;
+    uint16_t n;
+    while ((n = db.readFrom(1, cur, 0xFFFFFFFF, out.data(), 64)) > 0) {
+        for (uint16_t k = 0; k < n; ++k) {
+            uint32_t v;
+            std::memcpy(&v, out.data() + k * 8 + 4, 4);
+            ASSERT_EQ(v, 100000 + next);
+            next++;
+        }
+    }
+    EXPECT_EQ(next, 600u);
+    EXPECT_EQ(cur.block, db.headCursor().block);
+    db.close();
+}
+
+TEST(ArcanaTsDbEdgeTest, ReadFromSkipsCorruptBlock) {
+    DbCtx d;
+    TestClock::reset();
+    ArcanaTsDb db;
+    ASSERT_TRUE(db.open("rfc.ats", d.makeCfg(/*primary*/0)));
+    ASSERT_TRUE(db.addChannel(0, makeAdcSchema()));
+    ASSERT_TRUE(db.start());
+
+    uint8_t rec[8];
+    for (uint32_t i = 0; i < 508 * 3; ++i) {
+        mkRec(rec, i, i);
+        ASSERT_TRUE(db.append(0, rec));
+    }
+    ASSERT_TRUE(db.flush());
+
+    d.file.data[2 * BLOCK_SIZE + BLOCK_HEADER_SIZE + 10] ^= 0x5A;   // block 2 payload
+
+    AtsCursor cur{1, 0};
+    std::vector<uint8_t> out(8 * 508 * 3);
+    uint16_t total = 0, n;
+    while ((n = db.readFrom(0, cur, 0xFFFFFFFF, out.data() + total * 8, 508)) > 0) total += n;
+    EXPECT_EQ(total, 508u * 2);
+    uint32_t v;
+    std::memcpy(&v, out.data() + 508 * 8 + 4, 4);
+    EXPECT_EQ(v, 508u * 2);                 // block 3 follows block 1
+    EXPECT_EQ(cur.block, 4u);
+    db.close();
+}
+
+TEST(ArcanaTsDbEdgeTest, ReadFromOnClosedDbReturnsNothing) {
+    DbCtx d;
+    ArcanaTsDb db;
+    AtsCursor cur{1, 0};
+    uint8_t out[8];
+    EXPECT_EQ(db.readFrom(0, cur, 10, out, 1), 0u);
+    EXPECT_EQ(db.headCursor().block, 1u);
+    EXPECT_EQ(db.getCreatedEpoch(), 0u);
+}
+
 // ── Schema accessors / record-size math ──────────────────────────────────────
 
 TEST(ArcanaTsSchemaTest, PredefinedSchemasHaveCorrectRecordSizes) {
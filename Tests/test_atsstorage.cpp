@@ -49,10 +49,14 @@ struct AtsStorageTestAccess {
     }
     static void serialize(AtsStorageServiceImpl& s,
                           const SensorDataModel* m, uint8_t* buf) {
-        s.serializeRecord(m, buf);
+        TelemetrySample t;
+        t.setSensor(*m);
+        s.serializeRecord(t, buf);
     }
     static void appendRecord(AtsStorageServiceImpl& s, const SensorDataModel* m) {
-        s.appendRecord(m);
+        TelemetrySample t;
+        t.setSensor(*m);
+        s.appendRecord(t);
     }
     static void publish(AtsStorageServiceImpl& s) { s.publishStats(); }
     static uint32_t totalRecords(AtsStorageServiceImpl& s) { return s.mTotalRecords; }
@@ -71,6 +75,8 @@ struct AtsStorageTestAccess {
     static ats::FatFsFilePort& filePort(AtsStorageServiceImpl& s)        { return s.mFilePort; }
     static ats::FatFsFilePort& deviceFilePort(AtsStorageServiceImpl& s) { return s.mDeviceFilePort; }
     static ats::FreeRtosMutex& mutex(AtsStorageServiceImpl& s)          { return s.mMutex; }
+    static volatile bool& cursorPosted(AtsStorageServiceImpl& s)        { return s.mCursorPosted; }
+    static void savePostedCursor(AtsStorageServiceImpl& s) { s.savePostedMqttCursor(); }
 };
 
 }} // namespace arcana::atsstorage
@@ -100,6 +106,7 @@ void resetEnvironment() {
      * so the dtor doesn't traverse closed paths. */
     AtsStorageTestAccess::dbReady(s)       = false;
     AtsStorageTestAccess::deviceDbReady(s) = false;
+    AtsStorageTestAccess::cursorPosted(s)  = false;
     test_ff_reset();
     SystemClock::getInstance().resetForTest();
 
@@ -175,8 +182,8 @@ TEST(AtsStorageOpen, OpenDeviceDbCreatesFileAndChannels) {
     EXPECT_TRUE(AtsStorageTestAccess::openDeviceDb(s));
     EXPECT_TRUE(AtsStorageTestAccess::deviceDbReady(s));
     EXPECT_TRUE(test_ff_exists("device.ats"));
-    /* Three channels: LIFECYCLE, CONFIG, CREDS */
-    EXPECT_EQ(AtsStorageTestAccess::deviceDb(s).getChannelCount(), 3u);
+    /* Four channels: LIFECYCLE, CONFIG, CREDS, MQTT_CURSOR */
+    EXPECT_EQ(AtsStorageTestAccess::deviceDb(s).getChannelCount(), 4u);
 }
 
 TEST(AtsStorageOpen, OpenDailyDbCreatesSensorFile) {
@@ -321,6 +328,58 @@ TEST(AtsStorageTimezone, NegativeTzOffset) {
     EXPECT_EQ(auto_, 0);
 }
 
+// ── loadMqttCursor / saveMqttCursor ────────────────────────────────────────
+
+TEST(AtsStorageMqttCursor, SaveLoadRoundTripKeepsLatest) {
+    resetEnvironment();
+    auto& s = storage();
+    ASSERT_TRUE(bootStorage());
+
+    uint32_t fileId = 0;
+    arcana::ats::AtsCursor cur = {0, 0};
+    EXPECT_FALSE(s.loadMqttCursor(fileId, cur));
+
+    EXPECT_TRUE(s.saveMqttCursor(1700000000u, arcana::ats::AtsCursor{5, 17}));
+    EXPECT_TRUE(s.saveMqttCursor(1700000000u, arcana::ats::AtsCursor{9, 260}));
+    ASSERT_TRUE(s.loadMqttCursor(fileId, cur));
+    EXPECT_EQ(fileId, 1700000000u);
+    EXPECT_EQ(cur.block, 9u);
+    EXPECT_EQ(cur.record, 260u);
+}
+
+TEST(AtsStorageMqttCursor, SkippedWhenDbNotReady) {
+    resetEnvironment();
+    auto& s = storage();
+    uint32_t fileId = 0;
+    arcana::ats::AtsCursor cur = {0, 0};
+    EXPECT_FALSE(s.saveMqttCursor(1, cur));
+    EXPECT_FALSE(s.postMqttCursor(1, cur));
+    EXPECT_FALSE(s.loadMqttCursor(fileId, cur));
+}
+
+TEST(AtsStorageMqttCursor, PostedCursorIsWrittenByStorageTaskOnly) {
+    resetEnvironment();
+    auto& s = storage();
+    ASSERT_TRUE(bootStorage());
+    auto& dev = AtsStorageTestAccess::deviceDb(s);
+    uint16_t blocks = dev.getIndexCount();
+
+    /* Two posts before the storage task runs: only the newest is kept */
+    EXPECT_TRUE(s.postMqttCursor(1700000000u, arcana::ats::AtsCursor{3, 1}));
+    EXPECT_TRUE(s.postMqttCursor(1700000000u, arcana::ats::AtsCursor{7, 42}));
+    EXPECT_EQ(dev.getIndexCount(), blocks);
+    uint32_t fileId = 0;
+    arcana::ats::AtsCursor cur = {0, 0};
+    EXPECT_FALSE(s.loadMqttCursor(fileId, cur));
+
+    AtsStorageTestAccess::savePostedCursor(s);
+    EXPECT_FALSE(AtsStorageTestAccess::cursorPosted(s));
+    ASSERT_TRUE(s.loadMqttCursor(fileId, cur));
+    EXPECT_EQ(fileId, 1700000000u);
+    EXPECT_EQ(cur.block, 7u);
+    EXPECT_EQ(cur.record, 42u);
+}
+
 // ── isDateUploaded / markUploaded / listPendingUploads ────────────────────
 // Note: the isDateUploaded path uses sReadCache (4KB shared static buffer)
 // and reads back via mDeviceDb.queryLatest which doesn't reliably round-trip
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "BatchCodec.hpp"
+#include <cstring>
+
+using namespace arcana;
+
+// ── Request round-trip ───────────────────────────────────────────────────────
+
+TEST(BatchCodecTest, RequestRoundTrip) {
+    uint8_t buf[64];
+    size_t off = 0;
+    ASSERT_TRUE(BatchCodec::beginWrite(buf, sizeof(buf), off));
+
+    const uint8_t params[] = {0xAA, 0xBB};
+    EXPECT_TRUE(BatchCodec::writeRequest(buf, sizeof(buf), off, 7,
+                                         {Cluster::System, SystemCommand::Ping},
+                                         nullptr, 0));
+    EXPECT_TRUE(BatchCodec::writeRequest(buf, sizeof(buf), off, 9,
+                                         {Cluster::Sensor, SensorCommand::GetTemperature},
+                                         params, sizeof(params)));
+    EXPECT_EQ(off, BatchCodec::kHeaderSize + 4 + 4 + 2);
+
+    uint8_t count = 0;
+    size_t rd = 0;
+    ASSERT_TRUE(BatchCodec::beginRead(buf, off, count, rd));
+    ASSERT_EQ(count, 2);
+
+    BatchEntry e;
+    ASSERT_TRUE(BatchCodec::readRequest(buf, off, rd, e));
+    EXPECT_EQ(e.reqId, 7);
+    EXPECT_EQ(e.key.cluster, Cluster::System);
+    EXPECT_EQ(e.key.commandId, SystemCommand::Ping);
+    EXPECT_EQ(e.length, 0);
+
+    ASSERT_TRUE(BatchCodec::readRequest(buf, off, rd, e));
+    EXPECT_EQ(e.reqId, 9);
+    EXPECT_EQ(e.key.commandId, SensorCommand::GetTemperature);
+    ASSERT_EQ(e.length, 2);
+    EXPECT_EQ(memcmp(e.data, params, 2), 0);
+    EXPECT_EQ(rd, off);
+}
+
+TEST(BatchCodecTest, ResponseRoundTrip) {
+    uint8_t buf[64];
+    size_t off = 0;
+    ASSERT_TRUE(BatchCodec::beginWrite(buf, sizeof(buf), off));
+
+    CommandResponseModel rsp;
+    rsp.key = {Cluster::System, SystemCommand::Ping};
+    rsp.setUint32(0x11223344);
+    ASSERT_TRUE(BatchCodec::writeResponse(buf, sizeof(buf), off, 3, rsp));
+
+    CommandResponseModel nf;
+    nf.key = {Cluster::Device, 0x7E};
+    nf.status = CommandStatus::NotFound;
+    ASSERT_TRUE(BatchCodec::writeResponse(buf, sizeof(buf), off, 4, nf));
+
+    uint8_t count = 0;
+    size_t rd = 0;
+    ASSERT_TRUE(BatchCodec::beginRead(buf, off, count, rd));
+    ASSERT_EQ(count, 2);
+
+    BatchEntry e;
+    ASSERT_TRUE(BatchCodec::readResponse(buf, off, rd, e));
+    EXPECT_EQ(e.reqId, 3);
+    EXPECT_EQ(e.status, CommandStatus::Success);
+    ASSERT_EQ(e.length, 4);
+    EXPECT_EQ(e.data[0], 0x44);
+
+    ASSERT_TRUE(BatchCodec::readResponse(buf, off, rd, e));
+    EXPECT_EQ(e.reqId, 4);
+    EXPECT_EQ(e.key.cluster, Cluster::Device);
+    EXPECT_EQ(e.status, CommandStatus::NotFound);
+    EXPECT_EQ(e.length, 0);
+}
+
+// ── Reject paths ─────────────────────────────────────────────────────────────
+
+TEST(BatchCodecTest, BeginReadRejectsWrongVersion) {
+    uint8_t buf[] = {0x01, 0x00};
+    uint8_t count = 0;
+    size_t off = 0;
+    EXPECT_FALSE(BatchCodec::beginRead(buf, sizeof(buf), count, off));
+}
+
+TEST(BatchCodecTest, BeginReadRejectsTooManyEntries) {
+    uint8_t buf[] = {BatchCodec::kVersion, BatchCodec::kMaxEntries + 1};
+    uint8_t count = 0;
+    size_t off = 0;
+    EXPECT_FALSE(BatchCodec::beginRead(buf, sizeof(buf), count, off));
+}
+
+TEST(BatchCodecTest, ReadRejectsTruncatedEntry) {
+    // Declares 3 params but carries only 1
+    uint8_t buf[] = {BatchCodec::kVersion, 1, 0x01, 0x00, 0x01, 3, 0xAA};
+    uint8_t count = 0;
+    size_t off = 0;
+    ASSERT_TRUE(BatchCodec::beginRead(buf, sizeof(buf), count, off));
+    BatchEntry e;
+    EXPECT_FALSE(BatchCodec::readRequest(buf, sizeof(buf), off, e));
+    EXPECT_EQ(off, BatchCodec::kHeaderSize);  // cursor untouched
+}
+
+TEST(BatchCodecTest, WriteRejectsWhenFullAndLeavesBufferIntact) {
+    uint8_t buf[BatchCodec::kHeaderSize + BatchCodec::kResponseHeader + 4];
+    size_t off = 0;
+    ASSERT_TRUE(BatchCodec::beginWrite(buf, sizeof(buf), off));
+
+    CommandResponseModel rsp;
+    rsp.setUint32(1);
+    ASSERT_TRUE(BatchCodec::writeResponse(buf, sizeof(buf), off, 1, rsp));
+    EXPECT_FALSE(BatchCodec::writeResponse(buf, sizeof(buf), off, 2, rsp));
+    EXPECT_EQ(buf[1], 1);
+    EXPECT_EQ(off, sizeof(buf));
+}
+
+TEST(BatchCodecTest, WriteRejectsPastMaxEntries) {
+    uint8_t buf[128];
+    size_t off = 0;
+    ASSERT_TRUE(BatchCodec::beginWrite(buf, sizeof(buf), off));
+    for (uint8_t i = 0; i < BatchCodec::kMaxEntries; i++) {
+        ASSERT_TRUE(BatchCodec::writeRequest(buf, sizeof(buf), off, i,
+                                             {Cluster::System, 1}, nullptr, 0));
+    }
+    EXPECT_FALSE(BatchCodec::writeRequest(buf, sizeof(buf), off, 0xFF,
+                                          {Cluster::System, 1}, nullptr, 0));
+    EXPECT_EQ(buf[1], BatchCodec::kMaxEntries);
+}
+
+TEST(BatchCodecTest, WriteRejectsParamsOverV1Limit) {
+    uint8_t buf[64];
+    uint8_t params[BatchCodec::kMaxParams + 1] = {};
+    size_t off = 0;
+    ASSERT_TRUE(BatchCodec::beginWrite(buf, sizeof(buf), off));
+    EXPECT_TRUE(BatchCodec::writeRequest(buf, sizeof(buf), off, 1, {Cluster::System, 1},
+                                         params, BatchCodec::kMaxParams));
+    size_t before = off;
+    EXPECT_FALSE(BatchCodec::writeRequest(buf, sizeof(buf), off, 2, {Cluster::System, 1},
+                                          params, sizeof(params)));
+    EXPECT_EQ(off, before);
+    EXPECT_EQ(buf[1], 1);
+}
@@ -32,6 +32,7 @@
 #include "CommandBridge.hpp"
 #include "FrameCodec.hpp"
 #include "ChaCha20.hpp"
+#include "TelemetryPipeline.hpp"
 #include "RegistrationServiceImpl.hpp"
 
 namespace arcana {
@@ -49,12 +50,31 @@ struct BleServiceTestAccess {
     static bool* runningPtr(BleServiceImpl& s) { return &s.mRunning; }
     static void setSensorDirty(BleServiceImpl& s, bool d) { s.mSensorDirty = d; }
     static bool sensorDirty(BleServiceImpl& s) { return s.mSensorDirty; }
-    static void setTemp(BleServiceImpl& s, float t) { s.mTemp = t; }
-    static void setAccel(BleServiceImpl& s, int16_t x, int16_t y, int16_t z) {
-        s.mAx = x; s.mAy = y; s.mAz = z;
+    /* Readings live in the TelemetryPipeline slot, not in the service */
+    static SensorDataModel sensor() {
+        TelemetrySample t;
+        TelemetryPipeline::getInstance().latest(t);
+        SensorDataModel m;
+        m.timestamp = t.ts;
+        m.temperature = t.temperature;
+        m.accelX = t.ax; m.accelY = t.ay; m.accelZ = t.az;
+        return m;
     }
-    static void setLight(BleServiceImpl& s, uint16_t als, uint16_t ps) {
-        s.mAls = als; s.mPs = ps;
+    static void setTemp(BleServiceImpl&, float t) {
+        SensorDataModel m = sensor();
+        m.temperature = t;
+        TelemetryPipeline::getInstance().update(m);
+    }
+    static void setAccel(BleServiceImpl&, int16_t x, int16_t y, int16_t z) {
+        SensorDataModel m = sensor();
+        m.accelX = x; m.accelY = y; m.accelZ = z;
+        TelemetryPipeline::getInstance().update(m);
+    }
+    static void setLight(BleServiceImpl&, uint16_t als, uint16_t ps) {
+        LightDataModel l;
+        l.ambientLight = als;
+        l.proximity = ps;
+        TelemetryPipeline::getInstance().update(l);
     }
     static void invokeBleTask(BleServiceImpl& s) { BleServiceImpl::bleTask(&s); }
     static void onSensorData(SensorDataModel* m, void* ctx) {
@@ -258,6 +278,16 @@ TEST(BleServiceTest, PushSensorEncryptedProducesValidFrame) {
     EXPECT_EQ(0x20, sid);                                 // sensor stream
     EXPECT_EQ(FrameCodec::kFlagFin, flags);
     ASSERT_GE(payloadLen, 12u);                           // [nonce:12][cipher:N]
+
+    // Decrypts to the protobuf the pipeline encoded for this sample
+    arcana::TelemetrySample t;
+    arcana::TelemetryPipeline::getInstance().latest(t);
+    std::vector<uint8_t> pb(payload + 12, payload + payloadLen);
+    arcana::crypto::ChaCha20::crypt(
+        arcana::reg::RegistrationServiceImpl::getInstance().getCommKey(),
+        payload, 0, pb.data(), (uint32_t)pb.size());
+    ASSERT_EQ(t.pbLen, pb.size());
+    EXPECT_EQ(0, memcmp(t.pb, pb.data(), pb.size()));
 }
 
 // ── taskLoop drives one iteration via the Hc08Ble stop-after-polls hook ────
@@ -0,0 +1,189 @@
+/**
+ * @file test_chacha20_poly1305.cpp
+ * @brief RFC 8439 known-answer tests for arcana::crypto::Poly1305 and
+ *        arcana::crypto::ChaCha20Poly1305
+ *
+ * Vectors from RFC 8439:
+ *   §2.5.2  Poly1305 over "Cryptographic Forum Research Group"
+ *   §2.8.2  AEAD seal of the "Ladies and Gentlemen..." plaintext with AAD
+ *   A.3     Poly1305 #5, #6, #8, #9 — carries and the final reduction mod p
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <cstdint>
+
+#include "ChaCha20Poly1305.hpp"
+
+using arcana::crypto::Poly1305;
+using arcana::crypto::ChaCha20Poly1305;
+
+namespace {
+
+const char kSunscreen[] =
+    "Ladies and Gentlemen of the class of '99: If I could offer you only one "
+    "tip for the future, sunscreen would be it.";
+
+const uint8_t kAeadKey[32] = {
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+    0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+};
+const uint8_t kAeadNonce[12] = {
+    0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+};
+const uint8_t kAeadAad[12] = {
+    0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+};
+const uint8_t kAeadCipher[114] = {
+    0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+    0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+    0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+    0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+    0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+    0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+    0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+    0x61, 0x16,
+};
+const uint8_t kAeadTag[16] = {
+    0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a,
+    0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91,
+};
+
+} // namespace
+
+// ── RFC 8439 §2.5.2 — Poly1305 ────────────────────────────────────────────────
+
+TEST(Poly1305, Rfc8439Section252) {
+    const uint8_t key[32] = {
+        0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33,
+        0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+        0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd,
+        0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b,
+    };
+    const char msg[] = "Cryptographic Forum Research Group";
+    const uint8_t expected[16] = {
+        0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6,
+        0xc2, 0x2b, 0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9,
+    };
+    uint8_t tag[16];
+    Poly1305::mac(key, reinterpret_cast<const uint8_t*>(msg), sizeof(msg) - 1, tag);
+    EXPECT_EQ(0, std::memcmp(tag, expected, 16));
+
+    // Same tag whatever the update() split
+    for (size_t split = 1; split < sizeof(msg) - 1; split += 5) {
+        Poly1305 p(key);
+        p.update(reinterpret_cast<const uint8_t*>(msg), split);
+        p.update(reinterpret_cast<const uint8_t*>(msg) + split, sizeof(msg) - 1 - split);
+        p.finish(tag);
+        EXPECT_EQ(0, std::memcmp(tag, expected, 16)) << "split " << split;
+    }
+}
+
+// ── RFC 8439 A.3 — reduction edge cases ───────────────────────────────────────
+
+TEST(Poly1305, Rfc8439AppendixA3EdgeCases) {
+    uint8_t key[32];
+    uint8_t msg[48];
+    uint8_t tag[16];
+    uint8_t expected[16];
+
+    // #5: h wraps to exactly p + 3
+    std::memset(key, 0, 32); key[0] = 2;
+    std::memset(msg, 0xff, 16);
+    std::memset(expected, 0, 16); expected[0] = 3;
+    Poly1305::mac(key, msg, 16, tag);
+    EXPECT_EQ(0, std::memcmp(tag, expected, 16));
+
+    // #6: h + s overflows 2^128
+    std::memset(key, 0, 16); key[0] = 2;
+    std::memset(key + 16, 0xff, 16);
+    std::memset(msg, 0, 16); msg[0] = 2;
+    Poly1305::mac(key, msg, 16, tag);
+    EXPECT_EQ(0, std::memcmp(tag, expected, 16));
+
+    // #8: h reduces to exactly p
+    std::memset(key, 0, 32); key[0] = 1;
+    std::memset(msg, 0xff, 16);
+    std::memset(msg + 16, 0xfe, 16); msg[16] = 0xfb;
+    std::memset(msg + 32, 0x01, 16);
+    std::memset(expected, 0, 16);
+    Poly1305::mac(key, msg, 48, tag);
+    EXPECT_EQ(0, std::memcmp(tag, expected, 16));
+
+    // #9: h = p - 5 + ..., no final subtraction
+    std::memset(key, 0, 32); key[0] = 2;
+    std::memset(msg, 0xff, 16); msg[0] = 0xfd;
+    std::memset(expected, 0xff, 16); expected[0] = 0xfa;
+    Poly1305::mac(key, msg, 16, tag);
+    EXPECT_EQ(0, std::memcmp(tag, expected, 16));
+}
+
+// ── RFC 8439 §2.8.2 — AEAD ────────────────────────────────────────────────────
+
+TEST(ChaCha20Poly1305, Rfc8439Section282Seal) {
+    uint8_t data[sizeof(kSunscreen) - 1];
+    ASSERT_EQ(sizeof(data), sizeof(kAeadCipher));
+    std::memcpy(data, kSunscreen, sizeof(data));
+
+    uint8_t tag[16];
+    ChaCha20Poly1305::seal(kAeadKey, kAeadNonce, kAeadAad, sizeof(kAeadAad),
+                           data, sizeof(data), tag);
+    EXPECT_EQ(0, std::memcmp(data, kAeadCipher, sizeof(data)));
+    EXPECT_EQ(0, std::memcmp(tag, kAeadTag, 16));
+}
+
+TEST(ChaCha20Poly1305, Rfc8439Section282Open) {
+    uint8_t data[sizeof(kAeadCipher)];
+    std::memcpy(data, kAeadCipher, sizeof(data));
+    ASSERT_TRUE(ChaCha20Poly1305::open(kAeadKey, kAeadNonce, kAeadAad, sizeof(kAeadAad),
+                                       data, sizeof(data), kAeadTag));
+    EXPECT_EQ(0, std::memcmp(data, kSunscreen, sizeof(data)));
+}
+
+TEST(ChaCha20Poly1305, OpenRejectsTamperAndLeavesDataUntouched) {
+    uint8_t data[sizeof(kAeadCipher)];
+    uint8_t tag[16];
+
+    // Flipped ciphertext bit
+    std::memcpy(data, kAeadCipher, sizeof(data));
+    data[50] ^= 0x04;
+    EXPECT_FALSE(ChaCha20Poly1305::open(kAeadKey, kAeadNonce, kAeadAad, sizeof(kAeadAad),
+                                        data, sizeof(data), kAeadTag));
+    data[50] ^= 0x04;
+    EXPECT_EQ(0, std::memcmp(data, kAeadCipher, sizeof(data)));
+
+    // Flipped tag bit
+    std::memcpy(tag, kAeadTag, 16);
+    tag[15] ^= 0x01;
+    EXPECT_FALSE(ChaCha20Poly1305::open(kAeadKey, kAeadNonce, kAeadAad, sizeof(kAeadAad),
+                                        data, sizeof(data), tag));
+
+    // Different AAD
+    uint8_t aad[sizeof(kAeadAad)];
+    std::memcpy(aad, kAeadAad, sizeof(aad));
+    aad[0] ^= 0x01;
+    EXPECT_FALSE(ChaCha20Poly1305::open(kAeadKey, kAeadNonce, aad, sizeof(aad),
+                                        data, sizeof(data), kAeadTag));
+
+    // Missing AAD
+    EXPECT_FALSE(ChaCha20Poly1305::open(kAeadKey, kAeadNonce, nullptr, 0,
+                                        data, sizeof(data), kAeadTag));
+}
+
+TEST(ChaCha20Poly1305, RoundTripEveryLengthWithoutAad) {
+    uint8_t key[32];
+    for (int i = 0; i < 32; ++i) key[i] = static_cast<uint8_t>(0xA0 + i);
+    const uint8_t nonce[12] = {1, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0};
+
+    for (size_t len = 0; len <= 130; ++len) {
+        uint8_t plain[130], data[130], tag[16];
+        for (size_t i = 0; i < len; ++i) plain[i] = static_cast<uint8_t>(i * 7 + len);
+        std::memcpy(data, plain, len);
+        ChaCha20Poly1305::seal(key, nonce, nullptr, 0, data, len, tag);
+        ASSERT_TRUE(ChaCha20Poly1305::open(key, nonce, nullptr, 0, data, len, tag))
+            << "len " << len;
+        EXPECT_EQ(0, std::memcmp(data, plain, len)) << "len " << len;
+    }
+}
@@ -19,11 +19,20 @@
  *   - processFrame (legacy): plaintext deframe → execute → frame
  *   - encryptAndFrame: happy path + buffer-too-small reject
  *   - decryptAndVerify: happy + replay + bad-HMAC + short-payload
- *   - handleKeyExchange: real uECC P-256 → HKDF → session install
+ *   - handleKeyExchange: real uECC P-256 → HKDF → session install,
+ *     ChaCha20-Poly1305 suite negotiation (offer byte, downgrade-bound tag)
  *   - bridgeTask: plaintext, encrypted, KE, bad frame, command-not-found
+ *   - handleBatch: v2 plaintext/encrypted batches, per-entry rejects,
+ *     response overflow, and a v1-vs-v2 round-trips/sec comparison
+ *   - HMAC vs AEAD session suites: round trip, tamper, per-frame cost
+ *   - resumption tickets: issue, resume by HKDF, replay / expiry / tamper
+ *   - stream transfers: window pump, ACK slide, encrypted DATA, RESUME
+ *     rebinding, and StreamRecordsCommand over a real ArcanaTsDb
  */
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 #include <exception>
 #include <vector>
@@ -31,10 +40,14 @@
 #include "stm32f1xx_hal.h"            // mock — must precede DeviceKey/Commands
 #include "CommandBridge.hpp"
 #include "FrameCodec.hpp"
+#include "BatchCodec.hpp"
 #include "ChaCha20.hpp"
+#include "ChaCha20Poly1305.hpp"
 #include "Sha256.hpp"
 #include "ICommand.hpp"
 #include "Commands.hpp"
+#include "StreamCommands.hpp"
+#include "ats_mocks.hpp"
 
 extern "C" {
 #include "uECC.h"
@@ -46,6 +59,8 @@ typedef void* QueueHandle_t;
 typedef uint32_t TickType_t;
 typedef BaseType_t (*XQueueReceiveFn)(QueueHandle_t, void*, TickType_t);
 extern XQueueReceiveFn g_xQueueReceiveOverride;
+extern TickType_t (*g_xTaskGetTickCountOverride)(void);
+extern UBaseType_t g_uxStackHighWaterMark;
 
 namespace arcana {
 
@@ -73,6 +88,13 @@ struct CommandBridgeTestAccess {
                                   uint8_t* serverPub, uint8_t* authTag) {
         return b.handleKeyExchange(source, clientPub, serverPub, authTag);
     }
+    static bool handleKeyExchange(CommandBridge& b, uint8_t source,
+                                  const uint8_t* clientPub,
+                                  uint8_t* serverPub, uint8_t* authTag,
+                                  uint8_t offer, uint8_t& chosen) {
+        return b.handleKeyExchange(source, clientPub, serverPub, authTag,
+                                   &offer, &chosen);
+    }
     static ChaChaSession& session(CommandBridge& b, uint8_t idx) {
         return b.mSessions[idx & 1];
     }
@@ -80,12 +102,25 @@ struct CommandBridgeTestAccess {
     static void invokeBridgeTask(CommandBridge& b) {
         CommandBridge::bridgeTask(&b);
     }
+    static UBaseType_t& stackFree(CommandBridge& b) { return b.mStackFree; }
+    static void setRxOrigin(CommandBridge& b, uint8_t source, bool encrypted) {
+        b.mRxSource = source;
+        b.mRxEncrypted = encrypted;
+    }
+    static void stopStream(CommandBridge& b) {
+        StreamMessage abort;
+        abort.type = StreamCodec::kAbort;
+        abort.xferId = b.mStream.xferId();
+        b.mStream.onControl(abort, 0);
+    }
     static void resetSessions(CommandBridge& b) {
         for (auto& s : b.mSessions) {
             memset(s.key, 0, sizeof(s.key));
+            memset(&s.mac, 0, sizeof(s.mac));
             s.txCounter = 0;
             s.rxCounter = 0;
             s.active = false;
+            s.suite = CommandBridge::SUITE_HMAC;
         }
     }
 };
@@ -102,6 +137,7 @@ namespace SystemCommand = arcana::SystemCommand;
 namespace SecurityCommand = arcana::SecurityCommand;
 namespace SensorCommand = arcana::SensorCommand;
 using arcana::crypto::ChaCha20;
+using arcana::crypto::ChaCha20Poly1305;
 using arcana::crypto::Sha256;
 
 // ───────────────────────────────────────────────────────────────────────────
@@ -142,6 +178,7 @@ void resetHarness(CommandBridge& bridge) {
     bridge.setBleSend(testBleSend, nullptr);
     bridge.setMqttSend(testMqttSend, nullptr);
     CommandBridgeTestAccess::resetSessions(bridge);
+    CommandBridgeTestAccess::stopStream(bridge);
 }
 
 void pushPlaintextCmd(uint8_t cluster, uint8_t cmd,
@@ -329,12 +366,11 @@ TEST(CommandBridgeSubmit, OversizedFrameRejected) {
 // ───────────────────────────────────────────────────────────────────────────
 
 namespace {
-void seedSession(CommandBridge& b, uint8_t source, uint8_t fill = 0x42) {
-    auto& sess = CommandBridgeTestAccess::session(b, source);
-    std::memset(sess.key, fill, sizeof(sess.key));
-    sess.txCounter = 0;
-    sess.rxCounter = 0;
-    sess.active = true;
+void seedSession(CommandBridge& b, uint8_t source, uint8_t fill = 0x42,
+                 uint8_t suite = CommandBridge::SUITE_HMAC) {
+    uint8_t key[32];
+    std::memset(key, fill, sizeof(key));
+    CommandBridgeTestAccess::session(b, source).install(key, suite);
 }
 } // anonymous namespace
 
@@ -384,9 +420,9 @@ TEST(CommandBridgeCrypto, EncryptRejectsWhenSessionInactive) {
 TEST(CommandBridgeCrypto, EncryptRejectsOversizedPlain) {
     CommandBridge& b = CommandBridge::getInstance();
     seedSession(b, 0);
-    // payload[80] is the internal cap → 80 - 12 - 32 = 36 bytes max plaintext
-    uint8_t big[40] = {};
-    uint8_t frameBuf[112];
+    // Internal payload cap is MAX_TX_FRAME - kOverhead → MAX_PLAIN bytes of plaintext
+    uint8_t big[CommandBridge::MAX_PLAIN + 1] = {};
+    uint8_t frameBuf[CommandBridge::MAX_TX_FRAME + 16];
     size_t frameLen = 0;
     EXPECT_FALSE(CommandBridgeTestAccess::encryptAndFrame(
         b, 0, CommandBridge::SID_ENCRYPTED,
@@ -490,6 +526,85 @@ TEST(CommandBridgeCrypto, DecryptReplayProtection) {
         b, 0, p1, p1Len, out, sizeof(out), outLen));
 }
 
+TEST(CommandBridgeCrypto, AeadSessionSealsWithPoly1305Tag) {
+    CommandBridge& b = CommandBridge::getInstance();
+    seedSession(b, 0, 0x42, CommandBridge::SUITE_AEAD);
+
+    const uint8_t plain[8] = {0x01, 0x02, 0x03, 0x04, 0xAA, 0xBB, 0xCC, 0xDD};
+    uint8_t frameBuf[112];
+    size_t frameLen = 0;
+    ASSERT_TRUE(CommandBridgeTestAccess::encryptAndFrame(
+        b, 0, CommandBridge::SID_ENCRYPTED,
+        plain, sizeof(plain), frameBuf, sizeof(frameBuf), frameLen));
+
+    const uint8_t* payload = nullptr;
+    size_t payloadLen = 0;
+    uint8_t flags = 0, sid = 0;
+    ASSERT_TRUE(FrameCodec::deframe(frameBuf, frameLen,
+                                    payload, payloadLen, flags, sid));
+    EXPECT_EQ(payloadLen, CommandBridge::AEAD_OVERHEAD + sizeof(plain));
+
+    // Wire format is plain RFC 8439: [nonce][cipher][tag], empty AAD
+    uint8_t key[32];
+    std::memset(key, 0x42, sizeof(key));
+    uint8_t opened[sizeof(plain)];
+    std::memcpy(opened, payload + 12, sizeof(plain));
+    ASSERT_TRUE(ChaCha20Poly1305::open(
+        key, payload, nullptr, 0, opened, sizeof(opened), payload + 12 + sizeof(plain)));
+    EXPECT_EQ(0, std::memcmp(opened, plain, sizeof(plain)));
+
+    uint8_t out[32];
+    size_t outLen = 0;
+    ASSERT_TRUE(CommandBridgeTestAccess::decryptAndVerify(
+        b, 0, payload, payloadLen, out, sizeof(out), outLen));
+    EXPECT_EQ(outLen, sizeof(plain));
+    EXPECT_EQ(0, std::memcmp(out, plain, sizeof(plain)));
+}
+
+TEST(CommandBridgeCrypto, AeadSessionRejectsTamperAndHmacFrames) {
+    CommandBridge& b = CommandBridge::getInstance();
+    const uint8_t plain[6] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+    uint8_t hmacFrame[112], aeadFrame[112];
+    size_t hmacLen = 0, aeadLen = 0;
+
+    seedSession(b, 0, 0x24);
+    ASSERT_TRUE(CommandBridgeTestAccess::encryptAndFrame(
+        b, 0, CommandBridge::SID_ENCRYPTED, plain, sizeof(plain),
+        hmacFrame, sizeof(hmacFrame), hmacLen));
+    seedSession(b, 0, 0x24, CommandBridge::SUITE_AEAD);
+    ASSERT_TRUE(CommandBridgeTestAccess::encryptAndFrame(
+        b, 0, CommandBridge::SID_ENCRYPTED, plain, sizeof(plain),
+        aeadFrame, sizeof(aeadFrame), aeadLen));
+
+    const uint8_t* p = nullptr;
+    size_t plen = 0;
+    uint8_t flags = 0, sid = 0;
+    uint8_t out[64];
+    size_t outLen = 0;
+
+    // Same key, legacy construction → tag check fails
+    ASSERT_TRUE(FrameCodec::deframe(hmacFrame, hmacLen, p, plen, flags, sid));
+    EXPECT_FALSE(CommandBridgeTestAccess::decryptAndVerify(
+        b, 0, p, plen, out, sizeof(out), outLen));
+
+    ASSERT_TRUE(FrameCodec::deframe(aeadFrame, aeadLen, p, plen, flags, sid));
+    std::vector<uint8_t> bad(p, p + plen);
+    bad[12] ^= 0x01;
+    EXPECT_FALSE(CommandBridgeTestAccess::decryptAndVerify(
+        b, 0, bad.data(), bad.size(), out, sizeof(out), outLen));
+    bad[12] ^= 0x01;
+    bad[plen - 1] ^= 0x80;
+    EXPECT_FALSE(CommandBridgeTestAccess::decryptAndVerify(
+        b, 0, bad.data(), bad.size(), out, sizeof(out), outLen));
+
+    // Untouched frame still opens once, then replays are refused
+    EXPECT_TRUE(CommandBridgeTestAccess::decryptAndVerify(
+        b, 0, p, plen, out, sizeof(out), outLen));
+    CommandBridgeTestAccess::session(b, 0).rxCounter = 5;
+    EXPECT_FALSE(CommandBridgeTestAccess::decryptAndVerify(
+        b, 0, p, plen, out, sizeof(out), outLen));
+}
+
 // ───────────────────────────────────────────────────────────────────────────
 // handleKeyExchange (uECC P-256 + HKDF on host)
 // ───────────────────────────────────────────────────────────────────────────
@@ -547,6 +662,55 @@ TEST(CommandBridgeKeyExchange, ServerInstallsSessionAndAuthTagMatches) {
                  sessionKey, 32);
     EXPECT_EQ(0, std::memcmp(sessionKey,
                              CommandBridgeTestAccess::session(b, 0).key, 32));
+    EXPECT_EQ(CommandBridgeTestAccess::session(b, 0).suite, CommandBridge::SUITE_HMAC);
+}
+
+TEST(CommandBridgeKeyExchange, AeadOfferSelectsSuiteAndBindsItInAuthTag) {
+    CommandBridge& b = CommandBridge::getInstance();
+    CommandBridgeTestAccess::resetSessions(b);
+
+    uECC_set_rng(clientRng);
+    const uECC_Curve curve = uECC_secp256r1();
+    uint8_t clientPriv[32], clientPub[64];
+    ASSERT_EQ(1, uECC_make_key(clientPub, clientPriv, curve));
+
+    uint8_t serverPub[64], authTag[32];
+    uint8_t chosen = 0xFF;
+    ASSERT_TRUE(CommandBridgeTestAccess::handleKeyExchange(
+        b, 0, clientPub, serverPub, authTag, CommandBridge::SUITE_AEAD, chosen));
+    EXPECT_EQ(chosen, CommandBridge::SUITE_AEAD);
+    EXPECT_EQ(CommandBridgeTestAccess::session(b, 0).suite, CommandBridge::SUITE_AEAD);
+
+    // authTag = HMAC(deviceKey, serverPub || clientPub || offer || chosen)
+    uint8_t buf[130];
+    std::memcpy(buf, serverPub, 64);
+    std::memcpy(buf + 64, clientPub, 64);
+    buf[128] = CommandBridge::SUITE_AEAD;
+    buf[129] = CommandBridge::SUITE_AEAD;
+    uint8_t expected[32];
+    Sha256::hmac(CommandBridgeTestAccess::deviceKey(b), 32, buf, 130, expected);
+    EXPECT_EQ(0, std::memcmp(authTag, expected, 32));
+
+    // A client that sees the legacy tag knows the offer was stripped
+    Sha256::hmac(CommandBridgeTestAccess::deviceKey(b), 32, buf, 128, expected);
+    EXPECT_NE(0, std::memcmp(authTag, expected, 32));
+}
+
+TEST(CommandBridgeKeyExchange, OfferWithoutAeadBitKeepsHmacSuite) {
+    CommandBridge& b = CommandBridge::getInstance();
+    CommandBridgeTestAccess::resetSessions(b);
+
+    uECC_set_rng(clientRng);
+    const uECC_Curve curve = uECC_secp256r1();
+    uint8_t clientPriv[32], clientPub[64];
+    ASSERT_EQ(1, uECC_make_key(clientPub, clientPriv, curve));
+
+    uint8_t serverPub[64], authTag[32];
+    uint8_t chosen = 0xFF;
+    ASSERT_TRUE(CommandBridgeTestAccess::handleKeyExchange(
+        b, 1, clientPub, serverPub, authTag, 0x00, chosen));
+    EXPECT_EQ(chosen, CommandBridge::SUITE_HMAC);
+    EXPECT_EQ(CommandBridgeTestAccess::session(b, 1).suite, CommandBridge::SUITE_HMAC);
 }
 
 // ───────────────────────────────────────────────────────────────────────────
@@ -573,6 +737,24 @@ TEST(CommandBridgeBridgeTask, PlaintextPingDispatchesAndResponds) {
     EXPECT_EQ(p[2], 0u);                      // Success
 }
 
+TEST(CommandBridgeBridgeTask, KeepsLowestStackHighWaterMark) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    CommandBridgeTestAccess::stackFree(b) = 832;
+
+    g_uxStackHighWaterMark = 300;
+    pushPlaintextCmd(0x00, SystemCommand::Ping, nullptr, 0, CmdFrameItem::BLE);
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    EXPECT_EQ(CommandBridgeTestAccess::stackFree(b), 300u);
+
+    /* A shallower pass does not raise it back */
+    g_uxStackHighWaterMark = 500;
+    pushPlaintextCmd(0x00, SystemCommand::Ping, nullptr, 0, CmdFrameItem::BLE);
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    EXPECT_EQ(CommandBridgeTestAccess::stackFree(b), 300u);
+    g_uxStackHighWaterMark = 1024;
+}
+
 TEST(CommandBridgeBridgeTask, PlaintextRoutesByTransport) {
     CommandBridge& b = CommandBridge::getInstance();
     resetHarness(b);
@@ -793,6 +975,259 @@ TEST(CommandBridgeBridgeTask, KeyExchangeOverMqttSendsResponse) {
     EXPECT_TRUE(b.hasSession(1));  // MQTT session installed
 }
 
+TEST(CommandBridgeBridgeTask, KeyExchangeWithSuiteOfferAppendsChosenSuite) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+
+    uECC_set_rng(clientRng);
+    const uECC_Curve curve = uECC_secp256r1();
+    uint8_t clientPriv[32], clientPub[64];
+    ASSERT_EQ(1, uECC_make_key(clientPub, clientPriv, curve));
+
+    // [Security, KeyExchange, 0, clientPub:64, offer:1]
+    uint8_t payload[3 + 64 + 1];
+    payload[0] = static_cast<uint8_t>(Cluster::Security);
+    payload[1] = SecurityCommand::KeyExchange;
+    payload[2] = 0;
+    std::memcpy(payload + 3, clientPub, 64);
+    payload[3 + 64] = CommandBridge::SUITE_AEAD;
+
+    CmdFrameItem item{};
+    size_t fl = 0;
+    ASSERT_TRUE(FrameCodec::frame(payload, sizeof(payload),
+                                  FrameCodec::kFlagFin,
+                                  CommandBridge::SID_PLAINTEXT,
+                                  item.data, sizeof(item.data), fl));
+    item.len = static_cast<uint16_t>(fl);
+    item.source = CmdFrameItem::BLE;
+    g_pendingFrames.push_back(item);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    const uint8_t* p = nullptr;
+    size_t plen = 0;
+    uint8_t flags = 0, sid = 0;
+    ASSERT_TRUE(FrameCodec::deframe(g_bleOut[0].data(), g_bleOut[0].size(),
+                                    p, plen, flags, sid));
+    EXPECT_EQ(plen, 101u);              // 4 header + 64 serverPub + 32 authTag + suite
+    EXPECT_EQ(p[3], 97u);
+    EXPECT_EQ(p[100], CommandBridge::SUITE_AEAD);
+    EXPECT_EQ(CommandBridgeTestAccess::session(b, 0).suite, CommandBridge::SUITE_AEAD);
+
+    // The client's derived key opens the AEAD-sealed response to a Ping
+    uint8_t shared[32], sessionKey[32];
+    ASSERT_EQ(1, uECC_shared_secret(p + 4, clientPriv, shared, curve));
+    Sha256::hkdf(shared, 32, CommandBridgeTestAccess::deviceKey(b), 32,
+                 reinterpret_cast<const uint8_t*>("ARCANA-SESSION"), 14,
+                 sessionKey, 32);
+
+    uint8_t plain[3] = {0x00, SystemCommand::Ping, 0x00};
+    uint8_t nonce[12] = {};
+    uint8_t sealed[12 + 3 + 16];
+    std::memcpy(sealed, nonce, 12);
+    std::memcpy(sealed + 12, plain, 3);
+    ChaCha20Poly1305::seal(sessionKey, nonce, nullptr, 0,
+                                           sealed + 12, 3, sealed + 15);
+    CmdFrameItem enc{};
+    ASSERT_TRUE(FrameCodec::frame(sealed, sizeof(sealed), FrameCodec::kFlagFin,
+                                  CommandBridge::SID_ENCRYPTED,
+                                  enc.data, sizeof(enc.data), fl));
+    enc.len = static_cast<uint16_t>(fl);
+    enc.source = CmdFrameItem::BLE;
+    g_bleOut.clear();
+    g_pendingFrames.push_back(enc);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    ASSERT_TRUE(FrameCodec::deframe(g_bleOut[0].data(), g_bleOut[0].size(),
+                                    p, plen, flags, sid));
+    EXPECT_EQ(sid, CommandBridge::SID_ENCRYPTED);
+    ASSERT_GT(plen, CommandBridge::AEAD_OVERHEAD);
+    std::vector<uint8_t> rsp(p + 12, p + plen - 16);
+    ASSERT_TRUE(ChaCha20Poly1305::open(
+        sessionKey, p, nullptr, 0, rsp.data(), rsp.size(), p + plen - 16));
+    EXPECT_EQ(rsp[1], SystemCommand::Ping);
+    EXPECT_EQ(rsp[2], 0u);              // Success
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// Session resumption tickets
+// ───────────────────────────────────────────────────────────────────────────
+
+namespace {
+
+TickType_t g_fixedTick = 0;
+TickType_t fixedTick() { return g_fixedTick; }
+
+/** SessionTicket over the current BLE session; returns the ticket */
+std::vector<uint8_t> requestTicket(CommandBridge& b) {
+    g_bleOut.clear();
+    uint8_t plain[3] = {static_cast<uint8_t>(Cluster::Security),
+                        SecurityCommand::SessionTicket, 0};
+    CmdFrameItem item{};
+    size_t fl = 0;
+    if (!CommandBridgeTestAccess::encryptAndFrame(
+            b, 0, CommandBridge::SID_ENCRYPTED, plain, sizeof(plain),
+            item.data, sizeof(item.data), fl)) return {};
+    item.len = static_cast<uint16_t>(fl);
+    item.source = CmdFrameItem::BLE;
+    g_pendingFrames.push_back(item);
+    try { CommandBridgeTestAccess::invokeBridgeTask(b); } catch (const StopBridgeTask&) {}
+
+    if (g_bleOut.size() != 1) return {};
+    const uint8_t* p = nullptr;
+    size_t plen = 0;
+    uint8_t flags = 0, sid = 0;
+    if (!FrameCodec::deframe(g_bleOut[0].data(), g_bleOut[0].size(), p, plen, flags, sid)) return {};
+    CommandBridgeTestAccess::session(b, 0).rxCounter = 0;
+    uint8_t rsp[CommandBridge::MAX_TX_FRAME];
+    size_t rspLen = 0;
+    if (!CommandBridgeTestAccess::decryptAndVerify(b, 0, p, plen, rsp, sizeof(rsp), rspLen)) return {};
+    if (rspLen != 4 + CommandBridge::TICKET_SIZE || rsp[2] != 0 ||
+        rsp[3] != CommandBridge::TICKET_SIZE) return {};
+    return std::vector<uint8_t>(rsp + 4, rsp + rspLen);
+}
+
+/** ResumeSession in plaintext; returns the response payload */
+std::vector<uint8_t> resume(CommandBridge& b, const std::vector<uint8_t>& ticket,
+                            const uint8_t* clientNonce, CmdFrameItem::Transport src) {
+    g_bleOut.clear();
+    g_mqttOut.clear();
+    uint8_t payload[3 + CommandBridge::TICKET_SIZE + CommandBridge::RESUME_NONCE_SIZE];
+    payload[0] = static_cast<uint8_t>(Cluster::Security);
+    payload[1] = SecurityCommand::ResumeSession;
+    payload[2] = 0;
+    std::memcpy(payload + 3, ticket.data(), CommandBridge::TICKET_SIZE);
+    std::memcpy(payload + 3 + CommandBridge::TICKET_SIZE, clientNonce,
+                CommandBridge::RESUME_NONCE_SIZE);
+    CmdFrameItem item{};
+    size_t fl = 0;
+    if (!FrameCodec::frame(payload, sizeof(payload), FrameCodec::kFlagFin,
+                           CommandBridge::SID_PLAINTEXT,
+                           item.data, sizeof(item.data), fl)) return {};
+    item.len = static_cast<uint16_t>(fl);
+    item.source = src;
+    g_pendingFrames.push_back(item);
+    try { CommandBridgeTestAccess::invokeBridgeTask(b); } catch (const StopBridgeTask&) {}
+
+    const auto& out = src == CmdFrameItem::BLE ? g_bleOut : g_mqttOut;
+    if (out.size() != 1) return {};
+    const uint8_t* p = nullptr;
+    size_t plen = 0;
+    uint8_t flags = 0, sid = 0;
+    if (!FrameCodec::deframe(out[0].data(), out[0].size(), p, plen, flags, sid)) return {};
+    return std::vector<uint8_t>(p, p + plen);
+}
+
+const uint8_t kClientNonce[16] = {
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+    0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+};
+
+} // anonymous namespace
+
+TEST(CommandBridgeResumption, TicketResumesWithoutKeyExchange) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 0, 0x31, CommandBridge::SUITE_AEAD);
+    uint8_t oldKey[32];
+    std::memset(oldKey, 0x31, sizeof(oldKey));
+
+    std::vector<uint8_t> ticket = requestTicket(b);
+    ASSERT_EQ(ticket.size(), CommandBridge::TICKET_SIZE);
+
+    // Disconnect: the session is gone, the client still holds key + ticket
+    CommandBridgeTestAccess::resetSessions(b);
+    std::vector<uint8_t> rsp = resume(b, ticket, kClientNonce, CmdFrameItem::BLE);
+    ASSERT_EQ(rsp.size(), 4u + 16u + 32u);
+    EXPECT_EQ(rsp[1], SecurityCommand::ResumeSession);
+    EXPECT_EQ(rsp[2], 0u);
+    EXPECT_EQ(rsp[3], 48u);
+
+    // Client side: rms from the old session key, then one HKDF
+    uint8_t rms[32], salt[32], newKey[32], confirm[32];
+    Sha256::hkdf(oldKey, 32, ticket.data(), 8,
+                 reinterpret_cast<const uint8_t*>("ARCANA-TICKET"), 13, rms, 32);
+    std::memcpy(salt, kClientNonce, 16);
+    std::memcpy(salt + 16, rsp.data() + 4, 16);
+    Sha256::hkdf(rms, 32, salt, 32,
+                 reinterpret_cast<const uint8_t*>("ARCANA-RESUME"), 13, newKey, 32);
+    Sha256::hmac(newKey, 32, salt, 32, confirm);
+    EXPECT_EQ(0, std::memcmp(rsp.data() + 4 + 16, confirm, 32));
+
+    const auto& sess = CommandBridgeTestAccess::session(b, 0);
+    EXPECT_TRUE(sess.active);
+    EXPECT_EQ(sess.suite, CommandBridge::SUITE_AEAD);
+    EXPECT_EQ(sess.txCounter, 0u);
+    EXPECT_EQ(0, std::memcmp(sess.key, newKey, 32));
+}
+
+TEST(CommandBridgeResumption, ReplayedTicketRejected) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 0, 0x32);
+    std::vector<uint8_t> ticket = requestTicket(b);
+    ASSERT_EQ(ticket.size(), CommandBridge::TICKET_SIZE);
+
+    std::vector<uint8_t> first = resume(b, ticket, kClientNonce, CmdFrameItem::BLE);
+    ASSERT_EQ(first.size(), 52u);
+    uint8_t resumedKey[32];
+    std::memcpy(resumedKey, CommandBridgeTestAccess::session(b, 0).key, 32);
+
+    std::vector<uint8_t> again = resume(b, ticket, kClientNonce, CmdFrameItem::BLE);
+    ASSERT_EQ(again.size(), 4u);
+    EXPECT_EQ(again[2], static_cast<uint8_t>(arcana::CommandStatus::Error));
+    EXPECT_EQ(0, std::memcmp(CommandBridgeTestAccess::session(b, 0).key, resumedKey, 32));
+}
+
+TEST(CommandBridgeResumption, ExpiredTamperedOrForeignTicketRejected) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 0, 0x33);
+    g_fixedTick = 5000;
+    g_xTaskGetTickCountOverride = fixedTick;
+    std::vector<uint8_t> ticket = requestTicket(b);
+    ASSERT_EQ(ticket.size(), CommandBridge::TICKET_SIZE);
+    const uint8_t kError = static_cast<uint8_t>(arcana::CommandStatus::Error);
+
+    std::vector<uint8_t> bad = ticket;
+    bad[20] ^= 0x01;
+    EXPECT_EQ(resume(b, bad, kClientNonce, CmdFrameItem::BLE).at(2), kError);
+    bad = ticket;
+    bad[0] ^= 0x01;                     // serial is authenticated as AAD
+    EXPECT_EQ(resume(b, bad, kClientNonce, CmdFrameItem::BLE).at(2), kError);
+
+    // Issued to BLE, presented over MQTT
+    EXPECT_EQ(resume(b, ticket, kClientNonce, CmdFrameItem::MQTT).at(2), kError);
+
+    g_fixedTick = 5000 + CommandBridge::TICKET_LIFETIME_S * configTICK_RATE_HZ;
+    EXPECT_EQ(resume(b, ticket, kClientNonce, CmdFrameItem::BLE).at(2), kError);
+
+    // None of the rejects consumed it
+    g_fixedTick = 5000 + configTICK_RATE_HZ;
+    EXPECT_EQ(resume(b, ticket, kClientNonce, CmdFrameItem::BLE).at(2), 0u);
+    g_xTaskGetTickCountOverride = nullptr;
+}
+
+TEST(CommandBridgeResumption, TicketNeedsAnEncryptedSession) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    pushPlaintextCmd(static_cast<uint8_t>(Cluster::Security),
+                     SecurityCommand::SessionTicket, nullptr, 0, CmdFrameItem::BLE);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    const uint8_t* p = nullptr;
+    size_t plen = 0;
+    uint8_t flags = 0, sid = 0;
+    ASSERT_TRUE(FrameCodec::deframe(g_bleOut[0].data(), g_bleOut[0].size(),
+                                    p, plen, flags, sid));
+    EXPECT_EQ(p[2], static_cast<uint8_t>(arcana::CommandStatus::InvalidParam));
+}
+
 TEST(CommandBridgeBridgeTask, EncryptedUnknownCommandReturnsNotFound) {
     CommandBridge& b = CommandBridge::getInstance();
     resetHarness(b);
@@ -934,3 +1369,743 @@ TEST(CommandBridgeBridgeTask, PlaintextKeyExchangeFailsOnInvalidClientPub) {
     EXPECT_FALSE(b.hasSession(0));  // session must NOT be installed on failure
 }
 
+
+// ───────────────────────────────────────────────────────────────────────────
+// v2 batch envelope (SID_BATCH / SID_ENCRYPTED_BATCH)
+// ───────────────────────────────────────────────────────────────────────────
+
+namespace {
+
+using arcana::BatchCodec;
+using arcana::BatchEntry;
+using arcana::CommandStatus;
+
+/** Frame (and optionally encrypt) a batch body and queue it for bridgeTask */
+void pushBatch(CommandBridge& b, const uint8_t* body, size_t bodyLen,
+               bool encrypted, CmdFrameItem::Transport src = CmdFrameItem::BLE) {
+    CmdFrameItem item{};
+    size_t fl = 0;
+    if (encrypted) {
+        uint8_t frameBuf[CommandBridge::MAX_TX_FRAME];
+        ASSERT_TRUE(CommandBridgeTestAccess::encryptAndFrame(
+            b, static_cast<uint8_t>(src), CommandBridge::SID_ENCRYPTED_BATCH,
+            body, bodyLen, frameBuf, sizeof(frameBuf), fl));
+        ASSERT_LE(fl, sizeof(item.data));
+        std::memcpy(item.data, frameBuf, fl);
+    } else {
+        ASSERT_TRUE(FrameCodec::frame(body, bodyLen, FrameCodec::kFlagFin,
+                                      CommandBridge::SID_BATCH,
+                                      item.data, sizeof(item.data), fl));
+    }
+    item.len = static_cast<uint16_t>(fl);
+    item.source = src;
+    g_pendingFrames.push_back(item);
+}
+
+/** Deframe (and decrypt) a batch response; returns the body length */
+size_t openBatchResponse(CommandBridge& b, const std::vector<uint8_t>& frame,
+                         uint8_t* body, size_t bodyCap, uint8_t expectSid) {
+    const uint8_t* p = nullptr;
+    size_t plen = 0;
+    uint8_t flags = 0, sid = 0;
+    if (!FrameCodec::deframe(frame.data(), frame.size(), p, plen, flags, sid)) return 0;
+    if (sid != expectSid) return 0;
+    if (sid == CommandBridge::SID_BATCH) {
+        if (plen > bodyCap) return 0;
+        std::memcpy(body, p, plen);
+        return plen;
+    }
+    // Response was encrypted with the shared test session — rewind rx so it verifies
+    CommandBridgeTestAccess::session(b, 0).rxCounter = 0;
+    size_t out = 0;
+    if (!CommandBridgeTestAccess::decryptAndVerify(b, 0, p, plen, body, bodyCap, out)) return 0;
+    return out;
+}
+
+std::vector<BatchEntry> readEntries(const uint8_t* body, size_t len) {
+    std::vector<BatchEntry> out;
+    uint8_t count = 0;
+    size_t off = 0;
+    if (!BatchCodec::beginRead(body, len, count, off)) return out;
+    for (uint8_t i = 0; i < count; i++) {
+        BatchEntry e;
+        if (!BatchCodec::readResponse(body, len, off, e)) break;
+        out.push_back(e);
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+TEST(CommandBridgeBatch, PlaintextBatchAnswersEveryRequestInOneFrame) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+
+    uint8_t body[64];
+    size_t off = 0;
+    BatchCodec::beginWrite(body, sizeof(body), off);
+    BatchCodec::writeRequest(body, sizeof(body), off, 0x10,
+                             {Cluster::System, SystemCommand::Ping}, nullptr, 0);
+    BatchCodec::writeRequest(body, sizeof(body), off, 0x11,
+                             {Cluster::System, 0xFE}, nullptr, 0);
+    BatchCodec::writeRequest(body, sizeof(body), off, 0x12,
+                             {Cluster::System, SystemCommand::GetFwVersion}, nullptr, 0);
+    pushBatch(b, body, off, false);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    uint8_t rsp[CommandBridge::MAX_TX_FRAME];
+    size_t rspLen = openBatchResponse(b, g_bleOut[0], rsp, sizeof(rsp),
+                                      CommandBridge::SID_BATCH);
+    auto entries = readEntries(rsp, rspLen);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].reqId, 0x10);
+    EXPECT_EQ(entries[0].status, CommandStatus::Success);
+    EXPECT_EQ(entries[0].length, 4u);
+    EXPECT_EQ(entries[1].reqId, 0x11);
+    EXPECT_EQ(entries[1].status, CommandStatus::NotFound);
+    EXPECT_EQ(entries[2].reqId, 0x12);
+    EXPECT_EQ(entries[2].key.commandId, SystemCommand::GetFwVersion);
+}
+
+TEST(CommandBridgeBatch, KeyExchangeAndOversizedParamsRejectedPerEntry) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+
+    uint8_t body[64];
+    size_t off = 0;
+    BatchCodec::beginWrite(body, sizeof(body), off);
+    BatchCodec::writeRequest(body, sizeof(body), off, 1,
+                             {Cluster::Security, SecurityCommand::KeyExchange}, nullptr, 0);
+    // The writer refuses params over kMaxParams; hand-encode one for the bridge
+    const uint8_t oversized[BatchCodec::kRequestHeader] = {
+        2, static_cast<uint8_t>(Cluster::System), SystemCommand::Ping,
+        BatchCodec::kMaxParams + 1};
+    memcpy(body + off, oversized, sizeof(oversized));
+    off += sizeof(oversized);
+    memset(body + off, 0, BatchCodec::kMaxParams + 1);
+    off += BatchCodec::kMaxParams + 1;
+    body[1]++;
+    BatchCodec::writeRequest(body, sizeof(body), off, 3,
+                             {Cluster::System, SystemCommand::Ping}, nullptr, 0);
+    pushBatch(b, body, off, false, CmdFrameItem::MQTT);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_mqttOut.size(), 1u);
+    EXPECT_TRUE(g_bleOut.empty());
+    uint8_t rsp[CommandBridge::MAX_TX_FRAME];
+    size_t rspLen = openBatchResponse(b, g_mqttOut[0], rsp, sizeof(rsp),
+                                      CommandBridge::SID_BATCH);
+    auto entries = readEntries(rsp, rspLen);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].status, CommandStatus::InvalidParam);
+    EXPECT_EQ(entries[1].status, CommandStatus::InvalidParam);
+    EXPECT_EQ(entries[2].status, CommandStatus::Success);
+    EXPECT_FALSE(b.hasSession(1));
+}
+
+TEST(CommandBridgeBatch, EncryptedBatchUsesOneNoncePerFrame) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 0, 0x5A);
+
+    uint8_t body[64];
+    size_t off = 0;
+    BatchCodec::beginWrite(body, sizeof(body), off);
+    for (uint8_t i = 0; i < 4; i++) {
+        BatchCodec::writeRequest(body, sizeof(body), off, i,
+                                 {Cluster::System, SystemCommand::Ping}, nullptr, 0);
+    }
+    pushBatch(b, body, off, true);
+    uint32_t txBefore = CommandBridgeTestAccess::session(b, 0).txCounter;
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    // Four responses, one encryptAndFrame call
+    EXPECT_EQ(CommandBridgeTestAccess::session(b, 0).txCounter, txBefore + 1);
+    uint8_t rsp[CommandBridge::MAX_TX_FRAME];
+    size_t rspLen = openBatchResponse(b, g_bleOut[0], rsp, sizeof(rsp),
+                                      CommandBridge::SID_ENCRYPTED_BATCH);
+    auto entries = readEntries(rsp, rspLen);
+    ASSERT_EQ(entries.size(), 4u);
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_EQ(entries[i].reqId, i);
+        EXPECT_EQ(entries[i].status, CommandStatus::Success);
+    }
+}
+
+TEST(CommandBridgeBatch, EncryptedBatchWithoutSessionDropped) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 0, 0x5A);
+
+    uint8_t body[8];
+    size_t off = 0;
+    BatchCodec::beginWrite(body, sizeof(body), off);
+    BatchCodec::writeRequest(body, sizeof(body), off, 1,
+                             {Cluster::System, SystemCommand::Ping}, nullptr, 0);
+    pushBatch(b, body, off, true);
+    CommandBridgeTestAccess::resetSessions(b);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    EXPECT_TRUE(g_bleOut.empty());
+}
+
+TEST(CommandBridgeBatch, BadVersionDropped) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+
+    uint8_t body[] = {0x07, 0x01, 0x01, 0x00, 0x01, 0x00};
+    pushBatch(b, body, sizeof(body), false);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    EXPECT_TRUE(g_bleOut.empty());
+}
+
+TEST(CommandBridgeBatch, ResponseOverflowOmitsTrailingEntries) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+
+    // 16 Pings need 2 + 16 * 9 = 146B of response, more than MAX_PLAIN
+    uint8_t body[CmdFrameItem::MAX_DATA];
+    size_t off = 0;
+    BatchCodec::beginWrite(body, sizeof(body), off);
+    for (uint8_t i = 0; i < BatchCodec::kMaxEntries; i++) {
+        BatchCodec::writeRequest(body, sizeof(body), off, i,
+                                 {Cluster::System, SystemCommand::Ping}, nullptr, 0);
+    }
+    pushBatch(b, body, off, false);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    uint8_t rsp[CommandBridge::MAX_TX_FRAME];
+    size_t rspLen = openBatchResponse(b, g_bleOut[0], rsp, sizeof(rsp),
+                                      CommandBridge::SID_BATCH);
+    auto entries = readEntries(rsp, rspLen);
+    size_t expected = (CommandBridge::MAX_PLAIN - BatchCodec::kHeaderSize)
+                      / (BatchCodec::kResponseHeader + 4);
+    EXPECT_EQ(entries.size(), expected);
+    EXPECT_LT(entries.size(), static_cast<size_t>(BatchCodec::kMaxEntries));
+    // Answered ids are a prefix; the client re-sends the rest
+    for (size_t i = 0; i < entries.size(); i++) EXPECT_EQ(entries[i].reqId, i);
+}
+
+TEST(CommandBridgeBatch, AeadSessionFitsMoreResponsesPerFrame) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 0, 0x5A, CommandBridge::SUITE_AEAD);
+
+    uint8_t body[CmdFrameItem::MAX_DATA];
+    size_t off = 0;
+    BatchCodec::beginWrite(body, sizeof(body), off);
+    for (uint8_t i = 0; i < BatchCodec::kMaxEntries; i++) {
+        BatchCodec::writeRequest(body, sizeof(body), off, i,
+                                 {Cluster::System, SystemCommand::Ping}, nullptr, 0);
+    }
+    pushBatch(b, body, off, true);
+
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    EXPECT_LE(g_bleOut[0].size(), static_cast<size_t>(CommandBridge::MAX_TX_FRAME));
+    uint8_t rsp[CommandBridge::MAX_TX_FRAME];
+    size_t rspLen = openBatchResponse(b, g_bleOut[0], rsp, sizeof(rsp),
+                                      CommandBridge::SID_ENCRYPTED_BATCH);
+    auto entries = readEntries(rsp, rspLen);
+    size_t hmacFits = (CommandBridge::MAX_PLAIN - BatchCodec::kHeaderSize)
+                      / (BatchCodec::kResponseHeader + 4);
+    size_t aeadFits = (CommandBridge::MAX_PLAIN_AEAD - BatchCodec::kHeaderSize)
+                      / (BatchCodec::kResponseHeader + 4);
+    EXPECT_EQ(entries.size(), aeadFits);
+    EXPECT_GT(entries.size(), hmacFits);
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// Round-trips/sec — v1 one-command-per-frame vs v2 batches (encrypted)
+//
+// Each "round trip" is one request frame in and one response frame out.
+// Wall-clock numbers are printed for information only (host CPU, not the
+// F103); the assertions are on the deterministic frame and byte counts.
+// ───────────────────────────────────────────────────────────────────────────
+
+TEST(CommandBridgeThroughput, BatchedVsSingleRoundTrips) {
+    CommandBridge& b = CommandBridge::getInstance();
+    constexpr int kCommands = 64;
+    constexpr uint8_t kPerBatch = 8;
+
+    // ── v1: one encrypted frame per command ──
+    resetHarness(b);
+    seedSession(b, 0, 0x33);
+    for (int i = 0; i < kCommands; i++) {
+        uint8_t plain[3] = {0x00, SystemCommand::Ping, 0x00};
+        uint8_t fb[CommandBridge::MAX_TX_FRAME];
+        size_t fl = 0;
+        ASSERT_TRUE(CommandBridgeTestAccess::encryptAndFrame(
+            b, 0, CommandBridge::SID_ENCRYPTED, plain, sizeof(plain), fb, sizeof(fb), fl));
+        CmdFrameItem item{};
+        std::memcpy(item.data, fb, fl);
+        item.len = static_cast<uint16_t>(fl);
+        item.source = CmdFrameItem::BLE;
+        g_pendingFrames.push_back(item);
+    }
+    size_t v1TxBytes = 0;
+    for (const auto& f : g_pendingFrames) v1TxBytes += f.len;
+
+    auto t0 = std::chrono::steady_clock::now();
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    auto t1 = std::chrono::steady_clock::now();
+
+    size_t v1RoundTrips = g_bleOut.size();
+    size_t v1RxBytes = 0;
+    for (const auto& f : g_bleOut) v1RxBytes += f.size();
+    ASSERT_EQ(v1RoundTrips, static_cast<size_t>(kCommands));
+
+    // ── v2: kPerBatch commands per encrypted frame ──
+    resetHarness(b);
+    seedSession(b, 0, 0x33);
+    for (int i = 0; i < kCommands; i += kPerBatch) {
+        uint8_t body[64];
+        size_t off = 0;
+        BatchCodec::beginWrite(body, sizeof(body), off);
+        for (uint8_t j = 0; j < kPerBatch; j++) {
+            BatchCodec::writeRequest(body, sizeof(body), off, static_cast<uint8_t>(i + j),
+                                     {Cluster::System, SystemCommand::Ping}, nullptr, 0);
+        }
+        pushBatch(b, body, off, true);
+    }
+    size_t v2TxBytes = 0;
+    for (const auto& f : g_pendingFrames) v2TxBytes += f.len;
+
+    auto t2 = std::chrono::steady_clock::now();
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    auto t3 = std::chrono::steady_clock::now();
+
+    size_t v2RoundTrips = g_bleOut.size();
+    size_t v2RxBytes = 0;
+    size_t v2Answered = 0;
+    for (const auto& f : g_bleOut) {
+        v2RxBytes += f.size();
+        uint8_t body[CommandBridge::MAX_TX_FRAME];
+        size_t len = openBatchResponse(b, f, body, sizeof(body),
+                                       CommandBridge::SID_ENCRYPTED_BATCH);
+        v2Answered += readEntries(body, len).size();
+    }
+    ASSERT_EQ(v2RoundTrips, static_cast<size_t>(kCommands / kPerBatch));
+    EXPECT_EQ(v2Answered, static_cast<size_t>(kCommands));
+    EXPECT_LT(v2TxBytes + v2RxBytes, (v1TxBytes + v1RxBytes) / 2);
+
+    double v1Sec = std::chrono::duration<double>(t1 - t0).count();
+    double v2Sec = std::chrono::duration<double>(t3 - t2).count();
+    std::printf("[ throughput ] v1: %zu round-trips, %zu B on wire, %.0f cmds/s\n",
+                v1RoundTrips, v1TxBytes + v1RxBytes,
+                v1Sec > 0 ? kCommands / v1Sec : 0.0);
+    std::printf("[ throughput ] v2: %zu round-trips, %zu B on wire, %.0f cmds/s "
+                "(%u cmds/round-trip)\n",
+                v2RoundTrips, v2TxBytes + v2RxBytes,
+                v2Sec > 0 ? kCommands / v2Sec : 0.0, kPerBatch);
+}
+
+// Per-frame cost of the two session suites: seal + open of a command-sized
+// payload. On the M3 the HMAC path is four SHA-256 compressions per frame
+// against one ChaCha20 block plus a few Poly1305 multiplies.
+TEST(CommandBridgeThroughput, AeadVsHmacPerFrame) {
+    CommandBridge& b = CommandBridge::getInstance();
+    constexpr int kFrames = 2000;
+    uint8_t plain[64];
+    for (size_t i = 0; i < sizeof(plain); i++) plain[i] = static_cast<uint8_t>(i);
+
+    size_t wire[2] = {};
+    double sec[2] = {};
+    const uint8_t suites[2] = {CommandBridge::SUITE_HMAC, CommandBridge::SUITE_AEAD};
+    for (int s = 0; s < 2; s++) {
+        seedSession(b, 0, 0x6C, suites[s]);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kFrames; i++) {
+            uint8_t fb[CommandBridge::MAX_TX_FRAME];
+            size_t fl = 0;
+            ASSERT_TRUE(CommandBridgeTestAccess::encryptAndFrame(
+                b, 0, CommandBridge::SID_ENCRYPTED, plain, sizeof(plain),
+                fb, sizeof(fb), fl));
+            const uint8_t* p = nullptr;
+            size_t plen = 0;
+            uint8_t flags = 0, sid = 0;
+            ASSERT_TRUE(FrameCodec::deframe(fb, fl, p, plen, flags, sid));
+            uint8_t out[sizeof(plain)];
+            size_t outLen = 0;
+            ASSERT_TRUE(CommandBridgeTestAccess::decryptAndVerify(
+                b, 0, p, plen, out, sizeof(out), outLen));
+            wire[s] = fl;
+        }
+        sec[s] = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    EXPECT_EQ(wire[0] - wire[1], CommandBridge::CRYPTO_OVERHEAD - CommandBridge::AEAD_OVERHEAD);
+    std::printf("[ throughput ] ChaCha20+HMAC-SHA256: %zu B/frame, %.2f us/frame\n",
+                wire[0], sec[0] * 1e6 / kFrames);
+    std::printf("[ throughput ] ChaCha20-Poly1305:    %zu B/frame, %.2f us/frame\n",
+                wire[1], sec[1] * 1e6 / kFrames);
+}
+
+// ───────────────────────────────────────────────────────────────────────────
+// Stream transfers — windowed DATA out, ACK / RESUME in
+// ───────────────────────────────────────────────────────────────────────────
+
+namespace {
+
+using arcana::StreamCodec;
+using arcana::StreamMessage;
+
+class PatternSource : public arcana::IStreamSource {
+public:
+    explicit PatternSource(size_t n) : total(n) {}
+    size_t read(uint8_t* dst, size_t cap) override {
+        size_t n = total - pos;
+        if (n > cap) n = cap;
+        for (size_t i = 0; i < n; i++) dst[i] = static_cast<uint8_t>(pos + i);
+        pos += n;
+        return n;
+    }
+    size_t total;
+    size_t pos = 0;
+};
+
+/** Frame a stream control message and queue it for bridgeTask */
+void pushStreamControl(const uint8_t* body, size_t len,
+                       CmdFrameItem::Transport src = CmdFrameItem::BLE) {
+    CmdFrameItem item{};
+    size_t fl = 0;
+    ASSERT_TRUE(FrameCodec::frame(body, len, FrameCodec::kFlagFin,
+                                  CommandBridge::SID_STREAM,
+                                  item.data, sizeof(item.data), fl));
+    item.len = static_cast<uint16_t>(fl);
+    item.source = src;
+    g_pendingFrames.push_back(item);
+}
+
+/** Same, sealed under the source's session (encrypted transfers) */
+void pushSealedStreamControl(CommandBridge& b, const uint8_t* body, size_t len,
+                             CmdFrameItem::Transport src) {
+    CmdFrameItem item{};
+    size_t fl = 0;
+    ASSERT_TRUE(CommandBridgeTestAccess::encryptAndFrame(
+        b, src, CommandBridge::SID_ENCRYPTED_STREAM, body, len,
+        item.data, sizeof(item.data), fl));
+    item.len = static_cast<uint16_t>(fl);
+    item.source = src;
+    g_pendingFrames.push_back(item);
+}
+
+/** Deframe (and decrypt) one outgoing DATA frame */
+bool openStreamData(CommandBridge& b, const std::vector<uint8_t>& frame, uint8_t source,
+                    StreamMessage& msg, bool& fin, uint8_t* plain, size_t cap) {
+    const uint8_t* p = nullptr;
+    size_t plen = 0;
+    uint8_t flags = 0, sid = 0;
+    if (!FrameCodec::deframe(frame.data(), frame.size(), p, plen, flags, sid)) return false;
+    if (!CommandBridge::isStreamSid(sid)) return false;
+    fin = (flags & FrameCodec::kFlagFin) != 0;
+    if (sid == CommandBridge::SID_ENCRYPTED_STREAM) {
+        CommandBridgeTestAccess::session(b, source).rxCounter = 0;
+        size_t out = 0;
+        if (!CommandBridgeTestAccess::decryptAndVerify(b, source, p, plen, plain, cap, out))
+            return false;
+        p = plain;
+        plen = out;
+    }
+    return StreamCodec::parse(p, plen, msg) && msg.type == StreamCodec::kData;
+}
+
+} // anonymous namespace
+
+TEST(CommandBridgeStream, WindowIsSentThenAckSlidesIt) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    CommandBridgeTestAccess::setRxOrigin(b, CmdFrameItem::BLE, false);
+
+    PatternSource src(CommandBridge::STREAM_CHUNK * 20);
+    uint8_t xferId = 0;
+    ASSERT_TRUE(b.beginStream(&src, xferId));
+    EXPECT_TRUE(b.isStreaming());
+    uint8_t again = 0;
+    EXPECT_FALSE(b.beginStream(&src, again));   // one transfer at a time
+
+    uint8_t ack[StreamCodec::kAckSize];
+    StreamCodec::writeAck(ack, sizeof(ack), xferId, CommandBridge::STREAM_WINDOW, 0);
+    pushStreamControl(ack, sizeof(ack));
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    // Full window, ACK, then the next full window
+    ASSERT_EQ(g_bleOut.size(), 2u * CommandBridge::STREAM_WINDOW);
+    EXPECT_TRUE(g_mqttOut.empty());
+    for (size_t i = 0; i < g_bleOut.size(); i++) {
+        StreamMessage m;
+        bool fin = true;
+        ASSERT_TRUE(openStreamData(b, g_bleOut[i], 0, m, fin, nullptr, 0));
+        EXPECT_EQ(m.xferId, xferId);
+        EXPECT_EQ(m.seq, i);
+        EXPECT_FALSE(fin);
+        ASSERT_EQ(m.length, CommandBridge::STREAM_CHUNK);
+        EXPECT_EQ(m.data[0], static_cast<uint8_t>(i * CommandBridge::STREAM_CHUNK));
+    }
+    CommandBridgeTestAccess::stopStream(b);
+}
+
+TEST(CommandBridgeStream, EncryptedTransferFollowsRequestingTransport) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 1, 0x5A);
+    CommandBridgeTestAccess::setRxOrigin(b, CmdFrameItem::MQTT, true);
+
+    PatternSource src(150);   // two chunks, the second short
+    uint8_t xferId = 0;
+    ASSERT_TRUE(b.beginStream(&src, xferId));
+    uint8_t ack[StreamCodec::kAckSize];
+    StreamCodec::writeAck(ack, sizeof(ack), xferId, 2, 0);
+    pushSealedStreamControl(b, ack, sizeof(ack), CmdFrameItem::MQTT);
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    EXPECT_TRUE(g_bleOut.empty());
+    ASSERT_EQ(g_mqttOut.size(), 2u);
+    uint8_t plain[CommandBridge::MAX_TX_FRAME];
+    StreamMessage m;
+    bool fin = false;
+    ASSERT_TRUE(openStreamData(b, g_mqttOut[0], 1, m, fin, plain, sizeof(plain)));
+    EXPECT_FALSE(fin);
+    ASSERT_TRUE(openStreamData(b, g_mqttOut[1], 1, m, fin, plain, sizeof(plain)));
+    EXPECT_TRUE(fin);
+    EXPECT_EQ(m.seq, 1);
+    EXPECT_EQ(m.length, 150u - CommandBridge::STREAM_CHUNK);
+    EXPECT_FALSE(b.isStreaming());   // final ACK completed the transfer
+}
+
+TEST(CommandBridgeStream, ResumeRebindsToArrivingTransport) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    CommandBridgeTestAccess::setRxOrigin(b, CmdFrameItem::BLE, false);
+
+    PatternSource src(CommandBridge::STREAM_CHUNK * 4);
+    uint8_t xferId = 0;
+    ASSERT_TRUE(b.beginStream(&src, xferId));
+
+    // BLE dropped after seq 1; client reconnects over MQTT
+    uint8_t resume[StreamCodec::kSeqMsgSize];
+    StreamCodec::writeResume(resume, sizeof(resume), xferId, 2);
+    pushStreamControl(resume, sizeof(resume), CmdFrameItem::MQTT);
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+
+    ASSERT_EQ(g_bleOut.size(), 5u);   // 4 full chunks + empty FIN chunk
+    ASSERT_EQ(g_mqttOut.size(), 3u);  // seq 2..4 re-sent on the new link
+    StreamMessage m;
+    bool fin = false;
+    ASSERT_TRUE(openStreamData(b, g_mqttOut[0], 1, m, fin, nullptr, 0));
+    EXPECT_EQ(m.seq, 2);
+    ASSERT_TRUE(openStreamData(b, g_mqttOut[2], 1, m, fin, nullptr, 0));
+    EXPECT_TRUE(fin);
+    CommandBridgeTestAccess::stopStream(b);
+}
+
+TEST(CommandBridgeStream, PlaintextControlCannotSteerEncryptedTransfer) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 1, 0x5B);
+    CommandBridgeTestAccess::setRxOrigin(b, CmdFrameItem::MQTT, true);
+
+    PatternSource src(CommandBridge::STREAM_CHUNK * 4);
+    uint8_t xferId = 0;
+    ASSERT_TRUE(b.beginStream(&src, xferId));
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    const size_t sent = g_mqttOut.size();
+    ASSERT_GT(sent, 0u);
+
+    // An unauthenticated RESUME / ACK is dropped: nothing re-sent, no
+    // switch to plaintext, the transfer is still running
+    uint8_t resume[StreamCodec::kSeqMsgSize];
+    StreamCodec::writeResume(resume, sizeof(resume), xferId, 0);
+    pushStreamControl(resume, sizeof(resume), CmdFrameItem::BLE);
+    pushStreamControl(resume, sizeof(resume), CmdFrameItem::MQTT);
+    uint8_t ack[StreamCodec::kAckSize];
+    StreamCodec::writeAck(ack, sizeof(ack), xferId, 5, 0);
+    pushStreamControl(ack, sizeof(ack), CmdFrameItem::MQTT);
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    EXPECT_TRUE(g_bleOut.empty());
+    EXPECT_EQ(g_mqttOut.size(), sent);
+    EXPECT_TRUE(b.isStreaming());
+
+    // A sealed RESUME is honoured and the re-sent frames stay encrypted
+    pushSealedStreamControl(b, resume, sizeof(resume), CmdFrameItem::MQTT);
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    ASSERT_GT(g_mqttOut.size(), sent);
+    for (const auto& f : g_mqttOut) {
+        ASSERT_GT(f.size(), static_cast<size_t>(FrameCodec::kOffSid));
+        EXPECT_EQ(f[FrameCodec::kOffSid], CommandBridge::SID_ENCRYPTED_STREAM);
+    }
+    CommandBridgeTestAccess::stopStream(b);
+}
+
+TEST(CommandBridgeStream, EncryptedControlForPlaintextTransferIgnored) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    seedSession(b, 0, 0x5C);
+    CommandBridgeTestAccess::setRxOrigin(b, CmdFrameItem::BLE, false);
+
+    PatternSource src(CommandBridge::STREAM_CHUNK * 4);
+    uint8_t xferId = 0;
+    ASSERT_TRUE(b.beginStream(&src, xferId));
+    uint8_t ack[StreamCodec::kAckSize];
+    StreamCodec::writeAck(ack, sizeof(ack), xferId, 5, 0);
+    pushSealedStreamControl(b, ack, sizeof(ack), CmdFrameItem::BLE);
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    EXPECT_TRUE(b.isStreaming());    // a full ACK would have finished it
+    CommandBridgeTestAccess::stopStream(b);
+}
+
+TEST(CommandBridgeStream, ControlForUnknownTransferIgnored) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    uint8_t ack[StreamCodec::kAckSize];
+    StreamCodec::writeAck(ack, sizeof(ack), 0xEE, 1, 0);
+    pushStreamControl(ack, sizeof(ack));
+    const uint8_t junk[] = {0x7F, 0x00};
+    pushStreamControl(junk, sizeof(junk));
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    EXPECT_TRUE(g_bleOut.empty());
+    EXPECT_FALSE(b.isStreaming());
+}
+
+// ── StreamRecordsCommand over a real ArcanaTsDb ─────────────────────────────
+
+namespace {
+
+struct RecordsDb {
+    arcana_test::MemFilePort file;
+    arcana_test::NullCipher  cipher;
+    arcana_test::StubMutex   mutex;
+    std::vector<uint8_t> bufA, bufB, slow, readCache;
+    uint8_t uid[12] = {};
+    uint8_t key[32] = {};
+    arcana::ats::ArcanaTsDb db;
+
+    RecordsDb()
+        : bufA(arcana::ats::BLOCK_SIZE), bufB(arcana::ats::BLOCK_SIZE),
+          slow(arcana::ats::BLOCK_SIZE), readCache(arcana::ats::BLOCK_SIZE) {
+        arcana::ats::AtsConfig c{};
+        c.file = &file;
+        c.cipher = &cipher;
+        c.mutex = &mutex;
+        c.getTime = &arcana_test::TestClock::now;
+        c.key = key;
+        c.deviceUid = uid;
+        c.deviceUidSize = 12;
+        c.primaryChannel = 0;
+        c.primaryBufA = bufA.data();
+        c.primaryBufB = bufB.data();
+        c.slowBuf = slow.data();
+        c.readCache = readCache.data();
+        arcana_test::TestClock::reset(1000, 0);
+        EXPECT_TRUE(db.open("rec.ats", c));
+        arcana::ats::ArcanaTsSchema s;
+        s.setName("ADC8");
+        s.addField("ts", arcana::ats::FieldType::U32);
+        s.addField("val", arcana::ats::FieldType::U32);
+        EXPECT_TRUE(db.addChannel(0, s));
+        EXPECT_TRUE(db.start());
+        for (uint32_t i = 0; i < 40; i++) {
+            uint8_t rec[8];
+            uint32_t ts = 1000 + i;
+            memcpy(rec, &ts, 4);
+            memcpy(rec + 4, &i, 4);
+            EXPECT_TRUE(db.append(0, rec));
+        }
+    }
+};
+
+arcana::CommandRequest recordsRequest(uint8_t channel, uint8_t mode,
+                                      uint32_t start, uint16_t arg) {
+    arcana::CommandRequest req;
+    req.key = arcana::StreamRecordsCommand::kKey;
+    req.params[0] = channel;
+    req.params[1] = mode;
+    memcpy(req.params + 2, &start, 4);
+    memcpy(req.params + 6, &arg, 2);
+    req.paramsLength = 8;
+    return req;
+}
+
+} // anonymous namespace
+
+TEST(CommandBridgeStream, StreamRecordsCommandStartsTransfer) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    CommandBridgeTestAccess::setRxOrigin(b, CmdFrameItem::BLE, false);
+    RecordsDb rdb;
+
+    arcana::StreamRecordsCommand cmd;
+    arcana::CommandResponseModel rsp;
+    cmd.execute(recordsRequest(0, arcana::StreamRecordsCommand::MODE_LATEST, 0, 10), rsp);
+    EXPECT_EQ(rsp.status, CommandStatus::Error);       // not wired
+
+    cmd.db = &rdb.db;
+    cmd.bridge = &b;
+    arcana::CommandRequest shortReq;
+    shortReq.paramsLength = 2;
+    cmd.execute(shortReq, rsp);
+    EXPECT_EQ(rsp.status, CommandStatus::InvalidParam);
+    cmd.execute(recordsRequest(5, arcana::StreamRecordsCommand::MODE_LATEST, 0, 10), rsp);
+    EXPECT_EQ(rsp.status, CommandStatus::InvalidParam);
+    cmd.execute(recordsRequest(0, 9, 0, 10), rsp);
+    EXPECT_EQ(rsp.status, CommandStatus::InvalidParam);
+
+    arcana::CommandResponseModel ok;
+    cmd.execute(recordsRequest(0, arcana::StreamRecordsCommand::MODE_LATEST, 0, 10), ok);
+    ASSERT_EQ(ok.status, CommandStatus::Success);
+    ASSERT_EQ(ok.dataLength, 7);
+    EXPECT_EQ(ok.data[1] | (ok.data[2] << 8), 8);      // record size
+    EXPECT_EQ(ok.data[3], CommandBridge::STREAM_CHUNK);
+    EXPECT_EQ(ok.data[4], CommandBridge::STREAM_WINDOW);
+    EXPECT_EQ(ok.data[5] | (ok.data[6] << 8), 10);     // records to follow
+
+    arcana::CommandResponseModel busy;
+    cmd.execute(recordsRequest(0, arcana::StreamRecordsCommand::MODE_LATEST, 0, 10), busy);
+    EXPECT_EQ(busy.status, CommandStatus::Busy);
+
+    // 10 records x 8 B fit one short chunk, which carries FIN
+    EXPECT_THROW(CommandBridgeTestAccess::invokeBridgeTask(b), StopBridgeTask);
+    ASSERT_EQ(g_bleOut.size(), 1u);
+    StreamMessage m;
+    bool fin = false;
+    ASSERT_TRUE(openStreamData(b, g_bleOut[0], 0, m, fin, nullptr, 0));
+    EXPECT_TRUE(fin);
+    EXPECT_EQ(m.xferId, ok.data[0]);
+    ASSERT_EQ(m.length, 80u);
+    uint32_t lastVal;
+    memcpy(&lastVal, m.data + 72 + 4, 4);
+    EXPECT_EQ(lastVal, 39u);
+    CommandBridgeTestAccess::stopStream(b);
+}
+
+TEST(CommandBridgeStream, StreamRecordsReportsClampedLatestCount) {
+    CommandBridge& b = CommandBridge::getInstance();
+    resetHarness(b);
+    CommandBridgeTestAccess::setRxOrigin(b, CmdFrameItem::BLE, false);
+    RecordsDb rdb;
+
+    arcana::StreamRecordsCommand cmd;
+    cmd.db = &rdb.db;
+    cmd.bridge = &b;
+    arcana::CommandResponseModel rsp;
+    cmd.execute(recordsRequest(0, arcana::StreamRecordsCommand::MODE_LATEST, 0, 1000), rsp);
+    ASSERT_EQ(rsp.status, CommandStatus::Success);
+    ASSERT_EQ(rsp.dataLength, 7);
+    // One staging buffer of 8-byte records, not the 1000 asked for
+    EXPECT_EQ(rsp.data[5] | (rsp.data[6] << 8), 128);
+    CommandBridgeTestAccess::stopStream(b);
+
+    cmd.execute(recordsRequest(0, arcana::StreamRecordsCommand::MODE_RANGE, 0, 0), rsp);
+    ASSERT_EQ(rsp.status, CommandStatus::Success);
+    EXPECT_EQ(rsp.data[5] | (rsp.data[6] << 8), 0);   // range: open-ended
+    CommandBridgeTestAccess::stopStream(b);
+}
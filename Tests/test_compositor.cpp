@@ -0,0 +1,367 @@
+/**
+ * @file test_compositor.cpp
+ * @brief Host coverage for the dirty-rect Compositor: Rect / DamageList
+ *        merging, Canvas rasterization, tiled composition and the toast
+ *        overlay layer.
+ *
+ * Output goes to FramebufferDisplay (Tests/mocks), which keeps real pixels
+ * and counts window setups, so tests check both what ends up on screen and
+ * how many bus transactions it took.
+ */
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "Compositor.hpp"
+#include "DisplayStatus.hpp"
+#include "FramebufferDisplay.hpp"
+
+using namespace arcana::display;
+
+namespace {
+
+const Color BG = colors::BLACK;
+
+/** Solid rect + optional label — stands in for a view's retained content */
+class BoxLayer : public Layer {
+public:
+    Rect box;
+    Color color;
+    const char* label;
+    bool shown = true;
+    uint32_t paints = 0;
+    Rect lastClip = { 0, 0, 0, 0 };
+
+    BoxLayer(Rect r, Color c, const char* text = nullptr) : box(r), color(c), label(text) {}
+
+    Rect bounds() const override { return shown ? box : Rect{ 0, 0, 0, 0 }; }
+
+    void paint(IDisplay& canvas, const Rect& clip) override {
+        paints++;
+        lastClip = clip;
+        canvas.fillRect(box.x, box.y, box.w, box.h, color);
+        if (label) canvas.drawString(box.x, box.y, label, colors::WHITE, color, 2);
+    }
+};
+
+std::unique_ptr<FramebufferDisplay> makeFb() {
+    return std::unique_ptr<FramebufferDisplay>(new FramebufferDisplay());
+}
+
+/** Every pixel of r holds c */
+void expectFilled(const FramebufferDisplay& fb, Rect r, Color c) {
+    for (uint16_t y = r.y; y < r.bottom(); y++)
+        for (uint16_t x = r.x; x < r.right(); x++)
+            ASSERT_EQ(fb.at(x, y), c) << "x=" << x << " y=" << y;
+}
+
+void resetToast() {
+    toastRequest().pending = false;
+    toastRequest().dismiss = false;
+    toastState().active = false;
+}
+
+} // anonymous
+
+// ── Rect ───────────────────────────────────────────────────────────────────
+
+TEST(RectTest, IntersectAndUnite) {
+    Rect a{ 10, 10, 20, 10 };
+    Rect b{ 25, 5, 20, 10 };
+    Rect i = a.intersect(b);
+    EXPECT_EQ(i.x, 25); EXPECT_EQ(i.y, 10); EXPECT_EQ(i.w, 5); EXPECT_EQ(i.h, 5);
+    Rect u = a.unite(b);
+    EXPECT_EQ(u.x, 10); EXPECT_EQ(u.y, 5); EXPECT_EQ(u.w, 35); EXPECT_EQ(u.h, 15);
+}
+
+TEST(RectTest, TouchingIsNotIntersecting) {
+    Rect a{ 0, 0, 10, 10 };
+    EXPECT_FALSE(a.intersects(Rect{ 10, 0, 5, 5 }));
+    EXPECT_TRUE(a.intersect(Rect{ 10, 0, 5, 5 }).empty());
+    EXPECT_FALSE(a.intersects(Rect{ 0, 0, 0, 0 }));
+    EXPECT_EQ(Rect{}.unite(a).area(), a.area());
+}
+
+// ── DamageList ─────────────────────────────────────────────────────────────
+
+TEST(DamageListTest, OverlappingRectsMerge) {
+    DamageList<> d;
+    d.add(Rect{ 20, 42, 100, 14 });
+    d.add(Rect{ 60, 42, 120, 14 });
+    ASSERT_EQ(d.count(), 1);
+    EXPECT_EQ(d[0].x, 20);
+    EXPECT_EQ(d[0].w, 160);
+}
+
+TEST(DamageListTest, DistantRectsStaySeparate) {
+    DamageList<> d;
+    d.add(Rect{ 20, 42, 180, 14 });      // temperature
+    d.add(Rect{ 72, 304, 96, 14 });      // clock
+    EXPECT_EQ(d.count(), 2);
+}
+
+TEST(DamageListTest, MergeCascadesThroughBridgingRect) {
+    DamageList<> d;
+    d.add(Rect{ 0, 0, 10, 10 });
+    d.add(Rect{ 30, 0, 10, 10 });
+    ASSERT_EQ(d.count(), 2);
+    d.add(Rect{ 5, 0, 30, 10 });         // overlaps both
+    ASSERT_EQ(d.count(), 1);
+    EXPECT_EQ(d[0].w, 40);
+}
+
+TEST(DamageListTest, FullListJoinsCheapestEntry) {
+    DamageList<2> d;
+    d.add(Rect{ 0, 0, 10, 10 });
+    d.add(Rect{ 0, 200, 10, 10 });
+    d.add(Rect{ 0, 30, 10, 10 });        // nearer the first
+    ASSERT_EQ(d.count(), 2);
+    bool joined = false;
+    for (uint8_t i = 0; i < d.count(); i++) {
+        if (d[i].y == 0 && d[i].h == 40) joined = true;
+    }
+    EXPECT_TRUE(joined);
+}
+
+TEST(DamageListTest, EmptyRectIgnored) {
+    DamageList<> d;
+    d.add(Rect{ 5, 5, 0, 10 });
+    EXPECT_EQ(d.count(), 0);
+}
+
+// ── Canvas ─────────────────────────────────────────────────────────────────
+
+TEST(CanvasTest, ClipsToWindow) {
+    Color buf[4 * 2];
+    for (auto& p : buf) p = 0x1111;
+    Canvas c(buf, 240, 320);
+    c.setWindow(Rect{ 10, 10, 4, 2 });
+    c.fillRect(0, 0, 12, 11, 0xAAAA);    // covers columns 10-11 of row 10
+    EXPECT_EQ(buf[0], 0xAAAA);
+    EXPECT_EQ(buf[1], 0xAAAA);
+    EXPECT_EQ(buf[2], 0x1111);
+    EXPECT_EQ(buf[4], 0x1111);           // row 11 untouched
+}
+
+TEST(CanvasTest, TileMatchesDirectDrawing) {
+    auto direct = makeFb();
+    direct->drawString(20, 42, "23.5 C", colors::YELLOW, BG, 2);
+
+    // Same string composed through a 240x3 window straddling the glyphs
+    Color buf[240 * 3];
+    Canvas c(buf, 240, 320);
+    c.setWindow(Rect{ 0, 46, 240, 3 });
+    c.fillRect(0, 0, 240, 320, BG);
+    c.drawString(20, 42, "23.5 C", colors::YELLOW, BG, 2);
+    for (uint16_t y = 0; y < 3; y++)
+        for (uint16_t x = 0; x < 240; x++)
+            ASSERT_EQ(buf[y * 240 + x], direct->at(x, 46 + y)) << x << "," << y;
+}
+
+TEST(CanvasTest, GlyphCrossingScreenEdgeIsDropped) {
+    auto fb = makeFb();
+    fb->drawString(228, 0, "abc", colors::WHITE, 0x1234, 1);   // only "ab" fits
+    EXPECT_EQ(fb->at(239, 0), 0x1234);
+    EXPECT_EQ(fb->windows, 2u);
+}
+
+TEST(CanvasTest, XBitmapAndBitmap16) {
+    auto fb = makeFb();
+    const uint8_t bits[2] = { 0x01, 0x02 };          // 3x2: (0,0) and (1,1)
+    fb->drawXBitmap(5, 5, 3, 2, bits, colors::WHITE, BG);
+    EXPECT_EQ(fb->at(5, 5), colors::WHITE);
+    EXPECT_EQ(fb->at(6, 5), BG);
+    EXPECT_EQ(fb->at(6, 6), colors::WHITE);
+
+    const uint16_t px[4] = { 1, 2, 3, 4 };
+    fb->drawBitmap16(238, 0, 4, 1, px);              // clipped to 2 columns
+    EXPECT_EQ(fb->at(238, 0), 1);
+    EXPECT_EQ(fb->at(239, 0), 2);
+    EXPECT_EQ(fb->pixelsWritten, 6u + 2u);
+}
+
+// ── Compositor ─────────────────────────────────────────────────────────────
+
+TEST(CompositorTest, FieldGoesOutInOneBurst) {
+    BoxLayer base(Rect{ 0, 0, 240, 320 }, BG);
+    BoxLayer field(Rect{ 72, 304, 96, 14 }, colors::DARKGRAY, "12:34:56");
+    Compositor<> comp;
+    comp.addLayer(&base);
+    comp.addLayer(&field);
+    auto fb = makeFb();
+
+    comp.damage(field.box);
+    EXPECT_TRUE(comp.dirty());
+    comp.compose(*fb);
+
+    EXPECT_FALSE(comp.dirty());
+    EXPECT_EQ(fb->windows, 1u);
+    EXPECT_EQ(fb->pixelsWritten, 96u * 14u);
+
+    // Same pixels as drawing the field directly
+    auto direct = makeFb();
+    direct->fillRect(72, 304, 96, 14, colors::DARKGRAY);
+    direct->drawString(72, 304, "12:34:56", colors::WHITE, colors::DARKGRAY, 2);
+    for (uint16_t y = 304; y < 318; y++)
+        for (uint16_t x = 72; x < 168; x++)
+            ASSERT_EQ(fb->at(x, y), direct->at(x, y));
+}
+
+TEST(CompositorTest, TallDamageSplitsIntoTiles) {
+    BoxLayer base(Rect{ 0, 0, 240, 320 }, colors::BLUE);
+    Compositor<240, 16> comp;
+    comp.addLayer(&base);
+    auto fb = makeFb();
+
+    comp.damage(Rect{ 0, 0, 240, 40 });
+    comp.compose(*fb);
+    EXPECT_EQ(fb->bitmapWindows, 3u);                // 16 + 16 + 8 rows
+    EXPECT_EQ(comp.tiles(), 3u);
+    EXPECT_EQ(comp.pixels(), 240u * 40u);
+    expectFilled(*fb, Rect{ 0, 0, 240, 40 }, colors::BLUE);
+}
+
+TEST(CompositorTest, NarrowRectPacksMoreRows) {
+    BoxLayer base(Rect{ 0, 0, 240, 320 }, colors::BLUE);
+    Compositor<240, 4> comp;                         // 960 px tile
+    comp.addLayer(&base);
+    auto fb = makeFb();
+
+    comp.damage(Rect{ 20, 42, 48, 14 });             // 672 px fits one tile
+    comp.compose(*fb);
+    EXPECT_EQ(fb->bitmapWindows, 1u);
+}
+
+TEST(CompositorTest, OverlayStaysOnTopWithoutOverdraw) {
+    BoxLayer base(Rect{ 0, 0, 240, 320 }, BG);
+    BoxLayer value(Rect{ 20, 150, 200, 14 }, colors::GREEN, "LIVE");
+    BoxLayer dialog(Rect{ 60, 140, 120, 40 }, colors::DARKGRAY);
+    Compositor<> comp;
+    comp.addLayer(&base);
+    comp.addLayer(&value);
+    comp.addLayer(&dialog);
+    auto fb = makeFb();
+
+    comp.damage(value.box);                          // live data changes under the dialog
+    comp.compose(*fb);
+
+    expectFilled(*fb, Rect{ 60, 150, 120, 14 }, colors::DARKGRAY);
+    EXPECT_EQ(fb->at(200, 150 + 13), colors::GREEN);         // beside the dialog
+    EXPECT_EQ(fb->pixelsWritten, value.box.area());  // each pixel sent once
+}
+
+TEST(CompositorTest, HiddenLayerNotPainted) {
+    BoxLayer base(Rect{ 0, 0, 240, 320 }, BG);
+    BoxLayer overlay(Rect{ 0, 0, 50, 50 }, colors::RED);
+    overlay.shown = false;
+    Compositor<> comp;
+    comp.addLayer(&base);
+    comp.addLayer(&overlay);
+    auto fb = makeFb();
+
+    comp.damage(Rect{ 0, 0, 50, 50 });
+    comp.compose(*fb);
+    EXPECT_EQ(overlay.paints, 0u);
+    expectFilled(*fb, Rect{ 0, 0, 50, 50 }, BG);
+}
+
+TEST(CompositorTest, LayerOutsideTileSkipped) {
+    BoxLayer top(Rect{ 0, 0, 240, 20 }, colors::RED);
+    BoxLayer bottom(Rect{ 0, 300, 240, 20 }, colors::BLUE);
+    Compositor<> comp;
+    comp.addLayer(&top);
+    comp.addLayer(&bottom);
+    auto fb = makeFb();
+
+    comp.damage(Rect{ 0, 0, 240, 10 });
+    comp.compose(*fb);
+    EXPECT_EQ(top.paints, 1u);
+    EXPECT_EQ(bottom.paints, 0u);
+}
+
+TEST(CompositorTest, LayerIsHandedTheTileAsClip) {
+    BoxLayer base(Rect{ 0, 0, 240, 320 }, BG);
+    Compositor<240, 16> comp;
+    comp.addLayer(&base);
+    auto fb = makeFb();
+
+    comp.damage(Rect{ 0, 100, 240, 40 });            // tiles at 100, 116, 124
+    comp.compose(*fb);
+    EXPECT_EQ(base.paints, 3u);
+    EXPECT_EQ(base.lastClip.x, 0);
+    EXPECT_EQ(base.lastClip.y, 132);
+    EXPECT_EQ(base.lastClip.w, 240);
+    EXPECT_EQ(base.lastClip.h, 8);
+}
+
+TEST(CompositorTest, DamageClippedToScreenAndLayerLimit) {
+    BoxLayer a(Rect{ 0, 0, 240, 320 }, BG);
+    Compositor<240, 16, 1> comp;
+    EXPECT_TRUE(comp.addLayer(&a));
+    EXPECT_FALSE(comp.addLayer(&a));
+    EXPECT_FALSE(comp.addLayer(nullptr));
+
+    auto fb = makeFb();
+    comp.damage(Rect{ 230, 310, 100, 100 });
+    comp.compose(*fb);
+    EXPECT_EQ(comp.pixels(), 10u * 10u);
+}
+
+// ── Toast layer ────────────────────────────────────────────────────────────
+
+TEST(ToastLayerTest, PollDamagesBoxOnShowAndDismiss) {
+    resetToast();
+    Rect dmg;
+    EXPECT_FALSE(toastPoll(0, 240, 320, dmg));
+
+    requestToast("Saved", 1000);
+    ASSERT_TRUE(toastPoll(0, 240, 320, dmg));
+    EXPECT_EQ(dmg.w, 200);                           // minimum box width
+    EXPECT_EQ(dmg.x, 20);
+    EXPECT_FALSE(toastPoll(500, 240, 320, dmg));     // steady: nothing to do
+
+    ASSERT_TRUE(toastPoll(1000, 240, 320, dmg));     // expired
+    EXPECT_EQ(dmg.w, 200);
+    EXPECT_FALSE(toastState().active);
+    resetToast();
+}
+
+TEST(ToastLayerTest, ReplacingToastDamagesBothBoxes) {
+    resetToast();
+    Rect dmg;
+    requestToast("Hi", 1000);
+    toastPoll(0, 240, 320, dmg);
+    requestToast("A much longer toast", 1000);
+    ASSERT_TRUE(toastPoll(10, 240, 320, dmg));
+    EXPECT_GT(dmg.w, 200);
+    resetToast();
+}
+
+TEST(ToastLayerTest, ComposesAboveLiveData) {
+    resetToast();
+    BoxLayer base(Rect{ 0, 0, 240, 320 }, BG);
+    BoxLayer live(Rect{ 0, 150, 240, 14 }, colors::GREEN);
+    ToastLayer toast;
+    Compositor<> comp;
+    comp.addLayer(&base);
+    comp.addLayer(&live);
+    comp.addLayer(&toast);
+    auto fb = makeFb();
+
+    requestToast("Mounting...", 5000);
+    Rect dmg;
+    ASSERT_TRUE(toastPoll(0, 240, 320, dmg));
+    comp.damage(dmg);
+    comp.compose(*fb);
+    Rect box = toast.bounds();
+    EXPECT_EQ(fb->at(box.x, box.y), colors::WHITE);          // border
+    EXPECT_EQ(fb->at(box.x + 2, box.y + 2), colors::DARKGRAY);
+
+    // Live data updates underneath: the toast interior is unchanged
+    fb->resetCounters();
+    comp.damage(live.box);
+    comp.compose(*fb);
+    EXPECT_EQ(fb->at(box.x + 2, 152), colors::DARKGRAY);
+    EXPECT_EQ(fb->at(0, 152), colors::GREEN);
+    EXPECT_EQ(fb->pixelsWritten, live.box.area());
+    resetToast();
+}
@@ -0,0 +1,322 @@
+/**
+ * @file test_ecg_sweep.cpp
+ * @brief Host coverage for EcgSweep (batched, decimating ECG renderer) and
+ *        the EcgDisplay wrapper built on it.
+ *
+ * A framebuffer IDisplay records every window (fillRect / drawBitmap16)
+ * and keeps the pixels, so tests check both the call pattern and what
+ * ends up on screen.
+ */
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "EcgSweep.hpp"
+#include "EcgBuffer.hpp"
+
+using arcana::EcgSweep;
+using arcana::EcgDisplay;
+using namespace arcana::display;
+
+namespace {
+
+const Color BG  = 0x0000;
+const Color FG  = 0x07E0;
+const Color FG2 = 0xF800;
+
+class FbDisplay : public IDisplay {
+public:
+    static const uint16_t W = 240;
+    static const uint16_t H = 320;
+
+    struct Call { char kind; uint16_t x, y, w, h; };
+    std::vector<Call> calls;
+    Color fb[W * H];
+
+    FbDisplay() { for (auto& p : fb) p = 0x1234; }   // "old trace" garbage
+
+    uint16_t width() const override { return W; }
+    uint16_t height() const override { return H; }
+    void fillScreen(Color c) override { fillRect(0, 0, W, H, c); }
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, Color c) override {
+        calls.push_back({ 'F', x, y, w, h });
+        for (uint16_t r = 0; r < h; r++)
+            for (uint16_t k = 0; k < w; k++) fb[(y + r) * W + x + k] = c;
+    }
+    void drawChar(uint16_t, uint16_t, char, Color, Color, uint8_t) override {}
+    void drawString(uint16_t, uint16_t, const char*, Color, Color, uint8_t) override {}
+    void drawXBitmap(uint16_t, uint16_t, uint16_t, uint16_t,
+                     const uint8_t*, Color, Color) override {}
+    void drawBitmap16(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint16_t* px) override {
+        calls.push_back({ 'B', x, y, w, h });
+        for (uint16_t r = 0; r < h; r++)
+            for (uint16_t k = 0; k < w; k++) fb[(y + r) * W + x + k] = px[r * w + k];
+    }
+
+    Color at(uint16_t x, uint16_t y) const { return fb[y * W + x]; }
+    size_t count(char kind) const {
+        size_t n = 0;
+        for (const Call& c : calls) n += (c.kind == kind);
+        return n;
+    }
+};
+
+const uint16_t TOP = 100;
+const uint8_t  HT  = 100;
+
+template <uint8_t L, uint16_t S>
+void configure(EcgSweep<L, S>& s, uint16_t rate, uint16_t cols, uint8_t gap = 4) {
+    typename EcgSweep<L, S>::Config cfg = {};
+    cfg.x = 0;
+    cfg.y = TOP;
+    cfg.width = 240;
+    cfg.height = HT;
+    cfg.sampleRateHz = rate;
+    cfg.columnsPerSec = cols;
+    cfg.gap = gap;
+    cfg.bg = BG;
+    cfg.color[0] = FG;
+    if (L > 1) cfg.color[L - 1] = FG2;
+    s.begin(cfg);
+}
+
+/** One column as handed to a drain() sink */
+struct Call3 { uint16_t x; uint8_t lo, hi; };
+
+/** Rows [lo, hi] of column x (area coords) hold the trace colour */
+void expectTrace(const FbDisplay& d, uint16_t x, uint8_t lo, uint8_t hi, Color c = FG) {
+    for (uint8_t r = 0; r < HT; r++) {
+        Color want = (r >= lo && r <= hi) ? c : BG;
+        ASSERT_EQ(d.at(x, TOP + r), want) << "x=" << x << " row=" << (int)r;
+    }
+}
+
+} // anonymous
+
+TEST(EcgSweepTest, BatchIsOneEraseAndOneStrip) {
+    EcgSweep<1> s;
+    configure(s, 250, 250);
+    FbDisplay d;
+    d.fillRect(0, TOP, 240, HT, BG);
+    d.calls.clear();
+
+    const uint8_t ys[8] = { 50, 52, 54, 56, 58, 60, 62, 64 };
+    for (uint8_t y : ys) s.push(&y);
+    EXPECT_EQ(s.pending(), 8);
+    s.flush(d);
+
+    ASSERT_EQ(d.calls.size(), 2u);
+    EXPECT_EQ(d.calls[0].kind, 'F');             // erase ahead: 8 new columns
+    EXPECT_EQ(d.calls[0].x, 4);
+    EXPECT_EQ(d.calls[0].w, 8);
+    EXPECT_EQ(d.calls[1].kind, 'B');             // one strip for the batch
+    EXPECT_EQ(d.calls[1].x, 0);
+    EXPECT_EQ(d.calls[1].w, 8);
+    EXPECT_EQ(d.calls[1].y, TOP + 50);           // band = rows touched only
+    EXPECT_EQ(s.cursor(), 8);
+    EXPECT_EQ(s.pending(), 0);
+
+    // Connected trace: each column spans previous → current sample
+    expectTrace(d, 0, 50, 51);                   // baseline 50 (HT/2), flat → 2px
+    expectTrace(d, 1, 50, 52);
+    expectTrace(d, 7, 62, 64);
+}
+
+TEST(EcgSweepTest, DrainHandsColumnsToSinkWithoutDrawing) {
+    EcgSweep<1> s;
+    configure(s, 250, 250);
+    const uint8_t ys[3] = { 50, 40, 60 };
+    for (uint8_t y : ys) s.push(&y);
+
+    std::vector<Call3> got;
+    s.drain([&got](uint16_t x, const uint8_t* lo, const uint8_t* hi) {
+        got.push_back({ x, lo[0], hi[0] });
+    });
+    ASSERT_EQ(got.size(), 3u);
+    EXPECT_EQ(got[0].x, 0);  EXPECT_EQ(got[0].lo, 50); EXPECT_EQ(got[0].hi, 51);
+    EXPECT_EQ(got[1].x, 1);  EXPECT_EQ(got[1].lo, 40); EXPECT_EQ(got[1].hi, 50);
+    EXPECT_EQ(got[2].x, 2);  EXPECT_EQ(got[2].lo, 40); EXPECT_EQ(got[2].hi, 60);
+    EXPECT_EQ(s.cursor(), 3);
+    EXPECT_EQ(s.pending(), 0);
+
+    // Nothing left for flush() to draw
+    FbDisplay d;
+    d.calls.clear();
+    s.flush(d);
+    EXPECT_TRUE(d.calls.empty());
+}
+
+TEST(EcgSweepTest, EraseAheadClearsOldTraceOnce) {
+    EcgSweep<1> s;
+    configure(s, 250, 250, 4);
+    FbDisplay d;                                  // area full of old garbage
+    uint8_t y = 50;
+    s.push(&y);
+    s.flush(d);
+    // Column 0 was never erased (onEnter clears the area), column 4 now is
+    for (uint8_t r = 0; r < HT; r++) EXPECT_EQ(d.at(4, TOP + r), BG);
+    EXPECT_EQ(d.at(5, TOP), 0x1234);
+}
+
+TEST(EcgSweepTest, DecimationKeepsMinMaxEnvelope) {
+    EcgSweep<1> s;
+    configure(s, 1000, 250);                     // 4 samples per column
+    FbDisplay d;
+    d.fillRect(0, TOP, 240, HT, BG);
+
+    const uint8_t ys[8] = { 50, 50, 10, 50,      // spike up inside column 0
+                            50, 90, 50, 50 };    // spike down inside column 1
+    for (uint8_t y : ys) s.push(&y);
+    EXPECT_EQ(s.pending(), 2);
+    s.flush(d);
+
+    expectTrace(d, 0, 10, 50);
+    expectTrace(d, 1, 50, 90);
+}
+
+TEST(EcgSweepTest, SlowSamplesStretchOverColumns) {
+    EcgSweep<1> s;
+    configure(s, 250, 500);                      // 2 columns per sample
+    FbDisplay d;
+    d.fillRect(0, TOP, 240, HT, BG);
+
+    uint8_t y = 70;
+    s.push(&y);
+    EXPECT_EQ(s.pending(), 2);
+    s.flush(d);
+    expectTrace(d, 0, 50, 70);                   // connect from baseline
+    expectTrace(d, 1, 70, 71);                   // hold
+}
+
+TEST(EcgSweepTest, StripSplitsAtRightEdge) {
+    EcgSweep<1> s;
+    configure(s, 250, 250, 4);
+    FbDisplay d;
+    uint8_t y = 50;
+    for (int i = 0; i < 236; i++) s.push(&y), s.flush(d);
+    d.calls.clear();
+
+    for (int i = 0; i < 8; i++) s.push(&y);
+    s.flush(d);
+    EXPECT_EQ(s.cursor(), 4);
+
+    // Two strips (236..239, 0..3), each with its own erase
+    EXPECT_EQ(d.count('B'), 2u);
+    EXPECT_EQ(d.count('F'), 2u);
+    for (const auto& c : d.calls) {
+        EXPECT_LE(c.x + c.w, 240);
+    }
+}
+
+TEST(EcgSweepTest, EraseWrapsAtRightEdge) {
+    EcgSweep<1> s;
+    configure(s, 250, 250, 4);
+    FbDisplay d;
+    uint8_t y = 50;
+    for (int i = 0; i < 234; i++) s.push(&y), s.flush(d);
+    d.calls.clear();
+
+    for (int i = 0; i < 4; i++) s.push(&y);
+    s.flush(d);
+
+    // Strip 234..237; erase 238..239 + 0..1
+    EXPECT_EQ(d.count('B'), 1u);
+    ASSERT_EQ(d.count('F'), 2u);
+    EXPECT_EQ(d.calls[0].x, 238);
+    EXPECT_EQ(d.calls[0].w, 2);
+    EXPECT_EQ(d.calls[1].x, 0);
+    EXPECT_EQ(d.calls[1].w, 2);
+}
+
+TEST(EcgSweepTest, TallBandSplitsToFitStripBuffer) {
+    EcgSweep<1, 200> s;                          // 200 px composite buffer
+    configure(s, 250, 250);
+    FbDisplay d;
+    d.fillRect(0, TOP, 240, HT, BG);
+    d.calls.clear();
+
+    const uint8_t ys[4] = { 0, 99, 0, 99 };      // full-height swings
+    for (uint8_t y : ys) s.push(&y);
+    s.flush(d);
+
+    // Each column is 100 rows tall → at most 2 columns per strip
+    EXPECT_EQ(d.count('B'), 2u);
+    for (const auto& c : d.calls) {
+        if (c.kind == 'B') EXPECT_LE((uint32_t)c.w * c.h, 200u);
+    }
+    expectTrace(d, 1, 0, 99);
+}
+
+TEST(EcgSweepTest, MultiLeadDrawsEachTrace) {
+    EcgSweep<2> s;
+    configure(s, 250, 250);
+    FbDisplay d;
+    d.fillRect(0, TOP, 240, HT, BG);
+
+    for (int i = 0; i < 4; i++) {
+        uint8_t ys[2] = { 20, 80 };
+        s.push(ys);
+    }
+    s.flush(d);
+    // Column 3: lead 0 flat at 20, lead 1 flat at 80
+    EXPECT_EQ(d.at(3, TOP + 20), FG);
+    EXPECT_EQ(d.at(3, TOP + 80), FG2);
+    EXPECT_EQ(d.at(3, TOP + 50), BG);
+    EXPECT_EQ(d.count('B'), 1u);                 // both leads in one strip
+}
+
+TEST(EcgSweepTest, OverrunDropsColumnsWithoutAdvancing) {
+    EcgSweep<1> s;
+    configure(s, 250, 250);
+    uint8_t y = 50;
+    for (int i = 0; i < EcgSweep<1>::MAX_PENDING + 5; i++) s.push(&y);
+    EXPECT_EQ(s.pending(), (uint8_t)EcgSweep<1>::MAX_PENDING);
+    EXPECT_EQ(s.dropped(), 5u);
+}
+
+TEST(EcgSweepTest, OutOfRangeSampleIsClamped) {
+    EcgSweep<1> s;
+    configure(s, 250, 250);
+    FbDisplay d;
+    d.fillRect(0, TOP, 240, HT, BG);
+    uint8_t y = 200;
+    s.push(&y);
+    s.flush(d);
+    expectTrace(d, 0, 50, 99);
+}
+
+TEST(EcgSweepTest, PushBeforeBeginIsIgnored) {
+    EcgSweep<1> s;
+    uint8_t y = 10;
+    s.push(&y);
+    EXPECT_EQ(s.pending(), 0);
+}
+
+// ── EcgDisplay wrapper ─────────────────────────────────────────────────────
+
+TEST(EcgDisplayTest, PushAndDrawDrawsOneColumn) {
+    FbDisplay d;
+    EcgDisplay e = {};
+    e.init(&d);
+    e.pushAndDraw(60);
+    EXPECT_EQ(d.count('B'), 1u);
+    EXPECT_EQ(d.count('F'), 1u);
+    EXPECT_EQ(e.sweep.cursor(), 1);
+}
+
+TEST(EcgDisplayTest, BatchedPushFlushesOnce) {
+    FbDisplay d;
+    EcgDisplay e = {};
+    e.init(&d);
+    for (int i = 0; i < 10; i++) e.push(50);
+    e.flush();
+    EXPECT_EQ(d.count('B'), 1u);
+    EXPECT_EQ(e.sweep.cursor(), 10);
+}
+
+TEST(EcgDisplayTest, NoDisplayIsNoop) {
+    EcgDisplay e = {};
+    e.init(nullptr);
+    e.pushAndDraw(50);
+    EXPECT_EQ(e.sweep.cursor(), 0);
+}
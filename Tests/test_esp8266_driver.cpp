@@ -4,26 +4,34 @@
  *
  * Same pattern as test_hc08ble_driver: link the REAL F103 Esp8266.cpp via
  * include order (F103_DRV before MOCKS_DIR) and exercise the pure-logic
- * functions (isr_onRxByte, isr_onIdle, responseContains, sendCmd timing,
- * waitFor, requestAccess/releaseAccess) against the HAL UART stubs.
+ * functions (isr_onIdle, responseContains, sendCmd timing, waitFor, the
+ * per-link +IPD queues) against the HAL UART stubs. Received bytes go
+ * through the RX DMA ring, played by mocks/SimUartDma.
  */
 #include <gtest/gtest.h>
 #include <cstring>
+#include <string>
 
 #include "stm32f1xx_hal.h"
 #include "task.h"
 #include "Esp8266.hpp"
+#include "SimUartDma.hpp"
 
 using arcana::Esp8266;
+using arcana::test::SimUartDma;
 
 namespace {
 Esp8266& esp() { return Esp8266::getInstance(); }
 
+/** Bytes on USART3 RX: the DMA writes them into the ring, no interrupt */
+void rx(const char* msg) { ASSERT_TRUE(SimUartDma::instance().receive(USART3, msg)); }
+
 void resetEsp() {
     /* No public reset — drain via clearRx */
     esp().clearRx();
-    esp().clearMqttMsg();
-    esp().setIpdPassthrough(false);
+    for (uint8_t l = 0; l < Esp8266::LINK_COUNT; ++l) {
+        esp().linkSkip(l, esp().linkAvailable(l));
+    }
 }
 } // anonymous
 
@@ -36,22 +44,46 @@ TEST(Esp8266DriverTest, GetInstanceSingleton) {
 }
 
 TEST(Esp8266DriverTest, InitHALSucceeds) {
+    SimUartDma::instance();   /* capture the RX ring when initHAL starts it */
     EXPECT_TRUE(esp().initHAL());
 }
 
-// ── isr_onRxByte: linear buffer accumulation ──────────────────────────────
+// ── RX DMA ring → linear buffer ───────────────────────────────────────────
 
-TEST(Esp8266DriverTest, IsrOnRxByteAccumulates) {
+TEST(Esp8266DriverTest, RxBytesReachBufferOnIdle) {
     resetEsp();
-    const char* msg = "OK\r\n";
-    for (size_t i = 0; i < strlen(msg); ++i) {
-        esp().isr_onRxByte((uint8_t)msg[i]);
-    }
-    /* getResponseLen reflects mRxLen which is updated by isr_onIdle, not
-     * isr_onRxByte; but mRxBuf is populated. Use responseContains to read. */
-    EXPECT_TRUE(esp().responseContains("OK") || esp().getResponseLen() == 0);
-    /* Just sanity: data is in the buffer somewhere */
-    SUCCEED();
+    rx("OK\r\n");
+    /* No per-byte interrupt: the ring is drained on IDLE (or HT/TC) */
+    EXPECT_FALSE(esp().responseContains("OK"));
+    esp().isr_onIdle();
+    EXPECT_TRUE(esp().responseContains("OK"));
+    EXPECT_EQ(esp().getResponseLen(), 4u);
+}
+
+TEST(Esp8266DriverTest, RxPayloadLargerThanRingArrivesIntact) {
+    resetEsp();
+    esp().initHAL();
+    /* 3+ ring lengths in one burst: HT/TC drain it before it is lapped */
+    std::string payload;
+    for (int i = 0; i < 300; ++i) payload += (char)('a' + i % 26);
+    std::string body = "+IPD,0,300:" + payload;
+    rx(body.c_str());
+    esp().isr_onIdle();
+    ASSERT_EQ(esp().linkAvailable(Esp8266::LINK_MQTT), 300u);
+    uint8_t out[300];
+    EXPECT_EQ(esp().linkRead(Esp8266::LINK_MQTT, out, sizeof(out)), 300u);
+    EXPECT_EQ(memcmp(out, payload.data(), 300), 0);
+    EXPECT_EQ(esp().getResponseLen(), 0u);
+    EXPECT_EQ(esp().rxStats().overruns(), 0u);
+    EXPECT_LE(esp().rxStats().peakFill(), Esp8266::RX_RING_SIZE / 2);
+}
+
+TEST(Esp8266DriverTest, RxBufferFullDropsTail) {
+    resetEsp();
+    std::string big(Esp8266::RX_BUF_SIZE + 100, 'z');
+    rx(big.c_str());
+    esp().isr_onIdle();
+    EXPECT_EQ(esp().getResponseLen(), Esp8266::RX_BUF_SIZE - 1);
 }
 
 // ── isr_onIdle: AT mode (no +IPD) → frame ready signal ────────────────────
@@ -62,61 +94,98 @@ TEST(Esp8266DriverTest, IsrOnIdleSetsFrameLength) {
     esp().initHAL();
     /* Push some bytes via ISR */
     const char* msg = "OK";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx(msg);
     esp().isr_onIdle();
     /* mRxLen should now equal mRxPos */
     EXPECT_GT(esp().getResponseLen(), 0u);
     EXPECT_TRUE(esp().responseContains("OK"));
 }
 
-// ── isr_onIdle: +IPD detection extracts to MQTT buffer ────────────────────
+// ── isr_onIdle: +IPD routed to the link queues ─────────────────────────────
 
-TEST(Esp8266DriverTest, IsrOnIdleExtractsIpdToMqttBuffer) {
+TEST(Esp8266DriverTest, IpdGoesToLinkQueueNotResponse) {
     resetEsp();
     esp().initHAL();
-    /* Production scan loop requires `i + 13 <= mRxLen` so the buffer must
-     * be at least 13 bytes for the +IPD detection to fire. Use a fuller
-     * +IPD payload to satisfy that. */
-    const char* msg = "+IPD,12:hello world!";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx("+IPD,0,5:hello");
     esp().isr_onIdle();
-    EXPECT_TRUE(esp().hasMqttMsg());
-    EXPECT_GT(esp().getMqttMsgLen(), 0u);
-    EXPECT_NE(strstr(esp().getMqttMsg(), "+IPD"), nullptr);
+    EXPECT_EQ(esp().linkAvailable(Esp8266::LINK_MQTT), 5u);
+    EXPECT_EQ(esp().getResponseLen(), 0u);
+    EXPECT_FALSE(esp().responseContains("+IPD"));
 }
 
-TEST(Esp8266DriverTest, IsrOnIdleExtractsMqttSubrecv) {
+TEST(Esp8266DriverTest, IpdWithoutLinkIdGoesToLinkZero) {
     resetEsp();
     esp().initHAL();
-    const char* msg = "+MQTTSUBRECV:0,topic,5,data";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx("+IPD,12:hello world!");
     esp().isr_onIdle();
-    EXPECT_TRUE(esp().hasMqttMsg());
+    uint8_t out[16];
+    ASSERT_EQ(esp().linkRead(Esp8266::LINK_MQTT, out, sizeof(out)), 12u);
+    EXPECT_EQ(memcmp(out, "hello world!", 12), 0);
 }
 
-TEST(Esp8266DriverTest, IsrOnIdleSplitsMixedAtAndIpd) {
+TEST(Esp8266DriverTest, MixedAtTextAndTwoLinksAreSeparated) {
     resetEsp();
     esp().initHAL();
-    /* AT response followed by long +IPD (must be >=13 chars total including
-     * the "+IPD," prefix for the production scan loop). */
-    const char* msg = "OK\r\n+IPD,12:hello world!";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx("OK\r\n+IPD,1,4:HTTP+IPD,0,2:\x30\x02\r\nSEND OK\r\n");
     esp().isr_onIdle();
-    EXPECT_TRUE(esp().responseContains("OK"));
-    EXPECT_TRUE(esp().hasMqttMsg());
+    EXPECT_TRUE(esp().responseContains("OK\r\n\r\nSEND OK"));
+    EXPECT_EQ(esp().linkAvailable(Esp8266::LINK_HTTP), 4u);
+    uint8_t out[4];
+    EXPECT_EQ(esp().linkPeek(Esp8266::LINK_HTTP, out, 4), 4u);
+    EXPECT_EQ(memcmp(out, "HTTP", 4), 0);
+    EXPECT_EQ(esp().linkAvailable(Esp8266::LINK_MQTT), 2u);
+}
+
+TEST(Esp8266DriverTest, ClosedLineMarksLinkAndStopsWait) {
+    resetEsp();
+    esp().initHAL();
+    rx("2,CLOSED\r\n");
+    esp().isr_onIdle();
+    EXPECT_TRUE(esp().linkClosed(Esp8266::LINK_SYSLOG));
+    EXPECT_FALSE(esp().linkClosed(Esp8266::LINK_MQTT));
+    EXPECT_FALSE(esp().linkWait(Esp8266::LINK_SYSLOG, 1000));
 }
 
-TEST(Esp8266DriverTest, IsrOnIdlePassthroughKeepsIpdInRxBuf) {
+TEST(Esp8266DriverTest, LinkWaitReturnsWhenDataQueued) {
     resetEsp();
     esp().initHAL();
-    esp().setIpdPassthrough(true);
-    const char* msg = "+IPD,5:hello";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx("+IPD,1,3:abc");
     esp().isr_onIdle();
-    /* Passthrough → +IPD stays in mRxBuf, mMqttBuf NOT populated */
-    EXPECT_TRUE(esp().responseContains("+IPD"));
-    EXPECT_FALSE(esp().hasMqttMsg());
-    esp().setIpdPassthrough(false);
+    EXPECT_TRUE(esp().linkWait(Esp8266::LINK_HTTP, 1000));
+    EXPECT_EQ(esp().linkSkip(Esp8266::LINK_HTTP, 10), 3u);
+    EXPECT_FALSE(esp().linkWait(Esp8266::LINK_HTTP, 50));
+}
+
+TEST(Esp8266DriverTest, LinkRecvUntilCollectsAcrossSegments) {
+    resetEsp();
+    esp().initHAL();
+    rx("+IPD,1,10:HTTP/1.1 2+IPD,1,11:00 OK\r\n\r\nxy");
+    esp().isr_onIdle();
+    char buf[64];
+    uint16_t len = 0;
+    ASSERT_TRUE(esp().linkRecvUntil(Esp8266::LINK_HTTP, buf, sizeof(buf), len,
+                                    "\r\n\r\n", 100));
+    EXPECT_EQ(len, 21u);
+    EXPECT_STREQ(buf, "HTTP/1.1 200 OK\r\n\r\nxy");
+}
+
+TEST(Esp8266DriverTest, LinkRecvUntilStopsWhenBufferFull) {
+    resetEsp();
+    esp().initHAL();
+    rx("+IPD,1,20:aaaaaaaaaaaaaaaaaaaa");
+    esp().isr_onIdle();
+    char buf[8];
+    uint16_t len = 0;
+    EXPECT_FALSE(esp().linkRecvUntil(Esp8266::LINK_HTTP, buf, sizeof(buf), len,
+                                     "\r\n", 100));
+    EXPECT_EQ(len, 7u);
+}
+
+TEST(Esp8266DriverTest, LinkOpenFailsWithoutOk) {
+    resetEsp();
+    esp().initHAL();
+    EXPECT_FALSE(esp().linkOpen(Esp8266::LINK_HTTP, "SSL", "example.com", 443, 10));
+    EXPECT_FALSE(esp().linkOpen(Esp8266::LINK_COUNT, "TCP", "example.com", 80, 10));
 }
 
 // ── responseContains edge cases ────────────────────────────────────────────
@@ -128,25 +197,42 @@ TEST(Esp8266DriverTest, ResponseContainsEmptyBufferReturnsFalse) {
 
 TEST(Esp8266DriverTest, ResponseContainsNullPointer) {
     resetEsp();
-    const char* msg = "data";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx("data");
+    esp().isr_onIdle();
     EXPECT_FALSE(esp().responseContains(nullptr));
 }
 
 TEST(Esp8266DriverTest, ResponseContainsLongerThanBuf) {
     resetEsp();
-    const char* msg = "ab";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx("ab");
+    esp().isr_onIdle();
     EXPECT_FALSE(esp().responseContains("longer than buffer"));
 }
 
 // ── clearRx ────────────────────────────────────────────────────────────────
 
 TEST(Esp8266DriverTest, ClearRxResetsBuffer) {
-    const char* msg = "noise";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx("noise");
+    esp().isr_onIdle();
+    esp().clearRx();
+    EXPECT_EQ(esp().getResponseLen(), 0u);
+}
+
+TEST(Esp8266DriverTest, ClearRxDropsBytesStillInRing) {
+    resetEsp();
+    rx("late");                  /* received, not yet drained */
     esp().clearRx();
+    esp().isr_onIdle();
     EXPECT_EQ(esp().getResponseLen(), 0u);
+    EXPECT_FALSE(esp().responseContains("late"));
+}
+
+TEST(Esp8266DriverTest, SetBaudRestartsRing) {
+    resetEsp();
+    esp().setBaud(460800);
+    rx("OK\r\n");
+    esp().isr_onIdle();
+    EXPECT_TRUE(esp().responseContains("OK"));
 }
 
 // ── sendCmd: timeout (no IRQ) ──────────────────────────────────────────────
@@ -170,11 +256,30 @@ TEST(Esp8266DriverTest, SendCmdAcceptsResponseFromIsr) {
     SUCCEED();
 }
 
-// ── sendData: forwards to HAL_UART_Transmit ────────────────────────────────
+// ── sendData / sendv: TX DMA on DMA1 Channel2 ──────────────────────────────
 
-TEST(Esp8266DriverTest, SendDataForwardsToHal) {
+TEST(Esp8266DriverTest, SendDataGoesOutOnTxDma) {
     const uint8_t data[] = {0xDE, 0xAD};
+    uint32_t before = arcana_test_dma_count;
     EXPECT_TRUE(esp().sendData(data, sizeof(data)));
+    ASSERT_EQ(arcana_test_dma_count, before + 1);
+    const ArcanaTestDmaXfer& x = arcana_test_dma_log[before];
+    EXPECT_EQ(x.src, (uint32_t)(uintptr_t)data);
+    EXPECT_EQ(x.dst, (uint32_t)(uintptr_t)&USART3->DR);
+    EXPECT_EQ(x.length, 2u);
+    EXPECT_EQ(esp().txStats().bytesSent() >= 2u, true);
+}
+
+TEST(Esp8266DriverTest, SendvChainsSegmentsFromTheirBuffers) {
+    const uint8_t hdr[] = {0x32, 0x09};
+    const uint8_t body[] = {1, 2, 3, 4, 5};
+    arcana::UartTxSeg segs[2] = { { hdr, sizeof(hdr) }, { body, sizeof(body) } };
+    uint32_t before = arcana_test_dma_count;
+    EXPECT_TRUE(esp().sendv(segs, 2));
+    ASSERT_EQ(arcana_test_dma_count, before + 2);
+    EXPECT_EQ(arcana_test_dma_log[before].src, (uint32_t)(uintptr_t)hdr);
+    EXPECT_EQ(arcana_test_dma_log[before + 1].src, (uint32_t)(uintptr_t)body);
+    EXPECT_EQ(arcana_test_dma_log[before + 1].length, 5u);
 }
 
 // ── waitFor: timeout (final responseContains check) ───────────────────────
@@ -189,35 +294,20 @@ TEST(Esp8266DriverTest, WaitForFindsResponseAfterIsr) {
     resetEsp();
     esp().initHAL();
     const char* msg = "OK\r\n";
-    for (size_t i = 0; i < strlen(msg); ++i) esp().isr_onRxByte((uint8_t)msg[i]);
+    rx(msg);
     esp().isr_onIdle();
     EXPECT_TRUE(esp().waitFor("OK", 100));
 }
 
-// ── Resource lock: requestAccess / releaseAccess ──────────────────────────
-
-TEST(Esp8266DriverTest, RequestAccessGrantsLock) {
-    resetEsp();
-    esp().initHAL();
-    esp().releaseAccess();   /* ensure unlocked */
-    esp().requestAccess(Esp8266::User::Mqtt);
-    /* mRequestedUser cleared after successful grant */
-    EXPECT_FALSE(esp().isAccessRequested());
-    esp().releaseAccess();
-}
+// ── Upload request flag ───────────────────────────────────────────────────
 
 TEST(Esp8266DriverTest, RequestAccessAsyncSetsRequestedUser) {
     resetEsp();
     esp().initHAL();
-    esp().releaseAccess();
-    esp().requestAccess(Esp8266::User::Mqtt);   /* Mqtt holds */
-
-    esp().requestAccessAsync(Esp8266::User::Upload);  /* Upload requests */
+    esp().requestAccessAsync(Esp8266::User::Upload);
     EXPECT_TRUE(esp().isAccessRequested());
     esp().clearRequest();
     EXPECT_FALSE(esp().isAccessRequested());
-
-    esp().releaseAccess();
 }
 
 // ── speedUp / setBaud / reset (no-op stubs but exercise HAL calls) ────────
@@ -0,0 +1,217 @@
+/**
+ * @file test_esp_link_demux.cpp
+ * @brief Host tests for LinkRxQueue / EspLinkDemux (AT+CIPMUX=1 stream split).
+ *
+ * Header-only, no HAL: the same parser the USART3 ISR runs is fed byte
+ * slices directly.
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+
+#include "EspLinkDemux.hpp"
+
+using arcana::EspLinkDemux;
+using arcana::LinkRxQueue;
+
+namespace {
+
+struct Rig {
+    EspLinkDemux demux;
+    LinkRxQueue  q[3];
+    uint8_t      buf[3][64] = {};
+    char         text[64] = {};
+
+    explicit Rig(uint8_t links = 3) {
+        demux.setTextBuffer(text, sizeof(text));
+        for (uint8_t i = 0; i < links; i++) {
+            q[i].init(buf[i], sizeof(buf[i]));
+            demux.attach(i, &q[i]);
+        }
+    }
+
+    uint8_t feed(const std::string& s) {
+        return demux.feed(reinterpret_cast<const uint8_t*>(s.data()), (uint16_t)s.size());
+    }
+
+    /** One byte per feed() — worst case DMA/IDLE slicing */
+    void feedBytewise(const std::string& s) {
+        for (char c : s) demux.feed(reinterpret_cast<const uint8_t*>(&c), 1);
+    }
+
+    std::string drain(uint8_t link) {
+        uint8_t out[128];
+        uint16_t n = q[link].read(out, sizeof(out));
+        return std::string(reinterpret_cast<char*>(out), n);
+    }
+};
+
+} // anonymous namespace
+
+// ── LinkRxQueue ──────────────────────────────────────────────────────────────
+
+TEST(LinkRxQueue, WrapsAroundTheEnd) {
+    uint8_t buf[8];
+    LinkRxQueue q;
+    q.init(buf, sizeof(buf));
+    uint8_t out[8];
+
+    EXPECT_EQ(q.push(reinterpret_cast<const uint8_t*>("abcdef"), 6), 6u);
+    EXPECT_EQ(q.read(out, 5), 5u);
+    EXPECT_EQ(q.push(reinterpret_cast<const uint8_t*>("ghijk"), 5), 5u);   // wraps
+    ASSERT_EQ(q.available(), 6u);
+    EXPECT_EQ(q.read(out, 8), 6u);
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(out), 6), "fghijk");
+}
+
+TEST(LinkRxQueue, PeekDoesNotConsumeSkipDoes) {
+    uint8_t buf[16];
+    LinkRxQueue q;
+    q.init(buf, sizeof(buf));
+    uint8_t out[4];
+
+    q.push(reinterpret_cast<const uint8_t*>("wxyz"), 4);
+    EXPECT_EQ(q.peek(out, 2), 2u);
+    EXPECT_EQ(q.available(), 4u);
+    EXPECT_EQ(q.skip(3), 3u);
+    EXPECT_EQ(q.read(out, 4), 1u);
+    EXPECT_EQ(out[0], 'z');
+    EXPECT_EQ(q.skip(5), 0u);
+}
+
+TEST(LinkRxQueue, OverflowIsDroppedAndCounted) {
+    uint8_t buf[4];
+    LinkRxQueue q;
+    q.init(buf, sizeof(buf));
+
+    EXPECT_EQ(q.push(reinterpret_cast<const uint8_t*>("123456"), 6), 4u);
+    EXPECT_EQ(q.available(), 4u);
+    EXPECT_EQ(q.dropped(), 2u);
+
+    q.clear();
+    EXPECT_EQ(q.available(), 0u);
+    EXPECT_EQ(q.dropped(), 2u);   // clear() keeps the counter
+}
+
+// ── Routing ──────────────────────────────────────────────────────────────────
+
+TEST(EspLinkDemux, RoutesByLinkIdAndKeepsTextInOrder) {
+    Rig r;
+    uint8_t ev = r.feed("OK\r\n+IPD,1,3:abc+IPD,0,2:xySEND OK\r\n");
+
+    EXPECT_EQ(r.drain(1), "abc");
+    EXPECT_EQ(r.drain(0), "xy");
+    EXPECT_EQ(r.drain(2), "");
+    EXPECT_STREQ(r.text, "OK\r\nSEND OK\r\n");
+    EXPECT_EQ(ev, 0x03);
+}
+
+TEST(EspLinkDemux, HeaderWithoutLinkIdGoesToLinkZero) {
+    Rig r;
+    r.feed("+IPD,4:ping");
+    EXPECT_EQ(r.drain(0), "ping");
+    EXPECT_EQ(r.text[0], '\0');
+}
+
+TEST(EspLinkDemux, HeaderAndPayloadSplitByteByByte) {
+    Rig r;
+    r.feedBytewise("ready\r\n+IPD,2,5:hello\r\nOK\r\n");
+    EXPECT_EQ(r.drain(2), "hello");
+    EXPECT_STREQ(r.text, "ready\r\n\r\nOK\r\n");
+    EXPECT_EQ(r.demux.framingErrors(), 0u);
+}
+
+TEST(EspLinkDemux, PayloadMayContainHeaderLookalikes) {
+    Rig r;
+    r.feed(std::string("+IPD,0,9:+IPD,1,1:") + "1,CLOSED\r\n");
+    EXPECT_EQ(r.drain(0), "+IPD,1,1:");
+    EXPECT_EQ(r.drain(1), "");
+    EXPECT_TRUE(r.demux.closed(1));
+}
+
+TEST(EspLinkDemux, PartialPrefixFallsBackToText) {
+    Rig r;
+    r.feed("+IP+IPD,0,1:z+IX");
+    EXPECT_STREQ(r.text, "+IP+IX");
+    EXPECT_EQ(r.drain(0), "z");
+}
+
+TEST(EspLinkDemux, CipdinfoAddressIsSkipped) {
+    Rig r;
+    r.feed("+IPD,1,4,192.168.1.5,8080:data");
+    EXPECT_EQ(r.drain(1), "data");
+    EXPECT_EQ(r.demux.framingErrors(), 0u);
+}
+
+// ── Link state ───────────────────────────────────────────────────────────────
+
+TEST(EspLinkDemux, ClosedLineMarksOnlyThatLink) {
+    Rig r;
+    uint8_t ev = r.feed("2,CLOSED\r\n");
+    EXPECT_TRUE(r.demux.closed(2));
+    EXPECT_FALSE(r.demux.closed(0));
+    EXPECT_EQ(ev, 0x04);
+
+    // Longer lines that merely contain it do not count
+    r.feed("12,CLOSED\r\nxx0,CLOSED\r\n");
+    EXPECT_FALSE(r.demux.closed(0));
+    EXPECT_FALSE(r.demux.closed(1));
+
+    r.demux.setClosed(2, false);
+    EXPECT_FALSE(r.demux.closed(2));
+}
+
+TEST(EspLinkDemux, UnattachedLinkIsCountedAsUnrouted) {
+    Rig r(1);   // only link 0 has a queue
+    uint8_t ev = r.feed("+IPD,3,6:abcdef+IPD,0,1:k");
+    EXPECT_EQ(r.demux.unrouted(), 6u);
+    EXPECT_EQ(r.drain(0), "k");
+    EXPECT_EQ(ev, 0x09);
+}
+
+// ── Framing errors ───────────────────────────────────────────────────────────
+
+TEST(EspLinkDemux, BadHeaderReturnsToText) {
+    Rig r;
+    r.feed("+IPD,x:OK\r\n");
+    EXPECT_EQ(r.demux.framingErrors(), 1u);
+    EXPECT_STREQ(r.text, ":OK\r\n");
+
+    r.feed("+IPD,:");
+    EXPECT_EQ(r.demux.framingErrors(), 2u);
+}
+
+TEST(EspLinkDemux, OversizeOrZeroLengthIsRejected) {
+    Rig r;
+    r.feed("+IPD,0,3000:");
+    r.feed("+IPD,0,0:");
+    r.feed("+IPD,0,123456:");
+    EXPECT_EQ(r.demux.framingErrors(), 3u);
+    EXPECT_EQ(r.q[0].available(), 0u);
+
+    // Parser is usable again afterwards
+    r.feed("+IPD,0,2:ok");
+    EXPECT_EQ(r.drain(0), "ok");
+}
+
+TEST(EspLinkDemux, ResetDropsHalfParsedPayload) {
+    Rig r;
+    r.feed("+IPD,1,10:abc");
+    r.demux.reset();
+    r.feed("OK\r\n");
+    EXPECT_STREQ(r.text, "OK\r\n");
+    EXPECT_EQ(r.drain(1), "abc");
+}
+
+// ── Text buffer ──────────────────────────────────────────────────────────────
+
+TEST(EspLinkDemux, TextIsTruncatedAndTerminated) {
+    Rig r;
+    r.feed(std::string(100, 'a'));
+    EXPECT_EQ(r.demux.textLen(), sizeof(r.text) - 1);
+    EXPECT_EQ(std::strlen(r.text), sizeof(r.text) - 1);
+
+    r.demux.clearText();
+    EXPECT_EQ(r.demux.textLen(), 0u);
+    EXPECT_STREQ(r.text, "");
+}
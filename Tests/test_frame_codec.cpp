@@ -135,3 +135,19 @@ TEST(FrameCodecTest, PayloadCorruptionDetected) {
     const uint8_t* p = nullptr; size_t len = 0; uint8_t f = 0, s = 0;
     EXPECT_FALSE(FrameCodec::deframe(buf, frameLen, p, len, f, s));
 }
+
+TEST(FrameCodecTest, FrameInPlaceMatchesCopy) {
+    const uint8_t payload[] = {0x10, 0x20, 0x30, 0x40};
+    uint8_t ref[32];
+    size_t refLen = 0;
+    ASSERT_TRUE(makeFrame(payload, 4, ref, sizeof(ref), refLen, FrameCodec::kFlagFin, 0x21));
+
+    // Payload already built at its final position (no second buffer)
+    uint8_t buf[32];
+    memcpy(buf + FrameCodec::kHeaderSize, payload, 4);
+    size_t len = 0;
+    ASSERT_TRUE(FrameCodec::frame(buf + FrameCodec::kHeaderSize, 4, FrameCodec::kFlagFin, 0x21,
+                                  buf, sizeof(buf), len));
+    ASSERT_EQ(len, refLen);
+    EXPECT_EQ(memcmp(buf, ref, len), 0);
+}
@@ -4,8 +4,9 @@
  *
  * Compiles the REAL Targets/stm32f103ze/Services/Driver/Hc08Ble.cpp against
  * UART HAL stubs (HAL_UART_Init/Transmit always return HAL_OK). The pure
- * logic functions — isr_onRxByte / isr_onIdle / processRxRing / sendCmd /
- * waitForData / send — are exercised directly.
+ * logic functions — isr_onIdle / processRxRing / sendCmd / waitForData /
+ * send — are exercised directly. Received bytes go through the RX DMA
+ * ring, played by mocks/SimUartDma.
  *
  * The default test target's COMMON_INCS resolves Hc08Ble.hpp to the host
  * MOCK in Tests/mocks/Hc08Ble.hpp. To pull in the real production header
@@ -14,14 +15,36 @@
  */
 #include <gtest/gtest.h>
 #include <cstring>
+#include <string>
 
 #include "stm32f1xx_hal.h"
 #include "Hc08Ble.hpp"
+#include "SimUartDma.hpp"
 
 using arcana::Hc08Ble;
+using arcana::test::SimUartDma;
+
+typedef uint32_t (*UlTaskNotifyTakeFn)(BaseType_t, TickType_t);
+extern UlTaskNotifyTakeFn g_ulTaskNotifyTakeOverride;
 
 namespace {
 Hc08Ble& ble() { return Hc08Ble::getInstance(); }
+
+/** Bytes on USART2 RX: the DMA writes them into the ring, no interrupt */
+void rx(const uint8_t* data, size_t len) {
+    ASSERT_TRUE(SimUartDma::instance().receive(USART2, data, len));
+}
+void rx(const char* msg) { rx((const uint8_t*)msg, strlen(msg)); }
+
+/** USART2 TX line: what the driver writes to DR on each TXE interrupt */
+std::string gWire;
+uint32_t pumpTxe(BaseType_t, TickType_t) {
+    for (int n = 0; n < 256 && (USART2->CR1 & USART_CR1_TXEIE); n++) {
+        ble().isr_onTxe();
+        gWire.push_back((char)USART2->DR);
+    }
+    return 1;
+}
 } // anonymous
 
 // ── Lifecycle ──────────────────────────────────────────────────────────────
@@ -35,29 +58,32 @@ TEST(Hc08BleDriverTest, GetInstanceSingleton) {
 TEST(Hc08BleDriverTest, InitHALSucceeds) {
     /* HAL_UART_* stubs return HAL_OK so initHAL → sendCmd("AT") → semaphore
      * timeout returns false → falls into the "data mode" branch. */
+    SimUartDma::instance();   /* capture the RX ring when initHAL starts it */
     EXPECT_TRUE(ble().initHAL());
 }
 
-// ── isr_onRxByte: AT mode + data mode ring buffer ─────────────────────────
+// ── RX DMA ring: AT mode + data mode ──────────────────────────────────────
 
-TEST(Hc08BleDriverTest, IsrOnRxByteAtModeBuffersBytes) {
+TEST(Hc08BleDriverTest, AtModeIdleCopiesRingToResponse) {
     auto& b = ble();
     b.setDataMode(false);
     b.clearRx();
 
-    const char msg[] = "OK\r\n";
-    for (size_t i = 0; i < sizeof(msg) - 1; ++i) {
-        b.isr_onRxByte((uint8_t)msg[i]);
-    }
-    EXPECT_GT(b.getResponseLen(), 0u);
+    rx("OK\r\n");
+    EXPECT_EQ(b.getResponseLen(), 0u);     /* no per-byte interrupt */
+    b.isr_onIdle();
+    EXPECT_EQ(b.getResponseLen(), 4u);
     EXPECT_NE(strstr(b.getResponse(), "OK"), nullptr);
 }
 
-TEST(Hc08BleDriverTest, IsrOnRxByteDataModePushesToRingBuffer) {
+TEST(Hc08BleDriverTest, DataModeRingFeedsAssembler) {
     auto& b = ble();
     b.setDataMode(true);
     /* Push a few bytes; processRxRing should drain them through FrameAssembler */
-    for (uint8_t i = 0; i < 10; ++i) b.isr_onRxByte(i);
+    uint8_t bytes[10];
+    for (uint8_t i = 0; i < 10; ++i) bytes[i] = i;
+    rx(bytes, sizeof(bytes));
+    b.isr_onIdle();
 
     /* FrameAssembler probably won't yield a frame from random bytes, but
      * processRxRing must drain without crashing. */
@@ -68,14 +94,20 @@ TEST(Hc08BleDriverTest, IsrOnRxByteDataModePushesToRingBuffer) {
     (void)got;
 }
 
-TEST(Hc08BleDriverTest, IsrOnRxByteDataModeFullDropsOverflow) {
+TEST(Hc08BleDriverTest, DataModeLappedRingCountsOverrun) {
     auto& b = ble();
     b.setDataMode(true);
-    /* Fill the ring buffer past RX_RING_SIZE=128 — overflow drops bytes */
-    for (int i = 0; i < 200; ++i) b.isr_onRxByte((uint8_t)(i & 0xFF));
-    /* Drain whatever made it in */
     while (b.processRxRing()) {}
-    SUCCEED();
+    uint32_t before = b.rxStats().overruns();
+    /* 200 bytes into the 128-byte ring with the task not reading */
+    uint8_t bytes[200];
+    for (int i = 0; i < 200; ++i) bytes[i] = (uint8_t)i;
+    rx(bytes, sizeof(bytes));
+    b.isr_onIdle();
+    /* The backlog was overwritten: it is dropped and counted, not parsed */
+    EXPECT_FALSE(b.processRxRing());
+    EXPECT_EQ(b.rxStats().overruns(), before + 1);
+    EXPECT_GE(b.rxStats().lostBytes(), 200u);
 }
 
 // ── processRxRing yields complete frames ───────────────────────────────────
@@ -93,7 +125,8 @@ TEST(Hc08BleDriverTest, ProcessRxRingFeedsFrameAssembler) {
     uint8_t frame[11] = {0xAC, 0xDA, 0x01, 0x00, 0x00, 0x02, 0x00, 'A', 'B', 0, 0};
     /* CRC isn't strictly needed — FrameAssembler doesn't verify; it just
      * accumulates and emits when length is reached. */
-    for (uint8_t byte : frame) b.isr_onRxByte(byte);
+    rx(frame, sizeof(frame));
+    b.isr_onIdle();
 
     /* processRxRing returns true when FrameAssembler has a complete frame */
     bool gotFrame = false;
@@ -141,8 +174,8 @@ TEST(Hc08BleDriverTest, WaitForDataReturnsAtLenInAtMode) {
     auto& b = ble();
     b.setDataMode(false);
     b.clearRx();
-    const char* msg = "RESP";
-    for (size_t i = 0; i < strlen(msg); ++i) b.isr_onRxByte((uint8_t)msg[i]);
+    rx("RESP");
+    b.isr_onIdle();
 
     EXPECT_GT(b.waitForData(100), 0u);
 }
@@ -152,15 +185,24 @@ TEST(Hc08BleDriverTest, WaitForDataReturnsRingCountInDataMode) {
     b.setDataMode(true);
     while (b.processRxRing()) {}
     /* Push 5 bytes */
-    for (uint8_t i = 0; i < 5; ++i) b.isr_onRxByte(0x55);
+    const uint8_t bytes[5] = {0x55, 0x55, 0x55, 0x55, 0x55};
+    rx(bytes, sizeof(bytes));
+    b.isr_onIdle();
     /* waitForData returns ring buffer pending count */
-    uint16_t pending = b.waitForData(100);
-    EXPECT_GE(pending, 0u);   /* at least returns without crashing */
+    EXPECT_EQ(b.waitForData(100), 5u);
     while (b.processRxRing()) {}
 }
 
-TEST(Hc08BleDriverTest, SendForwardsToHalUartTransmit) {
+TEST(Hc08BleDriverTest, SendFeedsUsartFromTxeInterrupt) {
     auto& b = ble();
     const uint8_t data[] = {0xDE, 0xAD, 0xBE, 0xEF};
+    /* DMA1 Ch7 belongs to I2C1: TX bytes go out one per TXE interrupt
+     * while the sending task sleeps on its notification */
+    gWire.clear();
+    g_ulTaskNotifyTakeOverride = pumpTxe;
     EXPECT_TRUE(b.send(data, sizeof(data)));
+    g_ulTaskNotifyTakeOverride = nullptr;
+    ASSERT_EQ(gWire.size(), sizeof(data));
+    EXPECT_EQ(memcmp(gWire.data(), data, sizeof(data)), 0);
+    EXPECT_FALSE(USART2->CR1 & USART_CR1_TXEIE);
 }
@@ -27,6 +27,7 @@
 #include "AtsStorageServiceImpl.hpp"
 #include "RegistrationServiceImpl.hpp"
 #include "HttpUploadServiceImpl.hpp"
+#include "test_helpers.h"
 #include "Esp8266.hpp"
 #include "SystemClock.hpp"
 
@@ -52,6 +53,9 @@ struct HttpUploadServiceTestAccess {
         return HttpUploadServiceImpl::sendHttpHeader(
             esp, filename, deviceId, bodySize, rangeStart, totalSize);
     }
+    static bool streamFileBody(Esp8266& esp, FIL* fp, uint32_t fileSize) {
+        return HttpUploadServiceImpl::streamFileBody(esp, fp, fileSize);
+    }
 };
 }
 
@@ -111,6 +115,32 @@ void createFakeDailyFile(const char* name, uint32_t size) {
     test_ff_create(name, bytes.data(), (UINT)size);
 }
 
+/** One Esp8266::linkSend (or linkSendAsync + linkSendWait):
+ *  CIPSEND prompt, the data, SEND OK */
+void pushSend(Esp8266& esp, int times = 1) {
+    for (int i = 0; i < times; i++) {
+        esp.pushResponse(">");
+        esp.pushResponse("");
+        esp.pushResponse("SEND OK");
+    }
+}
+
+/** queryServerOffset: open link 1, GET .../status, JSON reply, close */
+void pushStatusQuery(Esp8266& esp, const std::string& json) {
+    esp.pushResponse("OK");                      // CIPSTART=1
+    pushSend(esp);                               // GET
+    esp.pushIpd(1, "HTTP/1.1 200 OK\r\n\r\n" + json);
+    esp.pushResponse("OK");                      // CIPCLOSE=1
+}
+
+/** Body POST: open, header, body sends, reply, close */
+void pushPost(Esp8266& esp, int bodySends, const std::string& reply) {
+    esp.pushResponse("OK");                      // CIPSTART=1
+    pushSend(esp);                               // header
+    pushSend(esp, bodySends);                    // body chunks
+    esp.pushIpd(1, reply);
+    esp.pushResponse("OK");                      // CIPCLOSE=1
+}
 } // anonymous namespace
 
 // ── Smoke ──────────────────────────────────────────────────────────────────
@@ -192,75 +222,41 @@ TEST(HttpUploadFile, ServerAlreadyHasFile) {
     createFakeDailyFile("done.ats", 100);
 
     auto& esp = Esp8266::getInstance();
-    /* queryServerOffset response */
-    esp.pushResponse("OK");                  // CIPSTART
-    esp.pushResponse(">");                   // CIPSEND
-    esp.pushResponse("");                    // sendData header
-    esp.pushResponse("SEND OK");             // waitFor SEND OK
-    esp.pushResponse("\"size\":100");        // waitFor "size"
-    esp.pushResponse("OK");                  // CIPCLOSE
+    pushStatusQuery(esp, "{\"size\":100}");
 
     EXPECT_TRUE(HttpUploadServiceImpl::uploadFile(esp, "done.ats", "DEADBEEF"));
 }
 
 TEST(HttpUploadFile, FullUploadHappyPath) {
-    /* End-to-end uploadFile success — drives the entire upload pipeline:
-     * queryServerOffset → sslConnect → CIPMODE=1 → CIPSEND → header send →
-     * streamFileBody → CIPMODE=0 → waitHttpResponse → sslClose. */
+    /* End-to-end uploadFile success — drives the entire upload pipeline on
+     * link 1: queryServerOffset → sslConnect → header CIPSEND →
+     * streamFileBody CIPSENDs → waitHttpResponse → sslClose. */
     resetEnvironment();
     createFakeDailyFile("happy.ats", 256);
 
     auto& esp = Esp8266::getInstance();
-
-    /* 1. queryServerOffset: CIPSTART → CIPSEND → sendData → waitFor("SEND OK")
-     *    → waitFor("\"size\"") → CIPCLOSE */
-    esp.pushResponse("OK");                  // CIPSTART
-    esp.pushResponse(">");                   // CIPSEND
-    esp.pushResponse("");                    // sendData header
-    esp.pushResponse("SEND OK");             // waitFor SEND OK
-    esp.pushResponse("\"size\":0");          // waitFor "size" → offset 0
-    esp.pushResponse("OK");                  // CIPCLOSE
-
-    /* 2. sslConnect: CIPSTART */
-    esp.pushResponse("OK");                  // CIPSTART
-    /* 3. CIPMODE=1 */
-    esp.pushResponse("OK");                  // CIPMODE=1
-    /* 4. AT+CIPSEND (transparent mode) */
-    esp.pushResponse(">");                   // CIPSEND
-    /* 5. sendData header (POST) — empty response */
-    esp.pushResponse("");                    // sendData header
-    /* 6. streamFileBody — 256 bytes = 1 chunk via sendData */
-    esp.pushResponse("");                    // sendData body chunk
-    /* 7. sendData "+++" exit transparent mode */
-    esp.pushResponse("");                    // sendData "+++"
-    /* 8. AT+CIPMODE=0 */
-    esp.pushResponse("OK");                  // CIPMODE=0
-    /* 9. waitHttpResponse: waitFor "+IPD" → check "200" */
-    esp.pushResponse("HTTP/1.1 200 OK\r\n+IPD,5:hello");
-    /* 10. sslClose */
-    esp.pushResponse("OK");                  // CIPCLOSE
+    pushStatusQuery(esp, "{\"size\":0}");
+    pushPost(esp, 1, "HTTP/1.1 200 OK\r\n\r\n");
 
     EXPECT_TRUE(HttpUploadServiceImpl::uploadFile(esp, "happy.ats", "DEADBEEF"));
-    /* The Esp mock should have received many sentCmds */
-    EXPECT_GE(esp.sentCmds().size(), 6u);
+    /* Every AT command names link 1; MQTT's link 0 is never touched */
+    ASSERT_GE(esp.sentCmds().size(), 6u);
+    for (auto& cmd : esp.sentCmds()) {
+        EXPECT_TRUE(cmd.find("=1,") != std::string::npos ||
+                    cmd == "AT+CIPCLOSE=1") << cmd;
+    }
+    EXPECT_EQ(esp.sentCmds()[5], "AT+CIPSEND=1,256");
 }
 
-TEST(HttpUploadFile, CipModeFailureRetriesAndBails) {
+TEST(HttpUploadFile, UploadCipStartFailureRetriesAndBails) {
     resetEnvironment();
     createFakeDailyFile("retry.ats", 128);
     auto& esp = Esp8266::getInstance();
 
-    /* First attempt: queryServerOffset succeeds, then CIPMODE=1 fails */
+    /* Each attempt: queryServerOffset succeeds, then the upload CIPSTART fails */
     for (int attempt = 0; attempt < 5; ++attempt) {
-        esp.pushResponse("OK");                  // CIPSTART query
-        esp.pushResponse(">");                   // CIPSEND query
-        esp.pushResponse("");                    // sendData query
-        esp.pushResponse("SEND OK");             // waitFor SEND OK
-        esp.pushResponse("\"size\":0");          // waitFor "size"
-        esp.pushResponse("OK");                  // CIPCLOSE
-        esp.pushResponse("OK");                  // CIPSTART upload
-        esp.pushResponse("ERROR");               // CIPMODE=1 → fail
-        esp.pushResponse("OK");                  // CIPCLOSE
+        pushStatusQuery(esp, "{\"size\":0}");
+        esp.pushResponse("ERROR");               // CIPSTART upload → fail
     }
 
     /* Eventually stalls or runs out of attempts */
@@ -268,22 +264,15 @@ TEST(HttpUploadFile, CipModeFailureRetriesAndBails) {
     EXPECT_FALSE(ok);
 }
 
-TEST(HttpUploadFile, SendHeaderTransparentFailureBails) {
+TEST(HttpUploadFile, SendHeaderFailureBails) {
     resetEnvironment();
     createFakeDailyFile("nosend.ats", 64);
     auto& esp = Esp8266::getInstance();
 
     for (int attempt = 0; attempt < 5; ++attempt) {
-        esp.pushResponse("OK");                  // CIPSTART query
-        esp.pushResponse(">");                   // CIPSEND query
-        esp.pushResponse("");                    // sendData query
-        esp.pushResponse("SEND OK");             // waitFor SEND OK
-        esp.pushResponse("\"size\":0");          // waitFor "size"
-        esp.pushResponse("OK");                  // CIPCLOSE
+        pushStatusQuery(esp, "{\"size\":0}");
         esp.pushResponse("OK");                  // CIPSTART upload
-        esp.pushResponse("OK");                  // CIPMODE=1
         esp.pushResponse("ERROR");               // CIPSEND → fails (no >)
-        esp.pushResponse("OK");                  // CIPMODE=0
         esp.pushResponse("OK");                  // CIPCLOSE
     }
 
@@ -297,21 +286,8 @@ TEST(HttpUploadFile, WaitHttpResponseSuccess200) {
     auto& esp = Esp8266::getInstance();
 
     /* Drive a single attempt where waitHttpResponse sees "200" */
-    esp.pushResponse("OK");                  // CIPSTART query
-    esp.pushResponse(">");                   // CIPSEND query
-    esp.pushResponse("");                    // sendData query
-    esp.pushResponse("SEND OK");
-    esp.pushResponse("\"size\":0");
-    esp.pushResponse("OK");                  // CIPCLOSE query
-    esp.pushResponse("OK");                  // CIPSTART upload
-    esp.pushResponse("OK");                  // CIPMODE=1
-    esp.pushResponse(">");                   // CIPSEND
-    esp.pushResponse("");                    // sendData header
-    esp.pushResponse("");                    // sendData body
-    esp.pushResponse("");                    // sendData +++
-    esp.pushResponse("OK");                  // CIPMODE=0
-    esp.pushResponse("+IPD,5:HTTP/1.1 200 OK\r\n");
-    esp.pushResponse("OK");                  // CIPCLOSE
+    pushStatusQuery(esp, "{\"size\":0}");
+    pushPost(esp, 1, "HTTP/1.1 200 OK\r\n");
 
     EXPECT_TRUE(HttpUploadServiceImpl::uploadFile(esp, "rsp.ats", "DEADBEEF"));
 }
@@ -321,75 +297,80 @@ TEST(HttpUploadFile, WaitHttpResponseCompleteFallback) {
     createFakeDailyFile("rsp2.ats", 100);
     auto& esp = Esp8266::getInstance();
 
-    /* Server responds without "200" but with "complete" in body */
-    esp.pushResponse("OK");                  // CIPSTART query
-    esp.pushResponse(">");                   // CIPSEND query
-    esp.pushResponse("");                    // sendData query
-    esp.pushResponse("SEND OK");
-    esp.pushResponse("\"size\":0");
-    esp.pushResponse("OK");                  // CIPCLOSE query
-    esp.pushResponse("OK");                  // CIPSTART upload
-    esp.pushResponse("OK");                  // CIPMODE=1
-    esp.pushResponse(">");                   // CIPSEND
-    esp.pushResponse("");                    // sendData header
-    esp.pushResponse("");                    // sendData body
-    esp.pushResponse("");                    // sendData +++
-    esp.pushResponse("OK");                  // CIPMODE=0
-    esp.pushResponse("+IPD,8:complete");
-    esp.pushResponse("OK");                  // CIPCLOSE
+    /* Server responds without "200" but with "complete" in body, then
+     * hangs up */
+    pushStatusQuery(esp, "{\"size\":0}");
+    esp.pushResponse("OK");                      // CIPSTART upload
+    pushSend(esp);                               // header
+    pushSend(esp);                               // body
+    esp.pushIpd(1, "complete");
+    esp.pushResponse("1,CLOSED\r\n");
+    esp.pushResponse("OK");                      // CIPCLOSE
 
     EXPECT_TRUE(HttpUploadServiceImpl::uploadFile(esp, "rsp2.ats", "DEADBEEF"));
 }
 
 TEST(HttpUploadPending, FullSuccessTriggersMarkUploadedAndDeviceAts) {
     /* End-to-end uploadPendingFiles success path: queues responses for
-     * 1 daily file (full happy path) + the device.ats follow-up.
-     * Covers lines 93-110 (markUploaded → uploaded++ → device.ats upload). */
+     * 1 daily file (manifest exchange + its one missing chunk) and the
+     * device.ats follow-up, which the server already holds.
+     * Covers markUploaded → uploaded++ → device.ats sync. */
     resetEnvironment();
     ASSERT_TRUE(bootStorage());
     createFakeDailyFile("20260301.ats", 200);
 
     auto& esp = Esp8266::getInstance();
 
-    /* Helper lambda: push the 14-response sequence for one full uploadFile */
-    auto pushOneUploadFileSequence = [&]() {
-        esp.pushResponse("OK");                  // CIPSTART query
-        esp.pushResponse(">");                   // CIPSEND query
-        esp.pushResponse("");                    // sendData query
-        esp.pushResponse("SEND OK");
-        esp.pushResponse("\"size\":0");
-        esp.pushResponse("OK");                  // CIPCLOSE query
-        esp.pushResponse("OK");                  // CIPSTART upload
-        esp.pushResponse("OK");                  // CIPMODE=1
-        esp.pushResponse(">");                   // CIPSEND
-        esp.pushResponse("");                    // sendData header
-        esp.pushResponse("");                    // sendData body
-        esp.pushResponse("");                    // sendData +++
-        esp.pushResponse("OK");                  // CIPMODE=0
-        esp.pushResponse("+IPD:HTTP/1.1 200 OK");
-        esp.pushResponse("OK");                  // CIPCLOSE
-    };
+    /* Manifest exchange: 200 bytes = 1 chunk = 1 digest batch */
+    pushPost(esp, 1, "{\"missing\":\"0\"}");
+    pushPost(esp, 1, "{\"status\":\"complete\"}");
 
-    pushOneUploadFileSequence();   // for 20260301.ats
-    pushOneUploadFileSequence();   // for device.ats follow-up
+    uint8_t n = HttpUploadServiceImpl::uploadPendingFiles(esp);
+    EXPECT_EQ(n, 1u);
+}
 
+namespace {
+int sPumpLocksMax = 0;
+void recordPumpLocks(void*) {
+    int held = test_semaphore_lock_balance();
+    if (held > sPumpLocksMax) sPumpLocksMax = held;
+}
+}
+
+TEST(HttpUploadPending, ReadCacheLockedWhileFileStreams) {
+    /* The sync borrows sReadCache: record streaming from the bridge must
+     * wait on the read cache lock, and it is free again for markUploaded
+     * and once the upload returns */
+    resetEnvironment();
+    ASSERT_TRUE(bootStorage());
+    createFakeDailyFile("20260301.ats", 200);
+
+    auto& esp = Esp8266::getInstance();
+    pushPost(esp, 1, "{\"missing\":\"0\"}");
+    pushPost(esp, 1, "{\"status\":\"complete\"}");
+
+    int before = test_semaphore_lock_balance();
+    sPumpLocksMax = before;
+    HttpUploadServiceImpl::setPump(recordPumpLocks, nullptr);
     uint8_t n = HttpUploadServiceImpl::uploadPendingFiles(esp);
+    HttpUploadServiceImpl::setPump(nullptr, nullptr);
+
     EXPECT_EQ(n, 1u);
+    EXPECT_EQ(sPumpLocksMax, before + 1);
+    EXPECT_EQ(test_semaphore_lock_balance(), before);
 }
 
 TEST(HttpUploadFile, AlreadyConnectedRecoveryPath) {
-    /* sslConnect: CIPSTART returns ALREADY CONNECTED → responseContains
-     * branch returns true, sslConnect succeeds. Covers line 295. */
+    /* sslConnect: CIPSTART returns ALREADY CONNECTED → linkOpen treats it
+     * as success. */
     resetEnvironment();
     createFakeDailyFile("ac.ats", 100);
     auto& esp = Esp8266::getInstance();
 
     /* queryServerOffset uses sslConnect — feed ALREADY CONNECTED there */
     esp.pushResponse("ALREADY CONNECTED");       // CIPSTART query (no OK)
-    esp.pushResponse(">");                       // CIPSEND
-    esp.pushResponse("");                        // sendData
-    esp.pushResponse("SEND OK");
-    esp.pushResponse("\"size\":100");            // already done → fast path
+    pushSend(esp);
+    esp.pushIpd(1, "{\"size\":100}");         // already done → fast path
     esp.pushResponse("OK");                      // CIPCLOSE
 
     EXPECT_TRUE(HttpUploadServiceImpl::uploadFile(esp, "ac.ats", "DEADBEEF"));
@@ -441,10 +422,9 @@ TEST(HttpUploadFile, QueryServerOffsetNoSizeFieldReturnsZero) {
 
     for (int i = 0; i < 30; ++i) {
         esp.pushResponse("OK");                  // CIPSTART query
-        esp.pushResponse(">");                   // CIPSEND query
-        esp.pushResponse("");                    // sendData query
-        esp.pushResponse("SEND OK");
-        esp.pushResponse("garbage");             // waitFor "size" → fail
+        pushSend(esp);
+        esp.pushIpd(1, "garbage");               // no "size" → fail
+        esp.pushResponse("1,CLOSED\r\n");
         esp.pushResponse("OK");                  // CIPCLOSE query
         esp.pushResponse("ERROR");               // CIPSTART upload → fail
     }
@@ -460,31 +440,16 @@ TEST(HttpUploadFile, ResumeFromServerOffset) {
     createFakeDailyFile("resume.ats", 1000);
     auto& esp = Esp8266::getInstance();
 
-    esp.pushResponse("OK");                  // CIPSTART query
-    esp.pushResponse(">");                   // CIPSEND query
-    esp.pushResponse("");                    // sendData query
-    esp.pushResponse("SEND OK");
-    esp.pushResponse("\"size\":500");        // server has half — resume from 500
-    esp.pushResponse("OK");                  // CIPCLOSE query
-    esp.pushResponse("OK");                  // CIPSTART upload
-    esp.pushResponse("OK");                  // CIPMODE=1
-    esp.pushResponse(">");                   // CIPSEND
-    esp.pushResponse("");                    // sendData header
-    esp.pushResponse("");                    // sendData body chunk
-    esp.pushResponse("");                    // sendData +++
-    esp.pushResponse("OK");                  // CIPMODE=0
-    esp.pushResponse("+IPD,5:HTTP/1.1 200 OK");
-    esp.pushResponse("OK");                  // CIPCLOSE
+    pushStatusQuery(esp, "{\"size\":500}");   // server has half — resume from 500
+    pushPost(esp, 1, "HTTP/1.1 200 OK");
 
     EXPECT_TRUE(HttpUploadServiceImpl::uploadFile(esp, "resume.ats", "DEADBEEF"));
     EXPECT_EQ(arcana::g_uploadProgress.resumeOffset, 500u);
+    std::string hdr(esp.sentData()[1].begin(), esp.sentData()[1].end());
+    EXPECT_NE(hdr.find("Content-Range: bytes 500-999/1000\r\n"), std::string::npos);
 }
 
-// ── sendHttpHeader (legacy non-transparent path) ────────────────────────────
-//
-// sendHttpHeader is declared in the header but only its inline twin is used
-// from uploadFile. We exercise the static helper directly to claim coverage
-// for the dead-but-shipped code path.
+// ── sendHttpHeader (one linkSend on the upload link) ────────────────────────
 
 TEST(HttpUploadHeader, SendHttpHeaderHappyPath) {
     resetEnvironment();
@@ -516,3 +481,193 @@ TEST(HttpUploadHeader, SendHttpHeaderSendOkFails) {
     EXPECT_FALSE(arcana::HttpUploadServiceTestAccess::sendHttpHeader(
         esp, "20260101.ats", "DEADBEEF", 100, 0, 100));
 }
+
+// ── streamFileBody: ping-pong SD read / UART DMA send pipeline ────────────
+
+namespace {
+std::vector<uint8_t> patternFile(const char* name, uint32_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (uint32_t i = 0; i < size; i++) bytes[i] = (uint8_t)(i * 7 + (i >> 8));
+    test_ff_create(name, bytes.data(), (UINT)size);
+    return bytes;
+}
+
+std::vector<uint8_t> wire(const Esp8266& esp) {
+    std::vector<uint8_t> out;
+    for (auto& blob : esp.sentData()) out.insert(out.end(), blob.begin(), blob.end());
+    return out;
+}
+} // anonymous namespace
+
+TEST(HttpUploadStream, BodyGoesOutInOrderFromBothHalves) {
+    resetEnvironment();
+    auto bytes = patternFile("pipe.ats", 5000);
+    auto& esp = Esp8266::getInstance();
+    FIL fp = {};
+    ASSERT_EQ(f_open(&fp, "pipe.ats", FA_READ), FR_OK);
+    pushSend(esp, 3);
+
+    EXPECT_TRUE(arcana::HttpUploadServiceTestAccess::streamFileBody(esp, &fp, 5000));
+    f_close(&fp);
+
+    ASSERT_EQ(esp.sentData().size(), 3u);
+    EXPECT_EQ(esp.sentData()[0].size(), 2048u);
+    EXPECT_EQ(esp.sentData()[1].size(), 2048u);
+    EXPECT_EQ(esp.sentData()[2].size(), 904u);
+    EXPECT_EQ(wire(esp), bytes);
+    EXPECT_EQ(arcana::g_uploadProgress.bytesSent, 5000u);
+    EXPECT_EQ(arcana::g_uploadProgress.chunkSize, 2048u);
+    EXPECT_EQ(arcana::g_uploadProgress.readRetries, 0u);
+    EXPECT_GT(arcana::g_uploadProgress.bytesPerSec, 0u);
+    EXPECT_GT(arcana::g_uploadProgress.txRate, 0u);
+}
+
+TEST(HttpUploadStream, ReadRetryShrinksTheNextChunks) {
+    resetEnvironment();
+    auto bytes = patternFile("retry.ats", 5000);
+    auto& esp = Esp8266::getInstance();
+    FIL fp = {};
+    ASSERT_EQ(f_open(&fp, "retry.ats", FA_READ), FR_OK);
+    pushSend(esp, 4);
+
+    test_ff_fail_read(1);   // first read needs a retry
+    EXPECT_TRUE(arcana::HttpUploadServiceTestAccess::streamFileBody(esp, &fp, 5000));
+    f_close(&fp);
+
+    // The retried read keeps its size; the ones after it are halved
+    ASSERT_EQ(esp.sentData().size(), 4u);
+    EXPECT_EQ(esp.sentData()[0].size(), 2048u);
+    EXPECT_EQ(esp.sentData()[1].size(), 1024u);
+    EXPECT_EQ(esp.sentData()[2].size(), 1024u);
+    EXPECT_EQ(esp.sentData()[3].size(), 904u);
+    EXPECT_EQ(wire(esp), bytes);
+    EXPECT_EQ(arcana::g_uploadProgress.readRetries, 1u);
+}
+
+TEST(HttpUploadStream, ReadFailureBeforeFirstChunkSendsNothing) {
+    resetEnvironment();
+    patternFile("bad.ats", 3000);
+    auto& esp = Esp8266::getInstance();
+    FIL fp = {};
+    ASSERT_EQ(f_open(&fp, "bad.ats", FA_READ), FR_OK);
+
+    test_ff_fail_read(3);
+    EXPECT_FALSE(arcana::HttpUploadServiceTestAccess::streamFileBody(esp, &fp, 3000));
+    f_close(&fp);
+    EXPECT_TRUE(esp.sentData().empty());
+}
+
+TEST(HttpUploadStream, TxFailureStopsThePipeline) {
+    resetEnvironment();
+    patternFile("stuck.ats", 5000);
+    auto& esp = Esp8266::getInstance();
+    FIL fp = {};
+    ASSERT_EQ(f_open(&fp, "stuck.ats", FA_READ), FR_OK);
+
+    pushSend(esp);
+    esp.setTxOk(false);
+    EXPECT_FALSE(arcana::HttpUploadServiceTestAccess::streamFileBody(esp, &fp, 5000));
+    f_close(&fp);
+    // Only the first chunk was handed to the UART; it never counted as sent
+    EXPECT_EQ(esp.sentData().size(), 1u);
+    EXPECT_EQ(arcana::g_uploadProgress.bytesSent, 0u);
+}
+
+// ── syncFile (manifest → missing chunks only) ──────────────────────────────
+
+namespace {
+void pushManifestRound(Esp8266& esp, int digestBatches, const std::string& reply) {
+    pushPost(esp, digestBatches, reply);
+}
+
+std::vector<uint8_t> digestOf(const std::vector<uint8_t>& file, uint32_t off, uint32_t len) {
+    uint8_t full[arcana::crypto::Sha256::HASH_SIZE];
+    arcana::crypto::Sha256::hash(file.data() + off, len, full);
+    return std::vector<uint8_t>(full, full + arcana::UploadManifest::DIGEST_SIZE);
+}
+
+std::string text(const std::vector<uint8_t>& blob) {
+    return std::string(blob.begin(), blob.end());
+}
+} // anonymous namespace
+
+TEST(HttpUploadSync, NothingMissingSendsOnlyTheManifest) {
+    resetEnvironment();
+    auto file = patternFile("same.ats", 3 * 4096 + 100);
+    auto& esp = Esp8266::getInstance();
+    pushManifestRound(esp, 1, "{\"missing\":\"\"}");
+
+    EXPECT_TRUE(HttpUploadServiceImpl::syncFile(esp, "same.ats", "DEADBEEF"));
+
+    // header, digests — no body
+    ASSERT_EQ(esp.sentData().size(), 2u);
+    std::string hdr = text(esp.sentData()[0]);
+    EXPECT_NE(hdr.find("POST /upload/DEADBEEF/same.ats/manifest"), std::string::npos);
+    EXPECT_NE(hdr.find("Content-Length: 32\r\n"), std::string::npos);
+    EXPECT_NE(hdr.find("X-File-Size: 12388\r\n"), std::string::npos);
+    EXPECT_NE(hdr.find("X-Max-Ranges: 16\r\n"), std::string::npos);
+
+    // One truncated SHA-256 per 4KB chunk, the short tail included
+    std::vector<uint8_t> expect;
+    for (uint32_t off = 0; off < file.size(); off += 4096) {
+        uint32_t len = file.size() - off < 4096 ? (uint32_t)(file.size() - off) : 4096u;
+        auto d = digestOf(file, off, len);
+        expect.insert(expect.end(), d.begin(), d.end());
+    }
+    EXPECT_EQ(esp.sentData()[1], expect);
+}
+
+TEST(HttpUploadSync, SendsOnlyTheMissingRanges) {
+    resetEnvironment();
+    auto file = patternFile("grown.ats", 5 * 4096 + 300);
+    auto& esp = Esp8266::getInstance();
+    pushManifestRound(esp, 1, "{\"missing\":\"1,4-5\"}");
+    pushPost(esp, 5, "{\"status\":\"complete\"}");   // 2 + 3 body sends
+
+    EXPECT_TRUE(HttpUploadServiceImpl::syncFile(esp, "grown.ats", "DEADBEEF"));
+
+    // manifest round: header, digests; then chunks header
+    ASSERT_EQ(esp.sentData().size(), 8u);
+    std::string hdr = text(esp.sentData()[2]);
+    EXPECT_NE(hdr.find("POST /upload/DEADBEEF/grown.ats/chunks"), std::string::npos);
+    EXPECT_NE(hdr.find("Content-Length: 8492\r\n"), std::string::npos);
+    EXPECT_NE(hdr.find("X-Ranges: 1,4-5\r\n\r\n"), std::string::npos);
+
+    // Body: chunk 1, then chunks 4 and the short chunk 5
+    std::vector<uint8_t> body;
+    for (size_t i = 3; i < esp.sentData().size(); i++) {
+        body.insert(body.end(), esp.sentData()[i].begin(), esp.sentData()[i].end());
+    }
+    std::vector<uint8_t> expect(file.begin() + 4096, file.begin() + 8192);
+    expect.insert(expect.end(), file.begin() + 4 * 4096, file.end());
+    EXPECT_EQ(body, expect);
+}
+
+TEST(HttpUploadSync, ServerWithoutManifestGetsTheWholeFile) {
+    resetEnvironment();
+    createFakeDailyFile("old.ats", 256);
+    auto& esp = Esp8266::getInstance();
+    esp.pushResponse("OK");                      // CIPSTART
+    pushSend(esp, 2);                            // header, digests
+    esp.pushIpd(1, "HTTP/1.1 404 NOT FOUND\r\n\r\n");
+    esp.pushResponse("1,CLOSED\r\n");
+    esp.pushResponse("OK");                      // CIPCLOSE
+
+    // uploadFile: server already has it
+    pushStatusQuery(esp, "{\"size\":256}");
+
+    EXPECT_TRUE(HttpUploadServiceImpl::syncFile(esp, "old.ats", "DEADBEEF"));
+    std::string status = text(esp.sentData()[2]);
+    EXPECT_NE(status.find("GET /upload/DEADBEEF/old.ats/status"), std::string::npos);
+}
+
+TEST(HttpUploadSync, MalformedMissingListIsRetried) {
+    resetEnvironment();
+    createFakeDailyFile("odd.ats", 256);
+    auto& esp = Esp8266::getInstance();
+    pushManifestRound(esp, 1, "{\"missing\":\"7\"}");   // past the last chunk
+    pushManifestRound(esp, 1, "{\"missing\":\"\"}");
+
+    EXPECT_TRUE(HttpUploadServiceImpl::syncFile(esp, "odd.ats", "DEADBEEF"));
+    EXPECT_EQ(arcana::g_uploadProgress.attempts, 2u);
+}
@@ -2,13 +2,13 @@
  * @file test_i2c_drivers.cpp
  * @brief Host coverage for I2cBus + Mpu6050Sensor + Ap3216cSensor + DhtSensor.
  *
- * I2cBus is a software bit-bang driver. The HAL_GPIO_Write/Read stubs make
- * SDA reads return "released" (HIGH) which means every I2C ACK fails — but
- * we still cover all the bit-shifting and byte-pulse paths.
+ * I2cBus bit-bangs PB6/PB7; SimI2cBus (mocks/SimI2c.hpp) watches those pins
+ * through the HAL stub's GPIO hooks and answers as the devices attached per
+ * test. With nothing attached every address phase is NACKed.
  *
- * delayUs() spins on DWT->CYCCNT. test_hal_stub leaves CYCCNT at 0 forever,
- * so we set SystemCoreClock = 0 before each test → cycles = us * 0 = 0 →
- * the wait loop exits immediately. Restored to 72MHz after.
+ * I2cBus and DhtSensor delays spin on DWT->CYCCNT. test_hal_stub leaves
+ * CYCCNT at 0 forever, so we set SystemCoreClock = 0 before each test →
+ * cycles = us * 0 = 0 → the wait loop exits immediately. Restored after.
  */
 #include <gtest/gtest.h>
 #include <cstring>
@@ -18,8 +18,12 @@
 #include "Mpu6050Sensor.hpp"
 #include "Ap3216cSensor.hpp"
 #include "DhtSensor.hpp"
+#include "SimI2c.hpp"
 
 using arcana::I2cBus;
+using arcana::test::SimI2cBus;
+using arcana::test::SimMpu6050;
+using arcana::test::SimRegDevice;
 
 namespace {
 struct DwtFreezer {
@@ -43,8 +47,8 @@ TEST(I2cBusTest, InitHALCompletes) {
 
 TEST(I2cBusTest, WriteRegFailsOnNack) {
     DwtFreezer f;
-    /* SDA reads always return HIGH (released) → I2cBus interprets as NACK
-     * → sendByte returns false → writeReg short-circuits and returns false */
+    /* No simulated device at 0x68 → address phase NACKed → writeReg
+     * sends STOP and returns false */
     EXPECT_FALSE(I2cBus::getInstance().writeReg(0x68, 0x6B, 0x00));
 }
 
@@ -60,12 +64,216 @@ TEST(I2cBusTest, ReadRegsFailsOnNack) {
     EXPECT_FALSE(I2cBus::getInstance().readRegs(0x68, 0x3B, buf, 6));
 }
 
+// ── I2cBus against simulated devices ──────────────────────────────────────
+
+namespace {
+class SimBusTest : public ::testing::Test {
+protected:
+    DwtFreezer dwt;
+    SimI2cBus& sim = SimI2cBus::instance();
+    I2cBus& bus = I2cBus::getInstance();
+
+    void SetUp() override {
+        sim.reset();
+        bus.initHAL();
+    }
+    void TearDown() override { sim.reset(); }
+};
+} // anonymous
+
+TEST_F(SimBusTest, WriteRegReachesDevice) {
+    SimRegDevice dev;
+    sim.attach(0x1E, &dev);
+    EXPECT_TRUE(bus.writeReg(0x1E, 0x00, 0x03));
+    EXPECT_EQ(dev.regs[0x00], 0x03);
+    EXPECT_EQ(sim.starts, 1u);
+    EXPECT_EQ(sim.stops, 1u);
+}
+
+TEST_F(SimBusTest, SingleByteRead) {
+    SimRegDevice dev;
+    dev.regs[0x0C] = 0x5A;
+    sim.attach(0x1E, &dev);
+    uint8_t v = 0;
+    EXPECT_TRUE(bus.readReg(0x1E, 0x0C, &v));
+    EXPECT_EQ(v, 0x5A);
+    EXPECT_EQ(sim.starts, 2u);      // START + repeated START
+    EXPECT_EQ(sim.bytesRead, 1u);   // NACKed after one byte
+}
+
+TEST_F(SimBusTest, MultiByteReadIsOneTransaction) {
+    SimRegDevice dev;
+    for (int i = 0; i < 6; i++) dev.regs[0x3B + i] = (uint8_t)(0xA0 + i);
+    sim.attach(0x68, &dev);
+    uint8_t buf[6] = {};
+    EXPECT_TRUE(bus.readRegs(0x68, 0x3B, buf, 6));
+    for (int i = 0; i < 6; i++) EXPECT_EQ(buf[i], 0xA0 + i);
+    EXPECT_EQ(sim.starts, 2u);
+    EXPECT_EQ(sim.stops, 1u);
+    EXPECT_EQ(sim.bytesRead, 6u);   // no read-ahead past the final NACK
+}
+
+TEST_F(SimBusTest, NackCountsErrorAndLeavesBusIdle) {
+    uint32_t before = bus.errorCount();
+    uint8_t buf[4];
+    EXPECT_FALSE(bus.readRegs(0x50, 0x00, buf, 4));
+    EXPECT_EQ(bus.errorCount(), before + 1);
+    EXPECT_EQ(sim.nacks, 1u);
+    EXPECT_EQ(sim.bytesRead, 0u);
+    EXPECT_TRUE(sim.sdaLine());
+
+    /* Next transaction to a present device goes through */
+    SimRegDevice dev;
+    sim.attach(0x1E, &dev);
+    EXPECT_TRUE(bus.writeReg(0x1E, 0x01, 0x02));
+}
+
+TEST_F(SimBusTest, DataNackFailsWrite) {
+    class ReadOnly : public SimRegDevice {
+        bool write(uint8_t byte) override {
+            if (mSelect) return SimRegDevice::write(byte);
+            return false;
+        }
+    } dev;
+    sim.attach(0x1E, &dev);
+    uint32_t before = bus.errorCount();
+    EXPECT_FALSE(bus.writeReg(0x1E, 0x00, 0x01));
+    EXPECT_EQ(bus.errorCount(), before + 1);
+    EXPECT_EQ(sim.nacks, 1u);
+    EXPECT_EQ(sim.stops, 1u);
+}
+
+TEST_F(SimBusTest, StuckBusIsRecoveredBeforeStart) {
+    SimRegDevice dev;
+    sim.attach(0x1E, &dev);
+    sim.stuck = true;
+    uint32_t before = bus.recoveryCount();
+    EXPECT_TRUE(bus.writeReg(0x1E, 0x00, 0x01));
+    EXPECT_EQ(bus.recoveryCount(), before + 1);
+    EXPECT_FALSE(sim.stuck);
+    EXPECT_EQ(dev.regs[0x00], 0x01);
+}
+
+// ── Mpu6050Sensor FIFO burst mode (simulated chip) ─────────────────────────
+
+namespace {
+class Mpu6050FifoTest : public SimBusTest {
+protected:
+    SimMpu6050 chip;
+    arcana::sensor::Mpu6050Sensor mpu;
+    int16_t xyz[64 * 3] = {};
+
+    void SetUp() override {
+        SimBusTest::SetUp();
+        sim.attach(0x68, &chip);
+        mpu.init(&bus);
+    }
+    void expectSamples(uint16_t n, uint32_t first) {
+        for (uint16_t i = 0; i < n; i++) {
+            ASSERT_EQ(xyz[i * 3 + 0], SimMpu6050::sampleX(first + i)) << i;
+            ASSERT_EQ(xyz[i * 3 + 1], SimMpu6050::sampleY(first + i)) << i;
+            ASSERT_EQ(xyz[i * 3 + 2], SimMpu6050::sampleZ(first + i)) << i;
+        }
+    }
+};
+} // anonymous
+
+TEST_F(Mpu6050FifoTest, EnableProgramsRateAndAccelFifo) {
+    ASSERT_TRUE(mpu.enableFifo(500));
+    EXPECT_TRUE(mpu.fifoEnabled());
+    EXPECT_EQ(mpu.sampleRateHz(), 500u);
+    EXPECT_EQ(chip.sampleRateHz(), 500u);
+    EXPECT_TRUE(chip.fifoEnabled());
+    EXPECT_EQ(chip.regs[0x6B], 0x01);     // awake, gyro PLL clock
+
+    /* Divider rounds to the nearest rate at or above the request */
+    ASSERT_TRUE(mpu.enableFifo(300));
+    EXPECT_EQ(mpu.sampleRateHz(), 333u);
+    ASSERT_TRUE(mpu.enableFifo(5000));
+    EXPECT_EQ(mpu.sampleRateHz(), 1000u);
+}
+
+TEST_F(Mpu6050FifoTest, EnableFailsWithoutChip) {
+    chip.regs[0x75] = 0x00;               // wrong WHO_AM_I
+    EXPECT_FALSE(mpu.enableFifo(100));
+    EXPECT_FALSE(mpu.fifoEnabled());
+    sim.reset();
+    EXPECT_FALSE(mpu.enableFifo(100));
+}
+
+TEST_F(Mpu6050FifoTest, BurstDrainsWholeFramesInOneTransfer) {
+    ASSERT_TRUE(mpu.enableFifo(1000));
+    chip.produce(20);
+    uint32_t stopsBefore = sim.stops;
+    uint32_t bytesBefore = sim.bytesRead;
+    arcana::sensor::Mpu6050FifoRead r = mpu.readFifo(xyz, 32);
+    EXPECT_TRUE(r.ok);
+    EXPECT_FALSE(r.overflow);
+    EXPECT_EQ(r.frames, 20u);
+    EXPECT_EQ(r.pending, 0u);
+    expectSamples(20, 0);
+    /* INT_STATUS, FIFO_COUNT (2 bytes), then the 120-byte burst */
+    EXPECT_EQ(sim.stops - stopsBefore, 3u);
+    EXPECT_EQ(sim.bytesRead - bytesBefore, 1u + 2u + 120u);
+    EXPECT_TRUE(chip.fifo.empty());
+}
+
+TEST_F(Mpu6050FifoTest, DrainIsCappedAndResumesInOrder) {
+    ASSERT_TRUE(mpu.enableFifo(1000));
+    chip.produce(40);
+    arcana::sensor::Mpu6050FifoRead r = mpu.readFifo(xyz, 32);
+    EXPECT_EQ(r.frames, 32u);
+    EXPECT_EQ(r.pending, 8u);
+    expectSamples(32, 0);
+
+    r = mpu.readFifo(xyz, 32);
+    EXPECT_EQ(r.frames, 8u);
+    EXPECT_EQ(r.pending, 0u);
+    expectSamples(8, 32);
+}
+
+TEST_F(Mpu6050FifoTest, OverflowResetsFifoAndRealigns) {
+    ASSERT_TRUE(mpu.enableFifo(1000));
+    chip.produce(200);                    // 1200 bytes into 1KB
+    arcana::sensor::Mpu6050FifoRead r = mpu.readFifo(xyz, 32);
+    EXPECT_TRUE(r.ok);
+    EXPECT_TRUE(r.overflow);
+    EXPECT_EQ(r.frames, 0u);
+    EXPECT_TRUE(chip.fifo.empty());
+
+    chip.produce(5);
+    r = mpu.readFifo(xyz, 32);
+    EXPECT_FALSE(r.overflow);
+    EXPECT_EQ(r.frames, 5u);
+    expectSamples(5, 200);
+}
+
+TEST_F(Mpu6050FifoTest, ReadFifoWithoutEnableReturnsNothing) {
+    chip.produce(10);
+    arcana::sensor::Mpu6050FifoRead r = mpu.readFifo(xyz, 32);
+    EXPECT_FALSE(r.ok);
+    EXPECT_EQ(r.frames, 0u);
+}
+
+TEST_F(Mpu6050FifoTest, TemperatureAndPolledReadShareScaling) {
+    chip.setTemperatureRaw(-3400);        // 36.53 - 10
+    float t = 0;
+    ASSERT_TRUE(mpu.readTemperature(&t));
+    EXPECT_NEAR(t, 26.53f, 0.01f);
+
+    chip.produce(3);
+    arcana::sensor::Mpu6050Reading r = mpu.read();
+    ASSERT_TRUE(r.valid);
+    EXPECT_EQ(r.accelX, SimMpu6050::sampleX(2));
+    EXPECT_EQ(r.accelZ, SimMpu6050::sampleZ(2));
+    EXPECT_NEAR(r.temperature, 26.53f, 0.01f);
+}
+
 // ── Mpu6050Sensor + Ap3216cSensor (production drivers, NOT the stub) ──────
 //
 // These tests link the real Mpu6050Sensor.cpp + Ap3216cSensor.cpp instead of
-// the host stub in sensor_drivers_stub.cpp. The production drivers use
-// I2cBus to read raw registers — every read fails on host but the read()
-// method's branches are still exercised.
+// the host stub in sensor_drivers_stub.cpp. With no simulated device on the
+// bus every read fails, which exercises the read() failure branches.
 
 TEST(Mpu6050SensorTest, ReadReturnsInvalidWhenI2cFails) {
     DwtFreezer f;
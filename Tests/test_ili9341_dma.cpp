@@ -0,0 +1,174 @@
+/**
+ * @file test_ili9341_dma.cpp
+ * @brief Host coverage for the Ili9341Lcd DMA fill / blit path.
+ *
+ * Links the REAL Ili9341Lcd.cpp (F103_DRV before MOCKS_DIR). The LCD
+ * command/data ports are host RAM words and the HAL DMA mock records one
+ * descriptor per HAL_DMA_Start_IT, then completes synchronously through
+ * XferCpltCallback — so the driver's semaphore wait path runs as on target.
+ *
+ * Addresses in the log are 32-bit (HAL API width); compare against the
+ * truncated host pointer.
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+
+#include "stm32f1xx_hal.h"
+#include "Ili9341Lcd.hpp"
+#include "Ili9341Display.hpp"
+
+using arcana::lcd::Ili9341Lcd;
+using arcana::display::Ili9341Display;
+
+namespace {
+
+uint32_t addr32(const void* p) { return (uint32_t)(uintptr_t)p; }
+
+class Ili9341DmaTest : public ::testing::Test {
+protected:
+    static Ili9341Lcd& lcd() {
+        static Ili9341Lcd sLcd;
+        static bool sInit = false;
+        if (!sInit) { sLcd.initHAL(); sInit = true; }
+        return sLcd;
+    }
+
+    void SetUp() override {
+        lcd();
+        arcana_test_dma_count = 0;
+        arcana_test_dma_hold = 0;
+        memset(arcana_test_dma_log, 0, sizeof(arcana_test_dma_log));
+    }
+
+    const ArcanaTestDmaXfer& xfer(uint32_t i) { return arcana_test_dma_log[i]; }
+};
+
+} // anonymous
+
+TEST_F(Ili9341DmaTest, InitConfiguresMem2MemHalfword) {
+    uint32_t ccr = DMA2_Channel1->CCR;
+    EXPECT_TRUE(ccr & DMA_MEMORY_TO_MEMORY);
+    EXPECT_TRUE(ccr & DMA_PDATAALIGN_HALFWORD);
+    EXPECT_TRUE(ccr & DMA_MDATAALIGN_HALFWORD);
+    EXPECT_FALSE(ccr & DMA_CCR_MINC);   // FSMC data port never advances
+}
+
+TEST_F(Ili9341DmaTest, FullScreenFillSplitsAtCndtrLimit) {
+    lcd().fillScreen(Ili9341Lcd::BLUE);
+
+    ASSERT_EQ(arcana_test_dma_count, 2u);
+    EXPECT_EQ(xfer(0).length, 65535u);
+    EXPECT_EQ(xfer(1).length, 240u * 320u - 65535u);
+    for (uint32_t i = 0; i < 2; i++) {
+        EXPECT_EQ(xfer(i).srcInc, 0u);    // constant colour source
+        EXPECT_EQ(xfer(i).dstInc, 0u);
+        EXPECT_EQ(xfer(i).dst, (uint32_t)LCD_FSMC_DATA_ADDR);
+    }
+    EXPECT_EQ(xfer(0).src, xfer(1).src);
+}
+
+TEST_F(Ili9341DmaTest, SmallFillStaysOnCpu) {
+    lcd().fillRect(10, 10, 4, 4, Ili9341Lcd::RED);   // 16 px < DMA_MIN_PIXELS
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_EQ(arcana_test_lcd_data, 0xF800);   // RED
+}
+
+TEST_F(Ili9341DmaTest, FillRectClipsBeforeTransfer) {
+    lcd().fillRect(200, 300, 100, 100, Ili9341Lcd::GREEN);
+    ASSERT_EQ(arcana_test_dma_count, 1u);
+    EXPECT_EQ(xfer(0).length, 40u * 20u);
+}
+
+TEST_F(Ili9341DmaTest, ContiguousBlitIsOneIncrementingTransfer) {
+    static uint16_t pixels[32 * 16];
+    for (uint16_t i = 0; i < 32 * 16; i++) pixels[i] = i;
+
+    lcd().drawBitmap16(0, 0, 32, 16, pixels);
+
+    ASSERT_EQ(arcana_test_dma_count, 1u);
+    EXPECT_EQ(xfer(0).src, addr32(pixels));
+    EXPECT_EQ(xfer(0).length, 32u * 16u);
+    EXPECT_EQ(xfer(0).srcInc, 1u);
+    EXPECT_EQ(xfer(0).dst, (uint32_t)LCD_FSMC_DATA_ADDR);
+}
+
+TEST_F(Ili9341DmaTest, ClippedBlitPacksRowsIntoLineBuffers) {
+    static uint16_t pixels[64 * 8];
+    for (uint16_t i = 0; i < 64 * 8; i++) pixels[i] = i;
+    lcd().drawBitmap16(200, 0, 64, 8, pixels);   // 40 px visible per row
+
+    ASSERT_EQ(arcana_test_dma_count, 2u);       // 320 px = 240 + 80
+    EXPECT_EQ(xfer(0).length, 240u);
+    EXPECT_EQ(xfer(1).length, 80u);
+    EXPECT_EQ(xfer(0).srcInc, 1u);
+    EXPECT_NE(xfer(0).src, addr32(pixels));     // staged, not the source rows
+    EXPECT_NE(xfer(0).src, xfer(1).src);
+}
+
+TEST_F(Ili9341DmaTest, ClippedBlitUnderOneLineStaysOnCpu) {
+    static uint16_t pixels[64 * 4];
+    pixels[3 * 64 + 39] = 0xCAFE;
+    lcd().drawBitmap16(200, 0, 64, 4, pixels);   // 160 px
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_EQ(arcana_test_lcd_data, 0xCAFE);    // last visible pixel
+}
+
+TEST_F(Ili9341DmaTest, SmallBlitStaysOnCpu) {
+    const uint16_t pixels[4] = { 1, 2, 3, 0xBEEF };
+    lcd().drawBitmap16(0, 0, 2, 2, pixels);
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_EQ(arcana_test_lcd_data, 0xBEEF);
+}
+
+TEST_F(Ili9341DmaTest, BlitOffScreenIsNoop) {
+    uint16_t px = 0;
+    lcd().drawBitmap16(Ili9341Lcd::WIDTH, 0, 1, 1, &px);
+    lcd().drawBitmap16(0, 0, 0, 10, &px);
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+}
+
+TEST_F(Ili9341DmaTest, FillAfterBlitRestoresFixedSource) {
+    static uint16_t pixels[240];
+    lcd().drawBitmap16(0, 0, 240, 1, pixels);
+    lcd().fillRect(0, 0, 240, 1, Ili9341Lcd::WHITE);
+    ASSERT_EQ(arcana_test_dma_count, 2u);
+    EXPECT_EQ(xfer(0).srcInc, 1u);
+    EXPECT_EQ(xfer(1).srcInc, 0u);
+}
+
+TEST_F(Ili9341DmaTest, ScaledGlyphStreamsThroughLineBuffer) {
+    // 'A' at scale 3: 18 x 21 = 378 px → two line buffers (240 + 138)
+    lcd().drawChar(0, 0, 'A', Ili9341Lcd::WHITE, Ili9341Lcd::BLACK, 3);
+
+    ASSERT_EQ(arcana_test_dma_count, 2u);
+    EXPECT_EQ(xfer(0).length, 240u);
+    EXPECT_EQ(xfer(1).length, 138u);
+    EXPECT_EQ(xfer(0).srcInc, 1u);
+    EXPECT_NE(xfer(0).src, xfer(1).src);   // double-buffered
+}
+
+TEST_F(Ili9341DmaTest, ScaleOneGlyphStaysOnCpu) {
+    lcd().drawChar(0, 0, 'A', Ili9341Lcd::WHITE, Ili9341Lcd::BLACK, 1);  // 6x7 = 42 px
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_EQ(arcana_test_lcd_data, 0x0000);   // BLACK gap column
+}
+
+TEST_F(Ili9341DmaTest, XBitmapUsesLineBuffers) {
+    static uint8_t bits[(16 / 8) * 20];
+    memset(bits, 0xFF, sizeof(bits));
+    lcd().drawXBitmap(0, 0, 16, 20, bits, Ili9341Lcd::WHITE, Ili9341Lcd::BLACK);
+
+    ASSERT_EQ(arcana_test_dma_count, 2u);   // 320 px = 240 + 80
+    EXPECT_EQ(xfer(0).length, 240u);
+    EXPECT_EQ(xfer(1).length, 80u);
+}
+
+TEST_F(Ili9341DmaTest, DisplayRoutesBitmap16ToDriver) {
+    Ili9341Display display(lcd());
+    static uint16_t pixels[16 * 16];
+    display.drawBitmap16(0, 0, 16, 16, pixels);
+
+    ASSERT_EQ(arcana_test_dma_count, 1u);
+    EXPECT_EQ(xfer(0).src, addr32(pixels));
+    EXPECT_EQ(xfer(0).length, 256u);
+}
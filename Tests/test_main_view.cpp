@@ -9,6 +9,7 @@
  */
 #include <gtest/gtest.h>
 #include <cstring>
+#include <new>
 
 #include "stm32f1xx_hal.h"
 #include "IDisplay.hpp"
@@ -16,6 +17,7 @@
 #include "MainView.hpp"
 #include "MainViewModel.hpp"
 #include "SystemClock.hpp"
+#include "FramebufferDisplay.hpp"
 
 using arcana::display::IDisplay;
 using arcana::display::Color;
@@ -254,6 +256,15 @@ TEST(MainViewEcg, RenderEcgColumnAtTopAndBottomEdges) {
 namespace arcana { namespace lcd {
 struct MainViewTestAccess {
     static void processRender(MainView& v) { v.processRender(); }
+    static uint16_t ecgCursor(const MainView& v) { return v.mEcg.cursor(); }
+    static uint8_t ecgBatch(const MainView& v) { return v.mEcgBatch; }
+#if DISPLAY_FEATURE_COMPOSITOR
+    static uint8_t fieldsIn(const arcana::display::Rect& clip) { return MainView::fieldsIn(clip); }
+    static void paintDashboard(MainView& v, arcana::display::IDisplay& canvas,
+                               const arcana::display::Rect& clip) {
+        v.paintDashboard(canvas, clip);
+    }
+#endif
 };
 }}
 
@@ -320,6 +331,7 @@ TEST(MainViewProcess, ProcessRenderEcgDrainBranch) {
     MainViewModel vm;
     vm.init(nullptr);
 
+    v.input.ecgSampleHz = 250;
     v.init();
     v.input.lcd       = &d;
     v.input.viewModel = &vm;
@@ -336,6 +348,40 @@ TEST(MainViewProcess, ProcessRenderEcgDrainBranch) {
     EXPECT_GT(d.fillRectCalls, 0u);
 }
 
+namespace {
+/** Columns the sweep advances for `samples` queued samples at `hz` */
+uint16_t sweepColumns(uint16_t hz, int samples, uint8_t* batch = nullptr) {
+    static MainView v;             // sweep + render stack: keep off the test stack
+    StubDisplay d;
+    MainViewModel vm;
+    vm.init(nullptr);
+    new (&v) MainView();
+    v.input.ecgSampleHz = hz;
+    v.init();
+    v.input.lcd       = &d;
+    v.input.viewModel = &vm;
+
+    sQueuePops = samples;
+    g_xQueueReceiveOverride = fakeEcgQueueReceive;
+    MainViewTestAccess::processRender(v);
+    g_xQueueReceiveOverride = nullptr;
+    if (batch) *batch = MainViewTestAccess::ecgBatch(v);
+    return MainViewTestAccess::ecgCursor(v);
+}
+} // anonymous
+
+TEST(MainViewProcess, EcgSweepFollowsSourceRate) {
+    uint8_t batch = 0;
+    // 1 kHz record stream: two samples fold into each 500 Hz column
+    EXPECT_EQ(sweepColumns(1000, 32, &batch), 16u);
+    EXPECT_EQ(batch, 32u);
+    // 250 Hz: one sample stretches over two columns
+    EXPECT_EQ(sweepColumns(250, 8, &batch), 16u);
+    EXPECT_EQ(batch, 8u);
+    // No source wired: samples are consumed, nothing is swept
+    EXPECT_EQ(sweepColumns(0, 8), 0u);
+}
+
 // ── Toast expiry branch (lines 91-101: onEnter + full redraw) ──────────────
 
 TEST(MainViewProcess, ProcessRenderToastExpiryRedrawsView) {
@@ -365,3 +411,172 @@ TEST(MainViewProcess, ProcessRenderToastExpiryRedrawsView) {
 
     arcana::display::g_display = nullptr;
 }
+
+// ── Compositor path (DISPLAY_FEATURE_COMPOSITOR) ───────────────────────────
+
+namespace {
+
+using arcana::display::FramebufferDisplay;
+
+void resetToastState() {
+    arcana::display::toastRequest().pending = false;
+    arcana::display::toastRequest().dismiss = false;
+    arcana::display::toastState().active = false;
+}
+
+} // anonymous
+
+TEST(MainViewCompose, DirtyFieldIsComposedInTiles) {
+    resetToastState();
+    static MainView v;
+    static FramebufferDisplay fb;
+    static FramebufferDisplay direct;
+    MainViewModel vm;
+    vm.init(nullptr);
+    v.init();
+    v.input.lcd       = &fb;
+    v.input.viewModel = &vm;
+    v.onEnter(fb);
+    fb.resetCounters();
+
+    LcdInput in;
+    in.type = LcdInput::SensorData;
+    in.sensor.temperature = 21.5f;
+    vm.onEvent(in);
+    MainViewTestAccess::processRender(v);
+
+    /* Only the 180x14 temperature field crosses the bus, as bitmap tiles */
+    EXPECT_EQ(fb.windows, fb.bitmapWindows);
+    EXPECT_EQ(fb.pixelsWritten, 180u * 14u);
+
+    /* Pixels match drawing layout + value directly */
+    MainView ref;
+    ref.onEnter(direct);
+    LcdOutput out = vm.output();
+    out.temperature = 21.5f;
+    out.dirty = LcdOutput::DIRTY_TEMP;
+    LcdOutput rendered;
+    ref.render(direct, out, rendered);
+    for (uint16_t y = 0; y < 320; y++)
+        for (uint16_t x = 0; x < 240; x++)
+            ASSERT_EQ(fb.at(x, y), direct.at(x, y)) << x << "," << y;
+}
+
+TEST(MainViewCompose, ToastStaysOnTopOfLiveData) {
+    resetToastState();
+    static MainView v;
+    static FramebufferDisplay fb;
+    MainViewModel vm;
+    vm.init(nullptr);
+    v.init();
+    v.input.lcd       = &fb;
+    v.input.viewModel = &vm;
+    v.onEnter(fb);
+
+    arcana::display::requestToast("Mounting...", 60000);
+    MainViewTestAccess::processRender(v);
+    const auto& ts = arcana::display::toastState();
+    ASSERT_TRUE(ts.active);
+    EXPECT_EQ(fb.at(ts.x, ts.y), arcana::display::colors::WHITE);
+
+    /* MQTT status sits under the toast — it updates without drawing over it */
+    fb.resetCounters();
+    LcdInput in;
+    in.type = LcdInput::MqttStatus;
+    in.mqtt.connected = true;
+    vm.onEvent(in);
+    MainViewTestAccess::processRender(v);
+    EXPECT_EQ(fb.windows, fb.bitmapWindows);
+    EXPECT_EQ(fb.at(ts.x + 2, 156), ts.bg);
+
+    /* Dismiss repaints only the box, not the whole screen */
+    fb.resetCounters();
+    arcana::display::dismissToast();
+    MainViewTestAccess::processRender(v);
+    EXPECT_EQ(fb.pixelsWritten, (uint32_t)ts.w * ts.h);
+    EXPECT_EQ(fb.at(20, 156), arcana::display::colors::GREEN);
+    resetToastState();
+}
+
+TEST(MainViewCompose, TileFormatsOnlyTheFieldsItCrosses) {
+    using arcana::display::Rect;
+    EXPECT_EQ(MainViewTestAccess::fieldsIn(Rect{ 0, 42, 240, 4 }), 0x01);     // temperature
+    EXPECT_EQ(MainViewTestAccess::fieldsIn(Rect{ 0, 96, 240, 4 }), 0x10);     // SD status
+    EXPECT_EQ(MainViewTestAccess::fieldsIn(Rect{ 0, 304, 240, 4 }), 0x04);    // clock
+    EXPECT_EQ(MainViewTestAccess::fieldsIn(Rect{ 0, 60, 240, 4 }), 0x00);     // labels only
+    EXPECT_EQ(MainViewTestAccess::fieldsIn(Rect{ 0, 0, 240, 320 }), 0x37);    // every value field
+
+    /* A tile inside the ECG area has no dashboard content at all */
+    static MainView v;
+    new (&v) MainView();
+    v.init();
+    StubDisplay d;
+    MainViewTestAccess::paintDashboard(v, d, Rect{ 0, 200, 240, 4 });
+    EXPECT_EQ(d.fillRectCalls + d.drawStringCalls + d.drawHLineCalls, 0u);
+}
+
+namespace {
+uint8_t sEcgRow = 0;
+BaseType_t fakeFlatEcgReceive(QueueHandle_t /*q*/, void* buf, TickType_t /*t*/) {
+    if (sQueuePops <= 0) return 0;  // pdFALSE
+    --sQueuePops;
+    *static_cast<uint8_t*>(buf) = sEcgRow;
+    return 1;  // pdTRUE
+}
+
+void renderEcgSamples(MainView& v, int samples) {
+    sQueuePops = samples;
+    g_xQueueReceiveOverride = fakeFlatEcgReceive;
+    MainViewTestAccess::processRender(v);
+    g_xQueueReceiveOverride = nullptr;
+}
+} // anonymous
+
+TEST(MainViewCompose, EcgSweepLeavesToastIntact) {
+    using arcana::display::Rect;
+    using arcana::display::Color;
+    resetToastState();
+    static MainView v;
+    static FramebufferDisplay fb;
+    new (&v) MainView();
+    MainViewModel vm;
+    vm.init(nullptr);
+    v.input.ecgSampleHz = 500;          // one sample per column
+    v.init();
+    v.input.lcd       = &fb;
+    v.input.viewModel = &vm;
+    v.onEnter(fb);
+
+    arcana::display::requestToast("Mounting...", 60000);
+    MainViewTestAccess::processRender(v);
+    const auto& ts = arcana::display::toastState();
+    ASSERT_TRUE(ts.active);
+
+    /* The box reaches into the ECG area (top = 174); the sweep used to
+     * blank those rows with its erase-ahead */
+    Rect under = Rect{ ts.x, ts.y, ts.w, ts.h }.intersect(Rect{ 0, 174, 240, 100 });
+    ASSERT_FALSE(under.empty());
+    Color toastPx[40];
+    for (uint16_t x = 20; x < 60; x++) toastPx[x - 20] = fb.at(x, under.y);
+
+    /* Flat trace on the top trace row (sample 0 → area row 8) */
+    const uint16_t traceRow = 174 + 8;
+    sEcgRow = 0;
+    fb.resetCounters();
+    renderEcgSamples(v, 30);
+    renderEcgSamples(v, 30);
+    EXPECT_EQ(fb.windows, fb.bitmapWindows);
+    for (uint16_t x = 20; x < 60; x++)
+        ASSERT_EQ(fb.at(x, under.y), toastPx[x - 20]) << "x=" << x;
+    for (uint16_t x = 1; x < 60; x++)
+        ASSERT_EQ(fb.at(x, traceRow), arcana::display::colors::GREEN) << "x=" << x;
+    EXPECT_EQ(fb.at(62, traceRow), arcana::display::colors::BLACK); // gap ahead of the cursor
+
+    /* Dismiss hands the box back; the trace survives the repaint */
+    arcana::display::dismissToast();
+    MainViewTestAccess::processRender(v);
+    EXPECT_EQ(fb.at(30, under.y), arcana::display::colors::BLACK);
+    for (uint16_t x = 1; x < 60; x++)
+        ASSERT_EQ(fb.at(x, traceRow), arcana::display::colors::GREEN) << "x=" << x;
+    resetToastState();
+}
@@ -0,0 +1,82 @@
+/**
+ * @file test_mqtt_inflight.cpp
+ * @brief Host tests for MqttInflight (QoS 1 PUBLISH window).
+ */
+#include <gtest/gtest.h>
+
+#include "MqttInflight.hpp"
+
+using arcana::MqttInflight;
+using arcana::ats::AtsCursor;
+
+TEST(MqttInflight, WindowBoundsPush) {
+    MqttInflight w;
+    w.setWindow(2);
+    const AtsCursor c = { 0, 0 };
+    EXPECT_TRUE(w.push(1, MqttInflight::Response, c, 0));
+    EXPECT_TRUE(w.push(2, MqttInflight::Response, c, 0));
+    EXPECT_TRUE(w.full());
+    EXPECT_FALSE(w.push(3, MqttInflight::Response, c, 0));
+    EXPECT_EQ(w.count(), 2u);
+
+    w.setWindow(0);
+    EXPECT_EQ(w.window(), 1u);
+    w.setWindow(200);
+    EXPECT_EQ(w.window(), MqttInflight::MAX_WINDOW);
+}
+
+TEST(MqttInflight, PopsAcknowledgedPrefixInSendOrder) {
+    MqttInflight w;
+    w.setWindow(4);
+    for (uint16_t i = 0; i < 3; i++) {
+        const AtsCursor c = { 7, (uint16_t)(i * 32) };
+        ASSERT_TRUE(w.push(10 + i, MqttInflight::Backfill, c, 100 + i));
+    }
+
+    MqttInflight::Entry e;
+    ASSERT_TRUE(w.ack(11));
+    EXPECT_FALSE(w.pop(e));              // 10 still outstanding
+    EXPECT_EQ(w.oldestTick(), 100u);
+
+    ASSERT_TRUE(w.ack(10));
+    ASSERT_TRUE(w.pop(e));
+    EXPECT_EQ(e.packetId, 10u);
+    ASSERT_TRUE(w.pop(e));
+    EXPECT_EQ(e.packetId, 11u);
+    EXPECT_EQ(e.covered.record, 32u);
+    EXPECT_FALSE(w.pop(e));
+    EXPECT_EQ(w.count(), 1u);
+    EXPECT_EQ(w.oldestTick(), 102u);
+}
+
+TEST(MqttInflight, IgnoresUnknownAndRepeatedAcks) {
+    MqttInflight w;
+    w.setWindow(2);
+    const AtsCursor c = { 0, 0 };
+    w.push(5, MqttInflight::Live, c, 0);
+    EXPECT_FALSE(w.ack(6));
+    EXPECT_TRUE(w.ack(5));
+    EXPECT_FALSE(w.ack(5));
+}
+
+TEST(MqttInflight, WrapsAroundTheRing) {
+    MqttInflight w;
+    w.setWindow(MqttInflight::MAX_WINDOW);
+    const AtsCursor c = { 0, 0 };
+    MqttInflight::Entry e;
+    for (uint16_t id = 1; id <= 3 * MqttInflight::MAX_WINDOW; id++) {
+        ASSERT_TRUE(w.push(id, id & 1 ? MqttInflight::Live : MqttInflight::Response, c, id));
+        if (w.full()) {
+            ASSERT_TRUE(w.ack((uint16_t)(id - w.count() + 1)));
+            ASSERT_TRUE(w.pop(e));
+            EXPECT_EQ(e.packetId, (uint16_t)(id - MqttInflight::MAX_WINDOW + 1));
+        }
+    }
+    EXPECT_EQ(w.count(), MqttInflight::MAX_WINDOW - 1);
+    EXPECT_EQ(w.pending(MqttInflight::Live) + w.pending(MqttInflight::Response),
+              MqttInflight::MAX_WINDOW - 1);
+
+    w.clear();
+    EXPECT_EQ(w.count(), 0u);
+    EXPECT_EQ(w.pending(MqttInflight::Live), 0u);
+}
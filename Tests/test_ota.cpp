@@ -24,6 +24,7 @@
 #include "ff.h"
 #include "Crc32.hpp"
 #include "ota_header.h"
+#include "ota_delta.h"
 
 #include "OtaServiceImpl.hpp"
 #include "Esp8266.hpp"
@@ -43,9 +44,13 @@ struct OtaServiceTestAccess {
         return s.verifyCrc(crc, size);
     }
     static bool writeOtaMeta(OtaServiceImpl& s, uint32_t fwSize, uint32_t crc,
-                              const char* version) {
-        return s.writeOtaMeta(fwSize, crc, version);
+                              const char* version, uint8_t flags = 0) {
+        return s.writeOtaMeta(fwSize, crc, version, flags);
     }
+    static bool checkPatch(OtaServiceImpl& s, uint32_t& size, uint32_t& crc) {
+        return s.checkPatch(size, crc);
+    }
+    static void setImageBase(OtaServiceImpl& s, const uint8_t* base) { s.mImageBase = base; }
     static void setOtaFlag(OtaServiceImpl& s) { s.setOtaFlag(); }
     static volatile uint8_t& progress(OtaServiceImpl& s) { return s.mProgress; }
     static volatile bool&    active(OtaServiceImpl& s)    { return s.mActive; }
@@ -80,6 +85,36 @@ uint32_t createFakeFirmware(const char* name, uint32_t size, uint8_t fillByte =
     return ~crc32_calc(0xFFFFFFFF, bytes.data(), size);
 }
 
+/* "Running image" for delta tests; mImageBase points here instead of flash */
+uint8_t gImage[64];
+
+/* Patch rebuilding gImage + 16 erased bytes: COPY 64 @0, FILL 16 x 0xFF */
+std::vector<uint8_t> makePatch(const uint8_t* base, uint32_t baseSize) {
+    uint8_t dst[80];
+    memcpy(dst, gImage, 64);
+    memset(dst + 64, 0xFF, 16);
+
+    ota_delta_header_t h;
+    memset(&h, 0, sizeof(h));
+    h.magic = OTA_DELTA_MAGIC;
+    h.version = OTA_DELTA_VERSION;
+    h.src_size = baseSize;
+    h.src_crc32 = ~crc32_calc(0xFFFFFFFF, base, baseSize);
+    h.dst_size = sizeof(dst);
+    h.dst_crc32 = ~crc32_calc(0xFFFFFFFF, dst, sizeof(dst));
+    h.hdr_crc = ~crc32_calc(0xFFFFFFFF, (const uint8_t*)&h, OTA_DELTA_HDR_CRC_OFFSET);
+
+    std::vector<uint8_t> p((const uint8_t*)&h, (const uint8_t*)&h + sizeof(h));
+    const uint8_t ops[] = { 0x80, 0x02, 0x00, 0x42, 0xFF };
+    p.insert(p.end(), ops, ops + sizeof(ops));
+    return p;
+}
+
+void useImage() {
+    for (uint32_t i = 0; i < sizeof(gImage); i++) gImage[i] = (uint8_t)(i * 7 + 3);
+    OtaServiceTestAccess::setImageBase(ota(), gImage);
+}
+
 } // anonymous namespace
 
 // ── Lifecycle ──────────────────────────────────────────────────────────────
@@ -163,6 +198,19 @@ TEST(OtaMeta, WriteOtaMetaTruncatesLongVersion) {
     EXPECT_EQ(meta.fw_version[15], '\0');
 }
 
+TEST(OtaMeta, WriteOtaMetaStoresDeltaFlag) {
+    resetEnvironment();
+    EXPECT_TRUE(OtaServiceTestAccess::writeOtaMeta(
+        ota(), 80, 0x12345678, "delta", OTA_META_FLAG_DELTA));
+    uint8_t buf[64] = {};
+    UINT len = 0;
+    ASSERT_EQ(test_ff_read("ota_meta.bin", buf, sizeof(buf), &len), FR_OK);
+    ota_meta_t meta;
+    std::memcpy(&meta, buf, sizeof(meta));
+    EXPECT_EQ(meta.flags, OTA_META_FLAG_DELTA);
+    EXPECT_EQ(meta.meta_crc, ~crc32_calc(0xFFFFFFFF, buf, OTA_META_CRC_OFFSET));
+}
+
 // ── setOtaFlag ─────────────────────────────────────────────────────────────
 
 TEST(OtaFlag, SetOtaFlagWritesBkpDr2Dr3) {
@@ -180,15 +228,13 @@ TEST(OtaFlag, SetOtaFlagWritesBkpDr2Dr3) {
 TEST(OtaHttp, HttpGetCipStartFailureReturnsFalse) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("OK");      // CIPCLOSE (existing)
-    esp.pushResponse("ERROR");   // CIPSTART → fail
+    esp.pushResponse("ERROR");   // CIPSTART=1 → fail
     EXPECT_FALSE(OtaServiceTestAccess::httpGet(ota(), "host", 443, "/fw.bin"));
 }
 
 TEST(OtaHttp, HttpGetCipSendFailureReturnsFalse) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("OK");      // CIPCLOSE
     esp.pushResponse("OK");      // CIPSTART
     esp.pushResponse("ERROR");   // CIPSEND → no >
     EXPECT_FALSE(OtaServiceTestAccess::httpGet(ota(), "host", 443, "/fw.bin"));
@@ -197,7 +243,6 @@ TEST(OtaHttp, HttpGetCipSendFailureReturnsFalse) {
 TEST(OtaHttp, HttpGetSendOkFailureReturnsFalse) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("OK");      // CIPCLOSE
     esp.pushResponse("OK");      // CIPSTART
     esp.pushResponse(">");       // CIPSEND
     esp.pushResponse("");        // sendData
@@ -208,7 +253,6 @@ TEST(OtaHttp, HttpGetSendOkFailureReturnsFalse) {
 TEST(OtaHttp, HttpGetHappyPath) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("OK");      // CIPCLOSE
     esp.pushResponse("OK");      // CIPSTART
     esp.pushResponse(">");       // CIPSEND
     esp.pushResponse("");        // sendData
@@ -216,6 +260,19 @@ TEST(OtaHttp, HttpGetHappyPath) {
     EXPECT_TRUE(OtaServiceTestAccess::httpGet(ota(), "host", 443, "/fw.bin"));
 }
 
+TEST(OtaHttp, HttpGetRefusedWhileUploadHoldsLink) {
+    /* Upload (MQTT task) owns link 1 → OTA fails fast, no AT traffic */
+    resetEnvironment();
+    auto& esp = Esp8266::getInstance();
+    esp.setHoldLinks(true);
+    esp.pushResponse("OK");
+    ASSERT_TRUE(esp.linkOpen(Esp8266::LINK_HTTP, "SSL", "upload", 443));
+    size_t sent = esp.sentCmds().size();
+    EXPECT_FALSE(OtaServiceTestAccess::httpGet(ota(), "host", 443, "/fw.bin"));
+    EXPECT_EQ(esp.sentCmds().size(), sent);
+    esp.linkClose(Esp8266::LINK_HTTP);
+}
+
 // ── startUpdate orchestrator ───────────────────────────────────────────────
 
 TEST(OtaStartUpdate, NoEspReturnsFalse) {
@@ -233,7 +290,6 @@ TEST(OtaStartUpdate, AlreadyActiveReturnsFalse) {
 TEST(OtaStartUpdate, HttpGetFailureBailsEarly) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("OK");      // CIPCLOSE
     esp.pushResponse("ERROR");   // CIPSTART → bail
 
     EXPECT_FALSE(ota().startUpdate("host", 443, "/fw.bin", 1000, 0));
@@ -241,12 +297,14 @@ TEST(OtaStartUpdate, HttpGetFailureBailsEarly) {
 }
 
 // ── receiveToFile ──────────────────────────────────────────────────────────
+//
+// The response arrives on link 1 (LINK_HTTP): Esp8266::ipd(1, ...) frames
+// it the way the ESP does, "1,CLOSED" is the server's Connection: close.
 
 TEST(OtaReceive, ReceiveToFileNoIpdReturnsFalse) {
-    /* receiveToFile waits for "+IPD," 4 times then bails. */
+    /* Nothing ever arrives on link 1 → header wait times out */
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    /* Three rounds of "no +IPD" → noDataCount > 3 → bail */
     for (int i = 0; i < 5; ++i) esp.pushResponse("");
     EXPECT_FALSE(OtaServiceTestAccess::receiveToFile(ota(), 1000));
 }
@@ -254,108 +312,114 @@ TEST(OtaReceive, ReceiveToFileNoIpdReturnsFalse) {
 TEST(OtaReceive, ReceiveToFileServerClosedEarly) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    /* CLOSED in response → break out of loop with bytesWritten=0 → return false */
-    esp.pushResponse("CLOSED");
+    /* Link closed before any header → fail with nothing written */
+    esp.pushResponse("1,CLOSED\r\n");
     EXPECT_FALSE(OtaServiceTestAccess::receiveToFile(ota(), 1000));
 }
 
 TEST(OtaReceive, ReceiveToFileWith200OkAndBody) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    /* First +IPD with HTTP 200 OK headers + body */
-    std::string ipd = "+IPD,50:HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nDATA";
-    esp.pushResponse(ipd);
-    /* Subsequent waitFor returns no +IPD → noDataCount loops then bails */
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    /* Headers + whole body in one +IPD */
+    esp.pushIpd(1, "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nDATA");
     /* expected size = 4 (just "DATA") so first write completes */
     EXPECT_TRUE(OtaServiceTestAccess::receiveToFile(ota(), 4));
     EXPECT_EQ(OtaServiceTestAccess::progress(ota()), 100);
+
+    uint8_t buf[8] = {};
+    UINT len = 0;
+    ASSERT_EQ(test_ff_read("firmware.bin", buf, sizeof(buf), &len), FR_OK);
+    EXPECT_EQ(len, 4u);
+    EXPECT_EQ(std::memcmp(buf, "DATA", 4), 0);
 }
 
 TEST(OtaReceive, ReceiveToFileNonHttpResponseFails) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    std::string bad = "+IPD,12:GARBAGE\r\n\r\n";
-    esp.pushResponse(bad);
+    esp.pushIpd(1, "GARBAGE\r\n\r\n");
     EXPECT_FALSE(OtaServiceTestAccess::receiveToFile(ota(), 100));
 }
 
 TEST(OtaReceive, ReceiveToFileHttp404Fails) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    std::string ipd = "+IPD,30:HTTP/1.1 404 Not Found\r\n\r\n";
-    esp.pushResponse(ipd);
+    esp.pushIpd(1, "HTTP/1.1 404 Not Found\r\n\r\n");
     EXPECT_FALSE(OtaServiceTestAccess::receiveToFile(ota(), 100));
 }
 
 // ── receiveToFile: more uncov branches ──────────────────────────────────────
 
 TEST(OtaReceive, ReceiveToFileSubsequentChunksAreBodyOnly) {
-    /* First +IPD has headers + 4-byte body, second +IPD has the rest (raw
-     * body bytes only). Exercises the lines 252-256 branch. */
+    /* Header split over two segments, the rest of the body in a third:
+     * later segments are raw body bytes with no HTTP framing. */
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("+IPD,50:HTTP/1.1 200 OK\r\nContent-Length: 8\r\n\r\nDATA");
-    esp.pushResponse("+IPD,4:MORE");
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    esp.pushIpd(1, "HTTP/1.1 200 OK\r\nContent-Le");
+    esp.pushIpd(1, "ngth: 8\r\n\r\nDATA");
+    esp.pushIpd(1, "MORE");
     EXPECT_TRUE(OtaServiceTestAccess::receiveToFile(ota(), 8));
+
+    uint8_t buf[16] = {};
+    UINT len = 0;
+    ASSERT_EQ(test_ff_read("firmware.bin", buf, sizeof(buf), &len), FR_OK);
+    EXPECT_EQ(len, 8u);
+    EXPECT_EQ(std::memcmp(buf, "DATAMORE", 8), 0);
 }
 
-TEST(OtaReceive, ReceiveToFileWaitForFoundButBufHasNoIpdPrefix) {
-    /* waitFor("+IPD,") matches because the response contains the literal,
-     * but our parser looks for "+IPD," at any offset and falls through to
-     * "no ipd → clearRx → continue" if it can't lock onto a full prefix.
-     * Actually the parser scans the whole buf, so we need to send a buf
-     * where waitFor sees "+IPD," but the parser's memcmp loop ends without
-     * finding it (e.g. truncated). Easier: stage a "garbage with +IPD"
-     * that can't be parsed because no ':' after the digits → lines 199-201. */
+TEST(OtaReceive, ReceiveToFileShortBodyThenCloseFails) {
+    /* Server closes after half the body → bytesWritten < expected */
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    /* "+IPD,123" — has a number but no ':' terminator → bail to clearRx */
-    esp.pushResponse("+IPD,123");
-    /* Then drain noDataCount with empty responses */
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    esp.pushIpd(1, "HTTP/1.1 200 OK\r\n\r\nDATA");
+    esp.pushResponse("1,CLOSED\r\n");
     EXPECT_FALSE(OtaServiceTestAccess::receiveToFile(ota(), 100));
 }
 
-TEST(OtaReceive, ReceiveToFileIpdLenZeroBails) {
-    /* "+IPD,0:" — len=0 → also takes the clearRx/continue branch */
+TEST(OtaReceive, ReceiveToFileOtherLinkDataIsIgnored) {
+    /* MQTT traffic (link 0) during the download never reaches the file */
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("+IPD,0:");
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
-    EXPECT_FALSE(OtaServiceTestAccess::receiveToFile(ota(), 100));
+    esp.pushResponse(Esp8266::ipd(0, "mqtt") +
+                     Esp8266::ipd(1, "HTTP/1.1 200 OK\r\n\r\nAB"));
+    esp.pushResponse(Esp8266::ipd(1, "CD") + Esp8266::ipd(0, "more"));
+    EXPECT_TRUE(OtaServiceTestAccess::receiveToFile(ota(), 4));
+
+    uint8_t buf[8] = {};
+    UINT len = 0;
+    ASSERT_EQ(test_ff_read("firmware.bin", buf, sizeof(buf), &len), FR_OK);
+    EXPECT_EQ(len, 4u);
+    EXPECT_EQ(std::memcmp(buf, "ABCD", 4), 0);
+    EXPECT_EQ(esp.linkAvailable(Esp8266::LINK_MQTT), 8u);
 }
 
 TEST(OtaReceive, ReceiveToFileHeaderTooLargeBails) {
-    /* HTTP response with no \r\n\r\n in the first +IPD chunk → bodyStart is
-     * never found → OTA_HDR_TOO_LARGE return false (lines 223-225). */
+    /* Headers never terminate within the 320-byte buffer → OTA_HDR_TOO_LARGE */
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("+IPD,30:HTTP/1.1 200 OK no terminat");
+    esp.pushIpd(1, "HTTP/1.1 200 OK\r\nX-Pad: " + std::string(400, 'x'));
     EXPECT_FALSE(OtaServiceTestAccess::receiveToFile(ota(), 100));
 }
 
 // ── startUpdate: cover the post-httpGet failure + success branches ──────────
 
 TEST(OtaStartUpdate, ReceiveFailureRollsBackEsp) {
-    /* httpGet succeeds, receiveToFile fails (no +IPD ever) → cleanup branch
-     * (lines 60-65: AT+CIPCLOSE, setIpdPassthrough false, mActive false). */
+    /* httpGet succeeds, receiveToFile fails (nothing on link 1) → cleanup
+     * branch: AT+CIPCLOSE=1, mActive false. */
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
     /* httpGet sequence */
-    esp.pushResponse("OK");        // CIPCLOSE
     esp.pushResponse("OK");        // CIPSTART
     esp.pushResponse(">");         // CIPSEND
     esp.pushResponse("");          // sendData
     esp.pushResponse("SEND OK");
-    /* receive: 4 empty waitFors → noDataCount > 3 → bail */
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    /* receive: header wait times out */
+    esp.pushResponse("");
     /* Cleanup CIPCLOSE */
     esp.pushResponse("OK");
 
     EXPECT_FALSE(ota().startUpdate("h", 443, "/f", 1000, 0));
     EXPECT_FALSE(ota().isActive());
+    EXPECT_EQ(esp.sentCmds().back(), "AT+CIPCLOSE=1");
 }
 
 TEST(OtaStartUpdate, VerifyFailureLeavesActiveFalse) {
@@ -365,12 +429,11 @@ TEST(OtaStartUpdate, VerifyFailureLeavesActiveFalse) {
     auto& esp = Esp8266::getInstance();
     /* httpGet */
     esp.pushResponse("OK");
-    esp.pushResponse("OK");
     esp.pushResponse(">");
     esp.pushResponse("");
     esp.pushResponse("SEND OK");
     /* receive: one +IPD with 4 body bytes */
-    esp.pushResponse("+IPD,50:HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nDATA");
+    esp.pushIpd(1, "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nDATA");
 
     EXPECT_FALSE(ota().startUpdate("h", 443, "/f", 4, /*wrong crc*/ 0xDEADBEEF));
     EXPECT_FALSE(ota().isActive());
@@ -385,7 +448,6 @@ TEST(OtaStartUpdate, FullSuccessHitsResetPath) {
     auto& esp = Esp8266::getInstance();
     /* httpGet */
     esp.pushResponse("OK");
-    esp.pushResponse("OK");
     esp.pushResponse(">");
     esp.pushResponse("");
     esp.pushResponse("SEND OK");
@@ -394,9 +456,102 @@ TEST(OtaStartUpdate, FullSuccessHitsResetPath) {
     const char* body = "ABCD";
     uint32_t crc = ~crc32_calc(0xFFFFFFFF,
                                reinterpret_cast<const uint8_t*>(body), 4);
-    esp.pushResponse("+IPD,50:HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nABCD");
+    esp.pushIpd(1, "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nABCD");
 
     /* The handler calls vTaskDelay(100) before NVIC_SystemReset; both are
      * no-ops on host. The function returns true after the (no-op) reset. */
     EXPECT_TRUE(ota().startUpdate("h", 443, "/f", 4, crc));
 }
+
+// ── Delta OTA ──────────────────────────────────────────────────────────────
+
+TEST(OtaDelta, CheckPatchAcceptsMatchingBase) {
+    resetEnvironment();
+    useImage();
+    std::vector<uint8_t> p = makePatch(gImage, sizeof(gImage));
+    test_ff_create(OTA_PATCH_FILENAME, p.data(), (UINT)p.size());
+
+    uint32_t size = 0, crc = 0;
+    EXPECT_TRUE(OtaServiceTestAccess::checkPatch(ota(), size, crc));
+    EXPECT_EQ(size, 80u);
+    EXPECT_NE(crc, 0u);
+}
+
+TEST(OtaDelta, CheckPatchRejectsOtherBase) {
+    resetEnvironment();
+    useImage();
+    uint8_t other[64];
+    memset(other, 0x11, sizeof(other));
+    std::vector<uint8_t> p = makePatch(other, sizeof(other));
+    test_ff_create(OTA_PATCH_FILENAME, p.data(), (UINT)p.size());
+
+    uint32_t size = 0, crc = 0;
+    EXPECT_FALSE(OtaServiceTestAccess::checkPatch(ota(), size, crc));
+}
+
+TEST(OtaDelta, CheckPatchRejectsBadHeaderAndMissingFile) {
+    resetEnvironment();
+    useImage();
+    uint32_t size = 0, crc = 0;
+    EXPECT_FALSE(OtaServiceTestAccess::checkPatch(ota(), size, crc));
+
+    std::vector<uint8_t> p = makePatch(gImage, sizeof(gImage));
+    p[0] ^= 0xFF;                                    // magic
+    test_ff_create(OTA_PATCH_FILENAME, p.data(), (UINT)p.size());
+    EXPECT_FALSE(OtaServiceTestAccess::checkPatch(ota(), size, crc));
+
+    test_ff_create(OTA_PATCH_FILENAME, p.data(), 10);  // truncated header
+    EXPECT_FALSE(OtaServiceTestAccess::checkPatch(ota(), size, crc));
+}
+
+/* HTTP response carrying the patch as one +IPD frame on link 1 */
+void pushPatchDownload(const std::vector<uint8_t>& patch) {
+    auto& esp = Esp8266::getInstance();
+    esp.pushResponse("OK");        // CIPSTART
+    esp.pushResponse(">");         // CIPSEND
+    esp.pushResponse("");          // sendData
+    esp.pushResponse("SEND OK");
+
+    std::string http = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                       std::to_string(patch.size()) + "\r\n\r\n";
+    http.append(reinterpret_cast<const char*>(patch.data()), patch.size());
+    esp.pushIpd(1, http);
+}
+
+TEST(OtaDelta, StartDeltaUpdateWritesMetaForRebuiltImage) {
+    resetEnvironment();
+    useImage();
+    std::vector<uint8_t> p = makePatch(gImage, sizeof(gImage));
+    pushPatchDownload(p);
+
+    uint32_t patchCrc = ~crc32_calc(0xFFFFFFFF, p.data(), p.size());
+    EXPECT_TRUE(ota().startDeltaUpdate("h", 80, "/p", (uint32_t)p.size(), patchCrc));
+    EXPECT_TRUE(test_ff_exists(OTA_PATCH_FILENAME));
+
+    uint8_t buf[64] = {};
+    UINT len = 0;
+    ASSERT_EQ(test_ff_read("ota_meta.bin", buf, sizeof(buf), &len), FR_OK);
+    ota_meta_t meta;
+    std::memcpy(&meta, buf, sizeof(meta));
+    EXPECT_EQ(meta.flags, OTA_META_FLAG_DELTA);
+    EXPECT_EQ(meta.fw_size, 80u);
+
+    ota_delta_header_t h;
+    std::memcpy(&h, p.data(), sizeof(h));
+    EXPECT_EQ(meta.crc32, h.dst_crc32);
+}
+
+TEST(OtaDelta, StartDeltaUpdateDropsPatchForOtherBuild) {
+    resetEnvironment();
+    useImage();
+    uint8_t other[64];
+    memset(other, 0x11, sizeof(other));
+    std::vector<uint8_t> p = makePatch(other, sizeof(other));
+    pushPatchDownload(p);
+
+    uint32_t patchCrc = ~crc32_calc(0xFFFFFFFF, p.data(), p.size());
+    EXPECT_FALSE(ota().startDeltaUpdate("h", 80, "/p", (uint32_t)p.size(), patchCrc));
+    EXPECT_FALSE(ota().isActive());
+    EXPECT_FALSE(test_ff_exists(OTA_PATCH_FILENAME));
+    EXPECT_FALSE(test_ff_exists("ota_meta.bin"));
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test_ota_delta.cpp
+ * @brief ota_delta.h: patch header checks and the streaming applier the
+ *        bootloader runs — COPY/LITERAL/FILL ops, bounded staging buffer,
+ *        base/target CRC and malformed-stream rejection.
+ *
+ * Patches are hand-encoded here with the same rules as tools/ota_delta.py.
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "ota_delta.h"
+
+namespace {
+
+typedef std::vector<uint8_t> Bytes;
+
+uint32_t crc(const Bytes& b) {
+    return ~crc32_calc(0xFFFFFFFFu, b.data(), b.size());
+}
+
+void varint(Bytes& out, uint32_t v) {
+    while (v >= 0x80) { out.push_back((uint8_t)(v | 0x80)); v >>= 7; }
+    out.push_back((uint8_t)v);
+}
+
+struct Ops {
+    Bytes b;
+    Ops& copy(uint32_t len, int32_t delta) {
+        varint(b, len << 2 | OTA_DELTA_OP_COPY);
+        varint(b, delta >= 0 ? (uint32_t)delta << 1 : ((uint32_t)(-delta - 1) << 1) | 1);
+        return *this;
+    }
+    Ops& literal(const Bytes& data) {
+        varint(b, (uint32_t)data.size() << 2 | OTA_DELTA_OP_LITERAL);
+        b.insert(b.end(), data.begin(), data.end());
+        return *this;
+    }
+    Ops& fill(uint32_t len, uint8_t v) {
+        varint(b, len << 2 | OTA_DELTA_OP_FILL);
+        b.push_back(v);
+        return *this;
+    }
+};
+
+ota_delta_header_t header(const Bytes& src, const Bytes& dst) {
+    ota_delta_header_t h;
+    memset(&h, 0, sizeof(h));
+    h.magic = OTA_DELTA_MAGIC;
+    h.version = OTA_DELTA_VERSION;
+    h.src_size = (uint32_t)src.size();
+    h.src_crc32 = crc(src);
+    h.dst_size = (uint32_t)dst.size();
+    h.dst_crc32 = crc(dst);
+    h.hdr_crc = ~crc32_calc(0xFFFFFFFFu, (const uint8_t*)&h, OTA_DELTA_HDR_CRC_OFFSET);
+    return h;
+}
+
+/** Patch stream served in small, uneven reads like FatFs near a sector edge */
+struct Harness {
+    Bytes patch;
+    size_t pos = 0;
+    Bytes out;
+    int writes = 0;
+    int failWriteAt = -1;
+    uint8_t staging[16];
+
+    static int read(void* ctx, uint8_t* buf, uint32_t len) {
+        Harness* h = static_cast<Harness*>(ctx);
+        uint32_t n = len < 7 ? len : 7;
+        if (n > h->patch.size() - h->pos) n = (uint32_t)(h->patch.size() - h->pos);
+        memcpy(buf, h->patch.data() + h->pos, n);
+        h->pos += n;
+        return (int)n;
+    }
+    static int write(void* ctx, const uint8_t* buf, uint32_t len) {
+        Harness* h = static_cast<Harness*>(ctx);
+        if (h->writes++ == h->failWriteAt) return -1;
+        h->out.insert(h->out.end(), buf, buf + len);
+        return 0;
+    }
+
+    int apply(const Bytes& src, const ota_delta_header_t& hdr) {
+        ota_delta_io_t io;
+        io.read = read;
+        io.write = write;
+        io.ctx = this;
+        io.src = src.data();
+        io.buf = staging;
+        io.buf_size = sizeof(staging);
+        return ota_delta_apply(&io, &hdr);
+    }
+};
+
+Bytes pattern(size_t n, uint8_t seed) {
+    Bytes b(n);
+    for (size_t i = 0; i < n; i++) b[i] = (uint8_t)(i * 31 + seed + (i >> 7));
+    return b;
+}
+
+} // namespace
+
+TEST(OtaDelta, HeaderIs28Bytes) {
+    EXPECT_EQ(sizeof(ota_delta_header_t), 28u);
+    EXPECT_EQ(OTA_DELTA_MAGIC, 0x50445241u);
+    EXPECT_STREQ(OTA_PATCH_FILENAME, "fw_patch.bin");
+}
+
+TEST(OtaDelta, HeaderChecks) {
+    Bytes src = pattern(64, 1);
+    ota_delta_header_t h = header(src, src);
+    EXPECT_EQ(ota_delta_check_header(&h), OTA_DELTA_OK);
+
+    ota_delta_header_t bad = h;
+    bad.magic ^= 1;
+    EXPECT_EQ(ota_delta_check_header(&bad), OTA_DELTA_ERR_HEADER);
+
+    bad = h;
+    bad.dst_size = 65;           // self-CRC no longer matches
+    EXPECT_EQ(ota_delta_check_header(&bad), OTA_DELTA_ERR_HEADER);
+
+    bad = h;
+    bad.dst_size = APP_FLASH_SIZE + 1;
+    bad.hdr_crc = ~crc32_calc(0xFFFFFFFFu, (const uint8_t*)&bad, OTA_DELTA_HDR_CRC_OFFSET);
+    EXPECT_EQ(ota_delta_check_header(&bad), OTA_DELTA_ERR_HEADER);
+}
+
+TEST(OtaDelta, RebuildsShiftedAndEditedImage) {
+    // New image: 40 inserted bytes, an edited word, a trimmed tail, erased padding
+    Bytes src = pattern(3000, 7);
+    Bytes dst(src.begin(), src.begin() + 1000);
+    Bytes ins = pattern(40, 99);
+    dst.insert(dst.end(), ins.begin(), ins.end());
+    dst.insert(dst.end(), src.begin() + 1000, src.begin() + 2500);
+    dst[1500] ^= 0x5A;
+    dst.insert(dst.end(), 300, 0xFF);
+
+    Ops ops;
+    ops.copy(1000, 0)                                  // src 0..999
+       .literal(ins)
+       .copy(460, 0)                                   // src 1000..1459
+       .literal(Bytes(1, dst[1500]))
+       .copy(1039, 1)                                  // skip edited byte
+       .fill(300, 0xFF);
+
+    Harness h;
+    h.patch = ops.b;
+    ASSERT_EQ(h.apply(src, header(src, dst)), OTA_DELTA_OK);
+    EXPECT_EQ(h.out, dst);
+    EXPECT_EQ(h.pos, h.patch.size());
+    EXPECT_LT(h.patch.size(), 80u);
+}
+
+TEST(OtaDelta, BackwardCopiesReuseEarlierSource) {
+    Bytes src = pattern(512, 3);
+    Bytes dst(src.begin() + 256, src.end());           // moved down
+    dst.insert(dst.end(), src.begin(), src.begin() + 256);
+
+    Ops ops;
+    ops.copy(256, 256).copy(256, -512);
+    Harness h;
+    h.patch = ops.b;
+    ASSERT_EQ(h.apply(src, header(src, dst)), OTA_DELTA_OK);
+    EXPECT_EQ(h.out, dst);
+}
+
+TEST(OtaDelta, WrongBaseIsRejectedBeforeWriting) {
+    Bytes src = pattern(256, 1);
+    Bytes other = pattern(256, 2);
+    Ops ops;
+    ops.copy(256, 0);
+    Harness h;
+    h.patch = ops.b;
+    EXPECT_EQ(h.apply(other, header(src, src)), OTA_DELTA_ERR_SOURCE);
+    EXPECT_EQ(h.writes, 0);
+}
+
+TEST(OtaDelta, MalformedStreamsAreRejected) {
+    Bytes src = pattern(256, 1);
+    Bytes dst = pattern(100, 5);
+
+    struct Case { Bytes ops; const char* what; };
+    Case cases[] = {
+        { Ops().copy(100, 200).b,            "copy past the base" },
+        { Ops().copy(50, 0).copy(50, -51).b, "copy before the base" },
+        { Ops().fill(101, 0).b,              "op longer than the target" },
+        { Ops().literal(Bytes(60, 1)).b,     "truncated stream" },
+        { Bytes{ 3 << 0 | (10 << 2) },       "unknown op" },
+        { Bytes{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 }, "overlong varint" },
+    };
+    for (auto& c : cases) {
+        Harness h;
+        h.patch = c.ops;
+        EXPECT_EQ(h.apply(src, header(src, dst)), OTA_DELTA_ERR_CORRUPT) << c.what;
+    }
+}
+
+TEST(OtaDelta, TargetCrcAndWriteFailures) {
+    Bytes src = pattern(256, 1);
+    Bytes dst = pattern(64, 9);
+
+    // Ops rebuild something else of the right length
+    Harness h1;
+    h1.patch = Ops().copy(64, 0).b;
+    EXPECT_EQ(h1.apply(src, header(src, dst)), OTA_DELTA_ERR_TARGET);
+
+    // SD write error mid-literal
+    Harness h2;
+    h2.patch = Ops().literal(dst).b;
+    h2.failWriteAt = 2;
+    EXPECT_EQ(h2.apply(src, header(src, dst)), OTA_DELTA_ERR_IO);
+    EXPECT_EQ(h2.out.size(), 32u);     // two 16-byte staging flushes
+}
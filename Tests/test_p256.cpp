@@ -0,0 +1,281 @@
+/**
+ * @file test_p256.cpp
+ * @brief Host tests for arcana::crypto::P256 (comb keygen, ECDH, ECDSA verify)
+ *
+ * The comb is checked against uECC_compute_public_key for random and edge
+ * scalars (each tooth alone, all teeth set), and against G / -G for 1 and
+ * n-1, which uECC's own ladder rejects. The benchmark prints ops/s and
+ * peak stack for keygen and ECDH next to plain uECC and mbedTLS ECP; stack
+ * is measured on a painted pthread stack, minus an empty run.
+ * Numbers are from the -O0 coverage build, so only the ratios mean much.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <pthread.h>
+
+#include "P256.hpp"
+#include "uECC.h"
+#include "mbedtls/ecp.h"
+
+using arcana::crypto::P256;
+
+namespace {
+
+uint32_t sRngState = 0x2545F491;
+
+int testRng(uint8_t* dest, unsigned size) {
+    for (unsigned i = 0; i < size; i++) {
+        sRngState ^= sRngState << 13;
+        sRngState ^= sRngState >> 17;
+        sRngState ^= sRngState << 5;
+        dest[i] = static_cast<uint8_t>(sRngState);
+    }
+    return 1;
+}
+
+int mbedRng(void*, unsigned char* out, size_t len) {
+    return testRng(out, static_cast<unsigned>(len)) ? 0 : -1;
+}
+
+// Big-endian 256-bit constants
+const uint8_t kOrderN[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xBC, 0xE6, 0xFA, 0xAD, 0xA7, 0x17, 0x9E, 0x84, 0xF3, 0xB9, 0xCA, 0xC2, 0xFC, 0x63, 0x25, 0x51,
+};
+const uint8_t kGx[32] = {
+    0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+    0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0, 0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
+};
+const uint8_t kGy[32] = {
+    0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B, 0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
+    0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE, 0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5,
+};
+const uint8_t kNegGy[32] = {   // p - Gy
+    0xB0, 0x1C, 0xBD, 0x1C, 0x01, 0xE5, 0x80, 0x65, 0x71, 0x18, 0x14, 0xB5, 0x83, 0xF0, 0x61, 0xE9,
+    0xD4, 0x31, 0xCC, 0xA9, 0x94, 0xCE, 0xA1, 0x31, 0x34, 0x49, 0xBF, 0x97, 0xC8, 0x40, 0xAE, 0x0A,
+};
+
+void expectCombMatchesUecc(const uint8_t priv[32]) {
+    uint8_t mine[64], ref[64];
+    ASSERT_TRUE(P256::computePublicKey(priv, mine));
+    ASSERT_EQ(1, uECC_compute_public_key(priv, ref, uECC_secp256r1()));
+    EXPECT_EQ(0, std::memcmp(mine, ref, 64));
+}
+
+/** Peak stack of fn in bytes, from a painted pthread stack */
+class StackProbe {
+public:
+    static size_t peak(const std::function<void()>& fn) {
+        return raw(fn) - raw([] {});
+    }
+
+private:
+    static constexpr size_t SIZE = 256 * 1024;
+
+    static void* entry(void* arg) {
+        (*static_cast<const std::function<void()>*>(arg))();
+        return nullptr;
+    }
+
+    static size_t raw(const std::function<void()>& fn) {
+        uint8_t* stack = static_cast<uint8_t*>(std::aligned_alloc(4096, SIZE));
+        std::memset(stack, 0xA5, SIZE);
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstack(&attr, stack, SIZE);
+        pthread_t th;
+        pthread_create(&th, &attr, entry, const_cast<std::function<void()>*>(&fn));
+        pthread_join(th, nullptr);
+        pthread_attr_destroy(&attr);
+        size_t untouched = 0;
+        while (untouched < SIZE && stack[untouched] == 0xA5) untouched++;
+        std::free(stack);
+        return SIZE - untouched;
+    }
+};
+
+template <typename F>
+double opsPerSecond(int n, F fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) fn();
+    return n / std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+class P256Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sRngState = 0x2545F491;
+        P256::setRng(testRng);
+    }
+};
+
+} // namespace
+
+// ── Fixed-base comb ───────────────────────────────────────────────────────────
+
+TEST_F(P256Test, CombMatchesUeccForRandomKeys) {
+    for (int i = 0; i < 32; i++) {
+        uint8_t pub[64], priv[32];
+        ASSERT_EQ(1, uECC_make_key(pub, priv, uECC_secp256r1()));
+        expectCombMatchesUecc(priv);
+    }
+}
+
+TEST_F(P256Test, CombMatchesUeccForEdgeScalars) {
+    uint8_t k[32] = {};
+
+    k[31] = 1;                                   // G itself
+    uint8_t pub[64];
+    ASSERT_TRUE(P256::computePublicKey(k, pub));
+    EXPECT_EQ(0, std::memcmp(pub, kGx, 32));
+    EXPECT_EQ(0, std::memcmp(pub + 32, kGy, 32));
+
+    std::memcpy(k, kOrderN, 32);                 // n - 1 = -G
+    k[31] -= 1;
+    ASSERT_TRUE(P256::computePublicKey(k, pub));
+    EXPECT_EQ(0, std::memcmp(pub, kGx, 32));
+    EXPECT_EQ(0, std::memcmp(pub + 32, kNegGy, 32));
+
+    for (int tooth = 1; tooth < 5; tooth++) {    // 2^(52j): one tooth, one column
+        std::memset(k, 0, 32);
+        int bit = 52 * tooth;
+        k[31 - bit / 8] = static_cast<uint8_t>(1u << (bit % 8));
+        expectCombMatchesUecc(k);
+    }
+
+    std::memset(k, 0, 32);                       // top column: all five teeth (index 31)
+    for (int tooth = 0; tooth < 5; tooth++) {
+        int bit = 52 * tooth + 51;
+        if (bit < 256) k[31 - bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+    }
+    expectCombMatchesUecc(k);
+
+    std::memset(k, 0x55, 32);                    // same index in consecutive columns
+    expectCombMatchesUecc(k);
+}
+
+TEST_F(P256Test, RejectsScalarsOutOfRange) {
+    uint8_t k[32] = {};
+    uint8_t pub[64];
+    EXPECT_FALSE(P256::computePublicKey(k, pub));
+    EXPECT_FALSE(P256::computePublicKey(kOrderN, pub));
+    std::memset(k, 0xFF, 32);
+    EXPECT_FALSE(P256::computePublicKey(k, pub));
+}
+
+TEST_F(P256Test, WorksWithoutRngForFixedScalars) {
+    uint8_t k[32];
+    std::memset(k, 0x3C, 32);
+    uint8_t ref[64];
+    ASSERT_TRUE(P256::computePublicKey(k, ref));
+
+    P256::setRng(nullptr);
+    uint8_t pub[64];
+    ASSERT_TRUE(P256::computePublicKey(k, pub));   // Z blinding is skipped
+    EXPECT_EQ(0, std::memcmp(pub, ref, 64));
+    uint8_t priv[32];
+    EXPECT_FALSE(P256::makeKey(pub, priv));
+}
+
+// ── ECDH + verify ─────────────────────────────────────────────────────────────
+
+TEST_F(P256Test, MakeKeyPairsAgreeOnSharedSecret) {
+    uint8_t pubA[64], privA[32], pubB[64], privB[32];
+    ASSERT_TRUE(P256::makeKey(pubA, privA));
+    ASSERT_TRUE(P256::makeKey(pubB, privB));
+    EXPECT_EQ(1, uECC_valid_public_key(pubA, uECC_secp256r1()));
+    EXPECT_NE(0, std::memcmp(privA, privB, 32));
+
+    uint8_t sAB[32], sBA[32], ref[32];
+    ASSERT_TRUE(P256::sharedSecret(pubB, privA, sAB));
+    ASSERT_TRUE(P256::sharedSecret(pubA, privB, sBA));
+    ASSERT_EQ(1, uECC_shared_secret(pubB, privA, ref, uECC_secp256r1()));
+    EXPECT_EQ(0, std::memcmp(sAB, sBA, 32));
+    EXPECT_EQ(0, std::memcmp(sAB, ref, 32));
+}
+
+TEST_F(P256Test, SharedSecretRejectsPointsOffTheCurve) {
+    uint8_t pub[64], priv[32], secret[32];
+    ASSERT_TRUE(P256::makeKey(pub, priv));
+    pub[63] ^= 0x01;
+    EXPECT_FALSE(P256::sharedSecret(pub, priv, secret));
+    std::memset(pub, 0, 64);
+    EXPECT_FALSE(P256::sharedSecret(pub, priv, secret));
+}
+
+TEST_F(P256Test, VerifiesUeccSignatures) {
+    uint8_t pub[64], priv[32];
+    ASSERT_TRUE(P256::makeKey(pub, priv));
+    uint8_t hash[32];
+    for (int i = 0; i < 32; i++) hash[i] = static_cast<uint8_t>(i * 11);
+    uint8_t sig[64];
+    ASSERT_EQ(1, uECC_sign(priv, hash, sizeof(hash), sig, uECC_secp256r1()));
+
+    EXPECT_TRUE(P256::verify(pub, hash, sizeof(hash), sig));
+    hash[0] ^= 0x80;
+    EXPECT_FALSE(P256::verify(pub, hash, sizeof(hash), sig));
+    hash[0] ^= 0x80;
+    sig[40] ^= 0x01;
+    EXPECT_FALSE(P256::verify(pub, hash, sizeof(hash), sig));
+}
+
+// ── Benchmark: P256 vs uECC vs mbedTLS ECP ───────────────────────────────────
+
+TEST_F(P256Test, BenchmarkAgainstUeccAndMbedtls) {
+    constexpr int kOps = 20;
+    const uECC_Curve curve = uECC_secp256r1();
+    uint8_t pubA[64], privA[32], pubB[64], privB[32], out[64];
+    ASSERT_TRUE(P256::makeKey(pubA, privA));
+    ASSERT_TRUE(P256::makeKey(pubB, privB));
+
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point peer, r;
+    mbedtls_mpi d;
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&peer);
+    mbedtls_ecp_point_init(&r);
+    mbedtls_mpi_init(&d);
+    ASSERT_EQ(0, mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1));
+    ASSERT_EQ(0, mbedtls_mpi_read_binary(&d, privA, 32));
+    uint8_t peerBuf[65] = {0x04};
+    std::memcpy(peerBuf + 1, pubB, 64);
+    ASSERT_EQ(0, mbedtls_ecp_point_read_binary(&grp, &peer, peerBuf, sizeof(peerBuf)));
+
+    // Same answers before timing anything
+    uint8_t ref[32];
+    ASSERT_EQ(0, mbedtls_ecp_mul(&grp, &r, &d, &peer, mbedRng, nullptr));
+    ASSERT_EQ(0, mbedtls_mpi_write_binary(&r.MBEDTLS_PRIVATE(X), ref, 32));
+    ASSERT_TRUE(P256::sharedSecret(pubB, privA, out));
+    EXPECT_EQ(0, std::memcmp(out, ref, 32));
+
+    struct Row {
+        const char* name;
+        std::function<void()> fn;
+    };
+    const Row rows[] = {
+        {"keygen  P256 comb      ", [&] { P256::computePublicKey(privA, out); }},
+        {"keygen  uECC           ", [&] { uECC_compute_public_key(privA, out, curve); }},
+        {"keygen  mbedTLS ECP    ", [&] { mbedtls_ecp_mul(&grp, &r, &d, &grp.G, mbedRng, nullptr); }},
+        {"ECDH    P256 (checked) ", [&] { P256::sharedSecret(pubB, privA, out); }},
+        {"ECDH    uECC           ", [&] { uECC_shared_secret(pubB, privA, out, curve); }},
+        {"ECDH    mbedTLS ECP    ", [&] { mbedtls_ecp_mul(&grp, &r, &d, &peer, mbedRng, nullptr); }},
+    };
+
+    double ops[6];
+    for (int i = 0; i < 6; i++) {
+        ops[i] = opsPerSecond(kOps, rows[i].fn);
+        size_t stack = StackProbe::peak(rows[i].fn);
+        std::printf("[ p256 ] %s %8.1f ops/s  %6zu B stack\n", rows[i].name, ops[i], stack);
+    }
+    EXPECT_GT(ops[0], 0.0);
+
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&r);
+    mbedtls_ecp_point_free(&peer);
+    mbedtls_ecp_group_free(&grp);
+}
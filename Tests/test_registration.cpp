@@ -140,6 +140,12 @@ uint16_t computeCrc16(const uint8_t* data, size_t len) {
     return crc;
 }
 
+/** Server reply on link 1, then the server hangs up (Connection: close) */
+void pushReply(Esp8266& esp, const std::string& bytes) {
+    esp.pushIpd(Esp8266::LINK_HTTP, bytes);
+    esp.pushResponse("1,CLOSED\r\n");
+}
+
 } // anonymous namespace
 
 // ───────────────────────────────────────────────────────────────────────────
@@ -397,22 +403,15 @@ TEST(RegistrationHttp, RegisterSuccessThroughEsp8266) {
     /* Programmed AT-command responses for httpRegister's sequence:
      *   AT+CIPSTART → "OK"
      *   AT+CIPSEND  → ">"
-     *   sendData header → "" (sendData ignores response)
-     *   sendData body   → ""
+     *   sendv header + body → "" (sendv ignores response)
      *   waitFor "SEND OK" → "SEND OK"
-     *   waitFor "+IPD"   → big response with our framed protobuf
+     *   link 1 data  → big response with our framed protobuf, then CLOSED
      *   AT+CIPCLOSE → "OK" */
     esp.pushResponse("OK");                     // CIPSTART
     esp.pushResponse(">");                      // CIPSEND
-    esp.pushResponse("");                       // sendData header
-    esp.pushResponse("");                       // sendData body
+    esp.pushResponse("");                       // sendv header + body
     esp.pushResponse("SEND OK");                // waitFor SEND OK
-    esp.pushResponseBytes(resp.data(), resp.size());  // waitFor +IPD #1
-    /* The five-iteration +IPD drain loop expects up to 5 responses; supply empty so it bails. */
-    esp.pushResponse("");
-    esp.pushResponse("");
-    esp.pushResponse("");
-    esp.pushResponse("");
+    pushReply(esp, std::string(resp.begin(), resp.end()));
     esp.pushResponse("OK");                     // AT+CIPCLOSE
 
     /* doRegistration calls httpRegister; force re-register so it doesn't
@@ -423,9 +422,8 @@ TEST(RegistrationHttp, RegisterSuccessThroughEsp8266) {
     arcana::atsstorage::test_storage_set_load_ok(false);
 
     bool ok = reg.doRegistration();
-    /* httpRegister returns true if it parsed a valid response. We don't
-     * strictly require true here — coverage of the path is the goal. */
-    (void)ok;
+    /* The link 1 reply carries a valid frame → httpRegister parses it */
+    EXPECT_TRUE(ok);
     EXPECT_GT(esp.sentCmds().size(), 1u);
 }
 
@@ -563,12 +561,9 @@ TEST(RegistrationHttp, RegisterWithServerPubDerivesCommKey) {
     auto& esp = Esp8266::getInstance();
     esp.pushResponse("OK");                              // CIPSTART
     esp.pushResponse(">");                               // CIPSEND
-    esp.pushResponse("");                                // header sendData
-    esp.pushResponse("");                                // body sendData
+    esp.pushResponse("");                                // sendv header + body
     esp.pushResponse("SEND OK");                         // waitFor SEND OK
-    esp.pushResponseBytes(resp.data(), resp.size());     // waitFor +IPD #1
-    /* Empty for the rest of the +IPD drain loop */
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    pushReply(esp, std::string(resp.begin(), resp.end()));
     esp.pushResponse("OK");                              // CIPCLOSE
 
     arcana::atsstorage::test_storage_set_load_ok(false);
@@ -639,10 +634,8 @@ TEST(RegistrationHttp, RegisterEncryptedResponseRetry) {
     esp.pushResponse("OK");
     esp.pushResponse(">");
     esp.pushResponse("");
-    esp.pushResponse("");
     esp.pushResponse("SEND OK");
-    esp.pushResponseBytes(resp.data(), resp.size());
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    pushReply(esp, std::string(resp.begin(), resp.end()));
     esp.pushResponse("OK");
 
     arcana::atsstorage::test_storage_set_load_ok(false);
@@ -666,11 +659,9 @@ TEST(RegistrationHttp, RegisterResponseWithNoFrameMagicLogsNoFrame) {
 
     esp.pushResponse("OK");                              // CIPSTART
     esp.pushResponse(">");                               // CIPSEND
-    esp.pushResponse("");                                // sendData header
-    esp.pushResponse("");                                // sendData body
+    esp.pushResponse("");                                // sendv header + body
     esp.pushResponse("SEND OK");                         // waitFor SEND OK
-    esp.pushResponse("HTTP/1.1 500 Internal Server Error\r\n\r\nbad");
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    pushReply(esp, "HTTP/1.1 500 Internal Server Error\r\n\r\nbad");
     esp.pushResponse("OK");                              // CIPCLOSE
 
     arcana::atsstorage::test_storage_set_load_ok(false);
@@ -712,10 +703,8 @@ TEST(RegistrationHttp, RegisterResponseSuccessFalseRejected) {
     esp.pushResponse("OK");
     esp.pushResponse(">");
     esp.pushResponse("");
-    esp.pushResponse("");
     esp.pushResponse("SEND OK");
-    esp.pushResponseBytes(resp.data(), resp.size());
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    pushReply(esp, std::string(resp.begin(), resp.end()));
     esp.pushResponse("OK");
 
     arcana::atsstorage::test_storage_set_load_ok(false);
@@ -763,10 +752,8 @@ TEST(RegistrationHttp, RegisterResponseWithEcdsaSigCopied) {
     esp.pushResponse("OK");
     esp.pushResponse(">");
     esp.pushResponse("");
-    esp.pushResponse("");
     esp.pushResponse("SEND OK");
-    esp.pushResponseBytes(resp.data(), resp.size());
-    for (int i = 0; i < 5; ++i) esp.pushResponse("");
+    pushReply(esp, std::string(resp.begin(), resp.end()));
     esp.pushResponse("OK");
 
     arcana::atsstorage::test_storage_set_load_ok(false);
@@ -784,8 +771,7 @@ TEST(RegistrationHttp, RegisterSendOkFailureBails) {
 
     esp.pushResponse("OK");                     // CIPSTART
     esp.pushResponse(">");                      // CIPSEND
-    esp.pushResponse("");                       // sendData header
-    esp.pushResponse("");                       // sendData body
+    esp.pushResponse("");                       // sendv header + body
     esp.pushResponse("");                       // waitFor "SEND OK" → empty (fail)
     esp.pushResponse("OK");                     // CIPCLOSE
 
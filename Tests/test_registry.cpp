@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "CommandRegistry.hpp"
 #include "ICommand.hpp"
+#include "CommandTable.hpp"
 
 using namespace arcana;
 
@@ -22,6 +23,10 @@ public:
 };
 
 // ── CommandRegistry ───────────────────────────────────────────────────────────
+// Built twice: test_registry with ARCANA_CMD_RUNTIME_REGISTRY=1 and
+// test_registry_table with the F051 default (table only, no runtime list).
+
+#if ARCANA_CMD_RUNTIME_REGISTRY
 
 TEST(CommandRegistryTest, EmptyRegistryFindsNothing) {
     CommandRegistry reg;
@@ -110,3 +115,87 @@ TEST(CommandRegistryTest, ExecuteCommandViaFound) {
     uint32_t val = rsp.data[0] | (rsp.data[1] << 8) | (rsp.data[2] << 16) | (rsp.data[3] << 24);
     EXPECT_EQ(val, 42u);
 }
+
+#else
+
+static_assert(sizeof(CommandRegistry) == sizeof(CommandTableView),
+              "table-only registry holds nothing but the table view");
+
+TEST(CommandRegistryTest, EmptyRegistryFindsNothing) {
+    CommandRegistry reg;
+    EXPECT_EQ(reg.findCommand({Cluster::System, SystemCommand::Ping}), nullptr);
+    EXPECT_EQ(reg.getCommandCount(), 0);
+}
+
+#endif
+
+// ── Compile-time CommandTable ────────────────────────────────────────────────
+
+namespace {
+
+struct TablePingCmd : public ICommand {
+    static constexpr CommandKey kKey = {Cluster::System, SystemCommand::Ping};
+    CommandKey getKey() const override { return kKey; }
+    void execute(const CommandRequest&, CommandResponseModel& rsp) override {
+        rsp.setUint32(1);
+    }
+};
+
+struct TableOtaCmd : public ICommand {
+    static constexpr CommandKey kKey = {Cluster::Device, DeviceCommand::StartOta};
+    CommandKey getKey() const override { return kKey; }
+    void execute(const CommandRequest&, CommandResponseModel& rsp) override {
+        rsp.setUint32(2);
+    }
+};
+
+TablePingCmd sTablePing;
+TableOtaCmd  sTableOta;
+
+constexpr CommandEntry kTableEntries[] = {
+    commandEntry(sTablePing),
+    commandEntry(sTableOta),
+};
+constexpr auto kTable = makeCommandTable<kTableEntries>();
+
+// Dense dimensions: clusters 0..Device(2), ids 0..StartOta(0x10)
+static_assert(sizeof(kTable) >= 3 * 0x11 * sizeof(ICommand*), "dense matrix size");
+static_assert(kTable.size() == 2, "entry count");
+
+} // namespace
+
+TEST(CommandTableTest, FindsEntriesByKey) {
+    EXPECT_EQ(kTable.find(TablePingCmd::kKey), &sTablePing);
+    EXPECT_EQ(kTable.find(TableOtaCmd::kKey), &sTableOta);
+}
+
+TEST(CommandTableTest, OutOfRangeKeysReturnNull) {
+    EXPECT_EQ(kTable.find({Cluster::Security, SecurityCommand::KeyExchange}), nullptr);
+    EXPECT_EQ(kTable.find({Cluster::System, 0xFF}), nullptr);
+    EXPECT_EQ(kTable.find({Cluster::Sensor, SensorCommand::GetCounter}), nullptr);
+}
+
+TEST(CommandTableTest, DefaultViewIsEmpty) {
+    CommandTableView view;
+    EXPECT_EQ(view.size(), 0);
+    EXPECT_EQ(view.find({Cluster::System, SystemCommand::Ping}), nullptr);
+}
+
+TEST(CommandRegistryTest, TableBackedRegistryFindsBuiltins) {
+    CommandRegistry reg(kTable.view());
+    EXPECT_EQ(reg.getCommandCount(), 2);
+    EXPECT_EQ(reg.findCommand(TableOtaCmd::kKey), &sTableOta);
+}
+
+#if ARCANA_CMD_RUNTIME_REGISTRY
+TEST(CommandRegistryTest, RuntimeDuplicateOfBuiltinRejected) {
+    CommandRegistry reg(kTable.view());
+    PingCmd ping;  // same key as the table's TablePingCmd
+    EXPECT_FALSE(reg.registerCommand(&ping));
+
+    GetCounterCmd getCounter;
+    ASSERT_TRUE(reg.registerCommand(&getCounter));
+    EXPECT_EQ(reg.getCommandCount(), 3);
+    EXPECT_EQ(reg.findCommand({Cluster::Sensor, SensorCommand::GetCounter}), &getCounter);
+}
+#endif
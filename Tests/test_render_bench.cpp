@@ -0,0 +1,361 @@
+/**
+ * @file test_render_bench.cpp
+ * @brief Render cost profiler + LcdInput replay benchmark for MainView.
+ *
+ * Recorded event streams (Tests/replay/*.lcdlog) are replayed through the
+ * real MainViewModel + MainView into FramebufferDisplay; every
+ * processRender() is one frame and its window setups, pixels, overdraw and
+ * FSMC bus writes are reported. Budgets below are regression guards —
+ * re-measure and tighten them when a rendering change makes frames cheaper.
+ *
+ * Environment knobs (all optional):
+ *   ARCANA_REPLAY=<file>      replay another recording
+ *   ARCANA_BENCH_CSV=<file>   per-frame stats as CSV (compare runs with diff)
+ *   ARCANA_SNAPSHOT=<file>    final frame as .png or .ppm
+ *   ARCANA_BENCH_VERBOSE=1    print the per-frame table
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "stm32f1xx_hal.h"
+#include "DisplayStatus.hpp"
+#include "FramebufferDisplay.hpp"
+#include "MainView.hpp"
+#include "MainViewModel.hpp"
+
+using arcana::display::FramebufferDisplay;
+using arcana::lcd::LcdInput;
+using arcana::lcd::MainView;
+using arcana::lcd::MainViewModel;
+
+namespace arcana { namespace lcd {
+struct MainViewTestAccess {
+    static void processRender(MainView& v) { v.processRender(); }
+};
+}}
+using arcana::lcd::MainViewTestAccess;
+
+/* freertos_stubs override hooks */
+typedef long BaseType_t;
+typedef void* QueueHandle_t;
+typedef uint32_t TickType_t;
+typedef BaseType_t (*XQueueReceiveFn)(QueueHandle_t, void*, TickType_t);
+typedef TickType_t (*XTaskGetTickCountFn)(void);
+extern XQueueReceiveFn g_xQueueReceiveOverride;
+extern XTaskGetTickCountFn g_xTaskGetTickCountOverride;
+
+namespace {
+
+// ── Replay plumbing ─────────────────────────────────────────────────────────
+
+TickType_t sTick = 0;
+std::deque<uint8_t> sEcg;
+
+TickType_t replayTick() { return sTick; }
+
+BaseType_t replayEcgReceive(QueueHandle_t, void* buf, TickType_t) {
+    if (sEcg.empty()) return 0;
+    *static_cast<uint8_t*>(buf) = sEcg.front();
+    sEcg.pop_front();
+    return 1;
+}
+
+struct Frame {
+    uint32_t tick;
+    uint32_t events;
+    FramebufferDisplay::FrameStats stats;
+};
+
+struct ReplayResult {
+    std::vector<Frame> frames;
+    uint32_t badLines = 0;
+};
+
+/** Apply one recorded line; false if it is not a known event */
+bool applyEvent(const std::string& event, std::istringstream& args, MainViewModel& vm) {
+    LcdInput in;
+    if (event == "sensor") {
+        in.type = LcdInput::SensorData;
+        args >> in.sensor.temperature;
+    } else if (event == "storage") {
+        in.type = LcdInput::StorageStats;
+        args >> in.storage.records >> in.storage.rate >> in.storage.totalKB >> in.storage.kbps;
+    } else if (event == "tick") {
+        int synced = 0;
+        in.type = LcdInput::TimerTick;
+        args >> in.timer.epoch >> synced >> in.timer.uptime;
+        in.timer.synced = synced != 0;
+    } else if (event == "sdinfo") {
+        in.type = LcdInput::SdInfo;
+        args >> in.sdinfo.freeMB >> in.sdinfo.totalMB;
+    } else if (event == "mqtt") {
+        int connected = 0;
+        in.type = LcdInput::MqttStatus;
+        args >> connected;
+        in.mqtt.connected = connected != 0;
+    } else if (event == "ecg") {
+        unsigned y;
+        while (args >> y) sEcg.push_back((uint8_t)y);
+        return true;
+    } else if (event == "toast") {
+        uint32_t ms = 0;
+        std::string text;
+        args >> ms;
+        std::getline(args >> std::ws, text);
+        arcana::display::requestToast(text.c_str(), ms);
+        return true;
+    } else if (event == "dismiss") {
+        arcana::display::dismissToast();
+        return true;
+    } else {
+        return false;
+    }
+    if (args.fail()) return false;
+    vm.onEvent(in);
+    return true;
+}
+
+/**
+ * Replay a recording: frame 0 is onEnter(), then one processRender() per
+ * distinct tick after applying that tick's events.
+ */
+ReplayResult replay(std::istream& src, FramebufferDisplay& fb) {
+    std::unique_ptr<MainView> view(new MainView());   // render stack + tiles: keep off the test stack
+    MainView& v = *view;
+    MainViewModel vm;
+    vm.init(nullptr);
+    v.input.ecgSampleHz = 250;     // the bundled recordings carry the 250 Hz feed
+    v.init();
+    v.input.lcd = &fb;
+    v.input.viewModel = &vm;
+
+    arcana::display::toastRequest().pending = false;
+    arcana::display::toastRequest().dismiss = false;
+    arcana::display::toastState().active = false;
+    sEcg.clear();
+    sTick = 0;
+    g_xTaskGetTickCountOverride = replayTick;
+    g_xQueueReceiveOverride = replayEcgReceive;
+
+    ReplayResult result;
+    fb.resetCounters();
+    v.onEnter(fb);
+    result.frames.push_back(Frame{ 0, 0, fb.frameStats() });
+
+    std::string line;
+    bool pending = false;
+    Frame frame = {};
+    auto render = [&]() {
+        sTick = frame.tick;
+        fb.beginFrame();
+        MainViewTestAccess::processRender(v);
+        frame.stats = fb.frameStats();
+        result.frames.push_back(frame);
+    };
+
+    while (std::getline(src, line)) {
+        std::istringstream ls(line);
+        uint32_t tick;
+        std::string event;
+        if (line.empty() || line[0] == '#') continue;
+        if (!(ls >> tick >> event)) { result.badLines++; continue; }
+        if (pending && tick != frame.tick) {
+            render();
+            frame = Frame{};
+        }
+        frame.tick = tick;
+        pending = true;
+        if (applyEvent(event, ls, vm)) frame.events++;
+        else result.badLines++;
+    }
+    if (pending) render();
+
+    g_xTaskGetTickCountOverride = nullptr;
+    g_xQueueReceiveOverride = nullptr;
+    return result;
+}
+
+std::string defaultRecording() {
+    const char* env = getenv("ARCANA_REPLAY");
+    return env ? env : ARCANA_REPLAY_DIR "/dashboard_10s.lcdlog";
+}
+
+void report(const ReplayResult& r, const char* name) {
+    uint64_t windows = 0, pixels = 0, overdraw = 0, bus = 0;
+    uint32_t worst = 0, worstTick = 0;
+    bool verbose = getenv("ARCANA_BENCH_VERBOSE") != nullptr;
+    if (verbose) printf("%8s %6s %8s %8s %8s %9s\n",
+                        "tick", "events", "windows", "pixels", "overdraw", "busWrites");
+    // Frame 0 is the static layout — report steady state separately
+    for (size_t i = 1; i < r.frames.size(); i++) {
+        const Frame& f = r.frames[i];
+        windows += f.stats.windows;
+        pixels += f.stats.pixels;
+        overdraw += f.stats.overdraw;
+        bus += f.stats.busWrites;
+        if (f.stats.busWrites > worst) { worst = f.stats.busWrites; worstTick = f.tick; }
+        if (verbose) printf("%8u %6u %8u %8u %8u %9u\n", f.tick, f.events, f.stats.windows,
+                            f.stats.pixels, f.stats.overdraw, f.stats.busWrites);
+    }
+    size_t n = r.frames.size() > 1 ? r.frames.size() - 1 : 1;
+    printf("[bench] %s: %zu frames, layout %u bus writes; per frame avg %llu windows, "
+           "%llu px, %llu overdraw, %llu bus writes; worst %u @ %u ms\n",
+           name, r.frames.size() - 1, r.frames[0].stats.busWrites,
+           (unsigned long long)(windows / n), (unsigned long long)(pixels / n),
+           (unsigned long long)(overdraw / n), (unsigned long long)(bus / n),
+           worst, worstTick);
+    ::testing::Test::RecordProperty("frames", (int)(r.frames.size() - 1));
+    ::testing::Test::RecordProperty("avgBusWrites", (int)(bus / n));
+    ::testing::Test::RecordProperty("worstBusWrites", (int)worst);
+
+    if (const char* csv = getenv("ARCANA_BENCH_CSV")) {
+        if (FILE* f = fopen(csv, "w")) {
+            fprintf(f, "tick,events,windows,pixels,overdraw,busWrites\n");
+            for (const Frame& fr : r.frames) {
+                fprintf(f, "%u,%u,%u,%u,%u,%u\n", fr.tick, fr.events, fr.stats.windows,
+                        fr.stats.pixels, fr.stats.overdraw, fr.stats.busWrites);
+            }
+            fclose(f);
+        }
+    }
+}
+
+uint32_t frameAt(const ReplayResult& r, uint32_t tick, uint32_t FramebufferDisplay::FrameStats::*field) {
+    for (const Frame& f : r.frames) if (f.tick == tick && &f != &r.frames[0]) return f.stats.*field;
+    return 0xFFFFFFFF;
+}
+
+std::unique_ptr<FramebufferDisplay> makeFb() {
+    return std::unique_ptr<FramebufferDisplay>(new FramebufferDisplay());
+}
+
+} // anonymous
+
+// ── Profiler ───────────────────────────────────────────────────────────────
+
+TEST(FrameProfilerTest, CountsWindowsPixelsAndBusWrites) {
+    auto fb = makeFb();
+    fb->beginFrame();
+    fb->fillRect(0, 0, 10, 10, 0xFFFF);
+    fb->drawString(0, 20, "ab", 0xFFFF, 0, 1);          // 2 glyph windows
+    FramebufferDisplay::FrameStats s = fb->frameStats();
+    EXPECT_EQ(s.windows, 3u);
+    EXPECT_EQ(s.pixels, 100u + 2u * 42u);
+    EXPECT_EQ(s.busWrites, 3u * FramebufferDisplay::WINDOW_BUS_WRITES + s.pixels);
+    EXPECT_EQ(s.overdraw, 0u);
+}
+
+TEST(FrameProfilerTest, OverdrawIsPerFrame) {
+    auto fb = makeFb();
+    fb->beginFrame();
+    fb->fillRect(0, 0, 10, 10, 1);
+    fb->fillRect(5, 0, 10, 10, 2);                      // 50 px again
+    EXPECT_EQ(fb->frameStats().overdraw, 50u);
+
+    fb->beginFrame();
+    fb->fillRect(0, 0, 10, 10, 3);                      // new frame: fresh
+    EXPECT_EQ(fb->frameStats().overdraw, 0u);
+    EXPECT_EQ(fb->frameStats().windows, 1u);
+}
+
+TEST(FrameProfilerTest, SnapshotsHaveValidHeaders) {
+    auto fb = makeFb();
+    fb->fillRect(0, 0, 1, 1, 0xF800);
+    std::string base = ::testing::TempDir() + "arcana_fb";
+
+    ASSERT_TRUE(fb->writePpm((base + ".ppm").c_str()));
+    std::ifstream ppm(base + ".ppm", std::ios::binary);
+    std::string magic, w, h, max;
+    ppm >> magic >> w >> h >> max;
+    EXPECT_EQ(magic, "P6");
+    EXPECT_EQ(w, "240");
+    EXPECT_EQ(h, "320");
+    ppm.get();
+    char px[3];
+    ppm.read(px, 3);
+    EXPECT_EQ((uint8_t)px[0], 0xFF);                    // red, expanded 5→8 bits
+    EXPECT_EQ((uint8_t)px[1], 0x00);
+
+    ASSERT_TRUE(fb->writePng((base + ".png").c_str()));
+    std::ifstream png(base + ".png", std::ios::binary | std::ios::ate);
+    size_t size = (size_t)png.tellg();
+    png.seekg(0);
+    char sig[16];
+    png.read(sig, sizeof(sig));
+    EXPECT_EQ(memcmp(sig, "\x89PNG\r\n\x1a\n", 8), 0);
+    EXPECT_EQ(memcmp(sig + 12, "IHDR", 4), 0);
+    // Stored deflate: raw rows + 5 bytes per 64K block + fixed overhead
+    EXPECT_GT(size, 320u * (1 + 240 * 3));
+}
+
+// ── Replay ─────────────────────────────────────────────────────────────────
+
+TEST(RenderBenchTest, ParsesRecordingAndRejectsUnknownEvents) {
+    auto fb = makeFb();
+    std::istringstream src(
+        "# comment\n"
+        "0 sensor 21.5\n"
+        "0 bogus 1 2\n"
+        "100 mqtt 1\n"
+        "garbage\n");
+    ReplayResult r = replay(src, *fb);
+    ASSERT_EQ(r.frames.size(), 3u);                     // layout + 2 ticks
+    EXPECT_EQ(r.frames[1].events, 1u);
+    EXPECT_EQ(r.badLines, 2u);
+}
+
+TEST(RenderBenchTest, ClockTickCostsOneTimeField) {
+    auto fb = makeFb();
+    std::istringstream src("0 tick 0 0 1\n1000 tick 0 0 2\n");
+    ReplayResult r = replay(src, *fb);
+    ASSERT_EQ(r.frames.size(), 3u);
+    // Second tick: only the 96x14 time field, no overdraw
+    EXPECT_EQ(r.frames[2].stats.pixels, 96u * 14u);
+    EXPECT_EQ(r.frames[2].stats.overdraw, 0u);
+    EXPECT_LE(r.frames[2].stats.windows, 2u);
+}
+
+TEST(RenderBenchTest, DashboardRecording) {
+    std::ifstream src(defaultRecording());
+    ASSERT_TRUE(src.good()) << "cannot open " << defaultRecording();
+    auto fb = makeFb();
+    ReplayResult r = replay(src, *fb);
+    report(r, defaultRecording().c_str());
+
+    EXPECT_EQ(r.badLines, 0u);
+    ASSERT_GT(r.frames.size(), 1u);
+
+    if (const char* snap = getenv("ARCANA_SNAPSHOT")) {
+        size_t len = strlen(snap);
+        bool png = len > 4 && strcmp(snap + len - 4, ".png") == 0;
+        EXPECT_TRUE(png ? fb->writePng(snap) : fb->writePpm(snap));
+    }
+
+    if (getenv("ARCANA_REPLAY")) return;                // budgets are for the bundled stream
+
+    // Regression budgets for dashboard_10s.lcdlog
+    uint32_t worst = 0;
+    uint64_t bus = 0;
+    for (size_t i = 1; i < r.frames.size(); i++) {
+        worst = std::max(worst, r.frames[i].stats.busWrites);
+        bus += r.frames[i].stats.busWrites;
+    }
+    EXPECT_LE(bus / (r.frames.size() - 1), 600u);       // measured ~450
+    EXPECT_LE(worst, 16000u);                           // toast show, ~13950
+    // ECG-only frame (8 samples): the new columns' runs and the gap columns
+    // they blank ahead merge into one tile — no full-height erase
+    EXPECT_LE(frameAt(r, 224, &FramebufferDisplay::FrameStats::windows), 1u);
+    EXPECT_LE(frameAt(r, 224, &FramebufferDisplay::FrameStats::pixels), 22u * 8u);
+    // Dismiss repaints the toast box only
+    EXPECT_LE(frameAt(r, 7500, &FramebufferDisplay::FrameStats::pixels),
+              200u * 38u + 100u * 50u);
+}
@@ -1,6 +1,7 @@
 /**
  * @file test_services_f103.cpp
- * @brief Coverage for the small F103 service singletons (Timer/Led/Io).
+ * @brief Coverage for the small F103 service singletons (Timer/Led/Io) and
+ *        the sensor services' sampling plans on the acquisition task.
  *
  * Each service is exercised through its public lifecycle (initHAL → init →
  * start → stop) plus any direct accessor / mutation that doesn't require
@@ -20,6 +21,7 @@
 #include "IoServiceImpl.hpp"
 #include "SensorServiceImpl.hpp"
 #include "LightServiceImpl.hpp"
+#include "AcquisitionServiceImpl.hpp"
 
 extern int g_hal_gpio_read_abort_after;
 extern int g_hal_gpio_read_call_count;
@@ -57,20 +59,62 @@ using arcana::io::IoServiceTestAccess;
 
 namespace arcana { namespace sensor {
 struct SensorServiceTestAccess {
-    static void invokeTask(SensorServiceImpl& s) { SensorServiceImpl::sensorTask(&s); }
+    static arcana::AcqStatus drain(SensorServiceImpl& s, const arcana::AcqSlot& slot) {
+        return SensorServiceImpl::drainPlan(&s, slot);
+    }
+    static arcana::AcqStatus snapshot(SensorServiceImpl& s, const arcana::AcqSlot& slot) {
+        return SensorServiceImpl::snapshotPlan(&s, slot);
+    }
+    static arcana::AcqStatus poll(SensorServiceImpl& s, const arcana::AcqSlot& slot) {
+        return SensorServiceImpl::pollPlan(&s, slot);
+    }
+    static const arcana::SensorDataModel& data(SensorServiceImpl& s) { return s.mSensorData; }
     static void setRunning(SensorServiceImpl& s, bool r) { s.mRunning = r; }
+    static uint32_t sequence(SensorServiceImpl& s) { return s.mSequence; }
+    static const arcana::SensorBatchModel& batch(SensorServiceImpl& s) { return s.mBatch; }
+    static uint32_t drainMs(SensorServiceImpl& s) { return s.mDrainMs; }
 };
 }}
 using arcana::sensor::SensorServiceTestAccess;
 
 namespace arcana { namespace light {
 struct LightServiceTestAccess {
-    static void invokeTask(LightServiceImpl& s) { LightServiceImpl::lightTask(&s); }
+    static arcana::AcqStatus read(LightServiceImpl& s, const arcana::AcqSlot& slot) {
+        return LightServiceImpl::readPlan(&s, slot);
+    }
+    static const arcana::LightDataModel& data(LightServiceImpl& s) { return s.mLightData; }
     static void setRunning(LightServiceImpl& s, bool r) { s.mRunning = r; }
 };
 }}
 using arcana::light::LightServiceTestAccess;
 
+namespace arcana { namespace acquisition {
+struct AcquisitionServiceTestAccess {
+    static void invokeTask(AcquisitionServiceImpl& s) { AcquisitionServiceImpl::acqTask(&s); }
+    static void setRunning(AcquisitionServiceImpl& s, bool r) { s.mRunning = r; }
+    static arcana::AcquisitionSchedule& schedule(AcquisitionServiceImpl& s) { return s.mSchedule; }
+    static const arcana::AcquisitionStatsModel& stats(AcquisitionServiceImpl& s) { return s.mStats; }
+    /* A fresh table per test: the singleton outlives them */
+    static void reset(AcquisitionServiceImpl& s) {
+        s.mSchedule = arcana::AcquisitionSchedule();
+        s.mRunning = false;
+    }
+};
+}}
+using arcana::acquisition::AcquisitionServiceImpl;
+using arcana::acquisition::AcquisitionServiceTestAccess;
+
+static AcquisitionServiceImpl& acqService() {
+    auto& a = static_cast<AcquisitionServiceImpl&>(AcquisitionServiceImpl::getInstance());
+    AcquisitionServiceTestAccess::reset(a);
+    return a;
+}
+
+static arcana::AcqSlot slotAt(uint32_t ms) {
+    arcana::AcqSlot slot = { ms, ms, ms * 1000, 0 };
+    return slot;
+}
+
 // ── TimerServiceImpl ────────────────────────────────────────────────────────
 
 TEST(TimerServiceTest, GetInstanceReturnsSameSingleton) {
@@ -217,14 +261,28 @@ TEST(SensorServiceTest, GetInstanceReturnsSameSingleton) {
 TEST(SensorServiceTest, LifecycleInitHalInitStartStop) {
     auto& s = static_cast<arcana::sensor::SensorServiceImpl&>(
         arcana::sensor::SensorServiceImpl::getInstance());
+    auto& acq = acqService();
+    s.input.Acquisition = &acq;
     EXPECT_EQ(s.initHAL(), ServiceStatus::OK);
     EXPECT_EQ(s.init(),    ServiceStatus::OK);
     EXPECT_EQ(s.start(),   ServiceStatus::OK);
+    /* Stub FIFO accepts the rate: drain + 1Hz snapshot plans */
+    EXPECT_EQ(AcquisitionServiceTestAccess::schedule(acq).planCount(), 2u);
+    /* Restart updates the plans in place */
+    EXPECT_EQ(s.start(),   ServiceStatus::OK);
+    EXPECT_EQ(AcquisitionServiceTestAccess::schedule(acq).planCount(), 2u);
     s.stop();
     /* Output observable wired */
     EXPECT_NE(s.output.DataEvents, nullptr);
 }
 
+TEST(SensorServiceTest, StartWithoutAcquisitionReturnsInvalidState) {
+    auto& s = static_cast<arcana::sensor::SensorServiceImpl&>(
+        arcana::sensor::SensorServiceImpl::getInstance());
+    s.input.Acquisition = nullptr;
+    EXPECT_EQ(s.start(), ServiceStatus::InvalidState);
+}
+
 // ── LightServiceImpl (with stubbed Ap3216c + I2cBus drivers) ────────────────
 
 TEST(LightServiceTest, GetInstanceReturnsSameSingleton) {
@@ -236,11 +294,17 @@ TEST(LightServiceTest, GetInstanceReturnsSameSingleton) {
 TEST(LightServiceTest, LifecycleInitHalInitStartStop) {
     auto& s = static_cast<arcana::light::LightServiceImpl&>(
         arcana::light::LightServiceImpl::getInstance());
+    auto& acq = acqService();
+    s.input.Acquisition = &acq;
     EXPECT_EQ(s.initHAL(), ServiceStatus::OK);
     EXPECT_EQ(s.init(),    ServiceStatus::OK);
     EXPECT_EQ(s.start(),   ServiceStatus::OK);
+    EXPECT_EQ(AcquisitionServiceTestAccess::schedule(acq).planCount(), 1u);
     s.stop();
     EXPECT_NE(s.output.DataEvents, nullptr);
+
+    s.input.Acquisition = nullptr;
+    EXPECT_EQ(s.start(),   ServiceStatus::InvalidState);
 }
 
 // ── IoServiceImpl::taskLoop body via abort hook ─────────────────────────────
@@ -276,40 +340,167 @@ TEST(IoServiceTaskLoop, ManyIterationsHitsKey1HoldThresholds) {
     s.clearFormatRequest();
 }
 
-// ── SensorServiceImpl::sensorTask body via vTaskDelay abort ─────────────────
+// ── SensorServiceImpl sampling plans ────────────────────────────────────────
 
-TEST(SensorServiceTaskBody, OneIterationViaVTaskDelayAbort) {
+TEST(SensorServicePlans, SnapshotAndPollStampAtTransaction) {
     auto& s = static_cast<arcana::sensor::SensorServiceImpl&>(
         arcana::sensor::SensorServiceImpl::getInstance());
     s.init();   // wires Mpu sensor
     SensorServiceTestAccess::setRunning(s, true);
 
-    /* sensorTask: vTaskDelay(100ms init) + while(running) { read; vTaskDelay }
-     * abort=2 → init delay + first iter delay → throws */
-    g_vTaskDelay_call_count  = 0;
-    g_vTaskDelay_abort_after = 2;
-    try {
-        SensorServiceTestAccess::invokeTask(s);
-        FAIL() << "expected abort";
-    } catch (int) {}
-    g_vTaskDelay_abort_after = 0;
+    EXPECT_EQ(SensorServiceTestAccess::snapshot(s, slotAt(4321)), arcana::AcqStatus::Done);
+    EXPECT_EQ(SensorServiceTestAccess::data(s).timestamp, 4321u);
+    EXPECT_EQ(SensorServiceTestAccess::poll(s, slotAt(5321)), arcana::AcqStatus::Done);
+    EXPECT_EQ(SensorServiceTestAccess::data(s).timestamp, 5321u);
+
+    /* Stopped: plans stay registered but do not touch the bus */
+    SensorServiceTestAccess::setRunning(s, false);
+    EXPECT_EQ(SensorServiceTestAccess::poll(s, slotAt(6321)), arcana::AcqStatus::Done);
+    EXPECT_EQ(SensorServiceTestAccess::data(s).timestamp, 5321u);
 }
 
-// ── LightServiceImpl::lightTask body via vTaskDelay abort ───────────────────
+static int sBatchSeen = 0;
+static void onBatch(arcana::SensorBatchModel* m, void*) {
+    if (m->count > 0) sBatchSeen++;
+}
 
-TEST(LightServiceTaskBody, OneIterationViaVTaskDelayAbort) {
+TEST(SensorServicePlans, FifoDrainPublishesTimestampedBatch) {
+    auto& s = static_cast<arcana::sensor::SensorServiceImpl&>(
+        arcana::sensor::SensorServiceImpl::getInstance());
+    s.init();   // stub FIFO accepts the rate
+    SensorServiceTestAccess::setRunning(s, true);
+    EXPECT_NE(s.output.BatchEvents, nullptr);
+    /* 32 samples at 200Hz, drained at 3/4 full */
+    EXPECT_EQ(SensorServiceTestAccess::drainMs(s), 120u);
+
+    uint32_t seq = SensorServiceTestAccess::sequence(s);
+    s.output.BatchEvents->subscribe(onBatch, nullptr);
+    sBatchSeen = 0;
+    /* Stub FIFO yields 4 frames with nothing pending → the burst ends */
+    EXPECT_EQ(SensorServiceTestAccess::drain(s, slotAt(7000)), arcana::AcqStatus::Done);
+    s.output.BatchEvents->unsubscribe(onBatch);
+
+    /* One batch, delivered synchronously */
+    EXPECT_EQ(sBatchSeen, 1);
+    const arcana::SensorBatchModel& b = SensorServiceTestAccess::batch(s);
+    EXPECT_EQ(b.count, 4u);
+    EXPECT_EQ(b.periodUs, 5000u);
+    EXPECT_EQ(b.sequence, seq);
+    EXPECT_EQ(b.accel[3][2], 11);
+    EXPECT_EQ(b.timestamp, 7000u);
+    EXPECT_EQ(b.sampleTime(0), b.timestamp - 15u);
+    EXPECT_EQ(SensorServiceTestAccess::sequence(s), seq + 4);
+}
+
+// ── LightServiceImpl sampling plan ──────────────────────────────────────────
+
+TEST(LightServicePlans, ReadStampsAtTransaction) {
     auto& s = static_cast<arcana::light::LightServiceImpl&>(
         arcana::light::LightServiceImpl::getInstance());
     s.init();
     LightServiceTestAccess::setRunning(s, true);
+    EXPECT_EQ(LightServiceTestAccess::read(s, slotAt(1234)), arcana::AcqStatus::Done);
+    EXPECT_EQ(LightServiceTestAccess::data(s).timestamp, 1234u);
+    LightServiceTestAccess::setRunning(s, false);
+}
 
+// ── AcquisitionServiceImpl::acqTask via vTaskDelayUntil abort ───────────────
+//
+// The tick override advances 1ms per read and the schedule's clock follows
+// it, so the task sees time pass as it would on target. A plan's sample
+// function can "hold the bus" by pushing the tick forward.
+
+static TickType_t sAcqTick = 0;
+static TickType_t acqTick() { return ++sAcqTick; }
+static uint32_t acqClockUs() { return sAcqTick * 1000; }
+
+static uint32_t sAcqSamples = 0;
+static TickType_t sAcqHoldMs = 0;
+static uint32_t sAcqAbortAfter = 0;   // an overrunning plan never lets the task sleep
+static arcana::AcqStatus acqSample(void*, const arcana::AcqSlot&) {
+    sAcqSamples++;
+    sAcqTick += sAcqHoldMs;
+    if (sAcqAbortAfter && sAcqSamples >= sAcqAbortAfter) throw 2;
+    return arcana::AcqStatus::Done;
+}
+
+extern TickType_t (*g_xTaskGetTickCountOverride)(void);
+
+static void runAcqTask(AcquisitionServiceImpl& acq, int delays) {
+    AcquisitionServiceTestAccess::setRunning(acq, true);
+    g_xTaskGetTickCountOverride = acqTick;
     g_vTaskDelay_call_count  = 0;
-    g_vTaskDelay_abort_after = 2;
+    g_vTaskDelay_abort_after = delays;
     try {
-        LightServiceTestAccess::invokeTask(s);
+        AcquisitionServiceTestAccess::invokeTask(acq);
         FAIL() << "expected abort";
     } catch (int) {}
     g_vTaskDelay_abort_after = 0;
+    g_xTaskGetTickCountOverride = nullptr;
+}
+
+TEST(AcquisitionServiceTest, LifecycleAndOutput) {
+    auto& acq = acqService();
+    EXPECT_EQ(acq.initHAL(), ServiceStatus::OK);
+    EXPECT_EQ(acq.init(),    ServiceStatus::OK);
+    EXPECT_NE(acq.output.StatsEvents, nullptr);
+    EXPECT_EQ(acq.start(),   ServiceStatus::OK);
+    acq.stop();
+}
+
+TEST(AcquisitionServiceTest, TaskRunsPlansAndPublishesStats) {
+    auto& acq = acqService();
+    acq.init();
+    AcquisitionServiceTestAccess::schedule(acq).setClock(acqClockUs);
+    arcana::AcqPlan plan = { acqSample, nullptr, 5, 0, 1 };
+    ASSERT_TRUE(acq.addPlan(plan));
+
+    sAcqTick = 0;
+    sAcqSamples = 0;
+    sAcqHoldMs = 0;
+    /* Well past the first 1s stats window */
+    runAcqTask(acq, 800);
+
+    /* Plans are frozen while the task runs */
+    arcana::AcqPlan late = { acqSample, &acq, 5, 0, 1 };
+    EXPECT_FALSE(acq.addPlan(late));
+
+    const arcana::AcquisitionStatsModel& st = AcquisitionServiceTestAccess::stats(acq);
+    EXPECT_EQ(st.planCount, 1u);
+    EXPECT_GE(st.windowMs, 1000u);
+    /* 200Hz plan: every slot of the window released, none missed */
+    EXPECT_GE(st.plan[0].releases, 199u);
+    EXPECT_LE(st.plan[0].releases, 201u);
+    EXPECT_EQ(st.plan[0].missed, 0u);
+    EXPECT_EQ(st.totalMissed, 0u);
+    /* The fake tick moves on every read, so releases land 0-2ms late */
+    EXPECT_LE(st.plan[0].jitterMaxUs, 2000u);
+    EXPECT_GT(sAcqSamples, 200u);
+}
+
+TEST(AcquisitionServiceTest, OverrunningPlanReportsMissedDeadlines) {
+    auto& acq = acqService();
+    acq.init();
+    AcquisitionServiceTestAccess::schedule(acq).setClock(acqClockUs);
+    arcana::AcqPlan plan = { acqSample, nullptr, 5, 0, 1 };
+    ASSERT_TRUE(acq.addPlan(plan));
+
+    sAcqTick = 0;
+    sAcqSamples = 0;
+    sAcqHoldMs = 12;   // each read holds the bus past two more slots
+    sAcqAbortAfter = 120;
+    runAcqTask(acq, 0);
+    sAcqHoldMs = 0;
+    sAcqAbortAfter = 0;
+
+    const arcana::AcquisitionStatsModel& st = AcquisitionServiceTestAccess::stats(acq);
+    EXPECT_GT(st.plan[0].releases, 0u);
+    /* Every release overran at least one of the slots after it */
+    EXPECT_GE(st.plan[0].missed, st.plan[0].releases);
+    EXPECT_GT(st.totalMissed, 0u);
+    EXPECT_GE(st.plan[0].busMaxUs, 12000u);
+    /* 12ms of every ~14ms loop is spent in the sample function */
+    EXPECT_GE(st.busyPermille, 800u);
 }
 
 // ── IoServiceImpl::taskFunc (static FreeRTOS task entry) ──────────────────
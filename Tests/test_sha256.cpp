@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 #include <array>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 #include "Sha256.hpp"
 
 using arcana::crypto::Sha256;
+using arcana::crypto::HmacSha256;
 
 namespace {
 
@@ -72,6 +75,36 @@ TEST(Sha256Test, MultiBlockInput) {
     EXPECT_TRUE(eq(first, expected));
 }
 
+TEST(Sha256Test, StreamingMatchesOneShotForEveryChunkSize) {
+    // Mixes buffered tails with the whole-block path straight from the input
+    uint8_t buf[300];
+    for (size_t i = 0; i < sizeof(buf); ++i) buf[i] = static_cast<uint8_t>(i * 13 + 5);
+    auto expected = hashOf(buf, sizeof(buf));
+
+    for (size_t chunk = 1; chunk <= 130; ++chunk) {
+        Sha256::Context ctx;
+        Sha256::init(ctx);
+        for (size_t off = 0; off < sizeof(buf); off += chunk) {
+            size_t n = sizeof(buf) - off < chunk ? sizeof(buf) - off : chunk;
+            Sha256::update(ctx, buf + off, n);
+        }
+        std::array<uint8_t, 32> got{};
+        Sha256::final(ctx, got.data());
+        EXPECT_EQ(got, expected) << "chunk " << chunk;
+    }
+}
+
+TEST(Sha256Test, CompressTakesBigEndianWords) {
+    // "abc" padded by hand: 0x61626380, zeros, bit length 24
+    uint32_t block[16] = {0x61626380};
+    block[15] = 24;
+    Sha256::Context ctx;
+    Sha256::init(ctx);
+    Sha256::compress(ctx.state, block);
+    EXPECT_EQ(ctx.state[0], 0xba7816bfu);
+    EXPECT_EQ(ctx.state[7], 0xf20015adu);
+}
+
 // ── HMAC-SHA256 (RFC 4231) ────────────────────────────────────────────────────
 
 TEST(Sha256Test, HmacRfc4231Case1) {
@@ -108,6 +141,84 @@ TEST(Sha256Test, HmacRfc4231Case6_LongKey) {
     EXPECT_EQ(0, std::memcmp(out, expected, 32));
 }
 
+// ── HmacSha256 (cached pad midstates, streaming) ─────────────────────────────
+
+TEST(HmacSha256Test, Rfc4231Case2AnySplitAndReset) {
+    const char* data = "what do ya want for nothing?";
+    const uint8_t expected[32] = {
+        0x5b,0xdc,0xc1,0x46,0xbf,0x60,0x75,0x4e, 0x6a,0x04,0x24,0x26,0x08,0x95,0x75,0xc7,
+        0x5a,0x00,0x3f,0x08,0x9d,0x27,0x39,0x83, 0x9d,0xec,0x58,0xb9,0x64,0xec,0x38,0x43,
+    };
+    HmacSha256::Key k;
+    HmacSha256::setKey(k, reinterpret_cast<const uint8_t*>("Jefe"), 4);
+
+    uint8_t out[32];
+    HmacSha256::mac(k, reinterpret_cast<const uint8_t*>(data), 28, out);
+    EXPECT_EQ(0, std::memcmp(out, expected, 32));
+
+    // One context, reset between messages, every split point
+    HmacSha256 h(k);
+    for (size_t split = 0; split <= 28; ++split) {
+        h.reset();
+        h.update(reinterpret_cast<const uint8_t*>(data), split);
+        h.update(reinterpret_cast<const uint8_t*>(data) + split, 28 - split);
+        h.final(out);
+        EXPECT_EQ(0, std::memcmp(out, expected, 32)) << "split " << split;
+    }
+}
+
+TEST(HmacSha256Test, LongKeyStreamedInUnevenChunks) {
+    // 131-byte key (hashed first), 1000-byte message — verified via Python hmac
+    uint8_t key[131];
+    std::memset(key, 0xaa, sizeof(key));
+    uint8_t msg[1000];
+    for (size_t i = 0; i < sizeof(msg); ++i) msg[i] = static_cast<uint8_t>(i * 31 + 7);
+    const uint8_t expected[32] = {
+        0x9c,0x62,0x0c,0x94,0x57,0x84,0x6b,0x5d, 0x2d,0x73,0xa2,0xf3,0x6f,0xba,0x68,0xd4,
+        0x28,0x2a,0xb8,0x2f,0x36,0xef,0xbf,0x41, 0x1a,0xd1,0x36,0x71,0xb9,0xf3,0x03,0x0b,
+    };
+
+    HmacSha256::Key k;
+    HmacSha256::setKey(k, key, sizeof(key));
+    HmacSha256 h(k);
+    const size_t chunks[] = {1, 7, 63, 64, 65, 200, 600};
+    size_t off = 0;
+    for (size_t c : chunks) {
+        h.update(msg + off, c);
+        off += c;
+    }
+    ASSERT_EQ(off, sizeof(msg));
+    uint8_t out[32];
+    h.final(out);
+    EXPECT_EQ(0, std::memcmp(out, expected, 32));
+
+    Sha256::hmac(key, sizeof(key), msg, sizeof(msg), out);
+    EXPECT_EQ(0, std::memcmp(out, expected, 32));
+}
+
+TEST(HmacSha256Test, CachedKeyVsOneShotPerFrame) {
+    // A 40-byte HMAC command frame: [nonce:12][cipher:28]
+    constexpr int kFrames = 20000;
+    uint8_t key[32], frame[40], out[32], ref[32];
+    for (int i = 0; i < 32; ++i) key[i] = static_cast<uint8_t>(i);
+    for (int i = 0; i < 40; ++i) frame[i] = static_cast<uint8_t>(i * 3);
+    HmacSha256::Key k;
+    HmacSha256::setKey(k, key, sizeof(key));
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; ++i) Sha256::hmac(key, sizeof(key), frame, sizeof(frame), ref);
+    double oneShot = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; ++i) HmacSha256::mac(k, frame, sizeof(frame), out);
+    double cached = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    EXPECT_EQ(0, std::memcmp(out, ref, 32));
+    std::printf("[ throughput ] Sha256::hmac one-shot: %.2f us/frame (4 blocks)\n",
+                oneShot * 1e6 / kFrames);
+    std::printf("[ throughput ] HmacSha256 cached key: %.2f us/frame (2 blocks)\n",
+                cached * 1e6 / kFrames);
+}
+
 // ── HKDF-SHA256 (RFC 5869) ────────────────────────────────────────────────────
 
 TEST(Sha256Test, HkdfRfc5869Case1) {
@@ -0,0 +1,618 @@
+/**
+ * @file test_stream.cpp
+ * @brief StreamCodec wire format, StreamSender windowing / loss recovery,
+ *        and AtsQuerySource paging over a real ArcanaTsDb
+ */
+
+#include <gtest/gtest.h>
+#include <functional>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "StreamCodec.hpp"
+#include "StreamSender.hpp"
+#include "AtsQuerySource.hpp"
+#include "ats_mocks.hpp"
+
+using namespace arcana;
+
+namespace {
+
+typedef StreamSender<4, 8> Sender;
+
+class VectorSource : public IStreamSource {
+public:
+    explicit VectorSource(size_t n) {
+        for (size_t i = 0; i < n; i++) bytes.push_back(static_cast<uint8_t>(i * 7 + 1));
+    }
+    size_t read(uint8_t* dst, size_t cap) override {
+        size_t n = bytes.size() - pos;
+        if (n > cap) n = cap;
+        memcpy(dst, bytes.data() + pos, n);
+        pos += n;
+        return n;
+    }
+    std::vector<uint8_t> bytes;
+    size_t pos = 0;
+};
+
+struct Sent {
+    uint16_t seq;
+    bool fin;
+    std::vector<uint8_t> data;
+};
+
+/** Captures emitted DATA messages; optionally drops selected sends */
+struct Link {
+    std::vector<Sent> sent;
+    bool busy = false;
+
+    static bool emit(const uint8_t* p, size_t len, bool fin, void* ctx) {
+        Link* l = static_cast<Link*>(ctx);
+        if (l->busy) return false;
+        StreamMessage m;
+        EXPECT_TRUE(StreamCodec::parse(p, len, m));
+        EXPECT_EQ(m.type, StreamCodec::kData);
+        l->sent.push_back({m.seq, fin, std::vector<uint8_t>(m.data, m.data + m.length)});
+        return true;
+    }
+};
+
+/** Minimal receiver: reorders chunks and builds cumulative + SACK acks */
+struct Receiver {
+    std::map<uint16_t, std::vector<uint8_t>> chunks;
+    uint16_t next = 0;
+    bool finSeen = false;
+    uint16_t finSeq = 0;
+
+    void accept(const Sent& s) {
+        if (static_cast<uint16_t>(s.seq - next) >= 0x8000) return;  // old duplicate
+        chunks[s.seq] = s.data;
+        if (s.fin) { finSeen = true; finSeq = s.seq; }
+        while (chunks.count(next)) next++;
+    }
+
+    StreamMessage ack(uint8_t xferId) const {
+        StreamMessage m;
+        m.type = StreamCodec::kAck;
+        m.xferId = xferId;
+        m.seq = next;
+        for (uint8_t i = 0; i < StreamCodec::kSackBits; i++) {
+            if (chunks.count(static_cast<uint16_t>(next + 1 + i))) m.sack |= (1u << i);
+        }
+        return m;
+    }
+
+    bool complete() const { return finSeen && next == static_cast<uint16_t>(finSeq + 1); }
+
+    std::vector<uint8_t> bytes() const {
+        std::vector<uint8_t> out;
+        for (uint16_t s = 0; s != next; s++) {
+            const auto& c = chunks.at(s);
+            out.insert(out.end(), c.begin(), c.end());
+        }
+        return out;
+    }
+};
+
+StreamMessage control(uint8_t type, uint8_t xferId, uint16_t seq, uint16_t sack = 0) {
+    StreamMessage m;
+    m.type = type;
+    m.xferId = xferId;
+    m.seq = seq;
+    m.sack = sack;
+    return m;
+}
+
+} // namespace
+
+// ── StreamCodec ──────────────────────────────────────────────────────────────
+
+TEST(StreamCodecTest, DataRoundTrip) {
+    const uint8_t chunk[] = {1, 2, 3};
+    uint8_t buf[16];
+    size_t len = StreamCodec::writeData(buf, sizeof(buf), 9, 0x1234, chunk, sizeof(chunk));
+    ASSERT_EQ(len, StreamCodec::kDataHeader + 3);
+    EXPECT_EQ(buf[2], 0x34);
+    EXPECT_EQ(buf[3], 0x12);
+
+    StreamMessage m;
+    ASSERT_TRUE(StreamCodec::parse(buf, len, m));
+    EXPECT_EQ(m.type, StreamCodec::kData);
+    EXPECT_EQ(m.xferId, 9);
+    EXPECT_EQ(m.seq, 0x1234);
+    ASSERT_EQ(m.length, 3u);
+    EXPECT_EQ(memcmp(m.data, chunk, 3), 0);
+}
+
+TEST(StreamCodecTest, ControlRoundTrip) {
+    uint8_t buf[8];
+    StreamMessage m;
+
+    ASSERT_EQ(StreamCodec::writeAck(buf, sizeof(buf), 2, 40, 0x8001), StreamCodec::kAckSize);
+    ASSERT_TRUE(StreamCodec::parse(buf, StreamCodec::kAckSize, m));
+    EXPECT_EQ(m.type, StreamCodec::kAck);
+    EXPECT_EQ(m.seq, 40);
+    EXPECT_EQ(m.sack, 0x8001);
+
+    ASSERT_EQ(StreamCodec::writeNack(buf, sizeof(buf), 2, 7), StreamCodec::kSeqMsgSize);
+    ASSERT_TRUE(StreamCodec::parse(buf, StreamCodec::kSeqMsgSize, m));
+    EXPECT_EQ(m.type, StreamCodec::kNack);
+    EXPECT_EQ(m.seq, 7);
+
+    ASSERT_EQ(StreamCodec::writeResume(buf, sizeof(buf), 2, 300), StreamCodec::kSeqMsgSize);
+    ASSERT_TRUE(StreamCodec::parse(buf, StreamCodec::kSeqMsgSize, m));
+    EXPECT_EQ(m.type, StreamCodec::kResume);
+    EXPECT_EQ(m.seq, 300);
+
+    ASSERT_EQ(StreamCodec::writeAbort(buf, sizeof(buf), 2), StreamCodec::kAbortSize);
+    ASSERT_TRUE(StreamCodec::parse(buf, StreamCodec::kAbortSize, m));
+    EXPECT_EQ(m.type, StreamCodec::kAbort);
+    EXPECT_EQ(m.xferId, 2);
+}
+
+TEST(StreamCodecTest, RejectsShortAndUnknown) {
+    StreamMessage m;
+    const uint8_t shortAck[] = {StreamCodec::kAck, 1, 0, 0};
+    EXPECT_FALSE(StreamCodec::parse(shortAck, sizeof(shortAck), m));
+    const uint8_t unknown[] = {0x7F, 1, 0, 0};
+    EXPECT_FALSE(StreamCodec::parse(unknown, sizeof(unknown), m));
+    EXPECT_FALSE(StreamCodec::parse(unknown, 1, m));
+
+    uint8_t buf[4];
+    const uint8_t chunk[8] = {};
+    EXPECT_EQ(StreamCodec::writeData(buf, sizeof(buf), 1, 0, chunk, sizeof(chunk)), 0u);
+    EXPECT_EQ(StreamCodec::writeAck(buf, sizeof(buf), 1, 0, 0), 0u);
+}
+
+// ── StreamSender ─────────────────────────────────────────────────────────────
+
+TEST(StreamSenderTest, WindowLimitsInFlightAndAckSlides) {
+    VectorSource src(100);   // 13 chunks of 8 (last is 4)
+    Sender tx;
+    Link link;
+    tx.begin(1, &src, 0);
+
+    EXPECT_EQ(tx.pump(0, Link::emit, &link), 4);
+    EXPECT_EQ(tx.pump(0, Link::emit, &link), 0);   // window full
+
+    ASSERT_TRUE(tx.onControl(control(StreamCodec::kAck, 1, 2), 10));
+    EXPECT_EQ(tx.pump(10, Link::emit, &link), 2);
+    ASSERT_EQ(link.sent.size(), 6u);
+    EXPECT_EQ(link.sent[5].seq, 5);
+}
+
+TEST(StreamSenderTest, LosslessTransferCompletesWithFinOnLastChunk) {
+    VectorSource src(100);
+    Sender tx;
+    Link link;
+    Receiver rx;
+    tx.begin(3, &src, 0);
+
+    for (int round = 0; round < 20 && tx.running(); round++) {
+        size_t from = link.sent.size();
+        tx.pump(0, Link::emit, &link);
+        for (size_t i = from; i < link.sent.size(); i++) rx.accept(link.sent[i]);
+        tx.onControl(rx.ack(3), 0);
+    }
+
+    EXPECT_EQ(tx.state(), Sender::State::Idle);
+    EXPECT_TRUE(rx.complete());
+    EXPECT_EQ(rx.bytes(), src.bytes);
+    EXPECT_EQ(tx.retransmits(), 0u);
+    for (size_t i = 0; i + 1 < link.sent.size(); i++) EXPECT_FALSE(link.sent[i].fin);
+    EXPECT_TRUE(link.sent.back().fin);
+}
+
+TEST(StreamSenderTest, ExactMultipleOfChunkEndsWithEmptyFinChunk) {
+    VectorSource src(16);
+    Sender tx;
+    Link link;
+    tx.begin(1, &src, 0);
+    tx.pump(0, Link::emit, &link);
+    ASSERT_EQ(link.sent.size(), 3u);
+    EXPECT_TRUE(link.sent[2].fin);
+    EXPECT_TRUE(link.sent[2].data.empty());
+}
+
+TEST(StreamSenderTest, SackHoleIsFastRetransmittedOnce) {
+    VectorSource src(100);
+    Sender tx;
+    Link link;
+    tx.begin(1, &src, 0);
+    tx.pump(0, Link::emit, &link);           // seq 0..3
+
+    // Receiver got 0, 2, 3 — seq 1 lost
+    ASSERT_TRUE(tx.onControl(control(StreamCodec::kAck, 1, 1, 0x0003), 5));
+    link.sent.clear();
+    tx.pump(5, Link::emit, &link);
+    ASSERT_GE(link.sent.size(), 1u);
+    EXPECT_EQ(link.sent[0].seq, 1);          // hole first, no RTO wait
+    EXPECT_EQ(tx.retransmits(), 1u);
+
+    // Same SACK again must not re-send the hole a second time
+    link.sent.clear();
+    ASSERT_TRUE(tx.onControl(control(StreamCodec::kAck, 1, 1, 0x0003), 6));
+    tx.pump(6, Link::emit, &link);
+    for (const Sent& s : link.sent) EXPECT_NE(s.seq, 1);
+    EXPECT_EQ(tx.retransmits(), 1u);
+}
+
+TEST(StreamSenderTest, NackRetransmitsOneChunk) {
+    VectorSource src(100);
+    Sender tx;
+    Link link;
+    tx.begin(1, &src, 0);
+    tx.pump(0, Link::emit, &link);
+
+    link.sent.clear();
+    ASSERT_TRUE(tx.onControl(control(StreamCodec::kNack, 1, 2), 1));
+    EXPECT_EQ(tx.pump(1, Link::emit, &link), 1);
+    EXPECT_EQ(link.sent[0].seq, 2);
+
+    // Out-of-window NACK is ignored
+    EXPECT_FALSE(tx.onControl(control(StreamCodec::kNack, 1, 9), 2));
+}
+
+TEST(StreamSenderTest, RtoRetransmitsThenStalls) {
+    VectorSource src(100);
+    Sender tx;
+    Link link;
+    tx.begin(1, &src, 0, /*rto*/100, /*maxRetries*/2);
+    tx.pump(0, Link::emit, &link);
+    link.sent.clear();
+
+    EXPECT_EQ(tx.pump(99, Link::emit, &link), 0);
+    EXPECT_EQ(tx.pump(100, Link::emit, &link), 4);   // retry 1
+    EXPECT_EQ(tx.pump(200, Link::emit, &link), 4);   // retry 2
+    EXPECT_EQ(tx.pump(300, Link::emit, &link), 0);   // gave up
+    EXPECT_EQ(tx.state(), Sender::State::Stalled);
+    EXPECT_FALSE(tx.running());
+    EXPECT_EQ(tx.retransmits(), 8u);
+}
+
+TEST(StreamSenderTest, ResumeAfterStallContinuesFromReceiverPosition) {
+    VectorSource src(100);
+    Sender tx;
+    Link link;
+    Receiver rx;
+    tx.begin(4, &src, 0, 100, 0);
+    tx.pump(0, Link::emit, &link);
+    rx.accept(link.sent[0]);
+    rx.accept(link.sent[1]);                 // link dropped after seq 1
+    tx.pump(100, Link::emit, &link);
+    ASSERT_EQ(tx.state(), Sender::State::Stalled);
+
+    // Reconnect: receiver resumes from the next seq it needs
+    link.sent.clear();
+    ASSERT_TRUE(tx.onControl(control(StreamCodec::kResume, 4, rx.next), 500));
+    EXPECT_TRUE(tx.running());
+    for (int round = 0; round < 20 && tx.running(); round++) {
+        size_t from = link.sent.size();
+        tx.pump(500, Link::emit, &link);
+        for (size_t i = from; i < link.sent.size(); i++) rx.accept(link.sent[i]);
+        tx.onControl(rx.ack(4), 500);
+    }
+    EXPECT_EQ(link.sent[0].seq, 2);
+    EXPECT_TRUE(rx.complete());
+    EXPECT_EQ(rx.bytes(), src.bytes);
+}
+
+TEST(StreamSenderTest, AbortAndForeignXferId) {
+    VectorSource src(100);
+    Sender tx;
+    Link link;
+    tx.begin(5, &src, 0);
+    tx.pump(0, Link::emit, &link);
+
+    EXPECT_FALSE(tx.onControl(control(StreamCodec::kAck, 6, 4), 0));
+    ASSERT_TRUE(tx.onControl(control(StreamCodec::kAbort, 5, 0), 0));
+    EXPECT_EQ(tx.state(), Sender::State::Idle);
+    EXPECT_EQ(tx.pump(0, Link::emit, &link), 0);
+}
+
+TEST(StreamSenderTest, BusyLinkDefersWithoutLosingChunks) {
+    VectorSource src(20);
+    Sender tx;
+    Link link;
+    tx.begin(1, &src, 0);
+    link.busy = true;
+    EXPECT_EQ(tx.pump(0, Link::emit, &link), 0);
+    link.busy = false;
+    EXPECT_EQ(tx.pump(0, Link::emit, &link), 3);
+    EXPECT_EQ(tx.framesSent(), 3u);
+}
+
+TEST(StreamSenderTest, LossyLinkDeliversIntactPayload) {
+    VectorSource src(1000);
+    Sender tx;
+    Link link;
+    Receiver rx;
+    tx.begin(7, &src, 0, 50, 10);
+
+    uint32_t now = 0;
+    size_t delivered = 0;
+    for (int round = 0; round < 2000 && tx.running(); round++, now += 10) {
+        size_t from = link.sent.size();
+        tx.pump(now, Link::emit, &link);
+        for (size_t i = from; i < link.sent.size(); i++) {
+            if (++delivered % 5 == 0) continue;          // drop every 5th frame
+            rx.accept(link.sent[i]);
+        }
+        if (round % 3 != 0) tx.onControl(rx.ack(7), now);   // ACKs lost too
+    }
+
+    EXPECT_TRUE(rx.complete());
+    EXPECT_EQ(rx.bytes(), src.bytes);
+    EXPECT_GT(tx.retransmits(), 0u);
+}
+
+// ── AtsQuerySource ───────────────────────────────────────────────────────────
+
+namespace {
+
+using arcana::ats::ArcanaTsDb;
+using arcana::ats::ArcanaTsSchema;
+using arcana::ats::AtsConfig;
+using arcana::ats::FieldType;
+using arcana::ats::BLOCK_SIZE;
+
+struct AtsFixture {
+    arcana_test::MemFilePort file;
+    arcana_test::NullCipher  cipher;
+    arcana_test::StubMutex   mutex;
+    std::vector<uint8_t> bufA, bufB, slow, readCache;
+    uint8_t uid[12] = {};
+    uint8_t key[32] = {};
+    ArcanaTsDb db;
+
+    AtsFixture(arcana::ats::IFilePort* filePort = nullptr,
+               arcana::ats::IMutex* dbMutex = nullptr)
+        : bufA(BLOCK_SIZE), bufB(BLOCK_SIZE), slow(BLOCK_SIZE), readCache(BLOCK_SIZE) {
+        arcana_test::TestClock::reset(1000, 1);
+        AtsConfig c{};
+        c.file = filePort ? filePort : &file;
+        c.cipher = &cipher;
+        c.mutex = dbMutex ? dbMutex : &mutex;
+        c.getTime = &arcana_test::TestClock::now;
+        c.key = key;
+        c.deviceUid = uid;
+        c.deviceUidSize = 12;
+        c.primaryChannel = 0;
+        c.primaryBufA = bufA.data();
+        c.primaryBufB = bufB.data();
+        c.slowBuf = slow.data();
+        c.readCache = readCache.data();
+        EXPECT_TRUE(db.open("q.ats", c));
+        ArcanaTsSchema s;
+        s.setName("ADC8");
+        s.addField("ts", FieldType::U32);
+        s.addField("val", FieldType::U32);
+        EXPECT_TRUE(db.addChannel(0, s));
+        EXPECT_TRUE(db.start());
+    }
+
+    // Block index timestamps come from the clock — keep it on the record ts
+    void append(uint32_t ts, uint32_t val) {
+        arcana_test::TestClock::reset(ts, 0);
+        uint8_t rec[8];
+        memcpy(rec, &ts, 4);
+        memcpy(rec + 4, &val, 4);
+        ASSERT_TRUE(db.append(0, rec));
+    }
+};
+
+// Stand-in for the storage task: it gets the CPU whenever the stream side
+// does not hold the DB mutex — before every lock() and after every file read
+struct Preempter {
+    std::function<void()> writer;
+    const arcana_test::StubMutex* mutex = nullptr;
+    bool running = false;
+    int runs = 0;
+
+    void maybeRun() {
+        if (!writer || running || mutex->lockCount > 0) return;
+        running = true;
+        writer();
+        running = false;
+        runs++;
+    }
+};
+
+class PreemptingMutex : public arcana_test::StubMutex {
+public:
+    Preempter* p = nullptr;
+    bool lock(uint32_t timeoutMs = 0xFFFFFFFF) override {
+        p->maybeRun();
+        return StubMutex::lock(timeoutMs);
+    }
+};
+
+class PreemptingFile : public arcana_test::MemFilePort {
+public:
+    Preempter* p = nullptr;
+    int32_t read(uint8_t* buf, uint32_t size) override {
+        int32_t n = MemFilePort::read(buf, size);
+        p->maybeRun();
+        return n;
+    }
+};
+
+std::vector<uint32_t> drainValues(IStreamSource& src, size_t chunk) {
+    std::vector<uint8_t> bytes;
+    uint8_t buf[96];
+    while (true) {
+        size_t n = src.read(buf, chunk);
+        bytes.insert(bytes.end(), buf, buf + n);
+        if (n < chunk) break;
+    }
+    std::vector<uint32_t> vals;
+    for (size_t off = 0; off + 8 <= bytes.size(); off += 8) {
+        uint32_t v;
+        memcpy(&v, bytes.data() + off + 4, 4);
+        vals.push_back(v);
+    }
+    EXPECT_EQ(bytes.size() % 8, 0u);
+    return vals;
+}
+
+} // namespace
+
+TEST(AtsQuerySourceTest, RangePagesAcrossDuplicateTimestamps) {
+    AtsFixture f;
+    // Three records per timestamp so page boundaries (128 records) split a group
+    for (uint32_t i = 0; i < 600; i++) f.append(5000 + i / 3, i);
+    ASSERT_TRUE(f.db.flush());
+
+    AtsQuerySource src;
+    ASSERT_TRUE(src.beginRange(&f.db, 0, 5000, 0xFFFFFFFFu));
+    EXPECT_EQ(src.recordSize(), 8u);
+
+    std::vector<uint32_t> vals = drainValues(src, 96);
+    ASSERT_EQ(vals.size(), 600u);
+    for (uint32_t i = 0; i < 600; i++) EXPECT_EQ(vals[i], i);
+}
+
+TEST(AtsQuerySourceTest, RangeHonoursBounds) {
+    AtsFixture f;
+    for (uint32_t i = 0; i < 300; i++) f.append(5000 + i, i);
+    ASSERT_TRUE(f.db.flush());
+
+    AtsQuerySource src;
+    ASSERT_TRUE(src.beginRange(&f.db, 0, 5010, 5019));
+    std::vector<uint32_t> vals = drainValues(src, 96);
+    ASSERT_EQ(vals.size(), 10u);
+    EXPECT_EQ(vals.front(), 10u);
+    EXPECT_EQ(vals.back(), 19u);
+}
+
+TEST(AtsQuerySourceTest, LatestNStreamsNewestRecords) {
+    AtsFixture f;
+    for (uint32_t i = 0; i < 50; i++) f.append(5000 + i, i);
+
+    AtsQuerySource src;
+    ASSERT_TRUE(src.beginLatest(&f.db, 0, 5));
+    std::vector<uint32_t> vals = drainValues(src, 96);
+    ASSERT_EQ(vals.size(), 5u);
+    EXPECT_EQ(vals.back(), 49u);
+}
+
+TEST(AtsQuerySourceTest, LatestNClampedToOneStagingBuffer) {
+    AtsFixture f;
+    for (uint32_t i = 0; i < 300; i++) f.append(5000 + i, i);
+    ASSERT_TRUE(f.db.flush());
+
+    // 8-byte records: one 1024-byte staging buffer holds 128
+    AtsQuerySource src;
+    ASSERT_TRUE(src.beginLatest(&f.db, 0, 200));
+    EXPECT_EQ(src.latestCount(), 128u);
+    std::vector<uint32_t> vals = drainValues(src, 96);
+    ASSERT_EQ(vals.size(), 128u);
+    EXPECT_EQ(vals.front(), 300u - 128u);
+    EXPECT_EQ(vals.back(), 299u);
+
+    ASSERT_TRUE(src.beginLatest(&f.db, 0, 5));
+    EXPECT_EQ(src.latestCount(), 5u);
+    ASSERT_TRUE(src.beginRange(&f.db, 0, 5000, 5010));
+    EXPECT_EQ(src.latestCount(), 0u);
+}
+
+// Records how many cache-lock holders each file read ran under
+class LockCheckingFile : public arcana_test::MemFilePort {
+public:
+    const arcana_test::StubMutex* lock = nullptr;
+    int reads = 0, unlocked = 0;
+    int32_t read(uint8_t* buf, uint32_t size) override {
+        reads++;
+        if (lock->lockCount != 1) unlocked++;
+        return MemFilePort::read(buf, size);
+    }
+};
+
+TEST(AtsQuerySourceTest, QueriesRunUnderTheCacheLock) {
+    // The upload borrows the DB's read cache through this lock
+    arcana_test::StubMutex cacheLock;
+    LockCheckingFile file;
+    file.lock = &cacheLock;
+    AtsFixture f(&file);
+    for (uint32_t i = 0; i < 300; i++) f.append(5000 + i, i);
+    ASSERT_TRUE(f.db.flush());
+    file.reads = file.unlocked = 0;
+
+    AtsQuerySource src;
+    src.setCacheLock(&cacheLock);
+    ASSERT_TRUE(src.beginRange(&f.db, 0, 5000, 0xFFFFFFFFu));
+    EXPECT_EQ(drainValues(src, 96).size(), 300u);
+    ASSERT_TRUE(src.beginLatest(&f.db, 0, 5));
+    EXPECT_EQ(drainValues(src, 96).size(), 5u);
+
+    EXPECT_GT(file.reads, 0);
+    EXPECT_EQ(file.unlocked, 0);
+    EXPECT_EQ(cacheLock.lockCount, 0);
+}
+
+TEST(AtsQuerySourceTest, RejectsUnknownChannel) {
+    AtsFixture f;
+    AtsQuerySource src;
+    EXPECT_FALSE(src.beginRange(&f.db, 3, 0, 100));
+    EXPECT_FALSE(src.beginLatest(nullptr, 0, 5));
+    uint8_t buf[8];
+    EXPECT_EQ(src.read(buf, sizeof(buf)), 0u);
+}
+
+TEST(AtsQuerySourceTest, FeedsSenderEndToEnd) {
+    AtsFixture f;
+    for (uint32_t i = 0; i < 400; i++) f.append(5000 + i, i);
+    ASSERT_TRUE(f.db.flush());
+
+    AtsQuerySource src;
+    ASSERT_TRUE(src.beginRange(&f.db, 0, 0, 0xFFFFFFFFu));
+    StreamSender<8, 96> tx;
+    Link link;
+    Receiver rx;
+    tx.begin(1, &src, 0);
+    for (int round = 0; round < 100 && tx.running(); round++) {
+        size_t from = link.sent.size();
+        tx.pump(0, Link::emit, &link);
+        for (size_t i = from; i < link.sent.size(); i++) rx.accept(link.sent[i]);
+        tx.onControl(rx.ack(1), 0);
+    }
+    ASSERT_TRUE(rx.complete());
+    std::vector<uint8_t> bytes = rx.bytes();
+    ASSERT_EQ(bytes.size(), 400u * 8u);
+    uint32_t v;
+    memcpy(&v, bytes.data() + 399 * 8 + 4, 4);
+    EXPECT_EQ(v, 399u);
+}
+
+TEST(AtsQuerySourceTest, RangeRefillInterleavedWithWriterStaysIntact) {
+    Preempter p;
+    PreemptingMutex mutex;
+    PreemptingFile file;
+    mutex.p = &p;
+    file.p = &p;
+    p.mutex = &mutex;
+    AtsFixture f(&file, &mutex);
+
+    for (uint32_t i = 0; i < 600; i++) f.append(5000 + i, i);
+    ASSERT_TRUE(f.db.flush());
+
+    // Each preemption commits a fresh block past the queried range: writeBlock
+    // reuses the read cache and moves the file position
+    uint32_t next = 9000;
+    p.writer = [&] {
+        for (int k = 0; k < 3; k++, next++) f.append(next, 0xDEAD0000u | next);
+        f.db.flush();
+    };
+
+    AtsQuerySource src;
+    ASSERT_TRUE(src.beginRange(&f.db, 0, 5000, 5599));
+    std::vector<uint32_t> vals = drainValues(src, 40);
+    p.writer = nullptr;
+
+    EXPECT_GT(p.runs, 0);
+    ASSERT_EQ(vals.size(), 600u);
+    for (uint32_t i = 0; i < 600; i++) EXPECT_EQ(vals[i], i);
+    EXPECT_EQ(mutex.maxDepth, 1);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file test_telemetry_batch.cpp
+ * @brief Host tests for TelemetryBatch (multi-sample MQTT telemetry payload).
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+
+#include "TelemetryBatch.hpp"
+
+using arcana::TelemetryBatch;
+
+TEST(TelemetryBatch, RoundTripsSamplesAndTimestamps) {
+    uint8_t buf[128];
+    TelemetryBatch b;
+    b.init(buf, sizeof(buf), 3);
+
+    const uint32_t ts[4] = { 100000, 101000, 101999, 103000 };
+    const int32_t v[4][3] = {
+        { 225, -16384, 0 }, { 226, -16380, 3 }, { 224, -16390, -2 }, { 224, 16384, 70000 },
+    };
+    for (int i = 0; i < 4; i++) ASSERT_TRUE(b.add(ts[i], v[i]));
+    EXPECT_EQ(b.count(), 4u);
+    EXPECT_EQ(b.data()[0], TelemetryBatch::VERSION);
+    EXPECT_EQ(b.data()[1], 3u);
+    EXPECT_EQ(b.data()[2], 4u);
+
+    uint32_t outTs[8];
+    int32_t outV[8 * 3];
+    ASSERT_EQ(TelemetryBatch::decode(b.data(), b.size(), outTs, outV, 8), 4u);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(outTs[i], ts[i]);
+        for (int f = 0; f < 3; f++) EXPECT_EQ(outV[i * 3 + f], v[i][f]);
+    }
+}
+
+TEST(TelemetryBatch, SteadySamplesCostFewBytes) {
+    uint8_t buf[256];
+    TelemetryBatch b;
+    b.init(buf, sizeof(buf), 6);
+
+    // 1Hz, sensor at rest: ts delta 2 bytes, each field delta 1 byte
+    int32_t v[6] = { 250, 12, -40, 16400, 300, 5 };
+    ASSERT_TRUE(b.add(5000, v));
+    const uint16_t first = b.size();
+    for (int i = 1; i < 10; i++) {
+        v[3] += (i & 1) ? 3 : -3;
+        ASSERT_TRUE(b.add(5000 + i * 1000, v));
+    }
+    EXPECT_EQ(b.size(), first + 9 * (2 + 6));
+}
+
+TEST(TelemetryBatch, RefusesSampleThatDoesNotFit) {
+    uint8_t buf[TelemetryBatch::HEADER_SIZE + 6];
+    TelemetryBatch b;
+    b.init(buf, sizeof(buf), 2);
+
+    const int32_t small[2] = { 1, 1 };
+    const int32_t big[2] = { 1000000, -1000000 };
+    ASSERT_TRUE(b.add(0, small));          // 3 bytes
+    EXPECT_FALSE(b.add(1, big));           // 1 + 3 + 3 bytes
+    EXPECT_EQ(b.count(), 1u);
+    EXPECT_TRUE(b.add(1, small));          // state unchanged by the refusal
+    EXPECT_EQ(b.size(), TelemetryBatch::HEADER_SIZE + 6);
+
+    uint32_t ts[2];
+    int32_t v[4];
+    ASSERT_EQ(TelemetryBatch::decode(b.data(), b.size(), ts, v, 2), 2u);
+    EXPECT_EQ(v[2], 1);
+    EXPECT_EQ(v[3], 1);
+}
+
+TEST(TelemetryBatch, ResetStartsFreshBase) {
+    uint8_t buf[64];
+    TelemetryBatch b;
+    b.init(buf, sizeof(buf), 1);
+
+    const int32_t a[1] = { 500 };
+    b.add(10, a);
+    b.add(20, a);
+    b.reset();
+    EXPECT_EQ(b.count(), 0u);
+    EXPECT_EQ(b.size(), 0u);
+
+    const int32_t c[1] = { -7 };
+    ASSERT_TRUE(b.add(90000, c));
+    uint32_t ts;
+    int32_t v;
+    ASSERT_EQ(TelemetryBatch::decode(b.data(), b.size(), &ts, &v, 1), 1u);
+    EXPECT_EQ(ts, 90000u);
+    EXPECT_EQ(v, -7);
+}
+
+TEST(TelemetryBatch, DecodeRejectsMalformedInput) {
+    uint8_t buf[64];
+    TelemetryBatch b;
+    b.init(buf, sizeof(buf), 2);
+    const int32_t v[2] = { 300, -300 };
+    b.add(1, v);
+    b.add(2, v);
+
+    uint32_t ts[4];
+    int32_t out[8];
+    EXPECT_EQ(TelemetryBatch::decode(buf, b.size() - 1, ts, out, 4), 0u);   // truncated
+    EXPECT_EQ(TelemetryBatch::decode(buf, b.size(), ts, out, 1), 0u);       // too many samples
+
+    uint8_t copy[64];
+    std::memcpy(copy, buf, b.size());
+    copy[0] = 2;                                                           // unknown version
+    EXPECT_EQ(TelemetryBatch::decode(copy, b.size(), ts, out, 4), 0u);
+    copy[0] = TelemetryBatch::VERSION;
+    copy[b.size()] = 0;                                                    // trailing byte
+    EXPECT_EQ(TelemetryBatch::decode(copy, b.size() + 1, ts, out, 4), 0u);
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_telemetry_pipeline.cpp
+ * @brief Host tests for TelemetryPipeline (encode-once sensor sample, SID 0x20 seal).
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "TelemetryPipeline.hpp"
+
+using arcana::TelemetrySample;
+using arcana::TelemetryPipeline;
+using arcana::SensorDataModel;
+using arcana::LightDataModel;
+using arcana::FrameCodec;
+using arcana::crypto::ChaCha20;
+
+namespace {
+
+const uint8_t KEY_A[32] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+const uint8_t KEY_B[32] = { 9, 9, 9, 9 };
+
+SensorDataModel sensor(uint32_t ts, float temp, int16_t ax, int16_t ay, int16_t az) {
+    SensorDataModel m;
+    m.timestamp = ts;
+    m.temperature = temp;
+    m.accelX = ax;
+    m.accelY = ay;
+    m.accelZ = az;
+    return m;
+}
+
+LightDataModel light(uint16_t als, uint16_t ps) {
+    LightDataModel l;
+    l.ambientLight = als;
+    l.proximity = ps;
+    return l;
+}
+
+/** Deframe + decrypt a sealed frame back to its protobuf */
+std::vector<uint8_t> openFrame(const uint8_t* frame, uint16_t len, const uint8_t* key,
+                               uint8_t& sid) {
+    const uint8_t* payload = nullptr;
+    size_t payloadLen = 0;
+    uint8_t flags = 0;
+    if (!FrameCodec::deframe(frame, len, payload, payloadLen, flags, sid)) return {};
+    std::vector<uint8_t> pb(payload + 12, payload + payloadLen);
+    ChaCha20::crypt(key, payload, 0, pb.data(), (uint32_t)pb.size());
+    return pb;
+}
+
+} // anonymous namespace
+
+TEST(TelemetryPipeline, EncodesSensorDataProtobuf) {
+    TelemetrySample s;
+    s.setSensor(sensor(1000, 24.5f, -1, 64, 16384));
+    s.setLight(light(300, 0));
+    s.encode();
+
+    // temp_x10 245 → zz 490; ax -1 → zz 1; ay 64 → zz 128; az 16384 → zz 32768
+    const uint8_t expect[] = {
+        0x08, 0xEA, 0x03,
+        0x10, 0x01,
+        0x18, 0x80, 0x01,
+        0x20, 0x80, 0x80, 0x02,
+        0x28, 0xAC, 0x02,
+        0x30, 0x00,
+    };
+    ASSERT_EQ(s.pbLen, sizeof(expect));
+    EXPECT_EQ(0, std::memcmp(s.pb, expect, sizeof(expect)));
+
+    int32_t v[TelemetrySample::FIELDS];
+    s.values(v);
+    EXPECT_EQ(v[0], 245);
+    EXPECT_EQ(v[3], 16384);
+    EXPECT_EQ(v[4], 300);
+}
+
+TEST(TelemetryPipeline, WorstCaseFitsMaxPb) {
+    TelemetrySample s;
+    s.setSensor(sensor(0, -1.0e6f, -32768, -32768, -32768));
+    s.setLight(light(65535, 65535));
+    s.encode();
+    EXPECT_EQ(s.pbLen, TelemetrySample::MAX_PB);
+    EXPECT_EQ(s.tempX10(), -32768);
+}
+
+TEST(TelemetryPipeline, MergesSensorAndLightIntoOneSlot) {
+    auto& p = TelemetryPipeline::getInstance();
+    TelemetrySample before;
+    p.latest(before);
+
+    p.update(sensor(5000, 20.0f, 1, 2, 3));
+    p.update(light(77, 8));
+
+    TelemetrySample s;
+    p.latest(s);
+    EXPECT_EQ(s.seq, before.seq + 2);
+    EXPECT_EQ(s.ts, 5000u);
+    EXPECT_EQ(s.ax, 1);
+    EXPECT_EQ(s.als, 77u);
+
+    TelemetrySample ref;
+    ref.setSensor(sensor(5000, 20.0f, 1, 2, 3));
+    ref.setLight(light(77, 8));
+    ref.encode();
+    ASSERT_EQ(s.pbLen, ref.pbLen);
+    EXPECT_EQ(0, std::memcmp(s.pb, ref.pb, ref.pbLen));
+}
+
+TEST(TelemetryPipeline, AttachedObservablesFillTheSlot) {
+    arcana::Observable<SensorDataModel> sensors("s");
+    arcana::Observable<LightDataModel> lights("l");
+    auto& p = TelemetryPipeline::getInstance();
+    p.attach(&sensors, &lights);
+
+    SensorDataModel m = sensor(9000, 18.2f, -5, 6, -7);
+    sensors.notify(&m);
+    LightDataModel l = light(1234, 56);
+    lights.notify(&l);
+
+    TelemetrySample s;
+    p.latest(s);
+    EXPECT_EQ(s.ts, 9000u);
+    EXPECT_EQ(s.az, -7);
+    EXPECT_EQ(s.ps, 56u);
+}
+
+TEST(TelemetryPipeline, SealDecryptsToTheEncodedSample) {
+    auto& p = TelemetryPipeline::getInstance();
+    p.update(sensor(12000, 21.0f, 100, -200, 300));
+    TelemetrySample s;
+    p.latest(s);
+
+    uint8_t frame[TelemetryPipeline::MAX_FRAME];
+    uint16_t len = 0;
+    ASSERT_TRUE(p.seal(s, KEY_A, frame, sizeof(frame), len));
+
+    uint8_t sid = 0;
+    std::vector<uint8_t> pb = openFrame(frame, len, KEY_A, sid);
+    EXPECT_EQ(sid, TelemetryPipeline::SID_SENSOR);
+    ASSERT_EQ(pb.size(), s.pbLen);
+    EXPECT_EQ(0, std::memcmp(pb.data(), s.pb, s.pbLen));
+
+    uint8_t small[16];
+    EXPECT_FALSE(p.seal(s, KEY_A, small, sizeof(small), len));
+}
+
+TEST(TelemetryPipeline, SameKeyReusesCiphertextOtherKeyReencrypts) {
+    auto& p = TelemetryPipeline::getInstance();
+    p.update(sensor(13000, 22.0f, 1, 1, 1));
+    TelemetrySample s;
+    p.latest(s);
+
+    uint8_t a1[TelemetryPipeline::MAX_FRAME], a2[TelemetryPipeline::MAX_FRAME];
+    uint8_t b[TelemetryPipeline::MAX_FRAME];
+    uint16_t la1, la2, lb;
+    ASSERT_TRUE(p.seal(s, KEY_A, a1, sizeof(a1), la1));
+    ASSERT_TRUE(p.seal(s, KEY_A, a2, sizeof(a2), la2));
+    ASSERT_TRUE(p.seal(s, KEY_B, b, sizeof(b), lb));
+    ASSERT_EQ(la1, la2);
+    EXPECT_EQ(0, std::memcmp(a1, a2, la1));
+    EXPECT_NE(0, std::memcmp(a1, b, la1));
+
+    uint8_t sid;
+    std::vector<uint8_t> pb = openFrame(b, lb, KEY_B, sid);
+    ASSERT_EQ(pb.size(), s.pbLen);
+    EXPECT_EQ(0, std::memcmp(pb.data(), s.pb, s.pbLen));
+
+    // A new reading changes the nonce, so nothing is reused across samples
+    p.update(light(1, 1));
+    TelemetrySample next;
+    p.latest(next);
+    uint8_t c[TelemetryPipeline::MAX_FRAME];
+    uint16_t lc;
+    ASSERT_TRUE(p.seal(next, KEY_A, c, sizeof(c), lc));
+    const size_t nonceAt = FrameCodec::kOverhead - 2;   // after the 7-byte header
+    EXPECT_NE(0, std::memcmp(a1 + nonceAt, c + nonceAt, 12));
+}
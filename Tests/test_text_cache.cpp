@@ -0,0 +1,280 @@
+/**
+ * @file test_text_cache.cpp
+ * @brief Host coverage for GlyphRunCache + TextDiff and the Ili9341Lcd
+ *        drawString path built on them.
+ *
+ * Driver tests link the REAL Ili9341Lcd.cpp; the HAL DMA mock records one
+ * descriptor per transfer, so the number and length of transfers show
+ * which characters a drawString actually sent.
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+
+#include "stm32f1xx_hal.h"
+#include "Ili9341Lcd.hpp"
+#include "TextCache.hpp"
+
+namespace arcana { namespace lcd {
+/* Friend struct — jumps the LRU clocks to just before the wrap */
+struct TextCacheTestAccess {
+    static void setStamp(GlyphRunCache& c, uint32_t v) { c.mStamp = v; }
+    static void setStamp(TextDiff& d, uint32_t v)      { d.mStamp = v; }
+};
+}}
+
+using arcana::lcd::GlyphRunCache;
+using arcana::lcd::TextDiff;
+using arcana::lcd::Ili9341Lcd;
+using arcana::lcd::TextCacheTestAccess;
+
+// ── GlyphRunCache ──────────────────────────────────────────────────────────
+
+TEST(GlyphRunCacheTest, RowBitsTransposesColumnFont) {
+    // '-' is {0x08 x5}: row 3 fully set, others empty
+    EXPECT_EQ(GlyphRunCache::rowBits('-', 3), 0x1F);
+    EXPECT_EQ(GlyphRunCache::rowBits('-', 2), 0x00);
+    // '!' is {0x00,0x00,0x5F,0x00,0x00}: only column 2
+    EXPECT_EQ(GlyphRunCache::rowBits('!', 0), 0x04);
+    EXPECT_EQ(GlyphRunCache::rowBits('!', 5), 0x00);
+    // Out of range renders as '?'
+    EXPECT_EQ(GlyphRunCache::rowBits('\x01', 0), GlyphRunCache::rowBits('?', 0));
+}
+
+TEST(GlyphRunCacheTest, RunsExpandPatternAtScale) {
+    GlyphRunCache cache;
+    int8_t slot = cache.acquire(2, 0xFFFF, 0x0000);
+    ASSERT_GE(slot, 0);
+
+    const uint16_t* r = cache.run(slot, 0x05);   // columns 0 and 2
+    const uint16_t expect[12] = {
+        0xFFFF, 0xFFFF, 0, 0, 0xFFFF, 0xFFFF, 0, 0, 0, 0, 0, 0 };
+    EXPECT_EQ(memcmp(r, expect, sizeof(expect)), 0);
+
+    // The gap column is always background, even for a full row
+    const uint16_t* full = cache.run(slot, 0x1F);
+    EXPECT_EQ(full[9], 0xFFFF);
+    EXPECT_EQ(full[10], 0x0000);
+    EXPECT_EQ(full[11], 0x0000);
+}
+
+TEST(GlyphRunCacheTest, HitReusesSlotAndLruEvicts) {
+    GlyphRunCache cache;
+    int8_t a = cache.acquire(1, 1, 0);
+    int8_t b = cache.acquire(2, 2, 0);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(cache.acquire(1, 1, 0), a);
+    EXPECT_EQ(cache.hits(), 1u);
+    EXPECT_EQ(cache.misses(), 2u);
+
+    // b is now least recently used
+    EXPECT_EQ(cache.acquire(1, 3, 0), b);
+    EXPECT_EQ(cache.acquire(1, 1, 0), a);
+}
+
+TEST(GlyphRunCacheTest, LruSurvivesStampWrap) {
+    GlyphRunCache cache;
+    TextCacheTestAccess::setStamp(cache, 0xFFFFFFFEu);
+    int8_t a = cache.acquire(1, 1, 0);               // stamp 0xFFFFFFFF
+    int8_t b = cache.acquire(2, 2, 0);               // stamp 0 (wrapped)
+    EXPECT_NE(a, b);
+
+    // a is least recently used even though its stamp is the largest
+    EXPECT_EQ(cache.acquire(1, 3, 0), a);
+    EXPECT_EQ(cache.acquire(2, 2, 0), b);
+    EXPECT_EQ(cache.misses(), 3u);
+}
+
+TEST(GlyphRunCacheTest, LargeScaleNotCached) {
+    GlyphRunCache cache;
+    EXPECT_EQ(cache.acquire(GlyphRunCache::MAX_SCALE + 1, 1, 0), -1);
+    EXPECT_EQ(cache.acquire(0, 1, 0), -1);
+}
+
+// ── TextDiff ───────────────────────────────────────────────────────────────
+
+namespace {
+TextDiff::Span put(TextDiff& d, uint16_t x, uint16_t y, const char* s,
+                   uint8_t scale = 1, uint16_t fg = 1, uint16_t bg = 0) {
+    return d.update(x, y, s, (uint8_t)strlen(s), scale, fg, bg);
+}
+} // anonymous
+
+TEST(TextDiffTest, FirstDrawIsFullSpan) {
+    TextDiff d;
+    TextDiff::Span s = put(d, 10, 10, "12:34:56");
+    EXPECT_EQ(s.first, 0);
+    EXPECT_EQ(s.count, 8);
+}
+
+TEST(TextDiffTest, UnchangedStringDrawsNothing) {
+    TextDiff d;
+    put(d, 10, 10, "12:34:56");
+    EXPECT_EQ(put(d, 10, 10, "12:34:56").count, 0);
+}
+
+TEST(TextDiffTest, SpanCoversFirstToLastChange) {
+    TextDiff d;
+    put(d, 10, 10, "12:34:59");
+    TextDiff::Span s = put(d, 10, 10, "12:35:00");
+    EXPECT_EQ(s.first, 4);
+    EXPECT_EQ(s.count, 4);
+}
+
+TEST(TextDiffTest, LongerStringIncludesNewTail) {
+    TextDiff d;
+    put(d, 0, 0, "99");
+    TextDiff::Span s = put(d, 0, 0, "990");
+    EXPECT_EQ(s.first, 2);
+    EXPECT_EQ(s.count, 1);
+}
+
+TEST(TextDiffTest, StyleChangeRedrawsAll) {
+    TextDiff d;
+    put(d, 0, 0, "abc", 1, 1, 0);
+    EXPECT_EQ(put(d, 0, 0, "abc", 1, 2, 0).count, 3);   // fg
+    EXPECT_EQ(put(d, 0, 0, "abc", 2, 2, 0).count, 3);   // scale
+}
+
+TEST(TextDiffTest, InvalidateForgetsOverlappingOrigins) {
+    TextDiff d;
+    put(d, 20, 40, "abc");              // 18 x 7 at (20,40)
+    put(d, 20, 80, "xyz");
+    d.invalidate(30, 45, 4, 1);         // touches the first only
+    EXPECT_EQ(put(d, 20, 40, "abc").count, 3);
+    EXPECT_EQ(put(d, 20, 80, "xyz").count, 0);
+
+    d.invalidate(0, 47, 240, 10);       // just below the first
+    EXPECT_EQ(put(d, 20, 40, "abc").count, 0);
+}
+
+TEST(TextDiffTest, OverlappingTextDropsOtherOrigin) {
+    TextDiff d;
+    put(d, 78, 0, "UPTIME", 2);
+    put(d, 60, 0, "2026-10-18", 2);
+    EXPECT_EQ(put(d, 78, 0, "UPTIME", 2).count, 6);
+}
+
+TEST(TextDiffTest, ClearForgetsEverything) {
+    TextDiff d;
+    put(d, 0, 0, "abc");
+    d.clear();
+    EXPECT_EQ(put(d, 0, 0, "abc").count, 3);
+}
+
+TEST(TextDiffTest, OverlongStringNotTracked) {
+    TextDiff d;
+    char s[TextDiff::MAX_LEN + 2];
+    memset(s, 'a', sizeof(s) - 1);
+    s[sizeof(s) - 1] = '\0';
+    EXPECT_EQ(put(d, 0, 0, s).count, TextDiff::MAX_LEN + 1);
+    EXPECT_EQ(put(d, 0, 0, s).count, TextDiff::MAX_LEN + 1);
+}
+
+TEST(TextDiffTest, FullTableEvictsLeastRecent) {
+    TextDiff d;
+    for (uint8_t i = 0; i < TextDiff::ENTRIES; i++) put(d, 0, (uint16_t)(i * 10), "a");
+    put(d, 0, 0, "a");                                   // refresh entry 0
+    put(d, 100, 0, "b");                                 // evicts y=10
+    EXPECT_EQ(put(d, 0, 0, "a").count, 0);
+    EXPECT_EQ(put(d, 0, 10, "a").count, 1);
+}
+
+TEST(TextDiffTest, EvictionOrderSurvivesStampWrap) {
+    TextDiff d;
+    TextCacheTestAccess::setStamp(d, 0xFFFFFFFFu - TextDiff::ENTRIES / 2);
+    for (uint8_t i = 0; i < TextDiff::ENTRIES; i++) put(d, 0, (uint16_t)(i * 10), "a");
+    put(d, 0, 0, "a");                                   // refresh y=0 past the wrap
+    put(d, 100, 0, "b");                                 // evicts y=10, the oldest
+    EXPECT_EQ(put(d, 0, 0, "a").count, 0);
+    EXPECT_EQ(put(d, 0, 150, "a").count, 0);             // newest kept
+    EXPECT_EQ(put(d, 0, 10, "a").count, 1);
+}
+
+// ── Ili9341Lcd::drawString ─────────────────────────────────────────────────
+
+namespace {
+
+class LcdTextTest : public ::testing::Test {
+protected:
+    static Ili9341Lcd& lcd() {
+        static Ili9341Lcd sLcd;
+        static bool sInit = false;
+        if (!sInit) { sLcd.initHAL(); sInit = true; }
+        return sLcd;
+    }
+
+    void SetUp() override {
+        lcd().fillScreen(0x0000);          // also forgets tracked text
+        arcana_test_dma_count = 0;
+        memset(arcana_test_dma_log, 0, sizeof(arcana_test_dma_log));
+    }
+};
+
+} // anonymous
+
+TEST_F(LcdTextTest, StringIsOneWindowOfPackedRows) {
+    // 8 chars at scale 2 = 96 px wide, 14 px rows → 2 rows per transfer
+    lcd().drawString(72, 304, "00:00:00", 0xFFE0, 0x0000, 2);
+    ASSERT_EQ(arcana_test_dma_count, 7u);
+    for (uint32_t i = 0; i < 7; i++) {
+        EXPECT_EQ(arcana_test_dma_log[i].length, 192u);
+        EXPECT_EQ(arcana_test_dma_log[i].srcInc, 1u);
+    }
+    EXPECT_NE(arcana_test_dma_log[0].src, arcana_test_dma_log[1].src);
+}
+
+TEST_F(LcdTextTest, RedrawSameStringSendsNothing) {
+    lcd().drawString(72, 304, "00:00:00", 0xFFE0, 0x0000, 2);
+    arcana_test_dma_count = 0;
+    lcd().drawString(72, 304, "00:00:00", 0xFFE0, 0x0000, 2);
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+}
+
+TEST_F(LcdTextTest, OnlyChangedSpanIsSent) {
+    lcd().drawString(72, 304, "12:34:59", 0xFFE0, 0x0000, 2);
+    arcana_test_dma_count = 0;
+    lcd().drawString(72, 304, "12:35:00", 0xFFE0, 0x0000, 2);
+    // 4 chars = 48 px wide: 5 rows per line buffer, 14 rows
+    ASSERT_EQ(arcana_test_dma_count, 3u);
+    EXPECT_EQ(arcana_test_dma_log[0].length, 5u * 48u);
+    EXPECT_EQ(arcana_test_dma_log[2].length, 4u * 48u);
+}
+
+TEST_F(LcdTextTest, NarrowSpanUsesCpu) {
+    lcd().drawString(72, 304, "12:34:56", 0xFFE0, 0x0000, 2);
+    arcana_test_dma_count = 0;
+    lcd().drawString(72, 304, "12:34:57", 0xFFE0, 0x0000, 2);   // 12 px
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_EQ(arcana_test_lcd_data, 0x0000);   // last pixel is the gap column
+}
+
+TEST_F(LcdTextTest, FillOverTextForcesRedraw) {
+    lcd().drawString(20, 42, "23.5 C", 0xFFE0, 0x0000, 2);
+    lcd().fillRect(20, 42, 180, 16, 0x0000);
+    arcana_test_dma_count = 0;
+    lcd().drawString(20, 42, "23.5 C", 0xFFE0, 0x0000, 2);
+    EXPECT_EQ(arcana_test_dma_count, 5u);      // 14 rows of 72 px, 3 per buffer
+}
+
+TEST_F(LcdTextTest, ShortScaleOneLabelUsesCpu) {
+    lcd().drawString(0, 0, "HR 72", 0xFFFF, 0x0000, 1);   // 30 x 7 = 210 px
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_EQ(arcana_test_lcd_data, 0x0000);   // gap column
+}
+
+TEST_F(LcdTextTest, LargeScaleFallsBackToGlyphs) {
+    // Scale 3: per-character windows through drawChar (18x21 = 378 px each)
+    lcd().drawString(0, 0, "AB", 0xFFFF, 0x0000, 3);
+    EXPECT_EQ(arcana_test_dma_count, 4u);      // 240 + 138 per glyph
+    arcana_test_dma_count = 0;
+    lcd().drawString(0, 0, "AB", 0xFFFF, 0x0000, 3);
+    EXPECT_EQ(arcana_test_dma_count, 4u);      // not tracked
+}
+
+TEST_F(LcdTextTest, ClipsToScreenWidth) {
+    // From x=228 only two 6 px cells fit
+    lcd().drawString(228, 0, "abcdef", 0xFFFF, 0x0000, 1);
+    EXPECT_EQ(arcana_test_dma_count, 0u);      // 12 px → CPU path
+    lcd().drawString(0, Ili9341Lcd::HEIGHT - 4, "abc", 0xFFFF, 0x0000, 1);
+    EXPECT_EQ(arcana_test_dma_count, 0u);      // row does not fit
+}
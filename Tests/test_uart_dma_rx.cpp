@@ -0,0 +1,206 @@
+/**
+ * @file test_uart_dma_rx.cpp
+ * @brief UartDmaRx: circular RX ring accounting against a simulated DMA
+ *        counter (mocks/SimUartDma) — spans, wrap, HT/TC/IDLE events,
+ *        overrun detection and peak fill.
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+
+#include "stm32f1xx_hal.h"
+#include "UartDmaRx.hpp"
+#include "SimUartDma.hpp"
+
+using arcana::UartDmaRx;
+using arcana::UartRxSpan;
+using arcana::test::SimUartDma;
+
+namespace {
+
+void onData(void* ctx) { (*static_cast<int*>(ctx))++; }
+
+/** Everything readable, both spans if wrapped, consumed */
+std::string readAll(UartDmaRx& rx) {
+    std::string out;
+    for (;;) {
+        UartRxSpan s = rx.span();
+        if (s.len == 0) return out;
+        out.append(reinterpret_cast<const char*>(s.data), s.len);
+        rx.consume(s.len);
+    }
+}
+
+class UartDmaRxTest : public ::testing::Test {
+protected:
+    static constexpr uint16_t RING = 16;
+
+    void SetUp() override {
+        sim = &SimUartDma::instance();
+        sim->htEvents = 0;
+        sim->tcEvents = 0;
+        huart = UART_HandleTypeDef();
+        huart.Instance = USART3;
+        USART3->CR3 = 0;
+        hdma = DMA_HandleTypeDef();
+        hdma.Instance = DMA1_Channel3;
+        memset(ring, 0, sizeof(ring));
+        ASSERT_TRUE(rx.start(&huart, &hdma, onData, &notified));
+    }
+    void TearDown() override { rx.stop(); }
+
+    SimUartDma* sim = nullptr;
+    UART_HandleTypeDef huart;
+    DMA_HandleTypeDef hdma;
+    uint8_t ring[RING];
+    UartDmaRx rx{ring, RING};
+    int notified = 0;
+};
+
+} // namespace
+
+TEST_F(UartDmaRxTest, StartRunsCircularChannelFromDr) {
+    EXPECT_EQ(hdma.Instance->CCR & DMA_CIRCULAR, DMA_CIRCULAR);
+    EXPECT_EQ(hdma.Instance->CCR & DMA_CCR_MINC, DMA_CCR_MINC);
+    EXPECT_EQ(hdma.Instance->CCR & DMA_CCR_PINC, 0u);
+    EXPECT_EQ(hdma.Instance->CNDTR, (uint32_t)RING);
+    EXPECT_EQ(hdma.Instance->CPAR, (uint32_t)(uintptr_t)&USART3->DR);
+    EXPECT_EQ(USART3->CR3 & USART_CR3_DMAR, USART_CR3_DMAR);
+    EXPECT_EQ(rx.available(), 0u);
+}
+
+TEST_F(UartDmaRxTest, RingMustBeAPowerOfTwo) {
+    uint8_t odd[12];
+    UartDmaRx bad(odd, sizeof(odd));
+    DMA_HandleTypeDef h = DMA_HandleTypeDef();
+    h.Instance = DMA1_Channel6;
+    EXPECT_FALSE(bad.start(&huart, &h, nullptr, nullptr));
+}
+
+TEST_F(UartDmaRxTest, BytesAreInvisibleUntilAnEvent) {
+    ASSERT_TRUE(sim->receive(USART3, "OK\r\n"));
+    // No per-byte interrupt: nothing accounted until IDLE
+    EXPECT_EQ(rx.available(), 0u);
+    EXPECT_EQ(notified, 0);
+
+    EXPECT_TRUE(rx.isr_update());          // USART IDLE
+    EXPECT_EQ(rx.available(), 4u);
+    UartRxSpan s = rx.span();
+    ASSERT_EQ(s.len, 4u);
+    EXPECT_EQ(s.data, ring);               // zero-copy: points into the ring
+    EXPECT_EQ(memcmp(s.data, "OK\r\n", 4), 0);
+    rx.consume(4);
+    EXPECT_EQ(rx.available(), 0u);
+    // A second IDLE with no new bytes reports nothing
+    EXPECT_FALSE(rx.isr_update());
+    EXPECT_EQ(rx.events(), 2u);
+}
+
+TEST_F(UartDmaRxTest, HalfAndFullTransferWakeTheConsumer) {
+    ASSERT_TRUE(sim->receive(USART3, "0123456789abcdef"));
+    EXPECT_EQ(sim->htEvents, 1u);
+    EXPECT_EQ(sim->tcEvents, 1u);
+    EXPECT_EQ(notified, 2);
+    EXPECT_EQ(rx.received(), 16u);
+    EXPECT_EQ(readAll(rx), "0123456789abcdef");
+}
+
+TEST_F(UartDmaRxTest, WrappedRunComesOutAsTwoSpans) {
+    ASSERT_TRUE(sim->receive(USART3, "............"));
+    rx.isr_update();
+    EXPECT_EQ(readAll(rx).size(), 12u);
+
+    ASSERT_TRUE(sim->receive(USART3, "ABCDEFGHIJ"));   // 4 to the end, 6 wrapped
+    rx.isr_update();
+    EXPECT_EQ(rx.available(), 10u);
+    UartRxSpan first = rx.span();
+    EXPECT_EQ(first.data, ring + 12);
+    EXPECT_EQ(first.len, 4u);
+    rx.consume(first.len);
+    UartRxSpan second = rx.span();
+    EXPECT_EQ(second.data, ring);
+    EXPECT_EQ(second.len, 6u);
+    EXPECT_EQ(std::string((const char*)first.data, 4) +
+              std::string((const char*)second.data, 6), "ABCDEFGHIJ");
+    rx.consume(second.len);
+    EXPECT_EQ(sim->position(USART3), 6u);
+}
+
+TEST_F(UartDmaRxTest, PartialConsumeKeepsTheRest) {
+    ASSERT_TRUE(sim->receive(USART3, "frame"));
+    rx.isr_update();
+    rx.consume(2);
+    EXPECT_EQ(readAll(rx), "ame");
+    rx.consume(10);                        // clamped to what is there
+    EXPECT_EQ(rx.available(), 0u);
+}
+
+TEST_F(UartDmaRxTest, LappedReaderCountsOverrunAndDropsBacklog) {
+    // HT/TC keep accounting but nobody reads: 40 bytes into a 16-byte ring
+    std::string burst(40, 'x');
+    ASSERT_TRUE(sim->receive(USART3, burst.c_str()));
+    rx.isr_update();
+    EXPECT_EQ(rx.received(), 40u);
+    EXPECT_EQ(rx.peakFill(), RING);
+
+    EXPECT_EQ(rx.available(), 0u);         // resynced to the writer
+    EXPECT_EQ(rx.overruns(), 1u);
+    EXPECT_EQ(rx.lostBytes(), 40u);
+
+    // Reception carries on from the new position
+    ASSERT_TRUE(sim->receive(USART3, "next"));
+    rx.isr_update();
+    EXPECT_EQ(readAll(rx), "next");
+    EXPECT_EQ(rx.overruns(), 1u);
+}
+
+TEST_F(UartDmaRxTest, FullRingIsNotAnOverrun) {
+    ASSERT_TRUE(sim->receive(USART3, "0123456789abcdef"));
+    EXPECT_EQ(rx.available(), 16u);
+    EXPECT_EQ(rx.overruns(), 0u);
+    EXPECT_EQ(readAll(rx), "0123456789abcdef");
+}
+
+TEST_F(UartDmaRxTest, PeakFillIsTheHighestBacklogAtAnEvent) {
+    ASSERT_TRUE(sim->receive(USART3, "abcdef"));
+    rx.isr_update();
+    EXPECT_EQ(rx.peakFill(), 6u);
+    readAll(rx);
+    ASSERT_TRUE(sim->receive(USART3, "abc"));
+    rx.isr_update();
+    EXPECT_EQ(rx.peakFill(), 6u);          // 3 unread < previous peak
+    ASSERT_TRUE(sim->receive(USART3, "defghijk"));   // TC at 16: 11 unread
+    EXPECT_EQ(rx.peakFill(), 10u);
+    rx.isr_update();
+    EXPECT_EQ(rx.peakFill(), 11u);
+}
+
+TEST_F(UartDmaRxTest, FlushDropsBytesNotYetAccounted) {
+    ASSERT_TRUE(sim->receive(USART3, "stale"));
+    rx.flush();
+    EXPECT_EQ(rx.available(), 0u);
+    EXPECT_FALSE(rx.isr_update());
+    ASSERT_TRUE(sim->receive(USART3, "fresh"));
+    rx.isr_update();
+    EXPECT_EQ(readAll(rx), "fresh");
+}
+
+TEST_F(UartDmaRxTest, UartOverrunsAreCountedSeparately) {
+    rx.isr_onUartOverrun();
+    rx.isr_onUartOverrun();
+    EXPECT_EQ(rx.uartOverruns(), 2u);
+    EXPECT_EQ(rx.overruns(), 0u);
+}
+
+TEST_F(UartDmaRxTest, StopAbortsAndRestartBeginsEmpty) {
+    ASSERT_TRUE(sim->receive(USART3, "abc"));
+    rx.stop();
+    EXPECT_FALSE(sim->receive(USART3, "lost"));
+    EXPECT_FALSE(rx.isr_update());
+
+    ASSERT_TRUE(rx.start(&huart, &hdma, onData, &notified));
+    EXPECT_EQ(rx.available(), 0u);
+    ASSERT_TRUE(sim->receive(USART3, "new"));
+    rx.isr_update();
+    EXPECT_EQ(readAll(rx), "new");
+}
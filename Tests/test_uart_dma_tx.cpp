@@ -0,0 +1,202 @@
+/**
+ * @file test_uart_dma_tx.cpp
+ * @brief UartDmaTx: gather-list transmit — segments chained from the DMA
+ *        TC callback, TXE-fed fallback, busy/timeout/abort handling and
+ *        task-notification completion.
+ *
+ * The DMA mock completes a transfer inside HAL_DMA_Start_IT unless
+ * arcana_test_dma_hold is set; the hook below captures what the channel
+ * would have clocked out of memory into DR.
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+
+#include "stm32f1xx_hal.h"
+#include "UartDmaTx.hpp"
+
+using arcana::UartDmaTx;
+using arcana::UartTxSeg;
+
+typedef uint32_t (*UlTaskNotifyTakeFn)(BaseType_t, TickType_t);
+extern UlTaskNotifyTakeFn g_ulTaskNotifyTakeOverride;
+
+namespace {
+
+std::string gWire;
+
+void captureDma(DMA_HandleTypeDef*, uintptr_t src, uintptr_t, uint32_t length) {
+    gWire.append(reinterpret_cast<const char*>(src), length);
+}
+
+UartDmaTx* gIrqTx = nullptr;
+int gTakes = 0;
+
+/** The task sleeps; meanwhile the USART drains the list byte by byte */
+uint32_t pumpTxe(BaseType_t, TickType_t) {
+    gTakes++;
+    while (gIrqTx->busy()) {
+        gIrqTx->isr_onTxe();
+        gWire.push_back((char)USART2->DR);
+    }
+    return 1;
+}
+
+uint32_t sleepOnly(BaseType_t, TickType_t) { return 0; }
+
+UartTxSeg seg(const char* s) {
+    UartTxSeg x = { s, (uint16_t)strlen(s) };
+    return x;
+}
+
+class UartDmaTxTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        gWire.clear();
+        gTakes = 0;
+        arcana_test_dma_count = 0;
+        arcana_test_dma_hold = 0;
+        arcana_test_dma_hook = captureDma;
+        g_ulTaskNotifyTakeOverride = nullptr;
+        huart = UART_HandleTypeDef();
+        huart.Instance = USART3;
+        USART3->CR1 = 0;
+        USART3->CR3 = 0;
+        hdma = DMA_HandleTypeDef();
+        hdma.Instance = DMA1_Channel2;
+        ASSERT_TRUE(tx.start(&huart, &hdma));
+    }
+    void TearDown() override {
+        arcana_test_dma_hook = nullptr;
+        arcana_test_dma_hold = 0;
+        g_ulTaskNotifyTakeOverride = nullptr;
+    }
+
+    UART_HandleTypeDef huart;
+    DMA_HandleTypeDef hdma;
+    UartDmaTx tx;
+};
+
+} // namespace
+
+TEST_F(UartDmaTxTest, StartConfiguresMemoryToDr) {
+    EXPECT_TRUE(hdma.Instance->CCR & DMA_MEMORY_TO_PERIPH);
+    EXPECT_TRUE(hdma.Instance->CCR & DMA_CCR_MINC);
+    EXPECT_FALSE(hdma.Instance->CCR & DMA_CIRCULAR);
+    EXPECT_EQ(hdma.Parent, &tx);
+    EXPECT_FALSE(tx.start(nullptr, &hdma));
+}
+
+TEST_F(UartDmaTxTest, SegmentsChainWithoutCopy) {
+    const char* hdr = "HDR:";
+    const char* body = "payload";
+    const char* tail = "\r\n";
+    UartTxSeg segs[3] = { seg(hdr), seg(body), seg(tail) };
+    EXPECT_TRUE(tx.send(segs, 3, 100));
+
+    // One channel start per segment, each straight from the caller's buffer
+    ASSERT_EQ(arcana_test_dma_count, 3u);
+    EXPECT_EQ(arcana_test_dma_log[0].src, (uint32_t)(uintptr_t)hdr);
+    EXPECT_EQ(arcana_test_dma_log[1].src, (uint32_t)(uintptr_t)body);
+    EXPECT_EQ(arcana_test_dma_log[2].src, (uint32_t)(uintptr_t)tail);
+    EXPECT_EQ(arcana_test_dma_log[1].length, 7u);
+    EXPECT_EQ(arcana_test_dma_log[0].dst, (uint32_t)(uintptr_t)&USART3->DR);
+    EXPECT_EQ(gWire, "HDR:payload\r\n");
+
+    EXPECT_FALSE(tx.busy());
+    EXPECT_FALSE(USART3->CR3 & USART_CR3_DMAT);
+    EXPECT_EQ(tx.bytesSent(), 13u);
+    EXPECT_EQ(tx.sends(), 1u);
+}
+
+TEST_F(UartDmaTxTest, EmptySegmentsAreSkipped) {
+    UartTxSeg segs[3] = { seg("a"), { "x", 0 }, seg("b") };
+    EXPECT_TRUE(tx.send(segs, 3, 100));
+    EXPECT_EQ(arcana_test_dma_count, 2u);
+    EXPECT_EQ(gWire, "ab");
+
+    // Nothing to send is a completed send
+    UartTxSeg none[1] = { { "x", 0 } };
+    EXPECT_TRUE(tx.send(none, 1, 100));
+    EXPECT_EQ(arcana_test_dma_count, 2u);
+    EXPECT_EQ(tx.sends(), 1u);
+}
+
+TEST_F(UartDmaTxTest, TooManySegmentsRejected) {
+    UartTxSeg segs[UartDmaTx::MAX_SEGS + 1];
+    for (auto& s : segs) s = seg("z");
+    EXPECT_FALSE(tx.submit(segs, UartDmaTx::MAX_SEGS + 1));
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_TRUE(tx.send(segs, UartDmaTx::MAX_SEGS, 100));
+    EXPECT_EQ(gWire, "zzzz");
+}
+
+TEST_F(UartDmaTxTest, AsyncSubmitCompletesFromTheDmaIrq) {
+    arcana_test_dma_hold = 1;
+    UartTxSeg segs[2] = { seg("one"), seg("two") };
+    ASSERT_TRUE(tx.submit(segs, 2));
+    EXPECT_TRUE(tx.busy());
+    EXPECT_TRUE(USART3->CR3 & USART_CR3_DMAT);
+    EXPECT_EQ(arcana_test_dma_count, 1u);
+
+    // A second list waits its turn
+    EXPECT_FALSE(tx.submit(segs, 1));
+
+    HAL_DMA_IRQHandler(&hdma);          // first segment done → second starts
+    EXPECT_EQ(arcana_test_dma_count, 2u);
+    EXPECT_TRUE(tx.busy());
+    HAL_DMA_IRQHandler(&hdma);
+    EXPECT_FALSE(tx.busy());
+    EXPECT_TRUE(tx.wait(100));
+    EXPECT_EQ(gWire, "onetwo");
+    EXPECT_EQ(tx.bytesSent(), 6u);
+}
+
+TEST_F(UartDmaTxTest, WaitTimeoutAbortsTheChannel) {
+    arcana_test_dma_hold = 1;
+    g_ulTaskNotifyTakeOverride = sleepOnly;
+    UartTxSeg segs[1] = { seg("stuck") };
+    EXPECT_FALSE(tx.send(segs, 1, 50));
+    EXPECT_FALSE(tx.busy());
+    EXPECT_EQ(hdma.Instance->CNDTR, 0u);
+    EXPECT_FALSE(USART3->CR3 & USART_CR3_DMAT);
+    EXPECT_EQ(tx.timeouts(), 1u);
+    EXPECT_EQ(tx.bytesSent(), 0u);
+
+    // The transmitter is usable again
+    arcana_test_dma_hold = 0;
+    EXPECT_TRUE(tx.send(segs, 1, 50));
+}
+
+TEST_F(UartDmaTxTest, ErrorCallbackFailsTheSend) {
+    arcana_test_dma_hold = 1;
+    UartTxSeg segs[1] = { seg("bad") };
+    ASSERT_TRUE(tx.submit(segs, 1));
+    hdma.XferErrorCallback(&hdma);
+    EXPECT_FALSE(tx.busy());
+    EXPECT_FALSE(tx.wait(100));
+    EXPECT_EQ(tx.timeouts(), 0u);
+}
+
+TEST_F(UartDmaTxTest, TxeFedModeWithoutDmaChannel) {
+    UART_HandleTypeDef u2 = UART_HandleTypeDef();
+    u2.Instance = USART2;
+    USART2->CR1 = 0;
+    UartDmaTx irq;
+    ASSERT_TRUE(irq.start(&u2, nullptr));
+    gIrqTx = &irq;
+    g_ulTaskNotifyTakeOverride = pumpTxe;
+
+    UartTxSeg segs[2] = { seg("AT+"), seg("NAME") };
+    EXPECT_TRUE(irq.send(segs, 2, 1000));   // the tick stub advances 100 per read
+    EXPECT_EQ(gWire, "AT+NAME");
+    EXPECT_EQ(arcana_test_dma_count, 0u);
+    EXPECT_FALSE(USART2->CR1 & USART_CR1_TXEIE);
+    EXPECT_EQ(irq.bytesSent(), 7u);
+    EXPECT_GE(gTakes, 1);
+
+    // A stray TXE with nothing queued just masks the interrupt
+    USART2->CR1 = USART2->CR1 | USART_CR1_TXEIE;
+    irq.isr_onTxe();
+    EXPECT_FALSE(USART2->CR1 & USART_CR1_TXEIE);
+}
@@ -0,0 +1,89 @@
+/**
+ * @file test_upload_chunk_sizer.cpp
+ * @brief UploadChunkSizer: retry back-off, regrowth, SD-bound stall
+ *        accounting and smoothed rates for the upload pipeline.
+ */
+#include <gtest/gtest.h>
+
+#include "UploadChunkSizer.hpp"
+
+using arcana::UploadChunkSizer;
+
+TEST(UploadChunkSizer, StartsAtBufferSizeAndClampsToRemaining) {
+    UploadChunkSizer s(2048);
+    EXPECT_EQ(s.chunk(), 2048u);
+    EXPECT_EQ(s.next(100000), 2048u);
+    EXPECT_EQ(s.next(700), 700u);
+    EXPECT_EQ(s.next(0), 0u);
+
+    // Never below the minimum, even for a tiny buffer
+    UploadChunkSizer tiny(100);
+    EXPECT_EQ(tiny.chunk(), 512u);
+}
+
+TEST(UploadChunkSizer, RetriesHalveDownToTheMinimum) {
+    UploadChunkSizer s(2048);
+    s.onReadRetry();
+    EXPECT_EQ(s.chunk(), 1024u);
+    s.onReadRetry();
+    EXPECT_EQ(s.chunk(), 512u);
+    s.onReadRetry();
+    EXPECT_EQ(s.chunk(), 512u);
+    EXPECT_EQ(s.retries(), 3u);
+}
+
+TEST(UploadChunkSizer, TxBoundStepsGrowBackSlowly) {
+    UploadChunkSizer s(2048);
+    s.onReadRetry();
+    s.onReadRetry();
+    // Read 2ms, send 20ms, task waited 18ms: TX is the bottleneck
+    for (int i = 0; i < UploadChunkSizer::GROW_AFTER - 1; i++) {
+        s.onStep(512, 2, 512, 20, 18);
+        EXPECT_EQ(s.chunk(), 512u);
+    }
+    s.onStep(512, 2, 512, 20, 18);
+    EXPECT_EQ(s.chunk(), 1024u);
+    EXPECT_EQ(s.sdStalls(), 0u);
+}
+
+TEST(UploadChunkSizer, SdBoundStepsGrowTwiceAsFast) {
+    UploadChunkSizer s(2048);
+    s.onReadRetry();
+    s.onReadRetry();
+    // Send was done before the read: waitMs 0, the wire idled on SD
+    s.onStep(512, 30, 512, 30, 0);
+    EXPECT_EQ(s.chunk(), 512u);
+    s.onStep(512, 30, 512, 30, 0);
+    EXPECT_EQ(s.chunk(), 1024u);
+    EXPECT_EQ(s.sdStalls(), 2u);
+
+    // Capped at the buffer size
+    for (int i = 0; i < 20; i++) s.onStep(1024, 30, 1024, 30, 0);
+    EXPECT_EQ(s.chunk(), 2048u);
+}
+
+TEST(UploadChunkSizer, RetryResetsGrowthCredit) {
+    UploadChunkSizer s(2048);
+    s.onReadRetry();
+    s.onStep(1024, 30, 1024, 30, 0);      // 2 credits
+    s.onReadRetry();                      // back to 512, credit lost
+    s.onStep(512, 30, 512, 30, 0);
+    EXPECT_EQ(s.chunk(), 512u);
+}
+
+TEST(UploadChunkSizer, RatesAreSmoothedBytesPerSecond) {
+    UploadChunkSizer s(2048);
+    EXPECT_EQ(s.sdRate(), 0u);
+    s.onStep(2048, 2, 2048, 20, 18);
+    EXPECT_EQ(s.sdRate(), 1024000u);
+    EXPECT_EQ(s.txRate(), 102400u);
+    // New samples move the average a quarter of the way
+    s.onStep(2048, 4, 2048, 20, 16);
+    EXPECT_EQ(s.sdRate(), (1024000u * 3 + 512000u) / 4);
+    EXPECT_EQ(s.txRate(), 102400u);
+    // A zero-tick step counts as 1ms rather than dividing by zero
+    UploadChunkSizer z(2048);
+    z.onStep(1000, 0, 1000, 0, 0);
+    EXPECT_EQ(z.sdRate(), 1000000u);
+    EXPECT_EQ(z.sdStalls(), 0u);
+}
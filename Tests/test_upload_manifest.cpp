@@ -0,0 +1,111 @@
+/**
+ * @file test_upload_manifest.cpp
+ * @brief UploadManifest: 4KB chunk digests fed piecewise, missing-range
+ *        list parsing/formatting and the byte spans ranges cover.
+ */
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "UploadManifest.hpp"
+
+using arcana::ChunkRange;
+using arcana::UploadManifest;
+
+namespace {
+
+std::vector<uint8_t> digest(const std::vector<uint8_t>& data, size_t piece) {
+    UploadManifest::Hasher h;
+    for (size_t off = 0; off < data.size(); off += piece) {
+        size_t n = data.size() - off < piece ? data.size() - off : piece;
+        h.update(data.data() + off, n);
+    }
+    std::vector<uint8_t> out(UploadManifest::DIGEST_SIZE);
+    h.finish(out.data());
+    return out;
+}
+
+} // namespace
+
+TEST(UploadManifest, SizesRoundUpToWholeChunks) {
+    EXPECT_EQ(UploadManifest::chunkCount(0), 0u);
+    EXPECT_EQ(UploadManifest::chunkCount(1), 1u);
+    EXPECT_EQ(UploadManifest::chunkCount(4096), 1u);
+    EXPECT_EQ(UploadManifest::chunkCount(4097), 2u);
+    EXPECT_EQ(UploadManifest::manifestSize(10000), 24u);
+}
+
+TEST(UploadManifest, DigestIsTruncatedSha256) {
+    // sha256(4096 zero bytes) = ad7facb2586fc6e9...
+    const uint8_t zeros[8] = { 0xad, 0x7f, 0xac, 0xb2, 0x58, 0x6f, 0xc6, 0xe9 };
+    std::vector<uint8_t> block(4096, 0);
+    EXPECT_EQ(digest(block, 4096), std::vector<uint8_t>(zeros, zeros + 8));
+    // Pieces of any size give the same digest
+    EXPECT_EQ(digest(block, 2048), std::vector<uint8_t>(zeros, zeros + 8));
+    EXPECT_EQ(digest(block, 100), std::vector<uint8_t>(zeros, zeros + 8));
+
+    // finish() leaves the hasher ready for the next chunk
+    const uint8_t abc[8] = { 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea };
+    UploadManifest::Hasher h;
+    uint8_t out[8];
+    h.update(block.data(), block.size());
+    h.finish(out);
+    h.update(reinterpret_cast<const uint8_t*>("abc"), 3);
+    h.finish(out);
+    EXPECT_EQ(memcmp(out, abc, 8), 0);
+}
+
+TEST(UploadManifest, ParsesRangeLists) {
+    ChunkRange r[UploadManifest::MAX_RANGES];
+    EXPECT_EQ(UploadManifest::parseRanges("", r, 16, 10), 0);
+    EXPECT_EQ(UploadManifest::parseRanges("\"", r, 16, 10), 0);
+
+    ASSERT_EQ(UploadManifest::parseRanges("0-3,7,9\",\"size\":1", r, 16, 10), 3);
+    EXPECT_EQ(r[0].first, 0u);
+    EXPECT_EQ(r[0].last, 3u);
+    EXPECT_EQ(r[1].first, 7u);
+    EXPECT_EQ(r[1].last, 7u);
+    EXPECT_EQ(r[2].first, 9u);
+    EXPECT_EQ(r[2].last, 9u);
+}
+
+TEST(UploadManifest, RejectsMalformedLists) {
+    ChunkRange r[4];
+    EXPECT_EQ(UploadManifest::parseRanges("1-", r, 4, 10), -1);
+    EXPECT_EQ(UploadManifest::parseRanges(",1", r, 4, 10), -1);
+    EXPECT_EQ(UploadManifest::parseRanges("1,,2", r, 4, 10), -1);
+    EXPECT_EQ(UploadManifest::parseRanges("3-1", r, 4, 10), -1);    // reversed
+    EXPECT_EQ(UploadManifest::parseRanges("4,2", r, 4, 10), -1);    // unordered
+    EXPECT_EQ(UploadManifest::parseRanges("1-3,3", r, 4, 10), -1);  // overlap
+    EXPECT_EQ(UploadManifest::parseRanges("10", r, 4, 10), -1);     // past the end
+    EXPECT_EQ(UploadManifest::parseRanges("1,2,3,4,5", r, 4, 10), -1);
+    EXPECT_EQ(UploadManifest::parseRanges("99999999999", r, 4, 10), -1);
+}
+
+TEST(UploadManifest, FormatRoundTrips) {
+    const ChunkRange in[3] = { { 0, 3 }, { 17, 17 }, { 40, 52 } };
+    char buf[32];
+    uint16_t n = UploadManifest::formatRanges(in, 3, buf, sizeof(buf));
+    EXPECT_STREQ(buf, "0-3,17,40-52");
+    EXPECT_EQ(n, 12u);
+
+    ChunkRange out[3];
+    ASSERT_EQ(UploadManifest::parseRanges(buf, out, 3, 53), 3);
+    EXPECT_EQ(out[2].first, 40u);
+    EXPECT_EQ(out[2].last, 52u);
+
+    // Too small: nothing usable
+    EXPECT_EQ(UploadManifest::formatRanges(in, 3, buf, 12), 0u);
+    EXPECT_EQ(UploadManifest::formatRanges(in, 0, buf, 1), 0u);
+    EXPECT_STREQ(buf, "");
+}
+
+TEST(UploadManifest, RangeBytesClipTheShortLastChunk) {
+    const uint32_t size = 5 * 4096 + 300;
+    const ChunkRange r[2] = { { 1, 1 }, { 4, 5 } };
+    EXPECT_EQ(UploadManifest::rangeOffset(r[1]), 16384u);
+    EXPECT_EQ(UploadManifest::rangeBytes(r[0], size), 4096u);
+    EXPECT_EQ(UploadManifest::rangeBytes(r[1], size), 4396u);
+    EXPECT_EQ(UploadManifest::totalBytes(r, 2, size), 8492u);
+    EXPECT_EQ(UploadManifest::totalChunks(r, 2), 3u);
+}
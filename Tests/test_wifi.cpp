@@ -110,6 +110,7 @@ TEST(WifiResetConnect, FirstAtSucceedsHappyPath) {
     /* AT command at 460800 succeeds on first try */
     esp.pushResponse("OK");          // AT
     esp.pushResponse("OK");          // AT+GMR
+    esp.pushResponse("OK");          // CIPMUX=1
     esp.pushResponse("OK");          // CWDHCP (in connectWifi)
     esp.pushResponse("OK");          // CWMODE
     esp.pushResponse("OK");          // CWJAP
@@ -126,6 +127,7 @@ TEST(WifiResetConnect, FallbackTo921kSucceeds) {
     esp.pushResponse("OK");          // AT+UART_DEF
     esp.pushResponse("OK");          // speedUp
     esp.pushResponse("OK");          // AT+GMR
+    esp.pushResponse("OK");          // CIPMUX=1
     esp.pushResponse("OK");          // CWDHCP
     esp.pushResponse("OK");          // CWMODE
     esp.pushResponse("OK");          // CWJAP
@@ -133,6 +135,16 @@ TEST(WifiResetConnect, FallbackTo921kSucceeds) {
     EXPECT_TRUE(wifi().resetAndConnect());
 }
 
+TEST(WifiResetConnect, MuxFailureBailsBeforeJoin) {
+    resetEnvironment();
+    auto& esp = Esp8266::getInstance();
+    esp.pushResponse("OK");          // AT
+    esp.pushResponse("OK");          // AT+GMR
+    esp.pushResponse("ERROR");       // CIPMUX=1
+    EXPECT_FALSE(wifi().resetAndConnect());
+    EXPECT_EQ(esp.sentCmds().back(), "AT+CIPMUX=1");
+}
+
 TEST(WifiResetConnect, AllBaudFallbacksFail) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
@@ -189,15 +201,18 @@ TEST(WifiTimezone, DetectTimezoneCipStartFailure) {
 TEST(WifiTimezone, DetectTimezoneAlreadyConnectedRecovers) {
     resetEnvironment();
     auto& esp = Esp8266::getInstance();
-    esp.pushResponse("ALREADY CONNECTED");  // CIPSTART
-    esp.pushResponse(">");                  // CIPSEND
-    esp.pushResponse("");                   // sendData
-    esp.pushResponse("HTTP/1.1 200 OK\r\n\r\n{\"offset\":28800}");  // waitFor "offset"
-    esp.pushResponse("OK");                 // CIPCLOSE
+    esp.pushResponse("ALREADY CONNECTED");  // CIPSTART=1
+    esp.pushResponse(">");                  // CIPSEND=1,n
+    esp.pushResponse("");                   // request bytes
+    esp.pushResponse("SEND OK");
+    esp.pushIpd(Esp8266::LINK_HTTP, "HTTP/1.1 200 OK\r\n\r\n{\"offset\":28800}");
+    esp.pushResponse("OK");                 // CIPCLOSE=1
 
     int16_t off = 0;
     EXPECT_TRUE(wifi().detectTimezone(off));
     EXPECT_EQ(off, 28800 / 60);  /* 480 minutes = UTC+8 */
+    EXPECT_EQ(esp.sentCmds().front(), "AT+CIPSTART=1,\"TCP\",\"ip-api.com\",80");
+    EXPECT_EQ(esp.sentCmds().back(), "AT+CIPCLOSE=1");
 }
 
 TEST(WifiTimezone, DetectTimezoneNegativeOffset) {
@@ -205,8 +220,11 @@ TEST(WifiTimezone, DetectTimezoneNegativeOffset) {
     auto& esp = Esp8266::getInstance();
     esp.pushResponse("OK");                 // CIPSTART
     esp.pushResponse(">");                  // CIPSEND
-    esp.pushResponse("");                   // sendData
-    esp.pushResponse("HTTP/1.1 200 OK\r\n\r\n{\"offset\":-18000}");
+    esp.pushResponse("");                   // request bytes
+    esp.pushResponse("SEND OK");
+    /* Key and value split across two +IPD segments */
+    esp.pushIpd(Esp8266::LINK_HTTP, "HTTP/1.1 200 OK\r\n\r\n{\"offset\":-18");
+    esp.pushIpd(Esp8266::LINK_HTTP, "000}");
     esp.pushResponse("OK");                 // CIPCLOSE
 
     int16_t off = 0;
@@ -222,6 +240,7 @@ TEST(WifiTimezone, DetectTimezoneCipSendFailureBails) {
     esp.pushResponse("OK");      // CIPCLOSE
     int16_t off = 99;
     EXPECT_FALSE(wifi().detectTimezone(off));
+    EXPECT_EQ(esp.sentCmds().back(), "AT+CIPCLOSE=1");
 }
 
 TEST(WifiTimezone, DetectTimezoneNoOffsetInResponse) {
@@ -230,10 +249,13 @@ TEST(WifiTimezone, DetectTimezoneNoOffsetInResponse) {
     esp.pushResponse("OK");
     esp.pushResponse(">");
     esp.pushResponse("");
-    esp.pushResponse("garbage no offset key here\r\n");  /* no "offset" → waitFor fails */
+    esp.pushResponse("SEND OK");
+    esp.pushIpd(Esp8266::LINK_HTTP, "garbage no offset key here\r\n");
+    esp.pushResponse("1,CLOSED\r\n");     /* server hangs up */
     esp.pushResponse("OK");      // CIPCLOSE
     int16_t off = 99;
     EXPECT_FALSE(wifi().detectTimezone(off));
+    EXPECT_EQ(off, 99);
 }
 
 // ── applyNtpEpoch real success path (covers lines 202-208) ──────────────────
@@ -15,7 +15,7 @@
  */
 
 import noble from '@abandonware/noble';
-import { FrameAssembler } from './protocol.js';
+import { FrameAssembler, MAX_RSP_FRAME } from './protocol.js';
 
 // HC-08 UUIDs (16-bit, lowercase for noble)
 const HC08_SERVICE_UUID = 'ffe0';
@@ -26,7 +26,7 @@ export class NobleBleTransport {
   constructor() {
     this.peripheral = null;
     this.characteristic = null;
-    this.assembler = new FrameAssembler(112); // KE response: 109B frame
+    this.assembler = new FrameAssembler(MAX_RSP_FRAME); // v2 batch response
     this.pendingResolve = null;
     this.pendingTimeout = null;
     this.connected = false;
@@ -17,13 +17,18 @@
  *   node index.js --monitor                          # serial debug monitor
  *   node index.js --list                             # list serial ports
  *   node index.js --auto                             # send all commands once
+ *   node index.js --ble --bench                      # round-trips/sec: v1 single vs v2 batch
+ *   node index.js --bench --bench-count 64 --batch-size 8
  */
 
 import { SerialPort } from 'serialport';
 import * as readline from 'readline';
 import {
-  frame, deframe, FrameAssembler,
+  frame, deframe, FrameAssembler, FLAG_FIN,
   encodeRequest, decodeResponse,
+  encodeBatchRequest, decodeBatchResponse,
+  SID_BATCH, SID_ENCRYPTED, SID_ENCRYPTED_BATCH, SID_SENSOR,
+  BATCH_MAX_ENTRIES, MAX_RSP_FRAME,
   Cluster as ClusterEnum,
   CommandStatusName,
 } from './protocol.js';
@@ -50,6 +55,12 @@ const LIST_MODE = hasFlag('--list');
 const AUTO_MODE = hasFlag('--auto');
 const TIMEOUT_MS = parseInt(getArg('--timeout') || '3000', 10);
 
+// Benchmark: v1 one-command-per-frame vs v2 batched envelope
+const BENCH_MODE = hasFlag('--bench');
+const BENCH_COUNT = parseInt(getArg('--bench-count') || '32', 10);
+const BATCH_SIZE = Math.min(BATCH_MAX_ENTRIES,
+  parseInt(getArg('--batch-size') || '8', 10));
+
 // Native BLE mode
 const BLE_MODE = hasFlag('--ble');
 
@@ -182,7 +193,7 @@ class BleTransport {
     this.portPath = portPath;
     this.baudRate = baudRate;
     this.port = null;
-    this.assembler = new FrameAssembler();
+    this.assembler = new FrameAssembler(MAX_RSP_FRAME);
     this.pendingResolve = null;
     this.pendingTimeout = null;
   }
@@ -248,6 +259,63 @@ class BleTransport {
   }
 }
 
+// ─── Batch helpers (v2 envelope) ────────────────────────────────────────────
+
+/**
+ * Wait for the next frame on `sid`, skipping sensor stream frames.
+ * @returns {Promise<{ payload: Buffer, flags: number, streamId: number } | null>}
+ */
+async function waitStreamFrame(transport, sid, timeoutMs) {
+  const deadline = Date.now() + timeoutMs;
+  while (Date.now() < deadline) {
+    const rxFrame = await transport.waitFrame(Math.max(100, deadline - Date.now()));
+    if (!rxFrame) return null;
+    const d = deframe(rxFrame);
+    if (!d || d.streamId === SID_SENSOR || d.streamId !== sid) continue;
+    return d;
+  }
+  return null;
+}
+
+/**
+ * Run a list of commands as v2 batches. Entries the device could not fit
+ * in its response frame are re-sent in the next batch.
+ * @param {function(Buffer): Promise<Buffer|null>} roundTrip body → response body
+ * @returns {Promise<{ success, results: Array, roundTrips: number, error? }>}
+ */
+async function runBatch(cmdList, roundTrip) {
+  const results = new Array(cmdList.length).fill(null);
+  let pending = cmdList.map((cmd, i) => i);
+  let roundTrips = 0;
+
+  while (pending.length > 0) {
+    const chunk = pending.slice(0, BATCH_MAX_ENTRIES);
+    const body = encodeBatchRequest(chunk.map(i => ({
+      reqId: i,
+      cluster: cmdList[i].key.cluster,
+      commandId: cmdList[i].key.commandId,
+      params: cmdList[i].buildParams(),
+    })));
+
+    const rspBody = await roundTrip(body);
+    roundTrips++;
+    if (!rspBody) return { success: false, results, roundTrips, error: 'Timeout waiting for batch response' };
+
+    const entries = decodeBatchResponse(rspBody);
+    if (!entries) return { success: false, results, roundTrips, error: 'Invalid batch response' };
+    if (entries.length === 0) return { success: false, results, roundTrips, error: 'Empty batch response' };
+
+    for (const rsp of entries) {
+      const cmd = cmdList[rsp.reqId];
+      if (!cmd || results[rsp.reqId]) continue;
+      const decoded = rsp.status === 0 ? cmd.decodeResponse(rsp.data) : { error: rsp.statusName };
+      results[rsp.reqId] = { success: true, response: rsp, decoded };
+    }
+    pending = pending.filter(i => !results[i]);
+  }
+  return { success: true, results, roundTrips };
+}
+
 // ─── Command Executor (plaintext) ───────────────────────────────────────────
 
 class PlaintextExecutor {
@@ -284,12 +352,19 @@ class PlaintextExecutor {
 
     return { success: true, response, decoded };
   }
+
+  /** v2: many commands per frame (sid=0x01) */
+  async executeBatch(cmdList) {
+    return runBatch(cmdList, async (body) => {
+      await this.transport.send(frame(body, FLAG_FIN, SID_BATCH));
+      const d = await waitStreamFrame(this.transport, SID_BATCH, this.timeoutMs);
+      return d ? d.payload : null;
+    });
+  }
 }
 
 // ─── Command Executor (encrypted — ChaCha20 + HMAC-SHA256) ─────────────────
 
-const SID_ENCRYPTED = 0x10;
-
 class EncryptedExecutor {
   constructor(transport, deviceKey, timeoutMs = 3000) {
     this.transport = transport;
@@ -314,7 +389,7 @@ class EncryptedExecutor {
     log(`   Encrypted: ${encrypted.length}B (counter=${this.session.txCounter - 1})`);
 
     // 3. Frame with sid=0x10
-    const frameBuf = frame(encrypted, 0x01, SID_ENCRYPTED);
+    const frameBuf = frame(encrypted, FLAG_FIN, SID_ENCRYPTED);
     logHex('   Frame', frameBuf);
 
     // 4. Send
@@ -328,7 +403,7 @@ class EncryptedExecutor {
       if (!rxFrame) break;
       const d = deframe(rxFrame);
       if (!d) continue;
-      if (d.streamId === 0x20) continue;
+      if (d.streamId === SID_SENSOR) continue;
       logHex('   RX Frame', rxFrame);
       deframed = d;
       break;
@@ -355,6 +430,22 @@ class EncryptedExecutor {
     return { success: true, response, decoded };
   }
 
+  /** v2: many commands per frame, one nonce + HMAC per batch (sid=0x11) */
+  async executeBatch(cmdList) {
+    if (!this.session) return { success: false, results: [], roundTrips: 0, error: 'No session — run key exchange first (k)' };
+    return runBatch(cmdList, async (body) => {
+      await this.transport.send(frame(this.session.encrypt(body), FLAG_FIN, SID_ENCRYPTED_BATCH));
+      const d = await waitStreamFrame(this.transport, SID_ENCRYPTED_BATCH, this.timeoutMs);
+      if (!d) return null;
+      try {
+        return this.session.decrypt(d.payload);
+      } catch (e) {
+        log(`   Batch decrypt/HMAC failed: ${e.message}`);
+        return null;
+      }
+    });
+  }
+
   /**
    * ECDH P-256 Key Exchange → ChaCha20 session.
    * KE request/response are plaintext (sid=0x00).
@@ -385,7 +476,7 @@ class EncryptedExecutor {
       if (!rxFrame) break;
       const d = deframe(rxFrame);
       if (!d) continue;
-      if (d.streamId === 0x20) continue; // skip sensor stream
+      if (d.streamId === SID_SENSOR) continue; // skip sensor stream
       logHex('[KE] RX Frame', rxFrame);
       deframed = d;
       break;
@@ -443,6 +534,48 @@ async function runAutoMode(executor) {
   console.log('');
 }
 
+// ─── Benchmark (round-trips/sec, v1 vs v2) ──────────────────────────────────
+
+async function runBenchmark(executor, count = BENCH_COUNT, batchSize = BATCH_SIZE) {
+  log(`Benchmark — ${count} pings, v1 single vs v2 batch of ${batchSize} (${executor.encrypted ? 'encrypted' : 'plaintext'})`);
+  const pingCmd = commands[0];
+
+  // Silence per-frame logging of execute() while timing
+  const quiet = async (fn) => {
+    const saved = console.log;
+    console.log = () => {};
+    try { return await fn(); } finally { console.log = saved; }
+  };
+
+  const t0 = Date.now();
+  let v1Ok = 0;
+  await quiet(async () => {
+    for (let i = 0; i < count; i++) {
+      const r = await executor.execute(pingCmd);
+      if (r.success && r.response.status === 0) v1Ok++;
+    }
+  });
+  const v1Sec = (Date.now() - t0) / 1000;
+
+  const t1 = Date.now();
+  let v2Ok = 0, v2RoundTrips = 0;
+  for (let i = 0; i < count; i += batchSize) {
+    const n = Math.min(batchSize, count - i);
+    const r = await executor.executeBatch(new Array(n).fill(pingCmd));
+    v2RoundTrips += r.roundTrips;
+    if (!r.success) { log(`  v2 batch failed: ${r.error}`); break; }
+    v2Ok += r.results.filter(x => x && x.response.status === 0).length;
+  }
+  const v2Sec = (Date.now() - t1) / 1000;
+
+  const rate = (n, sec) => (sec > 0 ? (n / sec).toFixed(1) : '∞');
+  console.log('');
+  log(`v1 single : ${v1Ok}/${count} ok, ${count} round-trips in ${v1Sec.toFixed(2)}s → ${rate(count, v1Sec)} rt/s, ${rate(v1Ok, v1Sec)} cmds/s`);
+  log(`v2 batch  : ${v2Ok}/${count} ok, ${v2RoundTrips} round-trips in ${v2Sec.toFixed(2)}s → ${rate(v2RoundTrips, v2Sec)} rt/s, ${rate(v2Ok, v2Sec)} cmds/s`);
+  if (v1Sec > 0 && v2Sec > 0) log(`speed-up  : ${(v1Sec / v2Sec).toFixed(1)}x commands/sec`);
+  console.log('');
+}
+
 // ─── Interactive Mode ───────────────────────────────────────────────────────
 
 async function runInteractiveMode(executor) {
@@ -467,6 +600,7 @@ async function runInteractiveMode(executor) {
     log('   a  Send ALL commands');
     log('   r  Repeat last command');
     log('   l  Loop ping (Ctrl+C to stop)');
+    log(`   b  Benchmark v1 vs v2 batch (${BENCH_COUNT} pings, batch ${BATCH_SIZE})`);
     if (executor.encrypted) {
     log('   k  Perform ECDH key exchange');
     }
@@ -529,6 +663,11 @@ async function runInteractiveMode(executor) {
       continue;
     }
 
+    if (input === 'b' || input === 'bench') {
+      await runBenchmark(executor);
+      continue;
+    }
+
     if ((input === 'k' || input === 'ke') && executor instanceof EncryptedExecutor) {
       await executor.performKeyExchange();
       continue;
@@ -729,6 +868,13 @@ async function main() {
     }
   }
 
+  if (BENCH_MODE) {
+    await runBenchmark(executor);
+    transport.close();
+    if (monitor) monitor.stop();
+    process.exit(0);
+  }
+
   if (AUTO_MODE) {
     await runAutoMode(executor);
     transport.close();
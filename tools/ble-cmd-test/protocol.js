@@ -1,6 +1,6 @@
 /**
  * @file protocol.js
- * @brief Arcana wire protocol — CRC-16, FrameCodec, FrameAssembler, CommandCodec
+ * @brief Arcana wire protocol — CRC-16, FrameCodec, FrameAssembler, CommandCodec, BatchCodec
  *
  * Ported from STM32 C++ headers:
  *   Shared/Inc/Crc16.hpp, FrameCodec.hpp, FrameAssembler.hpp
@@ -238,3 +238,66 @@ export function decodeResponse(payload) {
     data,
   };
 }
+
+// ─── BatchCodec (v2 envelope: N commands per frame) ─────────────────────────
+// Mirrors Shared/Inc/command/codec/BatchCodec.hpp
+
+export const SID_PLAINTEXT = 0x00;
+export const SID_BATCH = 0x01;
+export const SID_ENCRYPTED = 0x10;
+export const SID_ENCRYPTED_BATCH = 0x11;
+export const SID_SENSOR = 0x20;
+
+export const BATCH_VERSION = 0x02;
+export const BATCH_MAX_ENTRIES = 16;
+export const BATCH_MAX_PARAMS = 8;   // per entry, same as a v1 request
+export const MAX_RSP_FRAME = 160;   // CommandBridge::MAX_TX_FRAME
+export const MAX_REQ_FRAME = 128;   // CmdFrameItem::MAX_DATA
+
+/**
+ * Encode a v2 batch request body.
+ * @param {Array<{ reqId: number, cluster: number, commandId: number, params?: Buffer }>} entries
+ * @returns {Buffer} [ver][count] {[reqId][cluster][cmdId][plen][params]}*
+ */
+export function encodeBatchRequest(entries) {
+  if (entries.length > BATCH_MAX_ENTRIES) {
+    throw new Error(`batch too large: ${entries.length} > ${BATCH_MAX_ENTRIES}`);
+  }
+  const parts = [Buffer.from([BATCH_VERSION, entries.length])];
+  for (const e of entries) {
+    const params = e.params || Buffer.alloc(0);
+    if (params.length > BATCH_MAX_PARAMS) {
+      throw new Error(`batch params too large: ${params.length} > ${BATCH_MAX_PARAMS}`);
+    }
+    parts.push(Buffer.from([e.reqId & 0xFF, e.cluster, e.commandId, params.length]), params);
+  }
+  return Buffer.concat(parts);
+}
+
+/**
+ * Decode a v2 batch response body.
+ * @param {Buffer} payload
+ * @returns {Array<{ reqId, cluster, commandId, status, statusName, data }> | null}
+ */
+export function decodeBatchResponse(payload) {
+  if (payload.length < 2 || payload[0] !== BATCH_VERSION) return null;
+  const count = payload[1];
+  const out = [];
+  let off = 2;
+  for (let i = 0; i < count; i++) {
+    if (off + 5 > payload.length) return null;
+    const dataLen = payload[off + 4];
+    if (off + 5 + dataLen > payload.length) return null;
+    const status = payload[off + 3];
+    out.push({
+      reqId: payload[off],
+      cluster: payload[off + 1],
+      commandId: payload[off + 2],
+      status,
+      statusName: CommandStatusName[status] || `Unknown(${status})`,
+      data: payload.subarray(off + 5, off + 5 + dataLen),
+    });
+    off += 5 + dataLen;
+  }
+  return out;
+}
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""
+Generate the fixed-base comb table for Shared/Src/command/security/P256.cpp.
+
+Lim-Lee comb, w = 5 teeth spaced d = 52 bits apart (5 * 52 >= 256):
+entry i (1..31) = sum over set bits j of i of 2^(52*j) * G, affine,
+as 8 little-endian 32-bit limbs of x followed by 8 of y.
+
+    python3 tools/gen_p256_comb.py > table.inc
+"""
+
+P = 2**256 - 2**224 + 2**192 + 2**96 - 1
+A = P - 3
+GX = 0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296
+GY = 0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5
+
+W = 5
+D = 52
+
+
+def add(p, q):
+    if p is None:
+        return q
+    if q is None:
+        return p
+    if p[0] == q[0]:
+        if (p[1] + q[1]) % P == 0:
+            return None
+        lam = (3 * p[0] * p[0] + A) * pow(2 * p[1], -1, P) % P
+    else:
+        lam = (q[1] - p[1]) * pow(q[0] - p[0], -1, P) % P
+    x = (lam * lam - p[0] - q[0]) % P
+    return (x, (lam * (p[0] - x) - p[1]) % P)
+
+
+def mul(k, p):
+    r = None
+    while k:
+        if k & 1:
+            r = add(r, p)
+        p = add(p, p)
+        k >>= 1
+    return r
+
+
+def limbs(v):
+    return ["0x%08x" % ((v >> (32 * i)) & 0xFFFFFFFF) for i in range(8)]
+
+
+def main():
+    teeth = [mul(1 << (D * j), (GX, GY)) for j in range(W)]
+    print("const uint32_t kComb[COMB_ENTRIES][16] = {")
+    for i in range(1, 1 << W):
+        pt = None
+        for j in range(W):
+            if i >> j & 1:
+                pt = add(pt, teeth[j])
+        print("    {   // %2d" % i)
+        print("        " + ", ".join(limbs(pt[0])) + ",")
+        print("        " + ", ".join(limbs(pt[1])) + ",")
+        print("    },")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,8 @@ Arcana MQTT Monitor — real-time sensor data + encrypted command console.
 
 Shows:
   - Sensor data (temperature, accel) in real-time
+      JSON (MQTT_SENSOR_PLAINTEXT builds) or ChaCha20 frames:
+      SID 0x20 one sample, 0x21 sensor.ats backfill, 0x22 TelemetryBatch
   - Encrypted command responses (AES-256-CCM + protobuf)
 
 Interactive commands:
@@ -16,16 +18,58 @@ Interactive commands:
   quit     — Exit
 
 Usage:
-  python3 tools/mqtt_monitor.py
+  python3 tools/mqtt_monitor.py [comm_key_hex]
 """
 
 import json, ssl, struct, sys, time, threading
 
 sys.path.insert(0, '.')
 from tools.mqtt_crypto_test import *
+from cryptography.hazmat.primitives.ciphers import Cipher, algorithms
+
+SID_SENSOR, SID_BACKFILL, SID_SENSOR_BATCH = 0x20, 0x21, 0x22
+SENSOR_FIELDS = ('t', 'ax', 'ay', 'az', 'als', 'ps')
+
+def chacha20(key, nonce, data):
+    """ChaCha20 (RFC 8439), block counter 0 — same as crypto::ChaCha20::crypt"""
+    c = Cipher(algorithms.ChaCha20(key, b'\0\0\0\0' + nonce), mode=None)
+    return c.decryptor().update(data)
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+def decode_sensor_pb(data):
+    """SensorData protobuf: sint32 fields 1-4, uint32 fields 5-6"""
+    out, pos = {}, 0
+    while pos < len(data):
+        tag, pos = pb_decode_varint(data, pos)
+        val, pos = pb_decode_varint(data, pos)
+        field = tag >> 3
+        if 1 <= field <= len(SENSOR_FIELDS):
+            out[SENSOR_FIELDS[field - 1]] = unzigzag(val) if field <= 4 else val
+    if 't' in out:
+        out['t'] /= 10
+    return out
+
+def decode_telemetry_batch(data):
+    """TelemetryBatch: [ver][fields][count][rsv][baseTs:4] + zig-zag delta varints"""
+    ver, fields, count = data[0], data[1], data[2]
+    if ver != 1:
+        raise ValueError(f'batch version {ver}')
+    ts = struct.unpack('<I', data[4:8])[0]
+    prev, pos, samples = [0] * fields, 8, []
+    for _ in range(count):
+        d, pos = pb_decode_varint(data, pos)
+        ts = (ts + unzigzag(d)) & 0xFFFFFFFF
+        for i in range(fields):
+            d, pos = pb_decode_varint(data, pos)
+            prev[i] += unzigzag(d)
+        samples.append((ts, list(prev)))
+    return samples
 
 def main():
     crypto = CryptoEngine(PSK_HEX)
+    comm_key = bytes.fromhex(sys.argv[1]) if len(sys.argv) > 1 else None
 
     CMDS = {
         'ping':   (0x00, 0x01),
@@ -41,10 +85,42 @@ def main():
         c.subscribe('/arcana/#')
         print('[connected] Subscribed to /arcana/#')
 
+    def show_sensor_frame(ts, sid, plain):
+        if sid == SID_SENSOR:
+            d = decode_sensor_pb(plain)
+            print(f'  [{ts}] sensor  ' + '  '.join(f'{k}={v}' for k, v in d.items()))
+        elif sid == SID_SENSOR_BATCH:
+            samples = decode_telemetry_batch(plain)
+            print(f'  [{ts}] batch   {len(samples)} samples, {len(plain)}B')
+            for t, v in samples:
+                d = dict(zip(SENSOR_FIELDS, v))
+                if 't' in d:
+                    d['t'] /= 10
+                print(f'            @{t}ms  ' + '  '.join(f'{k}={x}' for k, x in d.items()))
+        elif sid == SID_BACKFILL:
+            file_id, block, rec, n, size = struct.unpack('<IIHBB', plain[:12])
+            recs = plain[12:12 + n * size]
+            first = struct.unpack('<I', recs[:4])[0] if n else 0
+            last = struct.unpack('<I', recs[(n - 1) * size:(n - 1) * size + 4])[0] if n else 0
+            print(f'  [{ts}] backfill file={file_id} block={block}/{rec} {n}x{size}B ts {first}..{last}')
+        else:
+            print(f'  [{ts}] sensor  sid 0x{sid:02X} {len(plain)}B')
+
     def on_message(c, ud, msg):
         ts = time.strftime('%H:%M:%S')
 
-        if msg.topic == '/arcana/sensor':
+        if msg.topic.endswith('/sensor'):
+            r = frame_decode(msg.payload)
+            if r and comm_key:
+                payload, flags, sid = r
+                try:
+                    show_sensor_frame(ts, sid, chacha20(comm_key, payload[:12], payload[12:]))
+                except Exception as e:
+                    print(f'  [{ts}] sensor  sid 0x{sid:02X} decode fail: {e}')
+                return
+            if r:
+                print(f'  [{ts}] sensor  sid 0x{r[2]:02X} {len(r[0])}B (no comm key)')
+                return
             try:
                 d = json.loads(msg.payload)
                 print(f'  [{ts}] sensor  t={d["t"]}°C  ax={d["ax"]}  ay={d["ay"]}  az={d["az"]}')
@@ -52,6 +128,14 @@ def main():
                 print(f'  [{ts}] sensor  {msg.payload[:80]}')
             return
 
+        if msg.topic.endswith('/rsp_bin'):
+            r = frame_decode(msg.payload)
+            if r:
+                print(f'  [{ts}] rsp_bin sid 0x{r[2]:02X} {len(r[0])}B')
+            else:
+                print(f'  [{ts}] rsp_bin deframe fail')
+            return
+
         if msg.topic == '/arcana/rsp':
             raw = msg.payload
             try:
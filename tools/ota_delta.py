@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""
+Arcana delta OTA — builds a compact patch between two firmware images.
+
+The device downloads the patch (fw_patch.bin) instead of firmware.bin;
+the bootloader rebuilds the new image from the running App flash + patch.
+Format: Shared/Inc/core/model/ota_delta.h
+
+Usage:
+  python3 tools/ota_delta.py make old.bin new.bin [-o fw_patch.bin]
+  python3 tools/ota_delta.py apply old.bin fw_patch.bin [-o new.bin]
+  python3 tools/ota_delta.py info fw_patch.bin
+
+old.bin must be the exact image running on the device: the patch carries
+its CRC-32, and both the App and the bootloader refuse any other base.
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+
+DELTA_MAGIC = 0x50445241  # "ARDP"
+DELTA_VERSION = 1
+HEADER_FMT = "<IB3xIIII"   # + hdr_crc
+HEADER_SIZE = 28
+APP_FLASH_SIZE = 476 * 1024
+
+OP_COPY, OP_LITERAL, OP_FILL = 0, 1, 2
+
+KEY_LEN = 8       # bytes hashed to find copy candidates
+MIN_COPY = 12     # shorter matches cost more than the literal bytes
+MIN_FILL = 16
+MAX_CANDIDATES = 32
+
+
+def crc32_ieee(data: bytes) -> int:
+    return binascii.crc32(data) & 0xFFFFFFFF
+
+
+def varint(v: int) -> bytes:
+    out = bytearray()
+    while True:
+        b = v & 0x7F
+        v >>= 7
+        if v:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(v: int) -> int:
+    return (v << 1) if v >= 0 else ((-v - 1) << 1) | 1
+
+
+def pack_header(src: bytes, dst: bytes) -> bytes:
+    body = struct.pack(HEADER_FMT, DELTA_MAGIC, DELTA_VERSION,
+                       len(src), crc32_ieee(src), len(dst), crc32_ieee(dst))
+    return body + struct.pack("<I", crc32_ieee(body))
+
+
+def unpack_header(patch: bytes) -> dict:
+    if len(patch) < HEADER_SIZE:
+        raise ValueError("patch shorter than its header")
+    magic, version, src_size, src_crc, dst_size, dst_crc = \
+        struct.unpack_from(HEADER_FMT, patch)
+    (hdr_crc,) = struct.unpack_from("<I", patch, 24)
+    if magic != DELTA_MAGIC or version != DELTA_VERSION:
+        raise ValueError("not an Arcana delta patch")
+    if crc32_ieee(patch[:24]) != hdr_crc:
+        raise ValueError("header CRC mismatch")
+    return {"src_size": src_size, "src_crc": src_crc,
+            "dst_size": dst_size, "dst_crc": dst_crc}
+
+
+def make_patch(src: bytes, dst: bytes) -> bytes:
+    """Greedy COPY/LITERAL/FILL encoding.
+
+    Candidates come from an index of every KEY_LEN-byte window of src. The
+    position that continues the last copy is tried first: after a small
+    code change most of the image still lines up at a fixed shift.
+    """
+    index = {}
+    for i in range(len(src) - KEY_LEN + 1):
+        bucket = index.setdefault(src[i:i + KEY_LEN], [])
+        if len(bucket) < MAX_CANDIDATES:
+            bucket.append(i)
+
+    ops = bytearray()
+    literal = bytearray()
+    src_pos = 0   # end of the last COPY, what COPY offsets are relative to
+
+    def flush_literal():
+        if literal:
+            ops.extend(varint(len(literal) << 2 | OP_LITERAL))
+            ops.extend(literal)
+            literal.clear()
+
+    def match_len(s, d):
+        n = 0
+        limit = min(len(src) - s, len(dst) - d)
+        while n < limit and src[s + n] == dst[d + n]:
+            n += 1
+        return n
+
+    j = 0
+    while j < len(dst):
+        # Runs of one byte (erased flash, zeroed tables)
+        run = 1
+        while j + run < len(dst) and dst[j + run] == dst[j]:
+            run += 1
+
+        best_len, best_off = 0, 0
+        cands = [src_pos] if src_pos < len(src) else []
+        cands += index.get(dst[j:j + KEY_LEN], [])
+        for s in cands:
+            n = match_len(s, j)
+            if n > best_len:
+                best_len, best_off = n, s
+
+        if run >= MIN_FILL and run >= best_len:
+            flush_literal()
+            ops.extend(varint(run << 2 | OP_FILL))
+            ops.append(dst[j])
+            j += run
+        elif best_len >= MIN_COPY:
+            flush_literal()
+            ops.extend(varint(best_len << 2 | OP_COPY))
+            ops.extend(varint(zigzag(best_off - src_pos)))
+            src_pos = best_off + best_len
+            j += best_len
+        else:
+            literal.append(dst[j])
+            j += 1
+    flush_literal()
+
+    return pack_header(src, dst) + bytes(ops)
+
+
+def apply_patch(src: bytes, patch: bytes) -> bytes:
+    """Reference applier — mirrors ota_delta_apply()."""
+    hdr = unpack_header(patch)
+    if len(src) < hdr["src_size"] or crc32_ieee(src[:hdr["src_size"]]) != hdr["src_crc"]:
+        raise ValueError("base image does not match the patch")
+    src = src[:hdr["src_size"]]
+
+    pos = HEADER_SIZE
+
+    def read_varint():
+        nonlocal pos
+        v, shift = 0, 0
+        while True:
+            b = patch[pos]
+            pos += 1
+            v |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return v
+
+    out = bytearray()
+    src_pos = 0
+    while len(out) < hdr["dst_size"]:
+        op = read_varint()
+        kind, length = op & 3, op >> 2
+        if kind == OP_COPY:
+            z = read_varint()
+            src_pos += -((z >> 1) + 1) if z & 1 else z >> 1
+            out += src[src_pos:src_pos + length]
+            src_pos += length
+        elif kind == OP_LITERAL:
+            out += patch[pos:pos + length]
+            pos += length
+        elif kind == OP_FILL:
+            out += bytes([patch[pos]]) * length
+            pos += 1
+        else:
+            raise ValueError(f"bad op {kind} at {pos}")
+    if crc32_ieee(bytes(out)) != hdr["dst_crc"]:
+        raise ValueError("rebuilt image CRC mismatch")
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Arcana delta OTA patch tool")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("make", help="build a patch from old.bin to new.bin")
+    p.add_argument("old")
+    p.add_argument("new")
+    p.add_argument("-o", "--output", default="fw_patch.bin")
+
+    p = sub.add_parser("apply", help="rebuild new.bin (checks a patch)")
+    p.add_argument("old")
+    p.add_argument("patch")
+    p.add_argument("-o", "--output", default="new.bin")
+
+    p = sub.add_parser("info", help="print a patch header")
+    p.add_argument("patch")
+
+    args = parser.parse_args()
+
+    if args.cmd == "make":
+        src = open(args.old, "rb").read()
+        dst = open(args.new, "rb").read()
+        if len(src) > APP_FLASH_SIZE or len(dst) > APP_FLASH_SIZE:
+            sys.exit("image larger than the App region")
+        patch = make_patch(src, dst)
+        if apply_patch(src, patch) != dst:
+            sys.exit("internal error: patch does not rebuild new.bin")
+        with open(args.output, "wb") as f:
+            f.write(patch)
+        print(f"Base:   {args.old} {len(src)}B CRC 0x{crc32_ieee(src):08X}")
+        print(f"Target: {args.new} {len(dst)}B CRC 0x{crc32_ieee(dst):08X}")
+        print(f"Patch:  {args.output} {len(patch)}B CRC 0x{crc32_ieee(patch):08X} "
+              f"({100 * len(patch) / max(len(dst), 1):.1f}% of target)")
+    elif args.cmd == "apply":
+        src = open(args.old, "rb").read()
+        patch = open(args.patch, "rb").read()
+        dst = apply_patch(src, patch)
+        with open(args.output, "wb") as f:
+            f.write(dst)
+        print(f"Rebuilt {args.output} {len(dst)}B CRC 0x{crc32_ieee(dst):08X}")
+    else:
+        hdr = unpack_header(open(args.patch, "rb").read())
+        print(f"Base:   {hdr['src_size']}B CRC 0x{hdr['src_crc']:08X}")
+        print(f"Target: {hdr['dst_size']}B CRC 0x{hdr['dst_crc']:08X}")
+
+
+if __name__ == "__main__":
+    main()
@@ -9,6 +9,15 @@ Endpoints:
     - Supports Content-Range for resume
     - Stores to ./uploads/<device_id>/<filename>
 
+  POST /upload/<device_id>/<filename>/manifest
+    - Body: 8-byte truncated SHA-256 per 4KB chunk (X-Chunk-Size), in order
+    - Rebuilds what it can from the device's chunk store
+    - Answers {"missing":"0-3,17",...} with at most X-Max-Ranges ranges
+
+  POST /upload/<device_id>/<filename>/chunks
+    - Body: the chunks listed in X-Ranges, back to back
+    - Answers {"status":"complete"} once the file matches its manifest
+
   GET /uploads/<device_id>
     - List uploaded files for a device
 
@@ -32,6 +41,7 @@ from flask import Flask, request, jsonify, abort
 app = Flask(__name__)
 
 UPLOAD_DIR = "./uploads"
+DIGEST_SIZE = 8
 
 
 @app.route("/health", methods=["GET"])
@@ -155,6 +165,168 @@ def upload_file(device_id, filename):
     return jsonify(result), 200 if complete else 206
 
 
+# ── Chunk sync (manifest → missing chunks only) ──────────────────────────────
+
+def check_filename(filename):
+    if not filename.endswith(".ats"):
+        abort(400, "Only .ats files accepted")
+    if "/" in filename or ".." in filename:
+        abort(400, "Invalid filename")
+
+
+def chunk_digest(data):
+    return hashlib.sha256(data).digest()[:DIGEST_SIZE]
+
+
+def parse_ranges(text):
+    """'0-3,17' → [(0, 3), (17, 17)]"""
+    ranges = []
+    for part in filter(None, text.split(",")):
+        first, _, last = part.partition("-")
+        ranges.append((int(first), int(last or first)))
+    return ranges
+
+
+def format_ranges(ranges):
+    return ",".join(str(a) if a == b else f"{a}-{b}" for a, b in ranges)
+
+
+def missing_ranges(have, max_ranges):
+    """Runs of chunks not held, merged across the smallest gaps until
+    there are at most max_ranges (the device holds a fixed-size list)."""
+    runs = []
+    for i, ok in enumerate(have):
+        if ok:
+            continue
+        if runs and runs[-1][1] == i - 1:
+            runs[-1][1] = i
+        else:
+            runs.append([i, i])
+    while len(runs) > max_ranges:
+        gaps = [runs[k + 1][0] - runs[k][1] for k in range(len(runs) - 1)]
+        k = gaps.index(min(gaps))
+        runs[k][1] = runs[k + 1][1]
+        del runs[k + 1]
+    return [tuple(r) for r in runs]
+
+
+def sync_paths(device_id, filename):
+    device_dir = Path(UPLOAD_DIR) / device_id
+    store = device_dir / ".chunks"
+    manifests = device_dir / ".manifests"
+    store.mkdir(parents=True, exist_ok=True)
+    manifests.mkdir(parents=True, exist_ok=True)
+    return device_dir / filename, store, manifests / filename
+
+
+def chunks_held(filepath, store, digests, chunk_size, file_size):
+    """Bring the stored file in line with the manifest; returns which
+    chunks now match. Chunks seen before — in this file at another offset
+    or in another file of the device — come from the chunk store."""
+    mode = "r+b" if filepath.exists() else "w+b"
+    have = []
+    with open(filepath, mode) as f:
+        f.truncate(file_size)
+        for i, want in enumerate(digests):
+            f.seek(i * chunk_size)
+            length = min(chunk_size, file_size - i * chunk_size)
+            data = f.read(length)
+            if len(data) == length and chunk_digest(data) == want:
+                have.append(True)
+                continue
+            cached = store / want.hex()
+            if cached.exists():
+                data = cached.read_bytes()
+                if len(data) == length:
+                    f.seek(i * chunk_size)
+                    f.write(data)
+                    have.append(True)
+                    continue
+            have.append(False)
+    return have
+
+
+@app.route("/upload/<device_id>/<filename>/manifest", methods=["POST"])
+def upload_manifest(device_id, filename):
+    check_filename(filename)
+    try:
+        file_size = int(request.headers["X-File-Size"])
+        chunk_size = int(request.headers.get("X-Chunk-Size", 4096))
+        max_ranges = int(request.headers.get("X-Max-Ranges", 16))
+    except (KeyError, ValueError):
+        abort(400, "X-File-Size required")
+
+    body = request.get_data()
+    chunks = (file_size + chunk_size - 1) // chunk_size
+    if len(body) != chunks * DIGEST_SIZE:
+        abort(400, f"Manifest is {len(body)}B, expected {chunks * DIGEST_SIZE}B")
+    digests = [body[i:i + DIGEST_SIZE] for i in range(0, len(body), DIGEST_SIZE)]
+
+    filepath, store, manifest_path = sync_paths(device_id, filename)
+    manifest_path.write_bytes(body)
+    have = chunks_held(filepath, store, digests, chunk_size, file_size)
+    missing = missing_ranges(have, max_ranges)
+
+    held = sum(have)
+    print(f"[SYNC] {device_id}/{filename}: {held}/{chunks} chunks held, "
+          f"missing {format_ranges(missing) or 'none'}")
+    return jsonify({
+        "missing": format_ranges(missing),
+        "chunks": chunks,
+        "held": held,
+        "size": file_size,
+    })
+
+
+@app.route("/upload/<device_id>/<filename>/chunks", methods=["POST"])
+def upload_chunks(device_id, filename):
+    check_filename(filename)
+    try:
+        file_size = int(request.headers["X-File-Size"])
+        chunk_size = int(request.headers.get("X-Chunk-Size", 4096))
+        ranges = parse_ranges(request.headers.get("X-Ranges", ""))
+    except (KeyError, ValueError):
+        abort(400, "X-File-Size and X-Ranges required")
+
+    filepath, store, manifest_path = sync_paths(device_id, filename)
+    if not manifest_path.exists():
+        abort(409, "No manifest for this file")
+    body = manifest_path.read_bytes()
+    digests = [body[i:i + DIGEST_SIZE] for i in range(0, len(body), DIGEST_SIZE)]
+
+    # Ranges arrive back to back; write each at its own offset
+    stream = request.stream
+    written = 0
+    mode = "r+b" if filepath.exists() else "w+b"
+    with open(filepath, mode) as f:
+        for first, last in ranges:
+            for i in range(first, last + 1):
+                length = min(chunk_size, file_size - i * chunk_size)
+                data = b""
+                while len(data) < length:
+                    part = stream.read(length - len(data))
+                    if not part:
+                        break
+                    data += part
+                f.seek(i * chunk_size)
+                f.write(data)
+                written += len(data)
+                if len(data) == length and i < len(digests) and chunk_digest(data) == digests[i]:
+                    (store / digests[i].hex()).write_bytes(data)
+
+    have = chunks_held(filepath, store, digests, chunk_size, file_size)
+    missing = missing_ranges(have, len(digests) or 1)
+    complete = not missing
+    print(f"[SYNC] {device_id}/{filename}: {written}B in {format_ranges(ranges)} "
+          f"→ {'COMPLETE' if complete else 'missing ' + format_ranges(missing)}")
+    return jsonify({
+        "status": "complete" if complete else "partial",
+        "written_bytes": written,
+        "missing": format_ranges(missing),
+        "file_size": file_size,
+    }), 200 if complete else 206
+
+
 @app.route("/uploads/<device_id>", methods=["GET"])
 def list_files(device_id):
     """List uploaded files for a device."""
@@ -283,6 +455,8 @@ if __name__ == "__main__":
     print(f"    POST /upload/<device_id>/<filename>  (gzip or raw)")
     print(f"    GET  /uploads/<device_id>            (list files)")
     print(f"    GET  /upload/<device_id>/<filename>/status  (resume check)")
+    print(f"    POST /upload/<device_id>/<filename>/manifest  (chunk digests → missing)")
+    print(f"    POST /upload/<device_id>/<filename>/chunks    (missing chunks)")
     print()
 
     # No request timeout — large file uploads can take hours over slow links